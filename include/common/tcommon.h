@@ -234,6 +234,8 @@ typedef struct SVarColAttr {
   int32_t* offset;    // start position for each entry in the list
   uint32_t length;    // used buffer size that contain the valid data
   uint32_t allocLen;  // allocated buffer size
+  int32_t  dictSize;  // number of dictionary entries if the rows carry dictionary codes, 0 otherwise
+  int16_t* dictCode;  // dictionary code of each row, the rows of the same code share one value and offset
 } SVarColAttr;
 
 // pBlockAgg->numOfNull == info.rows, all data are null
@@ -301,6 +303,8 @@ typedef struct STableBlockDistInfo {
   uint32_t numOfInmemRows;
   uint32_t numOfSmallBlocks;
   int32_t  blockRowsHisto[20];
+  uint64_t numOfPageCacheHits;
+  uint64_t numOfPageCacheMisses;
 } STableBlockDistInfo;
 
 int32_t tSerializeBlockDistInfo(void* buf, int32_t bufLen, const STableBlockDistInfo* pInfo);
@@ -51,6 +51,9 @@ typedef struct SBlockOrderInfo {
 
 #define BitmapLen(_n) (((_n) + ((1 << NBIT) - 1)) >> NBIT)
 
+#define BLOCK_VERSION_1          1  // column data in raw
+#define BLOCK_VERSION_COMPRESSED 2  // column data compressed by the codec of its type
+
 #define colDataGetVarData(p1_, r_) ((p1_)->pData + (p1_)->varmeta.offset[(r_)])
 
 #define colDataGetNumData(p1_, r_) ((p1_)->pData + ((r_) * (p1_)->info.bytes))
@@ -58,6 +61,9 @@ typedef struct SBlockOrderInfo {
 #define colDataGetData(p1_, r_) \
   ((IS_VAR_DATA_TYPE((p1_)->info.type)) ? colDataGetVarData(p1_, r_) : colDataGetNumData(p1_, r_))
 
+// the rows of a var column carry dictionary codes, set by the reader for dictionary encoded blocks
+#define colDataHasDict(p1_) (IS_VAR_DATA_TYPE((p1_)->info.type) && (p1_)->varmeta.dictSize > 0)
+
 #define IS_JSON_NULL(type, data) \
   ((type) == TSDB_DATA_TYPE_JSON && (*(data) == TSDB_DATA_TYPE_NULL || tTagIsJsonNull(data)))
 
@@ -228,6 +234,10 @@ size_t blockDataGetSerialMetaSize(uint32_t numOfCols);
 
 int32_t blockDataSort(SSDataBlock* pDataBlock, SArray* pOrderInfo);
 int32_t blockDataSort_rv(SSDataBlock* pDataBlock, SArray* pOrderInfo, bool nullFirst);
+int32_t blockDataReorder(SSDataBlock* pDataBlock, const int32_t* index);
+int32_t colDataSetDict(SColumnInfoData* pColumnInfoData, int32_t dictSize, uint32_t numOfRows);
+int32_t colDataKeepDictRows(SColumnInfoData* pColumnInfoData, const int8_t* pKeep, int32_t numOfRows);
+int32_t colDataGather(SColumnInfoData* pDst, const SColumnInfoData* pSrc, const int32_t* index, int32_t numOfRows);
 
 int32_t colInfoDataEnsureCapacity(SColumnInfoData* pColumn, uint32_t numOfRows, bool clearPayload);
 int32_t blockDataEnsureCapacity(SSDataBlock* pDataBlock, uint32_t numOfRows);
@@ -258,6 +268,9 @@ SColumnInfoData  createColumnInfoData(int16_t type, int32_t bytes, int16_t colId
 SColumnInfoData* bdGetColumnInfoData(const SSDataBlock* pBlock, int32_t index);
 
 int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols);
+int32_t blockCompressEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols);
+int32_t blockGetDecompressSize(const char* pData);
+int32_t blockDecompressEncode(const char* pData, char* pOut);
 const char* blockDecode(SSDataBlock* pBlock, const char* pData);
 
 void blockDebugShowDataBlock(SSDataBlock* pBlock, const char* flag);
@@ -274,6 +287,12 @@ static FORCE_INLINE int32_t blockGetEncodeSize(const SSDataBlock* pBlock) {
   return blockDataGetSerialMetaSize(taosArrayGetSize(pBlock->pDataBlock)) + blockDataGetSize(pBlock);
 }
 
+// each compressed segment has a flag and a length, and may grow COMP_OVERFLOW_BYTES at most
+static FORCE_INLINE int32_t blockGetCompressEncodeSize(const SSDataBlock* pBlock) {
+  return blockGetEncodeSize(pBlock) + taosArrayGetSize(pBlock->pDataBlock) * 2 *
+                                          (sizeof(int8_t) + sizeof(int32_t) + COMP_OVERFLOW_BYTES);
+}
+
 static FORCE_INLINE int32_t blockCompressColData(SColumnInfoData* pColRes, int32_t numOfRows, char* data,
                                                  int8_t compressed) {
   int32_t colSize = colDataGetLength(pColRes, numOfRows);
@@ -116,6 +116,8 @@ void    tColDataClear(SColData *pColData);
 int32_t tColDataAppendValue(SColData *pColData, SColVal *pColVal);
 void    tColDataGetValue(SColData *pColData, int32_t iVal, SColVal *pColVal);
 uint8_t tColDataGetBitValue(const SColData *pColData, int32_t iVal);
+void    tColDataCopyFixedValues(const SColData *pColData, int32_t iVal, int32_t nVal, bool asc, void *pDst);
+bool    tColDataGetNullBitmap(const SColData *pColData, int32_t iVal, int32_t nVal, bool asc, char *nullbitmap);
 int32_t tColDataCopy(SColData *pColDataSrc, SColData *pColDataDest);
 extern void (*tColDataCalcSMA[])(SColData *pColData, int64_t *sum, int64_t *max, int64_t *min, int16_t *numOfNull);
 
@@ -172,6 +174,8 @@ struct SColData {
   int32_t *aOffset;
   int32_t  nData;
   uint8_t *pData;
+  int32_t  nDict;      // number of dictionary entries if decoded from a dictionary chunk, 0 otherwise
+  int16_t *aDictCode;  // dictionary code of each value, valid only when nDict > 0
 };
 
 #pragma pack(push, 1)
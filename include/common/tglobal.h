@@ -58,16 +58,19 @@ extern int32_t tsNumOfVnodeQueryThreads;
 extern float   tsRatioOfVnodeStreamThreads;
 extern int32_t tsNumOfVnodeFetchThreads;
 extern int32_t tsNumOfVnodeRsmaThreads;
+extern int32_t tsNumOfVnodeInsertThreads;
 extern int32_t tsNumOfQnodeQueryThreads;
 extern int32_t tsNumOfQnodeFetchThreads;
 extern int32_t tsNumOfSnodeStreamThreads;
 extern int32_t tsNumOfSnodeWriteThreads;
+extern int32_t tsNumOfSortThreads;
 extern int64_t tsRpcQueueMemoryAllowed;
 
 // sync raft
 extern int32_t tsElectInterval;
 extern int32_t tsHeartbeatInterval;
 extern int32_t tsHeartbeatTimeout;
+extern bool    tsSyncBatchAppendEntries;
 
 // monitor
 extern bool     tsEnableMonitor;
@@ -140,6 +143,20 @@ extern int32_t tsSmlBatchSize;
 // wal
 extern int64_t tsWalFsyncDataSizeLimit;
 
+// tsdb
+extern int32_t tsCompactIoBudget;
+extern int32_t tsTsdbPageCacheSize;
+extern int32_t tsTsdbPrefetchBlocks;
+extern bool    tsTsdbSttBloomFilter;
+
+// meta
+extern int32_t tsMetaWalSize;
+extern int32_t tsMetaTagTableCacheSize;
+extern int32_t tsMetaSkmCacheSize;
+
+// stream
+extern int32_t tsStreamCheckpointInterval;
+
 // internal
 extern int32_t tsTransPullupInterval;
 extern int32_t tsMqRebalanceInterval;
@@ -1080,6 +1080,8 @@ typedef struct {
   int64_t totalStorage;
   int64_t compStorage;
   int64_t pointsWritten;
+  int32_t compactNFSet;  // file sets of the running compaction, 0 if not compacting
+  int32_t compactNDone;
   int64_t numOfSelectReqs;
   int64_t numOfInsertReqs;
   int64_t numOfInsertSuccessReqs;
@@ -1466,6 +1468,8 @@ typedef struct STableScanAnalyzeInfo {
   uint32_t filterOutBlocks;
   double   elapsedTime;
   double   filterTime;
+  uint64_t pageCacheHits;  // tsdb page cache lookups of the scan
+  uint64_t pageCacheMisses;
 } STableScanAnalyzeInfo;
 
 int32_t tSerializeSExplainRsp(void* buf, int32_t bufLen, SExplainRsp* pRsp);
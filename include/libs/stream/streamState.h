@@ -16,13 +16,13 @@
 #include "tdatablock.h"
 #include "tdbInt.h"
 
+#ifndef _STREAM_STATE_H_
+#define _STREAM_STATE_H_
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#ifndef _STREAM_STATE_H_
-#define _STREAM_STATE_H_
-
 typedef struct SStreamTask SStreamTask;
 
 typedef bool (*state_key_cmpr_fn)(void* pKey1, void* pKey2);
@@ -35,6 +35,7 @@ typedef struct STdbState {
   TTB*         pFillStateDb;  // todo refactor
   TTB*         pSessionStateDb;
   TTB*         pParNameDb;
+  TTB*         pCheckpointDb;
   TXN*         txn;
 } STdbState;
 
@@ -108,6 +109,9 @@ int32_t streamStateCurPrev(SStreamState* pState, SStreamStateCur* pCur);
 int32_t streamStatePutParName(SStreamState* pState, int64_t groupId, const char* tbname);
 int32_t streamStateGetParName(SStreamState* pState, int64_t groupId, void** pVal);
 
+int32_t streamStatePutCheckpoint(SStreamState* pState, int64_t checkpointId, int64_t checkpointVer);
+int32_t streamStateGetCheckpoint(SStreamState* pState, int64_t* pCheckpointId, int64_t* pCheckpointVer);
+
 #if 0
 char* streamStateSessionDump(SStreamState* pState);
 #endif
@@ -24,13 +24,13 @@
 #include "tqueue.h"
 #include "trpc.h"
 
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#ifndef _STREAM_H_
-#define _STREAM_H_
-
 typedef struct SStreamTask SStreamTask;
 
 enum {
@@ -136,10 +136,23 @@ typedef struct {
   SSDataBlock* pBlock;
 } SStreamRefDataBlock;
 
+// checkpoint barrier, flows through the queues of a task in order with the data
 typedef struct {
-  int8_t type;
+  int8_t         type;
+  int64_t        streamId;
+  int64_t        checkpointId;
+  int32_t        upstreamTaskId;
+  int32_t        upstreamNodeId;
+  int32_t        childId;  // -1 if injected into a source task by mnode
+  int32_t        code;     // non-zero if the checkpoint already failed upstream
+  SRpcHandleInfo rspInfo;  // to ack the upstream task (or mnode) once the checkpoint is done
 } SStreamCheckpoint;
 
+typedef struct {
+  int64_t checkpointId;
+  int64_t checkpointVer;  // latest wal version covered by the checkpoint, -1 if not a source task
+} SStreamCheckpointInfo;
+
 typedef struct {
   int8_t       type;
   SSDataBlock* pBlock;
@@ -340,8 +353,22 @@ typedef struct SStreamTask {
   SArray* checkReqIds;  // shuffle
   int32_t refCnt;
 
-  int64_t checkpointingId;
-  int32_t checkpointAlignCnt;
+  int64_t               checkpointingId;
+  int32_t               checkpointAlignCnt;
+  int32_t               checkpointCode;         // first failure carried by the barriers aligned so far
+  SArray*               checkpointBarriers;     // SArray<SStreamCheckpoint*>, aligned barriers waiting to be acked
+  int64_t               checkpointLastId;       // latest checkpoint finished or aborted, to answer retried barriers
+  int32_t               checkpointLastCode;
+  SRWLatch              checkpointLatch;        // guards the dispatch side below, also used by the rsp timer
+  int64_t               dispatchCheckpointId;   // barrier sent downstream and not fully acked yet, 0 if none
+  int32_t               dispatchCheckpointCode;
+  SArray*               checkpointAckTasks;     // SArray<int32_t>, downstream tasks that acked dispatchCheckpointId
+  int32_t               checkpointRetry;
+  void*                 checkpointTmr;
+  int32_t               outputCheckpointCnt;    // barriers waiting in the output queue
+  SStreamCheckpoint*    pOutputBarrier;         // barrier taken out of the output queue while coalescing
+  int64_t               processedVer;           // latest wal version processed by a source task
+  SStreamCheckpointInfo chkInfo;                // latest completed checkpoint
 
 } SStreamTask;
 
@@ -506,6 +533,7 @@ typedef struct {
   int32_t  childId;
   int64_t  expireTime;
   int8_t   taskLevel;
+  int32_t  code;
 } SStreamCheckpointReq;
 
 typedef struct {
@@ -519,6 +547,7 @@ typedef struct {
   int32_t  childId;
   int64_t  expireTime;
   int8_t   taskLevel;
+  int32_t  code;
 } SStreamCheckpointRsp;
 
 int32_t tEncodeSStreamCheckpointReq(SEncoder* pEncoder, const SStreamCheckpointReq* pReq);
@@ -552,6 +581,7 @@ int32_t tDecodeSStreamTaskRecoverReq(SDecoder* pDecoder, SStreamRecoverDownstrea
 int32_t tEncodeSStreamTaskRecoverRsp(SEncoder* pEncoder, const SStreamRecoverDownstreamRsp* pRsp);
 int32_t tDecodeSStreamTaskRecoverRsp(SDecoder* pDecoder, SStreamRecoverDownstreamRsp* pRsp);
 
+int32_t tEncodeStreamDispatchReq(SEncoder* pEncoder, const SStreamDispatchReq* pReq);
 int32_t tDecodeStreamDispatchReq(SDecoder* pDecoder, SStreamDispatchReq* pReq);
 int32_t tDecodeStreamRetrieveReq(SDecoder* pDecoder, SStreamRetrieveReq* pReq);
 void    tDeleteStreamRetrieveReq(SStreamRetrieveReq* pReq);
@@ -576,6 +606,7 @@ int32_t streamScanExec(SStreamTask* pTask, int32_t batchSz);
 // recover and fill history
 int32_t streamTaskCheckDownstream(SStreamTask* pTask, int64_t version);
 int32_t streamTaskLaunchRecover(SStreamTask* pTask, int64_t version);
+int32_t streamTaskResumeFromCheckpoint(SStreamTask* pTask, int64_t ver);
 int32_t streamProcessTaskCheckReq(SStreamTask* pTask, const SStreamTaskCheckReq* pReq);
 int32_t streamProcessTaskCheckRsp(SStreamTask* pTask, const SStreamTaskCheckRsp* pRsp, int64_t version);
 // common
@@ -626,12 +657,14 @@ void         streamMetaRemoveTask(SStreamMeta* pMeta, int32_t taskId);
 int32_t streamMetaBegin(SStreamMeta* pMeta);
 int32_t streamMetaCommit(SStreamMeta* pMeta);
 int32_t streamMetaRollBack(SStreamMeta* pMeta);
-int32_t streamLoadTasks(SStreamMeta* pMeta);
+int32_t streamLoadTasks(SStreamMeta* pMeta, int64_t ver);
 
 // checkpoint
-int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq);
-int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq);
-int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp);
+int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq,
+                                         SRpcMsg* pMsg);
+int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq, SRpcMsg* pMsg);
+int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp, int32_t code);
+int32_t streamLoadCheckpointInfo(SStreamTask* pTask);
 
 #ifdef __cplusplus
 }
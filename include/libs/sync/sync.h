@@ -43,6 +43,8 @@ extern "C" {
 #define SYNC_MAX_RETRY_BACKOFF         5
 #define SYNC_LOG_REPL_RETRY_WAIT_MS    100
 #define SYNC_APPEND_ENTRIES_TIMEOUT_MS 10000
+#define SYNC_APPEND_ENTRIES_MAX_NUM    64           // max number of raft entries in one append entries msg
+#define SYNC_APPEND_ENTRIES_MAX_BYTES  (1024 * 1024)  // max bytes of a batch, a larger entry is sent alone
 #define SYNC_HEART_TIMEOUT_MS          1000 * 15
 
 #define SYNC_HEARTBEAT_SLOW_MS       1500
@@ -194,6 +196,7 @@ typedef struct SSyncLogStore {
   int32_t (*syncLogAppendEntry)(struct SSyncLogStore* pLogStore, SSyncRaftEntry* pEntry);
   int32_t (*syncLogGetEntry)(struct SSyncLogStore* pLogStore, SyncIndex index, SSyncRaftEntry** ppEntry);
   int32_t (*syncLogTruncate)(struct SSyncLogStore* pLogStore, SyncIndex fromIndex);
+  int32_t (*syncLogFsync)(struct SSyncLogStore* pLogStore);
 
 } SSyncLogStore;
 
@@ -54,6 +54,11 @@ extern "C" {
 
 typedef struct TdFile *TdFilePtr;
 
+typedef struct {
+  const void *buf;
+  int64_t     len;
+} TdFileIoVec;
+
 #define TD_FILE_CREATE   0x0001
 #define TD_FILE_WRITE    0x0002
 #define TD_FILE_READ     0x0004
@@ -84,11 +89,14 @@ bool    taosCheckExistFile(const char *pathname);
 int64_t taosLSeekFile(TdFilePtr pFile, int64_t offset, int32_t whence);
 int32_t taosFtruncateFile(TdFilePtr pFile, int64_t length);
 int32_t taosFsyncFile(TdFilePtr pFile);
+int32_t taosFdatasyncFile(TdFilePtr pFile);
 
 int64_t taosReadFile(TdFilePtr pFile, void *buf, int64_t count);
 int64_t taosPReadFile(TdFilePtr pFile, void *buf, int64_t count, int64_t offset);
 int64_t taosWriteFile(TdFilePtr pFile, const void *buf, int64_t count);
 int64_t taosPWriteFile(TdFilePtr pFile, const void *buf, int64_t count, int64_t offset);
+int64_t taosWritevFile(TdFilePtr pFile, const TdFileIoVec *iov, int32_t iovcnt);
+int64_t taosPWritevFile(TdFilePtr pFile, const TdFileIoVec *iov, int32_t iovcnt, int64_t offset);
 void    taosFprintfFile(TdFilePtr pFile, const char *format, ...);
 
 int64_t taosGetLineFile(TdFilePtr pFile, char **__restrict ptrBuf);
@@ -34,6 +34,11 @@ extern "C" {
 #define NO_COMPRESSION 0
 #define ONE_STAGE_COMP 1
 #define TWO_STAGE_COMP 2
+// Integer only algorithms, picked per column chunk by the tsdb block writer
+#define FOR_BITPACK_COMP 3  // frame of reference + bit packing
+#define RLE_COMP         4  // run length
+// Var data only, a block dictionary of the distinct values plus FOR packed codes, built by the tsdb block writer
+#define DICT_COMP 5
 
 //
 // compressed data first byte foramt
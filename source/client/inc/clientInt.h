@@ -180,6 +180,8 @@ typedef struct SReqResultInfo {
   bool           convertUcs4;
   int32_t        payloadLen;
   char*          convertJson;
+  char*          decompBuf;  // the column-compressed block of rsp is restored here
+  int32_t        decompBufSize;
 } SReqResultInfo;
 
 typedef struct SRequestSendRecvBody {
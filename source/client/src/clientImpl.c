@@ -1971,7 +1971,26 @@ int32_t setQueryResultFromRsp(SReqResultInfo* pResultInfo, const SRetrieveTableR
   pResultInfo->payloadLen = htonl(pRsp->compLen);
   pResultInfo->precision = pRsp->precision;
 
-  // TODO handle the compressed case
+  if (pRsp->compressed && pResultInfo->numOfRows > 0) {
+    int32_t len = blockGetDecompressSize(pRsp->data);
+    if (len > pResultInfo->decompBufSize) {
+      char* p = taosMemoryRealloc(pResultInfo->decompBuf, len);
+      if (p == NULL) {
+        return TSDB_CODE_OUT_OF_MEMORY;
+      }
+      pResultInfo->decompBuf = p;
+      pResultInfo->decompBufSize = len;
+    }
+
+    if (blockDecompressEncode(pRsp->data, pResultInfo->decompBuf) < 0) {
+      tscError("failed to decompress the result block since %s", terrstr());
+      return terrno;
+    }
+
+    pResultInfo->pData = pResultInfo->decompBuf;
+    pResultInfo->payloadLen = len;
+  }
+
   pResultInfo->totalRows += pResultInfo->numOfRows;
   return setResultDataPtr(pResultInfo, pResultInfo->fields, pResultInfo->numOfCols, pResultInfo->numOfRows,
                           convertUcs4);
@@ -110,6 +110,7 @@ int32_t colDataAppend(SColumnInfoData* pColumnInfoData, uint32_t currentRow, con
 
     uint32_t len = pColumnInfoData->varmeta.length;
     pColumnInfoData->varmeta.offset[currentRow] = len;
+    pColumnInfoData->varmeta.dictSize = 0;
 
     memcpy(pColumnInfoData->pData + len, pData, dataLen);
     pColumnInfoData->varmeta.length += dataLen;
@@ -172,6 +173,7 @@ static void doCopyNItems(struct SColumnInfoData* pColumnInfoData, int32_t curren
     }
 
     pColumnInfoData->varmeta.length += numOfRows * itemLen;
+    pColumnInfoData->varmeta.dictSize = 0;
   }
 }
 
@@ -283,6 +285,7 @@ int32_t colDataMergeCol(SColumnInfoData* pColumnInfoData, int32_t numOfRow1, int
       memcpy(pColumnInfoData->pData + oldLen, pSource->pData, len);
     }
     pColumnInfoData->varmeta.length = len + oldLen;
+    pColumnInfoData->varmeta.dictSize = 0;
   } else {
     if (finalNumOfRows > (*capacity)) {
       // all data may be null, when the pColumnInfoData->info.type == 0, bytes == 0;
@@ -341,6 +344,15 @@ int32_t colDataAssign(SColumnInfoData* pColumnInfoData, const SColumnInfoData* p
     if (pColumnInfoData->pData != NULL && pSource->pData != NULL) {
       memcpy(pColumnInfoData->pData, pSource->pData, pSource->varmeta.length);
     }
+
+    pColumnInfoData->varmeta.dictSize = 0;
+    if (colDataHasDict(pSource)) {
+      int32_t code = colDataSetDict(pColumnInfoData, pSource->varmeta.dictSize, numOfRows);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+      memcpy(pColumnInfoData->varmeta.dictCode, pSource->varmeta.dictCode, sizeof(int16_t) * numOfRows);
+    }
   } else {
     memcpy(pColumnInfoData->nullbitmap, pSource->nullbitmap, BitmapLen(numOfRows));
     if (pSource->pData != NULL) {
@@ -612,6 +624,7 @@ int32_t blockDataFromBuf(SSDataBlock* pBlock, const char* buf) {
       }
 
       pCol->varmeta.length = colLength;
+      pCol->varmeta.dictSize = 0;
       ASSERT(pCol->varmeta.length <= pCol->varmeta.allocLen);
     }
 
@@ -659,6 +672,7 @@ int32_t blockDataFromBuf1(SSDataBlock* pBlock, const char* buf, size_t capacity)
       }
 
       pCol->varmeta.length = colLength;
+      pCol->varmeta.dictSize = 0;
       ASSERT(pCol->varmeta.length <= pCol->varmeta.allocLen);
     }
 
@@ -825,6 +839,12 @@ static int32_t blockDataAssign(SColumnInfoData* pCols, const SSDataBlock* pDataB
       for (int32_t j = 0; j < pDataBlock->info.rows; ++j) {
         pDst->varmeta.offset[j] = pSrc->varmeta.offset[index[j]];
       }
+
+      if (pDst->varmeta.dictCode != NULL) {
+        for (int32_t j = 0; j < pDataBlock->info.rows; ++j) {
+          pDst->varmeta.dictCode[j] = pSrc->varmeta.dictCode[index[j]];
+        }
+      }
     } else {
       for (int32_t j = 0; j < pDataBlock->info.rows; ++j) {
         if (colDataIsNull_f(pSrc->nullbitmap, index[j])) {
@@ -858,6 +878,12 @@ static SColumnInfoData* createHelpColInfoData(const SSDataBlock* pDataBlock) {
 
       pCols[i].varmeta.length = pColInfoData->varmeta.length;
       pCols[i].varmeta.allocLen = pCols[i].varmeta.length;
+
+      // the rows keep sharing the dictionary values, only the codes follow the rows
+      if (colDataHasDict(pColInfoData)) {
+        pCols[i].varmeta.dictCode = taosMemoryCalloc(rows, sizeof(int16_t));
+        pCols[i].varmeta.dictSize = pColInfoData->varmeta.dictSize;
+      }
     } else {
       pCols[i].nullbitmap = taosMemoryCalloc(1, BitmapLen(rows));
       pCols[i].pData = taosMemoryCalloc(rows, pCols[i].info.bytes);
@@ -876,6 +902,7 @@ static void copyBackToBlock(SSDataBlock* pDataBlock, SColumnInfoData* pCols) {
 
     if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
       taosMemoryFreeClear(pColInfoData->varmeta.offset);
+      taosMemoryFreeClear(pColInfoData->varmeta.dictCode);
       pColInfoData->varmeta = pCols[i].varmeta;
     } else {
       taosMemoryFreeClear(pColInfoData->nullbitmap);
@@ -996,6 +1023,94 @@ int32_t blockDataSort(SSDataBlock* pDataBlock, SArray* pOrderInfo) {
   return TSDB_CODE_SUCCESS;
 }
 
+// rearrange the rows of the block so that the i-th row becomes the row index[i] of the original block
+int32_t blockDataReorder(SSDataBlock* pDataBlock, const int32_t* index) {
+  if (pDataBlock->info.rows <= 1) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SColumnInfoData* pCols = createHelpColInfoData(pDataBlock);
+  if (pCols == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return terrno;
+  }
+
+  blockDataAssign(pCols, pDataBlock, index);
+  copyBackToBlock(pDataBlock, pCols);
+  return TSDB_CODE_SUCCESS;
+}
+
+// copy the rows index[0], index[1], ... of pSrc into the first numOfRows rows of pDst, pSrc is left untouched.
+// pDst must have the capacity of numOfRows rows, the var data buffer of pDst grows on demand.
+int32_t colDataGather(SColumnInfoData* pDst, const SColumnInfoData* pSrc, const int32_t* index, int32_t numOfRows) {
+  pDst->hasNull = pSrc->hasNull;
+
+  if (IS_VAR_DATA_TYPE(pSrc->info.type)) {
+    pDst->varmeta.length = 0;
+    pDst->varmeta.dictSize = 0;
+    for (int32_t j = 0; j < numOfRows; ++j) {
+      if (colDataIsNull_var(pSrc, index[j])) {
+        colDataSetNull_var(pDst, j);
+        continue;
+      }
+
+      int32_t code = colDataAppend(pDst, j, colDataGetVarData(pSrc, index[j]), false);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t bytes = pSrc->info.bytes;
+  memset(pDst->nullbitmap, 0, BitmapLen(numOfRows));
+  for (int32_t j = 0; j < numOfRows; ++j) {
+    if (pSrc->hasNull && colDataIsNull_f(pSrc->nullbitmap, index[j])) {
+      colDataSetNull_f(pDst->nullbitmap, j);
+      continue;
+    }
+
+    memcpy(pDst->pData + j * bytes, pSrc->pData + index[j] * bytes, bytes);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// mark the first numOfRows rows of a var column as carrying dictSize dictionary codes, the caller fills the codes
+int32_t colDataSetDict(SColumnInfoData* pColumnInfoData, int32_t dictSize, uint32_t numOfRows) {
+  ASSERT(IS_VAR_DATA_TYPE(pColumnInfoData->info.type) && dictSize > 0 && dictSize <= INT16_MAX + 1);
+
+  int16_t* p = taosMemoryRealloc(pColumnInfoData->varmeta.dictCode, sizeof(int16_t) * TMAX(numOfRows, 1));
+  if (p == NULL) {
+    pColumnInfoData->varmeta.dictSize = 0;
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pColumnInfoData->varmeta.dictCode = p;
+  pColumnInfoData->varmeta.dictSize = dictSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+// keep the rows of a dictionary column whose pKeep flag is set, in place and without moving any value.
+int32_t colDataKeepDictRows(SColumnInfoData* pColumnInfoData, const int8_t* pKeep, int32_t numOfRows) {
+  ASSERT(colDataHasDict(pColumnInfoData));
+
+  SVarColAttr* pAttr = &pColumnInfoData->varmeta;
+  int32_t      n = 0;
+  for (int32_t j = 0; j < numOfRows; ++j) {
+    if (pKeep[j] == 0) {
+      continue;
+    }
+
+    pAttr->offset[n] = pAttr->offset[j];
+    pAttr->dictCode[n] = pAttr->dictCode[j];
+    n += 1;
+  }
+
+  return n;
+}
+
 typedef struct SHelper {
   int32_t index;
   union {
@@ -1186,6 +1301,15 @@ static int32_t doEnsureCapacity(SColumnInfoData* pColumn, const SDataBlockInfo*
 
     pColumn->varmeta.offset = (int32_t*)tmp;
     memset(&pColumn->varmeta.offset[existedRows], 0, sizeof(int32_t) * (numOfRows - existedRows));
+
+    if (pColumn->varmeta.dictCode != NULL) {
+      tmp = taosMemoryRealloc(pColumn->varmeta.dictCode, sizeof(int16_t) * numOfRows);
+      if (tmp == NULL) {
+        return TSDB_CODE_OUT_OF_MEMORY;
+      }
+
+      pColumn->varmeta.dictCode = (int16_t*)tmp;
+    }
   } else {
     // prepare for the null bitmap
     char* tmp = taosMemoryRealloc(pColumn->nullbitmap, BitmapLen(numOfRows));
@@ -1230,6 +1354,7 @@ void  colInfoDataCleanup(SColumnInfoData* pColumn, uint32_t numOfRows) {
 
   if (IS_VAR_DATA_TYPE(pColumn->info.type)) {
     pColumn->varmeta.length = 0;
+    pColumn->varmeta.dictSize = 0;
     if (pColumn->varmeta.offset != NULL) {
       memset(pColumn->varmeta.offset, 0, sizeof(int32_t) * numOfRows);
     }
@@ -1573,6 +1698,8 @@ void colDataDestroy(SColumnInfoData* pColData) {
   if (!pColData) return;
   if (IS_VAR_DATA_TYPE(pColData->info.type)) {
     taosMemoryFreeClear(pColData->varmeta.offset);
+    taosMemoryFreeClear(pColData->varmeta.dictCode);
+    pColData->varmeta.dictSize = 0;
   } else {
     taosMemoryFreeClear(pColData->nullbitmap);
   }
@@ -1653,7 +1780,11 @@ static int32_t colDataMoveVarData(SColumnInfoData* pColInfoData, size_t start, s
 }
 
 static void colDataTrimFirstNRows(SColumnInfoData* pColInfoData, size_t n, size_t total) {
-  if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
+  if (colDataHasDict(pColInfoData)) {
+    // the rows share the dictionary values, so the values stay where they are
+    memmove(pColInfoData->varmeta.offset, &pColInfoData->varmeta.offset[n], (total - n) * sizeof(int32_t));
+    memmove(pColInfoData->varmeta.dictCode, &pColInfoData->varmeta.dictCode[n], (total - n) * sizeof(int16_t));
+  } else if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
     pColInfoData->varmeta.length = colDataMoveVarData(pColInfoData, n, total);
 
     // clear the offset value of the unused entries.
@@ -1685,7 +1816,9 @@ int32_t blockDataTrimFirstNRows(SSDataBlock* pBlock, size_t n) {
 }
 
 static void colDataKeepFirstNRows(SColumnInfoData* pColInfoData, size_t n, size_t total) {
-  if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
+  if (colDataHasDict(pColInfoData)) {
+    // the kept rows may refer to any dictionary value, the value buffer is left as it is
+  } else if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
     pColInfoData->varmeta.length = colDataMoveVarData(pColInfoData, 0, n);
     memset(&pColInfoData->varmeta.offset[n], 0, total - n);
   } else {  // reset the bitmap value
@@ -2345,12 +2478,193 @@ int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
   return dataLen;
 }
 
+// compressed segment: | flag(int8_t) | length(int32_t) | data |, the data is kept raw if it can not be compressed
+static int32_t blockCompressSeg(int8_t type, const char* pIn, int32_t rawLen, int32_t nEle, char* pOut) {
+  int8_t*  flag = (int8_t*)pOut;
+  int32_t* len = (int32_t*)(pOut + sizeof(int8_t));
+  char*    data = pOut + sizeof(int8_t) + sizeof(int32_t);
+
+  // bool is compressed as tinyint, since the value of a null bool is not defined
+  if (type == TSDB_DATA_TYPE_BOOL) type = TSDB_DATA_TYPE_TINYINT;
+
+  int32_t cmprLen = -1;
+  if (tDataTypes[type].compFunc != NULL) {
+    cmprLen = tDataTypes[type].compFunc((void*)pIn, rawLen, nEle, data, rawLen + COMP_OVERFLOW_BYTES, ONE_STAGE_COMP,
+                                        NULL, 0);
+  }
+
+  if (cmprLen <= 0 || cmprLen >= rawLen) {
+    *flag = NO_COMPRESSION;
+    *len = rawLen;
+    memcpy(data, pIn, rawLen);
+  } else {
+    *flag = ONE_STAGE_COMP;
+    *len = cmprLen;
+  }
+
+  return sizeof(int8_t) + sizeof(int32_t) + *len;
+}
+
+static const char* blockDecompressSeg(int8_t type, const char* pIn, char* pOut, int32_t rawLen, int32_t nEle) {
+  int8_t  flag = *(int8_t*)pIn;
+  int32_t len = *(int32_t*)(pIn + sizeof(int8_t));
+  pIn += sizeof(int8_t) + sizeof(int32_t);
+
+  if (type == TSDB_DATA_TYPE_BOOL) type = TSDB_DATA_TYPE_TINYINT;
+
+  if (flag == NO_COMPRESSION) {
+    if (len != rawLen) {
+      terrno = TSDB_CODE_INVALID_MSG;
+      return NULL;
+    }
+    memcpy(pOut, pIn, rawLen);
+  } else if (tDataTypes[type].decompFunc == NULL ||
+             tDataTypes[type].decompFunc((void*)pIn, len, nEle, pOut, rawLen, flag, NULL, 0) != rawLen) {
+    uError("failed to decompress column data, type:%d, len:%d, raw len:%d", type, len, rawLen);
+    terrno = TSDB_CODE_COMPRESS_ERROR;
+    return NULL;
+  }
+
+  return pIn + len;
+}
+
+// same as blockEncode, except that the offsets of var columns and the data of all columns are compressed by the codec
+// of their type, i.e. delta/simple8b for integers and timestamps, the float codecs, and lz4 for var data. The column
+// length segment still records the raw length of each column.
+int32_t blockCompressEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
+  char* pStart = data;
+
+  int32_t* version = (int32_t*)data;
+  *version = BLOCK_VERSION_COMPRESSED;
+  data += sizeof(int32_t);
+
+  int32_t* actualLen = (int32_t*)data;
+  data += sizeof(int32_t);
+
+  int32_t* rows = (int32_t*)data;
+  *rows = pBlock->info.rows;
+  data += sizeof(int32_t);
+  ASSERT(*rows > 0);
+
+  int32_t* cols = (int32_t*)data;
+  *cols = numOfCols;
+  data += sizeof(int32_t);
+
+  int32_t* flagSegment = (int32_t*)data;
+  *flagSegment = (1 << 31);
+  data += sizeof(int32_t);
+
+  uint64_t* groupId = (uint64_t*)data;
+  *groupId = pBlock->info.id.groupId;
+  data += sizeof(uint64_t);
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, i);
+
+    *((int8_t*)data) = pColInfoData->info.type;
+    data += sizeof(int8_t);
+
+    *((int32_t*)data) = pColInfoData->info.bytes;
+    data += sizeof(int32_t);
+  }
+
+  int32_t* colSizes = (int32_t*)data;
+  data += numOfCols * sizeof(int32_t);
+
+  int32_t numOfRows = pBlock->info.rows;
+  for (int32_t col = 0; col < numOfCols; ++col) {
+    SColumnInfoData* pColRes = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, col);
+
+    if (IS_VAR_DATA_TYPE(pColRes->info.type)) {
+      data += blockCompressSeg(TSDB_DATA_TYPE_INT, (const char*)pColRes->varmeta.offset, numOfRows * sizeof(int32_t),
+                               numOfRows, data);
+    } else {
+      memcpy(data, pColRes->nullbitmap, BitmapLen(numOfRows));
+      data += BitmapLen(numOfRows);
+    }
+
+    int32_t colSize = colDataGetLength(pColRes, numOfRows);
+    if (colSize > 0 && pColRes->pData != NULL) {
+      data += blockCompressSeg(pColRes->info.type, pColRes->pData, colSize, numOfRows, data);
+    } else {
+      colSize = 0;
+    }
+
+    colSizes[col] = htonl(colSize);
+  }
+
+  *actualLen = data - pStart;
+
+  uDebug("build compressed data block, actualLen:%d, rows:%d, cols:%d", *actualLen, *rows, *cols);
+  return *actualLen;
+}
+
+// the length of the block encoded by blockEncode, which the compressed block will be restored to
+int32_t blockGetDecompressSize(const char* pData) {
+  int32_t numOfRows = *(int32_t*)(pData + sizeof(int32_t) * 2);
+  int32_t numOfCols = *(int32_t*)(pData + sizeof(int32_t) * 3);
+
+  const char*    pSchema = pData + sizeof(int32_t) * 5 + sizeof(uint64_t);
+  const int32_t* colLen = (const int32_t*)(pSchema + numOfCols * (sizeof(int8_t) + sizeof(int32_t)));
+
+  int32_t len = blockDataGetSerialMetaSize(numOfCols);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int8_t type = *(int8_t*)(pSchema + i * (sizeof(int8_t) + sizeof(int32_t)));
+    len += IS_VAR_DATA_TYPE(type) ? numOfRows * sizeof(int32_t) : BitmapLen(numOfRows);
+    len += htonl(colLen[i]);
+  }
+
+  return len;
+}
+
+// restore a block encoded by blockCompressEncode to the layout of blockEncode, pOut has blockGetDecompressSize bytes
+int32_t blockDecompressEncode(const char* pData, char* pOut) {
+  int32_t numOfRows = *(int32_t*)(pData + sizeof(int32_t) * 2);
+  int32_t numOfCols = *(int32_t*)(pData + sizeof(int32_t) * 3);
+  int32_t metaSize = blockDataGetSerialMetaSize(numOfCols);
+
+  ASSERT(*(int32_t*)pData == BLOCK_VERSION_COMPRESSED);
+
+  memcpy(pOut, pData, metaSize);
+  *(int32_t*)pOut = BLOCK_VERSION_1;
+
+  const char*    pSchema = pData + sizeof(int32_t) * 5 + sizeof(uint64_t);
+  const int32_t* colLen = (const int32_t*)(pSchema + numOfCols * (sizeof(int8_t) + sizeof(int32_t)));
+  const char*    pStart = pData + metaSize;
+  char*          p = pOut + metaSize;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int8_t  type = *(int8_t*)(pSchema + i * (sizeof(int8_t) + sizeof(int32_t)));
+    int32_t len = htonl(colLen[i]);
+
+    if (IS_VAR_DATA_TYPE(type)) {
+      pStart = blockDecompressSeg(TSDB_DATA_TYPE_INT, pStart, p, numOfRows * sizeof(int32_t), numOfRows);
+      if (pStart == NULL) return -1;
+      p += numOfRows * sizeof(int32_t);
+    } else {
+      memcpy(p, pStart, BitmapLen(numOfRows));
+      pStart += BitmapLen(numOfRows);
+      p += BitmapLen(numOfRows);
+    }
+
+    if (len > 0) {
+      pStart = blockDecompressSeg(type, pStart, p, len, numOfRows);
+      if (pStart == NULL) return -1;
+      p += len;
+    }
+  }
+
+  *(int32_t*)(pOut + sizeof(int32_t)) = p - pOut;
+  return p - pOut;
+}
+
 const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
   const char* pStart = pData;
 
   int32_t version = *(int32_t*)pStart;
   pStart += sizeof(int32_t);
-  ASSERT(version == 1);
+  ASSERT(version == BLOCK_VERSION_1 || version == BLOCK_VERSION_COMPRESSED);
+  bool compressed = (version == BLOCK_VERSION_COMPRESSED);
 
   // total length sizeof(int32_t)
   int32_t dataLen = *(int32_t*)pStart;
@@ -2402,8 +2716,16 @@ const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
 
     SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, i);
     if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
-      memcpy(pColInfoData->varmeta.offset, pStart, sizeof(int32_t) * numOfRows);
-      pStart += sizeof(int32_t) * numOfRows;
+      if (compressed) {
+        pStart = blockDecompressSeg(TSDB_DATA_TYPE_INT, pStart, (char*)pColInfoData->varmeta.offset,
+                                    sizeof(int32_t) * numOfRows, numOfRows);
+        if (pStart == NULL) {
+          return NULL;
+        }
+      } else {
+        memcpy(pColInfoData->varmeta.offset, pStart, sizeof(int32_t) * numOfRows);
+        pStart += sizeof(int32_t) * numOfRows;
+      }
 
       if (colLen[i] > 0 && pColInfoData->varmeta.allocLen < colLen[i]) {
         char* tmp = taosMemoryRealloc(pColInfoData->pData, colLen[i]);
@@ -2416,20 +2738,26 @@ const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
       }
 
       pColInfoData->varmeta.length = colLen[i];
+      pColInfoData->varmeta.dictSize = 0;
     } else {
       memcpy(pColInfoData->nullbitmap, pStart, BitmapLen(numOfRows));
       pStart += BitmapLen(numOfRows);
     }
 
-    if (colLen[i] > 0) {
+    if (colLen[i] > 0 && compressed) {
+      pStart = blockDecompressSeg(pColInfoData->info.type, pStart, pColInfoData->pData, colLen[i], numOfRows);
+      if (pStart == NULL) {
+        return NULL;
+      }
+    } else if (colLen[i] > 0) {
       memcpy(pColInfoData->pData, pStart, colLen[i]);
+      pStart += colLen[i];
     }
 
     // TODO
     // setting this flag to true temporarily so aggregate function on stable will
     // examine NULL value for non-primary key column
     pColInfoData->hasNull = true;
-    pStart += colLen[i];
   }
 
   pBlock->info.dataLoad = 1;
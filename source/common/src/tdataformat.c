@@ -1215,6 +1215,7 @@ void tColDataDestroy(void *ph) {
   tFree(pColData->pBitMap);
   tFree((uint8_t *)pColData->aOffset);
   tFree(pColData->pData);
+  tFree((uint8_t *)pColData->aDictCode);
 }
 
 void tColDataInit(SColData *pColData, int16_t cid, int8_t type, int8_t smaOn) {
@@ -1228,6 +1229,7 @@ void tColDataClear(SColData *pColData) {
   pColData->nVal = 0;
   pColData->flag = 0;
   pColData->nData = 0;
+  pColData->nDict = 0;
 }
 
 static FORCE_INLINE int32_t tColDataPutValue(SColData *pColData, SColVal *pColVal) {
@@ -1563,6 +1565,7 @@ static int32_t (*tColDataAppendValueImpl[8][3])(SColData *pColData, SColVal *pCo
 };
 int32_t tColDataAppendValue(SColData *pColData, SColVal *pColVal) {
   ASSERT(pColData->cid == pColVal->cid && pColData->type == pColVal->type);
+  pColData->nDict = 0;
   return tColDataAppendValueImpl[pColData->flag][pColVal->flag](pColData, pColVal);
 }
 
@@ -1687,6 +1690,197 @@ uint8_t tColDataGetBitValue(const SColData *pColData, int32_t iVal) {
   return v;
 }
 
+#if __AVX2__
+static int32_t tColDataReverseCopyAVX2(const uint8_t *pSrc, int32_t nVal, int32_t bytes, uint8_t *pDst) {
+  const __m256i revIdx32 = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  const __m256i revIdx16 = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1, 14, 15, 12, 13, 10,
+                                            11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+  const __m256i revIdx8 = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11,
+                                           10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const int32_t width = sizeof(__m256i) / bytes;
+
+  // pSrc points to the last value to copy, move backward 32 bytes a round
+  int32_t i = 0;
+  for (; i + width <= nVal; i += width) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(pSrc - (i + width - 1) * bytes));
+    switch (bytes) {
+      case sizeof(int64_t):
+        v = _mm256_permute4x64_epi64(v, 0x1B);
+        break;
+      case sizeof(int32_t):
+        v = _mm256_permutevar8x32_epi32(v, revIdx32);
+        break;
+      case sizeof(int16_t):
+        v = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, revIdx16), 0x4E);
+        break;
+      default:
+        v = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, revIdx8), 0x4E);
+        break;
+    }
+    _mm256_storeu_si256((__m256i *)(pDst + i * bytes), v);
+  }
+
+  return i;
+}
+#endif
+
+#define COPY_REVERSE(TYPE, SRC, DST, START, N)                  \
+  do {                                                          \
+    const TYPE *s = (const TYPE *)(SRC);                        \
+    TYPE       *d = (TYPE *)(DST);                              \
+    for (int32_t j = (START); j < (N); j++) d[j] = s[-j];       \
+  } while (0)
+
+// copy nVal values of a fixed length column to pDst. In ascending order the values are [iVal, iVal + nVal), otherwise
+// they are iVal, iVal - 1, ..., iVal - nVal + 1, so the copy is reversed on the fly instead of by a second pass.
+void tColDataCopyFixedValues(const SColData *pColData, int32_t iVal, int32_t nVal, bool asc, void *pDst) {
+  int32_t bytes = tDataTypes[pColData->type].bytes;
+
+  ASSERT(IS_VAR_DATA_TYPE(pColData->type) == false);
+
+  if (asc) {
+    memcpy(pDst, pColData->pData + iVal * bytes, nVal * bytes);
+    return;
+  }
+
+  const uint8_t *pSrc = pColData->pData + iVal * bytes;
+  int32_t        i = 0;
+
+#if __AVX2__
+  if (tsAVX2Enable && tsSIMDBuiltins) {
+    i = tColDataReverseCopyAVX2(pSrc, nVal, bytes, pDst);
+  }
+#endif
+
+  switch (bytes) {
+    case sizeof(int64_t):
+      COPY_REVERSE(int64_t, pSrc, pDst, i, nVal);
+      break;
+    case sizeof(int32_t):
+      COPY_REVERSE(int32_t, pSrc, pDst, i, nVal);
+      break;
+    case sizeof(int16_t):
+      COPY_REVERSE(int16_t, pSrc, pDst, i, nVal);
+      break;
+    case sizeof(int8_t):
+      COPY_REVERSE(int8_t, pSrc, pDst, i, nVal);
+      break;
+    default:
+      for (; i < nVal; i++) {
+        memcpy((uint8_t *)pDst + i * bytes, pSrc - i * bytes, bytes);
+      }
+      break;
+  }
+}
+
+// reverse the bits of each byte in a word
+static FORCE_INLINE uint64_t tBitReverseBytes(uint64_t x) {
+  x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+  x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+  x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  return x;
+}
+
+// reverse the bytes of a word
+static FORCE_INLINE uint64_t tByteReverse(uint64_t x) {
+  x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+  x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+  x = (x >> 32) | (x << 32);
+  return x;
+}
+
+// bits [iBit, iBit + nBit) of a little endian bitmap, nBit <= 64
+static FORCE_INLINE uint64_t tGetBits(const uint8_t *p, int32_t iBit, int32_t nBit) {
+  const uint8_t *q = p + (iBit >> 3);
+  int32_t        shift = iBit & 7;
+  int32_t        nByte = (shift + nBit + 7) >> 3;
+  uint64_t       v = 0;
+
+  memcpy(&v, q, TMIN(nByte, (int32_t)sizeof(v)));
+  v >>= shift;
+  if (nByte > (int32_t)sizeof(v)) {
+    v |= ((uint64_t)q[sizeof(v)]) << (64 - shift);
+  }
+
+  return (nBit < 64) ? (v & ((1ULL << nBit) - 1)) : v;
+}
+
+// keep the high bit of each 2-bit value in a word, 32 bits are left
+static FORCE_INLINE uint64_t tCompressBit2High(uint64_t x) {
+  x = (x >> 1) & 0x5555555555555555ULL;
+  x = (x | (x >> 1)) & 0x3333333333333333ULL;
+  x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+  x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+  x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+  return x;
+}
+
+// bit k is set if value iVal + k is NONE or NULL, nVal <= 64
+static uint64_t tColDataGetNullBits(const SColData *pColData, int32_t iVal, int32_t nVal) {
+  uint64_t mask = (nVal < 64) ? ((1ULL << nVal) - 1) : UINT64_MAX;
+  uint64_t v = 0;
+
+  switch (pColData->flag) {
+    case HAS_NONE:
+    case HAS_NULL:
+    case (HAS_NULL | HAS_NONE):
+      v = mask;
+      break;
+    case HAS_VALUE:
+      v = 0;
+      break;
+    case (HAS_VALUE | HAS_NONE):
+    case (HAS_VALUE | HAS_NULL):
+      v = ~tGetBits(pColData->pBitMap, iVal, nVal) & mask;
+      break;
+    case (HAS_VALUE | HAS_NULL | HAS_NONE): {
+      int32_t n = TMIN(nVal, 32);
+      v = tCompressBit2High(tGetBits(pColData->pBitMap, iVal << 1, n << 1));
+      if (nVal > n) {
+        v |= tCompressBit2High(tGetBits(pColData->pBitMap, (iVal + n) << 1, (nVal - n) << 1)) << 32;
+      }
+      v = ~v & mask;
+    } break;
+    default:
+      ASSERT(0);
+      break;
+  }
+
+  return v;
+}
+
+// set the null bits of nVal values, ordered as in tColDataCopyFixedValues(), into the nullbitmap of SColumnInfoData,
+// 64 values a round. Return true if any of them is NONE or NULL.
+bool tColDataGetNullBitmap(const SColData *pColData, int32_t iVal, int32_t nVal, bool asc, char *nullbitmap) {
+  bool hasNull = false;
+
+  if (pColData->flag == HAS_VALUE) return hasNull;
+
+  for (int32_t i = 0; i < nVal; i += 64) {
+    int32_t  n = TMIN(nVal - i, 64);
+    uint64_t v;
+
+    if (asc) {
+      v = tBitReverseBytes(tColDataGetNullBits(pColData, iVal + i, n));
+    } else {
+      // bit k of the word is value (iVal - i - k)
+      v = tColDataGetNullBits(pColData, iVal - i - n + 1, n);
+      v = tByteReverse(tBitReverseBytes(v)) >> (64 - n);
+      v = tBitReverseBytes(v);
+    }
+
+    if (v == 0) continue;
+
+    hasNull = true;
+    for (int32_t iByte = 0; iByte < ((n + 7) >> 3); iByte++) {
+      nullbitmap[(i >> 3) + iByte] |= (char)((v >> (iByte << 3)) & 0xFF);
+    }
+  }
+
+  return hasNull;
+}
+
 int32_t tColDataCopy(SColData *pColDataSrc, SColData *pColDataDest) {
   int32_t code = 0;
   int32_t size;
@@ -1723,6 +1917,17 @@ int32_t tColDataCopy(SColData *pColDataSrc, SColData *pColDataDest) {
   if (code) goto _exit;
   memcpy(pColDataDest->pData, pColDataSrc->pData, pColDataDest->nData);
 
+  // dictionary codes
+  pColDataDest->nDict = pColDataSrc->nDict;
+  if (pColDataSrc->nDict > 0) {
+    size = sizeof(int16_t) * pColDataSrc->nVal;
+
+    code = tRealloc((uint8_t **)&pColDataDest->aDictCode, size);
+    if (code) goto _exit;
+
+    memcpy(pColDataDest->aDictCode, pColDataSrc->aDictCode, size);
+  }
+
 _exit:
   return code;
 }
@@ -50,15 +50,18 @@ int32_t tsNumOfVnodeQueryThreads = 4;
 float   tsRatioOfVnodeStreamThreads = 1.0;
 int32_t tsNumOfVnodeFetchThreads = 4;
 int32_t tsNumOfVnodeRsmaThreads = 2;
+int32_t tsNumOfVnodeInsertThreads = 2;
 int32_t tsNumOfQnodeQueryThreads = 4;
 int32_t tsNumOfQnodeFetchThreads = 1;
 int32_t tsNumOfSnodeStreamThreads = 4;
 int32_t tsNumOfSnodeWriteThreads = 1;
+int32_t tsNumOfSortThreads = 4;
 
 // sync raft
 int32_t tsElectInterval = 25 * 1000;
 int32_t tsHeartbeatInterval = 1000;
 int32_t tsHeartbeatTimeout = 20 * 1000;
+bool    tsSyncBatchAppendEntries = false;  // enable only after all dnodes are upgraded
 
 // monitor
 bool     tsEnableMonitor = true;
@@ -108,7 +111,8 @@ bool    tsUseAdapter = false;
  */
 int32_t tsCompressMsgSize = -1;
 
-/* denote if server needs to compress the retrieved column data before adding to the rpc response message body.
+/* denote if server needs to compress the retrieved column data before adding to the rpc response message body,
+ * and the data blocks dispatched between stream tasks.
  * 0: all data are compressed
  * -1: all data are not compressed
  * other values: if any retrieved column size is greater than the tsCompressColData, all data will be compressed.
@@ -144,7 +148,8 @@ int32_t  tsDiskCfgNum = 0;
 SDiskCfg tsDiskCfg[TFS_MAX_DISKS] = {0};
 
 // stream scheduler
-bool tsDeployOnSnode = true;
+bool    tsDeployOnSnode = true;
+int32_t tsStreamCheckpointInterval = 60;  // seconds between the checkpoints of a stream
 
 /*
  * minimum scale for whole system, millisecond by default
@@ -170,6 +175,17 @@ bool tsStartUdfd = true;
 // wal
 int64_t tsWalFsyncDataSizeLimit = (100 * 1024 * 1024L);
 
+// tsdb
+int32_t tsCompactIoBudget = 0;        // MB/s written by compaction, 0 means unlimited
+int32_t tsTsdbPageCacheSize = 16;     // MB of data file pages cached per vnode, 0 means disabled
+int32_t tsTsdbPrefetchBlocks = 8;     // data blocks read ahead by a query, 0 means disabled
+bool    tsTsdbSttBloomFilter = true;  // write uid bloom filters into new stt files
+
+// meta
+int32_t tsMetaWalSize = 0;             // MB of the meta redo log before a checkpoint, 0 means the rollback journal
+int32_t tsMetaTagTableCacheSize = 64;  // MB of the columnar tags cached per vnode, 0 means disabled
+int32_t tsMetaSkmCacheSize = 16;       // MB of the table schemas cached per vnode, beyond the acquired ones
+
 // internal
 int32_t tsTransPullupInterval = 2;
 int32_t tsMqRebalanceInterval = 2;
@@ -402,6 +418,10 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   tsNumOfVnodeRsmaThreads = TMAX(tsNumOfVnodeRsmaThreads, 4);
   if (cfgAddInt32(pCfg, "numOfVnodeRsmaThreads", tsNumOfVnodeRsmaThreads, 1, 1024, 0) != 0) return -1;
 
+  tsNumOfVnodeInsertThreads = tsNumOfCores / 4;
+  tsNumOfVnodeInsertThreads = TRANGE(tsNumOfVnodeInsertThreads, 1, 8);
+  if (cfgAddInt32(pCfg, "numOfVnodeInsertThreads", tsNumOfVnodeInsertThreads, 0, 1024, 0) != 0) return -1;
+
   tsNumOfQnodeQueryThreads = tsNumOfCores * 2;
   tsNumOfQnodeQueryThreads = TMAX(tsNumOfQnodeQueryThreads, 4);
   if (cfgAddInt32(pCfg, "numOfQnodeQueryThreads", tsNumOfQnodeQueryThreads, 4, 1024, 0) != 0) return -1;
@@ -418,6 +438,10 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   tsNumOfSnodeWriteThreads = TRANGE(tsNumOfSnodeWriteThreads, 2, 4);
   if (cfgAddInt32(pCfg, "numOfSnodeUniqueThreads", tsNumOfSnodeWriteThreads, 2, 1024, 0) != 0) return -1;
 
+  tsNumOfSortThreads = tsNumOfCores / 2;
+  tsNumOfSortThreads = TRANGE(tsNumOfSortThreads, 1, 16);
+  if (cfgAddInt32(pCfg, "numOfSortThreads", tsNumOfSortThreads, 0, 1024, 0) != 0) return -1;
+
   tsRpcQueueMemoryAllowed = tsTotalMemoryKB * 1024 * 0.1;
   tsRpcQueueMemoryAllowed = TRANGE(tsRpcQueueMemoryAllowed, TSDB_MAX_MSG_SIZE * 10LL, TSDB_MAX_MSG_SIZE * 10000LL);
   if (cfgAddInt64(pCfg, "rpcQueueMemoryAllowed", tsRpcQueueMemoryAllowed, TSDB_MAX_MSG_SIZE * 10L, INT64_MAX, 0) != 0)
@@ -426,6 +450,7 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   if (cfgAddInt32(pCfg, "syncElectInterval", tsElectInterval, 10, 1000 * 60 * 24 * 2, 0) != 0) return -1;
   if (cfgAddInt32(pCfg, "syncHeartbeatInterval", tsHeartbeatInterval, 10, 1000 * 60 * 24 * 2, 0) != 0) return -1;
   if (cfgAddInt32(pCfg, "syncHeartbeatTimeout", tsHeartbeatTimeout, 10, 1000 * 60 * 24 * 2, 0) != 0) return -1;
+  if (cfgAddBool(pCfg, "syncBatchAppendEntries", tsSyncBatchAppendEntries, 0) != 0) return -1;
 
   if (cfgAddBool(pCfg, "monitor", tsEnableMonitor, 0) != 0) return -1;
   if (cfgAddInt32(pCfg, "monitorInterval", tsMonitorInterval, 1, 200000, 0) != 0) return -1;
@@ -448,6 +473,14 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
 
   if (cfgAddInt64(pCfg, "walFsyncDataSizeLimit", tsWalFsyncDataSizeLimit, 100 * 1024 * 1024, INT64_MAX, 0) != 0)
     return -1;
+  if (cfgAddInt32(pCfg, "compactIoBudget", tsCompactIoBudget, 0, 100000, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbPageCacheSize", tsTsdbPageCacheSize, 0, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbPrefetchBlocks", tsTsdbPrefetchBlocks, 0, 1024, 0) != 0) return -1;
+  if (cfgAddBool(pCfg, "tsdbSttBloomFilter", tsTsdbSttBloomFilter, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "metaWalSize", tsMetaWalSize, 0, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "metaTagTableCacheSize", tsMetaTagTableCacheSize, 0, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "metaSkmCacheSize", tsMetaSkmCacheSize, 0, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "streamCheckpointInterval", tsStreamCheckpointInterval, 1, 86400, 0) != 0) return -1;
 
   if (cfgAddBool(pCfg, "udf", tsStartUdfd, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdResFuncs", tsUdfdResFuncs, 0) != 0) return -1;
@@ -533,6 +566,14 @@ static int32_t taosUpdateServerCfg(SConfig *pCfg) {
     pItem->stype = stype;
   }
 
+  pItem = cfgGetItem(tsCfg, "numOfVnodeInsertThreads");
+  if (pItem != NULL && pItem->stype == CFG_STYPE_DEFAULT) {
+    tsNumOfVnodeInsertThreads = numOfCores / 4;
+    tsNumOfVnodeInsertThreads = TRANGE(tsNumOfVnodeInsertThreads, 1, 8);
+    pItem->i32 = tsNumOfVnodeInsertThreads;
+    pItem->stype = stype;
+  }
+
   pItem = cfgGetItem(tsCfg, "numOfQnodeQueryThreads");
   if (pItem != NULL && pItem->stype == CFG_STYPE_DEFAULT) {
     tsNumOfQnodeQueryThreads = numOfCores * 2;
@@ -567,6 +608,14 @@ static int32_t taosUpdateServerCfg(SConfig *pCfg) {
     pItem->stype = stype;
   }
 
+  pItem = cfgGetItem(tsCfg, "numOfSortThreads");
+  if (pItem != NULL && pItem->stype == CFG_STYPE_DEFAULT) {
+    tsNumOfSortThreads = numOfCores / 2;
+    tsNumOfSortThreads = TRANGE(tsNumOfSortThreads, 1, 16);
+    pItem->i32 = tsNumOfSortThreads;
+    pItem->stype = stype;
+  }
+
   pItem = cfgGetItem(tsCfg, "totalMemoryKB");
   if (pItem == NULL) {
     return -1;
@@ -709,10 +758,12 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsRatioOfVnodeStreamThreads = cfgGetItem(pCfg, "ratioOfVnodeStreamThreads")->fval;
   tsNumOfVnodeFetchThreads = cfgGetItem(pCfg, "numOfVnodeFetchThreads")->i32;
   tsNumOfVnodeRsmaThreads = cfgGetItem(pCfg, "numOfVnodeRsmaThreads")->i32;
+  tsNumOfVnodeInsertThreads = cfgGetItem(pCfg, "numOfVnodeInsertThreads")->i32;
   tsNumOfQnodeQueryThreads = cfgGetItem(pCfg, "numOfQnodeQueryThreads")->i32;
   //  tsNumOfQnodeFetchThreads = cfgGetItem(pCfg, "numOfQnodeFetchThreads")->i32;
   tsNumOfSnodeStreamThreads = cfgGetItem(pCfg, "numOfSnodeSharedThreads")->i32;
   tsNumOfSnodeWriteThreads = cfgGetItem(pCfg, "numOfSnodeUniqueThreads")->i32;
+  tsNumOfSortThreads = cfgGetItem(pCfg, "numOfSortThreads")->i32;
   tsRpcQueueMemoryAllowed = cfgGetItem(pCfg, "rpcQueueMemoryAllowed")->i64;
 
   tsSIMDBuiltins = (bool) cfgGetItem(pCfg, "SIMD-builtins")->bval;
@@ -738,10 +789,19 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsQueryRsmaTolerance = cfgGetItem(pCfg, "queryRsmaTolerance")->i32;
 
   tsWalFsyncDataSizeLimit = cfgGetItem(pCfg, "walFsyncDataSizeLimit")->i64;
+  tsCompactIoBudget = cfgGetItem(pCfg, "compactIoBudget")->i32;
+  tsTsdbPageCacheSize = cfgGetItem(pCfg, "tsdbPageCacheSize")->i32;
+  tsTsdbPrefetchBlocks = cfgGetItem(pCfg, "tsdbPrefetchBlocks")->i32;
+  tsTsdbSttBloomFilter = cfgGetItem(pCfg, "tsdbSttBloomFilter")->bval;
+  tsMetaWalSize = cfgGetItem(pCfg, "metaWalSize")->i32;
+  tsMetaTagTableCacheSize = cfgGetItem(pCfg, "metaTagTableCacheSize")->i32;
+  tsMetaSkmCacheSize = cfgGetItem(pCfg, "metaSkmCacheSize")->i32;
+  tsStreamCheckpointInterval = cfgGetItem(pCfg, "streamCheckpointInterval")->i32;
 
   tsElectInterval = cfgGetItem(pCfg, "syncElectInterval")->i32;
   tsHeartbeatInterval = cfgGetItem(pCfg, "syncHeartbeatInterval")->i32;
   tsHeartbeatTimeout = cfgGetItem(pCfg, "syncHeartbeatTimeout")->i32;
+  tsSyncBatchAppendEntries = cfgGetItem(pCfg, "syncBatchAppendEntries")->bval;
 
   tsStartUdfd = cfgGetItem(pCfg, "udf")->bval;
   tstrncpy(tsUdfdResFuncs, cfgGetItem(pCfg, "udfdResFuncs")->str, sizeof(tsUdfdResFuncs));
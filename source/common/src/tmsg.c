@@ -1011,8 +1011,8 @@ int32_t tSerializeSStatusReq(void *buf, int32_t bufLen, SStatusReq *pReq) {
     if (tEncodeI64(&encoder, pload->totalStorage) < 0) return -1;
     if (tEncodeI64(&encoder, pload->compStorage) < 0) return -1;
     if (tEncodeI64(&encoder, pload->pointsWritten) < 0) return -1;
-    if (tEncodeI64(&encoder, reserved) < 0) return -1;
-    if (tEncodeI64(&encoder, reserved) < 0) return -1;
+    if (tEncodeI64(&encoder, pload->compactNFSet) < 0) return -1;
+    if (tEncodeI64(&encoder, pload->compactNDone) < 0) return -1;
     if (tEncodeI64(&encoder, reserved) < 0) return -1;
   }
 
@@ -1089,8 +1089,11 @@ int32_t tDeserializeSStatusReq(void *buf, int32_t bufLen, SStatusReq *pReq) {
     if (tDecodeI64(&decoder, &vload.totalStorage) < 0) return -1;
     if (tDecodeI64(&decoder, &vload.compStorage) < 0) return -1;
     if (tDecodeI64(&decoder, &vload.pointsWritten) < 0) return -1;
+    // the compaction progress takes two of the reserved fields, which older dnodes send as 0
     if (tDecodeI64(&decoder, &reserved) < 0) return -1;
+    vload.compactNFSet = (int32_t)reserved;
     if (tDecodeI64(&decoder, &reserved) < 0) return -1;
+    vload.compactNDone = (int32_t)reserved;
     if (tDecodeI64(&decoder, &reserved) < 0) return -1;
     if (taosArrayPush(pReq->pVloads, &vload) == NULL) {
       terrno = TSDB_CODE_OUT_OF_MEMORY;
@@ -260,4 +260,188 @@ TEST(testCase, var_dataBlock_split_test) {
   }
 }
 
-#pragma GCC diagnostic pop
\ No newline at end of file
+#pragma GCC diagnostic pop
+
+TEST(testCase, colData_copy_reverse_test) {
+  int32_t  numOfRows = 1000;
+  SColData colData = {0};
+  tColDataInit(&colData, 2, TSDB_DATA_TYPE_BIGINT, 0);
+
+  // value, null, none in turn, so that the 2-bit map is used
+  for (int64_t i = 0; i < numOfRows; ++i) {
+    SColVal cv;
+    if (i % 3 == 1) {
+      cv = COL_VAL_NULL(2, TSDB_DATA_TYPE_BIGINT);
+    } else if (i % 3 == 2) {
+      cv = COL_VAL_NONE(2, TSDB_DATA_TYPE_BIGINT);
+    } else {
+      cv = COL_VAL_VALUE(2, TSDB_DATA_TYPE_BIGINT, (SValue){.val = i});
+    }
+    ASSERT_EQ(tColDataAppendValue(&colData, &cv), 0);
+  }
+  ASSERT_EQ(colData.flag, HAS_VALUE | HAS_NULL | HAS_NONE);
+
+  int64_t data[1000] = {0};
+  char    bitmap[BitmapLen(1000)] = {0};
+
+  for (int32_t k = 0; k < 2; ++k) {
+    bool    asc = (k == 0);
+    int32_t start = asc ? 7 : numOfRows - 5;
+    int32_t rows = 900;
+
+    memset(data, 0, sizeof(data));
+    memset(bitmap, 0, sizeof(bitmap));
+    tColDataCopyFixedValues(&colData, start, rows, asc, data);
+    ASSERT_TRUE(tColDataGetNullBitmap(&colData, start, rows, asc, bitmap));
+
+    for (int32_t r = 0; r < rows; ++r) {
+      int32_t iVal = asc ? start + r : start - r;
+      ASSERT_EQ(colDataIsNull_f(bitmap, r), tColDataGetBitValue(&colData, iVal) != 2);
+      if (iVal % 3 == 0) {
+        ASSERT_EQ(data[r], iVal);
+      }
+    }
+  }
+
+  tColDataDestroy(&colData);
+}
+
+TEST(testCase, dataBlock_reorder_test) {
+  int32_t numOfRows = 100;
+
+  SSDataBlock* b = createDataBlock();
+
+  SColumnInfoData infoData = createColumnInfoData(TSDB_DATA_TYPE_INT, 4, 1);
+  blockDataAppendColInfo(b, &infoData);
+
+  SColumnInfoData infoData1 = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 40, 2);
+  blockDataAppendColInfo(b, &infoData1);
+
+  blockDataEnsureCapacity(b, numOfRows);
+
+  char buf[41] = {0};
+  char buf1[100] = {0};
+
+  SColumnInfoData* p0 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 0);
+  SColumnInfoData* p1 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 1);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    colDataAppend(p0, i, (const char*)&i, (i % 7 == 0));
+
+    sprintf(buf, "row:%d", i);
+    STR_TO_VARSTR(buf1, buf)
+    colDataAppend(p1, i, buf1, (i % 5 == 0));
+    b->info.rows++;
+  }
+
+  int32_t index[100] = {0};
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    index[i] = (i * 37) % numOfRows;
+  }
+
+  ASSERT_EQ(blockDataReorder(b, index), 0);
+  ASSERT_EQ(b->info.rows, numOfRows);
+
+  p0 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 0);
+  p1 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 1);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int32_t src = index[i];
+    ASSERT_EQ(colDataIsNull_f(p0->nullbitmap, i), (src % 7 == 0));
+    if (src % 7 != 0) {
+      ASSERT_EQ(*(int32_t*)colDataGetData(p0, i), src);
+    }
+
+    ASSERT_EQ(colDataIsNull_var(p1, i), (src % 5 == 0));
+    if (src % 5 != 0) {
+      sprintf(buf, "row:%d", src);
+      char* p = colDataGetData(p1, i);
+      ASSERT_EQ(varDataLen(p), strlen(buf));
+      ASSERT_EQ(memcmp(varDataVal(p), buf, varDataLen(p)), 0);
+    }
+  }
+
+  blockDataDestroy(b);
+}
+
+TEST(testCase, dataBlock_compress_encode_test) {
+  int32_t numOfRows = 1000;
+
+  SSDataBlock* b = createDataBlock();
+
+  SColumnInfoData infoData = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, 8, 1);
+  blockDataAppendColInfo(b, &infoData);
+
+  SColumnInfoData infoData1 = createColumnInfoData(TSDB_DATA_TYPE_INT, 4, 2);
+  blockDataAppendColInfo(b, &infoData1);
+
+  SColumnInfoData infoData2 = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, 8, 3);
+  blockDataAppendColInfo(b, &infoData2);
+
+  SColumnInfoData infoData3 = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 40, 4);
+  blockDataAppendColInfo(b, &infoData3);
+
+  blockDataEnsureCapacity(b, numOfRows);
+
+  char buf[41] = {0};
+  char buf1[100] = {0};
+
+  SColumnInfoData* p0 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 0);
+  SColumnInfoData* p1 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 1);
+  SColumnInfoData* p2 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 2);
+  SColumnInfoData* p3 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 3);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int64_t ts = 1577808000000 + i * 1000;
+    colDataAppend(p0, i, (const char*)&ts, false);
+
+    int32_t v = i % 10;
+    colDataAppend(p1, i, (const char*)&v, (i % 7 == 0));
+
+    double d = i * 0.5;
+    colDataAppend(p2, i, (const char*)&d, false);
+
+    sprintf(buf, "row:%d", i % 16);
+    STR_TO_VARSTR(buf1, buf)
+    colDataAppend(p3, i, buf1, (i % 5 == 0));
+    b->info.rows++;
+  }
+
+  int32_t numOfCols = taosArrayGetSize(b->pDataBlock);
+  char*   pRaw = (char*)taosMemoryCalloc(1, blockGetEncodeSize(b));
+  char*   pCmpr = (char*)taosMemoryCalloc(1, blockGetCompressEncodeSize(b));
+  int32_t rawLen = blockEncode(b, pRaw, numOfCols);
+  int32_t cmprLen = blockCompressEncode(b, pCmpr, numOfCols);
+  ASSERT_LT(cmprLen, rawLen);
+
+  // restored to the raw layout
+  ASSERT_EQ(blockGetDecompressSize(pCmpr), rawLen);
+  char* pOut = (char*)taosMemoryCalloc(1, rawLen);
+  ASSERT_EQ(blockDecompressEncode(pCmpr, pOut), rawLen);
+  ASSERT_EQ(memcmp(pOut, pRaw, rawLen), 0);
+
+  // decoded to a block directly
+  SSDataBlock* pDecode = createDataBlock();
+  ASSERT_EQ(blockDecode(pDecode, pCmpr), pCmpr + cmprLen);
+  ASSERT_EQ(pDecode->info.rows, numOfRows);
+
+  SColumnInfoData* q1 = (SColumnInfoData*)taosArrayGet(pDecode->pDataBlock, 1);
+  SColumnInfoData* q3 = (SColumnInfoData*)taosArrayGet(pDecode->pDataBlock, 3);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ASSERT_EQ(colDataIsNull_f(q1->nullbitmap, i), (i % 7 == 0));
+    if (i % 7 != 0) {
+      ASSERT_EQ(*(int32_t*)colDataGetData(q1, i), i % 10);
+    }
+
+    ASSERT_EQ(colDataIsNull_var(q3, i), (i % 5 == 0));
+    if (i % 5 != 0) {
+      sprintf(buf, "row:%d", i % 16);
+      char* p = colDataGetData(q3, i);
+      ASSERT_EQ(varDataLen(p), strlen(buf));
+      ASSERT_EQ(memcmp(varDataVal(p), buf, varDataLen(p)), 0);
+    }
+  }
+
+  taosMemoryFree(pRaw);
+  taosMemoryFree(pCmpr);
+  taosMemoryFree(pOut);
+  blockDataDestroy(pDecode);
+  blockDataDestroy(b);
+}
@@ -335,6 +335,8 @@ typedef struct {
   ESyncState syncState;
   bool       syncRestore;
   bool       syncCanRead;
+  int32_t    compactNFSet;  // file sets of the running compaction, 0 if not compacting
+  int32_t    compactNDone;
 } SVnodeGid;
 
 typedef struct {
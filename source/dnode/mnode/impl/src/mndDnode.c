@@ -430,6 +430,8 @@ static int32_t mndProcessStatusReq(SRpcMsg *pReq) {
             pGid->syncCanRead = pVload->syncCanRead;
             roleChanged = true;
           }
+          pGid->compactNFSet = pVload->compactNFSet;
+          pGid->compactNDone = pVload->compactNDone;
           break;
         }
       }
@@ -67,6 +67,7 @@ int32_t mndInitStream(SMnode *pMnode) {
   mndSetMsgHandle(pMnode, TDMT_MND_STREAM_CHECKPOINT_TIMER, mndProcessStreamCheckpointTmr);
   mndSetMsgHandle(pMnode, TDMT_MND_STREAM_BEGIN_CHECKPOINT, mndProcessStreamDoCheckpoint);
   mndSetMsgHandle(pMnode, TDMT_STREAM_TASK_REPORT_CHECKPOINT, mndTransProcessRsp);
+  mndSetMsgHandle(pMnode, TDMT_VND_STREAM_CHECK_POINT_SOURCE_RSP, mndTransProcessRsp);
 
   mndAddShowRetrieveHandle(pMnode, TSDB_MGMT_TABLE_STREAMS, mndRetrieveStream);
   mndAddShowFreeIterHandle(pMnode, TSDB_MGMT_TABLE_STREAMS, mndCancelGetNextStream);
@@ -295,6 +296,7 @@ static int32_t mndBuildStreamObjFromCreateReq(SMnode *pMnode, SStreamObj *pObj,
   pObj->triggerParam = pCreate->maxDelay;
   pObj->watermark = pCreate->watermark;
   pObj->fillHistory = pCreate->fillHistory;
+  pObj->checkpointFreq = (int64_t)tsStreamCheckpointInterval * 1000;
 
   memcpy(pObj->sourceDb, pCreate->sourceDB, TSDB_DB_FNAME_LEN);
   SDbObj *pSourceDb = mndAcquireDb(pMnode, pCreate->sourceDB);
@@ -708,10 +710,11 @@ static int32_t mndProcessStreamCheckpointTmr(SRpcMsg *pReq) {
   while (1) {
     pIter = sdbFetch(pSdb, SDB_STREAM, pIter, (void **)&pStream);
     if (pIter == NULL) break;
-    // incr tick
+    // incr tick, streams created before checkpointFreq was set take the configured one
     int64_t currentTick = atomic_add_fetch_64(&pStream->currentTick, 1);
+    int64_t freq = pStream->checkpointFreq > 0 ? pStream->checkpointFreq : (int64_t)tsStreamCheckpointInterval * 1000;
     // if >= checkpointFreq, build msg TDMT_MND_STREAM_BEGIN_CHECKPOINT, put into write q
-    if (currentTick >= pStream->checkpointFreq) {
+    if (currentTick * tsStreamCheckpointTickInterval * 1000 >= freq) {
       atomic_store_64(&pStream->currentTick, 0);
       SMStreamDoCheckpointMsg *pMsg = rpcMallocCont(sizeof(SMStreamDoCheckpointMsg));
 
@@ -727,6 +730,7 @@ static int32_t mndProcessStreamCheckpointTmr(SRpcMsg *pReq) {
 
       tmsgPutToQueue(&pMnode->msgCb, WRITE_QUEUE, &rpcMsg);
     }
+    sdbRelease(pSdb, pStream);
   }
 
   return 0;
@@ -785,12 +789,16 @@ static int32_t mndProcessStreamDoCheckpoint(SRpcMsg *pReq) {
 
   if (pStream == NULL || pStream->uid != pMsg->streamId) {
     mError("start checkpointing failed since stream %s not found", pMsg->streamName);
+    if (pStream != NULL) mndReleaseStream(pMnode, pStream);
     return -1;
   }
 
-  // build new transaction:
-  STrans *pTrans = mndTransCreate(pMnode, TRN_POLICY_RETRY, TRN_CONFLICT_DB_INSIDE, pReq, "stream-checkpoint");
-  if (pTrans == NULL) return -1;
+  // build new transaction, a failed checkpoint is given up and the next one is tried at its own tick
+  STrans *pTrans = mndTransCreate(pMnode, TRN_POLICY_ROLLBACK, TRN_CONFLICT_DB_INSIDE, pReq, "stream-checkpoint");
+  if (pTrans == NULL) {
+    mndReleaseStream(pMnode, pStream);
+    return -1;
+  }
   mndTransSetDbName(pTrans, pStream->sourceDb, pStream->targetDb);
   if (mndTrancCheckConflict(pMnode, pTrans) != 0) {
     mndReleaseStream(pMnode, pStream);
@@ -848,6 +856,15 @@ static int32_t mndProcessStreamDoCheckpoint(SRpcMsg *pReq) {
   // 2. reset tick
   atomic_store_64(&pStream->currentTick, 0);
   // 3. commit log: stream checkpoint info
+  SSdbRaw *pCommitRaw = mndStreamActionEncode(pStream);
+  if (pCommitRaw == NULL || mndTransAppendCommitlog(pTrans, pCommitRaw) != 0) {
+    mError("trans:%d, failed to append commit log since %s", pTrans->id, terrstr());
+    taosRUnLockLatch(&pStream->lock);
+    mndReleaseStream(pMnode, pStream);
+    mndTransDrop(pTrans);
+    return -1;
+  }
+  (void)sdbSetRawStatus(pCommitRaw, SDB_STATUS_READY);
   taosRUnLockLatch(&pStream->lock);
 
   if (mndTransPrepare(pMnode, pTrans) != 0) {
@@ -189,6 +189,8 @@ static int32_t mndVgroupActionUpdate(SSdb *pSdb, SVgObj *pOld, SVgObj *pNew) {
         pNewGid->syncState = pOldGid->syncState;
         pNewGid->syncRestore = pOldGid->syncRestore;
         pNewGid->syncCanRead = pOldGid->syncCanRead;
+        pNewGid->compactNFSet = pOldGid->compactNFSet;
+        pNewGid->compactNDone = pOldGid->compactNDone;
       }
     }
   }
@@ -873,6 +875,15 @@ static int32_t mndRetrieveVnodes(SRpcMsg *pReq, SShowObj *pShow, SSDataBlock *pB
       pColInfo = taosArrayGet(pBlock->pDataBlock, cols++);
       colDataAppend(pColInfo, numOfRows, (const char *)b2, false);
 
+      // percent of the file sets compacted, null if the vnode is not compacting
+      pColInfo = taosArrayGet(pBlock->pDataBlock, cols++);
+      if (pVgid->compactNFSet > 0) {
+        int32_t progress = pVgid->compactNDone * 100 / pVgid->compactNFSet;
+        colDataAppend(pColInfo, numOfRows, (const char *)&progress, false);
+      } else {
+        colDataAppendNULL(pColInfo, numOfRows);
+      }
+
       numOfRows++;
     }
 
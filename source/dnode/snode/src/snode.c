@@ -300,6 +300,55 @@ int32_t sndProcessTaskRecoverFinishRsp(SSnode *pSnode, SRpcMsg *pMsg) {
   return 0;
 }
 
+int32_t sndProcessTaskCheckpointReq(SSnode *pSnode, SRpcMsg *pMsg) {
+  char   *msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointReq req;
+  SDecoder             decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_INVALID_MSG;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask *pTask = streamMetaAcquireTask(pSnode->pMeta, req.downstreamTaskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  int32_t code = streamProcessCheckpointReq(pSnode->pMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pSnode->pMeta, pTask);
+  return code;
+}
+
+int32_t sndProcessTaskCheckpointRsp(SSnode *pSnode, SRpcMsg *pMsg) {
+  char   *msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointRsp rsp;
+  SDecoder             decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointRsp(&decoder, &rsp) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_INVALID_MSG;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask *pTask = streamMetaAcquireTask(pSnode->pMeta, rsp.upstreamTaskId);
+  if (pTask == NULL) {
+    return -1;
+  }
+
+  streamProcessCheckpointRsp(pSnode->pMeta, pTask, &rsp, pMsg->code);
+  streamMetaReleaseTask(pSnode->pMeta, pTask);
+  return 0;
+}
+
 int32_t sndProcessStreamMsg(SSnode *pSnode, SRpcMsg *pMsg) {
   switch (pMsg->msgType) {
     case TDMT_STREAM_TASK_RUN:
@@ -316,6 +365,10 @@ int32_t sndProcessStreamMsg(SSnode *pSnode, SRpcMsg *pMsg) {
       return sndProcessTaskRecoverFinishReq(pSnode, pMsg);
     case TDMT_STREAM_RECOVER_FINISH_RSP:
       return sndProcessTaskRecoverFinishRsp(pSnode, pMsg);
+    case TDMT_STREAM_TASK_CHECKPOINT:
+      return sndProcessTaskCheckpointReq(pSnode, pMsg);
+    case TDMT_STREAM_TASK_CHECKPOINT_RSP:
+      return sndProcessTaskCheckpointRsp(pSnode, pMsg);
     default:
       ASSERT(0);
   }
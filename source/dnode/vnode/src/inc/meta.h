@@ -73,6 +73,16 @@ int32_t metaStatsCacheGet(SMeta* pMeta, int64_t uid, SMetaStbStats* pInfo);
 void    metaUpdateStbStats(SMeta* pMeta, int64_t uid, int64_t delta);
 int32_t metaUidFilterCacheGet(SMeta* pMeta, uint64_t suid, const void* pKey, int32_t keyLen, LRUHandle** pHandle);
 
+int32_t metaSkmCacheGet(SMeta* pMeta, int64_t uid, int32_t sver, STSchema** ppTSchema);
+int32_t metaSkmCachePut(SMeta* pMeta, int64_t uid, const STSchema* pTSchema, STSchema** ppTSchema);
+void    metaSkmCacheRelease(SMeta* pMeta, STSchema* pTSchema);
+int32_t metaSkmCacheDrop(SMeta* pMeta, int64_t uid);
+
+int32_t metaTagTableUpsert(SMeta* pMeta, int64_t suid, int64_t uid, const char* name, const STag* pTag);
+int32_t metaTagTableDelete(SMeta* pMeta, int64_t suid, int64_t uid);
+int32_t metaTagTableDrop(SMeta* pMeta, int64_t suid);
+void    metaTagTableClear(SMeta* pMeta);
+
 struct SMeta {
   TdThreadRwlock lock;
 
@@ -73,6 +73,8 @@ typedef struct SBlkInfo         SBlkInfo;
 #define TSDB_FILE_DLMT     ((uint32_t)0xF00AFA0F)
 #define TSDB_MAX_SUBBLOCKS 8
 #define TSDB_FHDR_SIZE     512
+#define TSDB_FS_VER        2  // 1: SSttFile.bfOffset added, 2: SDFileSet.delVer added
+#define TSDB_DATA_FMT_VER  1  // 1: SBlockCol.cmprAlg added
 
 #define VERSION_MIN 0
 #define VERSION_MAX INT64_MAX
@@ -128,8 +130,8 @@ int32_t tTABLEIDCmprFn(const void *p1, const void *p2);
 #define MIN_TSDBKEY(KEY1, KEY2) ((tsdbKeyCmprFn(&(KEY1), &(KEY2)) < 0) ? (KEY1) : (KEY2))
 #define MAX_TSDBKEY(KEY1, KEY2) ((tsdbKeyCmprFn(&(KEY1), &(KEY2)) > 0) ? (KEY1) : (KEY2))
 // SBlockCol
-int32_t tPutBlockCol(uint8_t *p, void *ph);
-int32_t tGetBlockCol(uint8_t *p, void *ph);
+int32_t tPutBlockCol(uint8_t *p, void *ph, uint32_t fmtVer);
+int32_t tGetBlockCol(uint8_t *p, void *ph, uint32_t fmtVer, int8_t cmprAlg);
 int32_t tBlockColCmprFn(const void *p1, const void *p2);
 // SDataBlk
 void    tDataBlkReset(SDataBlk *pBlock);
@@ -161,8 +163,8 @@ SColData *tBlockDataGetColDataByIdx(SBlockData *pBlockData, int32_t idx);
 void      tBlockDataGetColData(SBlockData *pBlockData, int16_t cid, SColData **ppColData);
 int32_t   tBlockDataMerge(SBlockData *pBlockData1, SBlockData *pBlockData2, SBlockData *pBlockData);
 int32_t   tBlockDataAddColData(SBlockData *pBlockData, SColData **ppColData);
-int32_t   tCmprBlockData(SBlockData *pBlockData, int8_t cmprAlg, uint8_t **ppOut, int32_t *szOut, uint8_t *aBuf[],
-                         int32_t aBufN[]);
+int32_t   tCmprBlockData(SBlockData *pBlockData, int8_t cmprAlg, uint32_t fmtVer, uint8_t **ppOut, int32_t *szOut,
+                         uint8_t *aBuf[], int32_t aBufN[]);
 int32_t   tDecmprBlockData(uint8_t *pIn, int32_t szIn, SBlockData *pBlockData, uint8_t *aBuf[]);
 // SDiskDataHdr
 int32_t tPutDiskDataHdr(uint8_t *p, const SDiskDataHdr *pHdr);
@@ -198,8 +200,16 @@ int32_t tsdbCmprData(uint8_t *pIn, int32_t szIn, int8_t type, int8_t cmprAlg, ui
                      int32_t *szOut, uint8_t **ppBuf);
 int32_t tsdbDecmprData(uint8_t *pIn, int32_t szIn, int8_t type, int8_t cmprAlg, uint8_t **ppOut, int32_t szOut,
                        uint8_t **ppBuf);
-int32_t tsdbCmprColData(SColData *pColData, int8_t cmprAlg, SBlockCol *pBlockCol, uint8_t **ppOut, int32_t nOut,
-                        uint8_t **ppBuf);
+int32_t tsdbCmprDataAdaptive(uint8_t *pIn, int32_t szIn, int8_t type, uint8_t **ppOut, int32_t nOut, int32_t *szOut,
+                             int8_t *cmprAlg, uint8_t **ppBuf);
+// max number of distinct var values a block column is dictionary encoded with
+#define TSDB_DICT_MAX_SIZE 1024
+int32_t tsdbCmprDataDict(uint8_t *pIn, int32_t szIn, int32_t *aOffset, int32_t nVal, uint8_t **ppOut, int32_t nOut,
+                         int32_t *szOut, int8_t *cmprAlg, uint8_t **ppBuf);
+int32_t tsdbDecmprDataDict(uint8_t *pIn, int32_t szIn, int32_t nVal, uint8_t **ppOut, int32_t szOut, int16_t **paCode,
+                           int32_t *nDict, uint8_t **ppBuf);
+int32_t tsdbCmprColData(SColData *pColData, int8_t cmprAlg, uint32_t fmtVer, SBlockCol *pBlockCol, uint8_t **ppOut,
+                        int32_t nOut, uint8_t **ppBuf);
 int32_t tsdbDecmprColData(uint8_t *pIn, SBlockCol *pBlockCol, int8_t cmprAlg, int32_t nVal, SColData *pColData,
                           uint8_t **ppBuf);
 // tsdbMemTable ==============================================================================================
@@ -229,7 +239,7 @@ int32_t tPutSmaFile(uint8_t *p, SSmaFile *pSmaFile);
 int32_t tPutDelFile(uint8_t *p, SDelFile *pDelFile);
 int32_t tGetDelFile(uint8_t *p, SDelFile *pDelFile);
 int32_t tPutDFileSet(uint8_t *p, SDFileSet *pSet);
-int32_t tGetDFileSet(uint8_t *p, SDFileSet *pSet);
+int32_t tGetDFileSet(uint8_t *p, SDFileSet *pSet, int8_t fsVer);
 
 void tsdbHeadFileName(STsdb *pTsdb, SDiskID did, int32_t fid, SHeadFile *pHeadF, char fname[]);
 void tsdbDataFileName(STsdb *pTsdb, SDiskID did, int32_t fid, SDataFile *pDataF, char fname[]);
@@ -259,6 +269,7 @@ int32_t tsdbUpdateDFileSetHeader(SDataFWriter *pWriter);
 int32_t tsdbWriteBlockIdx(SDataFWriter *pWriter, SArray *aBlockIdx);
 int32_t tsdbWriteDataBlk(SDataFWriter *pWriter, SMapData *mDataBlk, SBlockIdx *pBlockIdx);
 int32_t tsdbWriteSttBlk(SDataFWriter *pWriter, SArray *aSttBlk);
+int32_t tsdbAddSttBlkUid(SDataFWriter *pWriter, const int64_t *aUid, int32_t nUid);
 int32_t tsdbWriteBlockData(SDataFWriter *pWriter, SBlockData *pBlockData, SBlockInfo *pBlkInfo, SSmaInfo *pSmaInfo,
                            int8_t cmprAlg, int8_t toLast);
 int32_t tsdbWriteDiskData(SDataFWriter *pWriter, const SDiskData *pDiskData, SBlockInfo *pBlkInfo, SSmaInfo *pSmaInfo);
@@ -267,13 +278,17 @@ int32_t tsdbDFileSetCopy(STsdb *pTsdb, SDFileSet *pSetFrom, SDFileSet *pSetTo);
 // SDataFReader
 int32_t tsdbDataFReaderOpen(SDataFReader **ppReader, STsdb *pTsdb, SDFileSet *pSet);
 int32_t tsdbDataFReaderClose(SDataFReader **ppReader);
+void    tsdbDataFReaderGetPgCacheStat(SDataFReader *pReader, int64_t *nHit, int64_t *nMiss);
 int32_t tsdbReadBlockIdx(SDataFReader *pReader, SArray *aBlockIdx);
 int32_t tsdbReadDataBlk(SDataFReader *pReader, SBlockIdx *pBlockIdx, SMapData *mDataBlk);
 int32_t tsdbReadSttBlk(SDataFReader *pReader, int32_t iStt, SArray *aSttBlk);
+int32_t tsdbReadSttBF(SDataFReader *pReader, int32_t iStt, SBloomFilter **ppBF);
+int32_t tsdbReadSttBlkBF(SDataFReader *pReader, int32_t iStt, SArray *aBlkBF);
 int32_t tsdbReadBlockSma(SDataFReader *pReader, SDataBlk *pBlock, SArray *aColumnDataAgg);
 int32_t tsdbReadDataBlock(SDataFReader *pReader, SDataBlk *pBlock, SBlockData *pBlockData);
 int32_t tsdbReadSttBlock(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData);
 int32_t tsdbReadSttBlockEx(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData);
+int32_t tsdbPrefetchDataBlocks(SDataFReader *pReader, SArray *aBlkInfo);
 // SDelFWriter
 int32_t tsdbDelFWriterOpen(SDelFWriter **ppWriter, SDelFile *pFile, STsdb *pTsdb);
 int32_t tsdbDelFWriterClose(SDelFWriter **ppWriter, int8_t sync);
@@ -288,6 +303,7 @@ int32_t tsdbReadDelIdx(SDelFReader *pReader, SArray *aDelIdx);
 // tsdbRead.c ==============================================================================================
 int32_t tsdbTakeReadSnap(STsdb *pTsdb, STsdbReadSnap **ppSnap, const char *id);
 void    tsdbUntakeReadSnap(STsdb *pTsdb, STsdbReadSnap *pSnap, const char *id);
+bool    hasBeenDropped(const SArray *pDelList, int32_t *index, TSDBKEY *pKey, int32_t order, SVersionRange *pVerRange);
 // tsdbMerge.c ==============================================================================================
 int32_t tsdbMerge(STsdb *pTsdb);
 
@@ -320,6 +336,10 @@ struct STsdb {
   STsdbFS        fs;
   SLRUCache     *lruCache;
   TdThreadMutex  lruMutex;
+  SLRUCache     *pgCache;  // verified pages of data files, keyed by (file, pgno)
+  TdThreadMutex  prefetchMutex;
+  TdThreadCond   prefetchDone;  // signaled when nPrefetch drops to 0
+  int32_t        nPrefetch;     // in-flight block prefetch tasks, guarded by prefetchMutex
 };
 
 struct TSDBKEY {
@@ -408,6 +428,7 @@ struct SBlockCol {
   int8_t  type;
   int8_t  smaOn;
   int8_t  flag;      // HAS_NONE|HAS_NULL|HAS_VALUE
+  int8_t  cmprAlg;   // value compress algorithm, SDiskDataHdr.cmprAlg before TSDB_DATA_FMT_VER 1
   int32_t szOrigin;  // original column value size (only save for variant data type)
   int32_t szBitmap;  // bitmap size, 0 only for flag == HAS_VAL
   int32_t szOffset;  // offset size, 0 only for non-variant-length type
@@ -545,6 +566,7 @@ struct SSttFile {
   int64_t commitID;
   int64_t size;
   int64_t offset;
+  int64_t bfOffset;  // offset of the uid bloom filters, 0 means not exist
 };
 
 struct SSmaFile {
@@ -562,6 +584,7 @@ struct SDFileSet {
   SSmaFile  *pSmaF;
   uint8_t    nSttF;
   SSttFile  *aSttF[TSDB_MAX_STT_TRIGGER];
+  int64_t    delVer;  // version of the latest delete purged from the file set by compaction, 0 for none
 };
 
 struct STSDBRowIter {
@@ -577,6 +600,7 @@ struct SRowMerger {
 };
 
 typedef struct {
+  STsdb    *pTsdb;
   char     *path;
   int32_t   szPage;
   int32_t   flag;
@@ -584,6 +608,8 @@ typedef struct {
   int64_t   pgno;
   uint8_t  *pBuf;
   int64_t   szFile;
+  int64_t   nPgCacheHit;  // page cache lookups of the reads through this fd
+  int64_t   nPgCacheMiss;
 } STsdbFD;
 
 struct SDelFWriter {
@@ -613,6 +639,9 @@ struct SDataFWriter {
   SSmaFile  fSma;
   SSttFile  fStt[TSDB_MAX_STT_TRIGGER];
 
+  SArray *aSttUid;     // SArray<int64_t>, uids of each stt block written
+  SArray *aSttUidEnd;  // SArray<int32_t>, end index in aSttUid of each stt block written
+
   uint8_t *aBuf[4];
 };
 
@@ -633,16 +662,20 @@ typedef struct {
 } SRowInfo;
 
 typedef struct SSttBlockLoadInfo {
-  SBlockData blockData[2];
-  SArray    *aSttBlk;
-  int32_t    blockIndex[2];  // to denote the loaded block in the corresponding position.
-  int32_t    currentLoadBlockIndex;
-  int32_t    loadBlocks;
-  double     elapsedTime;
-  STSchema  *pSchema;
-  int16_t   *colIds;
-  int32_t    numOfCols;
-  bool       sttBlockLoaded;
+  SBlockData    blockData[2];
+  SArray       *aSttBlk;
+  SBloomFilter *pBF;            // uid filter of the whole stt file, NULL if not exist
+  SArray       *aBlkBF;         // SArray<SBloomFilter *>, uid filter of each block in the stt file
+  int32_t       blkBFOffset;    // index in aBlkBF of the filter for aSttBlk[0]
+  bool          blkBFLoaded;
+  int32_t       blockIndex[2];  // to denote the loaded block in the corresponding position.
+  int32_t       currentLoadBlockIndex;
+  int32_t       loadBlocks;
+  double        elapsedTime;
+  STSchema     *pSchema;
+  int16_t      *colIds;
+  int32_t       numOfCols;
+  bool          sttBlockLoaded;
 
   // keep the last access position, this position may be used to reduce the binary times for
   // starting last block data for a new table
@@ -695,6 +728,7 @@ struct SDiskDataBuilder {
   SCompressor *pKeyC;
   int32_t      nBuilder;
   SArray      *aBuilder;  // SArray<SDiskColBuilder>
+  SArray      *aUid;      // SArray<int64_t>, uids added, each only once
   uint8_t     *aBuf[2];
   SDiskData    dd;
   SBlkInfo     bi;
@@ -739,6 +773,12 @@ typedef struct {
 
 int32_t tsdbOpenCache(STsdb *pTsdb);
 void    tsdbCloseCache(STsdb *pTsdb);
+int32_t tsdbOpenPgCache(STsdb *pTsdb);
+void    tsdbClosePgCache(STsdb *pTsdb);
+bool    tsdbPgCacheGet(STsdb *pTsdb, const char *path, int64_t pgno, uint8_t *pPage, int32_t szPage);
+void    tsdbPgCachePut(STsdb *pTsdb, const char *path, int64_t pgno, const uint8_t *pPage, int32_t szPage);
+void    tsdbPgCacheErase(STsdb *pTsdb, const char *path, int64_t pgno);
+bool    tsdbPgCacheContains(STsdb *pTsdb, const char *path, int64_t pgno);
 int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb *pTsdb);
 int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, STSRow *row, bool dup);
 int32_t tsdbCacheGetLastH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr, LRUHandle **h);
@@ -50,6 +50,7 @@ int32_t vnodeDecodeConfig(const SJson* pJson, void* pObj);
 
 // vnodeModule.c
 int32_t vnodeScheduleTask(int32_t (*execute)(void*), void* arg);
+int32_t vnodeScheduleInsertTask(int32_t (*execute)(void*), void* arg);
 
 // vnodeBufPool.c
 typedef struct SVBufPoolNode SVBufPoolNode;
@@ -94,6 +95,9 @@ int32_t vnodeSyncCommit(SVnode* pVnode);
 int32_t vnodeAsyncCommit(SVnode* pVnode);
 bool    vnodeShouldRollback(SVnode* pVnode);
 
+// vnodeCompact.c
+int32_t vnodeAsyncCompact(SVnode* pVnode);
+
 // vnodeSync.c
 int32_t vnodeSyncOpen(SVnode* pVnode, char* path);
 int32_t vnodeSyncStart(SVnode* pVnode);
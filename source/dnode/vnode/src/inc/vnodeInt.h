@@ -21,6 +21,7 @@
 #include "qworker.h"
 #include "sync.h"
 #include "tRealloc.h"
+#include "tbloomfilter.h"
 #include "tchecksum.h"
 #include "tcoding.h"
 #include "tcompare.h"
@@ -96,6 +97,7 @@ void  vnodeBufPoolFree(SVBufPool* pPool, void* p);
 void  vnodeBufPoolRef(SVBufPool* pPool);
 void  vnodeBufPoolUnRef(SVBufPool* pPool);
 int   vnodeDecodeInfo(uint8_t* pData, SVnodeInfo* pInfo);
+int   vnodeSchedulePrefetchTask(int (*execute)(void*), void* arg);
 
 // meta
 typedef struct SMCtbCursor SMCtbCursor;
@@ -124,6 +126,9 @@ int             metaAlterTable(SMeta* pMeta, int64_t version, SVAlterTbReq* pReq
 SSchemaWrapper* metaGetTableSchema(SMeta* pMeta, tb_uid_t uid, int32_t sver, int lock);
 STSchema*       metaGetTbTSchema(SMeta* pMeta, tb_uid_t uid, int32_t sver, int lock);
 int32_t         metaGetTbTSchemaEx(SMeta* pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema** ppTSchema);
+int32_t         metaAcquireTbTSchema(SMeta* pMeta, tb_uid_t uid, int32_t sver, STSchema** ppTSchema);
+int32_t         metaAcquireTbTSchemaEx(SMeta* pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema** ppTSchema);
+void            metaReleaseTbTSchema(SMeta* pMeta, STSchema* pTSchema);
 int             metaGetTableEntryByName(SMetaReader* pReader, const char* name);
 int             metaAlterCache(SMeta* pMeta, int32_t nPage);
 
@@ -162,6 +167,7 @@ int32_t tsdbCommit(STsdb* pTsdb, SCommitInfo* pInfo);
 int32_t tsdbFinishCommit(STsdb* pTsdb);
 int32_t tsdbRollbackCommit(STsdb* pTsdb);
 int32_t tsdbDoRetention(STsdb* pTsdb, int64_t now);
+int32_t tsdbCompact(STsdb* pTsdb, int64_t commitID);
 int     tsdbScanAndConvertSubmitMsg(STsdb* pTsdb, SSubmitReq* pMsg);
 int     tsdbInsertData(STsdb* pTsdb, int64_t version, SSubmitReq* pMsg, SSubmitRsp* pRsp);
 int32_t tsdbInsertTableData(STsdb* pTsdb, int64_t version, SSubmitMsgIter* pMsgIter, SSubmitBlk* pBlock,
@@ -201,6 +207,9 @@ int32_t tqProcessTaskRecover1Req(STQ* pTq, SRpcMsg* pMsg);
 int32_t tqProcessTaskRecover2Req(STQ* pTq, int64_t version, char* msg, int32_t msgLen);
 int32_t tqProcessTaskRecoverFinishReq(STQ* pTq, SRpcMsg* pMsg);
 int32_t tqProcessTaskRecoverFinishRsp(STQ* pTq, SRpcMsg* pMsg);
+int32_t tqProcessStreamCheckpointSourceReq(STQ* pTq, SRpcMsg* pMsg);
+int32_t tqProcessTaskCheckpointReq(STQ* pTq, SRpcMsg* pMsg);
+int32_t tqProcessTaskCheckpointRsp(STQ* pTq, SRpcMsg* pMsg);
 int32_t tqCheckLogInWal(STQ* pTq, int64_t version);
 
 SSubmitReq* tqBlockToSubmit(SVnode* pVnode, const SArray* pBlocks, const STSchema* pSchema,
@@ -350,6 +359,10 @@ struct SVnode {
   STQ*          pTq;
   SSink*        pSink;
   tsem_t        canCommit;
+  tsem_t        canCompact;
+  int8_t        compacting;
+  int32_t       compactNFSet;  // file sets to compact by the running compaction
+  int32_t       compactNDone;  // file sets compacted by the running compaction
   int64_t       sync;
   TdThreadMutex lock;
   bool          blocked;
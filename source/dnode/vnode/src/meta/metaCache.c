@@ -16,6 +16,9 @@
 
 #define META_CACHE_BASE_BUCKET  1024
 #define META_CACHE_STATS_BUCKET 16
+#define META_CACHE_SKM_BUCKET   64
+
+#define META_TAG_TABLE_MIN_ROWS 1024
 
 // (uid , suid) : child table
 // (uid,     0) : normal table
@@ -31,12 +34,38 @@ typedef struct SMetaStbStatsEntry {
   SMetaStbStats              info;
 } SMetaStbStatsEntry;
 
+// (uid, sver) : schema of a super or normal table, immutable once cached
+typedef struct SMetaSkmCacheEntry SMetaSkmCacheEntry;
+struct SMetaSkmCacheEntry {
+  SMetaSkmCacheEntry* next;
+  int64_t             uid;
+  int32_t             nRef;      // one held by the cache and one by each acquirer
+  int8_t              accessed;  // acquired since the clock hand passed it last
+  STSchema*           pTSchema;
+};
+
+#define META_SKM_ENTRY_SIZE(_nCols) (sizeof(SMetaSkmCacheEntry) + sizeof(STSchema) + sizeof(STColumn) * (_nCols))
+
 typedef struct STagFilterResEntry {
   uint64_t suid;    // uid for super table
   SList    list;    // the linked list of md5 digest, extracted from the serialized tag query condition
   uint32_t qTimes;  // queried times for current super table
 } STagFilterResEntry;
 
+// columnar tags of the child tables of a super table, slot 0 of pBlock is tbname and the rest are the tag columns
+typedef struct SMetaTagTable SMetaTagTable;
+struct SMetaTagTable {
+  int64_t        suid;
+  int32_t        nRef;     // one held by the cache and one by each query filling from it
+  int32_t        nUpdate;  // rows rewritten or deleted in place, whose var data is left as garbage
+  int64_t        size;     // memory charged to the cache
+  SMetaTagTable* lruPrev;
+  SMetaTagTable* lruNext;
+  SArray*        aUid;     // uid of each row
+  SHashObj*      pRowIdx;  // uid -> row
+  SSDataBlock*   pBlock;
+};
+
 struct SMetaCache {
   // child, normal, super, table entry cache
   struct SEntryCache {
@@ -52,12 +81,32 @@ struct SMetaCache {
     SMetaStbStatsEntry** aBucket;
   } sStbStatsCache;
 
+  // table schema cache, the entries not acquired recently are evicted by a clock sweep over the buckets when the
+  // schemas take more than tsMetaSkmCacheSize
+  struct SSkmCache {
+    TdThreadRwlock       lock;
+    int32_t              nEntry;
+    int32_t              nBucket;
+    int32_t              iClock;  // bucket the clock hand is at
+    int64_t              size;
+    SMetaSkmCacheEntry** aBucket;
+  } sSkmCache;
+
   // query cache
   struct STagFilterResCache {
     TdThreadMutex lock;
     SHashObj*  pTableEntry;
     SLRUCache* pUidResCache;
   } sTagFilterResCache;
+
+  // tag table cache, built on the first tag query of a super table and kept up to date by the writes, the least
+  // recently queried tables are evicted when the tables take more than tsMetaTagTableCacheSize
+  struct STagTableCache {
+    TdThreadMutex lock;
+    SHashObj*     pTables;
+    int64_t       size;
+    SMetaTagTable lru;  // head of the lru list, the most recently queried next to it
+  } sTagTableCache;
 };
 
 static void entryCacheClose(SMeta* pMeta) {
@@ -90,6 +139,44 @@ static void statsCacheClose(SMeta* pMeta) {
   }
 }
 
+static void skmCacheEntryUnref(SMetaSkmCacheEntry* pEntry) {
+  if (atomic_sub_fetch_32(&pEntry->nRef, 1) == 0) {
+    taosMemoryFree(pEntry);
+  }
+}
+
+static void skmCacheClose(SMeta* pMeta) {
+  if (pMeta->pCache) {
+    for (int32_t iBucket = 0; iBucket < pMeta->pCache->sSkmCache.nBucket; iBucket++) {
+      SMetaSkmCacheEntry* pEntry = pMeta->pCache->sSkmCache.aBucket[iBucket];
+      while (pEntry) {
+        SMetaSkmCacheEntry* tEntry = pEntry->next;
+        skmCacheEntryUnref(pEntry);
+        pEntry = tEntry;
+      }
+    }
+    taosMemoryFree(pMeta->pCache->sSkmCache.aBucket);
+    taosThreadRwlockDestroy(&pMeta->pCache->sSkmCache.lock);
+  }
+}
+
+static void metaTagTableDestroy(SMetaTagTable* pTable) {
+  if (pTable) {
+    taosArrayDestroy(pTable->aUid);
+    taosHashCleanup(pTable->pRowIdx);
+    blockDataDestroy(pTable->pBlock);
+    taosMemoryFree(pTable);
+  }
+}
+
+static void metaTagTableUnref(SMetaTagTable* pTable) {
+  if (atomic_sub_fetch_32(&pTable->nRef, 1) == 0) {
+    metaTagTableDestroy(pTable);
+  }
+}
+
+static void freeTagTableFp(void* param) { metaTagTableUnref(*(SMetaTagTable**)param); }
+
 static void freeCacheEntryFp(void* param) {
   STagFilterResEntry** p = param;
   tdListEmpty(&(*p)->list);
@@ -126,6 +213,19 @@ int32_t metaCacheOpen(SMeta* pMeta) {
     goto _err2;
   }
 
+  // open schema cache
+  pCache->sSkmCache.nEntry = 0;
+  pCache->sSkmCache.nBucket = META_CACHE_SKM_BUCKET;
+  pCache->sSkmCache.iClock = 0;
+  pCache->sSkmCache.size = 0;
+  pCache->sSkmCache.aBucket =
+      (SMetaSkmCacheEntry**)taosMemoryCalloc(pCache->sSkmCache.nBucket, sizeof(SMetaSkmCacheEntry*));
+  if (pCache->sSkmCache.aBucket == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err2;
+  }
+  taosThreadRwlockInit(&pCache->sSkmCache.lock, NULL);
+
   pCache->sTagFilterResCache.pUidResCache = taosLRUCacheInit(5 * 1024 * 1024, -1, 0.5);
   if (pCache->sTagFilterResCache.pUidResCache == NULL) {
     code = TSDB_CODE_OUT_OF_MEMORY;
@@ -142,6 +242,19 @@ int32_t metaCacheOpen(SMeta* pMeta) {
   taosHashSetFreeFp(pCache->sTagFilterResCache.pTableEntry, freeCacheEntryFp);
   taosThreadMutexInit(&pCache->sTagFilterResCache.lock, NULL);
 
+  pCache->sTagTableCache.pTables =
+      taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
+  if (pCache->sTagTableCache.pTables == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err2;
+  }
+
+  taosHashSetFreeFp(pCache->sTagTableCache.pTables, freeTagTableFp);
+  taosThreadMutexInit(&pCache->sTagTableCache.lock, NULL);
+  pCache->sTagTableCache.size = 0;
+  pCache->sTagTableCache.lru.lruPrev = &pCache->sTagTableCache.lru;
+  pCache->sTagTableCache.lru.lruNext = &pCache->sTagTableCache.lru;
+
   pMeta->pCache = pCache;
   return code;
 
@@ -158,11 +271,15 @@ void metaCacheClose(SMeta* pMeta) {
   if (pMeta->pCache) {
     entryCacheClose(pMeta);
     statsCacheClose(pMeta);
+    skmCacheClose(pMeta);
 
     taosHashCleanup(pMeta->pCache->sTagFilterResCache.pTableEntry);
     taosLRUCacheCleanup(pMeta->pCache->sTagFilterResCache.pUidResCache);
     taosThreadMutexDestroy(&pMeta->pCache->sTagFilterResCache.lock);
 
+    taosHashCleanup(pMeta->pCache->sTagTableCache.pTables);
+    taosThreadMutexDestroy(&pMeta->pCache->sTagTableCache.lock);
+
     taosMemoryFree(pMeta->pCache);
     pMeta->pCache = NULL;
   }
@@ -424,6 +541,189 @@ int32_t metaStatsCacheGet(SMeta* pMeta, int64_t uid, SMetaStbStats* pInfo) {
   return code;
 }
 
+static int32_t metaRehashSkmCache(SMetaCache* pCache, int8_t expand) {
+  int32_t code = 0;
+  int32_t nBucket;
+
+  if (expand) {
+    nBucket = pCache->sSkmCache.nBucket * 2;
+  } else {
+    nBucket = pCache->sSkmCache.nBucket / 2;
+  }
+
+  SMetaSkmCacheEntry** aBucket = (SMetaSkmCacheEntry**)taosMemoryCalloc(nBucket, sizeof(SMetaSkmCacheEntry*));
+  if (aBucket == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  // rehash
+  for (int32_t iBucket = 0; iBucket < pCache->sSkmCache.nBucket; iBucket++) {
+    SMetaSkmCacheEntry* pEntry = pCache->sSkmCache.aBucket[iBucket];
+
+    while (pEntry) {
+      SMetaSkmCacheEntry* pTEntry = pEntry->next;
+
+      pEntry->next = aBucket[TABS(pEntry->uid) % nBucket];
+      aBucket[TABS(pEntry->uid) % nBucket] = pEntry;
+
+      pEntry = pTEntry;
+    }
+  }
+
+  // final set
+  taosMemoryFree(pCache->sSkmCache.aBucket);
+  pCache->sSkmCache.nBucket = nBucket;
+  pCache->sSkmCache.iClock = 0;
+  pCache->sSkmCache.aBucket = aBucket;
+
+_exit:
+  return code;
+}
+
+// acquire the cached schema (uid, sver), release it by metaSkmCacheRelease
+int32_t metaSkmCacheGet(SMeta* pMeta, int64_t uid, int32_t sver, STSchema** ppTSchema) {
+  int32_t code = 0;
+
+  SMetaCache* pCache = pMeta->pCache;
+  taosThreadRwlockRdlock(&pCache->sSkmCache.lock);
+
+  int32_t             iBucket = TABS(uid) % pCache->sSkmCache.nBucket;
+  SMetaSkmCacheEntry* pEntry = pCache->sSkmCache.aBucket[iBucket];
+  while (pEntry && (pEntry->uid != uid || pEntry->pTSchema->version != sver)) {
+    pEntry = pEntry->next;
+  }
+
+  if (pEntry) {
+    atomic_add_fetch_32(&pEntry->nRef, 1);
+    atomic_store_8(&pEntry->accessed, 1);
+    *ppTSchema = pEntry->pTSchema;
+  } else {
+    code = TSDB_CODE_NOT_FOUND;
+  }
+
+  taosThreadRwlockUnlock(&pCache->sSkmCache.lock);
+  return code;
+}
+
+// sweep the clock hand over the buckets until the schemas fit in tsMetaSkmCacheSize, an entry acquired since the last
+// pass is given a second chance, and an evicted one still acquired is freed when released, the write lock is held
+static void metaSkmCacheEvict(SMetaCache* pCache) {
+  int64_t capacity = (int64_t)tsMetaSkmCacheSize * 1024 * 1024;
+
+  while (pCache->sSkmCache.size > capacity && pCache->sSkmCache.nEntry > 0) {
+    SMetaSkmCacheEntry** ppEntry = &pCache->sSkmCache.aBucket[pCache->sSkmCache.iClock];
+    while (*ppEntry && pCache->sSkmCache.size > capacity) {
+      SMetaSkmCacheEntry* pEntry = *ppEntry;
+      if (pEntry->accessed) {
+        pEntry->accessed = 0;
+        ppEntry = &pEntry->next;
+      } else {
+        *ppEntry = pEntry->next;
+        pCache->sSkmCache.size -= META_SKM_ENTRY_SIZE(pEntry->pTSchema->numOfCols);
+        pCache->sSkmCache.nEntry--;
+        skmCacheEntryUnref(pEntry);
+      }
+    }
+
+    pCache->sSkmCache.iClock = (pCache->sSkmCache.iClock + 1) % pCache->sSkmCache.nBucket;
+  }
+}
+
+// cache a copy of the schema of table uid, and acquire the cached one if ppTSchema is not NULL
+int32_t metaSkmCachePut(SMeta* pMeta, int64_t uid, const STSchema* pTSchema, STSchema** ppTSchema) {
+  int32_t code = 0;
+  int32_t size = sizeof(STSchema) + sizeof(STColumn) * pTSchema->numOfCols;
+
+  SMetaSkmCacheEntry* pEntryNew = (SMetaSkmCacheEntry*)taosMemoryMalloc(sizeof(*pEntryNew) + size);
+  if (pEntryNew == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pEntryNew->uid = uid;
+  pEntryNew->nRef = 1;
+  pEntryNew->accessed = 1;
+  pEntryNew->pTSchema = (STSchema*)&pEntryNew[1];
+  memcpy(pEntryNew->pTSchema, pTSchema, size);
+
+  SMetaCache* pCache = pMeta->pCache;
+  taosThreadRwlockWrlock(&pCache->sSkmCache.lock);
+
+  int32_t             iBucket = TABS(uid) % pCache->sSkmCache.nBucket;
+  SMetaSkmCacheEntry* pEntry = pCache->sSkmCache.aBucket[iBucket];
+  while (pEntry && (pEntry->uid != uid || pEntry->pTSchema->version != pTSchema->version)) {
+    pEntry = pEntry->next;
+  }
+
+  if (pEntry) {  // cached by others
+    taosMemoryFree(pEntryNew);
+  } else {  // insert
+    if (pCache->sSkmCache.nEntry >= pCache->sSkmCache.nBucket) {
+      code = metaRehashSkmCache(pCache, 1);
+      if (code) {
+        taosMemoryFree(pEntryNew);
+        goto _exit;
+      }
+
+      iBucket = TABS(uid) % pCache->sSkmCache.nBucket;
+    }
+
+    pEntry = pEntryNew;
+    pEntry->next = pCache->sSkmCache.aBucket[iBucket];
+    pCache->sSkmCache.aBucket[iBucket] = pEntry;
+    pCache->sSkmCache.nEntry++;
+    pCache->sSkmCache.size += META_SKM_ENTRY_SIZE(pTSchema->numOfCols);
+  }
+
+  // acquired before the eviction, which may take the new entry itself if it is larger than the cache
+  if (ppTSchema) {
+    atomic_add_fetch_32(&pEntry->nRef, 1);
+    *ppTSchema = pEntry->pTSchema;
+  }
+
+  metaSkmCacheEvict(pCache);
+
+_exit:
+  taosThreadRwlockUnlock(&pCache->sSkmCache.lock);
+  return code;
+}
+
+void metaSkmCacheRelease(SMeta* pMeta, STSchema* pTSchema) {
+  if (pTSchema) {
+    skmCacheEntryUnref((SMetaSkmCacheEntry*)pTSchema - 1);
+  }
+}
+
+// drop all the schema versions of table uid, the acquired ones are freed when released
+int32_t metaSkmCacheDrop(SMeta* pMeta, int64_t uid) {
+  int32_t code = TSDB_CODE_NOT_FOUND;
+
+  SMetaCache* pCache = pMeta->pCache;
+  taosThreadRwlockWrlock(&pCache->sSkmCache.lock);
+
+  int32_t              iBucket = TABS(uid) % pCache->sSkmCache.nBucket;
+  SMetaSkmCacheEntry** ppEntry = &pCache->sSkmCache.aBucket[iBucket];
+  while (*ppEntry) {
+    SMetaSkmCacheEntry* pEntry = *ppEntry;
+    if (pEntry->uid == uid) {
+      *ppEntry = pEntry->next;
+      pCache->sSkmCache.size -= META_SKM_ENTRY_SIZE(pEntry->pTSchema->numOfCols);
+      pCache->sSkmCache.nEntry--;
+      skmCacheEntryUnref(pEntry);
+      code = 0;
+    } else {
+      ppEntry = &pEntry->next;
+    }
+  }
+
+  if (code == 0 && pCache->sSkmCache.nEntry < pCache->sSkmCache.nBucket / 4 &&
+      pCache->sSkmCache.nBucket > META_CACHE_SKM_BUCKET) {
+    code = metaRehashSkmCache(pCache, 0);
+  }
+
+  taosThreadRwlockUnlock(&pCache->sSkmCache.lock);
+  return code;
+}
+
 int32_t metaGetCachedTableUidList(SMeta* pMeta, tb_uid_t suid, const uint8_t* pKey, int32_t keyLen, SArray* pList1,
                                   bool* acquireRes) {
   // generate the composed key for LRU cache
@@ -594,3 +894,480 @@ int32_t metaUidCacheClear(SMeta* pMeta, uint64_t suid) {
   taosThreadMutexUnlock(pLock);
   return TSDB_CODE_SUCCESS;
 }
+
+// set the tbname and tags of row, the row must be allocated in the block
+static int32_t metaTagTableSetRow(SMetaTagTable* pTable, int32_t row, const char* name, const STag* pTag) {
+  int32_t code = 0;
+  char    buf[TSDB_MAX_TAGS_LEN + VARSTR_HEADER_SIZE];
+
+  SColumnInfoData* pColInfo = taosArrayGet(pTable->pBlock->pDataBlock, 0);
+  STR_TO_VARSTR(buf, name);
+  code = colDataAppend(pColInfo, row, buf, false);
+  if (code) return code;
+
+  for (int32_t iCol = 1; iCol < taosArrayGetSize(pTable->pBlock->pDataBlock); iCol++) {
+    pColInfo = taosArrayGet(pTable->pBlock->pDataBlock, iCol);
+
+    STagVal     tagVal = {.cid = pColInfo->info.colId};
+    const char* p = metaGetTableTagVal((void*)pTag, pColInfo->info.type, &tagVal);
+    if (p == NULL) {
+      colDataAppendNULL(pColInfo, row);
+      continue;
+    }
+
+    if (IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+      varDataSetLen(buf, tagVal.nData);
+      memcpy(buf + VARSTR_HEADER_SIZE, tagVal.pData, tagVal.nData);
+      code = colDataAppend(pColInfo, row, buf, false);
+      if (code) return code;
+    } else {
+      colDataClearNull_f(pColInfo->nullbitmap, row);
+      colDataAppend(pColInfo, row, (const char*)&tagVal.i64, false);
+    }
+  }
+
+  return code;
+}
+
+static int32_t metaTagTableAppend(SMetaTagTable* pTable, int64_t uid, const char* name, const STag* pTag) {
+  int32_t code = 0;
+  int32_t row = pTable->pBlock->info.rows;
+
+  if (row >= pTable->pBlock->info.capacity) {
+    code = blockDataEnsureCapacityNoClear(pTable->pBlock, TMAX(row * 2, META_TAG_TABLE_MIN_ROWS));
+    if (code) return code;
+  }
+
+  code = metaTagTableSetRow(pTable, row, name, pTag);
+  if (code) return code;
+
+  if (taosArrayPush(pTable->aUid, &uid) == NULL ||
+      taosHashPut(pTable->pRowIdx, &uid, sizeof(uid), &row, sizeof(row)) != 0) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pTable->pBlock->info.rows++;
+  return code;
+}
+
+// build the tag table of suid from ctb.idx, the meta is read locked
+static int32_t metaTagTableBuild(SMeta* pMeta, int64_t suid, SMetaTagTable** ppTable) {
+  int32_t        code = 0;
+  SMetaTagTable* pTable = NULL;
+  SMetaReader    mr = {0};
+  TBC*           pCtbIdxc = NULL;
+  void*          pKey = NULL;
+  void*          pVal = NULL;
+  int32_t        nKey = 0;
+  int32_t        nVal = 0;
+  int32_t        c = 0;
+
+  // get the tag schema
+  if (tdbTbGet(pMeta->pUidIdx, &suid, sizeof(suid), &pVal, &nVal) < 0) {
+    code = TSDB_CODE_NOT_FOUND;
+    goto _exit;
+  }
+
+  metaReaderInit(&mr, pMeta, META_READER_NOLOCK);
+  if (metaGetTableEntryByVersion(&mr, ((SUidIdxVal*)pVal)->version, suid) != 0 || mr.me.type != TSDB_SUPER_TABLE) {
+    code = TSDB_CODE_NOT_FOUND;
+  } else if (mr.me.stbEntry.schemaTag.nCols <= 0 || mr.me.stbEntry.schemaTag.pSchema[0].type == TSDB_DATA_TYPE_JSON) {
+    code = TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+  if (code) {
+    metaReaderClear(&mr);
+    goto _exit;
+  }
+
+  const SSchemaWrapper* pTagSchema = &mr.me.stbEntry.schemaTag;
+
+  pTable = (SMetaTagTable*)taosMemoryCalloc(1, sizeof(*pTable));
+  if (pTable == NULL) {
+    metaReaderClear(&mr);
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  pTable->suid = suid;
+  pTable->nRef = 1;
+  pTable->aUid = taosArrayInit(META_TAG_TABLE_MIN_ROWS, sizeof(int64_t));
+  // updatable, the row of the last child table changes as it is moved into the place of a dropped one
+  pTable->pRowIdx = taosHashInit(META_TAG_TABLE_MIN_ROWS, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true,
+                                 HASH_NO_LOCK);
+  pTable->pBlock = createDataBlock();
+  if (pTable->aUid == NULL || pTable->pRowIdx == NULL || pTable->pBlock == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SColumnInfoData colInfo = {0};
+  colInfo.info.colId = -1;
+  colInfo.info.type = TSDB_DATA_TYPE_VARCHAR;
+  colInfo.info.bytes = TSDB_TABLE_FNAME_LEN - 1 + VARSTR_HEADER_SIZE;
+  if (code == 0) {
+    code = blockDataAppendColInfo(pTable->pBlock, &colInfo);
+  }
+  for (int32_t iCol = 0; code == 0 && iCol < pTagSchema->nCols; iCol++) {
+    colInfo.info.colId = pTagSchema->pSchema[iCol].colId;
+    colInfo.info.type = pTagSchema->pSchema[iCol].type;
+    colInfo.info.bytes = pTagSchema->pSchema[iCol].bytes;
+    code = blockDataAppendColInfo(pTable->pBlock, &colInfo);
+  }
+  metaReaderClear(&mr);
+  if (code) goto _exit;
+
+  // load the child tables
+  if (tdbTbcOpen(pMeta->pCtbIdx, &pCtbIdxc, NULL) < 0 ||
+      tdbTbcMoveTo(pCtbIdxc, &(SCtbIdxKey){.suid = suid, .uid = INT64_MIN}, sizeof(SCtbIdxKey), &c) < 0) {
+    code = TSDB_CODE_FAILED;
+    goto _exit;
+  }
+  if (c > 0) {
+    tdbTbcMoveToNext(pCtbIdxc);
+  }
+
+  while (tdbTbcNext(pCtbIdxc, &pKey, &nKey, &pVal, &nVal) == 0) {
+    SCtbIdxKey* pCtbIdxKey = (SCtbIdxKey*)pKey;
+    if (pCtbIdxKey->suid != suid) break;
+
+    SUidIdxVal* pUidIdxVal = NULL;
+    int32_t     nUidIdxVal = 0;
+    if (tdbTbGet(pMeta->pUidIdx, &pCtbIdxKey->uid, sizeof(tb_uid_t), (void**)&pUidIdxVal, &nUidIdxVal) < 0) {
+      continue;
+    }
+
+    metaReaderInit(&mr, pMeta, META_READER_NOLOCK);
+    if (metaGetTableEntryByVersion(&mr, pUidIdxVal->version, pCtbIdxKey->uid) == 0) {
+      code = metaTagTableAppend(pTable, pCtbIdxKey->uid, mr.me.name, (const STag*)pVal);
+    }
+    metaReaderClear(&mr);
+    tdbFree(pUidIdxVal);
+    if (code) goto _exit;
+  }
+
+_exit:
+  tdbFree(pKey);
+  tdbFree(pVal);
+  if (pCtbIdxc) tdbTbcClose(pCtbIdxc);
+  if (code) {
+    metaTagTableDestroy(pTable);
+    pTable = NULL;
+  } else {
+    metaDebug("vgId:%d, suid:%" PRId64 " tag table built, rows:%d", TD_VID(pMeta->pVnode), suid,
+              pTable->pBlock->info.rows);
+  }
+  *ppTable = pTable;
+  return code;
+}
+
+// memory taken by the tag table, with the var data of each column as allocated
+static int64_t metaTagTableSize(const SMetaTagTable* pTable) {
+  int32_t capacity = pTable->pBlock->info.capacity;
+  int64_t size = sizeof(*pTable) + sizeof(int64_t) * pTable->aUid->capacity + taosHashGetMemSize(pTable->pRowIdx);
+
+  for (int32_t iCol = 0; iCol < taosArrayGetSize(pTable->pBlock->pDataBlock); iCol++) {
+    SColumnInfoData* pColInfo = taosArrayGet(pTable->pBlock->pDataBlock, iCol);
+    if (IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+      size += sizeof(int32_t) * capacity + pColInfo->varmeta.allocLen;
+    } else {
+      size += (int64_t)pColInfo->info.bytes * capacity + BitmapLen(capacity);
+    }
+  }
+
+  return size;
+}
+
+static void metaTagTableLruUnlink(SMetaTagTable* pTable) {
+  pTable->lruPrev->lruNext = pTable->lruNext;
+  pTable->lruNext->lruPrev = pTable->lruPrev;
+}
+
+static void metaTagTableLruPush(struct STagTableCache* pCache, SMetaTagTable* pTable) {
+  pTable->lruPrev = &pCache->lru;
+  pTable->lruNext = pCache->lru.lruNext;
+  pTable->lruNext->lruPrev = pTable;
+  pCache->lru.lruNext = pTable;
+}
+
+// remove the tag table from the cache, whose reference is released by freeTagTableFp, the cache lock is held
+static void metaTagTableRemove(struct STagTableCache* pCache, SMetaTagTable* pTable) {
+  metaTagTableLruUnlink(pTable);
+  pCache->size -= pTable->size;
+  taosHashRemove(pCache->pTables, &pTable->suid, sizeof(pTable->suid));
+}
+
+// charge the tag table to the cache again as it grows, and evict the least recently queried tables until the cache
+// fits in tsMetaTagTableCacheSize, pTable itself included, the cache lock is held
+static void metaTagTableCharge(struct STagTableCache* pCache, SMetaTagTable* pTable) {
+  int64_t size = metaTagTableSize(pTable);
+  int64_t capacity = (int64_t)tsMetaTagTableCacheSize * 1024 * 1024;
+
+  pCache->size += size - pTable->size;
+  pTable->size = size;
+
+  while (pCache->size > capacity && pCache->lru.lruPrev != &pCache->lru) {
+    metaTagTableRemove(pCache, pCache->lru.lruPrev);
+  }
+}
+
+// get the tag table of suid referenced, to be released by metaTagTableUnref, a query also moves it to the lru head
+static SMetaTagTable* metaTagTableGet(SMeta* pMeta, int64_t suid, bool query) {
+  struct STagTableCache* pCache = &pMeta->pCache->sTagTableCache;
+  SMetaTagTable*         pTable = NULL;
+  SMetaTagTable**        ppTable = NULL;
+
+  taosThreadMutexLock(&pCache->lock);
+  ppTable = taosHashGet(pCache->pTables, &suid, sizeof(suid));
+  if (ppTable) {
+    pTable = *ppTable;
+    atomic_add_fetch_32(&pTable->nRef, 1);
+    if (query) {
+      metaTagTableLruUnlink(pTable);
+      metaTagTableLruPush(pCache, pTable);
+    }
+  }
+  taosThreadMutexUnlock(&pCache->lock);
+
+  return pTable;
+}
+
+// called with the meta write locked when a child table of suid is created or its tags are updated
+int32_t metaTagTableUpsert(SMeta* pMeta, int64_t suid, int64_t uid, const char* name, const STag* pTag) {
+  int32_t        code = 0;
+  SMetaTagTable* pTable = metaTagTableGet(pMeta, suid, false);
+  if (pTable == NULL) {
+    return code;
+  }
+
+  int32_t* pRow = taosHashGet(pTable->pRowIdx, &uid, sizeof(uid));
+  if (pRow) {
+    code = metaTagTableSetRow(pTable, *pRow, name, pTag);
+    pTable->nUpdate++;
+  } else {
+    code = metaTagTableAppend(pTable, uid, name, pTag);
+  }
+
+  if (code || pTable->nUpdate > TMAX(pTable->pBlock->info.rows, META_TAG_TABLE_MIN_ROWS)) {
+    metaTagTableDrop(pMeta, suid);
+  } else {
+    taosThreadMutexLock(&pMeta->pCache->sTagTableCache.lock);
+    metaTagTableCharge(&pMeta->pCache->sTagTableCache, pTable);
+    taosThreadMutexUnlock(&pMeta->pCache->sTagTableCache.lock);
+  }
+
+  metaTagTableUnref(pTable);
+  return code;
+}
+
+// called with the meta write locked when a child table of suid is dropped, the last row is moved into its place
+int32_t metaTagTableDelete(SMeta* pMeta, int64_t suid, int64_t uid) {
+  SMetaTagTable* pTable = metaTagTableGet(pMeta, suid, false);
+  if (pTable == NULL) {
+    return 0;
+  }
+
+  int32_t* pRow = taosHashGet(pTable->pRowIdx, &uid, sizeof(uid));
+  if (pRow == NULL) {
+    metaTagTableUnref(pTable);
+    return TSDB_CODE_NOT_FOUND;
+  }
+
+  int32_t row = *pRow;
+  int32_t last = pTable->pBlock->info.rows - 1;
+  taosHashRemove(pTable->pRowIdx, &uid, sizeof(uid));
+
+  if (row != last) {
+    for (int32_t iCol = 0; iCol < taosArrayGetSize(pTable->pBlock->pDataBlock); iCol++) {
+      SColumnInfoData* pColInfo = taosArrayGet(pTable->pBlock->pDataBlock, iCol);
+
+      if (IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+        pColInfo->varmeta.offset[row] = pColInfo->varmeta.offset[last];
+      } else {
+        if (colDataIsNull_f(pColInfo->nullbitmap, last)) {
+          colDataSetNull_f(pColInfo->nullbitmap, row);
+        } else {
+          colDataClearNull_f(pColInfo->nullbitmap, row);
+        }
+        memcpy(colDataGetNumData(pColInfo, row), colDataGetNumData(pColInfo, last), pColInfo->info.bytes);
+      }
+    }
+
+    int64_t lastUid = *(int64_t*)taosArrayGet(pTable->aUid, last);
+    taosArraySet(pTable->aUid, row, &lastUid);
+    taosHashPut(pTable->pRowIdx, &lastUid, sizeof(lastUid), &row, sizeof(row));
+  }
+
+  taosArrayPop(pTable->aUid);
+  pTable->pBlock->info.rows--;
+  pTable->nUpdate++;
+
+  if (pTable->nUpdate > TMAX(pTable->pBlock->info.rows, META_TAG_TABLE_MIN_ROWS)) {
+    metaTagTableDrop(pMeta, suid);
+  }
+
+  metaTagTableUnref(pTable);
+  return 0;
+}
+
+// called with the meta write locked when the super table is dropped or its tag schema is altered
+int32_t metaTagTableDrop(SMeta* pMeta, int64_t suid) {
+  struct STagTableCache* pCache = &pMeta->pCache->sTagTableCache;
+  int32_t                code = TSDB_CODE_NOT_FOUND;
+
+  taosThreadMutexLock(&pCache->lock);
+  SMetaTagTable** ppTable = taosHashGet(pCache->pTables, &suid, sizeof(suid));
+  if (ppTable) {
+    metaTagTableRemove(pCache, *ppTable);
+    code = 0;
+  }
+  taosThreadMutexUnlock(&pCache->lock);
+
+  return code;
+}
+
+// called when the uncommitted meta writes are rolled back, which the tag tables may have taken in
+void metaTagTableClear(SMeta* pMeta) {
+  struct STagTableCache* pCache = &pMeta->pCache->sTagTableCache;
+
+  taosThreadMutexLock(&pCache->lock);
+  taosHashClear(pCache->pTables);
+  pCache->size = 0;
+  pCache->lru.lruPrev = &pCache->lru;
+  pCache->lru.lruNext = &pCache->lru;
+  taosThreadMutexUnlock(&pCache->lock);
+}
+
+/*
+ * Fill the columns of pBlock, tbname (colId -1) or tags, with the child tables in uidList from the tag table of suid.
+ * The uids not belonging to suid are removed from uidList, and all the child tables are added if uidList is empty.
+ * The caller falls back to decode the tags of each table if it is not TSDB_CODE_SUCCESS.
+ */
+int32_t metaGetTableTagBlock(SMeta* pMeta, uint64_t suid, SArray* uidList, SSDataBlock* pBlock) {
+  int32_t        code = 0;
+  int32_t        nCol = taosArrayGetSize(pBlock->pDataBlock);
+  int32_t*       aSlot = NULL;
+  int32_t*       aRow = NULL;
+  SMetaTagTable* pTable = NULL;
+
+  if (tsMetaTagTableCacheSize <= 0) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  metaRLock(pMeta);
+
+  pTable = metaTagTableGet(pMeta, suid, true);
+  if (pTable == NULL) {
+    code = metaTagTableBuild(pMeta, suid, &pTable);
+    if (code) goto _exit;
+
+    // the query keeps a reference to the table even if it is evicted right away
+    struct STagTableCache* pCache = &pMeta->pCache->sTagTableCache;
+    taosThreadMutexLock(&pCache->lock);
+    SMetaTagTable** ppTable = taosHashGet(pCache->pTables, &suid, sizeof(suid));
+    if (ppTable) {  // built by others
+      metaTagTableDestroy(pTable);
+      pTable = *ppTable;
+      atomic_add_fetch_32(&pTable->nRef, 1);
+    } else if (taosHashPut(pCache->pTables, &suid, sizeof(suid), &pTable, POINTER_BYTES) != 0) {
+      metaTagTableDestroy(pTable);
+      pTable = NULL;
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    } else {
+      atomic_add_fetch_32(&pTable->nRef, 1);
+      metaTagTableLruPush(pCache, pTable);
+      metaTagTableCharge(pCache, pTable);
+    }
+    taosThreadMutexUnlock(&pCache->lock);
+    if (code) goto _exit;
+  }
+
+  // map the columns of pBlock to the tag table
+  aSlot = taosMemoryMalloc(sizeof(int32_t) * (nCol + 1));
+  if (aSlot == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+  for (int32_t iCol = 0; iCol < nCol; iCol++) {
+    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, iCol);
+
+    aSlot[iCol] = -1;
+    for (int32_t iSlot = 0; iSlot < taosArrayGetSize(pTable->pBlock->pDataBlock); iSlot++) {
+      SColumnInfoData* pSrc = taosArrayGet(pTable->pBlock->pDataBlock, iSlot);
+      if (pSrc->info.colId == pColInfo->info.colId && pSrc->info.type == pColInfo->info.type) {
+        aSlot[iCol] = iSlot;
+        break;
+      }
+    }
+
+    if (aSlot[iCol] < 0) {
+      code = TSDB_CODE_NOT_FOUND;
+      goto _exit;
+    }
+  }
+
+  // locate the rows
+  if (taosArrayGetSize(uidList) == 0) {
+    taosArrayAddAll(uidList, pTable->aUid);
+  }
+
+  int32_t nRows = taosArrayGetSize(uidList);
+  bool    inOrder = (nRows == pTable->pBlock->info.rows);
+
+  aRow = taosMemoryMalloc(sizeof(int32_t) * (nRows + 1));
+  if (aRow == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  int32_t n = 0;
+  for (int32_t i = 0; i < nRows; i++) {
+    int64_t* uid = taosArrayGet(uidList, i);
+    int32_t* pRow = taosHashGet(pTable->pRowIdx, uid, sizeof(int64_t));
+    if (pRow == NULL) {
+      continue;
+    }
+
+    if (n != i) {
+      taosArraySet(uidList, n, uid);
+    }
+    aRow[n] = *pRow;
+    inOrder = inOrder && (aRow[n] == n);
+    n++;
+  }
+  taosArrayPopTailBatch(uidList, nRows - n);
+  nRows = n;
+
+  if (nRows > 0) {
+    code = blockDataEnsureCapacity(pBlock, nRows);
+    if (code) goto _exit;
+  }
+
+  // fill the columns, by whole columns if uidList is in the order of the tag table
+  for (int32_t iCol = 0; iCol < nCol; iCol++) {
+    SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, iCol);
+    SColumnInfoData* pSrc = taosArrayGet(pTable->pBlock->pDataBlock, aSlot[iCol]);
+
+    if (inOrder) {
+      code = colDataAssign(pColInfo, pSrc, nRows, &pBlock->info);
+      if (code) goto _exit;
+      continue;
+    }
+
+    for (int32_t i = 0; i < nRows; i++) {
+      if (colDataIsNull_s(pSrc, aRow[i])) {
+        colDataAppendNULL(pColInfo, i);
+      } else {
+        code = colDataAppend(pColInfo, i, colDataGetData(pSrc, aRow[i]), false);
+        if (code) goto _exit;
+      }
+    }
+  }
+
+  pBlock->info.rows = nRows;
+
+_exit:
+  if (pTable) metaTagTableUnref(pTable);
+  metaULock(pMeta);
+  taosMemoryFree(aSlot);
+  taosMemoryFree(aRow);
+  return code;
+}
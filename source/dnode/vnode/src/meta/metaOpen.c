@@ -69,6 +69,12 @@ int metaOpen(SVnode *pVnode, SMeta **ppMeta, int8_t rollback) {
     goto _err;
   }
 
+  // commit to a redo log instead of the rollback journal
+  if (tsMetaWalSize > 0 && tdbSetWal(pMeta->pEnv, (int64_t)tsMetaWalSize * 1024 * 1024) < 0) {
+    metaError("vgId:%d, failed to set meta wal since %s", TD_VID(pVnode), tstrerror(terrno));
+    goto _err;
+  }
+
   // open pTbDb
   ret = tdbTbOpen("table.db", sizeof(STbDbKey), -1, tbDbKeyCmpr, pMeta->pEnv, &pMeta->pTbDb, 0);
   if (ret < 0) {
@@ -611,7 +611,7 @@ tb_uid_t metaStbCursorNext(SMStbCursor *pStbCur) {
   return *(tb_uid_t *)pStbCur->pKey;
 }
 
-STSchema *metaGetTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, int lock) {
+static STSchema *metaLoadTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, int lock) {
   // SMetaReader     mr = {0};
   STSchema       *pTSchema = NULL;
   SSchemaWrapper *pSW = NULL;
@@ -635,102 +635,197 @@ STSchema *metaGetTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, int lock) {
   return pTSchema;
 }
 
-int32_t metaGetTbTSchemaEx(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema **ppTSchema) {
-  int32_t code = 0;
+// resolve uid to the table owning the schema, and sver <= 0 to its latest schema version
+static int32_t metaGetTbSkmKey(SMeta *pMeta, tb_uid_t uid, int32_t sver, SSkmDbKey *pKey) {
+  SMetaInfo info;
 
-  void     *pData = NULL;
-  int       nData = 0;
-  SSkmDbKey skmDbKey;
+  int32_t code = metaGetInfo(pMeta, uid, &info, NULL);
+  if (code) return code;
+
+  pKey->uid = info.suid ? info.suid : uid;
+  pKey->sver = sver;
   if (sver <= 0) {
-    SMetaInfo info;
-    if (metaGetInfo(pMeta, suid ? suid : uid, &info, NULL) == 0) {
-      sver = info.skmVer;
-    } else {
-      TBC *pSkmDbC = NULL;
-      int  c;
+    if (pKey->uid != uid) {
+      code = metaGetInfo(pMeta, pKey->uid, &info, NULL);
+      if (code) return code;
+    }
+    pKey->sver = info.skmVer;
+  }
 
-      skmDbKey.uid = suid ? suid : uid;
-      skmDbKey.sver = INT32_MAX;
+  return code;
+}
 
-      tdbTbcOpen(pMeta->pSkmDb, &pSkmDbC, NULL);
-      metaRLock(pMeta);
+// the latest schema version of table uid, which may be dropped already and only left in the schema db
+static int32_t metaGetLatestSkmVer(SMeta *pMeta, tb_uid_t uid, int32_t *sver) {
+  int32_t   code = 0;
+  TBC      *pSkmDbC = NULL;
+  int       c;
+  SMetaInfo info;
 
-      if (tdbTbcMoveTo(pSkmDbC, &skmDbKey, sizeof(skmDbKey), &c) < 0) {
-        metaULock(pMeta);
-        tdbTbcClose(pSkmDbC);
-        code = TSDB_CODE_NOT_FOUND;
-        goto _exit;
-      }
+  if (metaGetInfo(pMeta, uid, &info, NULL) == 0) {
+    *sver = info.skmVer;
+    return code;
+  }
 
-      ASSERT(c);
+  SSkmDbKey skmDbKey = {.uid = uid, .sver = INT32_MAX};
 
-      if (c < 0) {
-        tdbTbcMoveToPrev(pSkmDbC);
-      }
+  tdbTbcOpen(pMeta->pSkmDb, &pSkmDbC, NULL);
+  metaRLock(pMeta);
 
-      const void *pKey = NULL;
-      int32_t     nKey = 0;
-      tdbTbcGet(pSkmDbC, &pKey, &nKey, NULL, NULL);
+  if (tdbTbcMoveTo(pSkmDbC, &skmDbKey, sizeof(skmDbKey), &c) < 0) {
+    code = TSDB_CODE_NOT_FOUND;
+    goto _exit;
+  }
 
-      if (((SSkmDbKey *)pKey)->uid != skmDbKey.uid) {
-        metaULock(pMeta);
-        tdbTbcClose(pSkmDbC);
-        code = TSDB_CODE_NOT_FOUND;
-        goto _exit;
-      }
+  ASSERT(c);
 
-      sver = ((SSkmDbKey *)pKey)->sver;
+  if (c < 0) {
+    tdbTbcMoveToPrev(pSkmDbC);
+  }
 
-      metaULock(pMeta);
-      tdbTbcClose(pSkmDbC);
-    }
+  const void *pKey = NULL;
+  int32_t     nKey = 0;
+  tdbTbcGet(pSkmDbC, &pKey, &nKey, NULL, NULL);
+
+  if (((SSkmDbKey *)pKey)->uid != uid) {
+    code = TSDB_CODE_NOT_FOUND;
+    goto _exit;
   }
 
-  ASSERT(sver > 0);
+  *sver = ((SSkmDbKey *)pKey)->sver;
+
+_exit:
+  metaULock(pMeta);
+  tdbTbcClose(pSkmDbC);
+  return code;
+}
+
+// read and decode the schema (uid, sver) from the schema db
+static STSchema *metaLoadSkm(SMeta *pMeta, const SSkmDbKey *pSkmDbKey) {
+  void *pData = NULL;
+  int   nData = 0;
 
-  skmDbKey.uid = suid ? suid : uid;
-  skmDbKey.sver = sver;
   metaRLock(pMeta);
-  if (tdbTbGet(pMeta->pSkmDb, &skmDbKey, sizeof(SSkmDbKey), &pData, &nData) < 0) {
+  if (tdbTbGet(pMeta->pSkmDb, pSkmDbKey, sizeof(SSkmDbKey), &pData, &nData) < 0) {
     metaULock(pMeta);
-    code = TSDB_CODE_NOT_FOUND;
-    goto _exit;
+    return NULL;
   }
   metaULock(pMeta);
 
   // decode
-  SDecoder        dc = {0};
-  SSchemaWrapper  schema;
-  SSchemaWrapper *pSchemaWrapper = &schema;
+  SDecoder       dc = {0};
+  SSchemaWrapper schema = {0};
 
   tDecoderInit(&dc, pData, nData);
-  (void)tDecodeSSchemaWrapper(&dc, pSchemaWrapper);
+  (void)tDecodeSSchemaWrapper(&dc, &schema);
   tDecoderClear(&dc);
   tdbFree(pData);
 
   // convert
   STSchemaBuilder sb = {0};
 
-  tdInitTSchemaBuilder(&sb, pSchemaWrapper->version);
-  for (int i = 0; i < pSchemaWrapper->nCols; i++) {
-    SSchema *pSchema = pSchemaWrapper->pSchema + i;
+  tdInitTSchemaBuilder(&sb, schema.version);
+  for (int i = 0; i < schema.nCols; i++) {
+    SSchema *pSchema = schema.pSchema + i;
     tdAddColToSchema(&sb, pSchema->type, pSchema->flags, pSchema->colId, pSchema->bytes);
   }
 
   STSchema *pTSchema = tdGetSchemaFromBuilder(&sb);
-  if (pTSchema == NULL) {
-    code = TSDB_CODE_OUT_OF_MEMORY;
-  }
 
   tdDestroyTSchemaBuilder(&sb);
+  taosMemoryFree(schema.pSchema);
+  return pTSchema;
+}
+
+// acquire the schema (uid, sver) from the schema cache, loaded into it on a miss
+static int32_t metaAcquireSkm(SMeta *pMeta, const SSkmDbKey *pSkmDbKey, STSchema **ppTSchema) {
+  int32_t code = 0;
 
-  *ppTSchema = pTSchema;
-  taosMemoryFree(pSchemaWrapper->pSchema);
+  if (metaSkmCacheGet(pMeta, pSkmDbKey->uid, pSkmDbKey->sver, ppTSchema) == 0) {
+    return code;
+  }
 
-_exit:
+  STSchema *pTSchema = metaLoadSkm(pMeta, pSkmDbKey);
+  if (pTSchema == NULL) {
+    return TSDB_CODE_NOT_FOUND;
+  }
+
+  code = metaSkmCachePut(pMeta, pSkmDbKey->uid, pTSchema, ppTSchema);
+  tDestroyTSchema(pTSchema);
   return code;
 }
 
+static STSchema *metaDupTSchema(const STSchema *pTSchema) {
+  int32_t   size = sizeof(STSchema) + sizeof(STColumn) * pTSchema->numOfCols;
+  STSchema *pDup = (STSchema *)taosMemoryMalloc(size);
+  if (pDup) {
+    memcpy(pDup, pTSchema, size);
+  }
+  return pDup;
+}
+
+// the acquired schema is shared and immutable, release it by metaReleaseTbTSchema
+int32_t metaAcquireTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, STSchema **ppTSchema) {
+  int32_t   code = 0;
+  SSkmDbKey skmDbKey;
+
+  *ppTSchema = NULL;
+
+  code = metaGetTbSkmKey(pMeta, uid, sver, &skmDbKey);
+  if (code) return code;
+
+  return metaAcquireSkm(pMeta, &skmDbKey, ppTSchema);
+}
+
+// as metaAcquireTbTSchema, with the super table of uid given, which also finds the schema of a dropped child table
+int32_t metaAcquireTbTSchemaEx(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema **ppTSchema) {
+  int32_t   code = 0;
+  SSkmDbKey skmDbKey = {.uid = suid ? suid : uid, .sver = sver};
+
+  *ppTSchema = NULL;
+
+  if (sver <= 0) {
+    code = metaGetLatestSkmVer(pMeta, skmDbKey.uid, &skmDbKey.sver);
+    if (code) return code;
+  }
+
+  ASSERT(skmDbKey.sver > 0);
+
+  return metaAcquireSkm(pMeta, &skmDbKey, ppTSchema);
+}
+
+void metaReleaseTbTSchema(SMeta *pMeta, STSchema *pTSchema) { metaSkmCacheRelease(pMeta, pTSchema); }
+
+// a private copy of the schema for the callers keeping it across meta changes, the hot paths acquire it instead
+STSchema *metaGetTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, int lock) {
+  STSchema *pTSchema = NULL;
+  STSchema *pCached = NULL;
+
+  if (!lock) {
+    return metaLoadTbTSchema(pMeta, uid, sver, lock);
+  }
+
+  if (metaAcquireTbTSchema(pMeta, uid, sver, &pCached) == 0) {
+    pTSchema = metaDupTSchema(pCached);
+    metaReleaseTbTSchema(pMeta, pCached);
+  }
+
+  return pTSchema;
+}
+
+int32_t metaGetTbTSchemaEx(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema **ppTSchema) {
+  STSchema *pCached = NULL;
+
+  *ppTSchema = NULL;
+
+  int32_t code = metaAcquireTbTSchemaEx(pMeta, suid, uid, sver, &pCached);
+  if (code) return code;
+
+  *ppTSchema = metaDupTSchema(pCached);
+  metaReleaseTbTSchema(pMeta, pCached);
+  return *ppTSchema ? 0 : TSDB_CODE_OUT_OF_MEMORY;
+}
+
 // N.B. Called by statusReq per second
 int64_t metaGetTbNum(SMeta *pMeta) {
   // num of child tables (excluding normal tables , stables and others)
@@ -1427,10 +1522,11 @@ int32_t metaGetInfo(SMeta *pMeta, int64_t uid, SMetaInfo *pInfo, SMetaReader *pR
   }
 
   // search TDB
+  terrno = TSDB_CODE_SUCCESS;
   if (tdbTbGet(pMeta->pUidIdx, &uid, sizeof(uid), &pData, &nData) < 0) {
-    // not found
+    // not found, unless the lookup itself failed
     metaULock(pMeta);
-    code = TSDB_CODE_NOT_FOUND;
+    code = (terrno == TSDB_CODE_OUT_OF_MEMORY) ? terrno : TSDB_CODE_NOT_FOUND;
     goto _exit;
   }
 
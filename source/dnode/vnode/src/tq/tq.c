@@ -106,7 +106,8 @@ STQ* tqOpen(const char* path, SVnode* pVnode) {
     ASSERT(0);
   }
 
-  if (streamLoadTasks(pTq->pStreamMeta) < 0) {
+  // the wal after the committed version is pushed to the tasks again when it is replayed
+  if (streamLoadTasks(pTq->pStreamMeta, pTq->pVnode->state.committed) < 0) {
     ASSERT(0);
   }
 
@@ -1232,6 +1233,81 @@ int32_t tqProcessTaskRecoverFinishRsp(STQ* pTq, SRpcMsg* pMsg) {
   return 0;
 }
 
+int32_t tqProcessStreamCheckpointSourceReq(STQ* pTq, SRpcMsg* pMsg) {
+  char*   msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointSourceReq req;
+  SDecoder                   decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointSourceReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_INVALID_MSG;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, req.taskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  // rsp is sent once the checkpoint of the task is done
+  int32_t code = streamProcessCheckpointSourceReq(pTq->pStreamMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return code;
+}
+
+int32_t tqProcessTaskCheckpointReq(STQ* pTq, SRpcMsg* pMsg) {
+  char*   msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointReq req;
+  SDecoder             decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_INVALID_MSG;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, req.downstreamTaskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  int32_t code = streamProcessCheckpointReq(pTq->pStreamMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return code;
+}
+
+int32_t tqProcessTaskCheckpointRsp(STQ* pTq, SRpcMsg* pMsg) {
+  char*   msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointRsp rsp;
+  SDecoder             decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointRsp(&decoder, &rsp) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_INVALID_MSG;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, rsp.upstreamTaskId);
+  if (pTask == NULL) {
+    return -1;
+  }
+
+  streamProcessCheckpointRsp(pTq->pStreamMeta, pTask, &rsp, pMsg->code);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return 0;
+}
+
 int32_t tqProcessDelReq(STQ* pTq, void* pReq, int32_t len, int64_t ver) {
   bool        failed = false;
   SDecoder*   pCoder = &(SDecoder){0};
@@ -1358,6 +1434,8 @@ int32_t tqProcessSubmitReq(STQ* pTq, SSubmitReq* pReq, int64_t ver) {
     terrno = TSDB_CODE_OUT_OF_MEMORY;
     tqError("failed to create data submit for stream since out of memory");
     failed = true;
+  } else {
+    pSubmit->ver = ver;
   }
 
   while (1) {
@@ -1369,6 +1447,11 @@ int32_t tqProcessSubmitReq(STQ* pTq, SSubmitReq* pReq, int64_t ver) {
       tqDebug("skip push task %d, task status %d", pTask->taskId, pTask->taskStatus);
       continue;
     }
+    if (ver <= pTask->chkInfo.checkpointVer) {
+      tqDebug("skip push task %d, ver %" PRId64 " covered by checkpoint %" PRId64, pTask->taskId, ver,
+              pTask->chkInfo.checkpointId);
+      continue;
+    }
 
     tqDebug("data submit enqueue stream task: %d, ver: %" PRId64, pTask->taskId, ver);
 
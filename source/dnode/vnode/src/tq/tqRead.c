@@ -282,7 +282,7 @@ void tqCloseReader(STqReader* pReader) {
   }
   // free cached schema
   if (pReader->pSchema) {
-    taosMemoryFree(pReader->pSchema);
+    metaReleaseTbTSchema(pReader->pVnodeMeta, pReader->pSchema);
   }
   if (pReader->pSchemaWrapper) {
     tDeleteSSchemaWrapper(pReader->pSchemaWrapper);
@@ -448,8 +448,8 @@ int32_t tqRetrieveDataBlock(SSDataBlock* pBlock, STqReader* pReader) {
   int32_t sversion = htonl(pReader->pBlock->sversion);
   if (pReader->cachedSchemaSuid == 0 || pReader->cachedSchemaVer != sversion ||
       pReader->cachedSchemaSuid != pReader->msgIter.suid) {
-    if (pReader->pSchema) taosMemoryFree(pReader->pSchema);
-    pReader->pSchema = metaGetTbTSchema(pReader->pVnodeMeta, pReader->msgIter.uid, sversion, 1);
+    metaReleaseTbTSchema(pReader->pVnodeMeta, pReader->pSchema);
+    metaAcquireTbTSchema(pReader->pVnodeMeta, pReader->msgIter.uid, sversion, &pReader->pSchema);
     if (pReader->pSchema == NULL) {
       tqWarn("cannot found tsschema for table: uid:%" PRId64 " (suid:%" PRId64 "), version %d, possibly dropped table",
              pReader->msgIter.uid, pReader->msgIter.suid, pReader->cachedSchemaVer);
@@ -562,8 +562,8 @@ int32_t tqRetrieveTaosxBlock(STqReader* pReader, SArray* blocks, SArray* schemas
 
   if (pReader->cachedSchemaSuid == 0 || pReader->cachedSchemaVer != sversion ||
       pReader->cachedSchemaSuid != pReader->msgIter.suid) {
-    if (pReader->pSchema) taosMemoryFree(pReader->pSchema);
-    pReader->pSchema = metaGetTbTSchema(pReader->pVnodeMeta, pReader->msgIter.uid, sversion, 1);
+    metaReleaseTbTSchema(pReader->pVnodeMeta, pReader->pSchema);
+    metaAcquireTbTSchema(pReader->pVnodeMeta, pReader->msgIter.uid, sversion, &pReader->pSchema);
     if (pReader->pSchema == NULL) {
       tqWarn("cannot found tsschema for table: uid:%" PRId64 " (suid:%" PRId64 "), version %d, possibly dropped table",
              pReader->msgIter.uid, pReader->msgIter.suid, pReader->cachedSchemaVer);
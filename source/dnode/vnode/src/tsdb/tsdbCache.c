@@ -46,6 +46,110 @@ void tsdbCloseCache(STsdb *pTsdb) {
   }
 }
 
+// page cache of data files ========================================
+int32_t tsdbOpenPgCache(STsdb *pTsdb) {
+  int32_t    code = 0;
+  SLRUCache *pCache = NULL;
+  size_t     cfgCapacity = (size_t)tsTsdbPageCacheSize * 1024 * 1024;
+
+  if (cfgCapacity == 0) goto _err;
+
+  pCache = taosLRUCacheInit(cfgCapacity, -1, .5);
+  if (pCache == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  taosLRUCacheSetStrictCapacity(pCache, false);
+
+_err:
+  pTsdb->pgCache = pCache;
+  return code;
+}
+
+void tsdbClosePgCache(STsdb *pTsdb) {
+  SLRUCache *pCache = pTsdb->pgCache;
+  if (pCache) {
+    taosLRUCacheEraseUnrefEntries(pCache);
+
+    taosLRUCacheCleanup(pCache);
+
+    pTsdb->pgCache = NULL;
+  }
+}
+
+static int32_t getPgCacheKey(const char *path, int64_t pgno, char *key) {
+  int32_t len = strlen(path);
+
+  *(int64_t *)key = pgno;
+  memcpy(key + sizeof(int64_t), path, len);
+
+  return sizeof(int64_t) + len;
+}
+
+static void deletePgCacheEntry(const void *key, size_t keyLen, void *value) { taosMemoryFree(value); }
+
+bool tsdbPgCacheGet(STsdb *pTsdb, const char *path, int64_t pgno, uint8_t *pPage, int32_t szPage) {
+  SLRUCache *pCache = pTsdb->pgCache;
+  char       key[sizeof(int64_t) + TSDB_FILENAME_LEN];
+
+  if (pCache == NULL) return false;
+
+  int32_t    keyLen = getPgCacheKey(path, pgno, key);
+  LRUHandle *h = taosLRUCacheLookup(pCache, key, keyLen);
+  if (h == NULL) {
+    return false;
+  }
+
+  memcpy(pPage, taosLRUCacheValue(pCache, h), szPage);
+  taosLRUCacheRelease(pCache, h, false);
+
+  return true;
+}
+
+void tsdbPgCachePut(STsdb *pTsdb, const char *path, int64_t pgno, const uint8_t *pPage, int32_t szPage) {
+  SLRUCache *pCache = pTsdb->pgCache;
+  char       key[sizeof(int64_t) + TSDB_FILENAME_LEN];
+
+  if (pCache == NULL) return;
+
+  uint8_t *pValue = taosMemoryMalloc(szPage);
+  if (pValue == NULL) return;  // caching is best effort
+  memcpy(pValue, pPage, szPage);
+
+  int32_t   keyLen = getPgCacheKey(path, pgno, key);
+  LRUStatus status =
+      taosLRUCacheInsert(pCache, key, keyLen, pValue, szPage, deletePgCacheEntry, NULL, TAOS_LRU_PRIORITY_LOW);
+  if (status != TAOS_LRU_STATUS_OK && status != TAOS_LRU_STATUS_OK_OVERWRITTEN) {
+    tsdbDebug("vgId:%d, failed to insert page %" PRId64 " of %s into page cache, status:%d", TD_VID(pTsdb->pVnode),
+              pgno, path, status);
+  }
+}
+
+bool tsdbPgCacheContains(STsdb *pTsdb, const char *path, int64_t pgno) {
+  SLRUCache *pCache = pTsdb->pgCache;
+  char       key[sizeof(int64_t) + TSDB_FILENAME_LEN];
+
+  if (pCache == NULL) return false;
+
+  int32_t    keyLen = getPgCacheKey(path, pgno, key);
+  LRUHandle *h = taosLRUCacheLookup(pCache, key, keyLen);
+  if (h == NULL) return false;
+
+  taosLRUCacheRelease(pCache, h, false);
+  return true;
+}
+
+void tsdbPgCacheErase(STsdb *pTsdb, const char *path, int64_t pgno) {
+  SLRUCache *pCache = pTsdb->pgCache;
+  char       key[sizeof(int64_t) + TSDB_FILENAME_LEN];
+
+  if (pCache == NULL) return;
+
+  int32_t keyLen = getPgCacheKey(path, pgno, key);
+  taosLRUCacheErase(pCache, key, keyLen);
+}
+
 static void getTableCacheKey(tb_uid_t uid, int cacheType, char *key, int *len) {
   if (cacheType == 0) {  // last_row
     *(uint64_t *)key = (uint64_t)uid;
@@ -200,10 +304,12 @@ int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, ST
   getTableCacheKey(uid, 0, key, &keyLen);
   LRUHandle *h = taosLRUCacheLookup(pCache, key, keyLen);
   if (h) {
-    STSchema *pTSchema = metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
+    STSchema *pTSchema = NULL;
     TSKEY     keyTs = row->ts;
     bool      invalidate = false;
 
+    metaAcquireTbTSchema(pTsdb->pVnode->pMeta, uid, -1, &pTSchema);
+
     SArray *pLast = (SArray *)taosLRUCacheValue(pCache, h);
     int16_t nCol = taosArrayGetSize(pLast);
     int16_t iCol = 0;
@@ -250,7 +356,7 @@ int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, ST
     }
 
   _invalidate:
-    taosMemoryFreeClear(pTSchema);
+    metaReleaseTbTSchema(pTsdb->pVnode->pMeta, pTSchema);
 
     taosLRUCacheRelease(pCache, h, invalidate);
     if (invalidate) {
@@ -271,10 +377,12 @@ int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb
   getTableCacheKey(uid, 1, key, &keyLen);
   LRUHandle *h = taosLRUCacheLookup(pCache, key, keyLen);
   if (h) {
-    STSchema *pTSchema = metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
+    STSchema *pTSchema = NULL;
     TSKEY     keyTs = row->ts;
     bool      invalidate = false;
 
+    metaAcquireTbTSchema(pTsdb->pVnode->pMeta, uid, -1, &pTSchema);
+
     SArray *pLast = (SArray *)taosLRUCacheValue(pCache, h);
     int16_t nCol = taosArrayGetSize(pLast);
     int16_t iCol = 0;
@@ -321,7 +429,7 @@ int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb
     }
 
   _invalidate:
-    taosMemoryFreeClear(pTSchema);
+    metaReleaseTbTSchema(pTsdb->pVnode->pMeta, pTSchema);
 
     taosLRUCacheRelease(pCache, h, invalidate);
     if (invalidate) {
@@ -677,6 +677,13 @@ int32_t tsdbWriteSttBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SArray
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
+  if (pBlockData->uid) {
+    code = tsdbAddSttBlkUid(pWriter, &pBlockData->uid, 1);
+  } else {
+    code = tsdbAddSttBlkUid(pWriter, pBlockData->aUid, pBlockData->nRow);
+  }
+  TSDB_CHECK_CODE(code, lino, _exit);
+
   // clear
   tBlockDataClear(pBlockData);
 
@@ -718,6 +725,9 @@ static int32_t tsdbCommitSttBlk(SDataFWriter *pWriter, SDiskDataBuilder *pBuilde
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
+  code = tsdbAddSttBlkUid(pWriter, (int64_t *)pBuilder->aUid->pData, taosArrayGetSize(pBuilder->aUid));
+  TSDB_CHECK_CODE(code, lino, _exit);
+
   // clear
   tDiskDataBuilderClear(pBuilder);
 
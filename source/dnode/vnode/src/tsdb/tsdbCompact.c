@@ -15,13 +15,898 @@
 
 #include "tsdb.h"
 
+typedef enum { TSDB_COMPACT_DATA_ITER = 0, TSDB_COMPACT_STT_ITER } ECompactIterT;
+typedef struct {
+  SRBTreeNode   n;
+  SRowInfo      rInfo;
+  ECompactIterT type;
+  union {
+    struct {
+      SArray    *aBlockIdx;
+      int32_t    iBlockIdx;
+      SBlockIdx *pBlockIdx;
+      SMapData   mBlock;
+      int32_t    iBlock;
+    };  // .data file
+    struct {
+      int32_t iStt;
+      SArray *aSttBlk;
+      int32_t iSttBlk;
+    };  // .stt file
+  };
+  SBlockData bData;
+  int32_t    iRow;
+} SCompactIter;
+
 typedef struct {
   STsdb  *pTsdb;
   STsdbFS fs;
+  // config
+  int64_t commitID;
+  int32_t minRow;
+  int32_t maxRow;
+  int8_t  cmprAlg;
+  // reader
+  SDataFReader *pReader;
+  SCompactIter *pIter;
+  SRBTree       rbt;
+  SCompactIter  aIter[TSDB_MAX_STT_TRIGGER + 1];
+  // del
+  SDelFile *pDelFile;
+  SDelFile  delFile;    // the del file aDelIdx and aDelRange are loaded from
+  SArray   *aDelIdx;    // SArray<SDelIdx>
+  SArray   *aDelRange;  // SArray<SDelData>, the deletes of all the tables
+  SArray   *aDelData;   // SArray<SDelData>
+  SArray   *aSkyline;  // SArray<TSDBKEY>
+  int32_t   iSkyline;
+  // table
+  TABLEID  tbid;
+  int8_t   dropped;
+  SSkmInfo skmTable;
+  // writer
+  SDataFWriter *pWriter;
+  SArray       *aBlockIdx;  // SArray<SBlockIdx>
+  SArray       *aSttBlk;    // SArray<SSttBlk>
+  SMapData      mDataBlk;
+  SBlockData    bData;
+  SBlockData    sData;
+  // throttle
+  int64_t sTime;
+  int64_t nBytes;
 } STsdbCompactor;
 
-int32_t tsdbCompact(STsdb *pTsdb) {
+extern int32_t tRowInfoCmprFn(const void *p1, const void *p2);
+extern int32_t tsdbReadDataBlockEx(SDataFReader *pReader, SDataBlk *pDataBlk, SBlockData *pBlockData);
+extern int32_t tsdbUpdateTableSchema(SMeta *pMeta, int64_t suid, int64_t uid, SSkmInfo *pSkmInfo);
+extern int32_t tsdbWriteDataBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SMapData *mDataBlk, int8_t cmprAlg);
+extern int32_t tsdbWriteSttBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SArray *aSttBlk, int8_t cmprAlg);
+
+static int32_t tCompactIterCmprFn(const SRBTreeNode *pNode1, const SRBTreeNode *pNode2) {
+  SCompactIter *pIter1 = (SCompactIter *)(((uint8_t *)pNode1) - offsetof(SCompactIter, n));
+  SCompactIter *pIter2 = (SCompactIter *)(((uint8_t *)pNode2) - offsetof(SCompactIter, n));
+
+  return tRowInfoCmprFn(&pIter1->rInfo, &pIter2->rInfo);
+}
+
+static int32_t tsdbCompactLoadDel(STsdbCompactor *pCompactor, SDelFile *pDelFile) {
+  int32_t      code = 0;
+  int32_t      lino = 0;
+  SDelFReader *pDelFReader = NULL;
+
+  // a new del file is only written by a commit with deletes
+  if (pDelFile && pCompactor->aDelIdx && pCompactor->delFile.commitID == pDelFile->commitID &&
+      pCompactor->delFile.size == pDelFile->size) {
+    goto _exit;
+  }
+
+  taosArrayDestroy(pCompactor->aDelIdx);
+  pCompactor->aDelIdx = NULL;
+  taosArrayClear(pCompactor->aDelRange);
+  if (pDelFile == NULL) goto _exit;
+
+  pCompactor->aDelIdx = taosArrayInit(0, sizeof(SDelIdx));
+  if (pCompactor->aDelIdx == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tsdbDelFReaderOpen(&pDelFReader, pDelFile, pCompactor->pTsdb);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbReadDelIdx(pDelFReader, pCompactor->aDelIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  for (int32_t iDelIdx = 0; iDelIdx < taosArrayGetSize(pCompactor->aDelIdx); iDelIdx++) {
+    code = tsdbReadDelData(pDelFReader, (SDelIdx *)taosArrayGet(pCompactor->aDelIdx, iDelIdx), pCompactor->aDelData);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (taosArrayAddAll(pCompactor->aDelRange, pCompactor->aDelData) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  pCompactor->delFile = *pDelFile;
+
+_exit:
+  if (pDelFReader) {
+    tsdbDelFReaderClose(&pDelFReader);
+  }
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+    taosArrayDestroy(pCompactor->aDelIdx);
+    pCompactor->aDelIdx = NULL;
+  }
+  return code;
+}
+
+static bool tsdbShouldCompact(STsdbCompactor *pCompactor, SDFileSet *pSet, int64_t *pDelVer) {
+  STsdb *pTsdb = pCompactor->pTsdb;
+  TSKEY  minKey;
+  TSKEY  maxKey;
+
+  // the latest delete overlapping the key range of the file set
+  *pDelVer = 0;
+  tsdbFidKeyRange(pSet->fid, pTsdb->keepCfg.days, pTsdb->keepCfg.precision, &minKey, &maxKey);
+  for (int32_t iDel = 0; iDel < taosArrayGetSize(pCompactor->aDelRange); iDel++) {
+    SDelData *pDelData = (SDelData *)taosArrayGet(pCompactor->aDelRange, iDel);
+    if (pDelData->sKey <= maxKey && pDelData->eKey >= minKey) {
+      *pDelVer = TMAX(*pDelVer, pDelData->version);
+    }
+  }
+
+  // multiple stt files need to be merged, and deletes not purged from the file set yet need to be applied
+  return pSet->nSttF > 1 || *pDelVer > pSet->delVer;
+}
+
+// reader ==============================================================================================
+static int32_t tsdbCompactIterNextBlock(STsdbCompactor *pCompactor, SCompactIter *pIter) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  pIter->iRow = 0;
+  tBlockDataReset(&pIter->bData);
+
+  if (pIter->type == TSDB_COMPACT_DATA_ITER) {
+    while (true) {
+      if (pIter->pBlockIdx && pIter->iBlock < pIter->mBlock.nItem) {
+        SDataBlk dataBlk;
+        tMapDataGetItemByIdx(&pIter->mBlock, pIter->iBlock, &dataBlk, tGetDataBlk);
+        pIter->iBlock++;
+
+        code = tsdbReadDataBlockEx(pCompactor->pReader, &dataBlk, &pIter->bData);
+        TSDB_CHECK_CODE(code, lino, _exit);
+
+        if (pIter->bData.nRow > 0) break;
+        continue;
+      }
+
+      if (pIter->iBlockIdx >= taosArrayGetSize(pIter->aBlockIdx)) {
+        pIter->pBlockIdx = NULL;
+        break;
+      }
+
+      pIter->pBlockIdx = (SBlockIdx *)taosArrayGet(pIter->aBlockIdx, pIter->iBlockIdx);
+      pIter->iBlockIdx++;
+
+      code = tsdbReadDataBlk(pCompactor->pReader, pIter->pBlockIdx, &pIter->mBlock);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      pIter->iBlock = 0;
+    }
+  } else {
+    while (pIter->iSttBlk < taosArrayGetSize(pIter->aSttBlk)) {
+      SSttBlk *pSttBlk = (SSttBlk *)taosArrayGet(pIter->aSttBlk, pIter->iSttBlk);
+      pIter->iSttBlk++;
+
+      code = tsdbReadSttBlockEx(pCompactor->pReader, pIter->iStt, pSttBlk, &pIter->bData);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      if (pIter->bData.nRow > 0) break;
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static void tsdbCompactIterSetRow(SCompactIter *pIter) {
+  SBlockData *pBData = &pIter->bData;
+
+  pIter->rInfo.suid = pBData->suid;
+  pIter->rInfo.uid = pBData->uid ? pBData->uid : pBData->aUid[pIter->iRow];
+  pIter->rInfo.row = tsdbRowFromBlockData(pBData, pIter->iRow);
+}
+
+static int32_t tsdbCompactOpenReader(STsdbCompactor *pCompactor, SDFileSet *pSet) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  code = tsdbDataFReaderOpen(&pCompactor->pReader, pCompactor->pTsdb, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pCompactor->pIter = NULL;
+  tRBTreeCreate(&pCompactor->rbt, tCompactIterCmprFn);
+
+  // .data file
+  SCompactIter *pIter = &pCompactor->aIter[0];
+  pIter->type = TSDB_COMPACT_DATA_ITER;
+  pIter->iBlockIdx = 0;
+  pIter->pBlockIdx = NULL;
+  pIter->iBlock = 0;
+  tMapDataReset(&pIter->mBlock);
+
+  code = tsdbReadBlockIdx(pCompactor->pReader, pIter->aBlockIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactIterNextBlock(pCompactor, pIter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pIter->bData.nRow > 0) {
+    tsdbCompactIterSetRow(pIter);
+    tRBTreePut(&pCompactor->rbt, (SRBTreeNode *)pIter);
+  }
+
+  // .stt files
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    pIter = &pCompactor->aIter[iStt + 1];
+    pIter->type = TSDB_COMPACT_STT_ITER;
+    pIter->iStt = iStt;
+    pIter->iSttBlk = 0;
+
+    code = tsdbReadSttBlk(pCompactor->pReader, iStt, pIter->aSttBlk);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbCompactIterNextBlock(pCompactor, pIter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (pIter->bData.nRow > 0) {
+      tsdbCompactIterSetRow(pIter);
+      tRBTreePut(&pCompactor->rbt, (SRBTreeNode *)pIter);
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactNextRow(STsdbCompactor *pCompactor, SRowInfo **ppRowInfo) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pCompactor->pIter) {
+    SCompactIter *pIter = pCompactor->pIter;
+
+    pIter->iRow++;
+    if (pIter->iRow >= pIter->bData.nRow) {
+      code = tsdbCompactIterNextBlock(pCompactor, pIter);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    if (pIter->iRow < pIter->bData.nRow) {
+      tsdbCompactIterSetRow(pIter);
+
+      SCompactIter *pMin = (SCompactIter *)tRBTreeMin(&pCompactor->rbt);
+      if (pMin && tRowInfoCmprFn(&pIter->rInfo, &pMin->rInfo) > 0) {
+        tRBTreePut(&pCompactor->rbt, (SRBTreeNode *)pIter);
+        pCompactor->pIter = NULL;
+      }
+    } else {
+      pCompactor->pIter = NULL;
+    }
+  }
+
+  if (pCompactor->pIter == NULL) {
+    pCompactor->pIter = (SCompactIter *)tRBTreeMin(&pCompactor->rbt);
+    if (pCompactor->pIter) {
+      tRBTreeDrop(&pCompactor->rbt, (SRBTreeNode *)pCompactor->pIter);
+    }
+  }
+
+  *ppRowInfo = pCompactor->pIter ? &pCompactor->pIter->rInfo : NULL;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+// writer ==============================================================================================
+static void tsdbCompactThrottle(STsdbCompactor *pCompactor) {
+  if (tsCompactIoBudget <= 0 || pCompactor->pWriter == NULL) return;
+
+  SDataFWriter *pWriter = pCompactor->pWriter;
+  int64_t       nBytes = pCompactor->nBytes + pWriter->fHead.size + pWriter->fData.size + pWriter->fSma.size +
+                   pWriter->fStt[pWriter->wSet.nSttF - 1].size;
+  int64_t       expMs = nBytes * 1000 / ((int64_t)tsCompactIoBudget << 20);
+  int64_t       elapsed = taosGetTimestampMs() - pCompactor->sTime;
+
+  if (expMs > elapsed) {
+    taosMsleep(expMs - elapsed);
+  }
+}
+
+static int32_t tsdbCompactWriteSttRows(STsdbCompactor *pCompactor) {
+  int32_t     code = 0;
+  int32_t     lino = 0;
+  SBlockData *pBData = &pCompactor->bData;
+  SBlockData *pSData = &pCompactor->sData;
+  TABLEID    *pId = &pCompactor->tbid;
+
+  if (pSData->suid || pSData->uid) {
+    if (!TABLE_SAME_SCHEMA(pSData->suid, pSData->uid, pId->suid, pId->uid)) {
+      code = tsdbWriteSttBlock(pCompactor->pWriter, pSData, pCompactor->aSttBlk, pCompactor->cmprAlg);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      pSData->suid = 0;
+      pSData->uid = 0;
+    }
+  }
+
+  if (pSData->suid == 0 && pSData->uid == 0) {
+    TABLEID tid = {.suid = pId->suid, .uid = pId->suid ? 0 : pId->uid};
+    code = tBlockDataInit(pSData, &tid, pCompactor->skmTable.pTSchema, NULL, 0);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  for (int32_t iRow = 0; iRow < pBData->nRow; iRow++) {
+    TSDBROW row = tsdbRowFromBlockData(pBData, iRow);
+
+    code = tBlockDataAppendRow(pSData, &row, NULL, pId->uid);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (pSData->nRow >= pCompactor->maxRow) {
+      code = tsdbWriteSttBlock(pCompactor->pWriter, pSData, pCompactor->aSttBlk, pCompactor->cmprAlg);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  tBlockDataClear(pBData);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactTableEnd(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pCompactor->tbid.uid == 0) return code;
+
+  if (!pCompactor->dropped) {
+    // remaining rows go to a data block only if they are enough to form one
+    if (pCompactor->bData.nRow > pCompactor->minRow) {
+      code = tsdbWriteDataBlock(pCompactor->pWriter, &pCompactor->bData, &pCompactor->mDataBlk, pCompactor->cmprAlg);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    } else if (pCompactor->bData.nRow > 0) {
+      code = tsdbCompactWriteSttRows(pCompactor);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    if (pCompactor->mDataBlk.nItem > 0) {
+      SBlockIdx blockIdx = {.suid = pCompactor->tbid.suid, .uid = pCompactor->tbid.uid};
+      code = tsdbWriteDataBlk(pCompactor->pWriter, &pCompactor->mDataBlk, &blockIdx);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      if (taosArrayPush(pCompactor->aBlockIdx, &blockIdx) == NULL) {
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+  }
+
+  tMapDataReset(&pCompactor->mDataBlk);
+  pCompactor->tbid = (TABLEID){0};
+
+  tsdbCompactThrottle(pCompactor);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactTableStart(STsdbCompactor *pCompactor, TABLEID *pId) {
+  int32_t   code = 0;
+  int32_t   lino = 0;
+  SMetaInfo info;
+
+  pCompactor->tbid = *pId;
+  pCompactor->dropped = 0;
+  pCompactor->iSkyline = 0;
+  taosArrayClear(pCompactor->aSkyline);
+
+  // rows of dropped tables are purged, any other failure to look the table up aborts the compaction
+  code = metaGetInfo(pCompactor->pTsdb->pVnode->pMeta, pId->uid, &info, NULL);
+  if (code == TSDB_CODE_NOT_FOUND || (code == 0 && info.suid != pId->suid)) {
+    code = 0;
+    pCompactor->dropped = 1;
+    goto _exit;
+  }
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbUpdateTableSchema(pCompactor->pTsdb->pVnode->pMeta, pId->suid, pId->uid, &pCompactor->skmTable);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tBlockDataInit(&pCompactor->bData, pId, pCompactor->skmTable.pTSchema, NULL, 0);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // delete skyline of the table
+  if (pCompactor->aDelIdx) {
+    SDelIdx *pDelIdx = taosArraySearch(pCompactor->aDelIdx, &(SDelIdx){.suid = pId->suid, .uid = pId->uid},
+                                       tCmprDelIdx, TD_EQ);
+    if (pDelIdx) {
+      SDelFReader *pDelFReader = NULL;
+
+      code = tsdbDelFReaderOpen(&pDelFReader, pCompactor->pDelFile, pCompactor->pTsdb);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      code = tsdbReadDelData(pDelFReader, pDelIdx, pCompactor->aDelData);
+      tsdbDelFReaderClose(&pDelFReader);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      if (taosArrayGetSize(pCompactor->aDelData) > 0) {
+        code = tsdbBuildDeleteSkyline(pCompactor->aDelData, 0, taosArrayGetSize(pCompactor->aDelData) - 1,
+                                      pCompactor->aSkyline);
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactWriteRow(STsdbCompactor *pCompactor, SRowInfo *pRowInfo) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pCompactor->dropped) goto _exit;
+
+  if (taosArrayGetSize(pCompactor->aSkyline) > 0) {
+    TSDBKEY       key = TSDBROW_KEY(&pRowInfo->row);
+    SVersionRange verRange = {.minVer = 0, .maxVer = VERSION_MAX};
+
+    if (hasBeenDropped(pCompactor->aSkyline, &pCompactor->iSkyline, &key, TSDB_ORDER_ASC, &verRange)) goto _exit;
+  }
+
+  code = tBlockDataAppendRow(&pCompactor->bData, &pRowInfo->row, NULL, pRowInfo->uid);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pCompactor->bData.nRow >= pCompactor->maxRow) {
+    code = tsdbWriteDataBlock(pCompactor->pWriter, &pCompactor->bData, &pCompactor->mDataBlk, pCompactor->cmprAlg);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    tsdbCompactThrottle(pCompactor);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static void tsdbCompactRemoveFiles(STsdb *pTsdb, SDFileSet *pSet) {
+  char fname[TSDB_FILENAME_LEN] = {0};
+
+  tsdbHeadFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pHeadF, fname);
+  (void)taosRemoveFile(fname);
+  tsdbDataFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pDataF, fname);
+  (void)taosRemoveFile(fname);
+  tsdbSmaFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pSmaF, fname);
+  (void)taosRemoveFile(fname);
+  tsdbSttFileName(pTsdb, pSet->diskId, pSet->fid, pSet->aSttF[0], fname);
+  (void)taosRemoveFile(fname);
+}
+
+static int32_t tsdbCommitCompactFS(STsdbCompactor *pCompactor) {
   int32_t code = 0;
-  // TODO
+  int32_t lino = 0;
+  STsdb  *pTsdb = pCompactor->pTsdb;
+
+  code = tsdbFSPrepareCommit(pTsdb, &pCompactor->fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  taosThreadRwlockWrlock(&pTsdb->rwLock);
+
+  code = tsdbFSCommit(pTsdb);
+  if (code) {
+    taosThreadRwlockUnlock(&pTsdb->rwLock);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+static bool tsdbFSetChanged(SDFileSet *pSet, SDFileSet *pSetOld) {
+  // the retention moves a file set to another disk without changing its commit ids
+  if (pSet->diskId.level != pSetOld->diskId.level || pSet->diskId.id != pSetOld->diskId.id) return true;
+  if (pSet->pHeadF->commitID != pSetOld->pHeadF->commitID || pSet->pDataF->commitID != pSetOld->pDataF->commitID ||
+      pSet->pSmaF->commitID != pSetOld->pSmaF->commitID || pSet->nSttF != pSetOld->nSttF) {
+    return true;
+  }
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    if (pSet->aSttF[iStt]->commitID != pSetOld->aSttF[iStt]->commitID) return true;
+  }
+  return false;
+}
+
+static int32_t tsdbCompactFileSet(STsdbCompactor *pCompactor, int32_t fid, bool locked, bool *pRetry) {
+  int32_t    code = 0;
+  int32_t    lino = 0;
+  STsdb     *pTsdb = pCompactor->pTsdb;
+  STsdbFS    fsRef = {0};
+  SDFileSet *pSetRef = NULL;
+  SDFileSet *pSet = NULL;
+  SDFileSet  wSet = {0};
+  SHeadFile  fHead = {.commitID = pCompactor->commitID};
+  SDataFile  fData = {.commitID = pCompactor->commitID};
+  SSmaFile   fSma = {.commitID = pCompactor->commitID};
+  SSttFile   fStt = {.commitID = pCompactor->commitID};
+  SRowInfo  *pRowInfo = NULL;
+  int64_t    delVer = 0;
+  bool       purged = false;
+  bool       written = false;
+
+  *pRetry = false;
+
+  // read from a referenced file system, the files stay alive even if a commit replaces them meanwhile
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSRef(pTsdb, &fsRef);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // deletes, all of them are applied to the rows of the file set
+  code = tsdbCompactLoadDel(pCompactor, fsRef.pDelFile);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  pCompactor->pDelFile = fsRef.pDelFile;
+
+  pSetRef = (SDFileSet *)taosArraySearch(fsRef.aDFileSet, &(SDFileSet){.fid = fid}, tDFileSetCmprFn, TD_EQ);
+  if (pSetRef == NULL || !tsdbShouldCompact(pCompactor, pSetRef, &delVer)) goto _exit;
+
+  // reader
+  code = tsdbCompactOpenReader(pCompactor, pSetRef);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // writer
+  wSet = (SDFileSet){.diskId = pSetRef->diskId,
+                     .fid = pSetRef->fid,
+                     .pHeadF = &fHead,
+                     .pDataF = &fData,
+                     .pSmaF = &fSma,
+                     .nSttF = 1,
+                     .aSttF = {&fStt},
+                     .delVer = TMAX(pSetRef->delVer, delVer)};
+
+  code = tsdbDataFWriterOpen(&pCompactor->pWriter, pTsdb, &wSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  written = true;
+
+  taosArrayClear(pCompactor->aBlockIdx);
+  taosArrayClear(pCompactor->aSttBlk);
+  tMapDataReset(&pCompactor->mDataBlk);
+  tBlockDataReset(&pCompactor->bData);
+  tBlockDataReset(&pCompactor->sData);
+  pCompactor->tbid = (TABLEID){0};
+
+  // merge
+  while (true) {
+    code = tsdbCompactNextRow(pCompactor, &pRowInfo);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (pRowInfo == NULL) break;
+
+    if (pRowInfo->suid != pCompactor->tbid.suid || pRowInfo->uid != pCompactor->tbid.uid) {
+      code = tsdbCompactTableEnd(pCompactor);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      code = tsdbCompactTableStart(pCompactor, &(TABLEID){.suid = pRowInfo->suid, .uid = pRowInfo->uid});
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    code = tsdbCompactWriteRow(pCompactor, pRowInfo);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tsdbCompactTableEnd(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbWriteSttBlock(pCompactor->pWriter, &pCompactor->sData, pCompactor->aSttBlk, pCompactor->cmprAlg);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbDataFReaderClose(&pCompactor->pReader);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (taosArrayGetSize(pCompactor->aBlockIdx) == 0 && taosArrayGetSize(pCompactor->aSttBlk) == 0) {
+    // everything in the file set has been purged
+    purged = true;
+    code = tsdbDataFWriterClose(&pCompactor->pWriter, 0);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    tsdbCompactRemoveFiles(pTsdb, &wSet);
+    written = false;
+  } else {
+    code = tsdbWriteBlockIdx(pCompactor->pWriter, pCompactor->aBlockIdx);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbWriteSttBlk(pCompactor->pWriter, pCompactor->aSttBlk);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbUpdateDFileSetHeader(pCompactor->pWriter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    SDataFWriter *pWriter = pCompactor->pWriter;
+    pCompactor->nBytes +=
+        pWriter->fHead.size + pWriter->fData.size + pWriter->fSma.size + pWriter->fStt[pWriter->wSet.nSttF - 1].size;
+    fHead = pWriter->fHead;
+    fData = pWriter->fData;
+    fSma = pWriter->fSma;
+    fStt = pWriter->fStt[pWriter->wSet.nSttF - 1];
+
+    code = tsdbDataFWriterClose(&pCompactor->pWriter, 1);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // swap the file set in between two commits
+  if (!locked) tsem_wait(&pTsdb->pVnode->canCommit);
+
+  tsdbFSDestroy(&pCompactor->fs);
+  code = tsdbFSCopy(pTsdb, &pCompactor->fs);
+  if (code) {
+    if (!locked) tsem_post(&pTsdb->pVnode->canCommit);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pSet = (SDFileSet *)taosArraySearch(pCompactor->fs.aDFileSet, &(SDFileSet){.fid = fid}, tDFileSetCmprFn, TD_EQ);
+  if (pSet == NULL || tsdbFSetChanged(pSet, pSetRef)) {
+    // a commit changed the file set meanwhile, the result is stale
+    ASSERT(!locked);
+    tsem_post(&pTsdb->pVnode->canCommit);
+    *pRetry = true;
+    goto _exit;
+  }
+
+  if (purged) {
+    int32_t idx = taosArraySearchIdx(pCompactor->fs.aDFileSet, pSet, tDFileSetCmprFn, TD_EQ);
+    taosMemoryFree(pSet->pHeadF);
+    taosMemoryFree(pSet->pDataF);
+    taosMemoryFree(pSet->pSmaF);
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      taosMemoryFree(pSet->aSttF[iStt]);
+    }
+    taosArrayRemove(pCompactor->fs.aDFileSet, idx);
+  } else {
+    code = tsdbFSUpsertFSet(&pCompactor->fs, &wSet);
+  }
+
+  if (code == 0) {
+    code = tsdbCommitCompactFS(pCompactor);
+  }
+  if (!locked) tsem_post(&pTsdb->pVnode->canCommit);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  written = false;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code),
+              fid);
+    if (pCompactor->pWriter) {
+      tsdbDataFWriterClose(&pCompactor->pWriter, 0);
+    }
+    if (pCompactor->pReader) {
+      tsdbDataFReaderClose(&pCompactor->pReader);
+    }
+  }
+  if (written) {
+    tsdbCompactRemoveFiles(pTsdb, &wSet);
+  }
+  pCompactor->pDelFile = NULL;
+  if (fsRef.aDFileSet) {
+    tsdbFSUnref(pTsdb, &fsRef);
+  }
+  return code;
+}
+
+// compactor ==============================================================================================
+static int32_t tsdbCompactorOpen(STsdb *pTsdb, int64_t commitID, STsdbCompactor **ppCompactor) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdbCompactor *pCompactor = NULL;
+
+  pCompactor = (STsdbCompactor *)taosMemoryCalloc(1, sizeof(*pCompactor));
+  if (pCompactor == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pCompactor->pTsdb = pTsdb;
+  pCompactor->commitID = commitID;
+  pCompactor->minRow = pTsdb->pVnode->config.tsdbCfg.minRows;
+  pCompactor->maxRow = pTsdb->pVnode->config.tsdbCfg.maxRows;
+  pCompactor->cmprAlg = pTsdb->pVnode->config.tsdbCfg.compression;
+  pCompactor->sTime = taosGetTimestampMs();
+
+  for (int32_t iIter = 0; iIter < sizeof(pCompactor->aIter) / sizeof(pCompactor->aIter[0]); iIter++) {
+    SCompactIter *pIter = &pCompactor->aIter[iIter];
+
+    if (iIter == 0) {
+      pIter->aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+      if (pIter->aBlockIdx == NULL) {
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    } else {
+      pIter->aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+      if (pIter->aSttBlk == NULL) {
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+    }
+
+    code = tBlockDataCreate(&pIter->bData);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pCompactor->aDelRange = taosArrayInit(0, sizeof(SDelData));
+  pCompactor->aDelData = taosArrayInit(0, sizeof(SDelData));
+  pCompactor->aSkyline = taosArrayInit(0, sizeof(TSDBKEY));
+  pCompactor->aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+  pCompactor->aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+  if (pCompactor->aDelRange == NULL || pCompactor->aDelData == NULL || pCompactor->aSkyline == NULL ||
+      pCompactor->aBlockIdx == NULL || pCompactor->aSttBlk == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tBlockDataCreate(&pCompactor->bData);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tBlockDataCreate(&pCompactor->sData);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  *ppCompactor = pCompactor;
+  return code;
+}
+
+static void tsdbCompactorClose(STsdbCompactor **ppCompactor) {
+  STsdbCompactor *pCompactor = *ppCompactor;
+
+  if (pCompactor == NULL) return;
+
+  for (int32_t iIter = 0; iIter < sizeof(pCompactor->aIter) / sizeof(pCompactor->aIter[0]); iIter++) {
+    SCompactIter *pIter = &pCompactor->aIter[iIter];
+
+    if (iIter == 0) {
+      taosArrayDestroy(pIter->aBlockIdx);
+      tMapDataClear(&pIter->mBlock);
+    } else {
+      taosArrayDestroy(pIter->aSttBlk);
+    }
+
+    tBlockDataDestroy(&pIter->bData, 1);
+  }
+
+  taosArrayDestroy(pCompactor->aDelIdx);
+  taosArrayDestroy(pCompactor->aDelRange);
+  taosArrayDestroy(pCompactor->aDelData);
+  taosArrayDestroy(pCompactor->aSkyline);
+  taosArrayDestroy(pCompactor->aBlockIdx);
+  taosArrayDestroy(pCompactor->aSttBlk);
+  tMapDataClear(&pCompactor->mDataBlk);
+  tBlockDataDestroy(&pCompactor->bData, 1);
+  tBlockDataDestroy(&pCompactor->sData, 1);
+  tDestroyTSchema(pCompactor->skmTable.pTSchema);
+  tsdbFSDestroy(&pCompactor->fs);
+
+  taosMemoryFree(pCompactor);
+  *ppCompactor = NULL;
+}
+
+int32_t tsdbCompact(STsdb *pTsdb, int64_t commitID) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  SVnode         *pVnode = pTsdb->pVnode;
+  STsdbCompactor *pCompactor = NULL;
+  STsdbFS         fs = {0};
+  SArray         *aFid = NULL;
+  int32_t         nDone = 0;
+
+  code = tsdbCompactorOpen(pTsdb, commitID, &pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // collect the file sets to compact
+  aFid = taosArrayInit(0, sizeof(int32_t));
+  if (aFid == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSRef(pTsdb, &fs);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactLoadDel(pCompactor, fs.pDelFile);
+  for (int32_t iSet = 0; code == 0 && iSet < taosArrayGetSize(fs.aDFileSet); iSet++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(fs.aDFileSet, iSet);
+    int64_t    delVer = 0;
+
+    if (tsdbShouldCompact(pCompactor, pSet, &delVer) && taosArrayPush(aFid, &pSet->fid) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+  tsdbFSUnref(pTsdb, &fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // progress reported with the vnode load
+  atomic_store_32(&pVnode->compactNDone, 0);
+  atomic_store_32(&pVnode->compactNFSet, (int32_t)taosArrayGetSize(aFid));
+
+  tsdbInfo("vgId:%d, tsdb compact started, commit id:%" PRId64 " nFSet:%d", TD_VID(pTsdb->pVnode), commitID,
+           (int32_t)taosArrayGetSize(aFid));
+
+  for (int32_t iFid = 0; iFid < taosArrayGetSize(aFid); iFid++) {
+    int32_t fid = *(int32_t *)taosArrayGet(aFid, iFid);
+
+    bool    retry = false;
+
+    code = tsdbCompactFileSet(pCompactor, fid, false, &retry);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (retry) {
+      // commits keep changing the file set, compact it again with commit held off for this file set only
+      tsdbInfo("vgId:%d, tsdb compact fid:%d changed by commit, redo with commit blocked", TD_VID(pTsdb->pVnode), fid);
+      tsem_wait(&pTsdb->pVnode->canCommit);
+      code = tsdbCompactFileSet(pCompactor, fid, true, &retry);
+      tsem_post(&pTsdb->pVnode->canCommit);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    nDone++;
+    atomic_store_32(&pVnode->compactNDone, nDone);
+    tsdbInfo("vgId:%d, tsdb compact fid:%d done, %d/%d", TD_VID(pTsdb->pVnode), fid, nDone,
+             (int32_t)taosArrayGetSize(aFid));
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  } else {
+    tsdbInfo("vgId:%d, tsdb compact done, nFSet:%d bytes written:%" PRId64 " elapsed:%" PRId64 "ms",
+             TD_VID(pTsdb->pVnode), nDone, pCompactor->nBytes, taosGetTimestampMs() - pCompactor->sTime);
+  }
+  taosArrayDestroy(aFid);
+  tsdbCompactorClose(&pCompactor);
   return code;
 }
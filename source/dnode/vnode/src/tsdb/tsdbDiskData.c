@@ -31,7 +31,11 @@ struct SDiskColBuilder {
   SColumnDataAgg sma;
   uint8_t        minSet;
   uint8_t        maxSet;
-  uint8_t       *aBuf[2];
+  int32_t        szRaw;
+  uint8_t       *pRaw;  // raw values of integer and var columns, for the adaptive and dictionary encodings
+  int32_t        nRawOff;
+  int32_t       *aRawOff;  // raw offsets of var columns
+  uint8_t       *aBuf[3];
 };
 
 // SDiskData ================================================
@@ -49,6 +53,8 @@ static int32_t tDiskColBuilderDestroy(SDiskColBuilder *pBuilder) {
   int32_t code = 0;
 
   tFree(pBuilder->pBitMap);
+  tFree(pBuilder->pRaw);
+  tFree((uint8_t *)pBuilder->aRawOff);
   if (pBuilder->pOffC) tCompressorDestroy(pBuilder->pOffC);
   if (pBuilder->pValC) tCompressorDestroy(pBuilder->pValC);
   for (int32_t iBuf = 0; iBuf < sizeof(pBuilder->aBuf) / sizeof(pBuilder->aBuf[0]); iBuf++) {
@@ -69,6 +75,8 @@ static int32_t tDiskColBuilderInit(SDiskColBuilder *pBuilder, int16_t cid, int8_
   pBuilder->flag = 0;
   pBuilder->nVal = 0;
   pBuilder->offset = 0;
+  pBuilder->szRaw = 0;
+  pBuilder->nRawOff = 0;
 
   if (IS_VAR_DATA_TYPE(type)) {
     if (pBuilder->pOffC == NULL && (code = tCompressorCreate(&pBuilder->pOffC))) return code;
@@ -98,6 +106,7 @@ static int32_t tGnrtDiskCol(SDiskColBuilder *pBuilder, SDiskCol *pDiskCol) {
                                      .type = pBuilder->type,
                                      .smaOn = pBuilder->calcSma,
                                      .flag = pBuilder->flag,
+                                     .cmprAlg = pBuilder->cmprAlg,
                                      .szOrigin = 0,
                                      .szBitmap = 0,
                                      .szOffset = 0,
@@ -138,6 +147,25 @@ static int32_t tGnrtDiskCol(SDiskColBuilder *pBuilder, SDiskCol *pDiskCol) {
   if (pBuilder->flag != (HAS_NULL | HAS_NONE)) {
     code = tCompressEnd(pBuilder->pValC, &pDiskCol->pVal, &pDiskCol->bCol.szValue, &pDiskCol->bCol.szOrigin);
     if (code) return code;
+
+    if (pBuilder->szRaw > 0 && pBuilder->szRaw == pDiskCol->bCol.szOrigin) {
+      code = tRealloc(&pBuilder->aBuf[2], pDiskCol->bCol.szValue);
+      if (code) return code;
+
+      memcpy(pBuilder->aBuf[2], pDiskCol->pVal, pDiskCol->bCol.szValue);
+      if (IS_VAR_DATA_TYPE(pBuilder->type)) {
+        if (pBuilder->nRawOff == pBuilder->nVal) {
+          code = tsdbCmprDataDict(pBuilder->pRaw, pBuilder->szRaw, pBuilder->aRawOff, pBuilder->nRawOff,
+                                  &pBuilder->aBuf[2], 0, &pDiskCol->bCol.szValue, &pDiskCol->bCol.cmprAlg,
+                                  &pBuilder->aBuf[1]);
+        }
+      } else {
+        code = tsdbCmprDataAdaptive(pBuilder->pRaw, pBuilder->szRaw, pBuilder->type, &pBuilder->aBuf[2], 0,
+                                    &pDiskCol->bCol.szValue, &pDiskCol->bCol.cmprAlg, &pBuilder->aBuf[1]);
+      }
+      if (code) return code;
+      pDiskCol->pVal = pBuilder->aBuf[2];
+    }
   }
 
   return code;
@@ -153,9 +181,27 @@ static FORCE_INLINE int32_t tDiskColPutValue(SDiskColBuilder *pBuilder, SColVal
 
     code = tCompress(pBuilder->pValC, pColVal->value.pData, pColVal->value.nData);
     if (code) return code;
+
+    if (pBuilder->cmprAlg != NO_COMPRESSION) {
+      code = tRealloc((uint8_t **)&pBuilder->aRawOff, sizeof(int32_t) * (pBuilder->nRawOff + 1));
+      if (code) return code;
+      pBuilder->aRawOff[pBuilder->nRawOff++] = pBuilder->szRaw;
+
+      code = tRealloc(&pBuilder->pRaw, pBuilder->szRaw + pColVal->value.nData);
+      if (code) return code;
+      memcpy(pBuilder->pRaw + pBuilder->szRaw, pColVal->value.pData, pColVal->value.nData);
+      pBuilder->szRaw += pColVal->value.nData;
+    }
   } else {
     code = tCompress(pBuilder->pValC, &pColVal->value.val, tDataTypes[pColVal->type].bytes);
     if (code) return code;
+
+    if (IS_INTEGER_TYPE(pColVal->type) && pBuilder->cmprAlg != NO_COMPRESSION) {
+      code = tRealloc(&pBuilder->pRaw, pBuilder->szRaw + tDataTypes[pColVal->type].bytes);
+      if (code) return code;
+      memcpy(pBuilder->pRaw + pBuilder->szRaw, &pColVal->value.val, tDataTypes[pColVal->type].bytes);
+      pBuilder->szRaw += tDataTypes[pColVal->type].bytes;
+    }
   }
 
   return code;
@@ -476,6 +522,7 @@ void *tDiskDataBuilderDestroy(SDiskDataBuilder *pBuilder) {
     }
     taosArrayDestroy(pBuilder->aBuilder);
   }
+  taosArrayDestroy(pBuilder->aUid);
   for (int32_t iBuf = 0; iBuf < sizeof(pBuilder->aBuf) / sizeof(pBuilder->aBuf[0]); iBuf++) {
     tFree(pBuilder->aBuf[iBuf]);
   }
@@ -517,6 +564,15 @@ int32_t tDiskDataBuilderInit(SDiskDataBuilder *pBuilder, STSchema *pTSchema, TAB
   code = tCompressStart(pBuilder->pKeyC, TSDB_DATA_TYPE_TIMESTAMP, cmprAlg);
   if (code) return code;
 
+  if (pBuilder->aUid == NULL) {
+    pBuilder->aUid = taosArrayInit(0, sizeof(int64_t));
+    if (pBuilder->aUid == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      return code;
+    }
+  }
+  taosArrayClear(pBuilder->aUid);
+
   if (pBuilder->aBuilder == NULL) {
     pBuilder->aBuilder = taosArrayInit(pTSchema->numOfCols - 1, sizeof(SDiskColBuilder));
     if (pBuilder->aBuilder == NULL) {
@@ -554,6 +610,7 @@ int32_t tDiskDataBuilderClear(SDiskDataBuilder *pBuilder) {
   pBuilder->suid = 0;
   pBuilder->uid = 0;
   pBuilder->nRow = 0;
+  taosArrayClear(pBuilder->aUid);
   return code;
 }
 
@@ -582,6 +639,12 @@ int32_t tDiskDataAddRow(SDiskDataBuilder *pBuilder, TSDBROW *pRow, STSchema *pTS
   }
   if (pBuilder->bi.minUid > pId->uid) pBuilder->bi.minUid = pId->uid;
   if (pBuilder->bi.maxUid < pId->uid) pBuilder->bi.maxUid = pId->uid;
+  if (pBuilder->nRow == 0 || *(int64_t *)taosArrayGetLast(pBuilder->aUid) != pId->uid) {
+    if (taosArrayPush(pBuilder->aUid, &pId->uid) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      return code;
+    }
+  }
 
   // version
   code = tCompress(pBuilder->pVerC, &kRow.version, sizeof(int64_t));
@@ -631,7 +694,7 @@ int32_t tGnrtDiskData(SDiskDataBuilder *pBuilder, const SDiskData **ppDiskData,
   SDiskData *pDiskData = &pBuilder->dd;
   // reset SDiskData
   pDiskData->hdr = (SDiskDataHdr){.delimiter = TSDB_FILE_DLMT,
-                                  .fmtVer = 0,
+                                  .fmtVer = TSDB_DATA_FMT_VER,
                                   .suid = pBuilder->suid,
                                   .uid = pBuilder->uid,
                                   .szUid = 0,
@@ -688,7 +751,7 @@ int32_t tGnrtDiskData(SDiskDataBuilder *pBuilder, const SDiskData **ppDiskData,
       return code;
     }
 
-    pDiskData->hdr.szBlkCol += tPutBlockCol(NULL, &dCol.bCol);
+    pDiskData->hdr.szBlkCol += tPutBlockCol(NULL, &dCol.bCol, pDiskData->hdr.fmtVer);
   }
 
   *ppDiskData = pDiskData;
@@ -22,7 +22,7 @@ static int32_t tsdbFSToBinary(uint8_t *p, STsdbFS *pFS) {
   uint32_t nSet = taosArrayGetSize(pFS->aDFileSet);
 
   // version
-  n += tPutI8(p ? p + n : p, 0);
+  n += tPutI8(p ? p + n : p, TSDB_FS_VER);
 
   // SDelFile
   n += tPutI8(p ? p + n : p, hasDel);
@@ -42,9 +42,10 @@ static int32_t tsdbFSToBinary(uint8_t *p, STsdbFS *pFS) {
 static int32_t tsdbBinaryToFS(uint8_t *pData, int64_t nData, STsdbFS *pFS) {
   int32_t code = 0;
   int32_t n = 0;
+  int8_t  fsVer = 0;
 
   // version
-  n += tGetI8(pData + n, NULL);
+  n += tGetI8(pData + n, &fsVer);
 
   // SDelFile
   int8_t hasDel = 0;
@@ -69,7 +70,7 @@ static int32_t tsdbBinaryToFS(uint8_t *pData, int64_t nData, STsdbFS *pFS) {
   for (uint32_t iSet = 0; iSet < nSet; iSet++) {
     SDFileSet fSet = {0};
 
-    int32_t nt = tGetDFileSet(pData + n, &fSet);
+    int32_t nt = tGetDFileSet(pData + n, &fSet, fsVer);
     if (nt < 0) {
       code = TSDB_CODE_OUT_OF_MEMORY;
       goto _exit;
@@ -384,7 +385,7 @@ static int32_t tsdbNewFileSet(STsdb *pTsdb, SDFileSet *pSetTo, SDFileSet *pSetFr
   int32_t code = 0;
   int32_t lino = 0;
 
-  *pSetTo = (SDFileSet){.diskId = pSetFrom->diskId, .fid = pSetFrom->fid, .nSttF = 0};
+  *pSetTo = (SDFileSet){.diskId = pSetFrom->diskId, .fid = pSetFrom->fid, .nSttF = 0, .delVer = pSetFrom->delVer};
 
   // head
   pSetTo->pHeadF = (SHeadFile *)taosMemoryMalloc(sizeof(SHeadFile));
@@ -595,6 +596,7 @@ static int32_t tsdbMergeFileSet(STsdb *pTsdb, SDFileSet *pSetOld, SDFileSet *pSe
   if (!sameDisk) {
     pSetOld->diskId = pSetNew->diskId;
   }
+  pSetOld->delVer = pSetNew->delVer;
 
 _exit:
   if (code) {
@@ -859,7 +861,7 @@ int32_t tsdbFSCopy(STsdb *pTsdb, STsdbFS *pFS) {
 
   for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet); iSet++) {
     SDFileSet *pSet = (SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet);
-    SDFileSet  fSet = {.diskId = pSet->diskId, .fid = pSet->fid};
+    SDFileSet  fSet = {.diskId = pSet->diskId, .fid = pSet->fid, .delVer = pSet->delVer};
 
     // head
     fSet.pHeadF = (SHeadFile *)taosMemoryMalloc(sizeof(SHeadFile));
@@ -963,12 +965,14 @@ int32_t tsdbFSUpsertFSet(STsdbFS *pFS, SDFileSet *pSet) {
       }
 
       pDFileSet->diskId = pSet->diskId;
+      // a commit rewriting the file set does not undo the deletes purged from it
+      pDFileSet->delVer = TMAX(pDFileSet->delVer, pSet->delVer);
       goto _exit;
     }
   }
 
   ASSERT(pSet->nSttF == 1);
-  SDFileSet fSet = {.diskId = pSet->diskId, .fid = pSet->fid, .nSttF = 1};
+  SDFileSet fSet = {.diskId = pSet->diskId, .fid = pSet->fid, .nSttF = 1, .delVer = pSet->delVer};
 
   // head
   fSet.pHeadF = (SHeadFile *)taosMemoryMalloc(sizeof(SHeadFile));
@@ -59,16 +59,22 @@ int32_t tPutSttFile(uint8_t *p, SSttFile *pSttFile) {
   n += tPutI64v(p ? p + n : p, pSttFile->commitID);
   n += tPutI64v(p ? p + n : p, pSttFile->size);
   n += tPutI64v(p ? p + n : p, pSttFile->offset);
+  n += tPutI64v(p ? p + n : p, pSttFile->bfOffset);
 
   return n;
 }
 
-static int32_t tGetSttFile(uint8_t *p, SSttFile *pSttFile) {
+static int32_t tGetSttFile(uint8_t *p, SSttFile *pSttFile, int8_t fsVer) {
   int32_t n = 0;
 
   n += tGetI64v(p + n, &pSttFile->commitID);
   n += tGetI64v(p + n, &pSttFile->size);
   n += tGetI64v(p + n, &pSttFile->offset);
+  if (fsVer >= 1) {
+    n += tGetI64v(p + n, &pSttFile->bfOffset);
+  } else {
+    pSttFile->bfOffset = 0;
+  }
 
   return n;
 }
@@ -200,10 +206,12 @@ int32_t tPutDFileSet(uint8_t *p, SDFileSet *pSet) {
     n += tPutSttFile(p ? p + n : p, pSet->aSttF[iStt]);
   }
 
+  n += tPutI64v(p ? p + n : p, pSet->delVer);
+
   return n;
 }
 
-int32_t tGetDFileSet(uint8_t *p, SDFileSet *pSet) {
+int32_t tGetDFileSet(uint8_t *p, SDFileSet *pSet, int8_t fsVer) {
   int32_t n = 0;
 
   n += tGetI32v(p + n, &pSet->diskId.level);
@@ -242,7 +250,13 @@ int32_t tGetDFileSet(uint8_t *p, SDFileSet *pSet) {
       return -1;
     }
     pSet->aSttF[iStt]->nRef = 1;
-    n += tGetSttFile(p + n, pSet->aSttF[iStt]);
+    n += tGetSttFile(p + n, pSet->aSttF[iStt], fsVer);
+  }
+
+  if (fsVer >= 2) {
+    n += tGetI64v(p + n, &pSet->delVer);
+  } else {
+    pSet->delVer = 0;
   }
 
   return n;
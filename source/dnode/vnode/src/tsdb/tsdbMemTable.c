@@ -326,8 +326,8 @@ _exit:
 static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t uid, STbData **ppTbData) {
   int32_t code = 0;
 
-  // get
-  STbData *pTbData = tsdbGetTbDataFromMemTableImpl(pMemTable, suid, uid);
+  // get, the hash may be rehashed by another insert thread of the vnode
+  STbData *pTbData = tsdbGetTbDataFromMemTable(pMemTable, suid, uid);
   if (pTbData) goto _exit;
 
   // create
@@ -364,6 +364,14 @@ static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid
 
   taosWLockLatch(&pMemTable->latch);
 
+  // the table data may have been created by another insert thread meanwhile
+  STbData *pTbDataT = tsdbGetTbDataFromMemTableImpl(pMemTable, suid, uid);
+  if (pTbDataT) {
+    taosWUnLockLatch(&pMemTable->latch);
+    pTbData = pTbDataT;
+    goto _exit;
+  }
+
   if (pMemTable->nTbData >= pMemTable->nBucket) {
     code = tsdbMemTableRehash(pMemTable);
     if (code) {
@@ -509,20 +517,22 @@ static int32_t tbDataDoPut(SMemTable *pMemTable, STbData *pTbData, SMemSkipListN
     }
   }
 
-  for (int8_t iLevel = level - 1; iLevel >= 0; iLevel--) {
+  // Readers iterate the skiplist without lock, so the node is published from the bottom level up, after it is fully
+  // built. A reader either sees the complete node at a level or does not see it at all.
+  for (int8_t iLevel = 0; iLevel < level; iLevel++) {
     SMemSkipListNode *pn = pos[iLevel];
     SMemSkipListNode *px;
 
     if (forward) {
       px = SL_NODE_FORWARD(pn, iLevel);
 
-      SL_NODE_FORWARD(pn, iLevel) = pNode;
-      SL_NODE_BACKWARD(px, iLevel) = pNode;
+      atomic_store_ptr(&SL_NODE_FORWARD(pn, iLevel), pNode);
+      atomic_store_ptr(&SL_NODE_BACKWARD(px, iLevel), pNode);
     } else {
       px = SL_NODE_BACKWARD(pn, iLevel);
 
-      SL_NODE_FORWARD(px, iLevel) = pNode;
-      SL_NODE_BACKWARD(pn, iLevel) = pNode;
+      atomic_store_ptr(&SL_NODE_FORWARD(px, iLevel), pNode);
+      atomic_store_ptr(&SL_NODE_BACKWARD(pn, iLevel), pNode);
     }
 
     pos[iLevel] = pNode;
@@ -537,6 +547,22 @@ _exit:
   return code;
 }
 
+static void tsdbMemTableUpdateKeyRange(SMemTable *pMemTable, TSKEY minKey, TSKEY maxKey) {
+  TSKEY key = atomic_load_64(&pMemTable->minKey);
+  while (minKey < key) {
+    TSKEY oldKey = atomic_val_compare_exchange_64(&pMemTable->minKey, key, minKey);
+    if (oldKey == key) break;
+    key = oldKey;
+  }
+
+  key = atomic_load_64(&pMemTable->maxKey);
+  while (maxKey > key) {
+    TSKEY oldKey = atomic_val_compare_exchange_64(&pMemTable->maxKey, key, maxKey);
+    if (oldKey == key) break;
+    key = oldKey;
+  }
+}
+
 static int32_t tsdbInsertTableDataImpl(SMemTable *pMemTable, STbData *pTbData, int64_t version,
                                        SSubmitMsgIter *pMsgIter, SSubmitBlk *pBlock, SSubmitBlkRsp *pRsp) {
   int32_t           code = 0;
@@ -602,10 +628,9 @@ static int32_t tsdbInsertTableDataImpl(SMemTable *pMemTable, STbData *pTbData, i
     tsdbCacheInsertLast(pMemTable->pTsdb->lruCache, pTbData->uid, pLastRow, pMemTable->pTsdb);
   }
 
-  // SMemTable
-  pMemTable->minKey = TMIN(pMemTable->minKey, pTbData->minKey);
-  pMemTable->maxKey = TMAX(pMemTable->maxKey, pTbData->maxKey);
-  pMemTable->nRow += nRow;
+  // SMemTable, shared by the insert threads of the vnode
+  tsdbMemTableUpdateKeyRange(pMemTable, pTbData->minKey, pTbData->maxKey);
+  atomic_add_fetch_64(&pMemTable->nRow, nRow);
 
   pRsp->numOfRows = nRow;
   pRsp->affectedRows = nRow;
@@ -54,6 +54,7 @@ SSttBlockLoadInfo *tCreateLastBlockLoadInfo(STSchema *pSchema, int16_t *colList,
     }
 
     pLoadInfo[i].aSttBlk = taosArrayInit(4, sizeof(SSttBlk));
+    pLoadInfo[i].aBlkBF = taosArrayInit(0, POINTER_BYTES);
     pLoadInfo[i].pSchema = pSchema;
     pLoadInfo[i].colIds = colList;
     pLoadInfo[i].numOfCols = numOfCols;
@@ -69,6 +70,11 @@ void resetLastBlockLoadInfo(SSttBlockLoadInfo *pLoadInfo) {
     pLoadInfo[i].blockIndex[1] = -1;
 
     taosArrayClear(pLoadInfo[i].aSttBlk);
+    tBloomFilterDestroy(pLoadInfo[i].pBF);
+    pLoadInfo[i].pBF = NULL;
+    taosArrayClearP(pLoadInfo[i].aBlkBF, (FDelete)tBloomFilterDestroy);
+    pLoadInfo[i].blkBFOffset = 0;
+    pLoadInfo[i].blkBFLoaded = false;
 
     pLoadInfo[i].elapsedTime = 0;
     pLoadInfo[i].loadBlocks = 0;
@@ -93,6 +99,8 @@ void *destroyLastBlockLoadInfo(SSttBlockLoadInfo *pLoadInfo) {
     tBlockDataDestroy(&pLoadInfo[i].blockData[1], true);
 
     taosArrayDestroy(pLoadInfo[i].aSttBlk);
+    tBloomFilterDestroy(pLoadInfo[i].pBF);
+    taosArrayDestroyP(pLoadInfo[i].aBlkBF, (FDelete)tBloomFilterDestroy);
   }
 
   taosMemoryFree(pLoadInfo);
@@ -259,6 +267,34 @@ static int32_t binarySearchForStartRowIndex(uint64_t *uidList, int32_t num, uint
   }
 }
 
+// check the uid bloom filter of a stt block, the filters of all blocks are loaded on the first check
+static bool sttBlockNoUid(SLDataIter *pIter, int32_t iSttBlk, const char *idStr) {
+  SSttBlockLoadInfo *pInfo = pIter->pBlockLoadInfo;
+  if (pInfo->pBF == NULL) {
+    return false;
+  }
+
+  if (!pInfo->blkBFLoaded) {
+    pInfo->blkBFLoaded = true;
+
+    int32_t code = tsdbReadSttBlkBF(pIter->pReader, pIter->iStt, pInfo->aBlkBF);
+    if (code) {
+      tsdbWarn("failed to load stt block bloom filters, file index:%d, code:%s, %s", pIter->iStt, tstrerror(code),
+               idStr);
+    }
+  }
+
+  int32_t iBF = pInfo->blkBFOffset + iSttBlk;
+  if (iBF >= taosArrayGetSize(pInfo->aBlkBF)) {
+    return false;
+  }
+
+  SBloomFilter *pBF = *(SBloomFilter **)taosArrayGet(pInfo->aBlkBF, iBF);
+  return tBloomFilterNoContain(pBF, &pIter->uid, sizeof(pIter->uid)) == TSDB_CODE_SUCCESS;
+}
+
+void tLDataIterNextBlock(SLDataIter *pIter, const char *idStr);
+
 int32_t tLDataIterOpen(struct SLDataIter **pIter, SDataFReader *pReader, int32_t iStt, int8_t backward, uint64_t suid,
                        uint64_t uid, STimeWindow *pTimeWindow, SVersionRange *pRange, SSttBlockLoadInfo *pBlockLoadInfo,
                        const char *idStr) {
@@ -316,6 +352,9 @@ int32_t tLDataIterOpen(struct SLDataIter **pIter, SDataFReader *pReader, int32_t
           }
 
           if (s == suid) {
+            if (taosArrayGetSize(pTmp) == 0) {
+              pBlockLoadInfo->blkBFOffset = i;
+            }
             taosArrayPush(pTmp, p);
           } else if (s > suid) {
             break;
@@ -327,17 +366,38 @@ int32_t tLDataIterOpen(struct SLDataIter **pIter, SDataFReader *pReader, int32_t
       }
     }
 
+    if (taosArrayGetSize(pBlockLoadInfo->aSttBlk) > 0) {
+      code = tsdbReadSttBF(pReader, iStt, &pBlockLoadInfo->pBF);
+      if (code) {
+        goto _exit;
+      }
+    }
+
     double el = (taosGetTimestampUs() - st) / 1000.0;
     tsdbDebug("load the last file info completed, elapsed time:%.2fms, %s", el, idStr);
   }
 
+  // the table has no data in this stt file at all
+  if (pBlockLoadInfo->pBF != NULL &&
+      tBloomFilterNoContain(pBlockLoadInfo->pBF, &uid, sizeof(uid)) == TSDB_CODE_SUCCESS) {
+    (*pIter)->iSttBlk = -1;
+    tsdbDebug("uid:%" PRIu64 " filtered out by the bloom filter of stt file:%d, %s", uid, iStt, idStr);
+    return code;
+  }
+
   size_t size = taosArrayGetSize(pBlockLoadInfo->aSttBlk);
 
   // find the start block
   (*pIter)->iSttBlk = binarySearchForStartBlock(pBlockLoadInfo->aSttBlk->pData, size, uid, backward);
   if ((*pIter)->iSttBlk != -1) {
     (*pIter)->pSttBlk = taosArrayGet(pBlockLoadInfo->aSttBlk, (*pIter)->iSttBlk);
-    (*pIter)->iRow = ((*pIter)->backward) ? (*pIter)->pSttBlk->nRow : -1;
+    if (sttBlockNoUid(*pIter, (*pIter)->iSttBlk, idStr)) {
+      tLDataIterNextBlock(*pIter, idStr);
+    }
+
+    if ((*pIter)->pSttBlk != NULL) {
+      (*pIter)->iRow = ((*pIter)->backward) ? (*pIter)->pSttBlk->nRow : -1;
+    }
   }
 
   return code;
@@ -387,7 +447,8 @@ void tLDataIterNextBlock(SLDataIter *pIter, const char *idStr) {
           break;
         }
 
-        if (p->minVer <= pIter->verRange.maxVer && p->maxVer >= pIter->verRange.minVer) {
+        if (p->minVer <= pIter->verRange.maxVer && p->maxVer >= pIter->verRange.minVer &&
+            !sttBlockNoUid(pIter, i, idStr)) {
           index = i;
           break;
         }
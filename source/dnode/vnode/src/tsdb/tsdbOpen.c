@@ -52,6 +52,8 @@ int tsdbOpen(SVnode *pVnode, STsdb **ppTsdb, const char *dir, STsdbKeepCfg *pKee
   // taosRealPath(pTsdb->path, NULL, slen);
   pTsdb->pVnode = pVnode;
   taosThreadRwlockInit(&pTsdb->rwLock, NULL);
+  taosThreadMutexInit(&pTsdb->prefetchMutex, NULL);
+  taosThreadCondInit(&pTsdb->prefetchDone, NULL);
   if (!pKeepCfg) {
     tsdbSetKeepCfg(pTsdb, &pVnode->config.tsdbCfg);
   } else {
@@ -74,6 +76,10 @@ int tsdbOpen(SVnode *pVnode, STsdb **ppTsdb, const char *dir, STsdbKeepCfg *pKee
     goto _err;
   }
 
+  if (tsdbOpenPgCache(pTsdb) < 0) {
+    goto _err;
+  }
+
   tsdbDebug("vgId:%d, tsdb is opened at %s, days:%d, keep:%d,%d,%d", TD_VID(pVnode), pTsdb->path, pTsdb->keepCfg.days,
             pTsdb->keepCfg.keep0, pTsdb->keepCfg.keep1, pTsdb->keepCfg.keep2);
 
@@ -81,6 +87,8 @@ int tsdbOpen(SVnode *pVnode, STsdb **ppTsdb, const char *dir, STsdbKeepCfg *pKee
   return 0;
 
 _err:
+  taosThreadCondDestroy(&pTsdb->prefetchDone);
+  taosThreadMutexDestroy(&pTsdb->prefetchMutex);
   taosMemoryFree(pTsdb);
   return -1;
 }
@@ -94,8 +102,18 @@ int tsdbClose(STsdb **pTsdb) {
 
     taosThreadRwlockDestroy(&(*pTsdb)->rwLock);
 
+    // wait for the prefetch tasks which refer to the page cache
+    taosThreadMutexLock(&(*pTsdb)->prefetchMutex);
+    while ((*pTsdb)->nPrefetch > 0) {
+      taosThreadCondWait(&(*pTsdb)->prefetchDone, &(*pTsdb)->prefetchMutex);
+    }
+    taosThreadMutexUnlock(&(*pTsdb)->prefetchMutex);
+    taosThreadCondDestroy(&(*pTsdb)->prefetchDone);
+    taosThreadMutexDestroy(&(*pTsdb)->prefetchMutex);
+
     tsdbFSClose(*pTsdb);
     tsdbCloseCache(*pTsdb);
+    tsdbClosePgCache(*pTsdb);
     taosMemoryFreeClear(*pTsdb);
   }
   return 0;
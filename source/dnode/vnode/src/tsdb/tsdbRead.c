@@ -79,6 +79,8 @@ typedef struct SIOCostSummary {
   int64_t composedBlocks;
   double  buildComposedBlockTime;
   double  createScanInfoList;
+  int64_t pgCacheHit;  // page cache lookups of the data file readers already closed
+  int64_t pgCacheMiss;
 } SIOCostSummary;
 
 typedef struct SBlockLoadSuppInfo {
@@ -121,6 +123,7 @@ typedef struct SDataBlockIter {
   int32_t   order;
   SDataBlk  block;  // current SDataBlk data
   SHashObj* pTableMap;
+  int32_t   prefetchIndex;  // last block index handed to the background prefetch
 } SDataBlockIter;
 
 typedef struct SFileBlockDumpInfo {
@@ -194,8 +197,6 @@ static int32_t  doAppendRowFromTSRow(SSDataBlock* pBlock, STsdbReader* pReader,
 static int32_t  doAppendRowFromFileBlock(SSDataBlock* pResBlock, STsdbReader* pReader, SBlockData* pBlockData,
                                          int32_t rowIndex);
 static void     setComposedBlockFlag(STsdbReader* pReader, bool composed);
-static bool     hasBeenDropped(const SArray* pDelList, int32_t* index, TSDBKEY* pKey, int32_t order,
-                               SVersionRange* pVerRange);
 
 static int32_t doMergeMemTableMultiRows(TSDBROW* pRow, uint64_t uid, SIterInfo* pIter, SArray* pDelList,
                                         STSRow** pTSRow, STsdbReader* pReader, bool* freeTSRow);
@@ -470,6 +471,20 @@ static int32_t initFilesetIterator(SFilesetIter* pIter, SArray* aDFileSet, STsdb
   return TSDB_CODE_SUCCESS;
 }
 
+static void closeDataFReader(STsdbReader* pReader) {
+  if (pReader->pFileReader == NULL) {
+    return;
+  }
+
+  int64_t nHit = 0;
+  int64_t nMiss = 0;
+  tsdbDataFReaderGetPgCacheStat(pReader->pFileReader, &nHit, &nMiss);
+  pReader->cost.pgCacheHit += nHit;
+  pReader->cost.pgCacheMiss += nMiss;
+
+  tsdbDataFReaderClose(&pReader->pFileReader);
+}
+
 static bool filesetIteratorNext(SFilesetIter* pIter, STsdbReader* pReader) {
   bool    asc = ASCENDING_TRAVERSE(pIter->order);
   int32_t step = asc ? 1 : -1;
@@ -490,9 +505,7 @@ static bool filesetIteratorNext(SFilesetIter* pIter, STsdbReader* pReader) {
   STimeWindow win = {0};
 
   while (1) {
-    if (pReader->pFileReader != NULL) {
-      tsdbDataFReaderClose(&pReader->pFileReader);
-    }
+    closeDataFReader(pReader);
 
     pReader->status.pCurrentFileset = (SDFileSet*)taosArrayGet(pIter->pFileList, pIter->index);
 
@@ -533,6 +546,7 @@ _err:
 static void resetDataBlockIterator(SDataBlockIter* pIter, int32_t order) {
   pIter->order = order;
   pIter->index = -1;
+  pIter->prefetchIndex = -1;
   pIter->numOfBlocks = 0;
   if (pIter->blockList == NULL) {
     pIter->blockList = taosArrayInit(4, sizeof(SFileDataBlockInfo));
@@ -882,113 +896,58 @@ static int32_t getEndPosInDataBlock(STsdbReader* pReader, SBlockData* pBlockData
 
 static void copyPrimaryTsCol(const SBlockData* pBlockData, SFileBlockDumpInfo* pDumpInfo, SColumnInfoData* pColData,
                              int32_t dumpedRows, bool asc) {
-  if (asc) {
-    memcpy(pColData->pData, &pBlockData->aTSKEY[pDumpInfo->rowIndex], dumpedRows * sizeof(int64_t));
-  } else {
-    int32_t startIndex = pDumpInfo->rowIndex - dumpedRows + 1;
-    memcpy(pColData->pData, &pBlockData->aTSKEY[startIndex], dumpedRows * sizeof(int64_t));
-
-    // todo: opt perf by extract the loop
-    // reverse the array list
-    int32_t  mid = dumpedRows >> 1u;
-    int64_t* pts = (int64_t*)pColData->pData;
-    for (int32_t j = 0; j < mid; ++j) {
-      int64_t t = pts[j];
-      pts[j] = pts[dumpedRows - j - 1];
-      pts[dumpedRows - j - 1] = t;
-    }
-  }
+  // the key column is not kept as SColData, wrap it to share the reversed copy
+  SColData tsCol = {.type = TSDB_DATA_TYPE_TIMESTAMP, .flag = HAS_VALUE, .pData = (uint8_t*)pBlockData->aTSKEY};
+  tColDataCopyFixedValues(&tsCol, pDumpInfo->rowIndex, dumpedRows, asc, pColData->pData);
 }
 
 // a faster version of copy procedure.
 static void copyNumericCols(const SColData* pData, SFileBlockDumpInfo* pDumpInfo, SColumnInfoData* pColData,
                             int32_t dumpedRows, bool asc)  {
-  uint8_t* p = NULL;
-  if (asc) {
-    p = pData->pData + tDataTypes[pData->type].bytes * pDumpInfo->rowIndex;
-  } else {
-    int32_t startIndex = pDumpInfo->rowIndex - dumpedRows + 1;
-    p = pData->pData + tDataTypes[pData->type].bytes * startIndex;
-  }
-
-  int32_t step = asc? 1:-1;
-
-  // make sure it is aligned to 8bit, the allocated memory address is aligned to 256bit
-//  ASSERT((((uint64_t)pColData->pData) & (0x8 - 1)) == 0);
-
-  // 1. copy data in a batch model
-  memcpy(pColData->pData, p, dumpedRows * tDataTypes[pData->type].bytes);
-
-  // 2. reverse the array list in case of descending order scan data block
-  if (!asc) {
-    switch(pColData->info.type) {
-      case TSDB_DATA_TYPE_TIMESTAMP:
-      case TSDB_DATA_TYPE_DOUBLE:
-      case TSDB_DATA_TYPE_BIGINT:
-      case TSDB_DATA_TYPE_UBIGINT:
-      {
-        int32_t  mid = dumpedRows >> 1u;
-        int64_t* pts = (int64_t*)pColData->pData;
-        for (int32_t j = 0; j < mid; ++j) {
-          int64_t t = pts[j];
-          pts[j] = pts[dumpedRows - j - 1];
-          pts[dumpedRows - j - 1] = t;
-        }
-        break;
-      }
+  // 1. copy data in a batch model, the array is reversed during the copy in case of descending order scan data block
+  tColDataCopyFixedValues(pData, pDumpInfo->rowIndex, dumpedRows, asc, pColData->pData);
 
-      case TSDB_DATA_TYPE_BOOL:
-      case TSDB_DATA_TYPE_TINYINT:
-      case TSDB_DATA_TYPE_UTINYINT: {
-        int32_t  mid = dumpedRows >> 1u;
-        int8_t* pts = (int8_t*)pColData->pData;
-        for (int32_t j = 0; j < mid; ++j) {
-          int8_t t = pts[j];
-          pts[j] = pts[dumpedRows - j - 1];
-          pts[dumpedRows - j - 1] = t;
-        }
-        break;
-      }
+  // 2. if the null value exists, set the null bitmap a word at a time
+  if (pData->flag != HAS_VALUE) {
+    if (tColDataGetNullBitmap(pData, pDumpInfo->rowIndex, dumpedRows, asc, pColData->nullbitmap)) {
+      pColData->hasNull = true;
+    }
+  }
+}
 
-      case TSDB_DATA_TYPE_SMALLINT:
-      case TSDB_DATA_TYPE_USMALLINT: {
-        int32_t  mid = dumpedRows >> 1u;
-        int16_t* pts = (int16_t*)pColData->pData;
-        for (int32_t j = 0; j < mid; ++j) {
-          int64_t t = pts[j];
-          pts[j] = pts[dumpedRows - j - 1];
-          pts[dumpedRows - j - 1] = t;
-        }
-        break;
-      }
+// the rows of a dictionary encoded column share one copy of each distinct value, and carry its code to the operators
+static int32_t copyDictCols(const SColData* pData, SFileBlockDumpInfo* pDumpInfo, SColumnInfoData* pColData,
+                            int32_t dumpedRows, bool asc, int32_t colIndex, SBlockLoadSuppInfo* pSup) {
+  int32_t aEntry[TSDB_DICT_MAX_SIZE];
+  int32_t step = asc ? 1 : -1;
+  SColVal cv = {0};
 
-      case TSDB_DATA_TYPE_FLOAT:
-      case TSDB_DATA_TYPE_INT:
-      case TSDB_DATA_TYPE_UINT: {
-        int32_t  mid = dumpedRows >> 1u;
-        int32_t* pts = (int32_t*)pColData->pData;
-        for (int32_t j = 0; j < mid; ++j) {
-          int32_t t = pts[j];
-          pts[j] = pts[dumpedRows - j - 1];
-          pts[dumpedRows - j - 1] = t;
-        }
-        break;
-      }
-    }
+  int32_t code = colDataSetDict(pColData, pData->nDict, dumpedRows);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
   }
 
-  // 3. if the  null value exists, check items one-by-one
-  if (pData->flag != HAS_VALUE) {
-    int32_t rowIndex = 0;
+  memset(aEntry, 0xff, sizeof(int32_t) * pData->nDict);
+  for (int32_t j = pDumpInfo->rowIndex, rowIndex = 0; rowIndex < dumpedRows; j += step, ++rowIndex) {
+    tColDataGetValue((SColData*)pData, j, &cv);
+    if (!COL_VAL_IS_VALUE(&cv)) {
+      colDataAppendNULL(pColData, rowIndex);
+      continue;
+    }
 
-    for (int32_t j = pDumpInfo->rowIndex; rowIndex < dumpedRows; j += step, rowIndex++) {
-      uint8_t v = tColDataGetBitValue(pData, j);
-      if (v == 0 || v == 1) {
-        colDataSetNull_f(pColData->nullbitmap, rowIndex);
-        pColData->hasNull = true;
-      }
+    int16_t dictCode = pData->aDictCode[j];
+    if (aEntry[dictCode] < 0) {
+      doCopyColVal(pColData, rowIndex, colIndex, &cv, pSup);
+      aEntry[dictCode] = pColData->varmeta.offset[rowIndex];
+    } else {
+      pColData->varmeta.offset[rowIndex] = aEntry[dictCode];
     }
+    pColData->varmeta.dictCode[rowIndex] = dictCode;
   }
+
+  // the appends of the values drop the dictionary
+  pColData->varmeta.dictSize = pData->nDict;
+  return TSDB_CODE_SUCCESS;
 }
 
 static int32_t copyBlockDataToSDataBlock(STsdbReader* pReader, STableBlockScanInfo* pBlockScanInfo) {
@@ -1068,6 +1027,11 @@ static int32_t copyBlockDataToSDataBlock(STsdbReader* pReader, STableBlockScanIn
       } else {
         if (IS_MATHABLE_TYPE(pColData->info.type)) {
           copyNumericCols(pData, pDumpInfo, pColData, dumpedRows, asc);
+        } else if (pData->nDict > 0) {
+          int32_t code = copyDictCols(pData, pDumpInfo, pColData, dumpedRows, asc, i, pSupInfo);
+          if (code != TSDB_CODE_SUCCESS) {
+            return code;
+          }
         } else {  // varchar/nchar type
           for (int32_t j = pDumpInfo->rowIndex; rowIndex < dumpedRows; j += step) {
             tColDataGetValue(pData, j, &cv);
@@ -1119,6 +1083,61 @@ static int32_t copyBlockDataToSDataBlock(STsdbReader* pReader, STableBlockScanIn
   return TSDB_CODE_SUCCESS;
 }
 
+static int32_t getDataBlkByIndex(SDataBlockIter* pBlockIter, int32_t index, SDataBlk* pBlock) {
+  SFileDataBlockInfo*   pBlockInfo = taosArrayGet(pBlockIter->blockList, index);
+  STableBlockScanInfo** pScanInfo = taosHashGet(pBlockIter->pTableMap, &pBlockInfo->uid, sizeof(pBlockInfo->uid));
+  if (pScanInfo == NULL) {
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  SBlockIndex* pIndex = taosArrayGet((*pScanInfo)->pBlockList, pBlockInfo->tbBlockIdx);
+  tMapDataGetItemByIdx(&(*pScanInfo)->mapData, pIndex->ordinalIndex, pBlock, tGetDataBlk);
+  return TSDB_CODE_SUCCESS;
+}
+
+// hand the next data blocks in the traverse order to the background prefetch, so that their pages are already in the
+// page cache when they are loaded. A new batch is issued once half of the previous one has been consumed.
+static void doPrefetchFileBlocks(STsdbReader* pReader, SDataBlockIter* pBlockIter) {
+  int32_t numOfPrefetch = tsTsdbPrefetchBlocks;
+  if (numOfPrefetch <= 0 || pReader->pFileReader == NULL) {
+    return;
+  }
+
+  bool    asc = ASCENDING_TRAVERSE(pBlockIter->order);
+  int32_t step = asc ? 1 : -1;
+  int32_t remain = (pBlockIter->prefetchIndex - pBlockIter->index) * step;
+  if (remain > numOfPrefetch / 2) {
+    return;
+  }
+
+  int32_t start = (remain > 0) ? pBlockIter->prefetchIndex + step : pBlockIter->index + step;
+  int32_t end = asc ? TMIN(pBlockIter->index + numOfPrefetch, pBlockIter->numOfBlocks - 1)
+                    : TMAX(pBlockIter->index - numOfPrefetch, 0);
+  if ((end - start) * step < 0) {
+    return;
+  }
+
+  SArray* aBlkInfo = taosArrayInit(numOfPrefetch, sizeof(SBlockInfo));
+  if (aBlkInfo == NULL) {
+    return;
+  }
+
+  for (int32_t i = start; (end - i) * step >= 0; i += step) {
+    SDataBlk block = {0};
+    if (getDataBlkByIndex(pBlockIter, i, &block) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    for (int32_t iSubBlock = 0; iSubBlock < block.nSubBlock; iSubBlock++) {
+      taosArrayPush(aBlkInfo, &block.aSubBlock[iSubBlock]);
+    }
+    pBlockIter->prefetchIndex = i;
+  }
+
+  tsdbPrefetchDataBlocks(pReader->pFileReader, aBlkInfo);
+  taosArrayDestroy(aBlkInfo);
+}
+
 static int32_t doLoadFileBlockData(STsdbReader* pReader, SDataBlockIter* pBlockIter, SBlockData* pBlockData,
                                    uint64_t uid) {
   int64_t st = taosGetTimestampUs();
@@ -1135,6 +1154,8 @@ static int32_t doLoadFileBlockData(STsdbReader* pReader, SDataBlockIter* pBlockI
   SFileBlockDumpInfo* pDumpInfo = &pReader->status.fBlockDumpInfo;
 
   SDataBlk* pBlock = getCurrentBlock(pBlockIter);
+  doPrefetchFileBlocks(pReader, pBlockIter);
+
   code = tsdbReadDataBlock(pReader->pFileReader, pBlock, pBlockData);
   if (code != TSDB_CODE_SUCCESS) {
     tsdbError("%p error occurs in loading file block, global index:%d, table index:%d, brange:%" PRId64 "-%" PRId64
@@ -1293,6 +1314,7 @@ static int32_t initBlockIterator(STsdbReader* pReader, SDataBlockIter* pBlockIte
               pReader, numOfBlocks, (et - st) / 1000.0, pReader->idStr);
 
     pBlockIter->index = asc ? 0 : (numOfBlocks - 1);
+    pBlockIter->prefetchIndex = pBlockIter->index;
     cleanupBlockOrderSupporter(&sup);
     doSetCurrentBlock(pBlockIter, pReader->idStr);
     return TSDB_CODE_SUCCESS;
@@ -1333,6 +1355,7 @@ static int32_t initBlockIterator(STsdbReader* pReader, SDataBlockIter* pBlockIte
   taosMemoryFree(pTree);
 
   pBlockIter->index = asc ? 0 : (numOfBlocks - 1);
+  pBlockIter->prefetchIndex = pBlockIter->index;
   doSetCurrentBlock(pBlockIter, pReader->idStr);
 
   return TSDB_CODE_SUCCESS;
@@ -1651,9 +1674,9 @@ static bool tryCopyDistinctRowFromSttBlock(TSDBROW* fRow, SLastBlockReader* pLas
 }
 
 static FORCE_INLINE STSchema* doGetSchemaForTSRow(int32_t sversion, STsdbReader* pReader, uint64_t uid) {
-  // always set the newest schema version in pReader->pSchema
+  // always set the newest schema version in pReader->pSchema, the schemas are acquired from the meta schema cache
   if (pReader->pSchema == NULL) {
-    pReader->pSchema = metaGetTbTSchema(pReader->pTsdb->pVnode->pMeta, uid, -1, 1);
+    metaAcquireTbTSchema(pReader->pTsdb->pVnode->pMeta, uid, -1, &pReader->pSchema);
   }
 
   if (pReader->pSchema && sversion == pReader->pSchema->version) {
@@ -1662,7 +1685,7 @@ static FORCE_INLINE STSchema* doGetSchemaForTSRow(int32_t sversion, STsdbReader*
 
   if (pReader->pMemSchema == NULL) {
     int32_t code =
-        metaGetTbTSchemaEx(pReader->pTsdb->pVnode->pMeta, pReader->suid, uid, sversion, &pReader->pMemSchema);
+        metaAcquireTbTSchemaEx(pReader->pTsdb->pVnode->pMeta, pReader->suid, uid, sversion, &pReader->pMemSchema);
     if (code != TSDB_CODE_SUCCESS) {
       terrno = code;
       return NULL;
@@ -1675,8 +1698,9 @@ static FORCE_INLINE STSchema* doGetSchemaForTSRow(int32_t sversion, STsdbReader*
     return pReader->pMemSchema;
   }
 
-  taosMemoryFreeClear(pReader->pMemSchema);
-  int32_t code = metaGetTbTSchemaEx(pReader->pTsdb->pVnode->pMeta, pReader->suid, uid, sversion, &pReader->pMemSchema);
+  metaReleaseTbTSchema(pReader->pTsdb->pVnode->pMeta, pReader->pMemSchema);
+  int32_t code =
+      metaAcquireTbTSchemaEx(pReader->pTsdb->pVnode->pMeta, pReader->suid, uid, sversion, &pReader->pMemSchema);
   if (code != TSDB_CODE_SUCCESS || pReader->pMemSchema == NULL) {
     terrno = code;
     return NULL;
@@ -3764,13 +3788,13 @@ int32_t tsdbReaderOpen(SVnode* pVnode, SQueryTableDataCond* pCond, void* pTableL
   //  no valid error code set in metaGetTbTSchema, so let's set the error code here.
   //  we should proceed in case of tmq processing.
   if (pCond->suid != 0) {
-    pReader->pSchema = metaGetTbTSchema(pReader->pTsdb->pVnode->pMeta, pReader->suid, -1, 1);
+    metaAcquireTbTSchema(pReader->pTsdb->pVnode->pMeta, pReader->suid, -1, &pReader->pSchema);
     if (pReader->pSchema == NULL) {
       tsdbError("failed to get table schema, suid:%" PRIu64 ", ver:-1, %s", pReader->suid, pReader->idStr);
     }
   } else if (numOfTables > 0) {
     STableKeyInfo* pKey = pTableList;
-    pReader->pSchema = metaGetTbTSchema(pReader->pTsdb->pVnode->pMeta, pKey->uid, -1, 1);
+    metaAcquireTbTSchema(pReader->pTsdb->pVnode->pMeta, pKey->uid, -1, &pReader->pSchema);
     if (pReader->pSchema == NULL) {
       tsdbError("failed to get table schema, uid:%" PRIu64 ", ver:-1, %s", pKey->uid, pReader->idStr);
     }
@@ -3884,9 +3908,7 @@ void tsdbReaderClose(STsdbReader* pReader) {
     clearBlockScanInfoBuf(&pReader->blockInfoBuf);
   }
 
-  if (pReader->pFileReader != NULL) {
-    tsdbDataFReaderClose(&pReader->pFileReader);
-  }
+  closeDataFReader(pReader);
 
   if (pReader->pDelFReader != NULL) {
     tsdbDelFReaderClose(&pReader->pDelFReader);
@@ -3918,16 +3940,18 @@ void tsdbReaderClose(STsdbReader* pReader) {
             ", fileBlocks-load-time:%.2f ms, "
             "build in-memory-block-time:%.2f ms, lastBlocks:%" PRId64
             ", lastBlocks-time:%.2f ms, composed-blocks:%" PRId64
-            ", composed-blocks-time:%.2fms, STableBlockScanInfo size:%.2f Kb, creatTime:%.2f ms, %s",
+            ", composed-blocks-time:%.2fms, STableBlockScanInfo size:%.2f Kb, creatTime:%.2f ms, "
+            "page-cache-hits:%" PRId64 ", page-cache-misses:%" PRId64 ", %s",
             pReader, pCost->headFileLoad, pCost->headFileLoadTime, pCost->smaDataLoad, pCost->smaLoadTime,
             pCost->numOfBlocks, pCost->blockLoadTime, pCost->buildmemBlock, pCost->lastBlockLoad,
             pCost->lastBlockLoadTime, pCost->composedBlocks, pCost->buildComposedBlockTime,
-            numOfTables * sizeof(STableBlockScanInfo) / 1000.0, pCost->createScanInfoList, pReader->idStr);
+            numOfTables * sizeof(STableBlockScanInfo) / 1000.0, pCost->createScanInfoList, pCost->pgCacheHit,
+            pCost->pgCacheMiss, pReader->idStr);
 
   taosMemoryFree(pReader->idStr);
-  taosMemoryFree(pReader->pSchema);
+  metaReleaseTbTSchema(pReader->pTsdb->pVnode->pMeta, pReader->pSchema);
   if (pReader->pMemSchema != pReader->pSchema) {
-    taosMemoryFree(pReader->pMemSchema);
+    metaReleaseTbTSchema(pReader->pTsdb->pVnode->pMeta, pReader->pMemSchema);
   }
   taosMemoryFreeClear(pReader);
 }
@@ -4198,7 +4222,7 @@ int32_t tsdbReaderReset(STsdbReader* pReader, SQueryTableDataCond* pCond) {
   memset(&pReader->suppInfo.tsColAgg, 0, sizeof(SColumnDataAgg));
 
   pReader->suppInfo.tsColAgg.colId = PRIMARYKEY_TIMESTAMP_COL_ID;
-  tsdbDataFReaderClose(&pReader->pFileReader);
+  closeDataFReader(pReader);
 
   int32_t numOfTables = taosHashGetSize(pReader->status.pTableMap);
 
@@ -4302,9 +4326,39 @@ int32_t tsdbGetFileBlocksDistInfo(STsdbReader* pReader, STableBlockDistInfo* pTa
     //              pReader->pFileGroup->fid, pReader->idStr);
   }
 
+  // the pages read by this query only
+  int64_t nHit = 0;
+  int64_t nMiss = 0;
+  tsdbReaderGetPgCacheStat(pReader, &nHit, &nMiss);
+  pTableBlockInfo->numOfPageCacheHits = nHit;
+  pTableBlockInfo->numOfPageCacheMisses = nMiss;
+
   return code;
 }
 
+void tsdbReaderGetPgCacheStat(STsdbReader* pReader, int64_t* nHit, int64_t* nMiss) {
+  *nHit = pReader->cost.pgCacheHit;
+  *nMiss = pReader->cost.pgCacheMiss;
+
+  if (pReader->pFileReader != NULL) {
+    int64_t hit = 0;
+    int64_t miss = 0;
+    tsdbDataFReaderGetPgCacheStat(pReader->pFileReader, &hit, &miss);
+    *nHit += hit;
+    *nMiss += miss;
+  }
+
+  for (int32_t i = 0; i < tListLen(pReader->innerReader); ++i) {
+    if (pReader->innerReader[i] != NULL) {
+      int64_t hit = 0;
+      int64_t miss = 0;
+      tsdbReaderGetPgCacheStat(pReader->innerReader[i], &hit, &miss);
+      *nHit += hit;
+      *nMiss += miss;
+    }
+  }
+}
+
 int64_t tsdbGetNumOfRowsInMemTable(STsdbReader* pReader) {
   int64_t rows = 0;
 
@@ -15,10 +15,13 @@
 
 #include "tsdb.h"
 
+#define TSDB_STT_BF_FPR 0.01  // false positive rate of the uid bloom filters in stt files
+
 // =============== PAGE-WISE FILE ===============
-static int32_t tsdbOpenFile(const char *path, int32_t szPage, int32_t flag, STsdbFD **ppFD) {
+static int32_t tsdbOpenFile(const char *path, STsdb *pTsdb, int32_t flag, STsdbFD **ppFD) {
   int32_t  code = 0;
   STsdbFD *pFD = NULL;
+  int32_t  szPage = pTsdb->pVnode->config.tsdbPageSize;
 
   *ppFD = NULL;
 
@@ -28,6 +31,7 @@ static int32_t tsdbOpenFile(const char *path, int32_t szPage, int32_t flag, STsd
     goto _exit;
   }
 
+  pFD->pTsdb = pTsdb;
   pFD->path = (char *)&pFD[1];
   strcpy(pFD->path, path);
   pFD->szPage = szPage;
@@ -90,6 +94,9 @@ static int32_t tsdbWriteFilePage(STsdbFD *pFD) {
       goto _exit;
     }
 
+    // the page may be cached from a previous read, drop the stale copy
+    tsdbPgCacheErase(pFD->pTsdb, pFD->path, pFD->pgno);
+
     if (pFD->szFile < pFD->pgno) {
       pFD->szFile = pFD->pgno;
     }
@@ -105,6 +112,17 @@ static int32_t tsdbReadFilePage(STsdbFD *pFD, int64_t pgno) {
 
   ASSERT(pgno <= pFD->szFile);
 
+  // cache, the header page and the last page may still be rewritten by an appending writer, so they are not cached
+  bool cacheable = (pFD->pTsdb->pgCache != NULL && pgno > 1 && pgno < pFD->szFile);
+  if (cacheable) {
+    if (tsdbPgCacheGet(pFD->pTsdb, pFD->path, pgno, pFD->pBuf, pFD->szPage)) {
+      pFD->nPgCacheHit++;
+      pFD->pgno = pgno;
+      goto _exit;
+    }
+    pFD->nPgCacheMiss++;
+  }
+
   // seek
   int64_t offset = PAGE_OFFSET(pgno, pFD->szPage);
   int64_t n = taosLSeekFile(pFD->pFD, offset, SEEK_SET);
@@ -129,6 +147,10 @@ static int32_t tsdbReadFilePage(STsdbFD *pFD, int64_t pgno) {
     goto _exit;
   }
 
+  if (cacheable) {
+    tsdbPgCachePut(pFD->pTsdb, pFD->path, pgno, pFD->pBuf, pFD->szPage);
+  }
+
   pFD->pgno = pgno;
 
 _exit:
@@ -216,7 +238,6 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
   int32_t       code = 0;
   int32_t       flag;
   int64_t       n;
-  int32_t       szPage = pTsdb->pVnode->config.tsdbPageSize;
   SDataFWriter *pWriter = NULL;
   char          fname[TSDB_FILENAME_LEN];
   char          hdr[TSDB_FHDR_SIZE] = {0};
@@ -245,7 +266,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
   // head
   flag = TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC;
   tsdbHeadFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fHead, fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pHeadFD);
+  code = tsdbOpenFile(fname, pTsdb, flag, &pWriter->pHeadFD);
   if (code) goto _err;
 
   code = tsdbWriteFile(pWriter->pHeadFD, 0, hdr, TSDB_FHDR_SIZE);
@@ -259,7 +280,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
     flag = TD_FILE_READ | TD_FILE_WRITE;
   }
   tsdbDataFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fData, fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pDataFD);
+  code = tsdbOpenFile(fname, pTsdb, flag, &pWriter->pDataFD);
   if (code) goto _err;
   if (pWriter->fData.size == 0) {
     code = tsdbWriteFile(pWriter->pDataFD, 0, hdr, TSDB_FHDR_SIZE);
@@ -274,7 +295,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
     flag = TD_FILE_READ | TD_FILE_WRITE;
   }
   tsdbSmaFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fSma, fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pSmaFD);
+  code = tsdbOpenFile(fname, pTsdb, flag, &pWriter->pSmaFD);
   if (code) goto _err;
   if (pWriter->fSma.size == 0) {
     code = tsdbWriteFile(pWriter->pSmaFD, 0, hdr, TSDB_FHDR_SIZE);
@@ -287,7 +308,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
   ASSERT(pWriter->fStt[pSet->nSttF - 1].size == 0);
   flag = TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC;
   tsdbSttFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fStt[pSet->nSttF - 1], fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pSttFD);
+  code = tsdbOpenFile(fname, pTsdb, flag, &pWriter->pSttFD);
   if (code) goto _err;
   code = tsdbWriteFile(pWriter->pSttFD, 0, hdr, TSDB_FHDR_SIZE);
   if (code) goto _err;
@@ -331,6 +352,8 @@ int32_t tsdbDataFWriterClose(SDataFWriter **ppWriter, int8_t sync) {
   for (int32_t iBuf = 0; iBuf < sizeof((*ppWriter)->aBuf) / sizeof(uint8_t *); iBuf++) {
     tFree((*ppWriter)->aBuf[iBuf]);
   }
+  taosArrayDestroy((*ppWriter)->aSttUid);
+  taosArrayDestroy((*ppWriter)->aSttUidEnd);
   taosMemoryFree(*ppWriter);
 _exit:
   *ppWriter = NULL;
@@ -461,6 +484,138 @@ _err:
   return code;
 }
 
+int32_t tsdbAddSttBlkUid(SDataFWriter *pWriter, const int64_t *aUid, int32_t nUid) {
+  int32_t code = 0;
+
+  if (pWriter->aSttUid == NULL) {
+    pWriter->aSttUid = taosArrayInit(0, sizeof(int64_t));
+    pWriter->aSttUidEnd = taosArrayInit(0, sizeof(int32_t));
+    if (pWriter->aSttUid == NULL || pWriter->aSttUidEnd == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      return code;
+    }
+  }
+
+  // uids of a stt block are sorted, keep each of them only once
+  int32_t iStart = taosArrayGetSize(pWriter->aSttUid);
+  for (int32_t iUid = 0; iUid < nUid; iUid++) {
+    if (taosArrayGetSize(pWriter->aSttUid) > iStart && *(int64_t *)taosArrayGetLast(pWriter->aSttUid) == aUid[iUid]) {
+      continue;
+    }
+
+    if (taosArrayPush(pWriter->aSttUid, &aUid[iUid]) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      return code;
+    }
+  }
+
+  int32_t iEnd = taosArrayGetSize(pWriter->aSttUid);
+  if (taosArrayPush(pWriter->aSttUidEnd, &iEnd) == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    return code;
+  }
+
+  return code;
+}
+
+static SBloomFilter *tsdbBuildSttBF(const int64_t *aUid, int32_t nUid) {
+  SBloomFilter *pBF = tBloomFilterInit(TMAX(nUid, 1), TSDB_STT_BF_FPR);
+  if (pBF == NULL) return NULL;
+
+  for (int32_t iUid = 0; iUid < nUid; iUid++) {
+    tBloomFilterPut(pBF, &aUid[iUid], sizeof(int64_t));
+  }
+
+  return pBF;
+}
+
+// uid bloom filters of a stt file, written after the SSttBlk array:
+// | szFileBF (int64) | uid filter of the whole file | uid filter of SSttBlk[0] | ... | uid filter of SSttBlk[n-1] |
+static int32_t tsdbWriteSttBF(SDataFWriter *pWriter, int32_t nSttBlk) {
+  int32_t   code = 0;
+  int32_t   lino = 0;
+  SSttFile *pSttFile = &pWriter->fStt[pWriter->wSet.nSttF - 1];
+  SArray   *aBF = NULL;
+  SEncoder  encoder = {0};
+  int64_t   szFileBF = 0;
+  int64_t   size = 0;
+
+  if (!tsTsdbSttBloomFilter || pWriter->aSttUidEnd == NULL || taosArrayGetSize(pWriter->aSttUidEnd) != nSttBlk) {
+    goto _exit;
+  }
+
+  aBF = taosArrayInit(nSttBlk + 1, POINTER_BYTES);
+  if (aBF == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // build
+  const int64_t *aUid = (const int64_t *)pWriter->aSttUid->pData;
+  for (int32_t iBlk = -1; iBlk < nSttBlk; iBlk++) {
+    SBloomFilter *pBF = NULL;
+    if (iBlk < 0) {
+      pBF = tsdbBuildSttBF(aUid, taosArrayGetSize(pWriter->aSttUid));
+    } else {
+      int32_t iStart = (iBlk == 0) ? 0 : *(int32_t *)taosArrayGet(pWriter->aSttUidEnd, iBlk - 1);
+      int32_t iEnd = *(int32_t *)taosArrayGet(pWriter->aSttUidEnd, iBlk);
+      pBF = tsdbBuildSttBF(aUid + iStart, iEnd - iStart);
+    }
+
+    if (pBF == NULL || taosArrayPush(aBF, &pBF) == NULL) {
+      tBloomFilterDestroy(pBF);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  // size
+  for (int32_t iBF = 0; iBF < taosArrayGetSize(aBF); iBF++) {
+    tEncoderInit(&encoder, NULL, 0);
+    tBloomFilterEncode(*(SBloomFilter **)taosArrayGet(aBF, iBF), &encoder);
+    if (iBF == 0) szFileBF = encoder.pos;
+    size += encoder.pos;
+    tEncoderClear(&encoder);
+  }
+  size += sizeof(int64_t);
+
+  // encode
+  code = tRealloc(&pWriter->aBuf[0], size);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tEncoderInit(&encoder, pWriter->aBuf[0], size);
+  if (tEncodeI64(&encoder, szFileBF) < 0) {
+    code = TSDB_CODE_INVALID_MSG;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  for (int32_t iBF = 0; iBF < taosArrayGetSize(aBF); iBF++) {
+    if (tBloomFilterEncode(*(SBloomFilter **)taosArrayGet(aBF, iBF), &encoder) < 0) {
+      code = TSDB_CODE_INVALID_MSG;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+  ASSERT(encoder.pos == size);
+
+  // write
+  code = tsdbWriteFile(pWriter->pSttFD, pSttFile->size, pWriter->aBuf[0], size);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // update
+  pSttFile->bfOffset = pSttFile->size;
+  pSttFile->size += size;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pWriter->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  tEncoderClear(&encoder);
+  taosArrayDestroyP(aBF, (FDelete)tBloomFilterDestroy);
+  taosArrayClear(pWriter->aSttUid);
+  taosArrayClear(pWriter->aSttUidEnd);
+  return code;
+}
+
 int32_t tsdbWriteSttBlk(SDataFWriter *pWriter, SArray *aSttBlk) {
   int32_t   code = 0;
   SSttFile *pSttFile = &pWriter->fStt[pWriter->wSet.nSttF - 1];
@@ -497,6 +652,9 @@ int32_t tsdbWriteSttBlk(SDataFWriter *pWriter, SArray *aSttBlk) {
   pSttFile->offset = pSttFile->size;
   pSttFile->size += size;
 
+  code = tsdbWriteSttBF(pWriter, taosArrayGetSize(aSttBlk));
+  if (code) goto _err;
+
 _exit:
   tsdbTrace("vgId:%d, tsdb write stt block, loffset:%" PRId64 " size:%" PRId64, TD_VID(pWriter->pTsdb->pVnode),
             pSttFile->offset, size);
@@ -558,7 +716,7 @@ int32_t tsdbWriteBlockData(SDataFWriter *pWriter, SBlockData *pBlockData, SBlock
   pBlkInfo->szKey = 0;
 
   int32_t aBufN[4] = {0};
-  code = tCmprBlockData(pBlockData, cmprAlg, NULL, NULL, pWriter->aBuf, aBufN);
+  code = tCmprBlockData(pBlockData, cmprAlg, TSDB_DATA_FMT_VER, NULL, NULL, pWriter->aBuf, aBufN);
   if (code) goto _err;
 
   // write =================
@@ -664,7 +822,7 @@ int32_t tsdbWriteDiskData(SDataFWriter *pWriter, const SDiskData *pDiskData, SBl
     n = 0;
     for (int32_t iDiskCol = 0; iDiskCol < taosArrayGetSize(pDiskData->aDiskCol); iDiskCol++) {
       SDiskCol *pDiskCol = (SDiskCol *)taosArrayGet(pDiskData->aDiskCol, iDiskCol);
-      n += tPutBlockCol(pWriter->aBuf[0] + n, pDiskCol);
+      n += tPutBlockCol(pWriter->aBuf[0] + n, pDiskCol, pDiskData->hdr.fmtVer);
     }
     ASSERT(n == pDiskData->hdr.szBlkCol);
 
@@ -845,7 +1003,6 @@ int32_t tsdbDataFReaderOpen(SDataFReader **ppReader, STsdb *pTsdb, SDFileSet *pS
   int32_t       code = 0;
   int32_t       lino = 0;
   SDataFReader *pReader = NULL;
-  int32_t       szPage = pTsdb->pVnode->config.tsdbPageSize;
   char          fname[TSDB_FILENAME_LEN];
 
   // alloc
@@ -859,23 +1016,23 @@ int32_t tsdbDataFReaderOpen(SDataFReader **ppReader, STsdb *pTsdb, SDFileSet *pS
 
   // head
   tsdbHeadFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pHeadF, fname);
-  code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->pHeadFD);
+  code = tsdbOpenFile(fname, pTsdb, TD_FILE_READ, &pReader->pHeadFD);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // data
   tsdbDataFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pDataF, fname);
-  code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->pDataFD);
+  code = tsdbOpenFile(fname, pTsdb, TD_FILE_READ, &pReader->pDataFD);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // sma
   tsdbSmaFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pSmaF, fname);
-  code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->pSmaFD);
+  code = tsdbOpenFile(fname, pTsdb, TD_FILE_READ, &pReader->pSmaFD);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // stt
   for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
     tsdbSttFileName(pTsdb, pSet->diskId, pSet->fid, pSet->aSttF[iStt], fname);
-    code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->aSttFD[iStt]);
+    code = tsdbOpenFile(fname, pTsdb, TD_FILE_READ, &pReader->aSttFD[iStt]);
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
@@ -925,6 +1082,23 @@ int32_t tsdbDataFReaderClose(SDataFReader **ppReader) {
   return code;
 }
 
+// add up the page cache hits and misses of the reads through all files of the reader
+void tsdbDataFReaderGetPgCacheStat(SDataFReader *pReader, int64_t *nHit, int64_t *nMiss) {
+  STsdbFD *aFD[3 + TSDB_MAX_STT_TRIGGER] = {pReader->pHeadFD, pReader->pDataFD, pReader->pSmaFD};
+  for (int32_t iStt = 0; iStt < TSDB_MAX_STT_TRIGGER; iStt++) {
+    aFD[3 + iStt] = pReader->aSttFD[iStt];
+  }
+
+  *nHit = 0;
+  *nMiss = 0;
+  for (int32_t iFD = 0; iFD < tListLen(aFD); iFD++) {
+    if (aFD[iFD]) {
+      *nHit += aFD[iFD]->nPgCacheHit;
+      *nMiss += aFD[iFD]->nPgCacheMiss;
+    }
+  }
+}
+
 int32_t tsdbReadBlockIdx(SDataFReader *pReader, SArray *aBlockIdx) {
   int32_t    code = 0;
   SHeadFile *pHeadFile = pReader->pSet->pHeadF;
@@ -966,7 +1140,7 @@ int32_t tsdbReadSttBlk(SDataFReader *pReader, int32_t iStt, SArray *aSttBlk) {
   int32_t   code = 0;
   SSttFile *pSttFile = pReader->pSet->aSttF[iStt];
   int64_t   offset = pSttFile->offset;
-  int64_t   size = pSttFile->size - offset;
+  int64_t   size = (pSttFile->bfOffset ? pSttFile->bfOffset : pSttFile->size) - offset;
 
   taosArrayClear(aSttBlk);
   if (size == 0) return code;
@@ -999,6 +1173,102 @@ _err:
   return code;
 }
 
+static int32_t tsdbReadSttBFSize(SDataFReader *pReader, int32_t iStt, int64_t *szFileBF) {
+  int32_t   code = 0;
+  SSttFile *pSttFile = pReader->pSet->aSttF[iStt];
+
+  code = tRealloc(&pReader->aBuf[0], sizeof(int64_t));
+  if (code) return code;
+
+  code = tsdbReadFile(pReader->aSttFD[iStt], pSttFile->bfOffset, pReader->aBuf[0], sizeof(int64_t));
+  if (code) return code;
+
+  tGetI64(pReader->aBuf[0], szFileBF);
+  return code;
+}
+
+int32_t tsdbReadSttBF(SDataFReader *pReader, int32_t iStt, SBloomFilter **ppBF) {
+  int32_t   code = 0;
+  int32_t   lino = 0;
+  SSttFile *pSttFile = pReader->pSet->aSttF[iStt];
+  int64_t   szFileBF = 0;
+  SDecoder  decoder = {0};
+
+  *ppBF = NULL;
+  if (pSttFile->bfOffset == 0) return code;
+
+  code = tsdbReadSttBFSize(pReader, iStt, &szFileBF);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tRealloc(&pReader->aBuf[0], szFileBF);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbReadFile(pReader->aSttFD[iStt], pSttFile->bfOffset + sizeof(int64_t), pReader->aBuf[0], szFileBF);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tDecoderInit(&decoder, pReader->aBuf[0], szFileBF);
+  *ppBF = tBloomFilterDecode(&decoder);
+  if (*ppBF == NULL) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pReader->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  tDecoderClear(&decoder);
+  return code;
+}
+
+int32_t tsdbReadSttBlkBF(SDataFReader *pReader, int32_t iStt, SArray *aBlkBF) {
+  int32_t   code = 0;
+  int32_t   lino = 0;
+  SSttFile *pSttFile = pReader->pSet->aSttF[iStt];
+  int64_t   szFileBF = 0;
+  SDecoder  decoder = {0};
+
+  taosArrayClearP(aBlkBF, (FDelete)tBloomFilterDestroy);
+  if (pSttFile->bfOffset == 0) return code;
+
+  code = tsdbReadSttBFSize(pReader, iStt, &szFileBF);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  int64_t offset = pSttFile->bfOffset + sizeof(int64_t) + szFileBF;
+  int64_t size = pSttFile->size - offset;
+
+  code = tRealloc(&pReader->aBuf[0], size);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbReadFile(pReader->aSttFD[iStt], offset, pReader->aBuf[0], size);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tDecoderInit(&decoder, pReader->aBuf[0], size);
+  while (!tDecodeIsEnd(&decoder)) {
+    SBloomFilter *pBF = tBloomFilterDecode(&decoder);
+    if (pBF == NULL) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    if (taosArrayPush(aBlkBF, &pBF) == NULL) {
+      tBloomFilterDestroy(pBF);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pReader->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+    taosArrayClearP(aBlkBF, (FDelete)tBloomFilterDestroy);
+  }
+  tDecoderClear(&decoder);
+  return code;
+}
+
 int32_t tsdbReadDataBlk(SDataFReader *pReader, SBlockIdx *pBlockIdx, SMapData *mDataBlk) {
   int32_t code = 0;
   int64_t offset = pBlockIdx->offset;
@@ -1082,6 +1352,10 @@ static int32_t tsdbReadBlockDataImpl(SDataFReader *pReader, SBlockInfo *pBlkInfo
 
   ASSERT(hdr.delimiter == TSDB_FILE_DLMT);
   ASSERT(pBlockData->suid == hdr.suid);
+  if (hdr.fmtVer > TSDB_DATA_FMT_VER) {
+    code = TSDB_CODE_VERSION_NOT_COMPATIBLE;
+    goto _err;
+  }
 
   pBlockData->uid = hdr.uid;
   pBlockData->nRow = hdr.nRow;
@@ -1133,7 +1407,7 @@ static int32_t tsdbReadBlockDataImpl(SDataFReader *pReader, SBlockInfo *pBlkInfo
 
     while (pBlockCol && pBlockCol->cid < pColData->cid) {
       if (n < hdr.szBlkCol) {
-        n += tGetBlockCol(pReader->aBuf[0] + n, pBlockCol);
+        n += tGetBlockCol(pReader->aBuf[0] + n, pBlockCol, hdr.fmtVer, hdr.cmprAlg);
       } else {
         ASSERT(n == hdr.szBlkCol);
         pBlockCol = NULL;
@@ -1256,6 +1530,114 @@ _exit:
   return code;
 }
 
+// Prefetch ====================================================
+#define TSDB_MAX_PREFETCH_TASKS 4
+
+typedef struct {
+  STsdb  *pTsdb;
+  SArray *aBlkInfo;  // SArray<SBlockInfo>
+  char    path[TSDB_FILENAME_LEN];
+} STsdbPrefetchTask;
+
+static bool tsdbPrefetchTaskAcquire(STsdb *pTsdb) {
+  bool acquired = false;
+
+  taosThreadMutexLock(&pTsdb->prefetchMutex);
+  if (pTsdb->nPrefetch < TSDB_MAX_PREFETCH_TASKS) {
+    pTsdb->nPrefetch++;
+    acquired = true;
+  }
+  taosThreadMutexUnlock(&pTsdb->prefetchMutex);
+
+  return acquired;
+}
+
+// tsdbClose() waits for the last task to release
+static void tsdbPrefetchTaskRelease(STsdb *pTsdb) {
+  taosThreadMutexLock(&pTsdb->prefetchMutex);
+  if (--pTsdb->nPrefetch == 0) {
+    taosThreadCondSignal(&pTsdb->prefetchDone);
+  }
+  taosThreadMutexUnlock(&pTsdb->prefetchMutex);
+}
+
+static int32_t tsdbPrefetchTaskExec(void *arg) {
+  int32_t            code = 0;
+  STsdbPrefetchTask *pTask = (STsdbPrefetchTask *)arg;
+  STsdb             *pTsdb = pTask->pTsdb;
+  STsdbFD           *pFD = NULL;
+
+  // the file may have been removed since the task was scheduled, which is fine
+  code = tsdbOpenFile(pTask->path, pTsdb, TD_FILE_READ, &pFD);
+  if (code) goto _exit;
+
+  for (int32_t iBlk = 0; iBlk < taosArrayGetSize(pTask->aBlkInfo); iBlk++) {
+    SBlockInfo *pBlkInfo = (SBlockInfo *)taosArrayGet(pTask->aBlkInfo, iBlk);
+    int64_t     sPgno = OFFSET_PGNO(LOGIC_TO_FILE_OFFSET(pBlkInfo->offset, pFD->szPage), pFD->szPage);
+    int64_t     ePgno =
+        OFFSET_PGNO(LOGIC_TO_FILE_OFFSET(pBlkInfo->offset + pBlkInfo->szBlock - 1, pFD->szPage), pFD->szPage);
+
+    // only the pages tsdbReadFilePage() would cache are worth reading ahead
+    for (int64_t pgno = TMAX(sPgno, 2); pgno <= ePgno && pgno < pFD->szFile; pgno++) {
+      if (tsdbPgCacheContains(pTsdb, pTask->path, pgno)) continue;
+
+      code = tsdbReadFilePage(pFD, pgno);
+      if (code) goto _exit;
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbDebug("vgId:%d, prefetch blocks of %s stopped since %s", TD_VID(pTsdb->pVnode), pTask->path, tstrerror(code));
+  }
+  tsdbCloseFile(&pFD);
+  taosArrayDestroy(pTask->aBlkInfo);
+  taosMemoryFree(pTask);
+  tsdbPrefetchTaskRelease(pTsdb);
+  return code;
+}
+
+int32_t tsdbPrefetchDataBlocks(SDataFReader *pReader, SArray *aBlkInfo) {
+  int32_t            code = 0;
+  STsdb             *pTsdb = pReader->pTsdb;
+  STsdbPrefetchTask *pTask = NULL;
+
+  // pages are read ahead into the page cache, nothing to do without it
+  if (pTsdb->pgCache == NULL || taosArrayGetSize(aBlkInfo) == 0) return code;
+
+  if (!tsdbPrefetchTaskAcquire(pTsdb)) return code;
+
+  pTask = (STsdbPrefetchTask *)taosMemoryCalloc(1, sizeof(*pTask));
+  if (pTask == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  pTask->pTsdb = pTsdb;
+  tsdbDataFileName(pTsdb, pReader->pSet->diskId, pReader->pSet->fid, pReader->pSet->pDataF, pTask->path);
+  pTask->aBlkInfo = taosArrayDup(aBlkInfo, NULL);
+  if (pTask->aBlkInfo == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  if (vnodeSchedulePrefetchTask(tsdbPrefetchTaskExec, pTask) < 0) {
+    code = terrno;
+    goto _exit;
+  }
+
+  return code;
+
+_exit:
+  // prefetch is best effort, the blocks are read synchronously when needed
+  if (pTask) {
+    taosArrayDestroy(pTask->aBlkInfo);
+    taosMemoryFree(pTask);
+  }
+  tsdbPrefetchTaskRelease(pTsdb);
+  return code;
+}
+
 // SDelFWriter ====================================================
 int32_t tsdbDelFWriterOpen(SDelFWriter **ppWriter, SDelFile *pFile, STsdb *pTsdb) {
   int32_t      code = 0;
@@ -1275,7 +1657,7 @@ int32_t tsdbDelFWriterOpen(SDelFWriter **ppWriter, SDelFile *pFile, STsdb *pTsdb
   pDelFWriter->fDel = *pFile;
 
   tsdbDelFileName(pTsdb, pFile, fname);
-  code = tsdbOpenFile(fname, pTsdb->pVnode->config.tsdbPageSize, TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE,
+  code = tsdbOpenFile(fname, pTsdb, TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE,
                       &pDelFWriter->pWriteH);
   TSDB_CHECK_CODE(code, lino, _exit);
 
@@ -1450,7 +1832,7 @@ int32_t tsdbDelFReaderOpen(SDelFReader **ppReader, SDelFile *pFile, STsdb *pTsdb
   pDelFReader->fDel = *pFile;
 
   tsdbDelFileName(pTsdb, pFile, fname);
-  code = tsdbOpenFile(fname, pTsdb->pVnode->config.tsdbPageSize, TD_FILE_READ, &pDelFReader->pReadH);
+  code = tsdbOpenFile(fname, pTsdb, TD_FILE_READ, &pDelFReader->pReadH);
   if (code) {
     taosMemoryFree(pDelFReader);
     goto _exit;
@@ -39,74 +39,112 @@ static bool tsdbShouldDoRetention(STsdb *pTsdb, int64_t now) {
   return false;
 }
 
-int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
+static int32_t tsdbDoRetentionFileSet(STsdb *pTsdb, int32_t fid, int64_t now) {
   int32_t code = 0;
-
-  if (!tsdbShouldDoRetention(pTsdb, now)) {
-    return code;
-  }
-
-  // do retention
+  int32_t lino = 0;
   STsdbFS fs = {0};
 
+  // the file set is moved or dropped in between two commits, as the compaction swaps it
+  tsem_wait(&pTsdb->pVnode->canCommit);
+
   code = tsdbFSCopy(pTsdb, &fs);
-  if (code) goto _err;
+  TSDB_CHECK_CODE(code, lino, _exit);
 
-  for (int32_t iSet = 0; iSet < taosArrayGetSize(fs.aDFileSet); iSet++) {
-    SDFileSet *pSet = (SDFileSet *)taosArrayGet(fs.aDFileSet, iSet);
-    int32_t    expLevel = tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now);
-    SDiskID    did;
+  SDFileSet *pSet = (SDFileSet *)taosArraySearch(fs.aDFileSet, &(SDFileSet){.fid = fid}, tDFileSetCmprFn, TD_EQ);
+  if (pSet == NULL) goto _exit;
 
-    if (expLevel < 0) {
-      taosMemoryFree(pSet->pHeadF);
-      taosMemoryFree(pSet->pDataF);
-      taosMemoryFree(pSet->aSttF[0]);
-      taosMemoryFree(pSet->pSmaF);
-      taosArrayRemove(fs.aDFileSet, iSet);
-      iSet--;
-    } else {
-      if (expLevel == 0) continue;
-      if (tfsAllocDisk(pTsdb->pVnode->pTfs, expLevel, &did) < 0) {
-        code = terrno;
-        goto _exit;
-      }
+  int32_t expLevel = tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now);
+  SDiskID did;
 
-      if (did.level == pSet->diskId.level) continue;
+  if (expLevel < 0) {
+    int32_t idx = taosArraySearchIdx(fs.aDFileSet, pSet, tDFileSetCmprFn, TD_EQ);
+    taosMemoryFree(pSet->pHeadF);
+    taosMemoryFree(pSet->pDataF);
+    taosMemoryFree(pSet->pSmaF);
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      taosMemoryFree(pSet->aSttF[iStt]);
+    }
+    taosArrayRemove(fs.aDFileSet, idx);
+  } else {
+    if (expLevel == 0) goto _exit;
+    if (tfsAllocDisk(pTsdb->pVnode->pTfs, expLevel, &did) < 0) {
+      code = terrno;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
 
-      // copy file to new disk (todo)
-      SDFileSet fSet = *pSet;
-      fSet.diskId = did;
+    if (did.level == pSet->diskId.level) goto _exit;
 
-      code = tsdbDFileSetCopy(pTsdb, pSet, &fSet);
-      if (code) goto _err;
+    // copy file to new disk
+    SDFileSet fSet = *pSet;
+    fSet.diskId = did;
 
-      code = tsdbFSUpsertFSet(&fs, &fSet);
-      if (code) goto _err;
-    }
+    code = tsdbDFileSetCopy(pTsdb, pSet, &fSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbFSUpsertFSet(&fs, &fSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
 
   // do change fs
   code = tsdbFSPrepareCommit(pTsdb, &fs);
-  if (code) goto _err;
+  TSDB_CHECK_CODE(code, lino, _exit);
 
   taosThreadRwlockWrlock(&pTsdb->rwLock);
 
   code = tsdbFSCommit(pTsdb);
   if (code) {
     taosThreadRwlockUnlock(&pTsdb->rwLock);
-    goto _err;
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
 
   taosThreadRwlockUnlock(&pTsdb->rwLock);
 
-  tsdbFSDestroy(&fs);
-
 _exit:
+  tsem_post(&pTsdb->pVnode->canCommit);
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code),
+              fid);
+  }
+  tsdbFSDestroy(&fs);
   return code;
+}
+
+int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  SArray *aFid = NULL;
+
+  if (!tsdbShouldDoRetention(pTsdb, now)) {
+    return code;
+  }
+
+  aFid = taosArrayInit(0, sizeof(int32_t));
+  if (aFid == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
 
-_err:
-  tsdbError("vgId:%d, tsdb do retention failed since %s", TD_VID(pTsdb->pVnode), tstrerror(code));
-  ASSERT(0);
-  // tsdbFSRollback(pTsdb->pFS);
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet); iSet++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet);
+    if (taosArrayPush(aFid, &pSet->fid) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      break;
+    }
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // do retention
+  for (int32_t iFid = 0; iFid < taosArrayGetSize(aFid); iFid++) {
+    code = tsdbDoRetentionFileSet(pTsdb, *(int32_t *)taosArrayGet(aFid, iFid), now);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, tsdb do retention failed at line %d since %s", TD_VID(pTsdb->pVnode), lino, tstrerror(code));
+  }
+  taosArrayDestroy(aFid);
   return code;
-}
\ No newline at end of file
+}
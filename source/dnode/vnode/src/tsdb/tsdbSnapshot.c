@@ -288,8 +288,9 @@ static int32_t tsdbSnapCmprData(STsdbSnapReader* pReader, uint8_t** ppData) {
 
   ASSERT(pReader->bData.nRow);
 
+  // a replica may run a tsdb before the per column encodings, so send the oldest format
   int32_t aBufN[5] = {0};
-  code = tCmprBlockData(&pReader->bData, TWO_STAGE_COMP, NULL, NULL, pReader->aBuf, aBufN);
+  code = tCmprBlockData(&pReader->bData, TWO_STAGE_COMP, 0, NULL, NULL, pReader->aBuf, aBufN);
   if (code) goto _exit;
 
   int32_t size = aBufN[0] + aBufN[1] + aBufN[2] + aBufN[3];
@@ -375,7 +375,7 @@ int32_t tGetSttBlk(uint8_t *p, void *ph) {
 }
 
 // SBlockCol ======================================================
-int32_t tPutBlockCol(uint8_t *p, void *ph) {
+int32_t tPutBlockCol(uint8_t *p, void *ph, uint32_t fmtVer) {
   int32_t    n = 0;
   SBlockCol *pBlockCol = (SBlockCol *)ph;
 
@@ -398,6 +398,9 @@ int32_t tPutBlockCol(uint8_t *p, void *ph) {
 
     if (pBlockCol->flag != (HAS_NULL | HAS_NONE)) {
       n += tPutI32v(p ? p + n : p, pBlockCol->szValue);
+      if (fmtVer >= 1) {
+        n += tPutI8(p ? p + n : p, pBlockCol->cmprAlg);
+      }
     }
 
     n += tPutI32v(p ? p + n : p, pBlockCol->offset);
@@ -407,7 +410,7 @@ _exit:
   return n;
 }
 
-int32_t tGetBlockCol(uint8_t *p, void *ph) {
+int32_t tGetBlockCol(uint8_t *p, void *ph, uint32_t fmtVer, int8_t cmprAlg) {
   int32_t    n = 0;
   SBlockCol *pBlockCol = (SBlockCol *)ph;
 
@@ -423,6 +426,7 @@ int32_t tGetBlockCol(uint8_t *p, void *ph) {
   pBlockCol->szOffset = 0;
   pBlockCol->szValue = 0;
   pBlockCol->offset = 0;
+  pBlockCol->cmprAlg = cmprAlg;
 
   if (pBlockCol->flag != HAS_NULL) {
     if (pBlockCol->flag != HAS_VALUE) {
@@ -435,6 +439,9 @@ int32_t tGetBlockCol(uint8_t *p, void *ph) {
 
     if (pBlockCol->flag != (HAS_NULL | HAS_NONE)) {
       n += tGetI32v(p + n, &pBlockCol->szValue);
+      if (fmtVer >= 1) {
+        n += tGetI8(p + n, &pBlockCol->cmprAlg);
+      }
     }
 
     n += tGetI32v(p + n, &pBlockCol->offset);
@@ -1410,12 +1417,14 @@ void tBlockDataGetColData(SBlockData *pBlockData, int16_t cid, SColData **ppColD
   *ppColData = NULL;
 }
 
-int32_t tCmprBlockData(SBlockData *pBlockData, int8_t cmprAlg, uint8_t **ppOut, int32_t *szOut, uint8_t *aBuf[],
-                       int32_t aBufN[]) {
+// fmtVer 0 keeps the block readable by the tsdb before the per column encodings, for the snapshot sent to replicas
+int32_t tCmprBlockData(SBlockData *pBlockData, int8_t cmprAlg, uint32_t fmtVer, uint8_t **ppOut, int32_t *szOut,
+                       uint8_t *aBuf[], int32_t aBufN[]) {
   int32_t code = 0;
 
+  ASSERT(fmtVer <= TSDB_DATA_FMT_VER);
   SDiskDataHdr hdr = {.delimiter = TSDB_FILE_DLMT,
-                      .fmtVer = 0,
+                      .fmtVer = fmtVer,
                       .suid = pBlockData->suid,
                       .uid = pBlockData->uid,
                       .nRow = pBlockData->nRow,
@@ -1435,19 +1444,20 @@ int32_t tCmprBlockData(SBlockData *pBlockData, int8_t cmprAlg, uint8_t **ppOut,
                           .type = pColData->type,
                           .smaOn = pColData->smaOn,
                           .flag = pColData->flag,
+                          .cmprAlg = cmprAlg,
                           .szOrigin = pColData->nData};
 
     if (pColData->flag != HAS_NULL) {
-      code = tsdbCmprColData(pColData, cmprAlg, &blockCol, &aBuf[0], aBufN[0], &aBuf[2]);
+      code = tsdbCmprColData(pColData, cmprAlg, hdr.fmtVer, &blockCol, &aBuf[0], aBufN[0], &aBuf[2]);
       if (code) goto _exit;
 
       blockCol.offset = aBufN[0];
       aBufN[0] = aBufN[0] + blockCol.szBitmap + blockCol.szOffset + blockCol.szValue;
     }
 
-    code = tRealloc(&aBuf[1], hdr.szBlkCol + tPutBlockCol(NULL, &blockCol));
+    code = tRealloc(&aBuf[1], hdr.szBlkCol + tPutBlockCol(NULL, &blockCol, hdr.fmtVer));
     if (code) goto _exit;
-    hdr.szBlkCol += tPutBlockCol(aBuf[1] + hdr.szBlkCol, &blockCol);
+    hdr.szBlkCol += tPutBlockCol(aBuf[1] + hdr.szBlkCol, &blockCol, hdr.fmtVer);
   }
 
   // SBlockCol
@@ -1509,6 +1519,10 @@ int32_t tDecmprBlockData(uint8_t *pIn, int32_t szIn, SBlockData *pBlockData, uin
   // SDiskDataHdr
   n += tGetDiskDataHdr(pIn + n, &hdr);
   ASSERT(hdr.delimiter == TSDB_FILE_DLMT);
+  if (hdr.fmtVer > TSDB_DATA_FMT_VER) {
+    code = TSDB_CODE_VERSION_NOT_COMPATIBLE;
+    goto _exit;
+  }
 
   pBlockData->suid = hdr.suid;
   pBlockData->uid = hdr.uid;
@@ -1543,7 +1557,7 @@ int32_t tDecmprBlockData(uint8_t *pIn, int32_t szIn, SBlockData *pBlockData, uin
   int32_t nt = 0;
   while (nt < hdr.szBlkCol) {
     SBlockCol blockCol = {0};
-    nt += tGetBlockCol(pIn + n + nt, &blockCol);
+    nt += tGetBlockCol(pIn + n + nt, &blockCol, hdr.fmtVer, hdr.cmprAlg);
     ASSERT(nt <= hdr.szBlkCol);
 
     SColData *pColData;
@@ -1694,8 +1708,186 @@ _exit:
   return code;
 }
 
-int32_t tsdbCmprColData(SColData *pColData, int8_t cmprAlg, SBlockCol *pBlockCol, uint8_t **ppOut, int32_t nOut,
-                        uint8_t **ppBuf) {
+// Try the integer only encodings on a value chunk already encoded with *cmprAlg at *ppOut + nOut. A candidate replaces
+// it when it is smaller, or as small, since RLE and FOR both decode faster than simple8b (+ LZ4).
+int32_t tsdbCmprDataAdaptive(uint8_t *pIn, int32_t szIn, int8_t type, uint8_t **ppOut, int32_t nOut, int32_t *szOut,
+                             int8_t *cmprAlg, uint8_t **ppBuf) {
+  int32_t code = 0;
+
+  if (*cmprAlg == NO_COMPRESSION || !IS_INTEGER_TYPE(type)) goto _exit;
+
+  static const int8_t aCandidate[] = {RLE_COMP, FOR_BITPACK_COMP};
+
+  int8_t  dftAlg = *cmprAlg;
+  int32_t size = szIn + COMP_OVERFLOW_BYTES;
+  code = tRealloc(ppBuf, size);
+  if (code) goto _exit;
+
+  for (int32_t i = 0; i < sizeof(aCandidate) / sizeof(aCandidate[0]); i++) {
+    int32_t szCmpr =
+        tDataTypes[type].compFunc(pIn, szIn, szIn / tDataTypes[type].bytes, *ppBuf, size, aCandidate[i], NULL, 0);
+    if (szCmpr <= 0) continue;
+
+    if (szCmpr < *szOut || (szCmpr == *szOut && *cmprAlg == dftAlg)) {
+      memcpy(*ppOut + nOut, *ppBuf, szCmpr);
+      *szOut = szCmpr;
+      *cmprAlg = aCandidate[i];
+    }
+  }
+
+_exit:
+  return code;
+}
+
+// Block dictionary of var data ==============================================
+// the chunk is: nDict(u32v) | [len(u32v) | bytes] * nDict | FOR packed int16 code of each value
+#define TSDB_DICT_HASH_SIZE (TSDB_DICT_MAX_SIZE * 2)
+
+typedef struct {
+  int32_t offset;
+  int32_t len;
+} SDictEntry;
+
+// Try the dictionary encoding on the nVal var values of pIn, delimited by aOffset. As in tsdbCmprDataAdaptive, the
+// value chunk already encoded at *ppOut + nOut is replaced when the dictionary chunk is not larger.
+int32_t tsdbCmprDataDict(uint8_t *pIn, int32_t szIn, int32_t *aOffset, int32_t nVal, uint8_t **ppOut, int32_t nOut,
+                         int32_t *szOut, int8_t *cmprAlg, uint8_t **ppBuf) {
+  int32_t code = 0;
+
+  // a dictionary does not pay off if less than half of the values repeat
+  int32_t maxDict = TMIN(TSDB_DICT_MAX_SIZE, nVal / 2);
+  if (*cmprAlg == NO_COMPRESSION || maxDict <= 0 || szIn <= 0) goto _exit;
+
+  // scratch: hash slots | dictionary entries | codes
+  int32_t szHash = sizeof(int32_t) * TSDB_DICT_HASH_SIZE;
+  int32_t szDict = sizeof(SDictEntry) * maxDict;
+  code = tRealloc(ppBuf, szHash + szDict + sizeof(int16_t) * nVal);
+  if (code) goto _exit;
+
+  int32_t    *aSlot = (int32_t *)(*ppBuf);
+  SDictEntry *aDict = (SDictEntry *)(*ppBuf + szHash);
+  int16_t    *aCode = (int16_t *)(*ppBuf + szHash + szDict);
+  int32_t     nDict = 0;
+  int32_t     szDictData = 0;
+
+  memset(aSlot, 0xff, szHash);
+  for (int32_t iVal = 0; iVal < nVal; iVal++) {
+    int32_t offset = aOffset[iVal];
+    int32_t len = ((iVal < nVal - 1) ? aOffset[iVal + 1] : szIn) - offset;
+    if (offset < 0 || len < 0 || offset + len > szIn) goto _exit;
+
+    uint32_t iSlot = MurmurHash3_32((const char *)pIn + offset, len) & (TSDB_DICT_HASH_SIZE - 1);
+    for (;;) {
+      int32_t iDict = aSlot[iSlot];
+      if (iDict < 0) {
+        if (nDict >= maxDict) goto _exit;  // too many distinct values
+        aDict[nDict] = (SDictEntry){.offset = offset, .len = len};
+        aSlot[iSlot] = nDict;
+        aCode[iVal] = nDict++;
+        szDictData += len;
+        break;
+      }
+      if (aDict[iDict].len == len && memcmp(pIn + aDict[iDict].offset, pIn + offset, len) == 0) {
+        aCode[iVal] = iDict;
+        break;
+      }
+      iSlot = (iSlot + 1) & (TSDB_DICT_HASH_SIZE - 1);
+    }
+  }
+
+  // the candidate is encoded after the current chunk, and moved over it if it wins
+  int32_t nCand = nOut + *szOut;
+  int32_t szCodes = sizeof(int16_t) * nVal + COMP_OVERFLOW_BYTES;
+  int32_t size = tPutU32v(NULL, nDict) + nDict * tPutU32v(NULL, UINT32_MAX) + szDictData + szCodes;
+  if (szDictData + tPutU32v(NULL, nDict) >= *szOut) goto _exit;
+
+  code = tRealloc(ppOut, nCand + size);
+  if (code) goto _exit;
+
+  uint8_t *p = *ppOut + nCand;
+  int32_t  n = tPutU32v(p, nDict);
+  for (int32_t iDict = 0; iDict < nDict; iDict++) {
+    n += tPutU32v(p + n, aDict[iDict].len);
+    memcpy(p + n, pIn + aDict[iDict].offset, aDict[iDict].len);
+    n += aDict[iDict].len;
+  }
+
+  int32_t szCmpr = tsCompressSmallint(aCode, sizeof(int16_t) * nVal, nVal, p + n, size - n, FOR_BITPACK_COMP, NULL, 0);
+  if (szCmpr <= 0) goto _exit;
+  n += szCmpr;
+
+  if (n <= *szOut) {
+    memmove(*ppOut + nOut, p, n);
+    *szOut = n;
+    *cmprAlg = DICT_COMP;
+  }
+
+_exit:
+  return code;
+}
+
+// Decode a dictionary chunk into the nVal values of szOut bytes, and the code of each value into *paCode.
+int32_t tsdbDecmprDataDict(uint8_t *pIn, int32_t szIn, int32_t nVal, uint8_t **ppOut, int32_t szOut, int16_t **paCode,
+                           int32_t *nDict, uint8_t **ppBuf) {
+  int32_t code = 0;
+
+  *nDict = 0;
+
+  code = tRealloc(ppOut, szOut);
+  if (code) goto _exit;
+
+  uint32_t nEntry = 0;
+  int32_t  n = tGetU32v(pIn, &nEntry);
+  if (nEntry == 0 || nEntry > TSDB_DICT_MAX_SIZE) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    goto _exit;
+  }
+
+  code = tRealloc(ppBuf, sizeof(SDictEntry) * nEntry);
+  if (code) goto _exit;
+  code = tRealloc((uint8_t **)paCode, sizeof(int16_t) * nVal);
+  if (code) goto _exit;
+
+  SDictEntry *aDict = (SDictEntry *)(*ppBuf);
+  int16_t    *aCode = *paCode;
+  for (int32_t iDict = 0; iDict < nEntry; iDict++) {
+    uint32_t len;
+    n += tGetU32v(pIn + n, &len);
+    if (n + len > szIn) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      goto _exit;
+    }
+    aDict[iDict] = (SDictEntry){.offset = n, .len = len};
+    n += len;
+  }
+
+  if (tsDecompressSmallint(pIn + n, szIn - n, nVal, aCode, sizeof(int16_t) * nVal, FOR_BITPACK_COMP, NULL, 0) !=
+      sizeof(int16_t) * nVal) {
+    code = TSDB_CODE_COMPRESS_ERROR;
+    goto _exit;
+  }
+
+  int32_t size = 0;
+  for (int32_t iVal = 0; iVal < nVal; iVal++) {
+    if (aCode[iVal] < 0 || aCode[iVal] >= nEntry || size + aDict[aCode[iVal]].len > szOut) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      goto _exit;
+    }
+    memcpy(*ppOut + size, pIn + aDict[aCode[iVal]].offset, aDict[aCode[iVal]].len);
+    size += aDict[aCode[iVal]].len;
+  }
+  if (size != szOut) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    goto _exit;
+  }
+  *nDict = nEntry;
+
+_exit:
+  return code;
+}
+
+int32_t tsdbCmprColData(SColData *pColData, int8_t cmprAlg, uint32_t fmtVer, SBlockCol *pBlockCol, uint8_t **ppOut,
+                        int32_t nOut, uint8_t **ppBuf) {
   int32_t code = 0;
 
   ASSERT(pColData->flag && (pColData->flag != HAS_NONE) && (pColData->flag != HAS_NULL));
@@ -1729,10 +1921,21 @@ int32_t tsdbCmprColData(SColData *pColData, int8_t cmprAlg, SBlockCol *pBlockCol
   size += pBlockCol->szOffset;
 
   // value
+  pBlockCol->cmprAlg = cmprAlg;
   if ((pColData->flag != (HAS_NULL | HAS_NONE)) && pColData->nData) {
     code = tsdbCmprData((uint8_t *)pColData->pData, pColData->nData, pColData->type, cmprAlg, ppOut, nOut + size,
                         &pBlockCol->szValue, ppBuf);
     if (code) goto _exit;
+
+    // the algorithm of each column is recorded since fmtVer 1
+    if (fmtVer >= 1 && IS_VAR_DATA_TYPE(pColData->type)) {
+      code = tsdbCmprDataDict(pColData->pData, pColData->nData, pColData->aOffset, pColData->nVal, ppOut, nOut + size,
+                              &pBlockCol->szValue, &pBlockCol->cmprAlg, ppBuf);
+    } else if (fmtVer >= 1) {
+      code = tsdbCmprDataAdaptive((uint8_t *)pColData->pData, pColData->nData, pColData->type, ppOut, nOut + size,
+                                  &pBlockCol->szValue, &pBlockCol->cmprAlg, ppBuf);
+    }
+    if (code) goto _exit;
   }
   size += pBlockCol->szValue;
 
@@ -1750,6 +1953,7 @@ int32_t tsdbDecmprColData(uint8_t *pIn, SBlockCol *pBlockCol, int8_t cmprAlg, in
   pColData->flag = pBlockCol->flag;
   pColData->nVal = nVal;
   pColData->nData = pBlockCol->szOrigin;
+  pColData->nDict = 0;
 
   uint8_t *p = pIn;
   // bitmap
@@ -1776,7 +1980,13 @@ int32_t tsdbDecmprColData(uint8_t *pIn, SBlockCol *pBlockCol, int8_t cmprAlg, in
 
   // value
   if (pBlockCol->szValue) {
-    code = tsdbDecmprData(p, pBlockCol->szValue, pColData->type, cmprAlg, &pColData->pData, pColData->nData, ppBuf);
+    if (pBlockCol->cmprAlg == DICT_COMP) {
+      code = tsdbDecmprDataDict(p, pBlockCol->szValue, pColData->nVal, &pColData->pData, pColData->nData,
+                                &pColData->aDictCode, &pColData->nDict, ppBuf);
+    } else {
+      code = tsdbDecmprData(p, pBlockCol->szValue, pColData->type, pBlockCol->cmprAlg, &pColData->pData,
+                            pColData->nData, ppBuf);
+    }
     if (code) goto _exit;
   }
   p += pBlockCol->szValue;
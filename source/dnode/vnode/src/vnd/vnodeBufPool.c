@@ -27,7 +27,8 @@ static int vnodeBufPoolCreate(SVnode *pVnode, int64_t size, SVBufPool **ppPool)
     return -1;
   }
 
-  if (VND_IS_RSMA(pVnode)) {
+  // the pool is shared by the rsma threads, or by the insert threads of a submit request
+  if (VND_IS_RSMA(pVnode) || tsNumOfVnodeInsertThreads > 0) {
     pPool->lock = taosMemoryMalloc(sizeof(TdThreadSpinlock));
     if (!pPool->lock) {
       taosMemoryFree(pPool);
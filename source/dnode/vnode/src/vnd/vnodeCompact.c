@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "vnd.h"
+#include "vnodeInt.h"
+
+typedef struct {
+  SVnode    *pVnode;
+  int64_t    commitID;
+  SVnodeInfo info;
+} SCompactInfo;
+
+static int32_t vnodePrepareCompact(SVnode *pVnode, SCompactInfo *pInfo) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  char    dir[TSDB_FILENAME_LEN] = {0};
+
+  // the commit ID is taken and persisted between two commits, the file sets are swapped in one by one later
+  tsem_wait(&pVnode->canCommit);
+
+  // the current commit ID is taken by compaction, the coming commit uses the next one
+  pInfo->pVnode = pVnode;
+  pInfo->commitID = pVnode->state.commitID++;
+
+  pInfo->info.config = pVnode->config;
+  pInfo->info.state.committed = pVnode->state.committed;
+  pInfo->info.state.commitTerm = pVnode->state.commitTerm;
+  pInfo->info.state.commitID = pInfo->commitID;
+
+  // persist the commit ID so file names are never reused after restart
+  if (pVnode->pTfs) {
+    snprintf(dir, TSDB_FILENAME_LEN, "%s%s%s", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP, pVnode->path);
+  } else {
+    snprintf(dir, TSDB_FILENAME_LEN, "%s", pVnode->path);
+  }
+  if (vnodeSaveInfo(dir, &pInfo->info) < 0) {
+    code = terrno;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  if (vnodeCommitInfo(dir, &pInfo->info) < 0) {
+    code = terrno;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  tsem_post(&pVnode->canCommit);
+  if (code) {
+    vError("vgId:%d, %s failed at line %d since %s, commit id:%" PRId64, TD_VID(pVnode), __func__, lino,
+           tstrerror(code), pInfo->commitID);
+  } else {
+    vDebug("vgId:%d, %s done", TD_VID(pVnode), __func__);
+  }
+  return code;
+}
+
+static int32_t vnodeCompactTask(void *arg) {
+  int32_t       code = 0;
+  SCompactInfo *pInfo = (SCompactInfo *)arg;
+  SVnode       *pVnode = pInfo->pVnode;
+
+  code = tsdbCompact(pVnode->pTsdb, pInfo->commitID);
+  if (code) {
+    vError("vgId:%d, vnode compact failed since %s, commit id:%" PRId64, TD_VID(pVnode), tstrerror(code),
+           pInfo->commitID);
+  } else {
+    vInfo("vgId:%d, vnode compact done, commit id:%" PRId64, TD_VID(pVnode), pInfo->commitID);
+  }
+
+  atomic_store_32(&pVnode->compactNFSet, 0);
+  atomic_store_32(&pVnode->compactNDone, 0);
+  tsem_post(&pVnode->canCompact);
+  atomic_store_8(&pVnode->compacting, 0);
+  taosMemoryFree(pInfo);
+  return code;
+}
+
+int32_t vnodeAsyncCompact(SVnode *pVnode) {
+  int32_t code = 0;
+
+  // only one compaction runs at a time, a request coming during it is covered by the running one
+  if (atomic_val_compare_exchange_8(&pVnode->compacting, 0, 1) != 0) {
+    vInfo("vgId:%d, vnode is compacting, compact request ignored", TD_VID(pVnode));
+    return code;
+  }
+  tsem_wait(&pVnode->canCompact);
+
+  SCompactInfo *pInfo = (SCompactInfo *)taosMemoryCalloc(1, sizeof(*pInfo));
+  if (NULL == pInfo) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  // prepare to compact
+  code = vnodePrepareCompact(pVnode, pInfo);
+  if (TSDB_CODE_SUCCESS != code) {
+    goto _exit;
+  }
+
+  // schedule the task
+  vnodeScheduleTask(vnodeCompactTask, pInfo);
+
+_exit:
+  if (code) {
+    if (NULL != pInfo) {
+      taosMemoryFree(pInfo);
+    }
+    tsem_post(&pVnode->canCompact);
+    atomic_store_8(&pVnode->compacting, 0);
+    vError("vgId:%d, vnode async compact failed since %s", TD_VID(pVnode), tstrerror(code));
+  } else {
+    vInfo("vgId:%d, vnode async compact scheduled", TD_VID(pVnode));
+  }
+  return code;
+}
@@ -23,20 +23,93 @@ struct SVnodeTask {
   void* arg;
 };
 
+typedef struct SVnodeTaskQueue SVnodeTaskQueue;
+struct SVnodeTaskQueue {
+  const char*  name;
+  int          nthreads;
+  TdThread*    threads;
+  TdThreadCond hasTask;
+  SVnodeTask   queue;
+  int32_t      nTask;
+};
+
 struct SVnodeGlobal {
-  int8_t        init;
-  int8_t        stop;
-  int           nthreads;
-  TdThread*     threads;
-  TdThreadMutex mutex;
-  TdThreadCond  hasTask;
-  SVnodeTask    queue;
+  int8_t          init;
+  int8_t          stop;
+  TdThreadMutex   mutex;
+  SVnodeTaskQueue commitQ;
+  SVnodeTaskQueue prefetchQ;  // best-effort read-ahead of tsdb data blocks
+  SVnodeTaskQueue insertQ;    // memtable inserts of the tables of one submit request
 };
 
 struct SVnodeGlobal vnodeGlobal;
 
+#define VNODE_PREFETCH_QUEUE_LIMIT 1024
+
 static void* loop(void* arg);
 
+static int vnodeInitTaskQueue(SVnodeTaskQueue* pQueue, const char* name, int nthreads) {
+  pQueue->name = name;
+  pQueue->nTask = 0;
+  pQueue->queue.next = &pQueue->queue;
+  pQueue->queue.prev = &pQueue->queue;
+  taosThreadCondInit(&pQueue->hasTask, NULL);
+
+  pQueue->nthreads = nthreads;
+  pQueue->threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
+  if (pQueue->threads == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (int i = 0; i < nthreads; i++) {
+    taosThreadCreate(&(pQueue->threads[i]), NULL, loop, pQueue);
+  }
+
+  return 0;
+}
+
+static void vnodeCleanupTaskQueue(SVnodeTaskQueue* pQueue) {
+  for (int i = 0; i < pQueue->nthreads; i++) {
+    taosThreadJoin(pQueue->threads[i], NULL);
+  }
+
+  taosMemoryFreeClear(pQueue->threads);
+  taosThreadCondDestroy(&(pQueue->hasTask));
+}
+
+static int vnodeScheduleTaskImpl(SVnodeTaskQueue* pQueue, int (*execute)(void*), void* arg, int32_t limit) {
+  SVnodeTask* pTask;
+
+  ASSERT(!vnodeGlobal.stop);
+
+  pTask = taosMemoryMalloc(sizeof(*pTask));
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pTask->execute = execute;
+  pTask->arg = arg;
+
+  taosThreadMutexLock(&(vnodeGlobal.mutex));
+  if (limit > 0 && pQueue->nTask >= limit) {
+    taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+    taosMemoryFree(pTask);
+    terrno = TSDB_CODE_OUT_OF_RANGE;
+    return -1;
+  }
+  pTask->next = &pQueue->queue;
+  pTask->prev = pQueue->queue.prev;
+  pQueue->queue.prev->next = pTask;
+  pQueue->queue.prev = pTask;
+  pQueue->nTask++;
+  taosThreadCondSignal(&(pQueue->hasTask));
+  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+
+  return 0;
+}
+
 static tsem_t canCommit = {0};
 
 static void vnodeInitCommit() { tsem_init(&canCommit, 0, 4); };
@@ -53,26 +126,18 @@ int vnodeInit(int nthreads) {
   }
 
   taosThreadMutexInit(&vnodeGlobal.mutex, NULL);
-  taosThreadCondInit(&vnodeGlobal.hasTask, NULL);
-
-  taosThreadMutexLock(&vnodeGlobal.mutex);
-
   vnodeGlobal.stop = 0;
-  vnodeGlobal.queue.next = &vnodeGlobal.queue;
-  vnodeGlobal.queue.prev = &vnodeGlobal.queue;
-
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
 
-  vnodeGlobal.nthreads = nthreads;
-  vnodeGlobal.threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
-  if (vnodeGlobal.threads == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
+  if (vnodeInitTaskQueue(&vnodeGlobal.commitQ, "vnode-commit", nthreads) < 0 ||
+      vnodeInitTaskQueue(&vnodeGlobal.prefetchQ, "vnode-prefetch", nthreads) < 0) {
     vError("failed to init vnode module since:%s", tstrerror(terrno));
     return -1;
   }
 
-  for (int i = 0; i < nthreads; i++) {
-    taosThreadCreate(&(vnodeGlobal.threads[i]), NULL, loop, NULL);
+  if (tsNumOfVnodeInsertThreads > 0 &&
+      vnodeInitTaskQueue(&vnodeGlobal.insertQ, "vnode-insert", tsNumOfVnodeInsertThreads) < 0) {
+    vError("failed to init vnode module since:%s", tstrerror(terrno));
+    return -1;
   }
 
   if (walInit() < 0) {
@@ -94,17 +159,19 @@ void vnodeCleanup() {
   // set stop
   taosThreadMutexLock(&(vnodeGlobal.mutex));
   vnodeGlobal.stop = 1;
-  taosThreadCondBroadcast(&(vnodeGlobal.hasTask));
+  taosThreadCondBroadcast(&(vnodeGlobal.commitQ.hasTask));
+  taosThreadCondBroadcast(&(vnodeGlobal.prefetchQ.hasTask));
+  if (vnodeGlobal.insertQ.nthreads > 0) {
+    taosThreadCondBroadcast(&(vnodeGlobal.insertQ.hasTask));
+  }
   taosThreadMutexUnlock(&(vnodeGlobal.mutex));
 
-  // wait for threads
-  for (int i = 0; i < vnodeGlobal.nthreads; i++) {
-    taosThreadJoin(vnodeGlobal.threads[i], NULL);
+  // wait for threads and clear source
+  vnodeCleanupTaskQueue(&vnodeGlobal.commitQ);
+  vnodeCleanupTaskQueue(&vnodeGlobal.prefetchQ);
+  if (vnodeGlobal.insertQ.nthreads > 0) {
+    vnodeCleanupTaskQueue(&vnodeGlobal.insertQ);
   }
-
-  // clear source
-  taosMemoryFreeClear(vnodeGlobal.threads);
-  taosThreadCondDestroy(&(vnodeGlobal.hasTask));
   taosThreadMutexDestroy(&(vnodeGlobal.mutex));
 
   walCleanUp();
@@ -113,53 +180,47 @@ void vnodeCleanup() {
 }
 
 int vnodeScheduleTask(int (*execute)(void*), void* arg) {
-  SVnodeTask* pTask;
+  return vnodeScheduleTaskImpl(&vnodeGlobal.commitQ, execute, arg, 0);
+}
 
-  ASSERT(!vnodeGlobal.stop);
+int vnodeSchedulePrefetchTask(int (*execute)(void*), void* arg) {
+  return vnodeScheduleTaskImpl(&vnodeGlobal.prefetchQ, execute, arg, VNODE_PREFETCH_QUEUE_LIMIT);
+}
 
-  pTask = taosMemoryMalloc(sizeof(*pTask));
-  if (pTask == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
+int vnodeScheduleInsertTask(int (*execute)(void*), void* arg) {
+  if (vnodeGlobal.insertQ.nthreads <= 0) {
+    terrno = TSDB_CODE_APP_ERROR;
     return -1;
   }
 
-  pTask->execute = execute;
-  pTask->arg = arg;
-
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
-  pTask->next = &vnodeGlobal.queue;
-  pTask->prev = vnodeGlobal.queue.prev;
-  vnodeGlobal.queue.prev->next = pTask;
-  vnodeGlobal.queue.prev = pTask;
-  taosThreadCondSignal(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
-
-  return 0;
+  return vnodeScheduleTaskImpl(&vnodeGlobal.insertQ, execute, arg, 0);
 }
 
 /* ------------------------ STATIC METHODS ------------------------ */
 static void* loop(void* arg) {
-  SVnodeTask* pTask;
-  int         ret;
+  SVnodeTaskQueue* pQueue = (SVnodeTaskQueue*)arg;
+  SVnodeTask*      pTask;
+  int              ret;
 
-  setThreadName("vnode-commit");
+  setThreadName(pQueue->name);
 
   for (;;) {
     taosThreadMutexLock(&(vnodeGlobal.mutex));
     for (;;) {
-      pTask = vnodeGlobal.queue.next;
-      if (pTask == &vnodeGlobal.queue) {
+      pTask = pQueue->queue.next;
+      if (pTask == &pQueue->queue) {
         // no task
         if (vnodeGlobal.stop) {
           taosThreadMutexUnlock(&(vnodeGlobal.mutex));
           return NULL;
         } else {
-          taosThreadCondWait(&(vnodeGlobal.hasTask), &(vnodeGlobal.mutex));
+          taosThreadCondWait(&(pQueue->hasTask), &(vnodeGlobal.mutex));
         }
       } else {
         // has task
         pTask->prev->next = pTask->next;
         pTask->next->prev = pTask->prev;
+        pQueue->nTask--;
         break;
       }
     }
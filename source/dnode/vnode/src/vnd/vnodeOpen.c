@@ -156,6 +156,7 @@ SVnode *vnodeOpen(const char *path, STfs *pTfs, SMsgCb msgCb) {
 
   tsem_init(&pVnode->syncSem, 0, 0);
   tsem_init(&(pVnode->canCommit), 0, 1);
+  tsem_init(&(pVnode->canCompact), 0, 1);
   taosThreadMutexInit(&pVnode->mutex, NULL);
   taosThreadCondInit(&pVnode->poolNotEmpty, NULL);
 
@@ -240,6 +241,7 @@ _err:
   if (pVnode->pPool) vnodeCloseBufPool(pVnode);
 
   tsem_destroy(&(pVnode->canCommit));
+  tsem_destroy(&(pVnode->canCompact));
   taosMemoryFree(pVnode);
   return NULL;
 }
@@ -252,6 +254,9 @@ void vnodePreClose(SVnode *pVnode) {
 void vnodeClose(SVnode *pVnode) {
   if (pVnode) {
     vnodeSyncCommit(pVnode);
+    // wait for the running compaction
+    tsem_wait(&pVnode->canCompact);
+    tsem_post(&pVnode->canCompact);
     vnodeSyncClose(pVnode);
     vnodeQueryClose(pVnode);
     walClose(pVnode->pWal);
@@ -262,6 +267,7 @@ void vnodeClose(SVnode *pVnode) {
     vnodeCloseBufPool(pVnode);
     // destroy handle
     tsem_destroy(&(pVnode->canCommit));
+    tsem_destroy(&(pVnode->canCompact));
     tsem_destroy(&pVnode->syncSem);
     taosThreadCondDestroy(&pVnode->poolNotEmpty);
     taosThreadMutexDestroy(&pVnode->mutex);
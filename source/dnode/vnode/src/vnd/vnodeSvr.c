@@ -28,6 +28,7 @@ static int32_t vnodeProcessAlterHashRangeReq(SVnode *pVnode, int64_t version, vo
 static int32_t vnodeProcessAlterConfigReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp);
 static int32_t vnodeProcessDropTtlTbReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp);
 static int32_t vnodeProcessTrimReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp);
+static int32_t vnodeProcessCompactVnodeReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp);
 static int32_t vnodeProcessDeleteReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp);
 static int32_t vnodeProcessBatchDeleteReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp);
 
@@ -231,6 +232,9 @@ int32_t vnodeProcessWriteMsg(SVnode *pVnode, SRpcMsg *pMsg, int64_t version, SRp
     case TDMT_VND_TRIM:
       if (vnodeProcessTrimReq(pVnode, version, pReq, len, pRsp) < 0) goto _err;
       break;
+    case TDMT_VND_COMPACT:
+      if (vnodeProcessCompactVnodeReq(pVnode, version, pReq, len, pRsp) < 0) goto _err;
+      break;
     case TDMT_VND_CREATE_SMA:
       if (vnodeProcessCreateTSmaReq(pVnode, version, pReq, len, pRsp) < 0) goto _err;
       break;
@@ -423,6 +427,12 @@ int32_t vnodeProcessFetchMsg(SVnode *pVnode, SRpcMsg *pMsg, SQueueInfo *pInfo) {
       return tqProcessTaskRecoverFinishReq(pVnode->pTq, pMsg);
     case TDMT_STREAM_RECOVER_FINISH_RSP:
       return tqProcessTaskRecoverFinishRsp(pVnode->pTq, pMsg);
+    case TDMT_VND_STREAM_CHECK_POINT_SOURCE:
+      return tqProcessStreamCheckpointSourceReq(pVnode->pTq, pMsg);
+    case TDMT_STREAM_TASK_CHECKPOINT:
+      return tqProcessTaskCheckpointReq(pVnode->pTq, pMsg);
+    case TDMT_STREAM_TASK_CHECKPOINT_RSP:
+      return tqProcessTaskCheckpointRsp(pVnode->pTq, pMsg);
     default:
       vError("unknown msg type:%d in fetch queue", pMsg->msgType);
       return TSDB_CODE_APP_ERROR;
@@ -470,6 +480,26 @@ _exit:
   return code;
 }
 
+static int32_t vnodeProcessCompactVnodeReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp) {
+  int32_t          code = 0;
+  SCompactVnodeReq compactReq = {0};
+
+  // decode
+  if (tDeserializeSCompactVnodeReq(pReq, len, &compactReq) != 0) {
+    code = TSDB_CODE_INVALID_MSG;
+    goto _exit;
+  }
+
+  vInfo("vgId:%d, compact vnode request will be processed, db:%s", pVnode->config.vgId, compactReq.db);
+
+  // process
+  code = vnodeAsyncCompact(pVnode);
+  if (code) goto _exit;
+
+_exit:
+  return code;
+}
+
 static int32_t vnodeProcessDropTtlTbReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp) {
   SArray *tbUids = taosArrayInit(8, sizeof(int64_t));
   if (tbUids == NULL) return TSDB_CODE_OUT_OF_MEMORY;
@@ -832,7 +862,7 @@ static int32_t vnodeDebugPrintSingleSubmitMsg(SMeta *pMeta, SSubmitBlk *pBlock,
   tInitSubmitBlkIter(msgIter, pBlock, &blkIter);
   if (blkIter.row == NULL) return 0;
 
-  pSchema = metaGetTbTSchema(pMeta, msgIter->suid, TD_ROW_SVER(blkIter.row), 1);  // TODO: use the real schema
+  metaAcquireTbTSchema(pMeta, msgIter->suid, TD_ROW_SVER(blkIter.row), &pSchema);  // TODO: use the real schema
   if (pSchema) {
     suid = msgIter->suid;
     rv = TD_ROW_SVER(blkIter.row);
@@ -847,7 +877,7 @@ static int32_t vnodeDebugPrintSingleSubmitMsg(SMeta *pMeta, SSubmitBlk *pBlock,
     tdSRowPrint(row, pSchema, __tags);
   }
 
-  taosMemoryFreeClear(pSchema);
+  metaReleaseTbTSchema(pMeta, pSchema);
 
   return TSDB_CODE_SUCCESS;
 }
@@ -869,6 +899,134 @@ static int32_t vnodeDebugPrintSubmitMsg(SVnode *pVnode, SSubmitReq *pMsg, const
   return 0;
 }
 
+// Blocks of different tables of one submit request are inserted into the memtable by the vnode insert threads. The
+// blocks are sharded by uid, so all blocks of one table are inserted by the same thread in the request order.
+#define VNODE_INSERT_MIN_BLOCKS 16  // min number of blocks inserted by one insert thread
+
+typedef struct {
+  SSubmitMsgIter msgIter;  // iterator positioned at pBlock
+  SSubmitBlk    *pBlock;
+  SSubmitBlkRsp  blkRsp;
+} SVSubmitBlkItem;
+
+typedef struct {
+  SVnode          *pVnode;
+  int64_t          version;
+  SVSubmitBlkItem *aItem;
+  int32_t          nItem;
+  int32_t          iShard;
+  int32_t          nShard;
+  tsem_t          *pDone;
+} SVInsertShard;
+
+static int32_t vnodeInsertShard(void *arg) {
+  SVInsertShard *pShard = (SVInsertShard *)arg;
+
+  for (int32_t iItem = 0; iItem < pShard->nItem; iItem++) {
+    SVSubmitBlkItem *pItem = &pShard->aItem[iItem];
+    if (TABS(pItem->msgIter.uid) % pShard->nShard != pShard->iShard) continue;
+
+    if (tsdbInsertTableData(pShard->pVnode->pTsdb, pShard->version, &pItem->msgIter, pItem->pBlock, &pItem->blkRsp) <
+        0) {
+      pItem->blkRsp.code = terrno;
+    }
+  }
+
+  tsem_post(pShard->pDone);
+  return 0;
+}
+
+// Insert all blocks of the submit request in parallel, and set *pInserted. If any block needs to create the table,
+// nothing is inserted and the request is left to the serial path. Returns the error that kept the blocks from being
+// inserted, or the first error of the inserted blocks.
+static int32_t vnodeProcessSubmitBlocksInParallel(SVnode *pVnode, int64_t version, SSubmitReq *pSubmitReq,
+                                                  SSubmitRsp *pSubmitRsp, bool *pInserted) {
+  int32_t          code = 0;
+  int32_t          nItem = 0;
+  SSubmitMsgIter   msgIter = {0};
+  SVSubmitBlkItem *aItem = NULL;
+  SVInsertShard   *aShard = NULL;
+  tsem_t           done;
+
+  *pInserted = false;
+  if (tInitSubmitMsgIter(pSubmitReq, &msgIter) < 0) {
+    return TSDB_CODE_INVALID_MSG;
+  }
+
+  aItem = taosMemoryCalloc(msgIter.numOfBlocks, sizeof(SVSubmitBlkItem));
+  if (aItem == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (;;) {
+    SSubmitBlk *pBlock = NULL;
+    if (tGetSubmitMsgNext(&msgIter, &pBlock) < 0) {
+      taosMemoryFree(aItem);
+      return terrno;
+    }
+    if (pBlock == NULL) break;
+
+    if (msgIter.schemaLen > 0 || nItem >= msgIter.numOfBlocks) {
+      taosMemoryFree(aItem);
+      return 0;
+    }
+
+    aItem[nItem].msgIter = msgIter;
+    aItem[nItem].pBlock = pBlock;
+    nItem++;
+  }
+
+  int32_t nShard = TMIN(tsNumOfVnodeInsertThreads + 1, nItem / VNODE_INSERT_MIN_BLOCKS);
+  nShard = TMAX(nShard, 1);
+  aShard = taosMemoryCalloc(nShard, sizeof(SVInsertShard));
+  if (aShard == NULL) {
+    taosMemoryFree(aItem);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  tsem_init(&done, 0, 0);
+  for (int32_t iShard = 0; iShard < nShard; iShard++) {
+    aShard[iShard] = (SVInsertShard){.pVnode = pVnode,
+                                     .version = version,
+                                     .aItem = aItem,
+                                     .nItem = nItem,
+                                     .iShard = iShard,
+                                     .nShard = nShard,
+                                     .pDone = &done};
+  }
+
+  // the first shard is inserted by the write thread itself
+  for (int32_t iShard = 1; iShard < nShard; iShard++) {
+    if (vnodeScheduleInsertTask(vnodeInsertShard, &aShard[iShard]) < 0) {
+      vnodeInsertShard(&aShard[iShard]);
+    }
+  }
+  vnodeInsertShard(&aShard[0]);
+
+  for (int32_t iShard = 0; iShard < nShard; iShard++) {
+    tsem_wait(&done);
+  }
+  tsem_destroy(&done);
+  *pInserted = true;
+
+  for (int32_t iItem = 0; iItem < nItem; iItem++) {
+    SSubmitBlkRsp *pBlkRsp = &aItem[iItem].blkRsp;
+
+    pSubmitRsp->numOfRows += pBlkRsp->numOfRows;
+    pSubmitRsp->affectedRows += pBlkRsp->affectedRows;
+    if (pBlkRsp->code) {
+      if (code == 0) code = pBlkRsp->code;
+      taosArrayPush(pSubmitRsp->pArray, pBlkRsp);
+    }
+  }
+
+  vDebug("vgId:%d, %d blocks inserted by %d threads, index:%" PRId64, TD_VID(pVnode), nItem, nShard, version);
+
+  taosMemoryFree(aShard);
+  taosMemoryFree(aItem);
+  return code;
+}
+
 static int32_t vnodeProcessSubmitReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp) {
   SSubmitReq    *pSubmitReq = (SSubmitReq *)pReq;
   SSubmitRsp     submitRsp = {0};
@@ -882,6 +1040,7 @@ static int32_t vnodeProcessSubmitReq(SVnode *pVnode, int64_t version, void *pReq
   SArray        *newTbUids = NULL;
   SVStatis       statis = {0};
   bool           tbCreated = false;
+  bool           inserted = false;
   terrno = TSDB_CODE_SUCCESS;
 
   pRsp->code = 0;
@@ -910,7 +1069,19 @@ static int32_t vnodeProcessSubmitReq(SVnode *pVnode, int64_t version, void *pReq
     goto _exit;
   }
 
-  for (;;) {
+  if (tsNumOfVnodeInsertThreads > 0 && msgIter.numOfBlocks >= VNODE_INSERT_MIN_BLOCKS * 2) {
+    int32_t code = vnodeProcessSubmitBlocksInParallel(pVnode, version, pSubmitReq, &submitRsp, &inserted);
+    if (code && !inserted) {
+      pRsp->code = code;
+      goto _exit;
+    }
+    // like a block failed in the serial path, so the request is not sent to rsma
+    if (code) {
+      terrno = code;
+    }
+  }
+
+  while (!inserted) {
     tGetSubmitMsgNext(&msgIter, &pBlock);
     if (pBlock == NULL) break;
 
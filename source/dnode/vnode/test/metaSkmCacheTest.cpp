@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "meta.h"
+
+namespace {
+
+const char *kPath = TD_TMP_DIR_PATH "metaSkmCacheTest";
+
+SSchema schema(int8_t type, col_id_t colId, int32_t bytes, const char *name) {
+  SSchema s = {0};
+  s.type = type;
+  s.colId = colId;
+  s.bytes = bytes;
+  tstrncpy(s.name, name, TSDB_COL_NAME_LEN);
+  return s;
+}
+
+class MetaSkmCacheTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { indexInit(1); }
+  static void TearDownTestSuite() { indexCleanup(); }
+
+  void SetUp() override {
+    cacheSize = tsMetaSkmCacheSize;
+    taosRemoveDir(kPath);
+    taosMkDir(kPath);
+
+    memset(&vnode, 0, sizeof(vnode));
+    vnode.path = (char *)kPath;
+    vnode.config.vgId = 2;
+    vnode.config.szPage = 4096;
+    vnode.config.szCache = 256;
+    ASSERT_EQ(metaOpen(&vnode, &pMeta, 0), 0);
+    ASSERT_EQ(metaBegin(pMeta, META_BEGIN_HEAP_OS), 0);
+  }
+
+  void TearDown() override {
+    metaAbort(pMeta);
+    metaClose(pMeta);
+    taosRemoveDir(kPath);
+    tsMetaSkmCacheSize = cacheSize;
+  }
+
+  // a normal table of ts and nCols - 1 int columns
+  void createNtb(int64_t uid, int32_t nCols) {
+    std::string          name = "ntb" + std::to_string(uid);
+    std::vector<SSchema> aRow;
+    aRow.push_back(schema(TSDB_DATA_TYPE_TIMESTAMP, 1, 8, "ts"));
+    for (int32_t iCol = 1; iCol < nCols; iCol++) {
+      aRow.push_back(schema(TSDB_DATA_TYPE_INT, iCol + 1, 4, ("c" + std::to_string(iCol)).c_str()));
+    }
+
+    SVCreateTbReq req = {0};
+    req.name = (char *)name.c_str();
+    req.uid = uid;
+    req.type = TSDB_NORMAL_TABLE;
+    req.ntb.schemaRow = {nCols, 1, aRow.data()};
+    ASSERT_EQ(metaCreateTable(pMeta, ++version, &req, NULL), 0);
+  }
+
+  void addColumn(int64_t uid, const char *colName) {
+    std::string  name = "ntb" + std::to_string(uid);
+    SVAlterTbReq req = {0};
+    req.tbName = (char *)name.c_str();
+    req.action = TSDB_ALTER_TABLE_ADD_COLUMN;
+    req.colName = (char *)colName;
+    req.type = TSDB_DATA_TYPE_BIGINT;
+    req.bytes = 8;
+    STableMetaRsp rsp = {0};
+    ASSERT_EQ(metaAlterTable(pMeta, ++version, &req, &rsp), 0);
+    taosMemoryFree(rsp.pSchemas);
+  }
+
+  void dropNtb(int64_t uid) {
+    std::string name = "ntb" + std::to_string(uid);
+    SVDropTbReq req = {0};
+    req.name = (char *)name.c_str();
+    ASSERT_EQ(metaDropTable(pMeta, ++version, &req, NULL, NULL), 0);
+  }
+
+  static void checkSchema(const STSchema *pTSchema, int32_t sver, int32_t nCols) {
+    ASSERT_NE(pTSchema, nullptr);
+    ASSERT_EQ(pTSchema->version, sver);
+    ASSERT_EQ(pTSchema->numOfCols, nCols);
+    for (int32_t iCol = 0; iCol < nCols; iCol++) {
+      ASSERT_EQ(pTSchema->columns[iCol].colId, iCol + 1);
+    }
+  }
+
+  SVnode  vnode;
+  SMeta  *pMeta = NULL;
+  int64_t version = 0;
+  int32_t cacheSize = 0;
+};
+
+}  // namespace
+
+TEST_F(MetaSkmCacheTest, acquireRelease) {
+  createNtb(1, 3);
+
+  STSchema *pA = NULL;
+  STSchema *pB = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pA), 0);
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, -1, &pB), 0);
+  ASSERT_EQ(pA, pB);
+  checkSchema(pA, 1, 3);
+
+  // the private copy is not the shared one
+  STSchema *pCopy = metaGetTbTSchema(pMeta, 1, 1, 1);
+  ASSERT_NE(pCopy, pA);
+  checkSchema(pCopy, 1, 3);
+  taosMemoryFree(pCopy);
+
+  metaReleaseTbTSchema(pMeta, pA);
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pA), 0);
+  ASSERT_EQ(pA, pB);
+  metaReleaseTbTSchema(pMeta, pA);
+  metaReleaseTbTSchema(pMeta, pB);
+
+  metaReleaseTbTSchema(pMeta, NULL);
+  ASSERT_NE(metaAcquireTbTSchema(pMeta, 2, 1, &pA), 0);
+  ASSERT_EQ(pA, nullptr);
+}
+
+TEST_F(MetaSkmCacheTest, alterWhileHeld) {
+  createNtb(1, 3);
+
+  STSchema *pOld = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, -1, &pOld), 0);
+  checkSchema(pOld, 1, 3);
+
+  addColumn(1, "c3");
+
+  // the held schema outlives its cache entry
+  checkSchema(pOld, 1, 3);
+
+  STSchema *pNew = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, -1, &pNew), 0);
+  checkSchema(pNew, 2, 4);
+
+  STSchema *pReloaded = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pReloaded), 0);
+  ASSERT_NE(pReloaded, pOld);
+  checkSchema(pReloaded, 1, 3);
+
+  metaReleaseTbTSchema(pMeta, pReloaded);
+  metaReleaseTbTSchema(pMeta, pNew);
+  metaReleaseTbTSchema(pMeta, pOld);
+}
+
+TEST_F(MetaSkmCacheTest, dropWhileHeld) {
+  createNtb(1, 3);
+  addColumn(1, "c3");
+
+  STSchema *pHeld = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, -1, &pHeld), 0);
+
+  dropNtb(1);
+  checkSchema(pHeld, 2, 4);
+
+  STSchema *pTSchema = NULL;
+  ASSERT_NE(metaAcquireTbTSchema(pMeta, 1, -1, &pTSchema), 0);
+  ASSERT_EQ(pTSchema, nullptr);
+
+  // a reader of the rows written before the drop still finds their schema, the latest one by the schema db
+  ASSERT_EQ(metaAcquireTbTSchemaEx(pMeta, 0, 1, 1, &pTSchema), 0);
+  checkSchema(pTSchema, 1, 3);
+  metaReleaseTbTSchema(pMeta, pTSchema);
+
+  ASSERT_EQ(metaAcquireTbTSchemaEx(pMeta, 0, 1, -1, &pTSchema), 0);
+  checkSchema(pTSchema, 2, 4);
+  metaReleaseTbTSchema(pMeta, pTSchema);
+
+  metaReleaseTbTSchema(pMeta, pHeld);
+}
+
+TEST_F(MetaSkmCacheTest, evictWhileHeld) {
+  tsMetaSkmCacheSize = 0;
+  createNtb(1, 3);
+
+  // nothing stays cached, each acquirer gets a schema of its own
+  STSchema *pA = NULL;
+  STSchema *pB = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pA), 0);
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pB), 0);
+  ASSERT_NE(pA, pB);
+  checkSchema(pA, 1, 3);
+  checkSchema(pB, 1, 3);
+
+  metaReleaseTbTSchema(pMeta, pA);
+  checkSchema(pB, 1, 3);
+  metaReleaseTbTSchema(pMeta, pB);
+}
+
+TEST_F(MetaSkmCacheTest, evictUnderBudget) {
+  const int32_t nTable = 200;
+  const int32_t nCols = 1000;
+
+  tsMetaSkmCacheSize = 1;
+  for (int64_t uid = 1; uid <= nTable; uid++) {
+    createNtb(uid, nCols);
+  }
+
+  // about 3 MB of schemas through a 1 MB cache, the first one held all along
+  STSchema *pHeld = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pHeld), 0);
+  for (int32_t round = 0; round < 2; round++) {
+    for (int64_t uid = 1; uid <= nTable; uid++) {
+      STSchema *pTSchema = NULL;
+      ASSERT_EQ(metaAcquireTbTSchema(pMeta, uid, 1, &pTSchema), 0);
+      checkSchema(pTSchema, 1, nCols);
+      metaReleaseTbTSchema(pMeta, pTSchema);
+    }
+  }
+  checkSchema(pHeld, 1, nCols);
+
+  STSchema *pTSchema = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, 1, 1, &pTSchema), 0);
+  checkSchema(pTSchema, 1, nCols);
+  metaReleaseTbTSchema(pMeta, pTSchema);
+  metaReleaseTbTSchema(pMeta, pHeld);
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "meta.h"
+
+namespace {
+
+const char   *kPath = TD_TMP_DIR_PATH "metaTagTableTest";
+const int64_t kSuid = 1000000;
+
+// the tags of a child table as a query sees them, "" for a NULL t2
+struct STagRow {
+  std::string name;
+  bool        t1Null;
+  int32_t     t1;
+  std::string t2;
+  bool operator==(const STagRow &o) const {
+    return name == o.name && t1Null == o.t1Null && (t1Null || t1 == o.t1) && t2 == o.t2;
+  }
+};
+
+SSchema schema(int8_t type, col_id_t colId, int32_t bytes, const char *name) {
+  SSchema s = {0};
+  s.type = type;
+  s.colId = colId;
+  s.bytes = bytes;
+  tstrncpy(s.name, name, TSDB_COL_NAME_LEN);
+  return s;
+}
+
+SColumnInfoData colInfo(int8_t type, int16_t colId, int32_t bytes) {
+  SColumnInfoData col = {0};
+  col.info.type = type;
+  col.info.colId = colId;
+  col.info.bytes = bytes;
+  return col;
+}
+
+class MetaTagTableTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { indexInit(1); }
+  static void TearDownTestSuite() { indexCleanup(); }
+
+  void SetUp() override {
+    cacheSize = tsMetaTagTableCacheSize;
+    taosRemoveDir(kPath);
+    taosMkDir(kPath);
+
+    memset(&vnode, 0, sizeof(vnode));
+    vnode.path = (char *)kPath;
+    vnode.config.vgId = 2;
+    vnode.config.szPage = 4096;
+    vnode.config.szCache = 256;
+    ASSERT_EQ(metaOpen(&vnode, &pMeta, 0), 0);
+    ASSERT_EQ(metaBegin(pMeta, META_BEGIN_HEAP_OS), 0);
+
+    aTagSchema.push_back(schema(TSDB_DATA_TYPE_INT, 3, sizeof(int32_t), "t1"));
+    aTagSchema.push_back(schema(TSDB_DATA_TYPE_BINARY, 4, 1024 + VARSTR_HEADER_SIZE, "t2"));
+    createStb(1);
+  }
+
+  void TearDown() override {
+    metaAbort(pMeta);
+    metaClose(pMeta);
+    taosRemoveDir(kPath);
+    tsMetaTagTableCacheSize = cacheSize;
+  }
+
+  void createStb(int32_t tagVer) {
+    SSchema        aRow[] = {schema(TSDB_DATA_TYPE_TIMESTAMP, 1, 8, "ts"), schema(TSDB_DATA_TYPE_INT, 2, 4, "c1")};
+    SVCreateStbReq req = {0};
+    req.name = (char *)"stb";
+    req.suid = kSuid;
+    req.schemaRow = {2, 1, aRow};
+    req.schemaTag = {(int32_t)aTagSchema.size(), tagVer, aTagSchema.data()};
+    if (tagVer == 1) {
+      ASSERT_EQ(metaCreateSTable(pMeta, ++version, &req), 0);
+    } else {
+      ASSERT_EQ(metaAlterSTable(pMeta, ++version, &req), 0);
+    }
+  }
+
+  void createCtb(int64_t uid, const STagRow &row) {
+    SArray *aTagVal = taosArrayInit(2, sizeof(STagVal));
+    STagVal val = {0};
+    val.cid = 3;
+    val.type = TSDB_DATA_TYPE_INT;
+    val.i64 = row.t1;
+    if (!row.t1Null) taosArrayPush(aTagVal, &val);
+    val.cid = 4;
+    val.type = TSDB_DATA_TYPE_BINARY;
+    val.pData = (uint8_t *)row.t2.data();
+    val.nData = row.t2.size();
+    if (!row.t2.empty()) taosArrayPush(aTagVal, &val);
+
+    STag *pTag = NULL;
+    ASSERT_EQ(tTagNew(aTagVal, 1, false, &pTag), 0);
+    taosArrayDestroy(aTagVal);
+
+    SVCreateTbReq req = {0};
+    req.name = (char *)row.name.c_str();
+    req.uid = uid;
+    req.type = TSDB_CHILD_TABLE;
+    req.ctb.stbName = (char *)"stb";
+    req.ctb.suid = kSuid;
+    req.ctb.pTag = (uint8_t *)pTag;
+    ASSERT_EQ(metaCreateTable(pMeta, ++version, &req, NULL), 0);
+    tTagFree(pTag);
+    expect[uid] = row;
+  }
+
+  void updateT1(int64_t uid, int32_t t1) {
+    SVAlterTbReq req = {0};
+    req.tbName = (char *)expect[uid].name.c_str();
+    req.action = TSDB_ALTER_TABLE_UPDATE_TAG_VAL;
+    req.tagName = (char *)"t1";
+    req.tagType = TSDB_DATA_TYPE_INT;
+    req.nTagVal = sizeof(t1);
+    req.pTagVal = (uint8_t *)&t1;
+    ASSERT_EQ(metaAlterTable(pMeta, ++version, &req, NULL), 0);
+    expect[uid].t1Null = false;
+    expect[uid].t1 = t1;
+  }
+
+  void dropCtb(int64_t uid) {
+    SVDropTbReq req = {0};
+    req.name = (char *)expect[uid].name.c_str();
+    req.suid = kSuid;
+    ASSERT_EQ(metaDropTable(pMeta, ++version, &req, NULL, NULL), 0);
+    expect.erase(uid);
+  }
+
+  // fill tbname, t1 and t2 of all the child tables from the tag table, in the row order of the tag table
+  int32_t tagBlock(std::vector<int64_t> &aUid, std::map<int64_t, STagRow> &rows, bool t3 = false) {
+    SSDataBlock    *pBlock = createDataBlock();
+    SColumnInfoData col = colInfo(TSDB_DATA_TYPE_VARCHAR, -1, TSDB_TABLE_NAME_LEN + VARSTR_HEADER_SIZE);
+    blockDataAppendColInfo(pBlock, &col);
+    col = colInfo(TSDB_DATA_TYPE_INT, 3, sizeof(int32_t));
+    blockDataAppendColInfo(pBlock, &col);
+    col = colInfo(TSDB_DATA_TYPE_BINARY, 4, 1024 + VARSTR_HEADER_SIZE);
+    blockDataAppendColInfo(pBlock, &col);
+    if (t3) {
+      col = colInfo(TSDB_DATA_TYPE_BIGINT, 5, sizeof(int64_t));
+      blockDataAppendColInfo(pBlock, &col);
+    }
+
+    SArray *uidList = taosArrayInit(8, sizeof(int64_t));
+    int32_t code = metaGetTableTagBlock(pMeta, kSuid, uidList, pBlock);
+    aUid.clear();
+    rows.clear();
+    for (int32_t i = 0; code == 0 && i < pBlock->info.rows; i++) {
+      int64_t          uid = *(int64_t *)taosArrayGet(uidList, i);
+      SColumnInfoData *pName = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+      SColumnInfoData *pT1 = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+      SColumnInfoData *pT2 = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 2);
+
+      STagRow row = {};
+      char   *p = colDataGetData(pName, i);
+      row.name.assign(varDataVal(p), varDataLen(p));
+      row.t1Null = colDataIsNull_s(pT1, i);
+      if (!row.t1Null) row.t1 = *(int32_t *)colDataGetData(pT1, i);
+      if (!colDataIsNull_s(pT2, i)) {
+        p = colDataGetData(pT2, i);
+        row.t2.assign(varDataVal(p), varDataLen(p));
+      }
+      if (t3) {
+        EXPECT_TRUE(colDataIsNull_s((SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 3), i));
+      }
+
+      aUid.push_back(uid);
+      rows[uid] = row;
+    }
+
+    taosArrayDestroy(uidList);
+    blockDataDestroy(pBlock);
+    return code;
+  }
+
+  // decode the tags of each child table, as the query does without the tag table
+  void tableTags(std::map<int64_t, STagRow> &rows) {
+    SArray   *uidList = taosArrayInit(8, sizeof(int64_t));
+    SHashObj *tags = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
+    ASSERT_EQ(metaGetTableTags(pMeta, kSuid, uidList, tags), 0);
+
+    rows.clear();
+    for (int32_t i = 0; i < taosArrayGetSize(uidList); i++) {
+      int64_t uid = *(int64_t *)taosArrayGet(uidList, i);
+      void   *pTag = taosHashGet(tags, &uid, sizeof(uid));
+      char    name[TSDB_TABLE_NAME_LEN + VARSTR_HEADER_SIZE] = {0};
+      ASSERT_NE(pTag, nullptr);
+      ASSERT_EQ(metaGetTableNameByUid(pMeta, uid, name), 0);
+
+      STagRow row = {};
+      row.name.assign(varDataVal(name), varDataLen(name));
+      STagVal val = {0};
+      val.cid = 3;
+      row.t1Null = (metaGetTableTagVal(pTag, TSDB_DATA_TYPE_INT, &val) == NULL);
+      if (!row.t1Null) row.t1 = *(int32_t *)&val.i64;
+      val.cid = 4;
+      if (metaGetTableTagVal(pTag, TSDB_DATA_TYPE_BINARY, &val) != NULL) {
+        row.t2.assign((const char *)val.pData, val.nData);
+      }
+      rows[uid] = row;
+    }
+
+    taosHashCleanup(tags);
+    taosArrayDestroy(uidList);
+  }
+
+  // the tag table agrees with the tags decoded table by table, and with what was written
+  void checkTags() {
+    std::vector<int64_t>        aUid;
+    std::map<int64_t, STagRow> rows;
+    std::map<int64_t, STagRow> perTable;
+    ASSERT_EQ(tagBlock(aUid, rows), 0);
+    tableTags(perTable);
+    ASSERT_EQ(aUid.size(), expect.size());
+    ASSERT_EQ(rows, perTable);
+    ASSERT_EQ(rows, expect);
+  }
+
+  SVnode                     vnode;
+  SMeta                     *pMeta = NULL;
+  int64_t                    version = 0;
+  int32_t                    cacheSize = 0;
+  std::vector<SSchema>       aTagSchema;
+  std::map<int64_t, STagRow> expect;
+};
+
+STagRow tagRow(int64_t uid) {
+  STagRow row;
+  row.name = "ctb" + std::to_string(uid);
+  row.t1Null = (uid % 7 == 0);
+  row.t1 = uid * 10;
+  row.t2 = (uid % 5 == 0) ? "" : "v" + std::to_string(uid % 3);
+  return row;
+}
+
+}  // namespace
+
+TEST_F(MetaTagTableTest, create) {
+  for (int64_t uid = 1; uid <= 100; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+  checkTags();
+
+  // appended to the cached table
+  for (int64_t uid = 101; uid <= 120; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+  checkTags();
+}
+
+TEST_F(MetaTagTableTest, tagUpdate) {
+  for (int64_t uid = 1; uid <= 100; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+  checkTags();
+
+  updateT1(7, 7007);   // from NULL
+  updateT1(50, 5050);  // in place
+  checkTags();
+}
+
+TEST_F(MetaTagTableTest, dropSwapWithLast) {
+  for (int64_t uid = 1; uid <= 5; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+
+  std::vector<int64_t>        aUid;
+  std::map<int64_t, STagRow> rows;
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 2, 3, 4, 5}));
+
+  // the last row moves into the place of the dropped one
+  dropCtb(2);
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 5, 3, 4}));
+  ASSERT_EQ(rows, expect);
+
+  // the last row itself
+  dropCtb(4);
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 5, 3}));
+  ASSERT_EQ(rows, expect);
+
+  // the moved row is found in its new place
+  dropCtb(5);
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 3}));
+  ASSERT_EQ(rows, expect);
+}
+
+TEST_F(MetaTagTableTest, rebuildThreshold) {
+  for (int64_t uid = 1; uid <= 5; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+
+  std::vector<int64_t>        aUid;
+  std::map<int64_t, STagRow> rows;
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  dropCtb(2);
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 5, 3, 4}));
+
+  // up to META_TAG_TABLE_MIN_ROWS rows deleted or rewritten in place are still served from the table
+  for (int32_t i = 1; i < 1024; i++) {
+    updateT1(3, i);
+  }
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 5, 3, 4}));
+  ASSERT_EQ(rows, expect);
+
+  // one more and the table is dropped, to be rebuilt in the order of ctb.idx
+  updateT1(3, 1024);
+  ASSERT_EQ(tagBlock(aUid, rows), 0);
+  ASSERT_EQ(aUid, std::vector<int64_t>({1, 3, 4, 5}));
+  ASSERT_EQ(rows, expect);
+}
+
+TEST_F(MetaTagTableTest, alterStable) {
+  for (int64_t uid = 1; uid <= 10; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+  checkTags();
+
+  std::vector<int64_t>        aUid;
+  std::map<int64_t, STagRow> rows;
+  ASSERT_NE(tagBlock(aUid, rows, true), 0);
+
+  // the table built with the old tag schema is dropped by the alter
+  aTagSchema.push_back(schema(TSDB_DATA_TYPE_BIGINT, 5, sizeof(int64_t), "t3"));
+  createStb(2);
+  ASSERT_EQ(tagBlock(aUid, rows, true), 0);
+  ASSERT_EQ(rows, expect);
+}
+
+TEST_F(MetaTagTableTest, abort) {
+  for (int64_t uid = 1; uid <= 10; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+  ASSERT_EQ(metaCommit(pMeta, pMeta->txn), 0);
+  ASSERT_EQ(metaFinishCommit(pMeta, pMeta->txn), 0);
+  ASSERT_EQ(metaBegin(pMeta, META_BEGIN_HEAP_OS), 0);
+  checkTags();
+
+  // the tables created in the rolled back txn are gone from the tag table too
+  std::map<int64_t, STagRow> committed = expect;
+  for (int64_t uid = 11; uid <= 20; uid++) {
+    createCtb(uid, tagRow(uid));
+  }
+  checkTags();
+
+  ASSERT_EQ(metaAbort(pMeta), 0);
+  ASSERT_EQ(metaBegin(pMeta, META_BEGIN_HEAP_OS), 0);
+  expect = committed;
+  checkTags();
+}
+
+TEST_F(MetaTagTableTest, budget) {
+  std::string t2(1000, 'x');
+  for (int64_t uid = 1; uid <= 200; uid++) {
+    STagRow row = tagRow(uid);
+    row.t2 = t2 + std::to_string(uid);
+    createCtb(uid, row);
+  }
+
+  // disabled, the caller decodes the tags of each table
+  std::vector<int64_t>        aUid;
+  std::map<int64_t, STagRow> rows;
+  tsMetaTagTableCacheSize = 0;
+  ASSERT_NE(tagBlock(aUid, rows), 0);
+
+  // larger than the budget, the table is evicted as soon as built but still serves the query building it
+  tsMetaTagTableCacheSize = 1;
+  for (int64_t uid = 201; uid <= 1200; uid++) {
+    STagRow row = tagRow(uid);
+    row.t2 = t2 + std::to_string(uid);
+    createCtb(uid, row);
+  }
+  checkTags();
+  updateT1(100, 1);
+  dropCtb(1);
+  checkTags();
+
+  tsMetaTagTableCacheSize = 64;
+  checkTags();
+  updateT1(100, 2);
+  dropCtb(2);
+  checkTags();
+}
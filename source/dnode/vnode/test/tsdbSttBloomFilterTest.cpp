@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "tsdb.h"
+
+extern "C" int32_t tsdbWriteSttBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SArray *aSttBlk, int8_t cmprAlg);
+
+namespace {
+
+const char *kRoot = TD_TMP_DIR_PATH "tsdbSttBloomFilterTest";
+
+const int64_t kOtherSuid = 50;
+const int64_t kSuid = 100;
+
+// uids of each stt block written, the blocks of kSuid have overlapping uid ranges
+const int64_t kSuidOf[] = {kOtherSuid, kSuid, kSuid};
+const std::vector<int64_t> kUidsOf[] = {{5}, {1000, 1000000}, {2000, 2000000}};
+
+bool bfMayContain(const SBloomFilter *pBF, int64_t uid) {
+  return tBloomFilterNoContain(pBF, &uid, sizeof(uid)) != TSDB_CODE_SUCCESS;
+}
+
+}  // namespace
+
+class TsdbSttBloomFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SDiskCfg dCfg = {0};
+    tstrncpy(dCfg.dir, kRoot, TSDB_FILENAME_LEN);
+    dCfg.level = 0;
+    dCfg.primary = 1;
+
+    taosRemoveDir(kRoot);
+    taosMulMkDir(kRoot);
+
+    char path[TSDB_FILENAME_LEN];
+    snprintf(path, sizeof(path), "%s%stsdb", kRoot, TD_DIRSEP);
+    taosMulMkDir(path);
+
+    pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(SVnode));
+    ASSERT_NE(pVnode, nullptr);
+    pVnode->config.vgId = 2;
+    pVnode->config.tsdbPageSize = 4096;
+    pVnode->pTfs = tfsOpen(&dCfg, 1);
+    ASSERT_NE(pVnode->pTfs, nullptr);
+
+    pTsdb = (STsdb *)taosMemoryCalloc(1, sizeof(STsdb));
+    ASSERT_NE(pTsdb, nullptr);
+    pTsdb->path = (char *)"tsdb";
+    pTsdb->pVnode = pVnode;
+
+    SSchema schema = {0};
+    schema.type = TSDB_DATA_TYPE_TIMESTAMP;
+    schema.colId = PRIMARYKEY_TIMESTAMP_COL_ID;
+    schema.bytes = TSDB_KEYSIZE;
+    pTSchema = tBuildTSchema(&schema, 1, 1);
+    ASSERT_NE(pTSchema, nullptr);
+
+    fStt.commitID = 1;
+    fSet.fid = 1;
+    fSet.pHeadF = &fHead;
+    fSet.pDataF = &fData;
+    fSet.pSmaF = &fSma;
+    fSet.nSttF = 1;
+    fSet.aSttF[0] = &fStt;
+
+    writeSttFile();
+  }
+
+  void TearDown() override {
+    tBloomFilterDestroy(pBF);
+    taosArrayDestroyP(aBlkBF, (FDelete)tBloomFilterDestroy);
+    tsdbDataFReaderClose(&pReader);
+    tDestroyTSchema(pTSchema);
+    taosMemoryFree(pTsdb);
+    tfsClose(pVnode->pTfs);
+    taosMemoryFree(pVnode);
+    taosRemoveDir(kRoot);
+  }
+
+  // write the blocks of kUidsOf into one stt file, then reopen it for reading
+  void writeSttFile() {
+    SDataFWriter *pWriter = NULL;
+    SBlockData    bData = {0};
+    SArray       *aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+    SArray       *aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+
+    ASSERT_EQ(tsdbDataFWriterOpen(&pWriter, pTsdb, &fSet), 0);
+    ASSERT_EQ(tBlockDataCreate(&bData), 0);
+
+    int64_t version = 1;
+    for (int32_t iBlk = 0; iBlk < sizeof(kSuidOf) / sizeof(kSuidOf[0]); iBlk++) {
+      TABLEID id = {kSuidOf[iBlk], 0};
+      ASSERT_EQ(tBlockDataInit(&bData, &id, pTSchema, NULL, 0), 0);
+
+      int32_t nRow = kUidsOf[iBlk].size();
+      ASSERT_EQ(tRealloc((uint8_t **)&bData.aUid, sizeof(int64_t) * nRow), 0);
+      ASSERT_EQ(tRealloc((uint8_t **)&bData.aVersion, sizeof(int64_t) * nRow), 0);
+      ASSERT_EQ(tRealloc((uint8_t **)&bData.aTSKEY, sizeof(TSKEY) * nRow), 0);
+      for (int32_t iRow = 0; iRow < nRow; iRow++) {
+        bData.aUid[iRow] = kUidsOf[iBlk][iRow];
+        bData.aVersion[iRow] = version++;
+        bData.aTSKEY[iRow] = 1600000000000;
+      }
+      bData.nRow = nRow;
+
+      ASSERT_EQ(tsdbWriteSttBlock(pWriter, &bData, aSttBlk, NO_COMPRESSION), 0);
+    }
+
+    ASSERT_EQ(tsdbWriteBlockIdx(pWriter, aBlockIdx), 0);
+    ASSERT_EQ(tsdbWriteSttBlk(pWriter, aSttBlk), 0);
+    ASSERT_EQ(tsdbUpdateDFileSetHeader(pWriter), 0);
+
+    fHead = pWriter->fHead;
+    fData = pWriter->fData;
+    fSma = pWriter->fSma;
+    fStt = pWriter->fStt[0];
+    ASSERT_EQ(tsdbDataFWriterClose(&pWriter, 1), 0);
+
+    tBlockDataDestroy(&bData, 1);
+    taosArrayDestroy(aBlockIdx);
+    taosArrayDestroy(aSttBlk);
+
+    ASSERT_EQ(tsdbDataFReaderOpen(&pReader, pTsdb, &fSet), 0);
+
+    aBlkBF = taosArrayInit(0, POINTER_BYTES);
+    ASSERT_EQ(tsdbReadSttBF(pReader, 0, &pBF), 0);
+    ASSERT_EQ(tsdbReadSttBlkBF(pReader, 0, aBlkBF), 0);
+  }
+
+  SBloomFilter *blkBF(int32_t iBlk) { return *(SBloomFilter **)taosArrayGet(aBlkBF, iBlk); }
+
+  // the first uid in [start, end) not written, for which the file filter and the filters of blocks 1 and 2 answer as
+  // given, blocks 1 and 2 are only asked if the uid is in their uid range
+  int64_t findUid(int64_t start, int64_t end, bool inFile, bool inBlk1, bool inBlk2) {
+    for (int64_t uid = start; uid < end; uid++) {
+      if (uid == 1000 || uid == 2000 || uid == 1000000) continue;
+      if (bfMayContain(pBF, uid) != inFile) continue;
+      if (uid <= 1000000 && bfMayContain(blkBF(1), uid) != inBlk1) continue;
+      if (uid >= 2000 && bfMayContain(blkBF(2), uid) != inBlk2) continue;
+      return uid;
+    }
+    return 0;
+  }
+
+  // read the rows of uid from the stt file, return the number of stt blocks loaded
+  int64_t readUid(int64_t uid, int32_t *nRow) {
+    STimeWindow        w = {TSKEY_MIN, TSKEY_MAX};
+    SVersionRange      v = {0, VERSION_MAX};
+    SSttBlockLoadInfo *pLoadInfo = tCreateLastBlockLoadInfo(pTSchema, NULL, 0);
+    SMergeTree         mTree = {0};
+    int64_t            blocks = 0;
+    double             el = 0;
+
+    *nRow = 0;
+    EXPECT_EQ(tMergeTreeOpen(&mTree, 0, pReader, kSuid, uid, &w, &v, pLoadInfo, false, "stt bf test"), 0);
+    while (tMergeTreeNext(&mTree)) {
+      TSDBROW row = tMergeTreeGetRow(&mTree);
+      EXPECT_EQ(row.pBlockData->aUid[row.iRow], uid);
+      (*nRow)++;
+    }
+    tMergeTreeClose(&mTree);
+
+    getLastBlockLoadInfo(pLoadInfo, &blocks, &el);
+    destroyLastBlockLoadInfo(pLoadInfo);
+    return blocks;
+  }
+
+  SVnode       *pVnode = NULL;
+  STsdb        *pTsdb = NULL;
+  STSchema     *pTSchema = NULL;
+  SHeadFile     fHead = {0};
+  SDataFile     fData = {0};
+  SSmaFile      fSma = {0};
+  SSttFile      fStt = {0};
+  SDFileSet     fSet = {0};
+  SDataFReader *pReader = NULL;
+  SBloomFilter *pBF = NULL;
+  SArray       *aBlkBF = NULL;
+};
+
+TEST_F(TsdbSttBloomFilterTest, persistAndReload) {
+  ASSERT_GT(fStt.bfOffset, fStt.offset);
+
+  // the SSttBlk array ends where the filters start
+  SArray *aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+  ASSERT_EQ(tsdbReadSttBlk(pReader, 0, aSttBlk), 0);
+  EXPECT_EQ(taosArrayGetSize(aSttBlk), 3);
+  taosArrayDestroy(aSttBlk);
+
+  ASSERT_NE(pBF, nullptr);
+  ASSERT_EQ(taosArrayGetSize(aBlkBF), 3);
+  for (int32_t iBlk = 0; iBlk < 3; iBlk++) {
+    for (int64_t uid : kUidsOf[iBlk]) {
+      EXPECT_TRUE(bfMayContain(pBF, uid));
+      EXPECT_TRUE(bfMayContain(blkBF(iBlk), uid));
+    }
+  }
+
+  // most uids not written are rejected by the file filter
+  int32_t nReject = 0;
+  for (int64_t uid = 3000; uid < 4000; uid++) {
+    nReject += !bfMayContain(pBF, uid);
+  }
+  EXPECT_GT(nReject, 900);
+}
+
+TEST_F(TsdbSttBloomFilterTest, uidNotInFile) {
+  // in the uid range of both blocks of kSuid, the file filter skips them without reading
+  int64_t uid = findUid(2001, 1000000, false, false, false);
+  ASSERT_NE(uid, 0);
+
+  int32_t nRow = 0;
+  EXPECT_EQ(readUid(uid, &nRow), 0);
+  EXPECT_EQ(nRow, 0);
+}
+
+TEST_F(TsdbSttBloomFilterTest, blockWithoutUidSkipped) {
+  ASSERT_FALSE(bfMayContain(blkBF(1), 2000));
+  ASSERT_FALSE(bfMayContain(blkBF(2), 1000000));
+
+  int32_t nRow = 0;
+
+  // 2000 is in the uid range of both blocks, only the second one is read
+  EXPECT_EQ(readUid(2000, &nRow), 1);
+  EXPECT_EQ(nRow, 1);
+
+  // 1000000 is in the uid range of both blocks, only the first one is read
+  EXPECT_EQ(readUid(1000000, &nRow), 1);
+  EXPECT_EQ(nRow, 1);
+
+  // let through by the file filter only, both blocks are skipped
+  int64_t uid = findUid(2001, 1000000, true, false, false);
+  ASSERT_NE(uid, 0);
+  EXPECT_EQ(readUid(uid, &nRow), 0);
+  EXPECT_EQ(nRow, 0);
+}
+
+TEST_F(TsdbSttBloomFilterTest, blockWithUidRead) {
+  int32_t nRow = 0;
+
+  EXPECT_EQ(readUid(1000, &nRow), 1);
+  EXPECT_EQ(nRow, 1);
+
+  EXPECT_EQ(readUid(2000000, &nRow), 1);
+  EXPECT_EQ(nRow, 1);
+}
+
+TEST_F(TsdbSttBloomFilterTest, falsePositiveStillRead) {
+  // not written, but let through by the file filter and the filter of the first block of kSuid
+  int64_t uid = findUid(1001, 1000000, true, true, false);
+  ASSERT_NE(uid, 0);
+
+  // the block is read and no row is returned
+  int32_t nRow = 0;
+  EXPECT_EQ(readUid(uid, &nRow), 1);
+  EXPECT_EQ(nRow, 0);
+}
@@ -0,0 +1,473 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tsdb.h"
+
+namespace {
+
+const char *kNames[] = {"beijing", "shanghai", "guangzhou", "shenzhen"};
+
+SColVal colVal(int16_t cid, int8_t type) {
+  SColVal cv = {0};
+  cv.cid = cid;
+  cv.type = type;
+  cv.flag = CV_FLAG_VALUE;
+  return cv;
+}
+
+void blockDataFill(SBlockData *pBlockData, int32_t nRow) {
+  pBlockData->suid = 1;
+  pBlockData->uid = 2;
+  pBlockData->nRow = nRow;
+  ASSERT_EQ(tRealloc((uint8_t **)&pBlockData->aVersion, sizeof(int64_t) * nRow), 0);
+  ASSERT_EQ(tRealloc((uint8_t **)&pBlockData->aTSKEY, sizeof(TSKEY) * nRow), 0);
+  for (int32_t iRow = 0; iRow < nRow; iRow++) {
+    pBlockData->aVersion[iRow] = 100 + iRow;
+    pBlockData->aTSKEY[iRow] = 1600000000000 + iRow * 1000;
+  }
+
+  SColData *pRun, *pNarrow, *pName, *pDouble;
+  ASSERT_EQ(tBlockDataAddColData(pBlockData, &pRun), 0);
+  tColDataInit(pRun, 2, TSDB_DATA_TYPE_INT, 1);
+  ASSERT_EQ(tBlockDataAddColData(pBlockData, &pNarrow), 0);
+  tColDataInit(pNarrow, 3, TSDB_DATA_TYPE_BIGINT, 1);
+  ASSERT_EQ(tBlockDataAddColData(pBlockData, &pName), 0);
+  tColDataInit(pName, 4, TSDB_DATA_TYPE_BINARY, 1);
+  ASSERT_EQ(tBlockDataAddColData(pBlockData, &pDouble), 0);
+  tColDataInit(pDouble, 5, TSDB_DATA_TYPE_DOUBLE, 1);
+
+  uint32_t seed = 12345;
+  for (int32_t iRow = 0; iRow < nRow; iRow++) {
+    SColVal cv;
+
+    // long runs
+    cv = colVal(2, TSDB_DATA_TYPE_INT);
+    cv.value.val = iRow / 100;
+    ASSERT_EQ(tColDataAppendValue(pRun, &cv), 0);
+
+    // a narrow range far from zero, not repeating
+    cv = colVal(3, TSDB_DATA_TYPE_BIGINT);
+    seed = seed * 1103515245u + 12345u;
+    cv.value.val = 1000000000 + (seed >> 16) % 200;
+    ASSERT_EQ(tColDataAppendValue(pNarrow, &cv), 0);
+
+    // a few distinct names, with NULLs
+    if (iRow % 10 == 3) {
+      cv = COL_VAL_NULL(4, TSDB_DATA_TYPE_BINARY);
+    } else {
+      cv = colVal(4, TSDB_DATA_TYPE_BINARY);
+      const char *name = kNames[(seed >> 8) % 4];
+      cv.value.nData = strlen(name);
+      cv.value.pData = (uint8_t *)name;
+    }
+    ASSERT_EQ(tColDataAppendValue(pName, &cv), 0);
+
+    double d = iRow * 0.25;
+    cv = colVal(5, TSDB_DATA_TYPE_DOUBLE);
+    memcpy(&cv.value.val, &d, sizeof(d));
+    ASSERT_EQ(tColDataAppendValue(pDouble, &cv), 0);
+  }
+}
+
+void blockDataCheck(SBlockData *pExpect, SBlockData *pBlockData) {
+  ASSERT_EQ(pBlockData->suid, pExpect->suid);
+  ASSERT_EQ(pBlockData->uid, pExpect->uid);
+  ASSERT_EQ(pBlockData->nRow, pExpect->nRow);
+  ASSERT_EQ(pBlockData->nColData, pExpect->nColData);
+  ASSERT_EQ(memcmp(pBlockData->aVersion, pExpect->aVersion, sizeof(int64_t) * pExpect->nRow), 0);
+  ASSERT_EQ(memcmp(pBlockData->aTSKEY, pExpect->aTSKEY, sizeof(TSKEY) * pExpect->nRow), 0);
+
+  for (int32_t iColData = 0; iColData < pExpect->nColData; iColData++) {
+    SColData *pColData = tBlockDataGetColDataByIdx(pBlockData, iColData);
+    SColData *pColDataExpect = tBlockDataGetColDataByIdx(pExpect, iColData);
+    ASSERT_EQ(pColData->cid, pColDataExpect->cid);
+    ASSERT_EQ(pColData->type, pColDataExpect->type);
+    ASSERT_EQ(pColData->flag, pColDataExpect->flag);
+
+    for (int32_t iRow = 0; iRow < pExpect->nRow; iRow++) {
+      SColVal cv, cvExpect;
+      tColDataGetValue(pColData, iRow, &cv);
+      tColDataGetValue(pColDataExpect, iRow, &cvExpect);
+      ASSERT_EQ(cv.flag, cvExpect.flag);
+      if (!COL_VAL_IS_VALUE(&cvExpect)) continue;
+
+      if (IS_VAR_DATA_TYPE(cvExpect.type)) {
+        ASSERT_EQ(cv.value.nData, cvExpect.value.nData);
+        ASSERT_EQ(memcmp(cv.value.pData, cvExpect.value.pData, cvExpect.value.nData), 0);
+      } else {
+        ASSERT_EQ(cv.value.val, cvExpect.value.val);
+      }
+    }
+  }
+}
+
+// the algorithm of each SBlockCol of an encoded block, in column order
+void blockColAlgs(uint8_t *pData, SDiskDataHdr *pHdr, std::vector<int8_t> &aAlg) {
+  int32_t n = tGetDiskDataHdr(pData, pHdr);
+  n += pHdr->szUid + pHdr->szVer + pHdr->szKey;
+
+  int32_t nt = 0;
+  while (nt < pHdr->szBlkCol) {
+    SBlockCol blockCol = {0};
+    nt += tGetBlockCol(pData + n + nt, &blockCol, pHdr->fmtVer, pHdr->cmprAlg);
+    aAlg.push_back(blockCol.cmprAlg);
+  }
+}
+
+class TsdbBlockDataFmtTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(tBlockDataCreate(&bData), 0);
+    ASSERT_EQ(tBlockDataCreate(&bDecoded), 0);
+    blockDataFill(&bData, 1000);
+  }
+
+  void TearDown() override {
+    tBlockDataDestroy(&bData, 1);
+    tBlockDataDestroy(&bDecoded, 1);
+    for (int32_t i = 0; i < sizeof(aBuf) / sizeof(aBuf[0]); i++) {
+      tFree(aBuf[i]);
+    }
+    tFree(pOut);
+  }
+
+  SBlockData bData;
+  SBlockData bDecoded;
+  uint8_t   *aBuf[4] = {0};
+  uint8_t   *pOut = NULL;
+  int32_t    szOut = 0;
+};
+
+}  // namespace
+
+TEST_F(TsdbBlockDataFmtTest, fmtVer0) {
+  // the format of the snapshot sent to replicas, readable by the tsdb before the per column encodings
+  int32_t aBufN[4] = {0};
+  ASSERT_EQ(tCmprBlockData(&bData, TWO_STAGE_COMP, 0, &pOut, &szOut, aBuf, aBufN), 0);
+
+  SDiskDataHdr        hdr = {0};
+  std::vector<int8_t> aAlg;
+  blockColAlgs(pOut, &hdr, aAlg);
+  ASSERT_EQ(hdr.fmtVer, 0);
+  ASSERT_EQ(aAlg.size(), 4);
+  for (int8_t alg : aAlg) {
+    ASSERT_EQ(alg, TWO_STAGE_COMP);
+  }
+
+  ASSERT_EQ(tDecmprBlockData(pOut, szOut, &bDecoded, aBuf), 0);
+  blockDataCheck(&bData, &bDecoded);
+}
+
+TEST_F(TsdbBlockDataFmtTest, fmtVer1) {
+  int32_t aBufN[4] = {0};
+  ASSERT_EQ(tCmprBlockData(&bData, TWO_STAGE_COMP, TSDB_DATA_FMT_VER, &pOut, &szOut, aBuf, aBufN), 0);
+
+  SDiskDataHdr        hdr = {0};
+  std::vector<int8_t> aAlg;
+  blockColAlgs(pOut, &hdr, aAlg);
+  ASSERT_EQ(hdr.fmtVer, TSDB_DATA_FMT_VER);
+  ASSERT_EQ(aAlg.size(), 4);
+  ASSERT_EQ(aAlg[0], RLE_COMP);
+  ASSERT_EQ(aAlg[1], FOR_BITPACK_COMP);
+  ASSERT_EQ(aAlg[2], DICT_COMP);
+  ASSERT_EQ(aAlg[3], TWO_STAGE_COMP);
+
+  ASSERT_EQ(tDecmprBlockData(pOut, szOut, &bDecoded, aBuf), 0);
+  blockDataCheck(&bData, &bDecoded);
+}
+
+TEST_F(TsdbBlockDataFmtTest, fmtVerUnknown) {
+  int32_t aBufN[4] = {0};
+  ASSERT_EQ(tCmprBlockData(&bData, TWO_STAGE_COMP, TSDB_DATA_FMT_VER, &pOut, &szOut, aBuf, aBufN), 0);
+
+  // a block from a newer tsdb is refused rather than misread
+  SDiskDataHdr hdr = {0};
+  int32_t      n = tGetDiskDataHdr(pOut, &hdr);
+  hdr.fmtVer = TSDB_DATA_FMT_VER + 1;
+  ASSERT_EQ(tPutDiskDataHdr(NULL, &hdr), n);
+  tPutDiskDataHdr(pOut, &hdr);
+
+  ASSERT_EQ(tDecmprBlockData(pOut, szOut, &bDecoded, aBuf), TSDB_CODE_VERSION_NOT_COMPATIBLE);
+}
+
+namespace {
+
+const int32_t kDictMaxSize = TSDB_DICT_MAX_SIZE;
+
+// a value no longer than the max length of the column, made of bytes with no run for LZ4 to find
+std::string varValue(int32_t len, uint32_t seed) {
+  std::string s(len, '\0');
+  for (int32_t i = 0; i < len; i++) {
+    seed = seed * 1103515245u + 12345u;
+    s[i] = (char)(seed >> 16);
+  }
+  return s;
+}
+
+// a pseudo random pick of [0, n), a periodic pattern of values is what LZ4 does best on
+int32_t pick(int32_t iVal, int32_t n) { return ((uint32_t)iVal * 2654435761u >> 13) % n; }
+
+// Encode the values with the dictionary over a chunk stored as is, decode it back if the dictionary wins, and return
+// the algorithm the chunk ends with.
+int8_t dictCodec(const std::vector<std::string> &aVal) {
+  std::vector<int32_t> aOffset;
+  std::string          in;
+  for (const std::string &val : aVal) {
+    aOffset.push_back(in.size());
+    in += val;
+  }
+
+  uint8_t *pOut = NULL;
+  uint8_t *pBuf = NULL;
+  uint8_t *pDecoded = NULL;
+  int16_t *aCode = NULL;
+  int32_t  nDict = 0;
+  int32_t  szIn = in.size();
+  int32_t  szOut = szIn;
+  int8_t   cmprAlg = TWO_STAGE_COMP;
+  EXPECT_EQ(tRealloc(&pOut, szIn + 1), 0);
+  memcpy(pOut, in.data(), szIn);
+
+  EXPECT_EQ(tsdbCmprDataDict((uint8_t *)in.data(), szIn, aOffset.data(), aVal.size(), &pOut, 0, &szOut, &cmprAlg,
+                             &pBuf),
+            0);
+  if (cmprAlg == DICT_COMP) {
+    EXPECT_LE(szOut, szIn);
+    EXPECT_EQ(tsdbDecmprDataDict(pOut, szOut, aVal.size(), &pDecoded, szIn, &aCode, &nDict, &pBuf), 0);
+    EXPECT_EQ(memcmp(pDecoded, in.data(), szIn), 0);
+
+    // the codes name the distinct values
+    std::map<int16_t, std::string> dict;
+    for (int32_t iVal = 0; iVal < aVal.size(); iVal++) {
+      EXPECT_TRUE(aCode[iVal] >= 0 && aCode[iVal] < nDict);
+      auto it = dict.emplace(aCode[iVal], aVal[iVal]).first;
+      EXPECT_EQ(it->second, aVal[iVal]);
+    }
+    EXPECT_EQ(dict.size(), nDict);
+    EXPECT_EQ(std::set<std::string>(aVal.begin(), aVal.end()).size(), nDict);
+  } else {
+    // the chunk in place is left alone
+    EXPECT_EQ(cmprAlg, TWO_STAGE_COMP);
+    EXPECT_EQ(szOut, szIn);
+    EXPECT_EQ(memcmp(pOut, in.data(), szIn), 0);
+  }
+
+  tFree(pOut);
+  tFree(pBuf);
+  tFree(pDecoded);
+  tFree((uint8_t *)aCode);
+  return cmprAlg;
+}
+
+// Encode a column of the values (NULL where aNull is set) as a block of the current format does, decode it back and
+// return the algorithm of its value chunk.
+int8_t dictColDataRoundTrip(int8_t type, const std::vector<std::string> &aVal, const std::vector<bool> &aNull) {
+  SColData colData = {0};
+  SColData decoded = {0};
+  tColDataInit(&colData, 2, type, 0);
+  tColDataInit(&decoded, 2, type, 0);
+  for (int32_t iVal = 0; iVal < aVal.size(); iVal++) {
+    SColVal cv;
+    if (aNull[iVal]) {
+      cv = COL_VAL_NULL(2, type);
+    } else {
+      cv = colVal(2, type);
+      cv.value.nData = aVal[iVal].size();
+      cv.value.pData = (uint8_t *)aVal[iVal].data();
+    }
+    EXPECT_EQ(tColDataAppendValue(&colData, &cv), 0);
+  }
+
+  SBlockCol blockCol = {0};
+  blockCol.cid = colData.cid;
+  blockCol.type = colData.type;
+  blockCol.flag = colData.flag;
+  blockCol.cmprAlg = TWO_STAGE_COMP;
+  blockCol.szOrigin = colData.nData;
+
+  uint8_t *pOut = NULL;
+  uint8_t *pBuf = NULL;
+  EXPECT_EQ(tsdbCmprColData(&colData, TWO_STAGE_COMP, TSDB_DATA_FMT_VER, &blockCol, &pOut, 0, &pBuf), 0);
+  EXPECT_EQ(tsdbDecmprColData(pOut, &blockCol, TWO_STAGE_COMP, aVal.size(), &decoded, &pBuf), 0);
+
+  for (int32_t iVal = 0; iVal < aVal.size(); iVal++) {
+    SColVal cv;
+    tColDataGetValue(&decoded, iVal, &cv);
+    if (aNull[iVal]) {
+      EXPECT_TRUE(COL_VAL_IS_NULL(&cv));
+      continue;
+    }
+    EXPECT_TRUE(COL_VAL_IS_VALUE(&cv));
+    EXPECT_EQ(cv.value.nData, aVal[iVal].size());
+    EXPECT_EQ(memcmp(cv.value.pData, aVal[iVal].data(), cv.value.nData), 0);
+  }
+
+  // the values of the same code are the same
+  if (blockCol.cmprAlg == DICT_COMP) {
+    EXPECT_GT(decoded.nDict, 0);
+    std::map<int16_t, std::string> dict;
+    for (int32_t iVal = 0; iVal < aVal.size(); iVal++) {
+      if (aNull[iVal]) continue;
+      auto it = dict.emplace(decoded.aDictCode[iVal], aVal[iVal]).first;
+      EXPECT_EQ(it->second, aVal[iVal]);
+    }
+  } else {
+    EXPECT_EQ(decoded.nDict, 0);
+  }
+
+  tColDataDestroy(&colData);
+  tColDataDestroy(&decoded);
+  tFree(pOut);
+  tFree(pBuf);
+  return blockCol.cmprAlg;
+}
+
+}  // namespace
+
+TEST(TsdbDictTest, emptyValues) {
+  // nothing to encode
+  std::vector<std::string> aVal(1000);
+  std::vector<bool>        aNull(1000, false);
+  ASSERT_EQ(dictCodec(aVal), TWO_STAGE_COMP);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), TWO_STAGE_COMP);
+
+  // the empty value is a dictionary entry as any other
+  for (int32_t iVal = 0; iVal < aVal.size(); iVal++) {
+    if (pick(iVal, 4)) aVal[iVal] = varValue(20, pick(iVal, 3));
+  }
+  ASSERT_EQ(dictCodec(aVal), DICT_COMP);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), DICT_COMP);
+}
+
+TEST(TsdbDictTest, identicalValues) {
+  std::vector<std::string> aVal(1000, "shanghai");
+  std::vector<bool>        aNull(1000, false);
+  ASSERT_EQ(dictCodec(aVal), DICT_COMP);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), DICT_COMP);
+
+  // a single value
+  ASSERT_EQ(dictCodec(std::vector<std::string>(1, "shanghai")), TWO_STAGE_COMP);
+}
+
+TEST(TsdbDictTest, cardinalityLimit) {
+  // at the limit
+  int32_t                  nVal = kDictMaxSize * 4;
+  std::vector<std::string> aVal;
+  std::vector<bool>        aNull(nVal, false);
+  for (int32_t iVal = 0; iVal < nVal; iVal++) {
+    aVal.push_back(varValue(16, iVal < kDictMaxSize ? iVal : pick(iVal, kDictMaxSize)));
+  }
+  ASSERT_EQ(dictCodec(aVal), DICT_COMP);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), DICT_COMP);
+
+  // one more distinct value falls back to the chunk in place
+  aVal.back() = varValue(16, kDictMaxSize);
+  ASSERT_EQ(dictCodec(aVal), TWO_STAGE_COMP);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), TWO_STAGE_COMP);
+
+  // more than half of a small block distinct
+  aVal.clear();
+  for (int32_t iVal = 0; iVal < 100; iVal++) {
+    aVal.push_back(varValue(16, iVal < 51 ? iVal : 0));
+  }
+  ASSERT_EQ(dictCodec(aVal), TWO_STAGE_COMP);
+  aVal[50] = aVal[0];
+  ASSERT_EQ(dictCodec(aVal), DICT_COMP);
+}
+
+TEST(TsdbDictTest, nullValues) {
+  std::vector<std::string> aVal;
+  std::vector<bool>        aNull;
+  for (int32_t iVal = 0; iVal < 1000; iVal++) {
+    aVal.push_back(varValue(12, pick(iVal, 5)));
+    aNull.push_back(iVal % 3 == 0);
+  }
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), DICT_COMP);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_NCHAR, aVal, aNull), DICT_COMP);
+
+  // NULLs only in front of the values
+  std::fill(aNull.begin(), aNull.end(), false);
+  std::fill(aNull.begin(), aNull.begin() + 500, true);
+  ASSERT_EQ(dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull), DICT_COMP);
+}
+
+TEST(TsdbDictTest, maxLengthValues) {
+  // values of the max length that differ only in the last byte
+  std::vector<std::string> aVal;
+  std::vector<bool>        aNull(64, false);
+  std::string              val = varValue(TSDB_MAX_BINARY_LEN, 1);
+  for (int32_t iVal = 0; iVal < 64; iVal++) {
+    aVal.push_back(val);
+    aVal.back().back() = (char)(iVal % 4);
+  }
+  ASSERT_EQ(dictCodec(aVal), DICT_COMP);
+  dictColDataRoundTrip(TSDB_DATA_TYPE_BINARY, aVal, aNull);
+
+  int32_t nchar = (TSDB_MAX_NCHAR_LEN / TSDB_NCHAR_SIZE) * TSDB_NCHAR_SIZE;
+  for (int32_t iVal = 0; iVal < 64; iVal++) {
+    aVal[iVal] = varValue(nchar, iVal % 8);
+  }
+  ASSERT_EQ(dictCodec(aVal), DICT_COMP);
+  dictColDataRoundTrip(TSDB_DATA_TYPE_NCHAR, aVal, aNull);
+}
+
+TEST(TsdbDictTest, corrupted) {
+  std::vector<std::string> aVal(100, "shanghai");
+  std::vector<int32_t>     aOffset;
+  std::string              in;
+  for (const std::string &val : aVal) {
+    aOffset.push_back(in.size());
+    in += val;
+  }
+
+  uint8_t *pOut = NULL;
+  uint8_t *pBuf = NULL;
+  uint8_t *pDecoded = NULL;
+  int16_t *aCode = NULL;
+  int32_t  nDict = 0;
+  int32_t  szIn = in.size();
+  int32_t  szOut = szIn;
+  int8_t   cmprAlg = TWO_STAGE_COMP;
+  ASSERT_EQ(tRealloc(&pOut, szIn), 0);
+  ASSERT_EQ(tsdbCmprDataDict((uint8_t *)in.data(), szIn, aOffset.data(), aVal.size(), &pOut, 0, &szOut, &cmprAlg,
+                             &pBuf),
+            0);
+  ASSERT_EQ(cmprAlg, DICT_COMP);
+
+  // the values decoded not as long as the column says
+  ASSERT_EQ(tsdbDecmprDataDict(pOut, szOut, aVal.size(), &pDecoded, szIn - 1, &aCode, &nDict, &pBuf), TSDB_CODE_FILE_CORRUPTED);
+  ASSERT_EQ(tsdbDecmprDataDict(pOut, szOut, aVal.size(), &pDecoded, szIn + 1, &aCode, &nDict, &pBuf), TSDB_CODE_FILE_CORRUPTED);
+
+  // an entry of the dictionary out of the chunk
+  ASSERT_EQ(tsdbDecmprDataDict(pOut, 4, aVal.size(), &pDecoded, szIn, &aCode, &nDict, &pBuf), TSDB_CODE_FILE_CORRUPTED);
+
+  // an empty dictionary
+  pOut[0] = 0;
+  ASSERT_EQ(tsdbDecmprDataDict(pOut, szOut, aVal.size(), &pDecoded, szIn, &aCode, &nDict, &pBuf),
+            TSDB_CODE_FILE_CORRUPTED);
+  ASSERT_EQ(nDict, 0);
+
+  tFree(pOut);
+  tFree(pBuf);
+  tFree(pDecoded);
+  tFree((uint8_t *)aCode);
+}
@@ -497,6 +497,10 @@ int32_t qExplainResNodeToRowsImpl(SExplainResNode *pResNode, SExplainCtx *ctx, i
           info.loadBlockStatis += pScanInfo->loadBlockStatis;
           info.totalCheckedRows += pScanInfo->totalCheckedRows;
           info.filterOutBlocks += pScanInfo->filterOutBlocks;
+          if (execInfo->verboseLen >= sizeof(STableScanAnalyzeInfo)) {
+            info.pageCacheHits += pScanInfo->pageCacheHits;
+            info.pageCacheMisses += pScanInfo->pageCacheMisses;
+          }
 
           if (pScanInfo->totalRows > totalRows) {
             totalRows = pScanInfo->totalRows;
@@ -518,6 +522,12 @@ int32_t qExplainResNodeToRowsImpl(SExplainResNode *pResNode, SExplainCtx *ctx, i
 
         EXPLAIN_ROW_APPEND("check_rows=%.1f", ((double)info.totalCheckedRows) / nodeNum);
         EXPLAIN_ROW_APPEND(EXPLAIN_BLANK_FORMAT);
+
+        EXPLAIN_ROW_APPEND("page_cache_hits=%.1f", ((double)info.pageCacheHits) / nodeNum);
+        EXPLAIN_ROW_APPEND(EXPLAIN_BLANK_FORMAT);
+
+        EXPLAIN_ROW_APPEND("page_cache_misses=%.1f", ((double)info.pageCacheMisses) / nodeNum);
+        EXPLAIN_ROW_APPEND(EXPLAIN_BLANK_FORMAT);
         EXPLAIN_ROW_END();
 
         QRY_ERR_RET(qExplainResAppendRow(ctx, tbuf, tlen, level + 1));
@@ -44,7 +44,8 @@ typedef struct SSortSource {
     void* param;
     bool  onlyRef;
   };
-
+  char*   pSortKeys;    // normalized sort keys of the rows in src.pBlock
+  int32_t keyCapacity;  // number of rows pSortKeys is allocated for
 } SSortSource;
 
 typedef struct SMsortComparParam {
@@ -52,6 +53,8 @@ typedef struct SMsortComparParam {
   int32_t numOfSources;
   SArray* orderInfo;  // SArray<SBlockOrderInfo>
   bool    cmpGroupId;
+  int32_t keyLen;       // length of the normalized sort key, 0 if not available, -1 if not decided yet
+  bool    keyComplete;  // rows with equal normalized keys are equal in order
 } SMsortComparParam;
 
 typedef struct SSortHandle  SSortHandle;
@@ -108,6 +111,16 @@ int32_t tsortSetComparFp(SSortHandle* pHandle, _sort_merge_compar_fn_t fp);
  */
 int32_t tsortSetCompareGroupId(SSortHandle* pHandle, bool compareGroupId);
 
+/**
+ * Only the first maxRows rows in order are required by the caller. For a small maxRows, the single source sort keeps
+ * a bounded in-memory buffer of the top rows instead of sorting the whole input and spilling it to disk.
+ *
+ * @param pHandle
+ * @param maxRows  0 means all rows are required
+ * @return
+ */
+int32_t tsortSetMaxRows(SSortHandle* pHandle, uint64_t maxRows);
+
 /**
  *
  * @param pHandle
@@ -27,6 +27,7 @@ extern SDataSinkStat gDataSinkStat;
 typedef struct SDataDispatchBuf {
   int32_t useSize;
   int32_t allocSize;
+  int8_t  compressed;
   char*   pData;
 } SDataDispatchBuf;
 
@@ -70,13 +71,17 @@ static void toDataCacheEntry(SDataDispatchHandle* pHandle, const SInputData* pIn
     }
   }
   SDataCacheEntry* pEntry = (SDataCacheEntry*)pBuf->pData;
-  pEntry->compressed = 0;
+  pEntry->compressed = pBuf->compressed;
   pEntry->numOfRows = pInput->pData->info.rows;
   pEntry->numOfCols = numOfCols;
   pEntry->dataLen = 0;
 
   pBuf->useSize = sizeof(SDataCacheEntry);
-  pEntry->dataLen = blockEncode(pInput->pData, pEntry->data, numOfCols);
+  if (pEntry->compressed) {
+    pEntry->dataLen = blockCompressEncode(pInput->pData, pEntry->data, numOfCols);
+  } else {
+    pEntry->dataLen = blockEncode(pInput->pData, pEntry->data, numOfCols);
+  }
 //  ASSERT(pEntry->numOfRows == *(int32_t*)(pEntry->data + 8));
 //  ASSERT(pEntry->numOfCols == *(int32_t*)(pEntry->data + 8 + 4));
 
@@ -86,6 +91,23 @@ static void toDataCacheEntry(SDataDispatchHandle* pHandle, const SInputData* pIn
   atomic_add_fetch_64(&gDataSinkStat.cachedSize, pEntry->dataLen);
 }
 
+// compress all columns if the size of any column exceeds tsCompressColData, see the definition of tsCompressColData
+static bool needCompress(const SSDataBlock* pBlock) {
+  if (tsCompressColData < 0 || pBlock->info.rows <= 0) {
+    return false;
+  }
+
+  size_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, i);
+    if (colDataGetLength(pCol, pBlock->info.rows) > tsCompressColData) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 static bool allocBuf(SDataDispatchHandle* pDispatcher, const SInputData* pInput, SDataDispatchBuf* pBuf) {
   /*
     uint32_t capacity = pDispatcher->pManager->cfg.maxDataBlockNumPerQuery;
@@ -96,7 +118,9 @@ static bool allocBuf(SDataDispatchHandle* pDispatcher, const SInputData* pInput,
     }
   */
 
-  pBuf->allocSize = sizeof(SDataCacheEntry) + blockGetEncodeSize(pInput->pData);
+  pBuf->compressed = needCompress(pInput->pData);
+  pBuf->allocSize = sizeof(SDataCacheEntry) + (pBuf->compressed ? blockGetCompressEncodeSize(pInput->pData)
+                                                                  : blockGetEncodeSize(pInput->pData));
 
   pBuf->pData = taosMemoryMalloc(pBuf->allocSize);
   if (pBuf->pData == NULL) {
@@ -431,7 +431,10 @@ static SColumnInfoData* getColInfoResult(void* metaHandle, int64_t suid, SArray*
   tags = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
 
   int32_t filter = optimizeTbnameInCond(metaHandle, suid, uidList, pTagCond, tags);
-  if (filter == -1) {
+
+  // read the columns from the columnar tag table of the super table, or decode the tags of each table
+  bool tagBlock = (suid != 0 && metaGetTableTagBlock(metaHandle, suid, uidList, pResBlock) == TSDB_CODE_SUCCESS);
+  if (filter == -1 && !tagBlock) {
     code = metaGetTableTags(metaHandle, suid, uidList, tags);
     if (code != TSDB_CODE_SUCCESS) {
       qError("failed to get table tags from meta, reason:%s, suid:%" PRIu64, tstrerror(code), suid);
@@ -439,7 +442,7 @@ static SColumnInfoData* getColInfoResult(void* metaHandle, int64_t suid, SArray*
       goto end;
     }
   }
-  if (suid != 0) {
+  if (suid != 0 && !tagBlock) {
     removeInvalidTable(uidList, tags);
   }
 
@@ -454,7 +457,7 @@ static SColumnInfoData* getColInfoResult(void* metaHandle, int64_t suid, SArray*
     goto end;
   }
 
-  for (int32_t i = 0; i < rows; i++) {
+  for (int32_t i = 0; !tagBlock && i < rows; i++) {
     int64_t* uid = taosArrayGet(uidList, i);
     for (int32_t j = 0; j < taosArrayGetSize(pResBlock->pDataBlock); j++) {
       SColumnInfoData* pColInfo = (SColumnInfoData*)taosArrayGet(pResBlock->pDataBlock, j);
@@ -598,9 +601,24 @@ int32_t getColInfoResultForGroupby(void* metaHandle, SNodeList* group, STableLis
 
   //  int64_t stt = taosGetTimestampUs();
   tags = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false, HASH_NO_LOCK);
-  code = metaGetTableTags(metaHandle, pTableListInfo->suid, uidList, tags);
-  if (code != TSDB_CODE_SUCCESS) {
-    goto end;
+
+  // the tag table removes the dropped tables from uidList, which must stay aligned with the table list here
+  bool tagBlock = (pTableListInfo->suid != 0 &&
+                   metaGetTableTagBlock(metaHandle, pTableListInfo->suid, uidList, pResBlock) == TSDB_CODE_SUCCESS &&
+                   taosArrayGetSize(uidList) == rows);
+  if (!tagBlock) {
+    if (taosArrayGetSize(uidList) != rows) {
+      taosArrayClear(uidList);
+      for (int32_t i = 0; i < rows; ++i) {
+        STableKeyInfo* pkeyInfo = taosArrayGet(pTableListInfo->pTableList, i);
+        taosArrayPush(uidList, &pkeyInfo->uid);
+      }
+    }
+
+    code = metaGetTableTags(metaHandle, pTableListInfo->suid, uidList, tags);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto end;
+    }
   }
 
   //  int64_t stt1 = taosGetTimestampUs();
@@ -612,7 +630,7 @@ int32_t getColInfoResultForGroupby(void* metaHandle, SNodeList* group, STableLis
   }
 
   //  int64_t st = taosGetTimestampUs();
-  for (int32_t i = 0; i < rows; i++) {
+  for (int32_t i = 0; !tagBlock && i < rows; i++) {
     int64_t* uid = taosArrayGet(uidList, i);
     for (int32_t j = 0; j < taosArrayGetSize(pResBlock->pDataBlock); j++) {
       SColumnInfoData* pColInfo = (SColumnInfoData*)taosArrayGet(pResBlock->pDataBlock, j);
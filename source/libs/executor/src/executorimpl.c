@@ -864,20 +864,25 @@ void extractQualifiedTupleByFilterResult(SSDataBlock* pBlock, const SColumnInfoD
         continue;
       }
 
-      colInfoDataCleanup(pDst, pBlock->info.rows);
-
       int32_t numOfRows = 0;
-      for (int32_t j = 0; j < totalRows; ++j) {
-        if (((int8_t*)p->pData)[j] == 0) {
-          continue;
-        }
+      if (colDataHasDict(pDst)) {
+        // the rows of a dictionary column share the values, only the offsets and the codes are compacted in place
+        numOfRows = colDataKeepDictRows(pDst, (int8_t*)p->pData, totalRows);
+      } else {
+        colInfoDataCleanup(pDst, pBlock->info.rows);
 
-        if (colDataIsNull_s(pSrc, j)) {
-          colDataAppendNULL(pDst, numOfRows);
-        } else {
-          colDataAppend(pDst, numOfRows, colDataGetData(pSrc, j), false);
+        for (int32_t j = 0; j < totalRows; ++j) {
+          if (((int8_t*)p->pData)[j] == 0) {
+            continue;
+          }
+
+          if (colDataIsNull_s(pSrc, j)) {
+            colDataAppendNULL(pDst, numOfRows);
+          } else {
+            colDataAppend(pDst, numOfRows, colDataGetData(pSrc, j), false);
+          }
+          numOfRows += 1;
         }
-        numOfRows += 1;
       }
 
       // todo this value can be assigned directly
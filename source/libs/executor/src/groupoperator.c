@@ -27,16 +27,38 @@
 #include "thash.h"
 #include "ttypes.h"
 
+// Buffers used to assign all rows of one data block to their groups in a batch.
+typedef struct SGroupBatchSupp {
+  int32_t      capacity;     // maximum number of rows the buffers are allocated for
+  int32_t      numOfSlots;   // size of the open-addressing hash table, power of 2
+  uint32_t*    pHash;        // key hash of each row
+  int32_t*     pRowGroup;    // group index of each row
+  int32_t*     pSelection;   // row indexes clustered by group, rows in the same group keep the input order
+  int32_t*     pSlots;       // hash slot -> group index, -1 means empty slot
+  int32_t*     pGroupRow;    // first row of each group
+  int32_t*     pGroupStart;  // start offset of each group in pSelection, numOfGroups + 1 items
+  SArray*      pInputSlots;  // slots of the input block read by the aggregate functions, SArray<int32_t>
+  SSDataBlock* pGather;      // the input slots gathered in the order of pSelection, the input block is never rewritten
+  int32_t      dictMapSize;  // number of items pDictMap is allocated for
+  int32_t*     pDictMap;     // group index or key hash of each dictionary code of a group key column
+} SGroupBatchSupp;
+
+// the aggregate functions are applied on the runs of the input block in place when they are long enough on average,
+// otherwise the rows are gathered group by group into pGather first
+#define GROUP_BATCH_MIN_RUN_LEN 8
+
 typedef struct SGroupbyOperatorInfo {
-  SOptrBasicInfo binfo;
-  SAggSupporter  aggSup;
-  SArray*        pGroupCols;     // group by columns, SArray<SColumn>
-  SArray*        pGroupColVals;  // current group column values, SArray<SGroupKeys>
-  bool           isInit;         // denote if current val is initialized or not
-  char*          keyBuf;         // group by keys for hash
-  int32_t        groupKeyLen;    // total group by column width
-  SGroupResInfo  groupResInfo;
-  SExprSupp      scalarSup;
+  SOptrBasicInfo  binfo;
+  SAggSupporter   aggSup;
+  SArray*         pGroupCols;     // group by columns, SArray<SColumn>
+  SArray*         pGroupColVals;  // current group column values, SArray<SGroupKeys>
+  bool            isInit;         // denote if current val is initialized or not
+  char*           keyBuf;         // group by keys for hash
+  int32_t         groupKeyLen;    // total group by column width
+  SGroupResInfo   groupResInfo;
+  SExprSupp       scalarSup;
+  bool            batchGroup;     // group the rows of each block in batch, not available for json group keys
+  SGroupBatchSupp batchSup;
 } SGroupbyOperatorInfo;
 
 // The sort in partition may be needed later.
@@ -68,6 +90,17 @@ static void freeGroupKey(void* param) {
   taosMemoryFree(pKey->pData);
 }
 
+static void cleanupGroupBatchSupp(SGroupBatchSupp* pSupp) {
+  taosMemoryFreeClear(pSupp->pHash);
+  taosMemoryFreeClear(pSupp->pRowGroup);
+  taosMemoryFreeClear(pSupp->pSelection);
+  taosMemoryFreeClear(pSupp->pSlots);
+  taosMemoryFreeClear(pSupp->pGroupRow);
+  taosMemoryFreeClear(pSupp->pGroupStart);
+  pSupp->capacity = 0;
+  pSupp->numOfSlots = 0;
+}
+
 static void destroyGroupOperatorInfo(void* param) {
   SGroupbyOperatorInfo* pInfo = (SGroupbyOperatorInfo*)param;
   if (pInfo == NULL) {
@@ -75,6 +108,10 @@ static void destroyGroupOperatorInfo(void* param) {
   }
 
   cleanupBasicInfo(&pInfo->binfo);
+  cleanupGroupBatchSupp(&pInfo->batchSup);
+  taosArrayDestroy(pInfo->batchSup.pInputSlots);
+  blockDataDestroy(pInfo->batchSup.pGather);
+  taosMemoryFreeClear(pInfo->batchSup.pDictMap);
   taosMemoryFreeClear(pInfo->keyBuf);
   taosArrayDestroy(pInfo->pGroupCols);
   taosArrayDestroyEx(pInfo->pGroupColVals, freeGroupKey);
@@ -263,9 +300,400 @@ static void doAssignGroupKeys(SqlFunctionCtx* pCtx, int32_t numOfOutput, int32_t
   }
 }
 
-static void doHashGroupbyAgg(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
+static int32_t ensureGroupBatchSupp(SGroupBatchSupp* pSupp, int32_t rows) {
+  if (rows <= pSupp->capacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t numOfSlots = 16;
+  while (numOfSlots < rows * 2) {
+    numOfSlots <<= 1;
+  }
+
+  cleanupGroupBatchSupp(pSupp);
+
+  pSupp->pHash = taosMemoryMalloc(sizeof(uint32_t) * rows);
+  pSupp->pRowGroup = taosMemoryMalloc(sizeof(int32_t) * rows);
+  pSupp->pSelection = taosMemoryMalloc(sizeof(int32_t) * rows);
+  pSupp->pSlots = taosMemoryMalloc(sizeof(int32_t) * numOfSlots);
+  pSupp->pGroupRow = taosMemoryMalloc(sizeof(int32_t) * rows);
+  pSupp->pGroupStart = taosMemoryMalloc(sizeof(int32_t) * (rows + 1));
+  if (pSupp->pHash == NULL || pSupp->pRowGroup == NULL || pSupp->pSelection == NULL || pSupp->pSlots == NULL ||
+      pSupp->pGroupRow == NULL || pSupp->pGroupStart == NULL) {
+    cleanupGroupBatchSupp(pSupp);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pSupp->capacity = rows;
+  pSupp->numOfSlots = numOfSlots;
+  return TSDB_CODE_SUCCESS;
+}
+
+// collect the slots of the input block read by the aggregate functions, including the columns of the selectivity
+// values and the group keys assigned to the output.
+static int32_t initGroupBatchInputSlots(SGroupBatchSupp* pSupp, const SExprSupp* pExprSup) {
+  pSupp->pInputSlots = taosArrayInit(4, sizeof(int32_t));
+  if (pSupp->pInputSlots == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < pExprSup->numOfExprs; ++i) {
+    SExprInfo* pExpr = &pExprSup->pExprInfo[i];
+    for (int32_t j = 0; j < pExpr->base.numOfParams; ++j) {
+      SFunctParam* pParam = &pExpr->base.pParam[j];
+      if (pParam->type != FUNC_PARAM_TYPE_COLUMN) {
+        continue;
+      }
+
+      int32_t slotId = pParam->pCol->slotId;
+      bool    exists = false;
+      for (int32_t k = 0; k < taosArrayGetSize(pSupp->pInputSlots); ++k) {
+        if (*(int32_t*)taosArrayGet(pSupp->pInputSlots, k) == slotId) {
+          exists = true;
+          break;
+        }
+      }
+
+      if (!exists && taosArrayPush(pSupp->pInputSlots, &slotId) == NULL) {
+        return TSDB_CODE_OUT_OF_MEMORY;
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t ensureGroupDictMap(SGroupBatchSupp* pSupp, int32_t size) {
+  if (size <= pSupp->dictMapSize) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t* p = taosMemoryRealloc(pSupp->pDictMap, sizeof(int32_t) * size);
+  if (p == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pSupp->pDictMap = p;
+  pSupp->dictMapSize = size;
+  return TSDB_CODE_SUCCESS;
+}
+
+#define GROUP_KEY_NULL_HASH 0x9E3779B9u
+
+// hash the group key columns column by column, instead of building the group key of each row
+static void hashGroupKeyColumns(SGroupBatchSupp* pSupp, const SArray* pGroupCols, const SSDataBlock* pBlock,
+                                uint32_t* pHash) {
+  int32_t rows = pBlock->info.rows;
+  memset(pHash, 0, sizeof(uint32_t) * rows);
+
+  size_t numOfGroupCols = taosArrayGetSize(pGroupCols);
+  for (int32_t i = 0; i < numOfGroupCols; ++i) {
+    SColumn*         pCol = taosArrayGet(pGroupCols, i);
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pCol->slotId);
+
+    // the rows of the same dictionary code have the same value, each distinct value is hashed once
+    if (colDataHasDict(pColInfoData) &&
+        ensureGroupDictMap(pSupp, pColInfoData->varmeta.dictSize) == TSDB_CODE_SUCCESS) {
+      uint32_t* pDictHash = (uint32_t*)pSupp->pDictMap;
+      memset(pDictHash, 0, sizeof(uint32_t) * pColInfoData->varmeta.dictSize);
+      for (int32_t j = 0; j < rows; ++j) {
+        uint32_t h = GROUP_KEY_NULL_HASH;
+        if (!colDataIsNull_var(pColInfoData, j)) {
+          int16_t dictCode = pColInfoData->varmeta.dictCode[j];
+          if (pDictHash[dictCode] == 0) {
+            char* val = colDataGetVarData(pColInfoData, j);
+            pDictHash[dictCode] = MurmurHash3_32(varDataVal(val), varDataLen(val)) | 1;
+          }
+          h = pDictHash[dictCode];
+        }
+        pHash[j] = pHash[j] * 31 + h;
+      }
+    } else if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
+      for (int32_t j = 0; j < rows; ++j) {
+        uint32_t h = GROUP_KEY_NULL_HASH;
+        if (!colDataIsNull_var(pColInfoData, j)) {
+          char* val = colDataGetVarData(pColInfoData, j);
+          h = MurmurHash3_32(varDataVal(val), varDataLen(val));
+        }
+        pHash[j] = pHash[j] * 31 + h;
+      }
+    } else {
+      int32_t bytes = pColInfoData->info.bytes;
+      char*   pData = pColInfoData->pData;
+      for (int32_t j = 0; j < rows; ++j) {
+        uint32_t h = GROUP_KEY_NULL_HASH;
+        if (!pColInfoData->hasNull || !colDataIsNull_f(pColInfoData->nullbitmap, j)) {
+          h = MurmurHash3_32(pData + j * bytes, bytes);
+        }
+        pHash[j] = pHash[j] * 31 + h;
+      }
+    }
+  }
+}
+
+static bool groupKeyRowEqual(const SArray* pGroupCols, const SSDataBlock* pBlock, int32_t r1, int32_t r2) {
+  size_t numOfGroupCols = taosArrayGetSize(pGroupCols);
+  for (int32_t i = 0; i < numOfGroupCols; ++i) {
+    SColumn*         pCol = taosArrayGet(pGroupCols, i);
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pCol->slotId);
+
+    bool isNull1 = colDataIsNull(pColInfoData, pBlock->info.rows, r1, NULL);
+    bool isNull2 = colDataIsNull(pColInfoData, pBlock->info.rows, r2, NULL);
+    if (isNull1 || isNull2) {
+      if (isNull1 != isNull2) {
+        return false;
+      }
+      continue;
+    }
+
+    if (colDataHasDict(pColInfoData)) {
+      if (pColInfoData->varmeta.dictCode[r1] != pColInfoData->varmeta.dictCode[r2]) {
+        return false;
+      }
+      continue;
+    }
+
+    char* v1 = colDataGetData(pColInfoData, r1);
+    char* v2 = colDataGetData(pColInfoData, r2);
+    if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
+      if (varDataLen(v1) != varDataLen(v2) || memcmp(varDataVal(v1), varDataVal(v2), varDataLen(v1)) != 0) {
+        return false;
+      }
+    } else if (memcmp(v1, v2, pColInfoData->info.bytes) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// A single dictionary group key column assigns the rows to groups by their codes, with no hash nor key compare.
+static int32_t groupBlockRowsByDict(SGroupBatchSupp* pSupp, const SColumnInfoData* pColInfoData, int32_t rows) {
+  int32_t* pCodeGroup = pSupp->pDictMap;  // the null rows use the last item
+  int32_t  dictSize = pColInfoData->varmeta.dictSize;
+  int32_t  num = 0;
+  memset(pCodeGroup, 0xFF, sizeof(int32_t) * (dictSize + 1));
+
+  for (int32_t j = 0; j < rows; ++j) {
+    int32_t dictCode = colDataIsNull_var(pColInfoData, j) ? dictSize : pColInfoData->varmeta.dictCode[j];
+    int32_t g = pCodeGroup[dictCode];
+    if (g == -1) {
+      g = num++;
+      pCodeGroup[dictCode] = g;
+      pSupp->pGroupRow[g] = j;
+      pSupp->pGroupStart[g] = 0;
+    }
+
+    pSupp->pRowGroup[j] = g;
+    pSupp->pGroupStart[g] += 1;
+  }
+
+  return num;
+}
+
+// Assign each row of the block to a group by probing a per-block open-addressing hash table.
+static int32_t groupBlockRowsByHash(SGroupBatchSupp* pSupp, const SArray* pGroupCols, const SSDataBlock* pBlock) {
+  int32_t rows = pBlock->info.rows;
+  hashGroupKeyColumns(pSupp, pGroupCols, pBlock, pSupp->pHash);
+
+  uint32_t mask = pSupp->numOfSlots - 1;
+  int32_t  num = 0;
+  memset(pSupp->pSlots, 0xFF, sizeof(int32_t) * pSupp->numOfSlots);
+
+  for (int32_t j = 0; j < rows; ++j) {
+    uint32_t h = pSupp->pHash[j];
+    uint32_t slot = h & mask;
+
+    while (1) {
+      int32_t g = pSupp->pSlots[slot];
+      if (g == -1) {
+        g = num++;
+        pSupp->pSlots[slot] = g;
+        pSupp->pGroupRow[g] = j;
+        pSupp->pGroupStart[g] = 0;
+        pSupp->pRowGroup[j] = g;
+        break;
+      }
+
+      int32_t firstRow = pSupp->pGroupRow[g];
+      if (pSupp->pHash[firstRow] == h && groupKeyRowEqual(pGroupCols, pBlock, firstRow, j)) {
+        pSupp->pRowGroup[j] = g;
+        break;
+      }
+
+      slot = (slot + 1) & mask;
+    }
+
+    pSupp->pGroupStart[pSupp->pRowGroup[j]] += 1;
+  }
+
+  return num;
+}
+
+// Assign each row of the block to a group, and build the selection vector that clusters the rows of the same group
+// together.
+static int32_t groupBlockRowsByKey(SGroupBatchSupp* pSupp, const SArray* pGroupCols, const SSDataBlock* pBlock,
+                                   int32_t* numOfGroups) {
+  int32_t rows = pBlock->info.rows;
+  int32_t code = ensureGroupBatchSupp(pSupp, rows);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SColumnInfoData* pDictCol = NULL;
+  if (taosArrayGetSize(pGroupCols) == 1) {
+    SColumn* pCol = taosArrayGet(pGroupCols, 0);
+    pDictCol = taosArrayGet(pBlock->pDataBlock, pCol->slotId);
+    if (!colDataHasDict(pDictCol) || ensureGroupDictMap(pSupp, pDictCol->varmeta.dictSize + 1) != TSDB_CODE_SUCCESS) {
+      pDictCol = NULL;
+    }
+  }
+
+  int32_t num = (pDictCol != NULL) ? groupBlockRowsByDict(pSupp, pDictCol, rows)
+                                   : groupBlockRowsByHash(pSupp, pGroupCols, pBlock);
+
+  // turn the group sizes into start offsets and scatter the row indexes
+  int32_t offset = 0;
+  for (int32_t g = 0; g < num; ++g) {
+    int32_t size = pSupp->pGroupStart[g];
+    pSupp->pGroupStart[g] = offset;
+    offset += size;
+  }
+
+  for (int32_t j = 0; j < rows; ++j) {
+    int32_t g = pSupp->pRowGroup[j];
+    pSupp->pSelection[pSupp->pGroupStart[g]++] = j;
+  }
+
+  // pGroupStart[g] now points to the end of group g, shift it back to the start offsets
+  for (int32_t g = num; g > 0; --g) {
+    pSupp->pGroupStart[g] = pSupp->pGroupStart[g - 1];
+  }
+  pSupp->pGroupStart[0] = 0;
+
+  *numOfGroups = num;
+  return TSDB_CODE_SUCCESS;
+}
+
+// the number of runs of consecutive rows of the input block, when the rows are visited group by group
+static int32_t countGroupRuns(const SGroupBatchSupp* pSupp, int32_t numOfGroups) {
+  int32_t numOfRuns = 0;
+  for (int32_t g = 0; g < numOfGroups; ++g) {
+    numOfRuns += 1;
+    for (int32_t k = pSupp->pGroupStart[g] + 1; k < pSupp->pGroupStart[g + 1]; ++k) {
+      if (pSupp->pSelection[k] != pSupp->pSelection[k - 1] + 1) {
+        numOfRuns += 1;
+      }
+    }
+  }
+
+  return numOfRuns;
+}
+
+static int32_t gatherGroupRows(SGroupBatchSupp* pSupp, const SSDataBlock* pBlock) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pSupp->pGather == NULL) {
+    pSupp->pGather = createOneDataBlock(pBlock, false);
+    if (pSupp->pGather == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  SSDataBlock* pGather = pSupp->pGather;
+  code = blockDataEnsureCapacity(pGather, pBlock->info.rows);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  size_t numOfSlots = taosArrayGetSize(pSupp->pInputSlots);
+  for (int32_t i = 0; i < numOfSlots; ++i) {
+    int32_t slotId = *(int32_t*)taosArrayGet(pSupp->pInputSlots, i);
+    code = colDataGather(taosArrayGet(pGather->pDataBlock, slotId), taosArrayGet(pBlock->pDataBlock, slotId),
+                         pSupp->pSelection, pBlock->info.rows);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  pGather->info.id = pBlock->info.id;
+  pGather->info.rows = pBlock->info.rows;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void doHashGroupbyAggBatch(SOperatorInfo* pOperator, SSDataBlock* pBlock, int32_t order, int32_t scanFlag) {
   SExecTaskInfo*        pTaskInfo = pOperator->pTaskInfo;
   SGroupbyOperatorInfo* pInfo = pOperator->info;
+  SGroupBatchSupp*      pSupp = &pInfo->batchSup;
+
+  SqlFunctionCtx* pCtx = pOperator->exprSupp.pCtx;
+  int32_t         numOfExprs = pOperator->exprSupp.numOfExprs;
+  int32_t         rows = pBlock->info.rows;
+
+  int32_t numOfGroups = 0;
+  int32_t code = groupBlockRowsByKey(pSupp, pInfo->pGroupCols, pBlock, &numOfGroups);
+  if (code != TSDB_CODE_SUCCESS) {
+    T_LONG_JMP(pTaskInfo->env, code);
+  }
+
+  // the aggregate functions only accept a range of rows, so the scattered rows of each group are gathered into a
+  // separate block, the input block keeps its rows in place.
+  int32_t numOfRuns = countGroupRuns(pSupp, numOfGroups);
+  bool    gather = numOfRuns > numOfGroups && (int64_t)numOfRuns * GROUP_BATCH_MIN_RUN_LEN > rows;
+  if (gather) {
+    code = gatherGroupRows(pSupp, pBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+
+    setInputDataBlock(&pOperator->exprSupp, pSupp->pGather, order, scanFlag, true);
+  }
+
+  for (int32_t g = 0; g < numOfGroups; ++g) {
+    int32_t start = pSupp->pGroupStart[g];
+    int32_t end = pSupp->pGroupStart[g + 1];
+
+    recordNewGroupKeys(pInfo->pGroupCols, pInfo->pGroupColVals, pBlock, pSupp->pGroupRow[g]);
+    int32_t len = buildGroupKeys(pInfo->keyBuf, pInfo->pGroupColVals);
+    int32_t ret = setGroupResultOutputBuf(pOperator, &(pInfo->binfo), numOfExprs, pInfo->keyBuf, len,
+                                          pBlock->info.id.groupId, pInfo->aggSup.pResultBuf, &pInfo->aggSup);
+    if (ret != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, TSDB_CODE_APP_ERROR);
+    }
+
+    if (gather) {
+      applyAggFunctionOnPartialTuples(pTaskInfo, pCtx, NULL, start, end - start, rows, numOfExprs);
+      doAssignGroupKeys(pCtx, numOfExprs, rows, start);
+      continue;
+    }
+
+    // rows of the same group keep the input order in pSelection, apply the functions on each run of them
+    for (int32_t k = start; k < end;) {
+      int32_t rowIndex = pSupp->pSelection[k];
+      int32_t num = 1;
+      while (k + num < end && pSupp->pSelection[k + num] == rowIndex + num) {
+        num += 1;
+      }
+
+      applyAggFunctionOnPartialTuples(pTaskInfo, pCtx, NULL, rowIndex, num, rows, numOfExprs);
+      k += num;
+    }
+
+    doAssignGroupKeys(pCtx, numOfExprs, rows, pSupp->pGroupRow[g]);
+  }
+
+  // the keys of the last group are kept in pGroupColVals, continue from there if the next block takes the row path
+  pInfo->isInit = (numOfGroups > 0);
+}
+
+static void doHashGroupbyAgg(SOperatorInfo* pOperator, SSDataBlock* pBlock, int32_t order, int32_t scanFlag) {
+  SExecTaskInfo*        pTaskInfo = pOperator->pTaskInfo;
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+
+  // the block-wise sma can not be split into groups, fall back to the row by row path
+  if (pInfo->batchGroup && pBlock->pBlockAgg == NULL) {
+    doHashGroupbyAggBatch(pOperator, pBlock, order, scanFlag);
+    return;
+  }
 
   SqlFunctionCtx* pCtx = pOperator->exprSupp.pCtx;
   int32_t         numOfGroupCols = taosArrayGetSize(pInfo->pGroupCols);
@@ -401,7 +829,7 @@ static SSDataBlock* hashGroupbyAggregate(SOperatorInfo* pOperator) {
       }
     }
 
-    doHashGroupbyAgg(pOperator, pBlock);
+    doHashGroupbyAgg(pOperator, pBlock, order, scanFlag);
   }
 
   pOperator->status = OP_RES_TO_RETURN;
@@ -456,6 +884,15 @@ SOperatorInfo* createGroupOperatorInfo(SOperatorInfo* downstream, SAggPhysiNode*
     goto _error;
   }
 
+  pInfo->batchGroup = true;
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pGroupCols); ++i) {
+    SColumn* pCol = taosArrayGet(pInfo->pGroupCols, i);
+    if (pCol->type == TSDB_DATA_TYPE_JSON) {
+      pInfo->batchGroup = false;
+      break;
+    }
+  }
+
   int32_t    num = 0;
   SExprInfo* pExprInfo = createExprInfo(pAggNode->pAggFuncs, pAggNode->pGroupKeys, &num);
   code = initAggSup(&pOperator->exprSupp, &pInfo->aggSup, pExprInfo, num, pInfo->groupKeyLen, pTaskInfo->id.str,
@@ -464,6 +901,11 @@ SOperatorInfo* createGroupOperatorInfo(SOperatorInfo* downstream, SAggPhysiNode*
     goto _error;
   }
 
+  code = initGroupBatchInputSlots(&pInfo->batchSup, &pOperator->exprSupp);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
   code = filterInitFromNode((SNode*)pAggNode->node.pConditions, &pOperator->exprSupp.pFilterInfo, 0);
   if (code != TSDB_CODE_SUCCESS) {
     goto _error;
@@ -789,6 +789,13 @@ static int32_t getTableScannerExecInfo(struct SOperatorInfo* pOptr, void** pOptr
   SFileBlockLoadRecorder* pRecorder = taosMemoryCalloc(1, sizeof(SFileBlockLoadRecorder));
   STableScanInfo*         pTableScanInfo = pOptr->info;
   *pRecorder = pTableScanInfo->base.readRecorder;
+  if (pTableScanInfo->base.dataReader != NULL) {
+    int64_t nHit = 0;
+    int64_t nMiss = 0;
+    tsdbReaderGetPgCacheStat(pTableScanInfo->base.dataReader, &nHit, &nMiss);
+    pRecorder->pageCacheHits = nHit;
+    pRecorder->pageCacheMisses = nMiss;
+  }
   *pOptrExplain = pRecorder;
   *len = sizeof(SFileBlockLoadRecorder);
   return 0;
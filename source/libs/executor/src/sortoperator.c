@@ -35,7 +35,6 @@ static int32_t      getExplainExecInfo(SOperatorInfo* pOptr, void** pOptrExplain
 
 static void destroySortOperatorInfo(void* param);
 
-// todo add limit/offset impl
 SOperatorInfo* createSortOperatorInfo(SOperatorInfo* downstream, SSortPhysiNode* pSortNode, SExecTaskInfo* pTaskInfo) {
   SSortOperatorInfo* pInfo = taosMemoryCalloc(1, sizeof(SSortOperatorInfo));
   SOperatorInfo*     pOperator = taosMemoryCalloc(1, sizeof(SOperatorInfo));
@@ -191,6 +190,12 @@ int32_t doOpenSortOperator(SOperatorInfo* pOperator) {
 
   tsortSetFetchRawDataFp(pInfo->pSortHandle, loadNextDataBlock, applyScalarFunction, pOperator);
 
+  // only the first offset + limit rows are required if no filter is applied on the sorted results
+  SLimit* pLimit = &pInfo->limitInfo.limit;
+  if (pLimit->limit > 0 && pOperator->exprSupp.pFilterInfo == NULL) {
+    tsortSetMaxRows(pInfo->pSortHandle, pLimit->limit + TMAX(pLimit->offset, 0));
+  }
+
   SSortSource* ps = taosMemoryCalloc(1, sizeof(SSortSource));
   ps->param = pOperator->pDownstream[0];
   ps->onlyRef = true;
@@ -236,7 +241,6 @@ SSDataBlock* doSort(SOperatorInfo* pOperator) {
       continue;
     }
 
-    // todo add the limit/offset info
     if (pInfo->limitInfo.remainOffset > 0) {
       if (pInfo->limitInfo.remainOffset >= blockDataGetNumOfRows(pBlock)) {
         pInfo->limitInfo.remainOffset -= pBlock->info.rows;
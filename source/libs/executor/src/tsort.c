@@ -19,8 +19,10 @@
 #include "tcompare.h"
 #include "tdatablock.h"
 #include "tdef.h"
+#include "tglobal.h"
 #include "tlosertree.h"
 #include "tpagedbuf.h"
+#include "tsched.h"
 #include "tsort.h"
 #include "tutil.h"
 
@@ -56,9 +58,18 @@ struct SSortHandle {
   _sort_fetch_block_fn_t  fetchfp;
   _sort_merge_compar_fn_t comparFn;
   SMultiwayMergeTreeInfo* pMergeTree;
+
+  uint64_t maxRows;      // only the first maxRows rows in order are required, 0 means all rows
+  bool     topNTrimmed;  // rows behind the first maxRows ones have been dropped from pDataBlock at least once
+
+  char*   pSortKeys;    // normalized sort keys of the block in the in-memory sort
+  int32_t keyCapacity;  // number of rows pSortKeys is allocated for
+  SArray* pRunTasks;    // SArray<SSortRunTask*>, runs being sorted by the sort thread pool
+  size_t  runTaskSize;  // total size of the runs in pRunTasks, charged to the sort buffer
 };
 
 static int32_t msortComparFn(const void* pLeft, const void* pRight, void* param);
+static int32_t doFinishAllSortRunTasks(SSortHandle* pHandle, bool flush);
 
 SSDataBlock* tsortGetSortedDataBlock(const SSortHandle* pSortHandle) {
   return createOneDataBlock(pSortHandle->pDataBlock, false);
@@ -84,8 +95,10 @@ SSortHandle* tsortCreateSortHandle(SArray* pSortInfo, int32_t type, int32_t page
   }
 
   pSortHandle->pOrderedSource = taosArrayInit(4, POINTER_BYTES);
+  pSortHandle->pRunTasks = taosArrayInit(4, POINTER_BYTES);
   pSortHandle->cmpParam.orderInfo = pSortInfo;
   pSortHandle->cmpParam.cmpGroupId = false;
+  pSortHandle->cmpParam.keyLen = -1;
 
   tsortSetComparFp(pSortHandle, msortComparFn);
 
@@ -101,6 +114,7 @@ static int32_t sortComparCleanup(SMsortComparParam* cmpParam) {
   for (int32_t i = 0; i < cmpParam->numOfSources; ++i) {
     SSortSource* pSource = cmpParam->pSources[i];
     blockDataDestroy(pSource->src.pBlock);
+    taosMemoryFreeClear(pSource->pSortKeys);
     taosMemoryFreeClear(pSource);
   }
 
@@ -121,6 +135,7 @@ void tsortClearOrderdSource(SArray *pOrderedSource) {
     if ((*pSource)->param && !(*pSource)->onlyRef) {
       taosMemoryFree((*pSource)->param);
     }
+    taosMemoryFreeClear((*pSource)->pSortKeys);
     taosMemoryFreeClear(*pSource);
   }
 
@@ -133,6 +148,9 @@ void tsortDestroySortHandle(SSortHandle* pSortHandle) {
   }
 
   tsortClose(pSortHandle);
+  doFinishAllSortRunTasks(pSortHandle, false);
+  taosArrayDestroy(pSortHandle->pRunTasks);
+
   if (pSortHandle->pMergeTree != NULL) {
     tMergeTreeDestroy(pSortHandle->pMergeTree);
   }
@@ -140,6 +158,7 @@ void tsortDestroySortHandle(SSortHandle* pSortHandle) {
   destroyDiskbasedBuf(pSortHandle->pBuf);
   taosMemoryFreeClear(pSortHandle->idStr);
   blockDataDestroy(pSortHandle->pDataBlock);
+  taosMemoryFreeClear(pSortHandle->pSortKeys);
 
   tsortClearOrderdSource(pSortHandle->pOrderedSource);
   taosArrayDestroy(pSortHandle->pOrderedSource);
@@ -151,6 +170,389 @@ int32_t tsortAddSource(SSortHandle* pSortHandle, void* pSource) {
   return TSDB_CODE_SUCCESS;
 }
 
+//=====================================================================================
+// Normalized sort keys
+//
+// Each row is encoded into a fixed-length binary key, so that memcmp of two keys gives the order of the two rows.
+// For every order column the key holds a null flag byte followed by the value in big-endian order with the sign bit
+// flipped, nulls first/last and DESC are baked into the bytes. A var data value keeps at most TSORT_KEY_VAR_PREFIX
+// bytes and the key stops right after a truncated value, so the columns still need to be compared for equal keys
+// if the key is not complete.
+#define TSORT_KEY_VAR_PREFIX    16
+#define TSORT_RADIX_MAX_KEY_LEN 32
+
+typedef struct SSortKeyHelper {
+  const char*        pKeys;
+  int32_t            keyLen;
+  bool               complete;
+  SArray*            pOrderInfo;
+  const SSDataBlock* pBlock;
+} SSortKeyHelper;
+
+static int32_t compareTuple(SArray* pOrderInfo, const SSDataBlock* pLeftBlock, int32_t leftIndex,
+                            const SSDataBlock* pRightBlock, int32_t rightIndex) {
+  for (int32_t i = 0; i < pOrderInfo->size; ++i) {
+    SBlockOrderInfo* pOrder = TARRAY_GET_ELEM(pOrderInfo, i);
+    SColumnInfoData* pLeftColInfoData = TARRAY_GET_ELEM(pLeftBlock->pDataBlock, pOrder->slotId);
+    SColumnInfoData* pRightColInfoData = TARRAY_GET_ELEM(pRightBlock->pDataBlock, pOrder->slotId);
+
+    bool leftNull = pLeftColInfoData->hasNull && colDataIsNull_s(pLeftColInfoData, leftIndex);
+    bool rightNull = pRightColInfoData->hasNull && colDataIsNull_s(pRightColInfoData, rightIndex);
+
+    if (leftNull && rightNull) {
+      continue;
+    }
+
+    if (rightNull) {
+      return pOrder->nullFirst ? 1 : -1;
+    }
+
+    if (leftNull) {
+      return pOrder->nullFirst ? -1 : 1;
+    }
+
+    void* left1 = colDataGetData(pLeftColInfoData, leftIndex);
+    void* right1 = colDataGetData(pRightColInfoData, rightIndex);
+
+    __compar_fn_t fn = getKeyComparFunc(pLeftColInfoData->info.type, pOrder->order);
+
+    int ret = fn(left1, right1);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+static int32_t getSortKeyColLen(const SColumnInfoData* pCol, bool* truncated) {
+  *truncated = false;
+
+  switch (pCol->info.type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+    case TSDB_DATA_TYPE_UTINYINT:
+    case TSDB_DATA_TYPE_SMALLINT:
+    case TSDB_DATA_TYPE_USMALLINT:
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_UINT:
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_UBIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+    case TSDB_DATA_TYPE_FLOAT:
+    case TSDB_DATA_TYPE_DOUBLE:
+      return pCol->info.bytes;
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR: {
+      int32_t maxLen = pCol->info.bytes - VARSTR_HEADER_SIZE;
+      if (maxLen > TSORT_KEY_VAR_PREFIX) {
+        *truncated = true;
+        // the length goes before the value of nchar, since nchar values are compared by length first
+        return TSORT_KEY_VAR_PREFIX + ((pCol->info.type == TSDB_DATA_TYPE_NCHAR) ? VARSTR_HEADER_SIZE : 0);
+      }
+      return maxLen + VARSTR_HEADER_SIZE;
+    }
+    default:
+      return -1;
+  }
+}
+
+static int32_t getSortKeyLen(SArray* pOrderInfo, const SSDataBlock* pBlock, bool* complete) {
+  int32_t keyLen = 0;
+  *complete = true;
+
+  for (int32_t i = 0; i < taosArrayGetSize(pOrderInfo); ++i) {
+    SBlockOrderInfo* pOrder = taosArrayGet(pOrderInfo, i);
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, pOrder->slotId);
+
+    bool    truncated = false;
+    int32_t len = getSortKeyColLen(pCol, &truncated);
+    if (len < 0) {
+      *complete = false;
+      return 0;
+    }
+
+    keyLen += 1 + len;
+    if (truncated) {
+      *complete = false;
+      break;
+    }
+  }
+
+  return keyLen;
+}
+
+static void initSortKeyLen(SMsortComparParam* pParam, const SSDataBlock* pBlock) {
+  if (pParam->keyLen < 0) {
+    pParam->keyLen = getSortKeyLen(pParam->orderInfo, pBlock, &pParam->keyComplete);
+  }
+}
+
+static void putSortKeyUint(uint8_t* p, uint64_t v, int32_t bytes) {
+  for (int32_t k = bytes - 1; k >= 0; --k) {
+    p[k] = (uint8_t)v;
+    v >>= 8;
+  }
+}
+
+static void putSortKeyVar(uint8_t* p, const char* val, int32_t len, bool truncated, bool lenFirst) {
+  int32_t n = varDataLen(val);
+  if (lenFirst) {
+    putSortKeyUint(p, n, VARSTR_HEADER_SIZE);
+    p += VARSTR_HEADER_SIZE;
+  }
+
+  int32_t contentLen = truncated ? TSORT_KEY_VAR_PREFIX : len - VARSTR_HEADER_SIZE;
+  int32_t copyLen = TMIN(n, contentLen);
+  memcpy(p, varDataVal(val), copyLen);
+  memset(p + copyLen, 0, contentLen - copyLen);
+
+  // shorter binary value goes first if the prefix is the same
+  if (!lenFirst && !truncated) {
+    putSortKeyUint(p + contentLen, n, VARSTR_HEADER_SIZE);
+  }
+}
+
+static void putSortKeyValue(const SColumnInfoData* pCol, int32_t row, uint8_t* p, int32_t len, bool truncated) {
+  const char* val = colDataGetData(pCol, row);
+
+  switch (pCol->info.type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      putSortKeyUint(p, (uint8_t)(*(int8_t*)val) ^ 0x80u, 1);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      putSortKeyUint(p, (uint16_t)(*(int16_t*)val) ^ 0x8000u, 2);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      putSortKeyUint(p, (uint32_t)(*(int32_t*)val) ^ 0x80000000u, 4);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      putSortKeyUint(p, (uint64_t)(*(int64_t*)val) ^ 0x8000000000000000ull, 8);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      putSortKeyUint(p, *(uint8_t*)val, 1);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      putSortKeyUint(p, *(uint16_t*)val, 2);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      putSortKeyUint(p, *(uint32_t*)val, 4);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      putSortKeyUint(p, *(uint64_t*)val, 8);
+      break;
+    case TSDB_DATA_TYPE_FLOAT: {
+      // NaN is the smallest value in compareFloatVal, and -0.0 is equal to 0.0
+      float    f = GET_FLOAT_VAL(val);
+      uint32_t u = 0;
+      if (!isnan(f)) {
+        f = (f == 0) ? 0 : f;
+        memcpy(&u, &f, sizeof(u));
+        u = (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+      }
+      putSortKeyUint(p, u, 4);
+      break;
+    }
+    case TSDB_DATA_TYPE_DOUBLE: {
+      double   d = GET_DOUBLE_VAL(val);
+      uint64_t u = 0;
+      if (!isnan(d)) {
+        d = (d == 0) ? 0 : d;
+        memcpy(&u, &d, sizeof(u));
+        u = (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+      }
+      putSortKeyUint(p, u, 8);
+      break;
+    }
+    case TSDB_DATA_TYPE_BINARY:
+      putSortKeyVar(p, val, len, truncated, false);
+      break;
+    case TSDB_DATA_TYPE_NCHAR:
+      putSortKeyVar(p, val, len, truncated, true);
+      break;
+    default:
+      ASSERT(0);
+  }
+}
+
+// build the keys column by column, the key of the j-th row starts at pKeys + j * keyLen
+static void buildSortKeys(SArray* pOrderInfo, const SSDataBlock* pBlock, int32_t keyLen, char* pKeys) {
+  int32_t rows = pBlock->info.rows;
+  int32_t offset = 0;
+
+  for (int32_t i = 0; i < taosArrayGetSize(pOrderInfo) && offset < keyLen; ++i) {
+    SBlockOrderInfo* pOrder = taosArrayGet(pOrderInfo, i);
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, pOrder->slotId);
+
+    bool    truncated = false;
+    int32_t len = getSortKeyColLen(pCol, &truncated);
+    bool    desc = (pOrder->order == TSDB_ORDER_DESC);
+    uint8_t nullFlag = pOrder->nullFirst ? 0 : 1;
+
+    for (int32_t j = 0; j < rows; ++j) {
+      uint8_t* p = (uint8_t*)pKeys + (int64_t)j * keyLen + offset;
+      if (pCol->hasNull && colDataIsNull_s(pCol, j)) {
+        p[0] = nullFlag;
+        memset(p + 1, 0, len);
+        continue;
+      }
+
+      p[0] = nullFlag ^ 1;
+      putSortKeyValue(pCol, j, p + 1, len, truncated);
+      if (desc) {
+        for (int32_t k = 1; k <= len; ++k) {
+          p[k] = ~p[k];
+        }
+      }
+    }
+
+    offset += 1 + len;
+  }
+}
+
+static int32_t ensureSortKeyBuf(char** pKeys, int32_t* capacity, int32_t rows, int32_t keyLen) {
+  if (*capacity >= rows) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  char* p = taosMemoryRealloc(*pKeys, (int64_t)rows * keyLen);
+  if (p == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  *pKeys = p;
+  *capacity = rows;
+  return TSDB_CODE_SUCCESS;
+}
+
+// build the normalized sort keys of a newly loaded source block, used by msortComparFn during merge
+static int32_t setSourceSortKeys(SSortHandle* pHandle, SSortSource* pSource) {
+  SSDataBlock* pBlock = pSource->src.pBlock;
+  if (pHandle->comparFn != msortComparFn || pBlock == NULL || pBlock->info.rows == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  initSortKeyLen(&pHandle->cmpParam, pBlock);
+  int32_t keyLen = pHandle->cmpParam.keyLen;
+  if (keyLen <= 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = ensureSortKeyBuf(&pSource->pSortKeys, &pSource->keyCapacity, pBlock->info.rows, keyLen);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  buildSortKeys(pHandle->cmpParam.orderInfo, pBlock, keyLen, pSource->pSortKeys);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t sortKeyIndexCompar(const void* p1, const void* p2, const void* param) {
+  const SSortKeyHelper* pHelper = param;
+  int32_t               left = *(int32_t*)p1;
+  int32_t               right = *(int32_t*)p2;
+
+  // taosqsort takes only 1 as greater
+  int32_t ret = memcmp(pHelper->pKeys + (int64_t)left * pHelper->keyLen,
+                       pHelper->pKeys + (int64_t)right * pHelper->keyLen, pHelper->keyLen);
+  if (ret != 0) {
+    return ret < 0 ? -1 : 1;
+  }
+
+  if (pHelper->complete) {
+    return 0;
+  }
+
+  return compareTuple(pHelper->pOrderInfo, pHelper->pBlock, left, pHelper->pBlock, right);
+}
+
+// LSD radix sort of the row indexes on the key bytes, the passes on bytes that are the same for all rows are skipped
+static void radixSortByKeys(const char* pKeys, int32_t keyLen, int32_t rows, int32_t* index, int32_t* tmp) {
+  int32_t* pSrc = index;
+  int32_t* pDst = tmp;
+  int32_t  count[256];
+
+  for (int32_t b = keyLen - 1; b >= 0; --b) {
+    memset(count, 0, sizeof(count));
+    for (int32_t j = 0; j < rows; ++j) {
+      count[(uint8_t)pKeys[(int64_t)j * keyLen + b]] += 1;
+    }
+
+    if (count[(uint8_t)pKeys[b]] == rows) {
+      continue;
+    }
+
+    int32_t offset = 0;
+    for (int32_t k = 0; k < 256; ++k) {
+      int32_t c = count[k];
+      count[k] = offset;
+      offset += c;
+    }
+
+    for (int32_t j = 0; j < rows; ++j) {
+      int32_t row = pSrc[j];
+      pDst[count[(uint8_t)pKeys[(int64_t)row * keyLen + b]]++] = row;
+    }
+
+    TSWAP(pSrc, pDst);
+  }
+
+  if (pSrc != index) {
+    memcpy(index, pSrc, sizeof(int32_t) * rows);
+  }
+}
+
+// Sort the block on the normalized keys, and fall back to blockDataSort if the keys are not available for the order
+// columns. Only the given key buffer is written, so blocks can be sorted in different threads with a private copy of
+// pOrderInfo, which is updated by blockDataSort.
+static int32_t sortBlockOnKeys(SSDataBlock* pBlock, SArray* pOrderInfo, int32_t keyLen, bool keyComplete,
+                               char** pKeys, int32_t* keyCapacity) {
+  int32_t rows = pBlock->info.rows;
+  if (rows <= 1) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (keyLen <= 0) {
+    return blockDataSort(pBlock, pOrderInfo);
+  }
+
+  int32_t code = ensureSortKeyBuf(pKeys, keyCapacity, rows, keyLen);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  int32_t* index = taosMemoryMalloc(sizeof(int32_t) * rows * 2);
+  if (index == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t j = 0; j < rows; ++j) {
+    index[j] = j;
+  }
+
+  buildSortKeys(pOrderInfo, pBlock, keyLen, *pKeys);
+
+  if (keyComplete && keyLen <= TSORT_RADIX_MAX_KEY_LEN) {
+    radixSortByKeys(*pKeys, keyLen, rows, index, index + rows);
+  } else {
+    SSortKeyHelper helper = {
+        .pKeys = *pKeys, .keyLen = keyLen, .complete = keyComplete, .pOrderInfo = pOrderInfo, .pBlock = pBlock};
+    taosqsort(index, rows, sizeof(int32_t), &helper, sortKeyIndexCompar);
+  }
+
+  code = blockDataReorder(pBlock, index);
+  taosMemoryFree(index);
+  return code;
+}
+
+static int32_t doSortDataBlock(SSortHandle* pHandle, SSDataBlock* pBlock) {
+  initSortKeyLen(&pHandle->cmpParam, pBlock);
+  return sortBlockOnKeys(pBlock, pHandle->pSortInfo, pHandle->cmpParam.keyLen, pHandle->cmpParam.keyComplete,
+                         &pHandle->pSortKeys, &pHandle->keyCapacity);
+}
+
 static int32_t doAddNewExternalMemSource(SDiskbasedBuf* pBuf, SArray* pAllSources, SSDataBlock* pBlock,
                                          int32_t* sourceId, SArray* pPageIdList) {
   SSortSource* pSource = taosMemoryCalloc(1, sizeof(SSortSource));
@@ -206,6 +608,7 @@ static int32_t doAddToBuf(SSDataBlock* pDataBlock, SSortHandle* pHandle) {
     void*   pPage = getNewBufPage(pHandle->pBuf, &pageId);
     if (pPage == NULL) {
       blockDataDestroy(p);
+      taosArrayDestroy(pPageIdList);
       return terrno;
     }
 
@@ -229,6 +632,146 @@ static int32_t doAddToBuf(SSDataBlock* pDataBlock, SSortHandle* pHandle) {
   return doAddNewExternalMemSource(pHandle->pBuf, pHandle->pOrderedSource, pBlock, &pHandle->sourceId, pPageIdList);
 }
 
+//=====================================================================================
+// Parallel run generation
+//
+// The full in-memory buffer of the single source sort is handed over to the sort thread pool, and the query thread
+// goes on loading data into a new buffer. The sorted runs are flushed into the disk buffer by the query thread in the
+// order they were generated, since SDiskbasedBuf is not thread safe.
+#define TSORT_MAX_RUN_TASKS 8
+
+typedef struct SSortRunTask {
+  SSDataBlock* pBlock;
+  size_t       size;
+  SArray*      pOrderInfo;  // private copy of the order info, blockDataSort updates it
+  int32_t      keyLen;
+  bool         keyComplete;
+  char*        pSortKeys;
+  int32_t      keyCapacity;
+  int32_t      code;
+  int64_t      elapsed;
+  tsem_t       ready;
+} SSortRunTask;
+
+static SSchedQueue  sortQueue = {0};
+static TdThreadOnce sortQueueInit = PTHREAD_ONCE_INIT;
+static bool         sortQueueReady = false;
+
+static void cleanupSortQueue() { taosCleanUpScheduler(&sortQueue); }
+
+static void initSortQueue() {
+  if (tsNumOfSortThreads <= 0) {
+    return;
+  }
+
+  if (taosInitScheduler(1024, tsNumOfSortThreads, "sort", &sortQueue) == NULL) {
+    qError("failed to init sort thread pool, runs are sorted by the query thread");
+    return;
+  }
+
+  sortQueueReady = true;
+  atexit(cleanupSortQueue);
+}
+
+static bool isParallelSortAvailable() {
+  taosThreadOnce(&sortQueueInit, initSortQueue);
+  return sortQueueReady;
+}
+
+static void doSortRunTask(SSchedMsg* pMsg) {
+  SSortRunTask* pTask = pMsg->ahandle;
+
+  int64_t st = taosGetTimestampUs();
+  pTask->code = sortBlockOnKeys(pTask->pBlock, pTask->pOrderInfo, pTask->keyLen, pTask->keyComplete,
+                                &pTask->pSortKeys, &pTask->keyCapacity);
+  pTask->elapsed = taosGetTimestampUs() - st;
+
+  tsem_post(&pTask->ready);
+}
+
+static void destroySortRunTask(SSortRunTask* pTask) {
+  blockDataDestroy(pTask->pBlock);
+  taosArrayDestroy(pTask->pOrderInfo);
+  taosMemoryFree(pTask->pSortKeys);
+  tsem_destroy(&pTask->ready);
+  taosMemoryFree(pTask);
+}
+
+// wait for the oldest run to be sorted and flush it into the disk buffer as a new source
+static int32_t doFinishSortRunTask(SSortHandle* pHandle, bool flush) {
+  SSortRunTask* pTask = *(SSortRunTask**)taosArrayGet(pHandle->pRunTasks, 0);
+  taosArrayRemove(pHandle->pRunTasks, 0);
+  pHandle->runTaskSize -= pTask->size;
+
+  tsem_wait(&pTask->ready);
+  pHandle->sortElapsed += pTask->elapsed;
+
+  int32_t code = pTask->code;
+  if (flush && code == TSDB_CODE_SUCCESS) {
+    code = doAddToBuf(pTask->pBlock, pHandle);
+  }
+
+  destroySortRunTask(pTask);
+  return code;
+}
+
+static int32_t doFinishAllSortRunTasks(SSortHandle* pHandle, bool flush) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  while (taosArrayGetSize(pHandle->pRunTasks) > 0) {
+    int32_t ret = doFinishSortRunTask(pHandle, flush && (code == TSDB_CODE_SUCCESS));
+    if (code == TSDB_CODE_SUCCESS) {
+      code = ret;
+    }
+  }
+
+  return code;
+}
+
+// the number of runs of one sort handle in the sort thread pool
+static int32_t getMaxSortRunTasks() { return TRANGE(tsNumOfSortThreads, 1, TSORT_MAX_RUN_TASKS); }
+
+static int32_t doAddToBufAsync(SSortHandle* pHandle) {
+  if (taosArrayGetSize(pHandle->pRunTasks) >= getMaxSortRunTasks()) {
+    int32_t code = doFinishSortRunTask(pHandle, true);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  initSortKeyLen(&pHandle->cmpParam, pHandle->pDataBlock);
+
+  SSortRunTask* pTask = taosMemoryCalloc(1, sizeof(SSortRunTask));
+  if (pTask == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SSDataBlock* pNewBuf = createOneDataBlock(pHandle->pDataBlock, false);
+  pTask->pOrderInfo = taosArrayDup(pHandle->pSortInfo, NULL);
+  if (pNewBuf == NULL || pTask->pOrderInfo == NULL) {
+    blockDataDestroy(pNewBuf);
+    taosArrayDestroy(pTask->pOrderInfo);
+    taosMemoryFree(pTask);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pTask->pBlock = pHandle->pDataBlock;
+  pTask->size = blockDataGetSize(pTask->pBlock);
+  pTask->keyLen = pHandle->cmpParam.keyLen;
+  pTask->keyComplete = pHandle->cmpParam.keyComplete;
+  tsem_init(&pTask->ready, 0, 0);
+
+  pHandle->pDataBlock = pNewBuf;
+  pHandle->runTaskSize += pTask->size;
+  taosArrayPush(pHandle->pRunTasks, &pTask);
+
+  SSchedMsg msg = {.fp = doSortRunTask, .ahandle = pTask};
+  if (taosScheduleTask(&sortQueue, &msg) != 0) {
+    doSortRunTask(&msg);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static void setCurrentSourceDone(SSortSource* pSource, SSortHandle* pHandle) {
   pSource->src.rowIndex = -1;
   ++pHandle->numOfCompletedSources;
@@ -276,6 +819,11 @@ static int32_t sortComparInit(SMsortComparParam* pParam, SArray* pSources, int32
       }
 
       releaseBufPage(pHandle->pBuf, pPage);
+
+      code = setSourceSortKeys(pHandle, pSource);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
     }
   } else {
     qDebug("start init for the multiway merge sort, %s", pHandle->idStr);
@@ -288,6 +836,12 @@ static int32_t sortComparInit(SMsortComparParam* pParam, SArray* pSources, int32
       // set current source is done
       if (pSource->src.pBlock == NULL) {
         setCurrentSourceDone(pSource, pHandle);
+        continue;
+      }
+
+      code = setSourceSortKeys(pHandle, pSource);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
       }
     }
 
@@ -343,12 +897,22 @@ static int32_t adjustMergeTreeForNextTuple(SSortSource* pSource, SMultiwayMergeT
         }
 
         releaseBufPage(pHandle->pBuf, pPage);
+
+        code = setSourceSortKeys(pHandle, pSource);
+        if (code != TSDB_CODE_SUCCESS) {
+          return code;
+        }
       }
     } else {
       pSource->src.pBlock = pHandle->fetchfp(((SSortSource*)pSource)->param);
       if (pSource->src.pBlock == NULL) {
         (*numOfCompleted) += 1;
         pSource->src.rowIndex = -1;
+      } else {
+        int32_t code = setSourceSortKeys(pHandle, pSource);
+        if (code != TSDB_CODE_SUCCESS) {
+          return code;
+        }
       }
     }
   }
@@ -429,6 +993,19 @@ int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
     }
   }
 
+  if (pParam->keyLen > 0) {
+    int32_t keyLen = pParam->keyLen;
+    int32_t ret = memcmp(pLeftSource->pSortKeys + (int64_t)pLeftSource->src.rowIndex * keyLen,
+                         pRightSource->pSortKeys + (int64_t)pRightSource->src.rowIndex * keyLen, keyLen);
+    if (ret != 0) {
+      return ret < 0 ? -1 : 1;
+    }
+
+    if (pParam->keyComplete) {
+      return 0;
+    }
+  }
+
   for (int32_t i = 0; i < pInfo->size; ++i) {
     SBlockOrderInfo* pOrder = TARRAY_GET_ELEM(pInfo, i);
     SColumnInfoData* pLeftColInfoData = TARRAY_GET_ELEM(pLeftBlock->pDataBlock, pOrder->slotId);
@@ -615,8 +1192,94 @@ int32_t getProperSortPageSize(size_t rowSize, uint32_t numOfCols) {
   return pgSize;
 }
 
+// number of rows the top-N buffer may hold before it is sorted and trimmed back to maxRows rows
+static int64_t getTopNBufRows(const SSortHandle* pHandle) { return TMAX((int64_t)pHandle->maxRows * 2, 4096); }
+
+// The bounded top-N buffer is used only if it always fits in the sort buffer, otherwise the external sort is used.
+static bool isTopNBufAvailable(const SSortHandle* pHandle, size_t rowSize, size_t sortBufSize) {
+  if (pHandle->maxRows == 0 || pHandle->maxRows > INT32_MAX) {
+    return false;
+  }
+
+  // bufRows * rowSize <= sortBufSize, without the overflow of the product
+  uint64_t bufRows = getTopNBufRows(pHandle);
+  return rowSize == 0 || bufRows <= sortBufSize / rowSize;
+}
+
+static int32_t doSortAndKeepTopNRows(SSortHandle* pHandle) {
+  int64_t p = taosGetTimestampUs();
+
+  int32_t code = doSortDataBlock(pHandle, pHandle->pDataBlock);
+  if (code != 0) {
+    return code;
+  }
+
+  pHandle->sortElapsed += taosGetTimestampUs() - p;
+
+  if (pHandle->pDataBlock->info.rows <= pHandle->maxRows) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SSDataBlock* pBlock = blockDataExtractBlock(pHandle->pDataBlock, 0, pHandle->maxRows);
+  if (pBlock == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  blockDataDestroy(pHandle->pDataBlock);
+  pHandle->pDataBlock = pBlock;
+  pHandle->topNTrimmed = true;
+  return TSDB_CODE_SUCCESS;
+}
+
+// Keep only the rows that may still be among the first maxRows rows in the buffer, the buffer never goes to disk.
+static int32_t doAddToTopNBuf(SSDataBlock* pBlock, SSortHandle* pHandle) {
+  int32_t code = 0;
+  int64_t bufRows = getTopNBufRows(pHandle);
+
+  if (!pHandle->topNTrimmed) {
+    code = blockDataMerge(pHandle->pDataBlock, pBlock);
+    if (code != 0) {
+      return code;
+    }
+
+    if (pHandle->pDataBlock->info.rows < bufRows) {
+      return TSDB_CODE_SUCCESS;
+    }
+
+    code = doSortAndKeepTopNRows(pHandle);
+    if (code != 0) {
+      return code;
+    }
+
+    return blockDataEnsureCapacity(pHandle->pDataBlock, bufRows);
+  }
+
+  // The last row of the trimmed buffer is the current maxRows-th row, rows behind it can be discarded directly.
+  int32_t last = (int32_t)(pHandle->maxRows - 1);
+  for (int32_t i = 0; i < pBlock->info.rows;) {
+    if (compareTuple(pHandle->pSortInfo, pBlock, i, pHandle->pDataBlock, last) >= 0) {
+      i += 1;
+      continue;
+    }
+
+    appendOneRowToDataBlock(pHandle->pDataBlock, pBlock, &i);
+    if (pHandle->pDataBlock->info.rows >= bufRows) {
+      code = doSortAndKeepTopNRows(pHandle);
+      if (code == 0) {
+        code = blockDataEnsureCapacity(pHandle->pDataBlock, bufRows);
+      }
+      if (code != 0) {
+        return code;
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t createInitialSources(SSortHandle* pHandle) {
   size_t sortBufSize = pHandle->numOfPages * pHandle->pageSize;
+  size_t runBufSize = sortBufSize;  // the buffer being loaded is sorted and flushed as a run beyond this size
 
   if (pHandle->type == SORT_SINGLESOURCE_SORT) {
     SSortSource** pSource = taosArrayGet(pHandle->pOrderedSource, 0);
@@ -625,6 +1288,8 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
     
     tsortClearOrderdSource(pHandle->pOrderedSource);
 
+    bool topN = false;
+    bool parallel = false;
     while (1) {
       SSDataBlock* pBlock = pHandle->fetchfp(source->param);
       if (pBlock == NULL) {
@@ -638,40 +1303,51 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         // todo, number of pages are set according to the total available sort buffer
         pHandle->numOfPages = 1024;
         sortBufSize = pHandle->numOfPages * pHandle->pageSize;
+        runBufSize = sortBufSize;
         pHandle->pDataBlock = createOneDataBlock(pBlock, false);
+
+        topN = isTopNBufAvailable(pHandle, blockDataGetRowSize(pBlock), sortBufSize);
+        parallel = !topN && isParallelSortAvailable();
       }
 
       if (pHandle->beforeFp != NULL) {
         pHandle->beforeFp(pBlock, pHandle->param);
       }
 
-      int32_t code = blockDataMerge(pHandle->pDataBlock, pBlock);
+      int32_t code = topN ? doAddToTopNBuf(pBlock, pHandle) : blockDataMerge(pHandle->pDataBlock, pBlock);
+      size_t  size = blockDataGetSize(pHandle->pDataBlock);
+
+      // the runs in the sort thread pool and the buffer being loaded are charged to the sort buffer together
+      while (code == 0 && taosArrayGetSize(pHandle->pRunTasks) > 0 && pHandle->runTaskSize + size > sortBufSize) {
+        code = doFinishSortRunTask(pHandle, true);
+      }
+
+      if (code == 0 && !topN && size > runBufSize) {
+        if (parallel) {
+          code = doAddToBufAsync(pHandle);
+
+          // The data does not fit in memory. The following runs are smaller, so that several of them are sorted at
+          // the same time within the sort buffer.
+          runBufSize = sortBufSize / (getMaxSortRunTasks() + 1);
+        } else {
+          // Perform the in-memory sort and then flush data in the buffer into disk.
+          int64_t p = taosGetTimestampUs();
+          code = doSortDataBlock(pHandle, pHandle->pDataBlock);
+          pHandle->sortElapsed += taosGetTimestampUs() - p;
+          if (code == 0) {
+            code = doAddToBuf(pHandle->pDataBlock, pHandle);
+          }
+        }
+      }
+
       if (code != 0) {
+        doFinishAllSortRunTasks(pHandle, false);
         if (source->param && !source->onlyRef) {
           taosMemoryFree(source->param);
         }
         taosMemoryFree(source);
         return code;
       }
-
-      size_t size = blockDataGetSize(pHandle->pDataBlock);
-      if (size > sortBufSize) {
-        // Perform the in-memory sort and then flush data in the buffer into disk.
-        int64_t p = taosGetTimestampUs();
-        code = blockDataSort(pHandle->pDataBlock, pHandle->pSortInfo);
-        if (code != 0) {
-          if (source->param && !source->onlyRef) {
-            taosMemoryFree(source->param);
-          }
-          taosMemoryFree(source);
-          return code;
-        }
-
-        int64_t el = taosGetTimestampUs() - p;
-        pHandle->sortElapsed += el;
-
-        doAddToBuf(pHandle->pDataBlock, pHandle);
-      }
     }
 
     if (source->param && !source->onlyRef) {
@@ -679,19 +1355,34 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
     }
     taosMemoryFree(source);
 
+    // all runs in the sort thread pool must be in the disk buffer before the remaining data is handled
+    int32_t code = doFinishAllSortRunTasks(pHandle, true);
+    if (code != 0) {
+      return code;
+    }
+
     if (pHandle->pDataBlock != NULL && pHandle->pDataBlock->info.rows > 0) {
+      if (topN) {
+        int32_t code = doSortAndKeepTopNRows(pHandle);
+        if (code != 0) {
+          return code;
+        }
+      }
+
       size_t size = blockDataGetSize(pHandle->pDataBlock);
 
       // Perform the in-memory sort and then flush data in the buffer into disk.
-      int64_t p = taosGetTimestampUs();
+      if (!topN) {
+        int64_t p = taosGetTimestampUs();
 
-      int32_t code = blockDataSort(pHandle->pDataBlock, pHandle->pSortInfo);
-      if (code != 0) {
-        return code;
-      }
+        int32_t code = doSortDataBlock(pHandle, pHandle->pDataBlock);
+        if (code != 0) {
+          return code;
+        }
 
-      int64_t el = taosGetTimestampUs() - p;
-      pHandle->sortElapsed += el;
+        int64_t el = taosGetTimestampUs() - p;
+        pHandle->sortElapsed += el;
+      }
 
       // All sorted data can fit in memory, external memory sort is not needed. Return to directly
       if (size <= sortBufSize && pHandle->pBuf == NULL) {
@@ -773,6 +1464,11 @@ int32_t tsortSetCompareGroupId(SSortHandle* pHandle, bool compareGroupId) {
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t tsortSetMaxRows(SSortHandle* pHandle, uint64_t maxRows) {
+  pHandle->maxRows = maxRows;
+  return TSDB_CODE_SUCCESS;
+}
+
 STupleHandle* tsortNextTuple(SSortHandle* pHandle) {
   if (pHandle->cmpParam.numOfSources == pHandle->numOfCompletedSources) {
     return NULL;
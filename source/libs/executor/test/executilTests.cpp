@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+
+#include "executorimpl.h"
+#include "meta.h"
+
+namespace {
+
+const char    *kPath = TD_TMP_DIR_PATH "executilTest";
+const uint64_t kSuid = 1000000;
+
+SSchema schema(int8_t type, col_id_t colId, int32_t bytes, const char *name) {
+  SSchema s = {0};
+  s.type = type;
+  s.colId = colId;
+  s.bytes = bytes;
+  tstrncpy(s.name, name, TSDB_COL_NAME_LEN);
+  return s;
+}
+
+SNode *tagNode(int8_t type, col_id_t colId, int32_t bytes, const char *name) {
+  SColumnNode *pCol = (SColumnNode *)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->colType = COLUMN_TYPE_TAG;
+  pCol->colId = colId;
+  pCol->tableId = kSuid;
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = bytes;
+  tstrncpy(pCol->colName, name, TSDB_COL_NAME_LEN);
+  return (SNode *)pCol;
+}
+
+// t1 >= 2
+SNode *tagCond() {
+  SValueNode *pVal = (SValueNode *)nodesMakeNode(QUERY_NODE_VALUE);
+  pVal->node.resType.type = TSDB_DATA_TYPE_INT;
+  pVal->node.resType.bytes = sizeof(int32_t);
+  pVal->datum.i = 2;
+  pVal->typeData = 2;
+
+  SOperatorNode *pOp = (SOperatorNode *)nodesMakeNode(QUERY_NODE_OPERATOR);
+  pOp->opType = OP_TYPE_GREATER_EQUAL;
+  pOp->node.resType.type = TSDB_DATA_TYPE_BOOL;
+  pOp->node.resType.bytes = sizeof(bool);
+  pOp->pLeft = tagNode(TSDB_DATA_TYPE_INT, 3, sizeof(int32_t), "t1");
+  pOp->pRight = (SNode *)pVal;
+  return (SNode *)pOp;
+}
+
+class ExecutilTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { indexInit(1); }
+  static void TearDownTestSuite() { indexCleanup(); }
+
+  void SetUp() override {
+    cacheSize = tsMetaTagTableCacheSize;
+    taosRemoveDir(kPath);
+    taosMkDir(kPath);
+
+    memset(&vnode, 0, sizeof(vnode));
+    vnode.path = (char *)kPath;
+    vnode.config.vgId = 2;
+    vnode.config.szPage = 4096;
+    vnode.config.szCache = 256;
+    ASSERT_EQ(metaOpen(&vnode, &pMeta, 0), 0);
+    ASSERT_EQ(metaBegin(pMeta, META_BEGIN_HEAP_OS), 0);
+
+    SSchema aRow[] = {schema(TSDB_DATA_TYPE_TIMESTAMP, 1, 8, "ts"), schema(TSDB_DATA_TYPE_INT, 2, 4, "c1")};
+    SSchema aTag[] = {schema(TSDB_DATA_TYPE_INT, 3, sizeof(int32_t), "t1"),
+                      schema(TSDB_DATA_TYPE_VARCHAR, 4, 16 + VARSTR_HEADER_SIZE, "t2")};
+    SVCreateStbReq req = {0};
+    req.name = (char *)"stb";
+    req.suid = kSuid;
+    req.schemaRow = {2, 1, aRow};
+    req.schemaTag = {2, 1, aTag};
+    ASSERT_EQ(metaCreateSTable(pMeta, ++version, &req), 0);
+  }
+
+  void TearDown() override {
+    metaAbort(pMeta);
+    metaClose(pMeta);
+    taosRemoveDir(kPath);
+    tsMetaTagTableCacheSize = cacheSize;
+  }
+
+  void createCtb(int64_t uid) {
+    std::string name = "ctb" + std::to_string(uid);
+    std::string t2 = "g" + std::to_string(uid % 3);
+
+    SArray *aTagVal = taosArrayInit(2, sizeof(STagVal));
+    STagVal val = {0};
+    val.cid = 3;
+    val.type = TSDB_DATA_TYPE_INT;
+    val.i64 = uid % 7;
+    if (uid % 5 != 0) taosArrayPush(aTagVal, &val);
+    val.cid = 4;
+    val.type = TSDB_DATA_TYPE_VARCHAR;
+    val.pData = (uint8_t *)t2.data();
+    val.nData = t2.size();
+    if (uid % 11 != 0) taosArrayPush(aTagVal, &val);
+
+    STag *pTag = NULL;
+    ASSERT_EQ(tTagNew(aTagVal, 1, false, &pTag), 0);
+    taosArrayDestroy(aTagVal);
+
+    SVCreateTbReq req = {0};
+    req.name = (char *)name.c_str();
+    req.uid = uid;
+    req.type = TSDB_CHILD_TABLE;
+    req.ctb.stbName = (char *)"stb";
+    req.ctb.suid = kSuid;
+    req.ctb.pTag = (uint8_t *)pTag;
+    ASSERT_EQ(metaCreateTable(pMeta, ++version, &req, NULL), 0);
+    tTagFree(pTag);
+  }
+
+  void updateT1(int64_t uid, int32_t t1) {
+    std::string  name = "ctb" + std::to_string(uid);
+    SVAlterTbReq req = {0};
+    req.tbName = (char *)name.c_str();
+    req.action = TSDB_ALTER_TABLE_UPDATE_TAG_VAL;
+    req.tagName = (char *)"t1";
+    req.tagType = TSDB_DATA_TYPE_INT;
+    req.nTagVal = sizeof(t1);
+    req.pTagVal = (uint8_t *)&t1;
+    ASSERT_EQ(metaAlterTable(pMeta, ++version, &req, NULL), 0);
+  }
+
+  void dropCtb(int64_t uid) {
+    std::string name = "ctb" + std::to_string(uid);
+    SVDropTbReq req = {0};
+    req.name = (char *)name.c_str();
+    req.suid = kSuid;
+    ASSERT_EQ(metaDropTable(pMeta, ++version, &req, NULL, NULL), 0);
+  }
+
+  // the tables of "select ... from stb where t1 >= 2 partition by t2, t1" and the group each of them falls in
+  void tableGroups(int32_t cacheSize, std::map<uint64_t, uint64_t> &groups) {
+    tsMetaTagTableCacheSize = cacheSize;
+    metaUidCacheClear(pMeta, kSuid);
+
+    SScanPhysiNode scan = {};
+    scan.uid = kSuid;
+    scan.suid = kSuid;
+    scan.tableType = TSDB_SUPER_TABLE;
+
+    SNodeList *pGroupTags = nodesMakeList();
+    nodesListAppend(pGroupTags, tagNode(TSDB_DATA_TYPE_VARCHAR, 4, 16 + VARSTR_HEADER_SIZE, "t2"));
+    nodesListAppend(pGroupTags, tagNode(TSDB_DATA_TYPE_INT, 3, sizeof(int32_t), "t1"));
+    SNode *pTagCond = tagCond();
+
+    SReadHandle handle = {0};
+    handle.meta = pMeta;
+    SExecTaskInfo taskInfo = {0};
+    taskInfo.id.str = (char *)"executilTest";
+
+    STableListInfo *pList = tableListCreate();
+    ASSERT_EQ(createScanTableListInfo(&scan, pGroupTags, false, &handle, pList, pTagCond, NULL, &taskInfo), 0);
+
+    groups.clear();
+    for (int32_t i = 0; i < tableListGetSize(pList); i++) {
+      STableKeyInfo *pInfo = tableListGetInfo(pList, i);
+      groups[pInfo->uid] = pInfo->groupId;
+    }
+
+    tableListDestroy(pList);
+    nodesDestroyNode(pTagCond);
+    nodesDestroyList(pGroupTags);
+  }
+
+  // filtered and grouped the same whether the tags come from the tag table or are decoded table by table
+  void checkGroups() {
+    std::map<uint64_t, uint64_t> perTable;
+    std::map<uint64_t, uint64_t> cached;
+    tableGroups(0, perTable);
+    tableGroups(64, cached);
+    ASSERT_FALSE(perTable.empty());
+    ASSERT_EQ(cached, perTable);
+  }
+
+  SVnode  vnode;
+  SMeta  *pMeta = NULL;
+  int64_t version = 0;
+  int32_t cacheSize = 0;
+};
+
+}  // namespace
+
+TEST_F(ExecutilTest, tagTableGroupby) {
+  for (int64_t uid = 1; uid <= 200; uid++) {
+    createCtb(uid);
+  }
+  checkGroups();
+
+  // t1 of uid 10 was NULL, and uid 13 no longer passes the filter
+  updateT1(10, 5);
+  updateT1(13, 0);
+  dropCtb(20);
+  dropCtb(200);
+  checkGroups();
+
+  std::map<uint64_t, uint64_t> groups;
+  tableGroups(64, groups);
+  ASSERT_EQ(groups.count(10), 1);
+  ASSERT_EQ(groups.count(13), 0);
+  ASSERT_EQ(groups.count(20), 0);
+  ASSERT_EQ(groups.count(200), 0);
+}
@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <tglobal.h>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "filter.h"
+#include "functionMgt.h"
+#include "plannodes.h"
+#include "tdatablock.h"
+
+namespace {
+
+const int32_t KEY_NULL = INT32_MIN;
+const int32_t VAR_KEY_LEN = 16;
+
+typedef std::function<int32_t(int32_t)> FRowGen;
+
+// the key column of the input blocks: an INT, or the VARCHAR "k<key>" with or without the dictionary codes the table
+// scan sets for a dictionary encoded block
+enum EKeyCol { KEY_INT, KEY_VAR, KEY_DICT };
+
+int8_t  keyType(EKeyCol keyCol) { return keyCol == KEY_INT ? TSDB_DATA_TYPE_INT : TSDB_DATA_TYPE_VARCHAR; }
+int32_t keyBytes(EKeyCol keyCol) { return keyCol == KEY_INT ? sizeof(int32_t) : VAR_KEY_LEN + VARSTR_HEADER_SIZE; }
+
+std::string keyStr(int32_t k) { return "k" + std::to_string(k); }
+
+// input blocks of (key, val BIGINT), the key of a row is KEY_NULL for a NULL key, every 13th val is NULL
+struct SGroupInput {
+  std::vector<SSDataBlock*> aBlock;
+  std::vector<FRowGen>      aKeyGen;
+  int32_t                   next = 0;
+};
+
+int64_t rowVal(int32_t block, int32_t row) { return block * 100000 + row; }
+bool    rowValIsNull(int32_t row) { return row % 13 == 0; }
+
+int32_t getKey(SColumnInfoData* pKey, int32_t row) {
+  if (colDataIsNull_s(pKey, row)) {
+    return KEY_NULL;
+  }
+
+  char* p = colDataGetData(pKey, row);
+  if (!IS_VAR_DATA_TYPE(pKey->info.type)) {
+    return *(int32_t*)p;
+  }
+
+  std::string s(varDataVal(p), varDataLen(p));
+  EXPECT_EQ(s[0], 'k');
+  return std::stoi(s.substr(1));
+}
+
+void appendVarKey(SColumnInfoData* pKey, int32_t row, int32_t k) {
+  char        buf[VAR_KEY_LEN + VARSTR_HEADER_SIZE];
+  std::string s = keyStr(k);
+  memcpy(varDataVal(buf), s.data(), s.size());
+  varDataSetLen(buf, s.size());
+  colDataAppend(pKey, row, buf, false);
+}
+
+// each distinct key is stored once, and the rows of the key share its offset and code
+void appendDictKeys(SColumnInfoData* pKey, int32_t rows, const FRowGen& keyGen) {
+  std::map<int32_t, std::pair<int32_t, int16_t>> dict;
+  std::vector<int16_t>                           aCode(rows, 0);
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t k = keyGen(i);
+    if (k == KEY_NULL) {
+      colDataAppendNULL(pKey, i);
+      continue;
+    }
+
+    auto it = dict.find(k);
+    if (it == dict.end()) {
+      appendVarKey(pKey, i, k);
+      it = dict.emplace(k, std::make_pair(pKey->varmeta.offset[i], (int16_t)dict.size())).first;
+    }
+
+    pKey->varmeta.offset[i] = it->second.first;
+    aCode[i] = it->second.second;
+  }
+
+  if (!dict.empty()) {
+    ASSERT_EQ(colDataSetDict(pKey, dict.size(), rows), TSDB_CODE_SUCCESS);
+    memcpy(pKey->varmeta.dictCode, aCode.data(), sizeof(int16_t) * rows);
+  }
+}
+
+SSDataBlock* createInputBlock(int32_t block, int32_t rows, const FRowGen& keyGen, EKeyCol keyCol) {
+  SSDataBlock* pBlock = createDataBlock();
+
+  SColumnInfoData key = createColumnInfoData(keyType(keyCol), keyBytes(keyCol), 1);
+  SColumnInfoData val = createColumnInfoData(TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), 2);
+  blockDataAppendColInfo(pBlock, &key);
+  blockDataAppendColInfo(pBlock, &val);
+  blockDataEnsureCapacity(pBlock, rows);
+
+  SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pVal = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  if (keyCol == KEY_DICT) {
+    appendDictKeys(pKey, rows, keyGen);
+  }
+
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t k = keyGen(i);
+    if (keyCol == KEY_INT) {
+      colDataAppend(pKey, i, (const char*)&k, k == KEY_NULL);
+    } else if (keyCol == KEY_VAR) {
+      if (k == KEY_NULL) {
+        colDataAppendNULL(pKey, i);
+      } else {
+        appendVarKey(pKey, i, k);
+      }
+    }
+
+    int64_t v = rowVal(block, i);
+    colDataAppend(pVal, i, (const char*)&v, rowValIsNull(i));
+  }
+
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+SSDataBlock* getGroupInputBlock(SOperatorInfo* pOperator) {
+  SGroupInput* pInput = (SGroupInput*)pOperator->info;
+  if (pInput->next >= pInput->aBlock.size()) {
+    return NULL;
+  }
+
+  return pInput->aBlock[pInput->next++];
+}
+
+void destroyGroupInput(void* param) {
+  SGroupInput* pInput = (SGroupInput*)param;
+  for (SSDataBlock* pBlock : pInput->aBlock) {
+    blockDataDestroy(pBlock);
+  }
+  delete pInput;
+}
+
+SOperatorInfo* createGroupInputOperator(SGroupInput* pInput) {
+  SOperatorInfo* pOperator = (SOperatorInfo*)taosMemoryCalloc(1, sizeof(SOperatorInfo));
+  pOperator->name = "dummyGroupInput4Test";
+  pOperator->operatorType = QUERY_NODE_PHYSICAL_PLAN_EXCHANGE;
+  pOperator->info = pInput;
+  pOperator->fpSet.getNextFn = getGroupInputBlock;
+  pOperator->fpSet.closeFn = destroyGroupInput;
+  return pOperator;
+}
+
+SNode* makeColumn(int16_t slotId, int8_t type, int32_t bytes) {
+  SColumnNode* pCol = (SColumnNode*)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = bytes;
+  pCol->colId = slotId + 1;
+  pCol->colType = COLUMN_TYPE_COLUMN;
+  pCol->slotId = slotId;
+  snprintf(pCol->colName, sizeof(pCol->colName), "c%d", slotId);
+  return (SNode*)pCol;
+}
+
+SNode* makeTarget(int16_t slotId, SNode* pExpr) {
+  STargetNode* pTarget = (STargetNode*)nodesMakeNode(QUERY_NODE_TARGET);
+  pTarget->dataBlockId = 1;
+  pTarget->slotId = slotId;
+  pTarget->pExpr = pExpr;
+  return (SNode*)pTarget;
+}
+
+SNode* makeFunction(const char* name, SNode* pParam) {
+  SFunctionNode* pFunc = (SFunctionNode*)nodesMakeNode(QUERY_NODE_FUNCTION);
+  tstrncpy(pFunc->functionName, name, sizeof(pFunc->functionName));
+  nodesListMakeAppend(&pFunc->pParameterList, pParam);
+
+  char msg[128] = {0};
+  EXPECT_EQ(fmGetFuncInfo(pFunc, msg, sizeof(msg)), TSDB_CODE_SUCCESS);
+  return (SNode*)pFunc;
+}
+
+SNode* makeSlot(int16_t slotId, int8_t type, int32_t bytes) {
+  SSlotDescNode* pSlot = (SSlotDescNode*)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+  pSlot->slotId = slotId;
+  pSlot->dataType.type = type;
+  pSlot->dataType.bytes = bytes;
+  pSlot->output = true;
+  return (SNode*)pSlot;
+}
+
+struct SGroupCase {
+  EKeyCol keyCol = KEY_INT;
+  bool    distinct = false;  // the group keys with no aggregate function, as a DISTINCT is planned
+  bool    twoKeys = false;   // group by key, key
+};
+
+// select count(val), sum(val), key from t group by key, the output slots are (count, sum, key), or (key) for DISTINCT
+SAggPhysiNode* createGroupAggNode(const SGroupCase& c) {
+  SAggPhysiNode* pAgg = (SAggPhysiNode*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_HASH_AGG);
+  int8_t         type = keyType(c.keyCol);
+  int32_t        bytes = keyBytes(c.keyCol);
+  int16_t        keySlot = c.distinct ? 0 : 2;
+
+  SDataBlockDescNode* pDesc = (SDataBlockDescNode*)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+  pDesc->dataBlockId = 2;
+  if (!c.distinct) {
+    nodesListMakeAppend(&pDesc->pSlots, makeSlot(0, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)));
+    nodesListMakeAppend(&pDesc->pSlots, makeSlot(1, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)));
+  }
+  nodesListMakeAppend(&pDesc->pSlots, makeSlot(keySlot, type, bytes));
+  if (c.twoKeys) {
+    nodesListMakeAppend(&pDesc->pSlots, makeSlot(keySlot + 1, type, bytes));
+  }
+  pAgg->node.pOutputDataBlockDesc = pDesc;
+
+  if (!c.distinct) {
+    nodesListMakeAppend(&pAgg->pAggFuncs,
+                        makeTarget(0, makeFunction("count", makeColumn(1, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)))));
+    nodesListMakeAppend(&pAgg->pAggFuncs,
+                        makeTarget(1, makeFunction("sum", makeColumn(1, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)))));
+  }
+  nodesListMakeAppend(&pAgg->pGroupKeys, makeTarget(keySlot, makeColumn(0, type, bytes)));
+  if (c.twoKeys) {
+    nodesListMakeAppend(&pAgg->pGroupKeys, makeTarget(keySlot + 1, makeColumn(0, type, bytes)));
+  }
+  return pAgg;
+}
+
+SNode* makeKeyCond(EOperatorType opType, const char* literal) {
+  SValueNode* pVal = (SValueNode*)nodesMakeNode(QUERY_NODE_VALUE);
+  pVal->node.resType.type = TSDB_DATA_TYPE_VARCHAR;
+  pVal->node.resType.bytes = strlen(literal);
+  pVal->datum.p = (char*)taosMemoryCalloc(1, strlen(literal) + VARSTR_HEADER_SIZE);
+  memcpy(varDataVal(pVal->datum.p), literal, strlen(literal));
+  varDataSetLen(pVal->datum.p, strlen(literal));
+
+  SOperatorNode* pOp = (SOperatorNode*)nodesMakeNode(QUERY_NODE_OPERATOR);
+  pOp->node.resType.type = TSDB_DATA_TYPE_BOOL;
+  pOp->node.resType.bytes = sizeof(bool);
+  pOp->opType = opType;
+  pOp->pLeft = makeColumn(0, TSDB_DATA_TYPE_VARCHAR, keyBytes(KEY_VAR));
+  pOp->pRight = (SNode*)pVal;
+  return (SNode*)pOp;
+}
+
+SNode* makeOrCond(SNode* pLeft, SNode* pRight) {
+  SLogicConditionNode* pCond = (SLogicConditionNode*)nodesMakeNode(QUERY_NODE_LOGIC_CONDITION);
+  pCond->condType = LOGIC_COND_TYPE_OR;
+  pCond->node.resType.type = TSDB_DATA_TYPE_BOOL;
+  pCond->node.resType.bytes = sizeof(bool);
+  nodesListMakeAppend(&pCond->pParameterList, pLeft);
+  nodesListMakeAppend(&pCond->pParameterList, pRight);
+  return (SNode*)pCond;
+}
+
+struct SGroupRes {
+  int64_t count = 0;
+  int64_t sum = 0;
+  bool    sumIsNull = true;
+
+  bool operator==(const SGroupRes& o) const {
+    return count == o.count && sumIsNull == o.sumIsNull && (sumIsNull || sum == o.sum);
+  }
+};
+
+class GroupOperatorTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    fmFuncMgtInit();
+    tsTempSpace.size.avail = 1024 * 1048576L;
+    if (tsTempDir[0] == 0) {
+      tstrncpy(tsTempDir, TD_TMP_DIR_PATH, PATH_MAX);
+    }
+  }
+
+  // run the group by on the blocks, check the result against the groups computed row by row, and check that the
+  // input blocks are left as they are
+  void checkGroupBy(const std::vector<std::pair<int32_t, FRowGen>>& aBlock, const SGroupCase& c = SGroupCase()) {
+    SGroupInput* pInput = new SGroupInput;
+
+    std::map<int32_t, SGroupRes> expect;
+    for (int32_t b = 0; b < aBlock.size(); ++b) {
+      pInput->aBlock.push_back(createInputBlock(b, aBlock[b].first, aBlock[b].second, c.keyCol));
+      pInput->aKeyGen.push_back(aBlock[b].second);
+
+      for (int32_t i = 0; i < aBlock[b].first; ++i) {
+        SGroupRes& res = expect[aBlock[b].second(i)];
+        if (!rowValIsNull(i)) {
+          res.count += 1;
+          res.sum += rowVal(b, i);
+          res.sumIsNull = false;
+        }
+      }
+    }
+
+    SExecTaskInfo taskInfo = {0};
+    taskInfo.id.str = "groupTest";
+
+    SAggPhysiNode* pAgg = createGroupAggNode(c);
+    SOperatorInfo* pOperator = createGroupOperatorInfo(createGroupInputOperator(pInput), pAgg, &taskInfo);
+    ASSERT_NE(pOperator, nullptr);
+
+    std::map<int32_t, SGroupRes> result;
+    while (SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator)) {
+      int32_t          keySlot = c.distinct ? 0 : 2;
+      SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, keySlot);
+      for (int32_t i = 0; i < pRes->info.rows; ++i) {
+        int32_t key = getKey(pKey, i);
+        ASSERT_EQ(result.count(key), 0) << "duplicated group " << key;
+        if (c.twoKeys) {
+          ASSERT_EQ(getKey((SColumnInfoData*)taosArrayGet(pRes->pDataBlock, keySlot + 1), i), key);
+        }
+
+        SGroupRes& res = result[key];
+        if (c.distinct) {
+          res = expect[key];
+          continue;
+        }
+
+        SColumnInfoData* pCount = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+        SColumnInfoData* pSum = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+        res.count = *(int64_t*)colDataGetData(pCount, i);
+        res.sumIsNull = colDataIsNull_s(pSum, i);
+        if (!res.sumIsNull) {
+          res.sum = *(int64_t*)colDataGetData(pSum, i);
+        }
+      }
+    }
+
+    ASSERT_EQ(result.size(), expect.size());
+    for (const auto& group : expect) {
+      ASSERT_EQ(result.count(group.first), 1) << "missing group " << group.first;
+      EXPECT_TRUE(result[group.first] == group.second) << "group " << group.first;
+    }
+
+    for (int32_t b = 0; b < pInput->aBlock.size(); ++b) {
+      SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pInput->aBlock[b]->pDataBlock, 0);
+      SColumnInfoData* pVal = (SColumnInfoData*)taosArrayGet(pInput->aBlock[b]->pDataBlock, 1);
+      bool hasKey = false;
+      for (int32_t i = 0; i < pInput->aBlock[b]->info.rows; ++i) {
+        hasKey = hasKey || pInput->aKeyGen[b](i) != KEY_NULL;
+      }
+      ASSERT_EQ(colDataHasDict(pKey), c.keyCol == KEY_DICT && hasKey);
+
+      for (int32_t i = 0; i < pInput->aBlock[b]->info.rows; ++i) {
+        int32_t key = getKey(pKey, i);
+        ASSERT_EQ(key, pInput->aKeyGen[b](i)) << "block " << b << " row " << i;
+        ASSERT_EQ(colDataIsNull_s(pVal, i), rowValIsNull(i));
+        if (!rowValIsNull(i)) {
+          ASSERT_EQ(*(int64_t*)colDataGetData(pVal, i), rowVal(b, i));
+        }
+      }
+    }
+
+    destroyOperatorInfo(pOperator);
+    nodesDestroyNode((SNode*)pAgg);
+  }
+};
+
+}  // namespace
+
+// the rows of each group are scattered across the block, they are gathered before the aggregation
+TEST_F(GroupOperatorTest, scatteredKeys) {
+  checkGroupBy({{4096, [](int32_t i) { return i % 5; }},
+                {4096, [](int32_t i) { return (i * 7919) % 97; }},
+                {100, [](int32_t i) { return i % 11 == 0 ? KEY_NULL : i % 3; }}});
+}
+
+// the rows of each group form long runs, the aggregation runs on the input block in place
+TEST_F(GroupOperatorTest, clusteredKeys) {
+  checkGroupBy({{4096, [](int32_t i) { return i / 256; }},
+                {4096, [](int32_t i) { return (i / 512) % 3; }},
+                {1000, [](int32_t i) { return i < 500 ? KEY_NULL : 7; }}});
+}
+
+// distinct keys and a single group, the selection vector is the identity
+TEST_F(GroupOperatorTest, distinctAndSingleKey) {
+  checkGroupBy({{1000, [](int32_t i) { return i; }},
+                {1000, [](int32_t i) { return 42; }},
+                {1, [](int32_t i) { return 3; }}});
+}
+
+// the rows of a dictionary key column are grouped by their codes
+TEST_F(GroupOperatorTest, dictKeys) {
+  std::vector<std::pair<int32_t, FRowGen>> aBlock = {
+      {4096, [](int32_t i) { return (i * 7919) % 97; }},
+      {4096, [](int32_t i) { return i / 256; }},
+      {100, [](int32_t i) { return i % 11 == 0 ? KEY_NULL : i % 3; }},
+      {10, [](int32_t i) { return KEY_NULL; }}};
+
+  SGroupCase c;
+  c.keyCol = KEY_VAR;
+  checkGroupBy(aBlock, c);
+  c.keyCol = KEY_DICT;
+  checkGroupBy(aBlock, c);
+
+  // the key hash of each code is computed once, and the keys are compared by the codes
+  c.twoKeys = true;
+  checkGroupBy(aBlock, c);
+}
+
+// a DISTINCT is a group by with no aggregate function
+TEST_F(GroupOperatorTest, distinct) {
+  std::vector<std::pair<int32_t, FRowGen>> aBlock = {
+      {4096, [](int32_t i) { return i % 11 == 0 ? KEY_NULL : (i * 7919) % 97; }},
+      {1000, [](int32_t i) { return i; }}};
+
+  SGroupCase c;
+  c.distinct = true;
+  checkGroupBy(aBlock, c);
+  c.keyCol = KEY_DICT;
+  checkGroupBy(aBlock, c);
+}
+
+// the filter compares each distinct value of a dictionary column once, and keeps the codes of the qualified rows
+TEST_F(GroupOperatorTest, filterDictKeys) {
+  typedef std::function<SNode*()>       FCondGen;
+  typedef std::function<bool(int32_t)> FKeyPred;
+
+  FRowGen keyGen = [](int32_t i) { return i % 17 == 0 ? KEY_NULL : (i * 7919) % 97; };
+  std::vector<std::pair<FCondGen, FKeyPred>> aCase = {
+      {[]() { return makeKeyCond(OP_TYPE_EQUAL, "k3"); }, [](int32_t k) { return k == 3; }},
+      {[]() { return makeKeyCond(OP_TYPE_GREATER_THAN, "k5"); }, [](int32_t k) { return keyStr(k) > "k5"; }},
+      {[]() { return makeOrCond(makeKeyCond(OP_TYPE_EQUAL, "k3"), makeKeyCond(OP_TYPE_LIKE, "k1%")); },
+       [](int32_t k) { return k == 3 || keyStr(k).compare(0, 2, "k1") == 0; }}};
+
+  for (int32_t n = 0; n < aCase.size(); ++n) {
+    for (EKeyCol keyCol : {KEY_VAR, KEY_DICT}) {
+      SSDataBlock* pBlock = createInputBlock(0, 4096, keyGen, keyCol);
+      SNode*       pCond = aCase[n].first();
+      SFilterInfo* pFilter = NULL;
+      ASSERT_EQ(filterInitFromNode(pCond, &pFilter, 0), TSDB_CODE_SUCCESS);
+      doFilter(pBlock, pFilter, NULL);
+
+      SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+      SColumnInfoData* pVal = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+      ASSERT_EQ(colDataHasDict(pKey), keyCol == KEY_DICT);
+
+      int32_t row = 0;
+      for (int32_t i = 0; i < 4096; ++i) {
+        int32_t k = keyGen(i);
+        if (k == KEY_NULL || !aCase[n].second(k)) {
+          continue;
+        }
+
+        ASSERT_LT(row, pBlock->info.rows) << "case " << n;
+        ASSERT_EQ(getKey(pKey, row), k) << "case " << n << " row " << i;
+        ASSERT_EQ(colDataIsNull_s(pVal, row), rowValIsNull(i));
+        if (!rowValIsNull(i)) {
+          ASSERT_EQ(*(int64_t*)colDataGetData(pVal, row), rowVal(0, i));
+        }
+        if (keyCol == KEY_DICT) {
+          ASSERT_LT(pKey->varmeta.dictCode[row], pKey->varmeta.dictSize);
+        }
+        row += 1;
+      }
+      ASSERT_EQ(row, pBlock->info.rows) << "case " << n;
+
+      filterFreeInfo(pFilter);
+      nodesDestroyNode(pCond);
+      blockDataDestroy(pBlock);
+    }
+  }
+}
+
+#pragma GCC diagnostic pop
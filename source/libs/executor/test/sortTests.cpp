@@ -14,9 +14,12 @@
  */
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <tglobal.h>
 #include <tsort.h>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wwrite-strings"
@@ -393,4 +396,437 @@ TEST(testCase, ordered_merge_sort_Test) {
 
 #endif
 
+namespace {
+
+// fill one column with the rows generated by gen, a NULL every nullStep rows
+template <typename T>
+void fillSortCol(SSDataBlock* pBlock, int32_t slotId, int32_t nullStep, T gen) {
+  SColumnInfoData* pCol = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, slotId);
+  char             buf[512] = {0};
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    if (nullStep > 0 && i % nullStep == 0) {
+      colDataAppendNULL(pCol, i);
+    } else {
+      gen(i, buf);
+      colDataAppend(pCol, i, buf, false);
+    }
+  }
+}
+
+SSDataBlock* createSortBlock(const std::vector<std::pair<int8_t, int32_t>>& cols, int32_t rows) {
+  SSDataBlock* pBlock = createDataBlock();
+  for (int32_t i = 0; i < (int32_t)cols.size(); ++i) {
+    SColumnInfoData colInfo = createColumnInfoData(cols[i].first, cols[i].second, i + 1);
+    blockDataAppendColInfo(pBlock, &colInfo);
+    if (IS_VAR_DATA_TYPE(cols[i].first)) {
+      pBlock->info.hasVarCol = true;
+    }
+  }
+
+  blockDataEnsureCapacity(pBlock, rows);
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+SArray* createOrderInfo(const std::vector<SBlockOrderInfo>& orders) {
+  SArray* pOrderInfo = taosArrayInit(orders.size(), sizeof(SBlockOrderInfo));
+  for (const SBlockOrderInfo& order : orders) {
+    taosArrayPush(pOrderInfo, &order);
+  }
+  return pOrderInfo;
+}
+
+SBlockOrderInfo orderBy(int32_t slotId, int32_t order, bool nullFirst) {
+  SBlockOrderInfo oi = {0};
+  oi.slotId = slotId;
+  oi.order = order;
+  oi.nullFirst = nullFirst;
+  return oi;
+}
+
+// the single source of a sort handle, the block is handed out rowsPerFetch rows at a time
+typedef struct {
+  SSDataBlock* pBlock;
+  int32_t      rowsPerFetch;
+  int32_t      start;
+  SSDataBlock* pFetched;
+} SSortBlockSource;
+
+SSDataBlock* fetchSortBlock(void* param) {
+  SSortBlockSource* pSource = (SSortBlockSource*)param;
+  pSource->pFetched = (SSDataBlock*)blockDataDestroy(pSource->pFetched);
+  if (pSource->start >= pSource->pBlock->info.rows) {
+    return NULL;
+  }
+
+  int32_t rows = TMIN(pSource->rowsPerFetch, pSource->pBlock->info.rows - pSource->start);
+  pSource->pFetched = blockDataExtractBlock(pSource->pBlock, pSource->start, rows);
+  pSource->start += rows;
+  return pSource->pFetched;
+}
+
+// sort the block with the sort handle, which goes through the normalized sort keys, and collect the output rows
+SSDataBlock* sortByHandle(SSDataBlock* pBlock, const std::vector<SBlockOrderInfo>& orders, uint64_t maxRows,
+                          int32_t rowsPerFetch, SSortExecInfo* pExecInfo = NULL) {
+  SArray*      pOrderInfo = createOrderInfo(orders);
+  SSortHandle* pHandle = tsortCreateSortHandle(pOrderInfo, SORT_SINGLESOURCE_SORT, 1024, 5, NULL, "sortTests");
+  tsortSetFetchRawDataFp(pHandle, fetchSortBlock, NULL, NULL);
+  if (maxRows > 0) {
+    tsortSetMaxRows(pHandle, maxRows);
+  }
+
+  SSortBlockSource src = {pBlock, rowsPerFetch, 0, NULL};
+  SSortSource*     ps = (SSortSource*)taosMemoryCalloc(1, sizeof(SSortSource));
+  ps->param = &src;
+  ps->onlyRef = true;
+  tsortAddSource(pHandle, ps);
+
+  SSDataBlock* pRes = createOneDataBlock(pBlock, false);
+  blockDataEnsureCapacity(pRes, pBlock->info.rows);
+  EXPECT_EQ(tsortOpen(pHandle), 0);
+
+  STupleHandle* pTuple = NULL;
+  while ((pTuple = tsortNextTuple(pHandle)) != NULL) {
+    for (int32_t i = 0; i < taosArrayGetSize(pRes->pDataBlock); ++i) {
+      SColumnInfoData* pCol = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, i);
+      bool             isNull = tsortIsNullVal(pTuple, i);
+      colDataAppend(pCol, pRes->info.rows, isNull ? NULL : (const char*)tsortGetValue(pTuple, i), isNull);
+    }
+    pRes->info.rows += 1;
+  }
+
+  if (pExecInfo != NULL) {
+    *pExecInfo = tsortGetSortExecInfo(pHandle);
+  }
+
+  tsortDestroySortHandle(pHandle);
+  taosArrayDestroy(pOrderInfo);
+  blockDataDestroy(src.pFetched);
+  return pRes;
+}
+
+// NaN is the smallest as in compareFloatVal, which however takes the values within a tolerance as equal and so can
+// not be the reference of the exact order of the keys
+template <typename T>
+int32_t compareFloatExact(const void* p1, const void* p2) {
+  T v1 = *(const T*)p1;
+  T v2 = *(const T*)p2;
+  if (isnan(v1)) {
+    return isnan(v2) ? 0 : -1;
+  }
+  if (isnan(v2)) {
+    return 1;
+  }
+
+  return (v1 == v2) ? 0 : (v1 < v2 ? -1 : 1);
+}
+
+int32_t compareSortRows(SSDataBlock* pLeft, int32_t left, SSDataBlock* pRight, int32_t right,
+                        const std::vector<SBlockOrderInfo>& orders) {
+  for (const SBlockOrderInfo& order : orders) {
+    SColumnInfoData* pLeftCol = (SColumnInfoData*)taosArrayGet(pLeft->pDataBlock, order.slotId);
+    SColumnInfoData* pRightCol = (SColumnInfoData*)taosArrayGet(pRight->pDataBlock, order.slotId);
+
+    bool leftNull = colDataIsNull_s(pLeftCol, left);
+    bool rightNull = colDataIsNull_s(pRightCol, right);
+    if (leftNull || rightNull) {
+      if (leftNull && rightNull) {
+        continue;
+      }
+      return (leftNull == order.nullFirst) ? -1 : 1;
+    }
+
+    const char* p1 = colDataGetData(pLeftCol, left);
+    const char* p2 = colDataGetData(pRightCol, right);
+
+    int32_t ret = 0;
+    if (pLeftCol->info.type == TSDB_DATA_TYPE_FLOAT) {
+      ret = compareFloatExact<float>(p1, p2);
+    } else if (pLeftCol->info.type == TSDB_DATA_TYPE_DOUBLE) {
+      ret = compareFloatExact<double>(p1, p2);
+    } else {
+      ret = getKeyComparFunc(pLeftCol->info.type, TSDB_ORDER_ASC)(p1, p2);
+    }
+
+    if (ret != 0) {
+      return (order.order == TSDB_ORDER_DESC) ? -ret : ret;
+    }
+  }
+
+  return 0;
+}
+
+// the rows of the block in the order given by the comparator
+std::vector<int32_t> sortByComparator(SSDataBlock* pBlock, const std::vector<SBlockOrderInfo>& orders) {
+  std::vector<int32_t> index(pBlock->info.rows);
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    index[i] = i;
+  }
+
+  std::stable_sort(index.begin(), index.end(), [&](int32_t left, int32_t right) {
+    return compareSortRows(pBlock, left, pBlock, right, orders) < 0;
+  });
+  return index;
+}
+
+// the order columns of the rows at the same position are equal by the comparator, ties may go either way
+void checkSameOrder(SSDataBlock* pBlock, const std::vector<int32_t>& expect, int32_t offset, SSDataBlock* pRes,
+                    const std::vector<SBlockOrderInfo>& orders) {
+  for (int32_t row = 0; row < pRes->info.rows; ++row) {
+    ASSERT_EQ(compareSortRows(pBlock, expect[row + offset], pRes, row, orders), 0) << "row " << row;
+  }
+}
+
+void checkSortKeys(SSDataBlock* pBlock, const std::vector<SBlockOrderInfo>& orders) {
+  std::vector<int32_t> expect = sortByComparator(pBlock, orders);
+  SSDataBlock*         pRes = sortByHandle(pBlock, orders, 0, pBlock->info.rows);
+  ASSERT_EQ(pRes->info.rows, pBlock->info.rows);
+  checkSameOrder(pBlock, expect, 0, pRes, orders);
+  blockDataDestroy(pRes);
+}
+
+// "order by ... limit offset, limit" on the top-N buffer is the same as on the full sort
+void checkTopN(SSDataBlock* pBlock, const std::vector<SBlockOrderInfo>& orders, int32_t offset, int32_t limit) {
+  std::vector<int32_t> expect = sortByComparator(pBlock, orders);
+  SSDataBlock*         pRes = sortByHandle(pBlock, orders, offset + limit, 1000);
+  ASSERT_EQ(pRes->info.rows, TMIN(offset + limit, pBlock->info.rows));
+
+  if (offset < pRes->info.rows) {
+    SSDataBlock* pPage = blockDataExtractBlock(pRes, offset, pRes->info.rows - offset);
+    checkSameOrder(pBlock, expect, offset, pPage, orders);
+    blockDataDestroy(pPage);
+  }
+
+  blockDataDestroy(pRes);
+}
+
+void checkSortKeysAllOrders(SSDataBlock* pBlock, int32_t slotId) {
+  for (int32_t order : {TSDB_ORDER_ASC, TSDB_ORDER_DESC}) {
+    for (bool nullFirst : {true, false}) {
+      checkSortKeys(pBlock, {orderBy(slotId, order, nullFirst)});
+    }
+  }
+}
+
+void putVar(char* buf, const std::string& s) {
+  memcpy(varDataVal(buf), s.data(), s.size());
+  varDataSetLen(buf, s.size());
+}
+
+void putNchar(char* buf, const std::vector<TdUcs4>& s) {
+  memcpy(varDataVal(buf), s.data(), s.size() * TSDB_NCHAR_SIZE);
+  varDataSetLen(buf, s.size() * TSDB_NCHAR_SIZE);
+}
+
+}  // namespace
+
+TEST(sortKeyTest, signedInt) {
+  const int32_t rows = 1000;
+  SSDataBlock*  pBlock = createSortBlock({{TSDB_DATA_TYPE_TINYINT, sizeof(int8_t)},
+                                          {TSDB_DATA_TYPE_SMALLINT, sizeof(int16_t)},
+                                          {TSDB_DATA_TYPE_INT, sizeof(int32_t)},
+                                          {TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)}},
+                                         rows);
+
+  // negative and positive values around zero, and the extremes of each type
+  fillSortCol(pBlock, 0, 0, [](int32_t i, char* buf) {
+    *(int8_t*)buf = (i % 10 == 1) ? INT8_MIN : (i % 10 == 2) ? INT8_MAX : (int8_t)(i % 7 - 3);
+  });
+  fillSortCol(pBlock, 1, 0, [](int32_t i, char* buf) {
+    *(int16_t*)buf = (i % 10 == 3) ? INT16_MIN : (i % 10 == 4) ? INT16_MAX : (int16_t)((i * 7919) % 601 - 300);
+  });
+  fillSortCol(pBlock, 2, 0, [](int32_t i, char* buf) {
+    *(int32_t*)buf = (i % 10 == 5) ? INT32_MIN : (i % 10 == 6) ? INT32_MAX : (i * 104729) % 20001 - 10000;
+  });
+  fillSortCol(pBlock, 3, 0, [](int32_t i, char* buf) {
+    *(int64_t*)buf = (i % 10 == 7) ? INT64_MIN : (i % 10 == 8) ? INT64_MAX : ((int64_t)i * 1299709) % 4001 - 2000;
+  });
+
+  for (int32_t slotId = 0; slotId < 4; ++slotId) {
+    checkSortKeysAllOrders(pBlock, slotId);
+  }
+  checkSortKeys(pBlock, {orderBy(0, TSDB_ORDER_ASC, true), orderBy(2, TSDB_ORDER_DESC, true)});
+  checkSortKeys(pBlock, {orderBy(0, TSDB_ORDER_DESC, false), orderBy(1, TSDB_ORDER_ASC, false),
+                         orderBy(3, TSDB_ORDER_DESC, true)});
+
+  // 5 + 3 + 9 + 9 + 9 bytes, longer than the keys of the radix sort
+  checkSortKeys(pBlock, {orderBy(2, TSDB_ORDER_ASC, true), orderBy(1, TSDB_ORDER_DESC, true),
+                         orderBy(3, TSDB_ORDER_ASC, true), orderBy(3, TSDB_ORDER_DESC, true),
+                         orderBy(3, TSDB_ORDER_ASC, false)});
+  blockDataDestroy(pBlock);
+}
+
+TEST(sortKeyTest, floatDouble) {
+  const int32_t rows = 1000;
+  SSDataBlock*  pBlock =
+      createSortBlock({{TSDB_DATA_TYPE_FLOAT, sizeof(float)}, {TSDB_DATA_TYPE_DOUBLE, sizeof(double)}}, rows);
+
+  const float  aFloat[] = {NAN, -0.0f, 0.0f, -INFINITY, INFINITY, -1.5f, 1.5f, FLT_MIN, -FLT_MIN, FLT_MAX, -FLT_MAX};
+  const double aDouble[] = {NAN, -0.0, 0.0, -INFINITY, INFINITY, -1.5, 1.5, DBL_MIN, -DBL_MIN, DBL_MAX, -DBL_MAX};
+  fillSortCol(pBlock, 0, 0, [&](int32_t i, char* buf) {
+    *(float*)buf = (i % 2 == 0) ? aFloat[(i / 2) % tListLen(aFloat)] : (float)((i * 7919) % 1001 - 500) / 8;
+  });
+  fillSortCol(pBlock, 1, 0, [&](int32_t i, char* buf) {
+    *(double*)buf = (i % 2 == 0) ? aDouble[(i / 3) % tListLen(aDouble)] : (double)((i * 104729) % 1001 - 500) / 16;
+  });
+
+  checkSortKeysAllOrders(pBlock, 0);
+  checkSortKeysAllOrders(pBlock, 1);
+  checkSortKeys(pBlock, {orderBy(0, TSDB_ORDER_DESC, true), orderBy(1, TSDB_ORDER_ASC, true)});
+  blockDataDestroy(pBlock);
+}
+
+TEST(sortKeyTest, nullsFirstLast) {
+  const int32_t rows = 1000;
+  SSDataBlock*  pBlock = createSortBlock({{TSDB_DATA_TYPE_INT, sizeof(int32_t)},
+                                          {TSDB_DATA_TYPE_DOUBLE, sizeof(double)},
+                                          {TSDB_DATA_TYPE_BINARY, 8 + VARSTR_HEADER_SIZE}},
+                                         rows);
+
+  fillSortCol(pBlock, 0, 3, [](int32_t i, char* buf) { *(int32_t*)buf = i % 13 - 6; });
+  fillSortCol(pBlock, 1, 7, [](int32_t i, char* buf) { *(double*)buf = (i % 2 == 0) ? NAN : (double)(i % 5) - 2; });
+  fillSortCol(pBlock, 2, 5, [](int32_t i, char* buf) { putVar(buf, std::string(i % 9, 'a' + i % 3)); });
+
+  for (int32_t slotId = 0; slotId < 3; ++slotId) {
+    checkSortKeysAllOrders(pBlock, slotId);
+  }
+  checkSortKeys(pBlock, {orderBy(0, TSDB_ORDER_ASC, false), orderBy(1, TSDB_ORDER_DESC, true),
+                         orderBy(2, TSDB_ORDER_ASC, true)});
+  checkSortKeys(pBlock, {orderBy(2, TSDB_ORDER_DESC, false), orderBy(0, TSDB_ORDER_DESC, false)});
+  blockDataDestroy(pBlock);
+}
+
+TEST(sortKeyTest, varLongerThanPrefix) {
+  const int32_t rows = 1000;
+  SSDataBlock*  pBlock = createSortBlock({{TSDB_DATA_TYPE_BINARY, 40 + VARSTR_HEADER_SIZE},
+                                          {TSDB_DATA_TYPE_NCHAR, 10 * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE},
+                                          {TSDB_DATA_TYPE_BINARY, 16 + VARSTR_HEADER_SIZE},
+                                          {TSDB_DATA_TYPE_NCHAR, 4 * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE},
+                                          {TSDB_DATA_TYPE_INT, sizeof(int32_t)}},
+                                         rows);
+
+  // values sharing a prefix longer than the key, and values which are the prefix of others
+  fillSortCol(pBlock, 0, 11, [](int32_t i, char* buf) {
+    putVar(buf, std::string(20, 'p') + std::string(i % 17, 'a' + i % 5) + std::string(i % 3, 'z'));
+  });
+  fillSortCol(pBlock, 1, 13, [](int32_t i, char* buf) {
+    std::vector<TdUcs4> s(4 + i % 7, 0x4e00);
+    s.back() = 0x4e00 + i % 11;
+    putNchar(buf, s);
+  });
+  fillSortCol(pBlock, 2, 0, [](int32_t i, char* buf) { putVar(buf, std::string(i % 17, 'a' + i % 2)); });
+  fillSortCol(pBlock, 3, 0, [](int32_t i, char* buf) {
+    std::vector<TdUcs4> s(i % 5, 'a' + i % 3);
+    putNchar(buf, s);
+  });
+  fillSortCol(pBlock, 4, 0, [](int32_t i, char* buf) { *(int32_t*)buf = i % 4; });
+
+  for (int32_t slotId = 0; slotId < 4; ++slotId) {
+    checkSortKeysAllOrders(pBlock, slotId);
+  }
+
+  // the keys of the columns after a truncated one are left to the comparator
+  checkSortKeys(pBlock, {orderBy(0, TSDB_ORDER_ASC, true), orderBy(4, TSDB_ORDER_DESC, true)});
+  checkSortKeys(pBlock, {orderBy(4, TSDB_ORDER_ASC, true), orderBy(1, TSDB_ORDER_DESC, false),
+                         orderBy(2, TSDB_ORDER_ASC, true)});
+  checkSortKeys(pBlock, {orderBy(3, TSDB_ORDER_DESC, true), orderBy(2, TSDB_ORDER_DESC, true)});
+  blockDataDestroy(pBlock);
+}
+
+TEST(sortTopNTest, limitOffset) {
+  const int32_t rows = 20000;
+  SSDataBlock*  pBlock = createSortBlock({{TSDB_DATA_TYPE_INT, sizeof(int32_t)},
+                                          {TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)},
+                                          {TSDB_DATA_TYPE_BINARY, 8 + VARSTR_HEADER_SIZE}},
+                                         rows);
+
+  // many ties on the first column, and the smallest rows come late so the buffer is trimmed more than once
+  fillSortCol(pBlock, 0, 37, [](int32_t i, char* buf) { *(int32_t*)buf = (i * 7919) % 50 - (i / 1000); });
+  fillSortCol(pBlock, 1, 0, [](int32_t i, char* buf) { *(int64_t*)buf = ((int64_t)i * 104729) % 100003; });
+  fillSortCol(pBlock, 2, 0, [](int32_t i, char* buf) { putVar(buf, std::string(1 + i % 7, 'a' + i % 4)); });
+
+  const std::vector<std::pair<int32_t, int32_t>> aLimit = {{0, 1}, {0, 10}, {5, 10}, {95, 10},
+                                                           {0, 500}, {1500, 3000}, {19990, 100}};
+  for (const auto& limit : aLimit) {
+    checkTopN(pBlock, {orderBy(0, TSDB_ORDER_ASC, true)}, limit.first, limit.second);
+    checkTopN(pBlock, {orderBy(0, TSDB_ORDER_DESC, false)}, limit.first, limit.second);
+    checkTopN(pBlock, {orderBy(1, TSDB_ORDER_DESC, true)}, limit.first, limit.second);
+    checkTopN(pBlock, {orderBy(2, TSDB_ORDER_DESC, true), orderBy(0, TSDB_ORDER_ASC, false)}, limit.first,
+              limit.second);
+    checkTopN(pBlock, {orderBy(0, TSDB_ORDER_ASC, false), orderBy(1, TSDB_ORDER_DESC, true)}, limit.first,
+              limit.second);
+  }
+
+  blockDataDestroy(pBlock);
+}
+
+class SortAsyncTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tempSpace = tsTempSpace;
+    tsTempSpace.size.avail = 1024 * 1048576L;
+    if (tsTempDir[0] == 0) {
+      tstrncpy(tsTempDir, TD_TMP_DIR_PATH, PATH_MAX);
+    }
+
+    // several times the 4 MB sort buffer of these rows
+    pBlock = createSortBlock({{TSDB_DATA_TYPE_INT, sizeof(int32_t)},
+                              {TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)},
+                              {TSDB_DATA_TYPE_BINARY, 40 + VARSTR_HEADER_SIZE}},
+                             300000);
+    fillSortCol(pBlock, 0, 101, [](int32_t i, char* buf) { *(int32_t*)buf = (i * 7919) % 1000; });
+    fillSortCol(pBlock, 1, 0, [](int32_t i, char* buf) { *(int64_t*)buf = ((int64_t)i * 104729) % 1000003; });
+    fillSortCol(pBlock, 2, 0, [](int32_t i, char* buf) {
+      putVar(buf, std::string(18, 'p') + std::string(1 + i % 13, 'a' + i % 5));
+    });
+  }
+
+  void TearDown() override {
+    blockDataDestroy(pBlock);
+    tsTempSpace = tempSpace;
+  }
+
+  SDiskSpace   tempSpace;
+  SSDataBlock* pBlock = NULL;
+};
+
+// the runs sorted in the sort thread pool are flushed and merged in order
+TEST_F(SortAsyncTest, order) {
+  ASSERT_GT(tsNumOfSortThreads, 0);
+
+  for (const std::vector<SBlockOrderInfo>& orders :
+       {std::vector<SBlockOrderInfo>{orderBy(0, TSDB_ORDER_ASC, true), orderBy(1, TSDB_ORDER_DESC, true)},
+        std::vector<SBlockOrderInfo>{orderBy(2, TSDB_ORDER_DESC, false), orderBy(0, TSDB_ORDER_DESC, false)}}) {
+    std::vector<int32_t> expect = sortByComparator(pBlock, orders);
+    SSortExecInfo        info = {0};
+    SSDataBlock*         pRes = sortByHandle(pBlock, orders, 0, 4096, &info);
+    ASSERT_EQ(info.sortMethod, SORT_SPILLED_MERGE_SORT_T);
+    ASSERT_EQ(pRes->info.rows, pBlock->info.rows);
+    checkSameOrder(pBlock, expect, 0, pRes, orders);
+    blockDataDestroy(pRes);
+  }
+}
+
+// the error of a run in the sort thread pool fails the sort, and the other runs in flight are dropped
+TEST_F(SortAsyncTest, error) {
+  tsTempSpace.size.avail = 0;
+
+  SArray*      pOrderInfo = createOrderInfo({orderBy(1, TSDB_ORDER_ASC, true)});
+  SSortHandle* pHandle = tsortCreateSortHandle(pOrderInfo, SORT_SINGLESOURCE_SORT, 1024, 5, NULL, "sortTests");
+  tsortSetFetchRawDataFp(pHandle, fetchSortBlock, NULL, NULL);
+
+  SSortBlockSource src = {pBlock, 4096, 0, NULL};
+  SSortSource*     ps = (SSortSource*)taosMemoryCalloc(1, sizeof(SSortSource));
+  ps->param = &src;
+  ps->onlyRef = true;
+  tsortAddSource(pHandle, ps);
+
+  ASSERT_EQ(tsortOpen(pHandle), TSDB_CODE_NO_AVAIL_DISK);
+  ASSERT_LT(src.start, pBlock->info.rows);
+
+  tsortDestroySortHandle(pHandle);
+  taosArrayDestroy(pOrderInfo);
+  blockDataDestroy(src.pFetched);
+}
+
 #pragma GCC diagnostic pop
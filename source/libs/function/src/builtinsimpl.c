@@ -5190,7 +5190,7 @@ bool blockDistSetup(SqlFunctionCtx* pCtx, SResultRowEntryInfo* pResultInfo) {
 }
 
 int32_t blockDistFunction(SqlFunctionCtx* pCtx) {
-  const int32_t BLOCK_DIST_RESULT_ROWS = 24;
+  const int32_t BLOCK_DIST_RESULT_ROWS = 25;
 
   SInputColumnInfoData* pInput = &pCtx->input;
   SColumnInfoData*      pInputCol = pInput->pData[0];
@@ -5208,6 +5208,8 @@ int32_t blockDistFunction(SqlFunctionCtx* pCtx) {
   pDistInfo->totalSize += p1.totalSize;
   pDistInfo->totalRows += p1.totalRows;
   pDistInfo->numOfFiles += p1.numOfFiles;
+  pDistInfo->numOfPageCacheHits += p1.numOfPageCacheHits;
+  pDistInfo->numOfPageCacheMisses += p1.numOfPageCacheMisses;
 
   pDistInfo->defMinRows = p1.defMinRows;
   pDistInfo->defMaxRows = p1.defMaxRows;
@@ -5253,6 +5255,9 @@ int32_t tSerializeBlockDistInfo(void* buf, int32_t bufLen, const STableBlockDist
     if (tEncodeI32(&encoder, pInfo->blockRowsHisto[i]) < 0) return -1;
   }
 
+  if (tEncodeU64(&encoder, pInfo->numOfPageCacheHits) < 0) return -1;
+  if (tEncodeU64(&encoder, pInfo->numOfPageCacheMisses) < 0) return -1;
+
   tEndEncode(&encoder);
 
   int32_t tlen = encoder.pos;
@@ -5284,10 +5289,29 @@ int32_t tDeserializeBlockDistInfo(void* buf, int32_t bufLen, STableBlockDistInfo
     if (tDecodeI32(&decoder, &pInfo->blockRowsHisto[i]) < 0) return -1;
   }
 
+  if (!tDecodeIsEnd(&decoder)) {
+    if (tDecodeU64(&decoder, &pInfo->numOfPageCacheHits) < 0) return -1;
+    if (tDecodeU64(&decoder, &pInfo->numOfPageCacheMisses) < 0) return -1;
+  }
+
   tDecoderClear(&decoder);
   return 0;
 }
 
+// append to the text of a block dist row, cut at the width of the result column, return the new length
+static int32_t blockDistPrintf(char* st, int32_t cap, int32_t len, const char* format, ...) {
+  if (len >= cap - 1) {
+    return len;
+  }
+
+  va_list args;
+  va_start(args, format);
+  int32_t n = vsnprintf(st + VARSTR_HEADER_SIZE + len, cap - len, format, args);
+  va_end(args);
+
+  return (n < 0) ? len : TMIN(len + n, cap - 1);
+}
+
 int32_t blockDistFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
   SResultRowEntryInfo* pResInfo = GET_RES_INFO(pCtx);
   STableBlockDistInfo* pData = GET_ROWCELL_INTERBUF(pResInfo);
@@ -5300,6 +5324,7 @@ int32_t blockDistFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
 
   int32_t row = 0;
   char    st[256] = {0};
+  int32_t cap = TMIN(pColInfo->info.bytes, sizeof(st)) - VARSTR_HEADER_SIZE;
   double  averageSize = 0;
   if (pData->numOfBlocks != 0) {
     averageSize = ((double)pData->totalSize) / pData->numOfBlocks;
@@ -5310,7 +5335,7 @@ int32_t blockDistFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
     compRatio = pData->totalSize * 100 / (double)totalRawSize;
   }
 
-  int32_t len = sprintf(st + VARSTR_HEADER_SIZE,
+  int32_t len = blockDistPrintf(st, cap, 0,
                         "Total_Blocks=[%d] Total_Size=[%.2f Kb] Average_size=[%.2f Kb] Compression_Ratio=[%.2f %c]",
                         pData->numOfBlocks, pData->totalSize / 1024.0, averageSize / 1024.0, compRatio, '%');
 
@@ -5322,21 +5347,28 @@ int32_t blockDistFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
     avgRows = pData->totalRows / pData->numOfBlocks;
   }
 
-  len = sprintf(st + VARSTR_HEADER_SIZE,
-                "Total_Rows=[%" PRId64 "] Inmem_Rows=[%d] MinRows=[%d] MaxRows=[%d] Average_Rows=[%" PRId64 "]",
-                pData->totalRows, pData->numOfInmemRows, pData->minRows, pData->maxRows, avgRows);
+  len = blockDistPrintf(st, cap, 0,
+                        "Total_Rows=[%" PRId64 "] Inmem_Rows=[%d] MinRows=[%d] MaxRows=[%d] Average_Rows=[%" PRId64 "]",
+                        pData->totalRows, pData->numOfInmemRows, pData->minRows, pData->maxRows, avgRows);
+
+  varDataSetLen(st, len);
+  colDataAppend(pColInfo, row++, st, false);
+
+  len = blockDistPrintf(st, cap, 0, "Total_Tables=[%d] Total_Files=[%d] Total_Vgroups=[%d]", pData->numOfTables,
+                        pData->numOfFiles, 0);
 
   varDataSetLen(st, len);
   colDataAppend(pColInfo, row++, st, false);
 
-  len = sprintf(st + VARSTR_HEADER_SIZE, "Total_Tables=[%d] Total_Files=[%d] Total_Vgroups=[%d]", pData->numOfTables,
-                pData->numOfFiles, 0);
+  // pages read by this query
+  len = blockDistPrintf(st, cap, 0, "Page_Cache_Hits=[%" PRIu64 "] Page_Cache_Misses=[%" PRIu64 "]",
+                        pData->numOfPageCacheHits, pData->numOfPageCacheMisses);
 
   varDataSetLen(st, len);
   colDataAppend(pColInfo, row++, st, false);
 
-  len = sprintf(st + VARSTR_HEADER_SIZE,
-                "--------------------------------------------------------------------------------");
+  len = blockDistPrintf(st, cap, 0,
+                        "--------------------------------------------------------------------------------");
   varDataSetLen(st, len);
   colDataAppend(pColInfo, row++, st, false);
 
@@ -5359,7 +5391,7 @@ int32_t blockDistFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
   int32_t bucketRange = (pData->defMaxRows - pData->defMinRows) / numOfBuckets;
 
   for (int32_t i = 0; i < tListLen(pData->blockRowsHisto); ++i) {
-    len = sprintf(st + VARSTR_HEADER_SIZE, "%04d |", pData->defMinRows + bucketRange * i);
+    len = blockDistPrintf(st, cap, 0, "%04d |", pData->defMinRows + bucketRange * i);
 
     int32_t num = 0;
     if (pData->blockRowsHisto[i] > 0) {
@@ -5367,13 +5399,12 @@ int32_t blockDistFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
     }
 
     for (int32_t j = 0; j < num; ++j) {
-      int32_t x = sprintf(st + VARSTR_HEADER_SIZE + len, "%c", '|');
-      len += x;
+      len = blockDistPrintf(st, cap, len, "%c", '|');
     }
 
     if (num > 0) {
       double v = pData->blockRowsHisto[i] * 100.0 / pData->numOfBlocks;
-      len += sprintf(st + VARSTR_HEADER_SIZE + len, "  %d (%.2f%c)", pData->blockRowsHisto[i], v, '%');
+      len = blockDistPrintf(st, cap, len, "  %d (%.2f%c)", pData->blockRowsHisto[i], v, '%');
     }
 
     varDataSetLen(st, len);
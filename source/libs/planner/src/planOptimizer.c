@@ -2459,7 +2459,9 @@ static int32_t tagScanOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSubp
 }
 
 static bool pushDownLimitOptShouldBeOptimized(SLogicNode* pNode) {
+  // the limit of sort node is applied on the sorted results, it can not be pushed down to scan
   if (NULL == pNode->pLimit || 1 != LIST_LENGTH(pNode->pChildren) ||
+      QUERY_NODE_LOGIC_PLAN_SORT == nodeType(pNode) ||
       QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(nodesListGetNode(pNode->pChildren, 0))) {
     return false;
   }
@@ -2481,6 +2483,40 @@ static int32_t pushDownLimitOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLog
   return TSDB_CODE_SUCCESS;
 }
 
+static bool pushDownLimitToSortOptShouldBeOptimized(SLogicNode* pNode) {
+  if (QUERY_NODE_LOGIC_PLAN_PROJECT != nodeType(pNode) || NULL == pNode->pLimit || NULL != pNode->pSlimit ||
+      NULL != pNode->pConditions || 1 != LIST_LENGTH(pNode->pChildren) || ((SLimitNode*)pNode->pLimit)->limit < 0) {
+    return false;
+  }
+
+  SLogicNode* pChild = (SLogicNode*)nodesListGetNode(pNode->pChildren, 0);
+  if (QUERY_NODE_LOGIC_PLAN_SORT != nodeType(pChild) || NULL != pChild->pLimit || NULL != pChild->pSlimit ||
+      NULL != pChild->pConditions || ((SSortLogicNode*)pChild)->groupSort) {
+    return false;
+  }
+  return true;
+}
+
+// The sort node only needs to produce the first 'offset + limit' rows, the project node still applies the limit.
+static int32_t pushDownLimitToSortOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSubplan) {
+  SLogicNode* pNode = optFindPossibleNode(pLogicSubplan->pNode, pushDownLimitToSortOptShouldBeOptimized);
+  if (NULL == pNode) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SLogicNode* pChild = (SLogicNode*)nodesListGetNode(pNode->pChildren, 0);
+  SLimitNode* pLimit = (SLimitNode*)nodesCloneNode(pNode->pLimit);
+  if (NULL == pLimit) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pLimit->limit += pLimit->offset;
+  pLimit->offset = 0;
+  pChild->pLimit = (SNode*)pLimit;
+  pCxt->optimized = true;
+
+  return TSDB_CODE_SUCCESS;
+}
+
 typedef struct STbCntScanOptInfo {
   SAggLogicNode*  pAgg;
   SScanLogicNode* pScan;
@@ -2733,6 +2769,7 @@ static const SOptimizeRule optimizeRuleSet[] = {
   {.pName = "LastRowScan",                .optimizeFunc = lastRowScanOptimize},
   {.pName = "TagScan",                    .optimizeFunc = tagScanOptimize},
   {.pName = "PushDownLimit",              .optimizeFunc = pushDownLimitOptimize},
+  {.pName = "PushDownLimitToSort",        .optimizeFunc = pushDownLimitToSortOptimize},
   {.pName = "TableCountScan",             .optimizeFunc = tableCountScanOptimize},
 };
 // clang-format on
@@ -18,7 +18,42 @@
 
 using namespace std;
 
-class PlanOrderByTest : public PlannerTestBase {};
+class PlanOrderByTest : public PlannerTestBase {
+ protected:
+  static const SSortPhysiNode* findSortNode(const SPhysiNode* pNode) {
+    if (QUERY_NODE_PHYSICAL_PLAN_SORT == nodeType(pNode)) {
+      return (const SSortPhysiNode*)pNode;
+    }
+    SNode* pChild = NULL;
+    FOREACH(pChild, pNode->pChildren) {
+      const SSortPhysiNode* pSort = findSortNode((const SPhysiNode*)pChild);
+      if (NULL != pSort) {
+        return pSort;
+      }
+    }
+    return NULL;
+  }
+
+  // the sort node must only keep the first 'offset + limit' rows
+  void expectSortLimit(int64_t limit) {
+    setPhysiPlanChecker([limit](const SQueryPlan* pPlan) {
+      const SSortPhysiNode* pSort = NULL;
+      SNode*                pNode = NULL;
+      FOREACH(pNode, pPlan->pSubplans) {
+        SNode* pSubplan = NULL;
+        FOREACH(pSubplan, ((SNodeListNode*)pNode)->pNodeList) {
+          if (NULL == pSort) {
+            pSort = findSortNode(((SSubplan*)pSubplan)->pNode);
+          }
+        }
+      }
+      ASSERT_NE(pSort, nullptr);
+      ASSERT_NE(pSort->node.pLimit, nullptr);
+      EXPECT_EQ(((SLimitNode*)pSort->node.pLimit)->limit, limit);
+      EXPECT_EQ(((SLimitNode*)pSort->node.pLimit)->offset, 0);
+    });
+  }
+};
 
 TEST_F(PlanOrderByTest, basic) {
   useDb("root", "test");
@@ -35,6 +70,19 @@ TEST_F(PlanOrderByTest, basic) {
   run("SELECT 1 FROM t1 ORDER BY c1");
 }
 
+TEST_F(PlanOrderByTest, withLimit) {
+  useDb("root", "test");
+
+  expectSortLimit(10);
+  run("SELECT c1 FROM t1 ORDER BY c2 DESC LIMIT 10");
+
+  expectSortLimit(15);
+  run("SELECT c1 FROM t1 ORDER BY c2 LIMIT 5, 10");
+
+  setPhysiPlanChecker(nullptr);
+  run("SELECT c1 FROM st1 ORDER BY c2 DESC LIMIT 10");
+}
+
 TEST_F(PlanOrderByTest, expr) {
   useDb("root", "test");
 
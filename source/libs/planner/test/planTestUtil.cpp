@@ -163,6 +163,10 @@ class PlannerTestBaseImpl {
       doCreatePhysiPlan(&cxt, pLogicPlan, &pPlan);
       unique_ptr<SQueryPlan, void (*)(SQueryPlan*)> plan(pPlan, (void (*)(SQueryPlan*))nodesDestroyNode);
 
+      if (physiPlanChecker_) {
+        physiPlanChecker_(pPlan);
+      }
+
       dump(g_dumpModule);
     } catch (...) {
       dump(DUMP_MODULE_ALL);
@@ -175,6 +179,8 @@ class PlannerTestBaseImpl {
     nodesDestroyAllocator(allocatorId);
   }
 
+  void setPhysiPlanChecker(const function<void(const SQueryPlan*)>& checker) { physiPlanChecker_ = checker; }
+
   void prepare(const string& sql) {
     if (caseEnv_.numOfSkipSql_ > 0) {
       return;
@@ -503,11 +509,12 @@ class PlannerTestBaseImpl {
     taosMemoryFreeClear(pStr);
   }
 
-  caseEnv caseEnv_;
-  stmtEnv stmtEnv_;
-  stmtRes res_;
-  int32_t sqlNo_;
-  int32_t sqlNum_;
+  caseEnv                           caseEnv_;
+  stmtEnv                           stmtEnv_;
+  stmtRes                           res_;
+  int32_t                           sqlNo_;
+  int32_t                           sqlNum_;
+  function<void(const SQueryPlan*)> physiPlanChecker_;
 };
 
 PlannerTestBase::PlannerTestBase() : impl_(new PlannerTestBaseImpl()) {}
@@ -518,6 +525,10 @@ void PlannerTestBase::useDb(const std::string& user, const std::string& db) { im
 
 void PlannerTestBase::run(const std::string& sql) { return impl_->run(sql); }
 
+void PlannerTestBase::setPhysiPlanChecker(const std::function<void(const SQueryPlan*)>& checker) {
+  impl_->setPhysiPlanChecker(checker);
+}
+
 void PlannerTestBase::prepare(const std::string& sql) { return impl_->prepare(sql); }
 
 void PlannerTestBase::bindParams(TAOS_MULTI_BIND* pParams, int32_t colIdx) {
@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <functional>
+
 #define ALLOW_FORBID_FUNC
 
 #include "planInt.h"
@@ -32,6 +34,8 @@ class PlannerTestBase : public testing::Test {
 
   void useDb(const std::string& user, const std::string& db);
   void run(const std::string& sql);
+  // called with the physical plan of each following run(), an empty function stops the checks
+  void setPhysiPlanChecker(const std::function<void(const SQueryPlan*)>& checker);
   // stmt mode APIs
   void prepare(const std::string& sql);
   void bindParams(TAOS_MULTI_BIND* pParams, int32_t colIdx);
@@ -260,6 +260,9 @@ struct SFilterInfo {
   int8_t           *blkUnitRes;
   void             *pTable;
   SArray           *blkList;
+  int8_t          **unitDictRes;  // result of each dictionary entry of the unit column, -1 for not compared yet
+  int8_t           *dictRes;
+  int32_t           dictResCap;
 
   SFilterPCtx pctx;
 };
@@ -1865,6 +1865,8 @@ void filterFreeInfo(SFilterInfo *info) {
   taosMemoryFreeClear(info->cunits);
   taosMemoryFreeClear(info->blkUnitRes);
   taosMemoryFreeClear(info->blkUnits);
+  taosMemoryFreeClear(info->unitDictRes);
+  taosMemoryFreeClear(info->dictRes);
 
   for (int32_t i = 0; i < FLD_TYPE_MAX; ++i) {
     for (uint32_t f = 0; f < info->fields[i].num; ++f) {
@@ -3153,6 +3155,94 @@ static FORCE_INLINE bool filterExecuteImplNotNull(void *pinfo, int32_t numOfRows
   return all;
 }
 
+// Compare the non null value of a row with a unit, the caller handles IS NULL and IS NOT NULL.
+static int8_t filterDoCompareUnit(SFilterComUnit *cunit, void *colData) {
+  if (cunit->rfunc >= 0) {
+    return (*gRangeCompare[cunit->rfunc])(colData, colData, cunit->valData, cunit->valData2,
+                                         gDataCompare[cunit->func]);
+  }
+
+  // match/nmatch for nchar type need convert from ucs4 to mbs
+  if (cunit->dataType == TSDB_DATA_TYPE_NCHAR && (cunit->optr == OP_TYPE_MATCH || cunit->optr == OP_TYPE_NMATCH)) {
+    int8_t  res = 0;
+    char   *newColData = taosMemoryCalloc(cunit->dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE, 1);
+    int32_t len = taosUcs4ToMbs((TdUcs4 *)varDataVal(colData), varDataLen(colData), varDataVal(newColData));
+    if (len < 0) {
+      qError("castConvert1 taosUcs4ToMbs error");
+    } else {
+      varDataSetLen(newColData, len);
+      res = filterDoCompare(gDataCompare[cunit->func], cunit->optr, newColData, cunit->valData);
+    }
+    taosMemoryFreeClear(newColData);
+    return res;
+  }
+
+  return filterDoCompare(gDataCompare[cunit->func], cunit->optr, colData, cunit->valData);
+}
+
+// The rows of a dictionary column with the same code have the same value, so a unit on such a column compares each
+// distinct value once per block and looks the result of the other rows up by the code.
+static void filterPrepareDictRes(SFilterInfo *info) {
+  int32_t total = 0;
+  for (uint32_t u = 0; u < info->unitNum; ++u) {
+    SColumnInfoData *pCol = info->cunits[u].colData;
+    if (pCol != NULL && colDataHasDict(pCol)) {
+      total += pCol->varmeta.dictSize;
+    }
+  }
+
+  if (total == 0) {
+    if (info->unitDictRes != NULL) {
+      memset(info->unitDictRes, 0, info->unitNum * POINTER_BYTES);
+    }
+    return;
+  }
+
+  if (info->unitDictRes == NULL) {
+    info->unitDictRes = taosMemoryCalloc(info->unitNum, POINTER_BYTES);
+    if (info->unitDictRes == NULL) {
+      return;
+    }
+  }
+
+  if (total > info->dictResCap) {
+    int8_t *p = taosMemoryRealloc(info->dictRes, total);
+    if (p == NULL) {  // compare every row instead
+      memset(info->unitDictRes, 0, info->unitNum * POINTER_BYTES);
+      return;
+    }
+
+    info->dictRes = p;
+    info->dictResCap = total;
+  }
+
+  int8_t *p = info->dictRes;
+  memset(p, -1, total);
+  for (uint32_t u = 0; u < info->unitNum; ++u) {
+    SColumnInfoData *pCol = info->cunits[u].colData;
+    if (pCol != NULL && colDataHasDict(pCol)) {
+      info->unitDictRes[u] = p;
+      p += pCol->varmeta.dictSize;
+    } else {
+      info->unitDictRes[u] = NULL;
+    }
+  }
+}
+
+static FORCE_INLINE int8_t filterExecuteUnit(SFilterInfo *info, uint32_t uidx, int32_t row, void *colData) {
+  int8_t *pDictRes = (info->unitDictRes != NULL) ? info->unitDictRes[uidx] : NULL;
+  if (pDictRes == NULL) {
+    return filterDoCompareUnit(&info->cunits[uidx], colData);
+  }
+
+  int16_t dictCode = ((SColumnInfoData *)info->cunits[uidx].colData)->varmeta.dictCode[row];
+  if (pDictRes[dictCode] < 0) {
+    pDictRes[dictCode] = filterDoCompareUnit(&info->cunits[uidx], colData);
+  }
+
+  return pDictRes[dictCode];
+}
+
 bool filterExecuteImplRange(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes, SColumnDataAgg *statis,
                             int16_t numOfCols, int32_t *numOfQualified) {
   SFilterInfo  *info = (SFilterInfo *)pinfo;
@@ -3168,6 +3258,7 @@ bool filterExecuteImplRange(void *pinfo, int32_t numOfRows, SColumnInfoData *pRe
   }
 
   int8_t *p = (int8_t *)pRes->pData;
+  int8_t *pDictRes = (info->unitDictRes != NULL) ? info->unitDictRes[0] : NULL;
 
   for (int32_t i = 0; i < numOfRows; ++i) {
     SColumnInfoData *pData = info->cunits[0].colData;
@@ -3178,7 +3269,11 @@ bool filterExecuteImplRange(void *pinfo, int32_t numOfRows, SColumnInfoData *pRe
       continue;
     }
 
-    p[i] = (*rfunc)(colData, colData, valData, valData2, func);
+    if (pDictRes != NULL) {
+      p[i] = filterExecuteUnit(info, 0, i, colData);
+    } else {
+      p[i] = (*rfunc)(colData, colData, valData, valData2, func);
+    }
 
     if (p[i] == 0) {
       all = false;
@@ -3210,23 +3305,7 @@ bool filterExecuteImplMisc(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes
       continue;
     }
 
-    // match/nmatch for nchar type need convert from ucs4 to mbs
-    if (info->cunits[uidx].dataType == TSDB_DATA_TYPE_NCHAR &&
-        (info->cunits[uidx].optr == OP_TYPE_MATCH || info->cunits[uidx].optr == OP_TYPE_NMATCH)) {
-      char   *newColData = taosMemoryCalloc(info->cunits[uidx].dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE, 1);
-      int32_t len = taosUcs4ToMbs((TdUcs4 *)varDataVal(colData), varDataLen(colData), varDataVal(newColData));
-      if (len < 0) {
-        qError("castConvert1 taosUcs4ToMbs error");
-      } else {
-        varDataSetLen(newColData, len);
-        p[i] = filterDoCompare(gDataCompare[info->cunits[uidx].func], info->cunits[uidx].optr, newColData,
-                               info->cunits[uidx].valData);
-      }
-      taosMemoryFreeClear(newColData);
-    } else {
-      p[i] = filterDoCompare(gDataCompare[info->cunits[uidx].func], info->cunits[uidx].optr, colData,
-                             info->cunits[uidx].valData);
-    }
+    p[i] = filterExecuteUnit(info, uidx, i, colData);
 
     if (p[i] == 0) {
       all = false;
@@ -3275,24 +3354,8 @@ bool filterExecuteImpl(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes, SC
             p[i] = 1;
           } else if (optr == OP_TYPE_IS_NULL) {
             p[i] = 0;
-          } else if (cunit->rfunc >= 0) {
-            p[i] = (*gRangeCompare[cunit->rfunc])(colData, colData, cunit->valData, cunit->valData2,
-                                                  gDataCompare[cunit->func]);
           } else {
-            if (cunit->dataType == TSDB_DATA_TYPE_NCHAR &&
-                (cunit->optr == OP_TYPE_MATCH || cunit->optr == OP_TYPE_NMATCH)) {
-              char   *newColData = taosMemoryCalloc(cunit->dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE, 1);
-              int32_t len = taosUcs4ToMbs((TdUcs4 *)varDataVal(colData), varDataLen(colData), varDataVal(newColData));
-              if (len < 0) {
-                qError("castConvert1 taosUcs4ToMbs error");
-              } else {
-                varDataSetLen(newColData, len);
-                p[i] = filterDoCompare(gDataCompare[cunit->func], cunit->optr, newColData, cunit->valData);
-              }
-              taosMemoryFreeClear(newColData);
-            } else {
-              p[i] = filterDoCompare(gDataCompare[cunit->func], cunit->optr, colData, cunit->valData);
-            }
+            p[i] = filterExecuteUnit(info, uidx, i, colData);
           }
 
           // FILTER_UNIT_SET_R(info, uidx, p[i]);
@@ -4110,6 +4173,7 @@ bool filterExecute(SFilterInfo *info, SSDataBlock *pSrc, SColumnInfoData **p, SC
       return false;
     }
 
+    filterPrepareDictRes(info);
     bool keep = (*info->func)(info, pSrc->info.rows, *p, statis, numOfCols, &output.numOfQualified);
 
     // todo this should be return during filter procedure
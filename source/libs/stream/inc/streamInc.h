@@ -30,10 +30,23 @@ typedef struct {
 
 static SStreamGlobalEnv streamEnv;
 
+#define STREAM_DISPATCH_MAX_BYTES     (4 * 1024 * 1024)  // max encoded bytes of the blocks coalesced in one dispatch
+#define STREAM_DISPATCH_MAX_BLOCKS    1024               // max number of blocks coalesced in one dispatch
+#define STREAM_DISPATCH_BUF_POOL_SIZE 64                 // max number of cached dispatch buffers
+#define STREAM_DISPATCH_BUF_MAX_SIZE  (1024 * 1024)      // larger dispatch buffers are not cached
+
+#define STREAM_CHECKPOINT_RSP_TIMEOUT_MS 5000  // resend the barrier to the downstream tasks not acked by then
+#define STREAM_CHECKPOINT_MAX_RETRY      12    // give up the barrier and resume the output after so many resends
+
+void* streamTimerGetInstance();
+
 int32_t streamDispatch(SStreamTask* pTask);
 int32_t streamDispatchReqToData(const SStreamDispatchReq* pReq, SStreamDataBlock* pData);
 int32_t streamRetrieveReqToData(const SStreamRetrieveReq* pReq, SStreamDataBlock* pData);
 int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* data);
+int32_t streamAddBlockToDispatchMsg(const SSDataBlock* pBlock, SStreamDispatchReq* pReq);
+void    streamDispatchBufPut(void* p);
+void    streamDispatchBufPoolCleanUp();
 
 int32_t streamBroadcastToChildren(SStreamTask* pTask, const SSDataBlock* pBlock);
 
@@ -46,6 +59,12 @@ int32_t streamDispatchOneRecoverFinishReq(SStreamTask* pTask, const SStreamRecov
 
 SStreamQueueItem* streamMergeQueueItem(SStreamQueueItem* dst, SStreamQueueItem* elem);
 
+int32_t streamProcessCheckpointBarrier(SStreamTask* pTask, SStreamCheckpoint* pBarrier);
+int32_t streamAlignCheckpoint(SStreamTask* pTask, SStreamCheckpoint* pBarrier);
+int32_t streamDispatchCheckpoint(SStreamTask* pTask, int64_t checkpointId, int32_t code);
+int32_t streamCheckpointStartDispatch(SStreamTask* pTask, const SStreamCheckpoint* pBarrier);
+bool    streamCheckpointAcked(const SStreamTask* pTask, int32_t taskId);
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,10 +43,13 @@ void streamCleanUp() {
 
   if (old == 1) {
     taosTmrCleanUp(streamEnv.timer);
+    streamDispatchBufPoolCleanUp();
     atomic_store_8(&streamEnv.inited, 0);
   }
 }
 
+void* streamTimerGetInstance() { return streamEnv.timer; }
+
 void streamSchedByTimer(void* param, void* tmrId) {
   SStreamTask* pTask = (void*)param;
 
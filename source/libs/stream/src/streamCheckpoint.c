@@ -14,6 +14,7 @@
  */
 
 #include "streamInc.h"
+#include "ttimer.h"
 
 int32_t tEncodeSStreamCheckpointSourceReq(SEncoder* pEncoder, const SStreamCheckpointSourceReq* pReq) {
   if (tStartEncode(pEncoder) < 0) return -1;
@@ -65,11 +66,12 @@ int32_t tEncodeSStreamCheckpointReq(SEncoder* pEncoder, const SStreamCheckpointR
   if (tEncodeI64(pEncoder, pReq->checkpointId) < 0) return -1;
   if (tEncodeI32(pEncoder, pReq->downstreamTaskId) < 0) return -1;
   if (tEncodeI32(pEncoder, pReq->downstreamNodeId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pReq->upstreamTaskId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pReq->upstreamNodeId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->upstreamTaskId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->upstreamNodeId) < 0) return -1;
   if (tEncodeI32(pEncoder, pReq->childId) < 0) return -1;
   if (tEncodeI64(pEncoder, pReq->expireTime) < 0) return -1;
   if (tEncodeI8(pEncoder, pReq->taskLevel) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->code) < 0) return -1;
   tEndEncode(pEncoder);
   return pEncoder->pos;
 }
@@ -85,6 +87,7 @@ int32_t tDecodeSStreamCheckpointReq(SDecoder* pDecoder, SStreamCheckpointReq* pR
   if (tDecodeI32(pDecoder, &pReq->childId) < 0) return -1;
   if (tDecodeI64(pDecoder, &pReq->expireTime) < 0) return -1;
   if (tDecodeI8(pDecoder, &pReq->taskLevel) < 0) return -1;
+  if (tDecodeI32(pDecoder, &pReq->code) < 0) return -1;
   tEndDecode(pDecoder);
   return 0;
 }
@@ -95,11 +98,12 @@ int32_t tEncodeSStreamCheckpointRsp(SEncoder* pEncoder, const SStreamCheckpointR
   if (tEncodeI64(pEncoder, pRsp->checkpointId) < 0) return -1;
   if (tEncodeI32(pEncoder, pRsp->downstreamTaskId) < 0) return -1;
   if (tEncodeI32(pEncoder, pRsp->downstreamNodeId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pRsp->upstreamTaskId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pRsp->upstreamNodeId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pRsp->upstreamTaskId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pRsp->upstreamNodeId) < 0) return -1;
   if (tEncodeI32(pEncoder, pRsp->childId) < 0) return -1;
   if (tEncodeI64(pEncoder, pRsp->expireTime) < 0) return -1;
   if (tEncodeI8(pEncoder, pRsp->taskLevel) < 0) return -1;
+  if (tEncodeI32(pEncoder, pRsp->code) < 0) return -1;
   tEndEncode(pEncoder);
   return pEncoder->pos;
 }
@@ -115,80 +119,419 @@ int32_t tDecodeSStreamCheckpointRsp(SDecoder* pDecoder, SStreamCheckpointRsp* pR
   if (tDecodeI32(pDecoder, &pRsp->childId) < 0) return -1;
   if (tDecodeI64(pDecoder, &pRsp->expireTime) < 0) return -1;
   if (tDecodeI8(pDecoder, &pRsp->taskLevel) < 0) return -1;
+  if (tDecodeI32(pDecoder, &pRsp->code) < 0) return -1;
   tEndDecode(pDecoder);
   return 0;
 }
 
-static int32_t streamAlignCheckpoint(SStreamTask* pTask, int64_t checkpointId, int32_t childId) {
+static SStreamCheckpoint* streamCheckpointNew(int64_t streamId, int64_t checkpointId, int32_t childId) {
+  SStreamCheckpoint* pBarrier = taosAllocateQitem(sizeof(SStreamCheckpoint), DEF_QITEM, 0);
+  if (pBarrier == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+  memset(pBarrier, 0, sizeof(SStreamCheckpoint));
+  pBarrier->type = STREAM_INPUT__CHECKPOINT;
+  pBarrier->streamId = streamId;
+  pBarrier->checkpointId = checkpointId;
+  pBarrier->childId = childId;
+  return pBarrier;
+}
+
+// keep the barrier for its ack and return the number of upstream tasks whose barrier is still missing. A barrier
+// resent by an upstream already aligned is acked with the others but not counted again.
+int32_t streamAlignCheckpoint(SStreamTask* pTask, SStreamCheckpoint* pBarrier) {
+  if (pTask->checkpointBarriers == NULL) {
+    pTask->checkpointBarriers = taosArrayInit(4, sizeof(void*));
+    if (pTask->checkpointBarriers == NULL) {
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
   if (pTask->checkpointingId == 0) {
-    pTask->checkpointingId = checkpointId;
-    pTask->checkpointAlignCnt = taosArrayGetSize(pTask->childEpInfo);
+    pTask->checkpointingId = pBarrier->checkpointId;
+    int32_t upstreamNum = pTask->taskLevel == TASK_LEVEL__AGG ? taosArrayGetSize(pTask->childEpInfo) : 0;
+    pTask->checkpointAlignCnt = upstreamNum > 0 ? upstreamNum : 1;
+    pTask->checkpointCode = 0;
+  }
+
+  ASSERT(pTask->checkpointingId == pBarrier->checkpointId);
+
+  bool    aligned = false;
+  int32_t num = taosArrayGetSize(pTask->checkpointBarriers);
+  for (int32_t i = 0; i < num; i++) {
+    SStreamCheckpoint* pAligned = taosArrayGetP(pTask->checkpointBarriers, i);
+    if (pAligned->childId == pBarrier->childId) {
+      aligned = true;
+      break;
+    }
+  }
+
+  if (taosArrayPush(pTask->checkpointBarriers, &pBarrier) == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
   }
 
-  ASSERT(pTask->checkpointingId == checkpointId);
+  if (pTask->checkpointCode == 0) {
+    pTask->checkpointCode = pBarrier->code;
+  }
+  if (!aligned) {
+    pTask->checkpointAlignCnt--;
+  }
+  return pTask->checkpointAlignCnt;
+}
 
-  return atomic_sub_fetch_32(&pTask->checkpointAlignCnt, 1);
+static int32_t streamSendCheckpointSourceRsp(SStreamTask* pTask, SStreamCheckpoint* pBarrier, int32_t code) {
+  SStreamCheckpointSourceRsp rsp = {
+      .streamId = pBarrier->streamId,
+      .checkpointId = pBarrier->checkpointId,
+      .taskId = pTask->taskId,
+      .nodeId = pTask->nodeId,
+      .expireTime = -1,
+  };
+
+  int32_t tlen;
+  int32_t ret;
+  tEncodeSize(tEncodeSStreamCheckpointSourceRsp, &rsp, tlen, ret);
+  if (ret < 0) {
+    return -1;
+  }
+
+  void* buf = rpcMallocCont(sizeof(SMsgHead) + tlen);
+  if (buf == NULL) {
+    return -1;
+  }
+
+  ((SMsgHead*)buf)->vgId = htonl(pTask->nodeId);
+  SEncoder encoder;
+  tEncoderInit(&encoder, POINTER_SHIFT(buf, sizeof(SMsgHead)), tlen);
+  tEncodeSStreamCheckpointSourceRsp(&encoder, &rsp);
+  tEncoderClear(&encoder);
+
+  SRpcMsg msg = {.info = pBarrier->rspInfo, .code = code, .pCont = buf, .contLen = sizeof(SMsgHead) + tlen};
+  tmsgSendRsp(&msg);
+  return 0;
 }
 
-static int32_t streamDoCheckpoint(SStreamMeta* pMeta, SStreamTask* pTask, int64_t checkpointId) {
-  // commit tdb state
-  streamStateCommit(pTask->pState);
-  // commit non-tdb state
-  // copy and save new state
-  // report to mnode
-  // send checkpoint req to downstream
+static int32_t streamSendCheckpointRsp(SStreamTask* pTask, SStreamCheckpoint* pBarrier, int32_t code) {
+  SStreamCheckpointRsp rsp = {
+      .streamId = pBarrier->streamId,
+      .checkpointId = pBarrier->checkpointId,
+      .downstreamTaskId = pTask->taskId,
+      .downstreamNodeId = pTask->nodeId,
+      .upstreamTaskId = pBarrier->upstreamTaskId,
+      .upstreamNodeId = pBarrier->upstreamNodeId,
+      .childId = pBarrier->childId,
+      .expireTime = -1,
+      .taskLevel = pTask->taskLevel,
+      .code = code,
+  };
+
+  int32_t tlen;
+  int32_t ret;
+  tEncodeSize(tEncodeSStreamCheckpointRsp, &rsp, tlen, ret);
+  if (ret < 0) {
+    return -1;
+  }
+
+  void* buf = rpcMallocCont(sizeof(SMsgHead) + tlen);
+  if (buf == NULL) {
+    return -1;
+  }
+
+  ((SMsgHead*)buf)->vgId = htonl(pBarrier->upstreamNodeId);
+  SEncoder encoder;
+  tEncoderInit(&encoder, POINTER_SHIFT(buf, sizeof(SMsgHead)), tlen);
+  tEncodeSStreamCheckpointRsp(&encoder, &rsp);
+  tEncoderClear(&encoder);
+
+  // the result goes in the body, the upstream resumes its output on any ack that reaches it
+  SRpcMsg msg = {.info = pBarrier->rspInfo, .code = 0, .pCont = buf, .contLen = sizeof(SMsgHead) + tlen};
+  tmsgSendRsp(&msg);
   return 0;
 }
 
-static int32_t streamDoSourceCheckpoint(SStreamMeta* pMeta, SStreamTask* pTask, int64_t checkpointId) {
-  // ref wal
-  // set status checkpointing
-  // do checkpoint
+static void streamAckBarrier(SStreamTask* pTask, SStreamCheckpoint* pBarrier, int32_t code) {
+  if (pBarrier->childId < 0) {
+    streamSendCheckpointSourceRsp(pTask, pBarrier, code);
+  } else {
+    streamSendCheckpointRsp(pTask, pBarrier, code);
+  }
+  taosFreeQitem(pBarrier);
+}
+
+// ack all the aligned barriers with the result, which unblocks the output of the upstream tasks
+static void streamFinishCheckpoint(SStreamTask* pTask, int32_t code) {
+  int32_t num = taosArrayGetSize(pTask->checkpointBarriers);
+  for (int32_t i = 0; i < num; i++) {
+    streamAckBarrier(pTask, taosArrayGetP(pTask->checkpointBarriers, i), code);
+  }
+  taosArrayClear(pTask->checkpointBarriers);
+
+  pTask->checkpointLastId = pTask->checkpointingId;
+  pTask->checkpointLastCode = code;
+  pTask->checkpointingId = 0;
+  pTask->checkpointAlignCnt = 0;
+  pTask->checkpointCode = 0;
+}
+
+static int32_t streamDoCheckpoint(SStreamTask* pTask, int64_t checkpointId, int32_t code) {
+  SStreamCheckpointInfo info = {
+      .checkpointId = checkpointId,
+      .checkpointVer = pTask->taskLevel == TASK_LEVEL__SOURCE ? pTask->processedVer : -1,
+  };
+
+  // the state is only committed here, a failed checkpoint leaves it in the txn for the next one to cover
+  if (code == 0 && pTask->pState) {
+    if (streamStatePutCheckpoint(pTask->pState, info.checkpointId, info.checkpointVer) < 0 ||
+        streamStateCommit(pTask->pState) < 0) {
+      code = terrno;
+    }
+  }
+
+  if (code == 0) {
+    pTask->chkInfo = info;
+    qInfo("stream task %d checkpoint %" PRId64 " done, ver %" PRId64, pTask->taskId, info.checkpointId,
+          info.checkpointVer);
+  } else {
+    qError("stream task %d checkpoint %" PRId64 " failed since %s", pTask->taskId, checkpointId, tstrerror(code));
+  }
+
+  // send the barrier to downstream behind the output produced before it, a failed one still keeps them aligned
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH || pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH) {
+    SStreamCheckpoint* pBarrier = streamCheckpointNew(pTask->streamId, checkpointId, pTask->selfChildId);
+    if (pBarrier == NULL) {
+      return code == 0 ? terrno : code;
+    }
+    pBarrier->code = code;
+    atomic_add_fetch_32(&pTask->outputCheckpointCnt, 1);
+    taosWriteQitem(pTask->outputQueue->queue, pBarrier);
+    streamDispatch(pTask);
+  }
+  return code;
+}
+
+int32_t streamProcessCheckpointBarrier(SStreamTask* pTask, SStreamCheckpoint* pBarrier) {
+  int64_t checkpointId = pBarrier->checkpointId;
+
+  // a sink keeps no state of its own
+  if (pTask->taskLevel == TASK_LEVEL__SINK) {
+    streamAckBarrier(pTask, pBarrier, pBarrier->code);
+    return 0;
+  }
+
+  // a barrier resent after the checkpoint ended gets the same answer again
+  if (checkpointId <= pTask->checkpointLastId) {
+    int32_t code = checkpointId == pTask->checkpointLastId ? pTask->checkpointLastCode
+                                                          : TSDB_CODE_STREAM_CHECKPOINT_ABORTED;
+    streamAckBarrier(pTask, pBarrier, code);
+    return 0;
+  }
+
+  if (pTask->checkpointingId != 0 && checkpointId < pTask->checkpointingId) {
+    qWarn("stream task %d checkpoint %" PRId64 " superseded by %" PRId64, pTask->taskId, checkpointId,
+          pTask->checkpointingId);
+    streamAckBarrier(pTask, pBarrier, TSDB_CODE_STREAM_CHECKPOINT_ABORTED);
+    return 0;
+  }
+
+  // an upstream that gave up waiting for its ack has moved on to the next checkpoint, this one can never align
+  if (pTask->checkpointingId != 0 && checkpointId > pTask->checkpointingId) {
+    qWarn("stream task %d checkpoint %" PRId64 " aborted by %" PRId64, pTask->taskId, pTask->checkpointingId,
+          checkpointId);
+    streamFinishCheckpoint(pTask, TSDB_CODE_STREAM_CHECKPOINT_ABORTED);
+  }
+
+  // an upstream stops sending after its barrier until acked, so the state is aligned once all barriers arrive
+  int32_t left = streamAlignCheckpoint(pTask, pBarrier);
+  if (left < 0) {
+    streamAckBarrier(pTask, pBarrier, terrno);
+    return -1;
+  }
+  if (left > 0) {
+    qDebug("stream task %d checkpoint %" PRId64 " waiting for %d upstream", pTask->taskId, checkpointId, left);
+    return 0;
+  }
+
+  int32_t code = streamDoCheckpoint(pTask, checkpointId, pTask->checkpointCode);
+  streamFinishCheckpoint(pTask, code);
+  return code == 0 ? 0 : -1;
+}
+
+int32_t streamLoadCheckpointInfo(SStreamTask* pTask) {
+  if (pTask->pState == NULL) {
+    return 0;
+  }
+
+  SStreamCheckpointInfo info = {0};
+  if (streamStateGetCheckpoint(pTask->pState, &info.checkpointId, &info.checkpointVer) < 0) {
+    // no checkpoint yet
+    return 0;
+  }
+
+  pTask->chkInfo = info;
+  pTask->checkpointLastId = info.checkpointId;
+  if (pTask->taskLevel == TASK_LEVEL__SOURCE) {
+    pTask->processedVer = info.checkpointVer;
+  }
+
+  qInfo("stream task %d restored from checkpoint %" PRId64 ", ver %" PRId64, pTask->taskId, info.checkpointId,
+        info.checkpointVer);
   return 0;
 }
-int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq) {
-  int32_t code;
-  int64_t checkpointId = pReq->checkpointId;
 
-  code = streamDoSourceCheckpoint(pMeta, pTask, checkpointId);
-  if (code < 0) {
-    // rsp error
+int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq,
+                                         SRpcMsg* pMsg) {
+  ASSERT(pTask->taskLevel == TASK_LEVEL__SOURCE);
+
+  SStreamCheckpoint* pBarrier = streamCheckpointNew(pReq->streamId, pReq->checkpointId, -1);
+  if (pBarrier == NULL) {
     return -1;
   }
+  pBarrier->rspInfo = pMsg->info;
+
+  // the barrier follows the submits already queued, mnode is acked after the checkpoint is persisted. Once queued
+  // the barrier owns the rsp, so a failed schedule is left to the next input.
+  streamTaskInput(pTask, (SStreamQueueItem*)pBarrier);
+  if (streamSchedExec(pTask) < 0) {
+    qError("stream task %d failed to sched checkpoint %" PRId64 " since %s", pTask->taskId, pReq->checkpointId,
+           terrstr());
+  }
 
   return 0;
 }
 
-int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq) {
-  int32_t code;
-  int64_t checkpointId = pReq->checkpointId;
-  int32_t childId = pReq->childId;
+int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq, SRpcMsg* pMsg) {
+  SStreamCheckpoint* pBarrier = streamCheckpointNew(pReq->streamId, pReq->checkpointId, pReq->childId);
+  if (pBarrier == NULL) {
+    return -1;
+  }
+  pBarrier->upstreamTaskId = pReq->upstreamTaskId;
+  pBarrier->upstreamNodeId = pReq->upstreamNodeId;
+  pBarrier->code = pReq->code;
+  pBarrier->rspInfo = pMsg->info;
+
+  // all the data sent by the upstream before the barrier has been acked, so it is already in the input queue
+  streamTaskInput(pTask, (SStreamQueueItem*)pBarrier);
+  if (streamSchedExec(pTask) < 0) {
+    qError("stream task %d failed to sched checkpoint %" PRId64 " since %s", pTask->taskId, pReq->checkpointId,
+           terrstr());
+  }
+
+  return 0;
+}
 
-  if (taosArrayGetSize(pTask->childEpInfo) > 0) {
-    code = streamAlignCheckpoint(pTask, checkpointId, childId);
-    if (code > 0) {
-      return 0;
+bool streamCheckpointAcked(const SStreamTask* pTask, int32_t taskId) {
+  int32_t num = taosArrayGetSize(pTask->checkpointAckTasks);
+  for (int32_t i = 0; i < num; i++) {
+    if (*(int32_t*)taosArrayGet(pTask->checkpointAckTasks, i) == taskId) {
+      return true;
     }
-    if (code < 0) {
-      ASSERT(0);
+  }
+  return false;
+}
+
+static void streamCheckpointResumeOutput(SStreamTask* pTask) {
+  int8_t old = atomic_exchange_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+  ASSERT(old == TASK_OUTPUT_STATUS__WAIT);
+  streamDispatch(pTask);
+}
+
+// resend the barrier to the downstream tasks that did not ack it in time, the timer holds a ref of the task
+static void streamCheckpointRspTmrCb(void* param, void* tmrId) {
+  SStreamTask* pTask = param;
+
+  taosWLockLatch(&pTask->checkpointLatch);
+  // a later barrier armed a new timer, or nothing is left to wait for
+  if (tmrId != pTask->checkpointTmr || pTask->dispatchCheckpointId == 0 ||
+      atomic_load_8(&pTask->taskStatus) == TASK_STATUS__DROPPING) {
+    taosWUnLockLatch(&pTask->checkpointLatch);
+    streamMetaReleaseTask(NULL, pTask);
+    return;
+  }
+
+  int64_t checkpointId = pTask->dispatchCheckpointId;
+  if (++pTask->checkpointRetry > STREAM_CHECKPOINT_MAX_RETRY) {
+    qError("stream task %d checkpoint %" PRId64 " not acked after %d resends, resume the output", pTask->taskId,
+           checkpointId, STREAM_CHECKPOINT_MAX_RETRY);
+    pTask->dispatchCheckpointId = 0;
+    taosWUnLockLatch(&pTask->checkpointLatch);
+    streamCheckpointResumeOutput(pTask);
+    streamMetaReleaseTask(NULL, pTask);
+    return;
+  }
+
+  qWarn("stream task %d checkpoint %" PRId64 " not acked in time, resend %d", pTask->taskId, checkpointId,
+        pTask->checkpointRetry);
+  streamDispatchCheckpoint(pTask, checkpointId, pTask->dispatchCheckpointCode);
+  taosTmrReset(streamCheckpointRspTmrCb, STREAM_CHECKPOINT_RSP_TIMEOUT_MS, pTask, streamTimerGetInstance(),
+               &pTask->checkpointTmr);
+  taosWUnLockLatch(&pTask->checkpointLatch);
+}
+
+// the output stays blocked until all downstream tasks ack the barrier
+int32_t streamCheckpointStartDispatch(SStreamTask* pTask, const SStreamCheckpoint* pBarrier) {
+  taosWLockLatch(&pTask->checkpointLatch);
+  if (pTask->checkpointAckTasks == NULL) {
+    pTask->checkpointAckTasks = taosArrayInit(4, sizeof(int32_t));
+    if (pTask->checkpointAckTasks == NULL) {
+      taosWUnLockLatch(&pTask->checkpointLatch);
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
       return -1;
     }
   }
+  taosArrayClear(pTask->checkpointAckTasks);
+  pTask->dispatchCheckpointId = pBarrier->checkpointId;
+  pTask->dispatchCheckpointCode = pBarrier->code;
+  pTask->checkpointRetry = 0;
 
-  code = streamDoCheckpoint(pMeta, pTask, checkpointId);
-  if (code < 0) {
-    // rsp error
+  if (streamDispatchCheckpoint(pTask, pBarrier->checkpointId, pBarrier->code) < 0) {
+    pTask->dispatchCheckpointId = 0;
+    taosWUnLockLatch(&pTask->checkpointLatch);
     return -1;
   }
 
-  // send rsp to all children
-
+  // a timer still waiting keeps the ref it took, the callback cannot run before the latch is released
+  if (!taosTmrReset(streamCheckpointRspTmrCb, STREAM_CHECKPOINT_RSP_TIMEOUT_MS, pTask, streamTimerGetInstance(),
+                    &pTask->checkpointTmr) &&
+      pTask->checkpointTmr != NULL) {
+    atomic_add_fetch_32(&pTask->refCnt, 1);
+  }
+  taosWUnLockLatch(&pTask->checkpointLatch);
   return 0;
 }
 
-int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp) {
-  // recover step2, scan from wal
-  // unref wal
-  // set status normal
+int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp, int32_t code) {
+  if (code != 0) {
+    qWarn("task %d checkpoint %" PRId64 " rsp from task %d failed since %s, wait for resend", pTask->taskId,
+          pRsp->checkpointId, pRsp->downstreamTaskId, tstrerror(code));
+    return 0;
+  }
+
+  qDebug("task %d receive checkpoint %" PRId64 " rsp from task %d, code:%s", pTask->taskId, pRsp->checkpointId,
+         pRsp->downstreamTaskId, tstrerror(pRsp->code));
+
+  taosWLockLatch(&pTask->checkpointLatch);
+  // a late or duplicated ack of a barrier already passed
+  if (pRsp->checkpointId != pTask->dispatchCheckpointId || streamCheckpointAcked(pTask, pRsp->downstreamTaskId)) {
+    taosWUnLockLatch(&pTask->checkpointLatch);
+    return 0;
+  }
+  taosArrayPush(pTask->checkpointAckTasks, &pRsp->downstreamTaskId);
+
+  int32_t total = 1;
+  if (pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH) {
+    total = taosArrayGetSize(pTask->shuffleDispatcher.dbInfo.pVgroupInfos);
+  }
+  if (taosArrayGetSize(pTask->checkpointAckTasks) < total) {
+    taosWUnLockLatch(&pTask->checkpointLatch);
+    return 0;
+  }
+  pTask->dispatchCheckpointId = 0;
+  taosWUnLockLatch(&pTask->checkpointLatch);
+
+  // all downstream passed the barrier, resume the output. The rsp timer finds nothing to wait for and exits
+  streamCheckpointResumeOutput(pTask);
   return 0;
 }
@@ -180,6 +180,8 @@ void streamFreeQitem(SStreamQueueItem* data) {
     taosArrayDestroy(pMerge->reqs);
     taosArrayDestroy(pMerge->dataRefs);
     taosFreeQitem(pMerge);
+  } else if (type == STREAM_INPUT__CHECKPOINT) {
+    taosFreeQitem(data);
   } else if (type == STREAM_INPUT__REF_DATA_BLOCK) {
     SStreamRefDataBlock* pRefBlock = (SStreamRefDataBlock*)data;
 
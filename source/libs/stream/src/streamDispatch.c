@@ -14,6 +14,70 @@
  */
 
 #include "streamInc.h"
+#include "tglobal.h"
+
+// buffers of the encoded blocks are reused across dispatches, each one is prefixed by its capacity
+typedef struct {
+  int32_t cap;
+  char    data[];
+} SStreamDispatchBuf;
+
+static struct {
+  SRWLatch            latch;
+  int32_t             num;
+  SStreamDispatchBuf* bufs[STREAM_DISPATCH_BUF_POOL_SIZE];
+} dispatchBufPool;
+
+static void* streamDispatchBufGet(int32_t size) {
+  SStreamDispatchBuf* pBuf = NULL;
+
+  taosWLockLatch(&dispatchBufPool.latch);
+  for (int32_t i = dispatchBufPool.num - 1; i >= 0; i--) {
+    if (dispatchBufPool.bufs[i]->cap >= size) {
+      pBuf = dispatchBufPool.bufs[i];
+      dispatchBufPool.bufs[i] = dispatchBufPool.bufs[--dispatchBufPool.num];
+      break;
+    }
+  }
+  taosWUnLockLatch(&dispatchBufPool.latch);
+
+  if (pBuf == NULL) {
+    pBuf = taosMemoryMalloc(sizeof(SStreamDispatchBuf) + size);
+    if (pBuf == NULL) {
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
+      return NULL;
+    }
+    pBuf->cap = size;
+  }
+
+  return pBuf->data;
+}
+
+void streamDispatchBufPut(void* p) {
+  if (p == NULL) return;
+
+  SStreamDispatchBuf* pBuf = (SStreamDispatchBuf*)((char*)p - offsetof(SStreamDispatchBuf, data));
+  if (pBuf->cap <= STREAM_DISPATCH_BUF_MAX_SIZE) {
+    taosWLockLatch(&dispatchBufPool.latch);
+    if (dispatchBufPool.num < STREAM_DISPATCH_BUF_POOL_SIZE) {
+      dispatchBufPool.bufs[dispatchBufPool.num++] = pBuf;
+      pBuf = NULL;
+    }
+    taosWUnLockLatch(&dispatchBufPool.latch);
+  }
+
+  taosMemoryFree(pBuf);
+}
+
+void streamDispatchBufPoolCleanUp() {
+  taosWLockLatch(&dispatchBufPool.latch);
+  for (int32_t i = 0; i < dispatchBufPool.num; i++) {
+    taosMemoryFree(dispatchBufPool.bufs[i]);
+    dispatchBufPool.bufs[i] = NULL;
+  }
+  dispatchBufPool.num = 0;
+  taosWUnLockLatch(&dispatchBufPool.latch);
+}
 
 int32_t tEncodeStreamDispatchReq(SEncoder* pEncoder, const SStreamDispatchReq* pReq) {
   if (tStartEncode(pEncoder) < 0) return -1;
@@ -178,15 +242,36 @@ CLEAR:
   return code;
 }
 
-static int32_t streamAddBlockToDispatchMsg(const SSDataBlock* pBlock, SStreamDispatchReq* pReq) {
-  int32_t dataStrLen = sizeof(SRetrieveTableRsp) + blockGetEncodeSize(pBlock);
-  void*   buf = taosMemoryCalloc(1, dataStrLen);
+// the downstream before the compressed block version can not decode it, so it is sent only when compressColData
+// asks for it, the same as the query results, see the definition of tsCompressColData
+static bool streamDispatchNeedCompress(const SSDataBlock* pBlock) {
+  if (tsCompressColData < 0 || pBlock->info.rows <= 0) {
+    return false;
+  }
+
+  int32_t numOfCols = (int32_t)taosArrayGetSize(pBlock->pDataBlock);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, i);
+    if (colDataGetLength(pCol, pBlock->info.rows) > tsCompressColData) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+int32_t streamAddBlockToDispatchMsg(const SSDataBlock* pBlock, SStreamDispatchReq* pReq) {
+  bool    compressed = streamDispatchNeedCompress(pBlock);
+  int32_t dataStrLen =
+      sizeof(SRetrieveTableRsp) + (compressed ? blockGetCompressEncodeSize(pBlock) : blockGetEncodeSize(pBlock));
+  void*   buf = streamDispatchBufGet(dataStrLen);
   if (buf == NULL) return -1;
 
   SRetrieveTableRsp* pRetrieve = (SRetrieveTableRsp*)buf;
+  memset(pRetrieve, 0, sizeof(SRetrieveTableRsp));
   pRetrieve->useconds = 0;
   pRetrieve->precision = TSDB_DEFAULT_PRECISION;
-  pRetrieve->compressed = 0;
+  pRetrieve->compressed = compressed;
   pRetrieve->completed = 1;
   pRetrieve->streamBlockType = pBlock->info.type;
   pRetrieve->numOfRows = htobe64((int64_t)pBlock->info.rows);
@@ -199,7 +284,8 @@ static int32_t streamAddBlockToDispatchMsg(const SSDataBlock* pBlock, SStreamDis
   int32_t numOfCols = (int32_t)taosArrayGetSize(pBlock->pDataBlock);
   pRetrieve->numOfCols = htonl(numOfCols);
 
-  int32_t actualLen = blockEncode(pBlock, pRetrieve->data, numOfCols);
+  int32_t actualLen = compressed ? blockCompressEncode(pBlock, pRetrieve->data, numOfCols)
+                                 : blockEncode(pBlock, pRetrieve->data, numOfCols);
   actualLen += sizeof(SRetrieveTableRsp);
   ASSERT(actualLen <= dataStrLen);
   taosArrayPush(pReq->dataLen, &actualLen);
@@ -289,6 +375,87 @@ FAIL:
   return code;
 }
 
+static int32_t streamDispatchOneCheckpointReq(SStreamTask* pTask, const SStreamCheckpointReq* pReq, int32_t vgId,
+                                              SEpSet* pEpSet) {
+  void*   buf = NULL;
+  int32_t code = -1;
+  SRpcMsg msg = {0};
+
+  int32_t tlen;
+  tEncodeSize(tEncodeSStreamCheckpointReq, pReq, tlen, code);
+  if (code < 0) {
+    return -1;
+  }
+
+  buf = rpcMallocCont(sizeof(SMsgHead) + tlen);
+  if (buf == NULL) {
+    return -1;
+  }
+
+  ((SMsgHead*)buf)->vgId = htonl(vgId);
+  void* abuf = POINTER_SHIFT(buf, sizeof(SMsgHead));
+
+  SEncoder encoder;
+  tEncoderInit(&encoder, abuf, tlen);
+  if ((code = tEncodeSStreamCheckpointReq(&encoder, pReq)) < 0) {
+    goto FAIL;
+  }
+  tEncoderClear(&encoder);
+
+  msg.contLen = tlen + sizeof(SMsgHead);
+  msg.pCont = buf;
+  msg.msgType = TDMT_STREAM_TASK_CHECKPOINT;
+
+  tmsgSendReq(pEpSet, &msg);
+
+  qDebug("dispatch from task %d to task %d node %d: checkpoint %" PRId64, pTask->taskId, pReq->downstreamTaskId, vgId,
+         pReq->checkpointId);
+
+  return 0;
+FAIL:
+  if (buf) rpcFreeCont(buf);
+  return code;
+}
+
+// send the barrier to the downstream tasks that have not acked it yet, called with checkpointLatch held
+int32_t streamDispatchCheckpoint(SStreamTask* pTask, int64_t checkpointId, int32_t code) {
+  SStreamCheckpointReq req = {
+      .streamId = pTask->streamId,
+      .checkpointId = checkpointId,
+      .upstreamTaskId = pTask->taskId,
+      .upstreamNodeId = pTask->nodeId,
+      .childId = pTask->selfChildId,
+      .expireTime = -1,
+      .taskLevel = pTask->taskLevel,
+      .code = code,
+  };
+
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    if (streamCheckpointAcked(pTask, pTask->fixedEpDispatcher.taskId)) {
+      return 0;
+    }
+    req.downstreamTaskId = pTask->fixedEpDispatcher.taskId;
+    req.downstreamNodeId = pTask->fixedEpDispatcher.nodeId;
+    return streamDispatchOneCheckpointReq(pTask, &req, req.downstreamNodeId, &pTask->fixedEpDispatcher.epSet);
+  }
+
+  ASSERT(pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH);
+  SArray* vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
+  int32_t vgSz = taosArrayGetSize(vgInfo);
+  for (int32_t i = 0; i < vgSz; i++) {
+    SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
+    if (streamCheckpointAcked(pTask, pVgInfo->taskId)) {
+      continue;
+    }
+    req.downstreamTaskId = pVgInfo->taskId;
+    req.downstreamNodeId = pVgInfo->vgId;
+    if (streamDispatchOneCheckpointReq(pTask, &req, pVgInfo->vgId, &pVgInfo->epSet) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
 int32_t streamDispatchOneDataReq(SStreamTask* pTask, const SStreamDispatchReq* pReq, int32_t vgId, SEpSet* pEpSet) {
   void*   buf = NULL;
   int32_t code = -1;
@@ -415,7 +582,7 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
     }
     code = 0;
   FAIL_FIXED_DISPATCH:
-    taosArrayDestroyP(req.data, taosMemoryFree);
+    taosArrayDestroyP(req.data, streamDispatchBufPut);
     taosArrayDestroy(req.dataLen);
     return code;
 
@@ -481,7 +648,7 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
   FAIL_SHUFFLE_DISPATCH:
     if (pReqs) {
       for (int32_t i = 0; i < vgSz; i++) {
-        taosArrayDestroyP(pReqs[i].data, taosMemoryFree);
+        taosArrayDestroyP(pReqs[i].data, streamDispatchBufPut);
         taosArrayDestroy(pReqs[i].dataLen);
       }
       taosMemoryFree(pReqs);
@@ -491,6 +658,48 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
   return 0;
 }
 
+static int64_t streamDataBlockEncodeSize(const SStreamDataBlock* pData) {
+  int64_t size = 0;
+  int32_t blockNum = taosArrayGetSize(pData->blocks);
+  for (int32_t i = 0; i < blockNum; i++) {
+    size += blockGetEncodeSize(taosArrayGet(pData->blocks, i));
+  }
+  return size;
+}
+
+// coalesce the output already queued behind pData into it, so that small outputs go downstream in one dispatch.
+// Nothing is held back to wait for more output, the merged item stays the current one of the queue for retry.
+static void streamCoalesceOutput(SStreamTask* pTask, SStreamDataBlock* pData) {
+  SStreamQueue* pQueue = pTask->outputQueue;
+  int64_t       size = streamDataBlockEncodeSize(pData);
+
+  while (size < STREAM_DISPATCH_MAX_BYTES && taosArrayGetSize(pData->blocks) < STREAM_DISPATCH_MAX_BLOCKS &&
+         atomic_load_32(&pTask->outputCheckpointCnt) == 0) {
+    void* qItem = NULL;
+    taosGetQitem(pQueue->qall, &qItem);
+    if (qItem == NULL) {
+      taosReadAllQitems(pQueue->queue, pQueue->qall);
+      taosGetQitem(pQueue->qall, &qItem);
+    }
+    if (qItem == NULL) {
+      break;
+    }
+
+    // a barrier queued meanwhile is sent right after the coalesced data
+    if (((SStreamQueueItem*)qItem)->type == STREAM_INPUT__CHECKPOINT) {
+      ASSERT(pTask->pOutputBarrier == NULL);
+      pTask->pOutputBarrier = qItem;
+      break;
+    }
+
+    SStreamDataBlock* pNext = qItem;
+    ASSERT(pNext->type == STREAM_INPUT__DATA_BLOCK);
+
+    size += streamDataBlockEncodeSize(pNext);
+    streamMergeQueueItem((SStreamQueueItem*)pData, (SStreamQueueItem*)pNext);
+  }
+}
+
 int32_t streamDispatch(SStreamTask* pTask) {
   ASSERT(pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH || pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH);
 
@@ -500,15 +709,41 @@ int32_t streamDispatch(SStreamTask* pTask) {
     return 0;
   }
 
+  // a barrier taken out while coalescing goes right after the data in front of it
+  if (pTask->pOutputBarrier != NULL && atomic_load_8(&pTask->outputQueue->status) != STREAM_QUEUE__FAILED) {
+    if (streamCheckpointStartDispatch(pTask, pTask->pOutputBarrier) < 0) {
+      atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+      return -1;
+    }
+    atomic_sub_fetch_32(&pTask->outputCheckpointCnt, 1);
+    taosFreeQitem(pTask->pOutputBarrier);
+    pTask->pOutputBarrier = NULL;
+    return 0;
+  }
+
   SStreamDataBlock* pBlock = streamQueueNextItem(pTask->outputQueue);
   if (pBlock == NULL) {
     qDebug("stream stop dispatching since no output: task %d", pTask->taskId);
     atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
     return 0;
   }
+
+  if (pBlock->type == STREAM_INPUT__CHECKPOINT) {
+    if (streamCheckpointStartDispatch(pTask, (SStreamCheckpoint*)pBlock) < 0) {
+      streamQueueProcessFail(pTask->outputQueue);
+      atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+      return -1;
+    }
+    streamQueueProcessSuccess(pTask->outputQueue);
+    atomic_sub_fetch_32(&pTask->outputCheckpointCnt, 1);
+    taosFreeQitem(pBlock);
+    return 0;
+  }
   ASSERT(pBlock->type == STREAM_INPUT__DATA_BLOCK);
 
-  qDebug("stream dispatching: task %d", pTask->taskId);
+  streamCoalesceOutput(pTask, pBlock);
+
+  qDebug("stream dispatching: task %d, blocks %d", pTask->taskId, (int32_t)taosArrayGetSize(pBlock->blocks));
 
   int32_t code = 0;
   if (streamDispatchAllBlocks(pTask, pBlock) < 0) {
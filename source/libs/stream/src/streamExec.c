@@ -234,6 +234,11 @@ int32_t streamExecForAll(SStreamTask* pTask) {
       break;
     }
 
+    if (((SStreamQueueItem*)input)->type == STREAM_INPUT__CHECKPOINT) {
+      streamProcessCheckpointBarrier(pTask, input);
+      continue;
+    }
+
     if (pTask->taskLevel == TASK_LEVEL__SINK) {
       ASSERT(((SStreamQueueItem*)input)->type == STREAM_INPUT__DATA_BLOCK);
       streamTaskOutput(pTask, input);
@@ -275,6 +280,12 @@ int32_t streamExecForAll(SStreamTask* pTask) {
     } else {
       taosArrayDestroy(pRes);
     }
+
+    if (((SStreamQueueItem*)input)->type == STREAM_INPUT__DATA_SUBMIT) {
+      pTask->processedVer = ((SStreamDataSubmit*)input)->ver;
+    } else if (((SStreamQueueItem*)input)->type == STREAM_INPUT__MERGED_SUBMIT) {
+      pTask->processedVer = ((SStreamMergedSubmit*)input)->ver;
+    }
     streamFreeQitem(input);
   }
   return 0;
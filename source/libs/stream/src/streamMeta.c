@@ -84,6 +84,10 @@ void streamMetaClose(SStreamMeta* pMeta) {
       taosTmrStop(pTask->timer);
       pTask->timer = NULL;
     }
+    if (pTask->checkpointTmr) {
+      taosTmrStop(pTask->checkpointTmr);
+      pTask->checkpointTmr = NULL;
+    }
     tFreeSStreamTask(pTask);
     /*streamMetaReleaseTask(pMeta, pTask);*/
   }
@@ -254,7 +258,7 @@ int32_t streamMetaAbort(SStreamMeta* pMeta) {
   return 0;
 }
 
-int32_t streamLoadTasks(SStreamMeta* pMeta) {
+int32_t streamLoadTasks(SStreamMeta* pMeta, int64_t ver) {
   TBC* pCur = NULL;
   if (tdbTbcOpen(pMeta->pTaskDb, &pCur, NULL) < 0) {
     ASSERT(0);
@@ -295,6 +299,15 @@ int32_t streamLoadTasks(SStreamMeta* pMeta) {
       return -1;
     }
     pTask->taskStatus = TASK_STATUS__NORMAL;
+
+    // resume from the latest checkpoint
+    streamLoadCheckpointInfo(pTask);
+    if (streamTaskResumeFromCheckpoint(pTask, ver) < 0) {
+      tdbFree(pKey);
+      tdbFree(pVal);
+      tdbTbcClose(pCur);
+      return -1;
+    }
   }
 
   tdbFree(pKey);
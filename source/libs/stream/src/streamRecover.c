@@ -53,6 +53,42 @@ int32_t streamTaskLaunchRecover(SStreamTask* pTask, int64_t version) {
   return 0;
 }
 
+// the state of a task is only persisted at checkpoints, so a source task rescans what the vnode committed after its
+// checkpoint and before ver
+int32_t streamTaskResumeFromCheckpoint(SStreamTask* pTask, int64_t ver) {
+  if (pTask->taskLevel != TASK_LEVEL__SOURCE || pTask->chkInfo.checkpointId == 0 ||
+      pTask->chkInfo.checkpointVer >= ver) {
+    return 0;
+  }
+
+  qInfo("task %d at node %d resume from checkpoint %" PRId64 ", ver %" PRId64 " to %" PRId64, pTask->taskId,
+        pTask->nodeId, pTask->chkInfo.checkpointId, pTask->chkInfo.checkpointVer, ver);
+
+  // hold the output until the whole range is scanned
+  bool dispatch = pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH || pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH;
+  if (dispatch) {
+    atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__WAIT);
+  }
+
+  void* exec = pTask->exec.executor;
+  qStreamSourceRecoverStep1(exec, pTask->chkInfo.checkpointVer);
+  qStreamSourceRecoverStep2(exec, ver);
+  int32_t code = streamScanExec(pTask, 100);
+
+  if (dispatch) {
+    atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+    streamDispatch(pTask);
+  }
+
+  if (code < 0) {
+    qError("task %d at node %d failed to resume from checkpoint %" PRId64 " since %s", pTask->taskId, pTask->nodeId,
+           pTask->chkInfo.checkpointId, terrstr());
+    return -1;
+  }
+  pTask->processedVer = ver;
+  return 0;
+}
+
 // checkstatus
 int32_t streamTaskCheckDownstream(SStreamTask* pTask, int64_t version) {
   SStreamTaskCheckReq req = {
@@ -159,6 +159,11 @@ SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int
     goto _err;
   }
 
+  if (tdbTbOpen("checkpoint.state.db", sizeof(int32_t), 2 * sizeof(int64_t), NULL, pState->pTdbState->db,
+                &pState->pTdbState->pCheckpointDb, 0) < 0) {
+    goto _err;
+  }
+
   if (streamStateBegin(pState) < 0) {
     goto _err;
   }
@@ -173,19 +178,26 @@ _err:
   tdbTbClose(pState->pTdbState->pFillStateDb);
   tdbTbClose(pState->pTdbState->pSessionStateDb);
   tdbTbClose(pState->pTdbState->pParNameDb);
+  tdbTbClose(pState->pTdbState->pCheckpointDb);
   tdbClose(pState->pTdbState->db);
   streamStateDestroy(pState);
   return NULL;
 }
 
 void streamStateClose(SStreamState* pState) {
-  tdbCommit(pState->pTdbState->db, pState->pTdbState->txn);
-  tdbPostCommit(pState->pTdbState->db, pState->pTdbState->txn);
+  // the state of a stream task is only persisted with its checkpoint, what came after it is replayed on open
+  if (pState->pTdbState->pOwner != NULL) {
+    tdbAbort(pState->pTdbState->db, pState->pTdbState->txn);
+  } else {
+    tdbCommit(pState->pTdbState->db, pState->pTdbState->txn);
+    tdbPostCommit(pState->pTdbState->db, pState->pTdbState->txn);
+  }
   tdbTbClose(pState->pTdbState->pStateDb);
   tdbTbClose(pState->pTdbState->pFuncStateDb);
   tdbTbClose(pState->pTdbState->pFillStateDb);
   tdbTbClose(pState->pTdbState->pSessionStateDb);
   tdbTbClose(pState->pTdbState->pParNameDb);
+  tdbTbClose(pState->pTdbState->pCheckpointDb);
   tdbClose(pState->pTdbState->db);
 
   streamStateDestroy(pState);
@@ -831,6 +843,28 @@ int32_t streamStateGetParName(SStreamState* pState, int64_t groupId, void** pVal
   return tdbTbGet(pState->pTdbState->pParNameDb, &groupId, sizeof(int64_t), pVal, &len);
 }
 
+// the checkpoint info is written in the txn of the state it describes, so both are committed atomically
+int32_t streamStatePutCheckpoint(SStreamState* pState, int64_t checkpointId, int64_t checkpointVer) {
+  int32_t key = 0;
+  int64_t val[2] = {checkpointId, checkpointVer};
+  return tdbTbUpsert(pState->pTdbState->pCheckpointDb, &key, sizeof(int32_t), val, sizeof(val),
+                     pState->pTdbState->txn);
+}
+
+int32_t streamStateGetCheckpoint(SStreamState* pState, int64_t* pCheckpointId, int64_t* pCheckpointVer) {
+  int32_t key = 0;
+  void*   pVal = NULL;
+  int32_t len = 0;
+  if (tdbTbGet(pState->pTdbState->pCheckpointDb, &key, sizeof(int32_t), &pVal, &len) < 0) {
+    return -1;
+  }
+  ASSERT(len == 2 * sizeof(int64_t));
+  *pCheckpointId = ((int64_t*)pVal)[0];
+  *pCheckpointVer = ((int64_t*)pVal)[1];
+  tdbFree(pVal);
+  return 0;
+}
+
 void streamStateDestroy(SStreamState* pState) {
   taosMemoryFreeClear(pState->pTdbState);
   taosMemoryFreeClear(pState);
@@ -180,6 +180,9 @@ void tFreeSStreamTask(SStreamTask* pTask) {
   }
 
   if (pTask->pState) streamStateClose(pTask->pState);
+  taosArrayDestroyP(pTask->checkpointBarriers, taosFreeQitem);
+  taosArrayDestroy(pTask->checkpointAckTasks);
+  if (pTask->pOutputBarrier) taosFreeQitem(pTask->pOutputBarrier);
 
   taosMemoryFree(pTask);
 }
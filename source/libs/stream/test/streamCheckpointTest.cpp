@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include "streamInc.h"
+
+namespace {
+
+const char *kStatePath = "/tmp/stream_checkpoint_test";
+
+SStreamCheckpoint *newBarrier(int64_t checkpointId, int32_t childId, int32_t code) {
+  SStreamCheckpoint *pBarrier = (SStreamCheckpoint *)taosAllocateQitem(sizeof(SStreamCheckpoint), DEF_QITEM, 0);
+  memset(pBarrier, 0, sizeof(SStreamCheckpoint));
+  pBarrier->type = STREAM_INPUT__CHECKPOINT;
+  pBarrier->checkpointId = checkpointId;
+  pBarrier->childId = childId;
+  pBarrier->code = code;
+  return pBarrier;
+}
+
+}  // namespace
+
+TEST(TD_STREAM_CHECKPOINT_TEST, reqRspCodec) {
+  SStreamCheckpointReq req = {0};
+  req.streamId = 1001;
+  req.checkpointId = 7;
+  req.downstreamTaskId = 3;
+  req.downstreamNodeId = 2;
+  req.upstreamTaskId = 5;
+  req.upstreamNodeId = 4;
+  req.childId = 1;
+  req.expireTime = -1;
+  req.taskLevel = TASK_LEVEL__AGG;
+  req.code = TSDB_CODE_STREAM_CHECKPOINT_ABORTED;
+
+  int32_t tlen = 0;
+  int32_t code = 0;
+  tEncodeSize(tEncodeSStreamCheckpointReq, &req, tlen, code);
+  ASSERT_EQ(code, 0);
+
+  void    *buf = taosMemoryCalloc(1, tlen);
+  SEncoder encoder;
+  tEncoderInit(&encoder, (uint8_t *)buf, tlen);
+  ASSERT_GT(tEncodeSStreamCheckpointReq(&encoder, &req), 0);
+  tEncoderClear(&encoder);
+
+  SStreamCheckpointReq decoded = {0};
+  SDecoder             decoder;
+  tDecoderInit(&decoder, (uint8_t *)buf, tlen);
+  ASSERT_EQ(tDecodeSStreamCheckpointReq(&decoder, &decoded), 0);
+  tDecoderClear(&decoder);
+  taosMemoryFree(buf);
+
+  EXPECT_EQ(decoded.streamId, req.streamId);
+  EXPECT_EQ(decoded.checkpointId, req.checkpointId);
+  EXPECT_EQ(decoded.downstreamTaskId, req.downstreamTaskId);
+  EXPECT_EQ(decoded.upstreamTaskId, req.upstreamTaskId);
+  EXPECT_EQ(decoded.childId, req.childId);
+  EXPECT_EQ(decoded.taskLevel, req.taskLevel);
+  EXPECT_EQ(decoded.code, req.code);
+
+  SStreamCheckpointRsp rsp = {0};
+  rsp.streamId = 1001;
+  rsp.checkpointId = 7;
+  rsp.downstreamTaskId = 3;
+  rsp.upstreamTaskId = 5;
+  rsp.childId = 1;
+  rsp.code = TSDB_CODE_OUT_OF_MEMORY;
+
+  tEncodeSize(tEncodeSStreamCheckpointRsp, &rsp, tlen, code);
+  ASSERT_EQ(code, 0);
+  buf = taosMemoryCalloc(1, tlen);
+  tEncoderInit(&encoder, (uint8_t *)buf, tlen);
+  ASSERT_GT(tEncodeSStreamCheckpointRsp(&encoder, &rsp), 0);
+  tEncoderClear(&encoder);
+
+  SStreamCheckpointRsp decodedRsp = {0};
+  tDecoderInit(&decoder, (uint8_t *)buf, tlen);
+  ASSERT_EQ(tDecodeSStreamCheckpointRsp(&decoder, &decodedRsp), 0);
+  tDecoderClear(&decoder);
+  taosMemoryFree(buf);
+
+  EXPECT_EQ(decodedRsp.checkpointId, rsp.checkpointId);
+  EXPECT_EQ(decodedRsp.downstreamTaskId, rsp.downstreamTaskId);
+  EXPECT_EQ(decodedRsp.code, rsp.code);
+}
+
+TEST(TD_STREAM_CHECKPOINT_TEST, alignDedupe) {
+  SStreamTask task = {0};
+  task.taskLevel = TASK_LEVEL__AGG;
+  task.childEpInfo = taosArrayInit(2, sizeof(void *));
+  SStreamChildEpInfo child0 = {0};
+  SStreamChildEpInfo child1 = {0};
+  child1.childId = 1;
+  SStreamChildEpInfo *pChild = &child0;
+  taosArrayPush(task.childEpInfo, &pChild);
+  pChild = &child1;
+  taosArrayPush(task.childEpInfo, &pChild);
+
+  EXPECT_EQ(streamAlignCheckpoint(&task, newBarrier(9, 0, 0)), 1);
+  EXPECT_EQ(task.checkpointingId, 9);
+
+  // a barrier resent by child 0 is kept for its rsp but does not complete the alignment
+  EXPECT_EQ(streamAlignCheckpoint(&task, newBarrier(9, 0, 0)), 1);
+
+  // the failure carried by a barrier is kept for the whole checkpoint
+  EXPECT_EQ(streamAlignCheckpoint(&task, newBarrier(9, 1, TSDB_CODE_STREAM_CHECKPOINT_ABORTED)), 0);
+  EXPECT_EQ(task.checkpointCode, TSDB_CODE_STREAM_CHECKPOINT_ABORTED);
+  EXPECT_EQ(taosArrayGetSize(task.checkpointBarriers), 3);
+
+  taosArrayDestroyP(task.checkpointBarriers, (FDelete)taosFreeQitem);
+  taosArrayDestroy(task.childEpInfo);
+}
+
+TEST(TD_STREAM_CHECKPOINT_TEST, stateOnlyPersistedAtCheckpoint) {
+  taosRemoveDir(kStatePath);
+
+  SStreamTask task = {0};
+  task.taskId = 1;
+
+  SStreamState *pState = streamStateOpen((char *)kStatePath, &task, true, -1, -1);
+  ASSERT_NE(pState, nullptr);
+
+  SWinKey key = {0};
+  key.ts = 1000;
+  key.groupId = 1;
+  int64_t val = 1;
+  ASSERT_EQ(streamStatePut(pState, &key, &val, sizeof(val)), 0);
+  ASSERT_EQ(streamStatePutCheckpoint(pState, 1, 100), 0);
+  ASSERT_EQ(streamStateCommit(pState), 0);
+
+  // written after the checkpoint, dropped when the task state is closed
+  key.ts = 2000;
+  ASSERT_EQ(streamStatePut(pState, &key, &val, sizeof(val)), 0);
+  ASSERT_EQ(streamStatePutCheckpoint(pState, 2, 200), 0);
+  streamStateClose(pState);
+
+  pState = streamStateOpen((char *)kStatePath, &task, true, -1, -1);
+  ASSERT_NE(pState, nullptr);
+
+  int64_t checkpointId = 0;
+  int64_t checkpointVer = 0;
+  ASSERT_EQ(streamStateGetCheckpoint(pState, &checkpointId, &checkpointVer), 0);
+  EXPECT_EQ(checkpointId, 1);
+  EXPECT_EQ(checkpointVer, 100);
+
+  void   *pVal = NULL;
+  int32_t vLen = 0;
+  key.ts = 1000;
+  EXPECT_EQ(streamStateGet(pState, &key, &pVal, &vLen), 0);
+  streamStateReleaseBuf(pState, &key, pVal);
+  pVal = NULL;
+  key.ts = 2000;
+  EXPECT_LT(streamStateGet(pState, &key, &pVal, &vLen), 0);
+
+  streamStateClose(pState);
+  taosRemoveDir(kStatePath);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include "streamInc.h"
+#include "tglobal.h"
+
+namespace {
+
+const int32_t kNumOfRows = 1000;
+
+SSDataBlock *newDataBlock() {
+  SSDataBlock *pBlock = createDataBlock();
+
+  SColumnInfoData col0 = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, 8, 1);
+  blockDataAppendColInfo(pBlock, &col0);
+  SColumnInfoData col1 = createColumnInfoData(TSDB_DATA_TYPE_INT, 4, 2);
+  blockDataAppendColInfo(pBlock, &col1);
+  SColumnInfoData col2 = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 32, 3);
+  blockDataAppendColInfo(pBlock, &col2);
+
+  blockDataEnsureCapacity(pBlock, kNumOfRows);
+
+  SColumnInfoData *p0 = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData *p1 = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData *p2 = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 2);
+  char             buf[32] = {0};
+  char             var[40] = {0};
+  for (int32_t i = 0; i < kNumOfRows; ++i) {
+    int64_t ts = 1577808000000 + i * 1000;
+    colDataAppend(p0, i, (const char *)&ts, false);
+
+    int32_t v = i % 100;
+    colDataAppend(p1, i, (const char *)&v, (i % 3 == 0));
+
+    sprintf(buf, "tb_%d", i % 8);
+    STR_TO_VARSTR(var, buf);
+    colDataAppend(p2, i, var, (i % 11 == 0));
+    pBlock->info.rows++;
+  }
+
+  pBlock->info.type = STREAM_NORMAL;
+  pBlock->info.window.skey = 1577808000000;
+  pBlock->info.window.ekey = 1577808000000 + (kNumOfRows - 1) * 1000;
+  pBlock->info.version = 17;
+  pBlock->info.watermark = 5;
+  strcpy(pBlock->info.parTbName, "stb_group_1");
+  return pBlock;
+}
+
+// add the block to a dispatch msg, send it through the codec and take the block back out on the receiver side
+void dispatchRoundTrip(const SSDataBlock *pBlock, int8_t *pCompressed, SStreamDataBlock *pData) {
+  SStreamDispatchReq req = {0};
+  req.streamId = 1001;
+  req.taskId = 2;
+  req.upstreamChildId = 3;
+  req.blockNum = 1;
+  req.data = taosArrayInit(1, sizeof(void *));
+  req.dataLen = taosArrayInit(1, sizeof(int32_t));
+  ASSERT_EQ(streamAddBlockToDispatchMsg(pBlock, &req), 0);
+  *pCompressed = ((SRetrieveTableRsp *)taosArrayGetP(req.data, 0))->compressed;
+
+  int32_t tlen = 0;
+  int32_t code = 0;
+  tEncodeSize(tEncodeStreamDispatchReq, &req, tlen, code);
+  ASSERT_EQ(code, 0);
+
+  void    *buf = taosMemoryCalloc(1, tlen);
+  SEncoder encoder;
+  tEncoderInit(&encoder, (uint8_t *)buf, tlen);
+  ASSERT_GT(tEncodeStreamDispatchReq(&encoder, &req), 0);
+  tEncoderClear(&encoder);
+  taosArrayDestroyP(req.data, streamDispatchBufPut);
+  taosArrayDestroy(req.dataLen);
+
+  SStreamDispatchReq decoded = {0};
+  SDecoder           decoder;
+  tDecoderInit(&decoder, (uint8_t *)buf, tlen);
+  ASSERT_EQ(tDecodeStreamDispatchReq(&decoder, &decoded), 0);
+  tDecoderClear(&decoder);
+  taosMemoryFree(buf);
+
+  ASSERT_EQ(streamDispatchReqToData(&decoded, pData), 0);
+  tDeleteStreamDispatchReq(&decoded);
+}
+
+void checkDataBlock(const SSDataBlock *pExpect, const SSDataBlock *pBlock) {
+  ASSERT_EQ(pBlock->info.rows, pExpect->info.rows);
+  ASSERT_EQ(pBlock->info.type, pExpect->info.type);
+  ASSERT_EQ(pBlock->info.window.skey, pExpect->info.window.skey);
+  ASSERT_EQ(pBlock->info.window.ekey, pExpect->info.window.ekey);
+  ASSERT_EQ(pBlock->info.version, pExpect->info.version);
+  ASSERT_EQ(pBlock->info.watermark, pExpect->info.watermark);
+  ASSERT_STREQ(pBlock->info.parTbName, pExpect->info.parTbName);
+  ASSERT_EQ(taosArrayGetSize(pBlock->pDataBlock), taosArrayGetSize(pExpect->pDataBlock));
+
+  for (int32_t iCol = 0; iCol < taosArrayGetSize(pExpect->pDataBlock); ++iCol) {
+    SColumnInfoData *pCol = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, iCol);
+    SColumnInfoData *pColExpect = (SColumnInfoData *)taosArrayGet(pExpect->pDataBlock, iCol);
+    ASSERT_EQ(pCol->info.type, pColExpect->info.type);
+
+    for (int32_t i = 0; i < pExpect->info.rows; ++i) {
+      bool isNull = colDataIsNull_s(pColExpect, i);
+      ASSERT_EQ(colDataIsNull_s(pCol, i), isNull);
+      if (isNull) continue;
+
+      char *pVal = colDataGetData(pCol, i);
+      char *pValExpect = colDataGetData(pColExpect, i);
+      if (IS_VAR_DATA_TYPE(pColExpect->info.type)) {
+        ASSERT_EQ(varDataTLen(pVal), varDataTLen(pValExpect));
+        ASSERT_EQ(memcmp(pVal, pValExpect, varDataTLen(pValExpect)), 0);
+      } else {
+        ASSERT_EQ(memcmp(pVal, pValExpect, pColExpect->info.bytes), 0);
+      }
+    }
+  }
+}
+
+void destroyStreamData(SStreamDataBlock *pData) {
+  for (int32_t i = 0; i < taosArrayGetSize(pData->blocks); ++i) {
+    blockDataFreeRes((SSDataBlock *)taosArrayGet(pData->blocks, i));
+  }
+  taosArrayDestroy(pData->blocks);
+}
+
+}  // namespace
+
+TEST(TD_STREAM_DISPATCH_TEST, compressedRoundTrip) {
+  int32_t      compressColData = tsCompressColData;
+  SSDataBlock *pBlock = newDataBlock();
+
+  // off by default, the downstream before the compressed block version can not decode it
+  SStreamDataBlock raw = {0};
+  int8_t           compressed = -1;
+  tsCompressColData = -1;
+  dispatchRoundTrip(pBlock, &compressed, &raw);
+  ASSERT_EQ(compressed, 0);
+  ASSERT_EQ(taosArrayGetSize(raw.blocks), 1);
+  checkDataBlock(pBlock, (SSDataBlock *)taosArrayGet(raw.blocks, 0));
+  destroyStreamData(&raw);
+
+  // always compressed
+  SStreamDataBlock cmpr = {0};
+  tsCompressColData = 0;
+  dispatchRoundTrip(pBlock, &compressed, &cmpr);
+  ASSERT_EQ(compressed, 1);
+  ASSERT_EQ(taosArrayGetSize(cmpr.blocks), 1);
+  checkDataBlock(pBlock, (SSDataBlock *)taosArrayGet(cmpr.blocks, 0));
+  destroyStreamData(&cmpr);
+
+  // compressed only if a column is larger than the threshold
+  SStreamDataBlock small = {0};
+  tsCompressColData = 100000000;
+  dispatchRoundTrip(pBlock, &compressed, &small);
+  ASSERT_EQ(compressed, 0);
+  checkDataBlock(pBlock, (SSDataBlock *)taosArrayGet(small.blocks, 0));
+  destroyStreamData(&small);
+
+  SStreamDataBlock large = {0};
+  tsCompressColData = kNumOfRows * sizeof(int32_t) - 1;
+  dispatchRoundTrip(pBlock, &compressed, &large);
+  ASSERT_EQ(compressed, 1);
+  checkDataBlock(pBlock, (SSDataBlock *)taosArrayGet(large.blocks, 0));
+  destroyStreamData(&large);
+
+  tsCompressColData = compressColData;
+  blockDataDestroy(pBlock);
+  streamDispatchBufPoolCleanUp();
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
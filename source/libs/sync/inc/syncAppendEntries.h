@@ -90,6 +90,9 @@ extern "C" {
 
 int32_t syncNodeOnAppendEntries(SSyncNode* ths, const SRpcMsg* pMsg);
 
+int32_t         syncLogAppendEntriesCheck(SSyncNode* ths, const SyncAppendEntries* pMsg, SyncIndex* pLastIndex);
+SSyncRaftEntry* syncLogAppendEntriesToRaftEntry(const SyncAppendEntries* pMsg, uint32_t offset, uint32_t bytes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,13 +30,23 @@ extern "C" {
 
 #define SYNC_SNAPSHOT_RETRY_MS 5000
 
+// max number of data blocks in flight, the receiver buffers the same number of out-of-order blocks
+#define SYNC_SNAPSHOT_WINDOW_SIZE 8
+
+typedef struct SSyncSnapBlock {
+  int32_t seq;
+  int32_t blockLen;
+  void   *pBlock;
+  bool    resent;
+} SSyncSnapBlock;
+
 typedef struct SSyncSnapshotSender {
   bool           start;
-  int32_t        seq;
-  int32_t        ack;
+  int32_t        seq;  // the last seq read and sent
+  int32_t        ack;  // cumulative ack of the receiver
   void          *pReader;
-  void          *pCurrentBlock;
-  int32_t        blockLen;
+  bool           readFinish;
+  SSyncSnapBlock blocks[SYNC_SNAPSHOT_WINDOW_SIZE];  // blocks of (ack, seq] kept for retransmission
   SSnapshotParam snapshotParam;
   SSnapshot      snapshot;
   SSyncCfg       lastConfig;
@@ -63,7 +73,7 @@ int32_t              snapshotReSend(SSyncSnapshotSender *pSender);
 typedef struct SSyncSnapshotReceiver {
   // update when pre snapshot
   bool     start;
-  int32_t  ack;
+  int32_t  ack;  // all blocks of seq <= ack are written
   SyncTerm term;
   SRaftId  fromId;
   int64_t  startTime;
@@ -72,6 +82,7 @@ typedef struct SSyncSnapshotReceiver {
   void          *pWriter;
   SSnapshotParam snapshotParam;
   SSnapshot      snapshot;
+  SSyncSnapBlock blocks[SYNC_SNAPSHOT_WINDOW_SIZE];  // out-of-order blocks of (ack + 1, ack + window]
 
   // init when create
   SSyncNode *pSyncNode;
@@ -127,17 +127,48 @@ int32_t syncNodeFollowerCommit(SSyncNode* ths, SyncIndex newCommitIndex) {
   return 0;
 }
 
-SSyncRaftEntry* syncLogAppendEntriesToRaftEntry(const SyncAppendEntries* pMsg) {
-  SSyncRaftEntry* pEntry = taosMemoryMalloc(pMsg->dataLen);
+SSyncRaftEntry* syncLogAppendEntriesToRaftEntry(const SyncAppendEntries* pMsg, uint32_t offset, uint32_t bytes) {
+  SSyncRaftEntry* pEntry = taosMemoryMalloc(bytes);
   if (pEntry == NULL) {
     terrno = TSDB_CODE_OUT_OF_MEMORY;
     return NULL;
   }
-  (void)memcpy(pEntry, pMsg->data, pMsg->dataLen);
-  ASSERT(pEntry->bytes == pMsg->dataLen);
+  (void)memcpy(pEntry, pMsg->data + offset, bytes);
+  ASSERT(pEntry->bytes == bytes);
   return pEntry;
 }
 
+// check the consecutive entries packed in the msg, and get the index of the last one
+int32_t syncLogAppendEntriesCheck(SSyncNode* ths, const SyncAppendEntries* pMsg, SyncIndex* pLastIndex) {
+  SyncIndex index = pMsg->prevLogIndex;
+  uint32_t  offset = 0;
+
+  while (offset < pMsg->dataLen) {
+    SSyncRaftEntry head;
+    if (pMsg->dataLen - offset < sizeof(SSyncRaftEntry)) {
+      sError("vgId:%d, incomplete append entries received. prev index:%" PRId64 ", term:%" PRId64
+             ", datalen:%d, offset:%u",
+             ths->vgId, pMsg->prevLogIndex, pMsg->prevLogTerm, pMsg->dataLen, offset);
+      return -1;
+    }
+
+    (void)memcpy(&head, pMsg->data + offset, sizeof(SSyncRaftEntry));
+    if (head.bytes < sizeof(SSyncRaftEntry) || head.bytes > pMsg->dataLen - offset || head.index != index + 1 ||
+        head.term < 0) {
+      sError("vgId:%d, invalid entry in append entries. index:%" PRId64 ", term:%" PRId64 ", bytes:%u, prevLogIndex:%" PRId64
+             ", prevLogTerm:%" PRId64 ", expect index:%" PRId64,
+             ths->vgId, head.index, head.term, head.bytes, pMsg->prevLogIndex, pMsg->prevLogTerm, index + 1);
+      return -1;
+    }
+
+    index = head.index;
+    offset += head.bytes;
+  }
+
+  *pLastIndex = index;
+  return 0;
+}
+
 int32_t syncNodeOnAppendEntries(SSyncNode* ths, const SRpcMsg* pRpcMsg) {
   SyncAppendEntries* pMsg = pRpcMsg->pCont;
   SRpcMsg            rpcRsp = {0};
@@ -181,32 +212,44 @@ int32_t syncNodeOnAppendEntries(SSyncNode* ths, const SRpcMsg* pRpcMsg) {
     goto _IGNORE;
   }
 
-  SSyncRaftEntry* pEntry = syncLogAppendEntriesToRaftEntry(pMsg);
-
-  if (pEntry == NULL) {
-    sError("vgId:%d, failed to get raft entry from append entries since %s", ths->vgId, terrstr());
-    goto _IGNORE;
-  }
-
-  if (pMsg->prevLogIndex + 1 != pEntry->index || pEntry->term < 0) {
-    sError("vgId:%d, invalid previous log index in msg. index:%" PRId64 ",  term:%" PRId64 ", prevLogIndex:%" PRId64
-           ", prevLogTerm:%" PRId64,
-           ths->vgId, pEntry->index, pEntry->term, pMsg->prevLogIndex, pMsg->prevLogTerm);
+  SyncIndex lastIndex = SYNC_INDEX_INVALID;
+  if (syncLogAppendEntriesCheck(ths, pMsg, &lastIndex) < 0) {
     goto _IGNORE;
   }
 
-  sTrace("vgId:%d, recv append entries msg. index:%" PRId64 ", term:%" PRId64 ", preLogIndex:%" PRId64
+  sTrace("vgId:%d, recv append entries msg. index:%" PRId64 " - %" PRId64 ", term:%" PRId64 ", preLogIndex:%" PRId64
          ", prevLogTerm:%" PRId64 " commitIndex:%" PRId64 "",
-         pMsg->vgId, pMsg->prevLogIndex + 1, pMsg->term, pMsg->prevLogIndex, pMsg->prevLogTerm, pMsg->commitIndex);
+         pMsg->vgId, pMsg->prevLogIndex + 1, lastIndex, pMsg->term, pMsg->prevLogIndex, pMsg->prevLogTerm,
+         pMsg->commitIndex);
+
+  // accept the batch in order, all of them are persisted by one proceed below and acked by one reply
+  SyncTerm prevTerm = pMsg->prevLogTerm;
+  uint32_t offset = 0;
+  while (offset < pMsg->dataLen) {
+    uint32_t        bytes = ((const SSyncRaftEntry*)(pMsg->data + offset))->bytes;
+    SSyncRaftEntry* pEntry = syncLogAppendEntriesToRaftEntry(pMsg, offset, bytes);
+    if (pEntry == NULL) {
+      sError("vgId:%d, failed to get raft entry from append entries since %s", ths->vgId, terrstr());
+      goto _SEND_RESPONSE;
+    }
+    offset += bytes;
 
-  // accept
-  if (syncLogBufferAccept(ths->pLogBuf, ths, pEntry, pMsg->prevLogTerm) < 0) {
-    goto _SEND_RESPONSE;
+    SyncTerm term = pEntry->term;
+    if (syncLogBufferAccept(ths->pLogBuf, ths, pEntry, prevTerm) < 0) {
+      goto _SEND_RESPONSE;
+    }
+    prevTerm = term;
   }
+  pReply->lastSendIndex = lastIndex;
   accepted = true;
 
 _SEND_RESPONSE:
   pReply->matchIndex = syncLogBufferProceed(ths->pLogBuf, ths, &pReply->lastMatchTerm);
+  if (pReply->matchIndex < 0) {
+    // nothing is acked before it is durable, the leader resends the entries
+    sError("vgId:%d, failed to proceed sync log buffer since %s", ths->vgId, terrstr());
+    goto _IGNORE;
+  }
   bool matched = (pReply->matchIndex >= pReply->lastSendIndex);
   if (accepted && matched) {
     pReply->success = true;
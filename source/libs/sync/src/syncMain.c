@@ -2370,6 +2370,11 @@ int32_t syncNodeAppend(SSyncNode* ths, SSyncRaftEntry* pEntry) {
 
   // proceed match index, with replicating on needed
   SyncIndex matchIndex = syncLogBufferProceed(ths->pLogBuf, ths, NULL);
+  if (matchIndex < 0) {
+    sError("vgId:%d, failed to proceed sync log buffer since %s, index:%" PRId64, ths->vgId, terrstr(),
+           pEntry->index);
+    return -1;
+  }
 
   sTrace("vgId:%d, append raft entry. index: %" PRId64 ", term: %" PRId64 " pBuf: [%" PRId64 " %" PRId64 " %" PRId64
          ", %" PRId64 ")",
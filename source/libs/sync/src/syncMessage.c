@@ -156,7 +156,19 @@ int32_t syncBuildAppendEntriesReply(SRpcMsg* pMsg, int32_t vgId) {
 
 int32_t syncBuildAppendEntriesFromRaftLog(SSyncNode* pNode, SSyncRaftEntry* pEntry, SyncTerm prevLogTerm,
                                           SRpcMsg* pRpcMsg) {
-  uint32_t dataLen = pEntry->bytes;
+  return syncBuildAppendEntriesFromRaftEntries(pNode, &pEntry, 1, prevLogTerm, pRpcMsg);
+}
+
+// the entries are consecutive, and packed back to back in data
+int32_t syncBuildAppendEntriesFromRaftEntries(SSyncNode* pNode, SSyncRaftEntry** ppEntries, int32_t nEntry,
+                                              SyncTerm prevLogTerm, SRpcMsg* pRpcMsg) {
+  ASSERT(nEntry > 0);
+  uint32_t dataLen = 0;
+  for (int32_t i = 0; i < nEntry; i++) {
+    ASSERT(ppEntries[i]->index == ppEntries[0]->index + i);
+    dataLen += ppEntries[i]->bytes;
+  }
+
   uint32_t bytes = sizeof(SyncAppendEntries) + dataLen;
   pRpcMsg->contLen = bytes;
   pRpcMsg->pCont = rpcMallocCont(pRpcMsg->contLen);
@@ -170,9 +182,13 @@ int32_t syncBuildAppendEntriesFromRaftLog(SSyncNode* pNode, SSyncRaftEntry* pEnt
   pMsg->msgType = pRpcMsg->msgType = TDMT_SYNC_APPEND_ENTRIES;
   pMsg->dataLen = dataLen;
 
-  (void)memcpy(pMsg->data, pEntry, dataLen);
+  uint32_t offset = 0;
+  for (int32_t i = 0; i < nEntry; i++) {
+    (void)memcpy(pMsg->data + offset, ppEntries[i], ppEntries[i]->bytes);
+    offset += ppEntries[i]->bytes;
+  }
 
-  pMsg->prevLogIndex = pEntry->index - 1;
+  pMsg->prevLogIndex = ppEntries[0]->index - 1;
   pMsg->prevLogTerm = prevLogTerm;
   pMsg->vgId = pNode->vgId;
   pMsg->srcId = pNode->myRaftId;
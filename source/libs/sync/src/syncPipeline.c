@@ -25,6 +25,7 @@
 #include "syncRespMgr.h"
 #include "syncSnapshot.h"
 #include "syncUtil.h"
+#include "tglobal.h"
 
 static bool syncIsMsgBlock(tmsg_t type) {
   return (type == TDMT_VND_CREATE_TABLE) || (type == TDMT_VND_ALTER_TABLE) || (type == TDMT_VND_DROP_TABLE) ||
@@ -378,6 +379,7 @@ int64_t syncLogBufferProceed(SSyncLogBuffer* pBuf, SSyncNode* pNode, SyncTerm* p
 
   SSyncLogStore* pLogStore = pNode->pLogStore;
   int64_t        matchIndex = pBuf->matchIndex;
+  int64_t        persistedIndex = matchIndex;
 
   while (pBuf->matchIndex + 1 < pBuf->endIndex) {
     int64_t index = pBuf->matchIndex + 1;
@@ -430,13 +432,25 @@ int64_t syncLogBufferProceed(SSyncLogBuffer* pBuf, SSyncNode* pNode, SyncTerm* p
     }
     ASSERT(pEntry->index == pBuf->matchIndex);
 
-    // update my match index
     matchIndex = pBuf->matchIndex;
-    syncIndexMgrSetIndex(pNode->pMatchIndex, &pNode->myRaftId, pBuf->matchIndex);
   }  // end of while
 
 _out:
   pBuf->matchIndex = matchIndex;
+
+  // group commit: one fsync covers all entries persisted above, before my match index acknowledges them
+  if (matchIndex > persistedIndex) {
+    if (pLogStore->syncLogFsync(pLogStore) < 0) {
+      // not durable, so not matched. The next proceed truncates and persists them again.
+      sError("vgId:%d, failed to fsync sync log entries since %s. index:%" PRId64 " - %" PRId64, pNode->vgId,
+             terrstr(), persistedIndex + 1, matchIndex);
+      pBuf->matchIndex = persistedIndex;
+      syncLogBufferValidate(pBuf);
+      taosThreadMutexUnlock(&pBuf->mutex);
+      return -1;
+    }
+    syncIndexMgrSetIndex(pNode->pMatchIndex, &pNode->myRaftId, matchIndex);
+  }
   if (pMatchTerm) {
     *pMatchTerm = pBuf->entries[(matchIndex + pBuf->size) % pBuf->size].pItem->term;
   }
@@ -816,33 +830,36 @@ int32_t syncLogReplMgrReplicateAttemptedOnce(SSyncLogReplMgr* pMgr, SSyncNode* p
   int64_t  nowMs = taosGetMonoTimestampMs();
   int64_t  limit = pMgr->size >> 1;
 
-  for (SyncIndex index = pMgr->endIndex; index <= pNode->pLogBuf->matchIndex; index++) {
-    if (batchSize < count++ || limit <= index - pMgr->startIndex) {
+  SyncIndex index = pMgr->endIndex;
+  while (index <= pNode->pLogBuf->matchIndex) {
+    if (batchSize < count || limit <= index - pMgr->startIndex) {
       break;
     }
     if (pMgr->startIndex + 1 < index && pMgr->states[(index - 1) % pMgr->size].barrier) {
       break;
     }
-    int64_t  pos = index % pMgr->size;
-    SRaftId* pDestId = &pNode->replicasId[pMgr->peerId];
-    bool     barrier = false;
-    SyncTerm term = -1;
-    if (syncLogBufferReplicateOneTo(pMgr, pNode, index, &term, pDestId, &barrier) < 0) {
+
+    // send the consecutive entries in one msg, bounded by the window left. followers before the batching
+    // accept one entry per msg only, so it stays off until all of the dnodes are upgraded
+    int64_t maxNum = TMIN(batchSize - count + 1, limit - (index - pMgr->startIndex));
+    maxNum = TMIN(maxNum, pNode->pLogBuf->matchIndex - index + 1);
+    if (!tsSyncBatchAppendEntries) maxNum = 1;
+    int32_t num = 0;
+    bool    barrier = false;
+    if (syncLogBufferReplicateBatchTo(pMgr, pNode, index, (int32_t)maxNum, pDestId, nowMs, &num, &barrier) < 0) {
       sError("vgId:%d, failed to replicate log entry since %s. index: %" PRId64 ", dest: 0x%016" PRIx64 "", pNode->vgId,
              terrstr(), index, pDestId->addr);
       return -1;
     }
-    pMgr->states[pos].barrier = barrier;
-    pMgr->states[pos].timeMs = nowMs;
-    pMgr->states[pos].term = term;
-    pMgr->states[pos].acked = false;
+    count += num;
+    index += num;
 
-    pMgr->endIndex = index + 1;
+    pMgr->endIndex = index;
     if (barrier) {
       sInfo("vgId:%d, replicated sync barrier to dest: %" PRIx64 ". index: %" PRId64 ", term: %" PRId64
             ", repl mgr: rs(%d) [%" PRId64 " %" PRId64 ", %" PRId64 ")",
-            pNode->vgId, pDestId->addr, index, term, pMgr->restored, pMgr->startIndex, pMgr->matchIndex,
-            pMgr->endIndex);
+            pNode->vgId, pDestId->addr, index - 1, pMgr->states[(index - 1) % pMgr->size].term, pMgr->restored,
+            pMgr->startIndex, pMgr->matchIndex, pMgr->endIndex);
       break;
     }
   }
@@ -1124,3 +1141,80 @@ _err:
   }
   return -1;
 }
+
+int32_t syncLogBufferReplicateBatchTo(SSyncLogReplMgr* pMgr, SSyncNode* pNode, SyncIndex index, int32_t maxNum,
+                                      SRaftId* pDestId, int64_t nowMs, int32_t* pNum, bool* pBarrier) {
+  SSyncRaftEntry* entries[SYNC_APPEND_ENTRIES_MAX_NUM] = {0};
+  bool            inBuf[SYNC_APPEND_ENTRIES_MAX_NUM] = {0};
+  SRpcMsg         msgOut = {0};
+  SyncTerm        prevLogTerm = -1;
+  SSyncLogBuffer* pBuf = pNode->pLogBuf;
+  int32_t         num = 0;
+  int64_t         bytes = 0;
+  int32_t         ret = -1;
+
+  *pNum = 0;
+  *pBarrier = false;
+  maxNum = TMAX(1, TMIN(maxNum, SYNC_APPEND_ENTRIES_MAX_NUM));
+
+  // collect the consecutive entries, a barrier ends the batch
+  while (num < maxNum) {
+    SSyncRaftEntry* pEntry = syncLogBufferGetOneEntry(pBuf, pNode, index + num, &inBuf[num]);
+    if (pEntry == NULL) {
+      if (num > 0) break;
+      sError("vgId:%d, failed to get raft entry for index: %" PRId64 "", pNode->vgId, index);
+      if (terrno == TSDB_CODE_WAL_LOG_NOT_EXIST) {
+        sInfo("vgId:%d, reset sync log repl mgr of peer: %" PRIx64 " since %s. index: %" PRId64, pNode->vgId,
+              pDestId->addr, terrstr(), index);
+        (void)syncLogReplMgrReset(pMgr);
+      }
+      goto _out;
+    }
+    if (num > 0 && bytes + pEntry->bytes > SYNC_APPEND_ENTRIES_MAX_BYTES) {
+      if (!inBuf[num]) syncEntryDestroy(pEntry);
+      break;
+    }
+
+    entries[num++] = pEntry;
+    bytes += pEntry->bytes;
+    if (syncLogIsReplicationBarrier(pEntry)) {
+      *pBarrier = true;
+      break;
+    }
+  }
+
+  prevLogTerm = syncLogReplMgrGetPrevLogTerm(pMgr, pNode, index);
+  if (prevLogTerm < 0) {
+    sError("vgId:%d, failed to get prev log term since %s. index: %" PRId64 "", pNode->vgId, terrstr(), index);
+    goto _out;
+  }
+
+  if (syncBuildAppendEntriesFromRaftEntries(pNode, entries, num, prevLogTerm, &msgOut) < 0) {
+    sError("vgId:%d, failed to get append entries for index:%" PRId64 ", num:%d", pNode->vgId, index, num);
+    goto _out;
+  }
+
+  (void)syncNodeSendAppendEntries(pNode, pDestId, &msgOut);
+  msgOut.pCont = NULL;
+
+  for (int32_t i = 0; i < num; i++) {
+    int64_t pos = (index + i) % pMgr->size;
+    pMgr->states[pos].barrier = syncLogIsReplicationBarrier(entries[i]);
+    pMgr->states[pos].timeMs = nowMs;
+    pMgr->states[pos].term = entries[i]->term;
+    pMgr->states[pos].acked = false;
+  }
+  *pNum = num;
+  ret = 0;
+
+  sTrace("vgId:%d, replicate %d msgs index: [%" PRId64 ", %" PRId64 "] bytes: %" PRId64 " prevterm: %" PRId64
+         " to dest: 0x%016" PRIx64,
+         pNode->vgId, num, index, index + num - 1, bytes, prevLogTerm, pDestId->addr);
+
+_out:
+  rpcFreeCont(msgOut.pCont);
+  for (int32_t i = 0; i < num; i++) {
+    if (!inBuf[i]) syncEntryDestroy(entries[i]);
+  }
+  return ret;
+}
@@ -25,6 +25,7 @@
 static int32_t   raftLogRestoreFromSnapshot(struct SSyncLogStore* pLogStore, SyncIndex snapshotIndex);
 static int32_t   raftLogAppendEntry(struct SSyncLogStore* pLogStore, SSyncRaftEntry* pEntry);
 static int32_t   raftLogTruncate(struct SSyncLogStore* pLogStore, SyncIndex fromIndex);
+static int32_t   raftLogFsync(struct SSyncLogStore* pLogStore);
 static bool      raftLogExist(struct SSyncLogStore* pLogStore, SyncIndex index);
 static int32_t   raftLogUpdateCommitIndex(SSyncLogStore* pLogStore, SyncIndex index);
 static SyncIndex raftlogCommitIndex(SSyncLogStore* pLogStore);
@@ -74,6 +75,7 @@ SSyncLogStore* logStoreCreate(SSyncNode* pSyncNode) {
   pLogStore->syncLogAppendEntry = raftLogAppendEntry;
   pLogStore->syncLogGetEntry = raftLogGetEntry;
   pLogStore->syncLogTruncate = raftLogTruncate;
+  pLogStore->syncLogFsync = raftLogFsync;
   pLogStore->syncLogWriteIndex = raftLogWriteIndex;
   pLogStore->syncLogExist = raftLogExist;
 
@@ -224,6 +226,17 @@ static int32_t raftLogAppendEntry(struct SSyncLogStore* pLogStore, SSyncRaftEntr
   return 0;
 }
 
+// fsync all entries appended so far, according to the wal level
+static int32_t raftLogFsync(struct SSyncLogStore* pLogStore) {
+  SSyncLogStoreData* pData = pLogStore->data;
+  SWal*              pWal = pData->pWal;
+
+  int64_t tsBegin = taosGetTimestampNs();
+  int32_t code = walFsync(pWal, false);
+  sNTrace(pData->pSyncNode, "fsync wal, elapsed:%" PRId64, taosGetTimestampNs() - tsBegin);
+  return code;
+}
+
 // entry found, return 0
 // entry not found, return -1, terrno = TSDB_CODE_WAL_LOG_NOT_EXIST
 // other error, return -1
@@ -23,6 +23,28 @@
 #include "syncReplication.h"
 #include "syncUtil.h"
 
+static void snapshotBlocksInit(SSyncSnapBlock *blocks) {
+  for (int32_t i = 0; i < SYNC_SNAPSHOT_WINDOW_SIZE; i++) {
+    blocks[i].seq = SYNC_SNAPSHOT_SEQ_INVALID;
+    blocks[i].blockLen = 0;
+    blocks[i].pBlock = NULL;
+    blocks[i].resent = false;
+  }
+}
+
+static void snapshotBlockClear(SSyncSnapBlock *pBlk) {
+  taosMemoryFreeClear(pBlk->pBlock);
+  pBlk->seq = SYNC_SNAPSHOT_SEQ_INVALID;
+  pBlk->blockLen = 0;
+  pBlk->resent = false;
+}
+
+static void snapshotBlocksClear(SSyncSnapBlock *blocks) {
+  for (int32_t i = 0; i < SYNC_SNAPSHOT_WINDOW_SIZE; i++) {
+    snapshotBlockClear(&blocks[i]);
+  }
+}
+
 SSyncSnapshotSender *snapshotSenderCreate(SSyncNode *pSyncNode, int32_t replicaIndex) {
   bool condition = (pSyncNode->pFsm->FpSnapshotStartRead != NULL) && (pSyncNode->pFsm->FpSnapshotStopRead != NULL) &&
                    (pSyncNode->pFsm->FpSnapshotDoRead != NULL);
@@ -38,8 +60,8 @@ SSyncSnapshotSender *snapshotSenderCreate(SSyncNode *pSyncNode, int32_t replicaI
   pSender->seq = SYNC_SNAPSHOT_SEQ_INVALID;
   pSender->ack = SYNC_SNAPSHOT_SEQ_INVALID;
   pSender->pReader = NULL;
-  pSender->pCurrentBlock = NULL;
-  pSender->blockLen = 0;
+  pSender->readFinish = false;
+  snapshotBlocksInit(pSender->blocks);
   pSender->sendingMS = SYNC_SNAPSHOT_RETRY_MS;
   pSender->pSyncNode = pSyncNode;
   pSender->replicaIndex = replicaIndex;
@@ -55,11 +77,8 @@ SSyncSnapshotSender *snapshotSenderCreate(SSyncNode *pSyncNode, int32_t replicaI
 void snapshotSenderDestroy(SSyncSnapshotSender *pSender) {
   if (pSender == NULL) return;
 
-  // free current block
-  if (pSender->pCurrentBlock != NULL) {
-    taosMemoryFree(pSender->pCurrentBlock);
-    pSender->pCurrentBlock = NULL;
-  }
+  // free blocks in flight
+  snapshotBlocksClear(pSender->blocks);
 
   // close reader
   if (pSender->pReader != NULL) {
@@ -78,8 +97,8 @@ int32_t snapshotSenderStart(SSyncSnapshotSender *pSender) {
   pSender->seq = SYNC_SNAPSHOT_SEQ_BEGIN;
   pSender->ack = SYNC_SNAPSHOT_SEQ_INVALID;
   pSender->pReader = NULL;
-  pSender->pCurrentBlock = NULL;
-  pSender->blockLen = 0;
+  pSender->readFinish = false;
+  snapshotBlocksClear(pSender->blocks);
   pSender->snapshotParam.start = SYNC_INDEX_INVALID;
   pSender->snapshotParam.end = SYNC_INDEX_INVALID;
   pSender->snapshot.data = NULL;
@@ -140,45 +159,16 @@ void snapshotSenderStop(SSyncSnapshotSender *pSender, bool finish) {
     pSender->pReader = NULL;
   }
 
-  // free current block
-  if (pSender->pCurrentBlock != NULL) {
-    taosMemoryFree(pSender->pCurrentBlock);
-    pSender->pCurrentBlock = NULL;
-    pSender->blockLen = 0;
-  }
+  // free blocks in flight
+  snapshotBlocksClear(pSender->blocks);
 }
 
-// when sender receive ack, call this function to send msg from seq
-// seq = ack + 1, already updated
-int32_t snapshotSend(SSyncSnapshotSender *pSender) {
-  // free memory last time (current seq - 1)
-  if (pSender->pCurrentBlock != NULL) {
-    taosMemoryFree(pSender->pCurrentBlock);
-    pSender->pCurrentBlock = NULL;
-    pSender->blockLen = 0;
-  }
-
-  // read data
-  int32_t ret = pSender->pSyncNode->pFsm->FpSnapshotDoRead(pSender->pSyncNode->pFsm, pSender->pReader,
-                                                           &pSender->pCurrentBlock, &pSender->blockLen);
-  if (ret != 0) {
-    sSError(pSender, "snapshot sender read failed since %s", terrstr());
-    return -1;
-  }
-
-  if (pSender->blockLen > 0) {
-    // has read data
-    sSDebug(pSender, "snapshot sender continue to read, blockLen:%d seq:%d", pSender->blockLen, pSender->seq);
-  } else {
-    // read finish, update seq to end
-    pSender->seq = SYNC_SNAPSHOT_SEQ_END;
-    sSInfo(pSender, "snapshot sender read to the end, blockLen:%d seq:%d", pSender->blockLen, pSender->seq);
-  }
-
+static int32_t snapshotSendBlock(SSyncSnapshotSender *pSender, int32_t seq, void *pBlock, int32_t blockLen,
+                                 const char *event) {
   // build msg
   SRpcMsg rpcMsg = {0};
-  if (syncBuildSnapshotSend(&rpcMsg, pSender->blockLen, pSender->pSyncNode->vgId) != 0) {
-    sSError(pSender, "snapshot sender build msg failed since %s", pSender->pSyncNode->vgId, terrstr());
+  if (syncBuildSnapshotSend(&rpcMsg, blockLen, pSender->pSyncNode->vgId) != 0) {
+    sSError(pSender, "snapshot sender build msg failed since %s", terrstr());
     return -1;
   }
 
@@ -191,18 +181,15 @@ int32_t snapshotSend(SSyncSnapshotSender *pSender) {
   pMsg->lastTerm = pSender->snapshot.lastApplyTerm;
   pMsg->lastConfigIndex = pSender->snapshot.lastConfigIndex;
   pMsg->lastConfig = pSender->lastConfig;
-  pMsg->seq = pSender->seq;
+  pMsg->startTime = pSender->startTime;
+  pMsg->seq = seq;
 
-  if (pSender->pCurrentBlock != NULL) {
-    memcpy(pMsg->data, pSender->pCurrentBlock, pSender->blockLen);
+  if (pBlock != NULL && blockLen > 0) {
+    memcpy(pMsg->data, pBlock, blockLen);
   }
 
   // event log
-  if (pSender->seq == SYNC_SNAPSHOT_SEQ_END) {
-    syncLogSendSyncSnapshotSend(pSender->pSyncNode, pMsg, "snapshot sender finish");
-  } else {
-    syncLogSendSyncSnapshotSend(pSender->pSyncNode, pMsg, "snapshot sender sending");
-  }
+  syncLogSendSyncSnapshotSend(pSender->pSyncNode, pMsg, event);
 
   // send msg
   if (syncNodeSendMsgById(&pMsg->destId, pSender->pSyncNode, &rpcMsg) != 0) {
@@ -214,54 +201,102 @@ int32_t snapshotSend(SSyncSnapshotSender *pSender) {
   return 0;
 }
 
-// send snapshot data from cache
-int32_t snapshotReSend(SSyncSnapshotSender *pSender) {
-  // build msg
-  SRpcMsg rpcMsg = {0};
-  if (syncBuildSnapshotSend(&rpcMsg, pSender->blockLen, pSender->pSyncNode->vgId) != 0) {
-    sSError(pSender, "snapshot sender build msg failed since %s", terrstr());
-    return -1;
+// when sender receive ack, call this function to fill the window of (ack, ack + window] with new blocks,
+// and send the end msg after all blocks are acked
+int32_t snapshotSend(SSyncSnapshotSender *pSender) {
+  if (pSender->seq == SYNC_SNAPSHOT_SEQ_END) {
+    return 0;
   }
 
-  SyncSnapshotSend *pMsg = rpcMsg.pCont;
-  pMsg->srcId = pSender->pSyncNode->myRaftId;
-  pMsg->destId = pSender->pSyncNode->replicasId[pSender->replicaIndex];
-  pMsg->term = pSender->pSyncNode->pRaftStore->currentTerm;
-  pMsg->beginIndex = pSender->snapshotParam.start;
-  pMsg->lastIndex = pSender->snapshot.lastApplyIndex;
-  pMsg->lastTerm = pSender->snapshot.lastApplyTerm;
-  pMsg->lastConfigIndex = pSender->snapshot.lastConfigIndex;
-  pMsg->lastConfig = pSender->lastConfig;
-  pMsg->seq = pSender->seq;
+  while (!pSender->readFinish && pSender->seq - pSender->ack < SYNC_SNAPSHOT_WINDOW_SIZE) {
+    // read data
+    void   *pBlock = NULL;
+    int32_t blockLen = 0;
+    int32_t ret = pSender->pSyncNode->pFsm->FpSnapshotDoRead(pSender->pSyncNode->pFsm, pSender->pReader, &pBlock,
+                                                             &blockLen);
+    if (ret != 0) {
+      sSError(pSender, "snapshot sender read failed since %s", terrstr());
+      return -1;
+    }
+
+    if (blockLen <= 0) {
+      taosMemoryFree(pBlock);
+      pSender->readFinish = true;
+      sSInfo(pSender, "snapshot sender read to the end, seq:%d ack:%d", pSender->seq, pSender->ack);
+      break;
+    }
+
+    SSyncSnapBlock *pBlk = &pSender->blocks[(pSender->seq + 1) % SYNC_SNAPSHOT_WINDOW_SIZE];
+    snapshotBlockClear(pBlk);
+    pBlk->seq = pSender->seq + 1;
+    pBlk->pBlock = pBlock;
+    pBlk->blockLen = blockLen;
+    pSender->seq = pBlk->seq;
 
-  if (pSender->pCurrentBlock != NULL && pSender->blockLen > 0) {
-    memcpy(pMsg->data, pSender->pCurrentBlock, pSender->blockLen);
+    sSDebug(pSender, "snapshot sender continue to read, blockLen:%d seq:%d", blockLen, pBlk->seq);
+    if (snapshotSendBlock(pSender, pBlk->seq, pBlk->pBlock, pBlk->blockLen, "snapshot sender sending") != 0) {
+      return -1;
+    }
   }
 
-  // event log
-  syncLogSendSyncSnapshotSend(pSender->pSyncNode, pMsg, "snapshot sender resend");
+  if (pSender->readFinish && pSender->ack == pSender->seq) {
+    pSender->seq = SYNC_SNAPSHOT_SEQ_END;
+    return snapshotSendBlock(pSender, pSender->seq, NULL, 0, "snapshot sender finish");
+  }
 
-  // send msg
-  if (syncNodeSendMsgById(&pMsg->destId, pSender->pSyncNode, &rpcMsg) != 0) {
-    sSError(pSender, "snapshot sender resend msg failed since %s", terrstr());
-    return -1;
+  return 0;
+}
+
+// send the blocks not acked yet, or the last ctrl msg
+int32_t snapshotReSend(SSyncSnapshotSender *pSender) {
+  if (pSender->seq == SYNC_SNAPSHOT_SEQ_END || pSender->seq <= SYNC_SNAPSHOT_SEQ_BEGIN) {
+    return snapshotSendBlock(pSender, pSender->seq, NULL, 0, "snapshot sender resend");
+  }
+
+  for (int32_t seq = TMAX(pSender->ack + 1, SYNC_SNAPSHOT_SEQ_BEGIN + 1); seq <= pSender->seq; seq++) {
+    SSyncSnapBlock *pBlk = &pSender->blocks[seq % SYNC_SNAPSHOT_WINDOW_SIZE];
+    if (pBlk->seq != seq) continue;
+    pBlk->resent = true;
+    if (snapshotSendBlock(pSender, pBlk->seq, pBlk->pBlock, pBlk->blockLen, "snapshot sender resend") != 0) {
+      return -1;
+    }
   }
 
-  pSender->lastSendTime = taosGetTimestampMs();
   return 0;
 }
 
+// a duplicated ack means block ack + 1 is missing while later ones arrived, resend it once
+static int32_t snapshotReSendMissing(SSyncSnapshotSender *pSender) {
+  int32_t seq = pSender->ack + 1;
+  if (pSender->seq == SYNC_SNAPSHOT_SEQ_END || seq <= SYNC_SNAPSHOT_SEQ_BEGIN || seq > pSender->seq) {
+    return 0;
+  }
+
+  SSyncSnapBlock *pBlk = &pSender->blocks[seq % SYNC_SNAPSHOT_WINDOW_SIZE];
+  if (pBlk->seq != seq || pBlk->resent) {
+    return 0;
+  }
+
+  pBlk->resent = true;
+  return snapshotSendBlock(pSender, pBlk->seq, pBlk->pBlock, pBlk->blockLen, "snapshot sender resend missing");
+}
+
 static int32_t snapshotSenderUpdateProgress(SSyncSnapshotSender *pSender, SyncSnapshotRsp *pMsg) {
-  if (pMsg->ack != pSender->seq) {
-    sSError(pSender, "snapshot sender update seq failed, ack:%d seq:%d", pMsg->ack, pSender->seq);
+  if (pMsg->ack > pSender->seq || pMsg->ack <= pSender->ack) {
+    sSError(pSender, "snapshot sender update ack failed, ack:%d seq:%d my ack:%d", pMsg->ack, pSender->seq,
+            pSender->ack);
     terrno = TSDB_CODE_SYN_INTERNAL_ERROR;
     return -1;
   }
 
+  // release the blocks acked
+  for (int32_t seq = TMAX(pSender->ack + 1, SYNC_SNAPSHOT_SEQ_BEGIN + 1); seq <= pMsg->ack; seq++) {
+    SSyncSnapBlock *pBlk = &pSender->blocks[seq % SYNC_SNAPSHOT_WINDOW_SIZE];
+    if (pBlk->seq == seq) snapshotBlockClear(pBlk);
+  }
   pSender->ack = pMsg->ack;
-  pSender->seq++;
 
-  sSDebug(pSender, "snapshot sender update seq:%d", pSender->seq);
+  sSDebug(pSender, "snapshot sender update ack:%d seq:%d", pSender->ack, pSender->seq);
   return 0;
 }
 
@@ -319,6 +354,7 @@ SSyncSnapshotReceiver *snapshotReceiverCreate(SSyncNode *pSyncNode, SRaftId from
   pReceiver->snapshot.lastApplyIndex = SYNC_INDEX_INVALID;
   pReceiver->snapshot.lastApplyTerm = 0;
   pReceiver->snapshot.lastConfigIndex = SYNC_INDEX_INVALID;
+  snapshotBlocksInit(pReceiver->blocks);
 
   return pReceiver;
 }
@@ -336,6 +372,9 @@ void snapshotReceiverDestroy(SSyncSnapshotReceiver *pReceiver) {
     pReceiver->pWriter = NULL;
   }
 
+  // free out-of-order blocks
+  snapshotBlocksClear(pReceiver->blocks);
+
   // free receiver
   taosMemoryFree(pReceiver);
 }
@@ -356,6 +395,7 @@ void snapshotReceiverForceStop(SSyncSnapshotReceiver *pReceiver) {
     pReceiver->pWriter = NULL;
   }
 
+  snapshotBlocksClear(pReceiver->blocks);
   pReceiver->start = false;
 }
 
@@ -368,6 +408,7 @@ static int32_t snapshotReceiverStartWriter(SSyncSnapshotReceiver *pReceiver, Syn
 
   // update ack
   pReceiver->ack = SYNC_SNAPSHOT_SEQ_BEGIN;
+  snapshotBlocksClear(pReceiver->blocks);
 
   // update snapshot
   pReceiver->snapshot.lastApplyIndex = pBeginMsg->lastIndex;
@@ -421,6 +462,7 @@ void snapshotReceiverStop(SSyncSnapshotReceiver *pReceiver) {
     sRInfo(pReceiver, "snapshot receiver stop, writer is null");
   }
 
+  snapshotBlocksClear(pReceiver->blocks);
   pReceiver->start = false;
 }
 
@@ -482,10 +524,34 @@ static int32_t snapshotReceiverFinish(SSyncSnapshotReceiver *pReceiver, SyncSnap
   return 0;
 }
 
-// apply data block
+static int32_t snapshotReceiverWriteBlock(SSyncSnapshotReceiver *pReceiver, int32_t seq, void *pBlock,
+                                          int32_t blockLen) {
+  sRDebug(pReceiver, "snapshot receiver continue to write, blockLen:%d seq:%d", blockLen, seq);
+
+  if (blockLen > 0) {
+    // apply data block
+    int32_t code =
+        pReceiver->pSyncNode->pFsm->FpSnapshotDoWrite(pReceiver->pSyncNode->pFsm, pReceiver->pWriter, pBlock, blockLen);
+    if (code != 0) {
+      sRError(pReceiver, "snapshot receiver continue write failed since %s", terrstr());
+      return -1;
+    }
+  }
+
+  // update progress
+  pReceiver->ack = seq;
+  return 0;
+}
+
+// apply data block in order, buffer the out-of-order ones in window
 // update progress
 static int32_t snapshotReceiverGotData(SSyncSnapshotReceiver *pReceiver, SyncSnapshotSend *pMsg) {
-  if (pMsg->seq != pReceiver->ack + 1) {
+  if (pMsg->seq <= pReceiver->ack) {
+    sRDebug(pReceiver, "snapshot receiver ignore duplicated seq:%d, ack:%d", pMsg->seq, pReceiver->ack);
+    return 0;
+  }
+
+  if (pMsg->seq > pReceiver->ack + SYNC_SNAPSHOT_WINDOW_SIZE) {
     sRError(pReceiver, "snapshot receiver invalid seq, ack:%d seq:%d", pReceiver->ack, pMsg->seq);
     terrno = TSDB_CODE_SYN_INVALID_SNAPSHOT_MSG;
     return -1;
@@ -497,23 +563,47 @@ static int32_t snapshotReceiverGotData(SSyncSnapshotReceiver *pReceiver, SyncSna
     return -1;
   }
 
-  sRDebug(pReceiver, "snapshot receiver continue to write, blockLen:%d seq:%d", pMsg->dataLen, pMsg->seq);
+  if (pMsg->seq != pReceiver->ack + 1) {
+    SSyncSnapBlock *pBlk = &pReceiver->blocks[pMsg->seq % SYNC_SNAPSHOT_WINDOW_SIZE];
+    if (pBlk->seq == pMsg->seq) {
+      return 0;
+    }
 
-  if (pMsg->dataLen > 0) {
-    // apply data block
-    int32_t code = pReceiver->pSyncNode->pFsm->FpSnapshotDoWrite(pReceiver->pSyncNode->pFsm, pReceiver->pWriter,
-                                                                 pMsg->data, pMsg->dataLen);
+    snapshotBlockClear(pBlk);
+    if (pMsg->dataLen > 0) {
+      pBlk->pBlock = taosMemoryMalloc(pMsg->dataLen);
+      if (pBlk->pBlock == NULL) {
+        terrno = TSDB_CODE_OUT_OF_MEMORY;
+        return -1;
+      }
+      memcpy(pBlk->pBlock, pMsg->data, pMsg->dataLen);
+    }
+    pBlk->seq = pMsg->seq;
+    pBlk->blockLen = pMsg->dataLen;
+
+    sRDebug(pReceiver, "snapshot receiver buffer out-of-order block, blockLen:%d seq:%d ack:%d", pMsg->dataLen,
+            pMsg->seq, pReceiver->ack);
+    return 0;
+  }
+
+  if (snapshotReceiverWriteBlock(pReceiver, pMsg->seq, pMsg->data, pMsg->dataLen) != 0) {
+    return -1;
+  }
+
+  // apply the buffered blocks following it
+  while (true) {
+    SSyncSnapBlock *pBlk = &pReceiver->blocks[(pReceiver->ack + 1) % SYNC_SNAPSHOT_WINDOW_SIZE];
+    if (pBlk->seq != pReceiver->ack + 1) break;
+
+    int32_t code = snapshotReceiverWriteBlock(pReceiver, pBlk->seq, pBlk->pBlock, pBlk->blockLen);
+    snapshotBlockClear(pBlk);
     if (code != 0) {
-      sRError(pReceiver, "snapshot receiver continue write failed since %s", terrstr());
       return -1;
     }
   }
 
-  // update progress
-  pReceiver->ack = pMsg->seq;
-
   // event log
-  sRDebug(pReceiver, "snapshot receiver continue to write finish");
+  sRDebug(pReceiver, "snapshot receiver continue to write finish, ack:%d", pReceiver->ack);
   return 0;
 }
 
@@ -931,7 +1021,8 @@ static int32_t syncNodeOnSnapshotPreRsp(SSyncNode *pSyncNode, SSyncSnapshotSende
 // sender on message
 //
 // condition 1 sender receives SYNC_SNAPSHOT_SEQ_END, close sender
-// condition 2 sender receives ack, set seq = ack + 1, send msg from seq
+// condition 2 sender receives cumulative ack, release acked blocks and send new ones to fill the window,
+//             a duplicated ack resends the missing block once
 // condition 3 sender receives error msg, just print error log
 //
 int32_t syncNodeOnSnapshotRsp(SSyncNode *pSyncNode, const SRpcMsg *pRpcMsg) {
@@ -989,18 +1080,6 @@ int32_t syncNodeOnSnapshotRsp(SSyncNode *pSyncNode, const SRpcMsg *pRpcMsg) {
     return syncNodeOnSnapshotPreRsp(pSyncNode, pSender, pMsg);
   }
 
-  if (pMsg->ack == SYNC_SNAPSHOT_SEQ_BEGIN) {
-    syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "process seq begin");
-    if (snapshotSenderUpdateProgress(pSender, pMsg) != 0) {
-      return -1;
-    }
-
-    if (snapshotSend(pSender) != 0) {
-      return -1;
-    }
-    return 0;
-  }
-
   // receive ack is finish, close sender
   if (pMsg->ack == SYNC_SNAPSHOT_SEQ_END) {
     syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "process seq end");
@@ -1010,22 +1089,25 @@ int32_t syncNodeOnSnapshotRsp(SSyncNode *pSyncNode, const SRpcMsg *pRpcMsg) {
     return 0;
   }
 
-  // send next msg
-  if (pMsg->ack == pSender->seq) {
-    syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "process seq data");
-    // update sender ack
+  // cumulative ack of begin or data, slide the window
+  if (pSender->seq != SYNC_SNAPSHOT_SEQ_END && pMsg->ack > pSender->ack && pMsg->ack <= pSender->seq) {
+    syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg,
+                               pMsg->ack == SYNC_SNAPSHOT_SEQ_BEGIN ? "process seq begin" : "process seq data");
     if (snapshotSenderUpdateProgress(pSender, pMsg) != 0) {
       return -1;
     }
     if (snapshotSend(pSender) != 0) {
       return -1;
     }
-  } else if (pMsg->ack == pSender->seq - 1) {
+  } else if (pMsg->ack == pSender->ack) {
     // maybe resend
-    syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "process seq and resend");
-    if (snapshotReSend(pSender) != 0) {
+    syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "process dup ack and resend");
+    if (snapshotReSendMissing(pSender) != 0) {
       return -1;
     }
+  } else if (pMsg->ack < pSender->ack) {
+    // acks arrive out of order, ignore the stale one
+    syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "ignore stale ack");
   } else {
     // error log
     syncLogRecvSyncSnapshotRsp(pSyncNode, pMsg, "receive error ack");
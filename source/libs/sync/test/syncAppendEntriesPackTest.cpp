@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "syncAppendEntries.h"
+#include "syncMessage.h"
+#include "syncRaftEntry.h"
+#include "syncRaftStore.h"
+#include "syncTest.h"
+
+static SSyncRaftEntry *createEntry(SyncIndex index, SyncTerm term, int32_t dataLen) {
+  SSyncRaftEntry *pEntry = syncEntryBuild(dataLen);
+  assert(pEntry != NULL);
+  pEntry->msgType = TDMT_SYNC_CLIENT_REQUEST;
+  pEntry->originalRpcType = TDMT_VND_SUBMIT;
+  pEntry->seqNum = index;
+  pEntry->isWeak = false;
+  pEntry->term = term;
+  pEntry->index = index;
+  memset(pEntry->data, (int)(index & 0x7f), dataLen);
+  return pEntry;
+}
+
+class SyncAppendEntriesPackTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&raftStore, 0, sizeof(raftStore));
+    memset(&node, 0, sizeof(node));
+    raftStore.currentTerm = 9;
+    node.vgId = 2;
+    node.pRaftStore = &raftStore;
+    node.commitIndex = 100;
+
+    // entries of index 101 - 105, the term changes in the middle
+    for (int32_t i = 0; i < nEntry; i++) {
+      entries[i] = createEntry(101 + i, i < 3 ? 8 : 9, 16 + i * 100);
+    }
+  }
+
+  void TearDown() override {
+    for (int32_t i = 0; i < nEntry; i++) {
+      syncEntryDestroy(entries[i]);
+    }
+  }
+
+  static const int32_t nEntry = 5;
+  SRaftStore           raftStore;
+  SSyncNode            node;
+  SSyncRaftEntry      *entries[nEntry];
+};
+
+TEST_F(SyncAppendEntriesPackTest, round_trip) {
+  SRpcMsg rpcMsg = {0};
+  ASSERT_EQ(syncBuildAppendEntriesFromRaftEntries(&node, entries, nEntry, 7, &rpcMsg), 0);
+
+  SyncAppendEntries *pMsg = (SyncAppendEntries *)rpcMsg.pCont;
+  uint32_t           dataLen = 0;
+  for (int32_t i = 0; i < nEntry; i++) {
+    dataLen += entries[i]->bytes;
+  }
+  ASSERT_EQ(pMsg->dataLen, dataLen);
+  ASSERT_EQ(pMsg->prevLogIndex, 100);
+  ASSERT_EQ(pMsg->prevLogTerm, 7);
+  ASSERT_EQ(pMsg->term, 9);
+  ASSERT_EQ(pMsg->commitIndex, 100);
+
+  SyncIndex lastIndex = SYNC_INDEX_INVALID;
+  ASSERT_EQ(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  ASSERT_EQ(lastIndex, 105);
+
+  // the follower takes the entries out in order, each the same as sent
+  uint32_t offset = 0;
+  for (int32_t i = 0; i < nEntry; i++) {
+    uint32_t        bytes = ((const SSyncRaftEntry *)(pMsg->data + offset))->bytes;
+    SSyncRaftEntry *pEntry = syncLogAppendEntriesToRaftEntry(pMsg, offset, bytes);
+    ASSERT_NE(pEntry, nullptr);
+    ASSERT_EQ(pEntry->bytes, entries[i]->bytes);
+    ASSERT_EQ(memcmp(pEntry, entries[i], bytes), 0);
+    syncEntryDestroy(pEntry);
+    offset += bytes;
+  }
+  ASSERT_EQ(offset, pMsg->dataLen);
+
+  rpcFreeCont(rpcMsg.pCont);
+}
+
+TEST_F(SyncAppendEntriesPackTest, single_entry_layout) {
+  // a msg of one entry is what the followers before the batching parse
+  SRpcMsg rpcOne = {0};
+  SRpcMsg rpcBatch = {0};
+  ASSERT_EQ(syncBuildAppendEntriesFromRaftLog(&node, entries[0], 7, &rpcOne), 0);
+  ASSERT_EQ(syncBuildAppendEntriesFromRaftEntries(&node, entries, 1, 7, &rpcBatch), 0);
+  ASSERT_EQ(rpcOne.contLen, rpcBatch.contLen);
+  ASSERT_EQ(memcmp(rpcOne.pCont, rpcBatch.pCont, rpcOne.contLen), 0);
+
+  SyncAppendEntries *pMsg = (SyncAppendEntries *)rpcOne.pCont;
+  ASSERT_EQ(pMsg->dataLen, entries[0]->bytes);
+
+  SyncIndex lastIndex = SYNC_INDEX_INVALID;
+  ASSERT_EQ(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  ASSERT_EQ(lastIndex, 101);
+
+  rpcFreeCont(rpcOne.pCont);
+  rpcFreeCont(rpcBatch.pCont);
+}
+
+TEST_F(SyncAppendEntriesPackTest, mismatch) {
+  SRpcMsg rpcMsg = {0};
+  ASSERT_EQ(syncBuildAppendEntriesFromRaftEntries(&node, entries, nEntry, 7, &rpcMsg), 0);
+
+  SyncAppendEntries *pMsg = (SyncAppendEntries *)rpcMsg.pCont;
+  SyncIndex          lastIndex = SYNC_INDEX_INVALID;
+  uint32_t           offset3 = entries[0]->bytes + entries[1]->bytes + entries[2]->bytes;
+  SSyncRaftEntry    *pEntry3 = (SSyncRaftEntry *)(pMsg->data + offset3);
+
+  // prev index not followed by the first entry
+  pMsg->prevLogIndex = 99;
+  ASSERT_LT(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  pMsg->prevLogIndex = 100;
+
+  // a gap in the middle of the batch
+  pEntry3->index = 105;
+  ASSERT_LT(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  pEntry3->index = 104;
+
+  // an entry claims more bytes than left in the msg
+  pEntry3->bytes = pMsg->dataLen;
+  ASSERT_LT(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  pEntry3->bytes = entries[3]->bytes;
+
+  // an entry shorter than its head
+  pEntry3->bytes = sizeof(SSyncRaftEntry) - 1;
+  ASSERT_LT(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  pEntry3->bytes = entries[3]->bytes;
+
+  // the msg ends in the middle of an entry head
+  uint32_t dataLen = pMsg->dataLen;
+  pMsg->dataLen = offset3 + sizeof(SSyncRaftEntry) / 2;
+  ASSERT_LT(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  pMsg->dataLen = dataLen;
+
+  // a negative term
+  pEntry3->term = -1;
+  ASSERT_LT(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  pEntry3->term = entries[3]->term;
+
+  ASSERT_EQ(lastIndex, SYNC_INDEX_INVALID);
+  ASSERT_EQ(syncLogAppendEntriesCheck(&node, pMsg, &lastIndex), 0);
+  ASSERT_EQ(lastIndex, 105);
+
+  rpcFreeCont(rpcMsg.pCont);
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "syncIndexMgr.h"
+#include "syncInt.h"
+#include "syncPipeline.h"
+#include "syncRaftEntry.h"
+
+namespace {
+
+const int32_t kVgId = 2;
+const int64_t kTerm = 1;
+
+// a log store of the entry terms in memory, counting the group fsyncs
+struct SMemLogStore {
+  std::vector<SyncTerm> terms;
+  int32_t               nFsync = 0;
+  bool                  failFsync = false;
+};
+
+SMemLogStore *memStore(SSyncLogStore *pLogStore) { return (SMemLogStore *)pLogStore->data; }
+
+SyncIndex memBeginIndex(SSyncLogStore *pLogStore) { return 0; }
+
+SyncIndex memLastIndex(SSyncLogStore *pLogStore) { return (SyncIndex)memStore(pLogStore)->terms.size() - 1; }
+
+int32_t memAppendEntry(SSyncLogStore *pLogStore, SSyncRaftEntry *pEntry) {
+  memStore(pLogStore)->terms.push_back(pEntry->term);
+  return 0;
+}
+
+int32_t memGetEntry(SSyncLogStore *pLogStore, SyncIndex index, SSyncRaftEntry **ppEntry) {
+  terrno = TSDB_CODE_WAL_LOG_NOT_EXIST;
+  return -1;
+}
+
+int32_t memTruncate(SSyncLogStore *pLogStore, SyncIndex fromIndex) {
+  memStore(pLogStore)->terms.resize(fromIndex);
+  return 0;
+}
+
+int32_t memFsync(SSyncLogStore *pLogStore) {
+  SMemLogStore *pStore = memStore(pLogStore);
+  pStore->nFsync++;
+  if (pStore->failFsync) {
+    terrno = TAOS_SYSTEM_ERROR(EIO);
+    return -1;
+  }
+  return 0;
+}
+
+void getSnapshotInfo(const SSyncFSM *pFsm, SSnapshot *pSnapshot) {
+  pSnapshot->lastApplyIndex = -1;
+  pSnapshot->lastApplyTerm = 0;
+}
+
+class SyncLogBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&node, 0, sizeof(node));
+    memset(&fsm, 0, sizeof(fsm));
+    memset(&logStore, 0, sizeof(logStore));
+
+    fsm.FpGetSnapshotInfo = getSnapshotInfo;
+
+    logStore.data = &store;
+    logStore.syncLogBeginIndex = memBeginIndex;
+    logStore.syncLogLastIndex = memLastIndex;
+    logStore.syncLogAppendEntry = memAppendEntry;
+    logStore.syncLogGetEntry = memGetEntry;
+    logStore.syncLogTruncate = memTruncate;
+    logStore.syncLogFsync = memFsync;
+
+    // a follower of a single replica, nothing is replicated on proceeding
+    node.vgId = kVgId;
+    node.state = TAOS_SYNC_STATE_FOLLOWER;
+    node.replicaNum = 1;
+    node.myRaftId.addr = 1;
+    node.myRaftId.vgId = kVgId;
+    node.replicasId[0] = node.myRaftId;
+    node.pFsm = &fsm;
+    node.pLogStore = &logStore;
+    node.pMatchIndex = syncIndexMgrCreate(&node);
+    ASSERT_NE(node.pMatchIndex, nullptr);
+
+    pBuf = syncLogBufferCreate();
+    ASSERT_NE(pBuf, nullptr);
+    ASSERT_EQ(syncLogBufferInit(pBuf, &node), 0);
+    node.pLogBuf = pBuf;
+  }
+
+  void TearDown() override {
+    syncLogBufferDestroy(pBuf);
+    syncIndexMgrDestroy(node.pMatchIndex);
+  }
+
+  void append(SyncIndex index) {
+    SSyncRaftEntry *pEntry = syncEntryBuildNoop(kTerm, index, kVgId);
+    ASSERT_NE(pEntry, nullptr);
+    ASSERT_EQ(syncLogBufferAppend(pBuf, &node, pEntry), 0);
+  }
+
+  SyncIndex myMatchIndex() { return syncIndexMgrGetIndex(node.pMatchIndex, &node.myRaftId); }
+
+  SSyncNode       node;
+  SSyncFSM        fsm;
+  SSyncLogStore   logStore;
+  SMemLogStore    store;
+  SSyncLogBuffer *pBuf = NULL;
+};
+
+}  // namespace
+
+TEST_F(SyncLogBufferTest, groupFsyncFailure) {
+  append(0);
+  ASSERT_EQ(syncLogBufferProceed(pBuf, &node, NULL), 0);
+  ASSERT_EQ(myMatchIndex(), 0);
+
+  for (SyncIndex index = 1; index <= 3; index++) {
+    append(index);
+  }
+
+  // none of the group is durable, so none of it is matched
+  store.failFsync = true;
+  ASSERT_EQ(syncLogBufferProceed(pBuf, &node, NULL), -1);
+  ASSERT_EQ(store.nFsync, 2);
+  ASSERT_EQ(pBuf->matchIndex, 0);
+  ASSERT_EQ(myMatchIndex(), 0);
+
+  // the next proceed persists the group again
+  store.failFsync = false;
+  SyncTerm matchTerm = 0;
+  ASSERT_EQ(syncLogBufferProceed(pBuf, &node, &matchTerm), 3);
+  ASSERT_EQ(matchTerm, kTerm);
+  ASSERT_EQ(store.nFsync, 3);
+  ASSERT_EQ(store.terms.size(), 4);
+  ASSERT_EQ(pBuf->matchIndex, 3);
+  ASSERT_EQ(myMatchIndex(), 3);
+
+  // nothing new, no fsync
+  ASSERT_EQ(syncLogBufferProceed(pBuf, &node, NULL), 3);
+  ASSERT_EQ(store.nFsync, 3);
+}
+
+TEST_F(SyncLogBufferTest, concurrentAppendersShareFsync) {
+  const int32_t nThreads = 8;
+  const int32_t nEntries = 50;
+
+  std::mutex               mutex;
+  SyncIndex                nextIndex = 0;
+  std::vector<SyncIndex>   matchIndexes(nThreads);
+  std::vector<std::thread> threads;
+
+  // every appender proceeds after all of them appended, the first proceed syncs the whole group
+  std::atomic<int32_t> nAppended(0);
+  for (int32_t iThread = 0; iThread < nThreads; iThread++) {
+    threads.emplace_back([&, iThread]() {
+      for (int32_t i = 0; i < nEntries; i++) {
+        std::lock_guard<std::mutex> lock(mutex);
+        append(nextIndex++);
+      }
+      nAppended++;
+      while (nAppended < nThreads) {
+        std::this_thread::yield();
+      }
+      matchIndexes[iThread] = syncLogBufferProceed(pBuf, &node, NULL);
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  const SyncIndex lastIndex = nThreads * nEntries - 1;
+  ASSERT_EQ(store.nFsync, 1);
+  ASSERT_EQ(store.terms.size(), nThreads * nEntries);
+  for (SyncIndex matchIndex : matchIndexes) {
+    ASSERT_EQ(matchIndex, lastIndex);
+  }
+  ASSERT_EQ(myMatchIndex(), lastIndex);
+}
@@ -44,9 +44,10 @@ SSyncSnapshotSender* createSender() {
   pSender->seq = 10;
   pSender->ack = 20;
   pSender->pReader = (void*)0x11;
-  pSender->blockLen = 20;
-  pSender->pCurrentBlock = taosMemoryMalloc(pSender->blockLen);
-  snprintf((char*)(pSender->pCurrentBlock), pSender->blockLen, "%s", "hello");
+  pSender->blocks[0].seq = 8;
+  pSender->blocks[0].blockLen = 20;
+  pSender->blocks[0].pBlock = taosMemoryMalloc(pSender->blocks[0].blockLen);
+  snprintf((char*)(pSender->blocks[0].pBlock), pSender->blocks[0].blockLen, "%s", "hello");
 
   pSender->snapshot.lastApplyIndex = 99;
   pSender->snapshot.lastApplyTerm = 88;
@@ -0,0 +1,340 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "syncInt.h"
+#include "syncMessage.h"
+#include "syncRaftStore.h"
+#include "syncSnapshot.h"
+
+namespace {
+
+const int32_t kVgId = 2;
+const int64_t kTerm = 1;
+const int64_t kStartTime = 1;
+
+// the msgs sent by the node under test, in sending order
+struct SSentMsg {
+  int32_t seq;  // seq of a snapshot send, or ack of a snapshot rsp
+  int32_t data;
+};
+
+std::vector<SSentMsg> sentMsgs;
+
+int32_t captureSnapshotSend(const SEpSet *pEpSet, SRpcMsg *pMsg) {
+  SyncSnapshotSend *pSend = (SyncSnapshotSend *)pMsg->pCont;
+  int32_t           data = 0;
+  if (pSend->dataLen == sizeof(int32_t)) {
+    memcpy(&data, pSend->data, sizeof(int32_t));
+  }
+  sentMsgs.push_back({pSend->seq, data});
+  rpcFreeCont(pMsg->pCont);
+  return 0;
+}
+
+int32_t captureSnapshotRsp(const SEpSet *pEpSet, SRpcMsg *pMsg) {
+  SyncSnapshotRsp *pRsp = (SyncSnapshotRsp *)pMsg->pCont;
+  sentMsgs.push_back({pRsp->ack, pRsp->code});
+  rpcFreeCont(pMsg->pCont);
+  return 0;
+}
+
+// the snapshot is nBlocks blocks, each one holding its 1-based number
+struct SMemSnapshot {
+  int32_t              nBlocks = 0;
+  int32_t              nRead = 0;
+  std::vector<int32_t> written;
+};
+
+void getSnapshotInfo(const SSyncFSM *pFsm, SSnapshot *pSnapshot) {
+  pSnapshot->lastApplyIndex = -1;
+  pSnapshot->lastApplyTerm = 0;
+}
+
+int32_t memStartRead(const SSyncFSM *pFsm, void *pParam, void **ppReader) { return 0; }
+void    memStopRead(const SSyncFSM *pFsm, void *pReader) {}
+
+int32_t memDoRead(const SSyncFSM *pFsm, void *pReader, void **ppBuf, int32_t *len) {
+  SMemSnapshot *pSnap = (SMemSnapshot *)pReader;
+  *ppBuf = NULL;
+  *len = 0;
+  if (pSnap->nRead < pSnap->nBlocks) {
+    *ppBuf = taosMemoryMalloc(sizeof(int32_t));
+    *(int32_t *)(*ppBuf) = ++pSnap->nRead;
+    *len = sizeof(int32_t);
+  }
+  return 0;
+}
+
+int32_t memStartWrite(const SSyncFSM *pFsm, void *pParam, void **ppWriter) { return 0; }
+int32_t memStopWrite(const SSyncFSM *pFsm, void *pWriter, bool isApply, SSnapshot *pSnapshot) { return 0; }
+
+int32_t memDoWrite(const SSyncFSM *pFsm, void *pWriter, void *pBuf, int32_t len) {
+  ((SMemSnapshot *)pWriter)->written.push_back(*(int32_t *)pBuf);
+  return 0;
+}
+
+// a node of two replicas, the peer is the other side of the snapshot transfer
+class SyncSnapshotWindowTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&node, 0, sizeof(node));
+    memset(&fsm, 0, sizeof(fsm));
+    memset(&raftStore, 0, sizeof(raftStore));
+    sentMsgs.clear();
+
+    fsm.FpGetSnapshotInfo = getSnapshotInfo;
+    fsm.FpSnapshotStartRead = memStartRead;
+    fsm.FpSnapshotStopRead = memStopRead;
+    fsm.FpSnapshotDoRead = memDoRead;
+    fsm.FpSnapshotStartWrite = memStartWrite;
+    fsm.FpSnapshotStopWrite = memStopWrite;
+    fsm.FpSnapshotDoWrite = memDoWrite;
+
+    raftStore.currentTerm = kTerm;
+
+    node.vgId = kVgId;
+    node.myRaftId.addr = 1;
+    node.myRaftId.vgId = kVgId;
+    peerId.addr = 2;
+    peerId.vgId = kVgId;
+    node.replicaNum = 2;
+    node.replicasId[0] = node.myRaftId;
+    node.replicasId[1] = peerId;
+    node.peersNum = 1;
+    node.peersId[0] = peerId;
+    node.raftCfg.isStandBy = true;
+    node.pFsm = &fsm;
+    node.pRaftStore = &raftStore;
+  }
+
+  std::vector<int32_t> sentSeqs() {
+    std::vector<int32_t> seqs;
+    for (const SSentMsg &msg : sentMsgs) {
+      seqs.push_back(msg.seq);
+    }
+    sentMsgs.clear();
+    return seqs;
+  }
+
+  SSyncNode    node;
+  SSyncFSM     fsm;
+  SRaftStore   raftStore;
+  SRaftId      peerId;
+  SMemSnapshot snap;
+};
+
+class SyncSnapshotSenderWindowTest : public SyncSnapshotWindowTest {
+ protected:
+  void SetUp() override {
+    SyncSnapshotWindowTest::SetUp();
+    node.state = TAOS_SYNC_STATE_LEADER;
+    node.syncSendMSg = captureSnapshotSend;
+
+    // the begin msg is acked, data blocks follow
+    pSender = snapshotSenderCreate(&node, 1);
+    ASSERT_NE(pSender, nullptr);
+    pSender->start = true;
+    pSender->seq = SYNC_SNAPSHOT_SEQ_BEGIN;
+    pSender->ack = SYNC_SNAPSHOT_SEQ_BEGIN;
+    pSender->pReader = &snap;
+    pSender->startTime = kStartTime;
+    node.senders[1] = pSender;
+  }
+
+  void TearDown() override {
+    pSender->pReader = NULL;
+    snapshotSenderDestroy(pSender);
+  }
+
+  int32_t ack(int32_t seq) {
+    SRpcMsg rpcMsg = {0};
+    if (syncBuildSnapshotSendRsp(&rpcMsg, kVgId) != 0) {
+      return -1;
+    }
+    SyncSnapshotRsp *pMsg = (SyncSnapshotRsp *)rpcMsg.pCont;
+    pMsg->srcId = peerId;
+    pMsg->destId = node.myRaftId;
+    pMsg->term = kTerm;
+    pMsg->startTime = kStartTime;
+    pMsg->ack = seq;
+    int32_t code = syncNodeOnSnapshotRsp(&node, &rpcMsg);
+    rpcFreeCont(rpcMsg.pCont);
+    return code;
+  }
+
+  int32_t nBlocksInFlight() {
+    int32_t n = 0;
+    for (int32_t i = 0; i < SYNC_SNAPSHOT_WINDOW_SIZE; i++) {
+      if (pSender->blocks[i].pBlock != NULL) {
+        EXPECT_GT(pSender->blocks[i].seq, pSender->ack);
+        EXPECT_LE(pSender->blocks[i].seq, pSender->seq);
+        n++;
+      }
+    }
+    return n;
+  }
+
+  SSyncSnapshotSender *pSender = NULL;
+};
+
+class SyncSnapshotReceiverWindowTest : public SyncSnapshotWindowTest {
+ protected:
+  void SetUp() override {
+    SyncSnapshotWindowTest::SetUp();
+    node.state = TAOS_SYNC_STATE_FOLLOWER;
+    node.syncSendMSg = captureSnapshotRsp;
+
+    // the begin msg is applied, data blocks follow
+    pReceiver = snapshotReceiverCreate(&node, peerId);
+    ASSERT_NE(pReceiver, nullptr);
+    pReceiver->start = true;
+    pReceiver->ack = SYNC_SNAPSHOT_SEQ_BEGIN;
+    pReceiver->pWriter = &snap;
+    pReceiver->startTime = kStartTime;
+    node.pNewNodeReceiver = pReceiver;
+  }
+
+  void TearDown() override {
+    pReceiver->pWriter = NULL;
+    snapshotReceiverDestroy(pReceiver);
+  }
+
+  int32_t send(int32_t seq) {
+    SRpcMsg rpcMsg = {0};
+    if (syncBuildSnapshotSend(&rpcMsg, sizeof(int32_t), kVgId) != 0) {
+      return -1;
+    }
+    SyncSnapshotSend *pMsg = (SyncSnapshotSend *)rpcMsg.pCont;
+    pMsg->srcId = peerId;
+    pMsg->destId = node.myRaftId;
+    pMsg->term = kTerm;
+    pMsg->startTime = kStartTime;
+    pMsg->seq = seq;
+    memcpy(pMsg->data, &seq, sizeof(int32_t));
+    int32_t code = syncNodeOnSnapshot(&node, &rpcMsg);
+    rpcFreeCont(rpcMsg.pCont);
+    return code;
+  }
+
+  int32_t nBlocksBuffered() {
+    int32_t n = 0;
+    for (int32_t i = 0; i < SYNC_SNAPSHOT_WINDOW_SIZE; i++) {
+      if (pReceiver->blocks[i].pBlock != NULL) {
+        EXPECT_GT(pReceiver->blocks[i].seq, pReceiver->ack + 1);
+        n++;
+      }
+    }
+    return n;
+  }
+
+  SSyncSnapshotReceiver *pReceiver = NULL;
+};
+
+std::vector<int32_t> seqRange(int32_t first, int32_t last) {
+  std::vector<int32_t> seqs;
+  for (int32_t seq = first; seq <= last; seq++) {
+    seqs.push_back(seq);
+  }
+  return seqs;
+}
+
+}  // namespace
+
+TEST_F(SyncSnapshotSenderWindowTest, windowSlides) {
+  snap.nBlocks = 2 * SYNC_SNAPSHOT_WINDOW_SIZE;
+
+  // a full window is sent without waiting for acks
+  ASSERT_EQ(snapshotSend(pSender), 0);
+  ASSERT_EQ(sentSeqs(), seqRange(1, SYNC_SNAPSHOT_WINDOW_SIZE));
+  ASSERT_EQ(pSender->seq, SYNC_SNAPSHOT_WINDOW_SIZE);
+  ASSERT_EQ(nBlocksInFlight(), SYNC_SNAPSHOT_WINDOW_SIZE);
+
+  // a cumulative ack releases the acked blocks and refills the window
+  ASSERT_EQ(ack(3), 0);
+  ASSERT_EQ(pSender->ack, 3);
+  ASSERT_EQ(sentSeqs(), seqRange(SYNC_SNAPSHOT_WINDOW_SIZE + 1, SYNC_SNAPSHOT_WINDOW_SIZE + 3));
+  ASSERT_EQ(pSender->seq, SYNC_SNAPSHOT_WINDOW_SIZE + 3);
+  ASSERT_EQ(nBlocksInFlight(), SYNC_SNAPSHOT_WINDOW_SIZE);
+
+  // a stale ack changes nothing
+  ASSERT_EQ(ack(2), 0);
+  ASSERT_EQ(pSender->ack, 3);
+  ASSERT_TRUE(sentSeqs().empty());
+
+  // the snapshot is read to the end, the end msg follows the ack of the last block only
+  ASSERT_EQ(ack(SYNC_SNAPSHOT_WINDOW_SIZE + 3), 0);
+  ASSERT_EQ(sentSeqs(), seqRange(SYNC_SNAPSHOT_WINDOW_SIZE + 4, 2 * SYNC_SNAPSHOT_WINDOW_SIZE));
+  ASSERT_TRUE(pSender->readFinish);
+  ASSERT_EQ(nBlocksInFlight(), SYNC_SNAPSHOT_WINDOW_SIZE - 3);
+
+  ASSERT_EQ(ack(2 * SYNC_SNAPSHOT_WINDOW_SIZE - 1), 0);
+  ASSERT_TRUE(sentSeqs().empty());
+  ASSERT_EQ(nBlocksInFlight(), 1);
+
+  ASSERT_EQ(ack(2 * SYNC_SNAPSHOT_WINDOW_SIZE), 0);
+  ASSERT_EQ(sentSeqs(), std::vector<int32_t>{SYNC_SNAPSHOT_SEQ_END});
+  ASSERT_EQ(pSender->seq, SYNC_SNAPSHOT_SEQ_END);
+  ASSERT_EQ(nBlocksInFlight(), 0);
+}
+
+TEST_F(SyncSnapshotSenderWindowTest, duplicatedAckResendsMissingBlock) {
+  snap.nBlocks = 2 * SYNC_SNAPSHOT_WINDOW_SIZE;
+
+  ASSERT_EQ(snapshotSend(pSender), 0);
+  ASSERT_EQ(ack(2), 0);
+  sentMsgs.clear();
+
+  // block 3 is lost, the receiver acks the later ones with 2 again, block 3 is resent once
+  ASSERT_EQ(ack(2), 0);
+  ASSERT_EQ(sentMsgs.size(), 1);
+  ASSERT_EQ(sentMsgs[0].seq, 3);
+  ASSERT_EQ(sentMsgs[0].data, 3);
+  sentMsgs.clear();
+
+  ASSERT_EQ(ack(2), 0);
+  ASSERT_TRUE(sentSeqs().empty());
+
+  // the resend timer retransmits the whole unacked window
+  ASSERT_EQ(snapshotReSend(pSender), 0);
+  ASSERT_EQ(sentSeqs(), seqRange(3, pSender->seq));
+}
+
+TEST_F(SyncSnapshotReceiverWindowTest, outOfOrderBlocksAreBuffered) {
+  // blocks 2 and 3 come before block 1, they are buffered and acked with the last seq applied
+  ASSERT_EQ(send(3), 0);
+  ASSERT_EQ(send(2), 0);
+  ASSERT_EQ(sentSeqs(), (std::vector<int32_t>{SYNC_SNAPSHOT_SEQ_BEGIN, SYNC_SNAPSHOT_SEQ_BEGIN}));
+  ASSERT_EQ(pReceiver->ack, SYNC_SNAPSHOT_SEQ_BEGIN);
+  ASSERT_TRUE(snap.written.empty());
+  ASSERT_EQ(nBlocksBuffered(), 2);
+
+  // a duplicated buffered block is ignored
+  ASSERT_EQ(send(3), 0);
+  ASSERT_EQ(nBlocksBuffered(), 2);
+  sentMsgs.clear();
+
+  // block 1 applies the buffered ones in seq order
+  ASSERT_EQ(send(1), 0);
+  ASSERT_EQ(sentSeqs(), std::vector<int32_t>{3});
+  ASSERT_EQ(pReceiver->ack, 3);
+  ASSERT_EQ(snap.written, seqRange(1, 3));
+  ASSERT_EQ(nBlocksBuffered(), 0);
+
+  // a block already applied is acked again but not written twice
+  ASSERT_EQ(send(2), 0);
+  ASSERT_EQ(sentSeqs(), std::vector<int32_t>{3});
+  ASSERT_EQ(snap.written, seqRange(1, 3));
+}
+
+TEST_F(SyncSnapshotReceiverWindowTest, blockBeyondWindowIsRejected) {
+  ASSERT_EQ(send(SYNC_SNAPSHOT_WINDOW_SIZE), 0);
+  ASSERT_EQ(nBlocksBuffered(), 1);
+  sentMsgs.clear();
+
+  ASSERT_NE(send(SYNC_SNAPSHOT_WINDOW_SIZE + 1), 0);
+  ASSERT_EQ(sentMsgs.size(), 1);
+  ASSERT_EQ(sentMsgs[0].seq, SYNC_SNAPSHOT_SEQ_BEGIN);
+  ASSERT_NE(sentMsgs[0].data, 0);
+  ASSERT_EQ(nBlocksBuffered(), 1);
+  ASSERT_TRUE(snap.written.empty());
+}
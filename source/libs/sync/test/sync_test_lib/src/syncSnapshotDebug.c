@@ -28,19 +28,18 @@ cJSON *snapshotSender2Json(SSyncSnapshotSender *pSender) {
     snprintf(u64buf, sizeof(u64buf), "%p", pSender->pReader);
     cJSON_AddStringToObject(pRoot, "pReader", u64buf);
 
-    snprintf(u64buf, sizeof(u64buf), "%p", pSender->pCurrentBlock);
-    cJSON_AddStringToObject(pRoot, "pCurrentBlock", u64buf);
-    cJSON_AddNumberToObject(pRoot, "blockLen", pSender->blockLen);
-
-    if (pSender->pCurrentBlock != NULL) {
-      char *s;
-      s = syncUtilPrintBin((char *)(pSender->pCurrentBlock), pSender->blockLen);
-      cJSON_AddStringToObject(pRoot, "pCurrentBlock", s);
-      taosMemoryFree(s);
-      s = syncUtilPrintBin2((char *)(pSender->pCurrentBlock), pSender->blockLen);
-      cJSON_AddStringToObject(pRoot, "pCurrentBlock2", s);
-      taosMemoryFree(s);
+    cJSON_AddNumberToObject(pRoot, "readFinish", pSender->readFinish);
+
+    cJSON *pBlocks = cJSON_CreateArray();
+    for (int32_t i = 0; i < SYNC_SNAPSHOT_WINDOW_SIZE; i++) {
+      if (pSender->blocks[i].seq == SYNC_SNAPSHOT_SEQ_INVALID) continue;
+      cJSON *pBlock = cJSON_CreateObject();
+      cJSON_AddNumberToObject(pBlock, "seq", pSender->blocks[i].seq);
+      cJSON_AddNumberToObject(pBlock, "blockLen", pSender->blocks[i].blockLen);
+      cJSON_AddNumberToObject(pBlock, "resent", pSender->blocks[i].resent);
+      cJSON_AddItemToArray(pBlocks, pBlock);
     }
+    cJSON_AddItemToObject(pRoot, "blocks", pBlocks);
 
     cJSON *pSnapshot = cJSON_CreateObject();
     snprintf(u64buf, sizeof(u64buf), "%" PRIu64, pSender->snapshot.lastApplyIndex);
@@ -325,6 +325,7 @@ int tdbBtreePGet(SBTree *pBt, const void *pKey, int kLen, void **ppKey, int *pkL
     pTKey = tdbRealloc(*ppKey, cd.kLen);
     if (pTKey == NULL) {
       tdbBtcClose(&btc);
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
       ASSERT(0);
       return -1;
     }
@@ -337,6 +338,7 @@ int tdbBtreePGet(SBTree *pBt, const void *pKey, int kLen, void **ppKey, int *pkL
     pTVal = tdbRealloc(*ppVal, cd.vLen);
     if (pTVal == NULL) {
       tdbBtcClose(&btc);
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
       ASSERT(0);
       return -1;
     }
@@ -863,7 +865,12 @@ static int tdbBtreeBalanceNonRoot(SBTree *pBt, SPage *pParent, int idx, TXN *pTx
   }
 
   for (pageIdx = 0; pageIdx < nOlds; ++pageIdx) {
-    tdbPagerReturnPage(pBt->pPager, pOlds[pageIdx], pTxn);
+    if (pageIdx < nNews) {
+      tdbPagerReturnPage(pBt->pPager, pOlds[pageIdx], pTxn);
+    } else {
+      // the cells of the page are all merged into its siblings
+      tdbPagerFreePage(pBt->pPager, pOlds[pageIdx], pTxn);
+    }
   }
   for (; pageIdx < nNews; ++pageIdx) {
     tdbPagerReturnPage(pBt->pPager, pNews[pageIdx], pTxn);
@@ -70,6 +70,17 @@ int32_t tdbOpen(const char *dbname, int32_t szPage, int32_t pages, TDB **ppDb, i
   if (ret < 0) {
     return -1;
   }
+
+  // open free db & load the free pages of the main db file
+  ret = tdbTbOpen(TDB_FREEDB_NAME, sizeof(int32_t), -1, NULL, pDb, &pDb->pFreeDb, rollback);
+  if (ret < 0) {
+    return -1;
+  }
+
+  ret = tdbPagerLoadFreeList(tdbEnvGetMainPager(pDb), pDb->pFreeDb);
+  if (ret < 0) {
+    return -1;
+  }
 #endif
 
   *ppDb = pDb;
@@ -81,6 +92,7 @@ int tdbClose(TDB *pDb) {
 
   if (pDb) {
 #ifdef USE_MAINDB
+    if (pDb->pFreeDb) tdbTbClose(pDb->pFreeDb);
     if (pDb->pMainDb) tdbTbClose(pDb->pMainDb);
 #endif
 
@@ -99,6 +111,20 @@ int tdbClose(TDB *pDb) {
 
 int32_t tdbAlter(TDB *pDb, int pages) { return tdbPCacheAlter(pDb->pCache, pages); }
 
+// ckptSize > 0 commits to a redo log checkpointed into the db files every ckptSize bytes, 0 to the rollback journal
+int32_t tdbSetWal(TDB *pDb, int64_t ckptSize) {
+  SPager *pPager;
+
+  for (pPager = pDb->pgrList; pPager; pPager = pPager->pNext) {
+    if (tdbPagerSetWal(pPager, ckptSize) < 0) {
+      tdbError("failed to set wal since %s. dbName:%s, ckptSize:%" PRId64, tstrerror(terrno), pDb->dbName, ckptSize);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
 int32_t tdbBegin(TDB *pDb, TXN **ppTxn, void *(*xMalloc)(void *, size_t), void (*xFree)(void *, void *), void *xArg,
                  int flags) {
   SPager *pPager;
@@ -133,10 +159,32 @@ int32_t tdbBegin(TDB *pDb, TXN **ppTxn, void *(*xMalloc)(void *, size_t), void (
   return 0;
 }
 
+// Release the free tail of the main db file and save its free pages, before the dirty pages are written out.
+static int tdbEnvSaveFreeList(TDB *pDb, TXN *pTxn) {
+#ifdef USE_MAINDB
+  if (pDb->pFreeDb == NULL) return 0;
+
+  SPager *pPager = tdbEnvGetMainPager(pDb);
+
+  tdbPagerVacuum(pPager);
+  if (tdbPagerSaveFreeList(pPager, pDb->pFreeDb, pTxn) < 0) {
+    tdbError("failed to save free pages since %s. dbName:%s, txnId:%" PRId64, tstrerror(terrno), pDb->dbName,
+             pTxn->txnId);
+    return -1;
+  }
+#endif
+  return 0;
+}
+
 int32_t tdbCommit(TDB *pDb, TXN *pTxn) {
   SPager *pPager;
   int     ret;
 
+  ret = tdbEnvSaveFreeList(pDb, pTxn);
+  if (ret < 0) {
+    return -1;
+  }
+
   for (pPager = pDb->pgrList; pPager; pPager = pPager->pNext) {
     ret = tdbPagerCommit(pPager, pTxn);
     if (ret < 0) {
@@ -171,6 +219,11 @@ int32_t tdbPrepareAsyncCommit(TDB *pDb, TXN *pTxn) {
   SPager *pPager;
   int     ret;
 
+  ret = tdbEnvSaveFreeList(pDb, pTxn);
+  if (ret < 0) {
+    return -1;
+  }
+
   for (pPager = pDb->pgrList; pPager; pPager = pPager->pNext) {
     ret = tdbPagerPrepareAsyncCommit(pPager, pTxn);
     if (ret < 0) {
@@ -196,11 +249,31 @@ int32_t tdbAbort(TDB *pDb, TXN *pTxn) {
     }
   }
 
+#ifdef USE_MAINDB
+  // the free pages changed by the txn are rolled back with the free db
+  if (pDb->pFreeDb) {
+    ret = tdbPagerLoadFreeList(tdbEnvGetMainPager(pDb), pDb->pFreeDb);
+    if (ret < 0) {
+      tdbError("failed to reload free pages since %s. dbName:%s", tstrerror(terrno), pDb->dbName);
+      return -1;
+    }
+  }
+#endif
+
   tdbTxnClose(pTxn);
 
   return 0;
 }
 
+#ifdef USE_MAINDB
+SPager *tdbEnvGetMainPager(TDB *pDb) {
+  char fFullName[TDB_FILENAME_LEN];
+
+  snprintf(fFullName, TDB_FILENAME_LEN, "%s/%s", pDb->dbName, TDB_MAINDB_NAME);
+  return tdbEnvGetPager(pDb, fFullName);
+}
+#endif
+
 SPager *tdbEnvGetPager(TDB *pDb, const char *fname) {
   u32      hash;
   SPager **ppPager;
@@ -17,18 +17,40 @@
 // #include <sys/types.h>
 // #include <unistd.h>
 
-struct SPCache {
-  int         szPage;
-  int         nPages;
-  SPage     **aPage;
+#define TDB_PCACHE_MAX_SHARDS  16
+#define TDB_PCACHE_SHARD_PAGES 64  // min pages of a shard
+
+/*
+ * The cache is split into shards by the hash of the pgid, each with its own lock, hash table and free list. A shard
+ * owns the pages in its aOwn, and a page in use always belongs to the shard of its pgid. Unpinned pages are replaced
+ * with CLOCK: a hit only sets clockRef, and the hand of the shard clears it or recycles the page. A shard out of free
+ * and recyclable pages borrows them from the other shards, so the pages follow the load instead of the pgid hash.
+ */
+typedef struct {
   tdb_mutex_t mutex;
+  int         idx;
   int         nFree;
   SPage      *pFree;
   int         nPage;
   int         nHash;
   SPage     **pgHash;
   int         nRecyclable;
-  SPage       lru;
+  int         nOwn;
+  int         szOwn;
+  SPage     **aOwn;   // pages owned by the shard, page->slot is the index
+  int         clock;  // next page of aOwn checked by the CLOCK hand
+  i64         nHit;
+  i64         nMiss;
+  i64         nBorrow;
+} SPCacheShard;
+
+struct SPCache {
+  int           szPage;
+  int           nPages;
+  SPage       **aPage;
+  int           nShard;
+  SPCacheShard *aShard;
+  volatile i32  nFree;  // free pages of all the shards
 };
 
 static inline uint32_t tdbPCachePageHash(const SPgid *pPgid) {
@@ -36,18 +58,75 @@ static inline uint32_t tdbPCachePageHash(const SPgid *pPgid) {
   return (uint32_t)(t[0] + t[1] + t[2] + t[3] + t[4] + t[5] + (pPgid)->pgno);
 }
 
+static inline SPCacheShard *tdbPCacheGetShard(SPCache *pCache, const SPgid *pPgid) {
+  return &pCache->aShard[tdbPCachePageHash(pPgid) % pCache->nShard];
+}
+
+static inline uint32_t tdbPCacheHashSlot(SPCache *pCache, SPCacheShard *pShard, const SPgid *pPgid) {
+  return tdbPCachePageHash(pPgid) / pCache->nShard % pShard->nHash;
+}
+
 static int    tdbPCacheOpenImpl(SPCache *pCache);
-static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn);
-static void   tdbPCachePinPage(SPCache *pCache, SPage *pPage);
-static void   tdbPCacheRemovePageFromHash(SPCache *pCache, SPage *pPage);
-static void   tdbPCacheAddPageToHash(SPCache *pCache, SPage *pPage);
-static void   tdbPCacheUnpinPage(SPCache *pCache, SPage *pPage);
+static SPage *tdbPCacheFetchImpl(SPCache *pCache, SPCacheShard *pShard, const SPgid *pPgid, TXN *pTxn);
+static void   tdbPCachePinPage(SPCacheShard *pShard, SPage *pPage);
+static void   tdbPCacheRemovePageFromHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage);
+static void   tdbPCacheAddPageToHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage);
+static void   tdbPCacheUnpinPage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage);
 static int    tdbPCacheCloseImpl(SPCache *pCache);
 
-static void tdbPCacheInitLock(SPCache *pCache) { tdbMutexInit(&(pCache->mutex), NULL); }
-static void tdbPCacheDestroyLock(SPCache *pCache) { tdbMutexDestroy(&(pCache->mutex)); }
-static void tdbPCacheLock(SPCache *pCache) { tdbMutexLock(&(pCache->mutex)); }
-static void tdbPCacheUnlock(SPCache *pCache) { tdbMutexUnlock(&(pCache->mutex)); }
+static void tdbPCacheInitLock(SPCacheShard *pShard) { tdbMutexInit(&(pShard->mutex), NULL); }
+static void tdbPCacheDestroyLock(SPCacheShard *pShard) { tdbMutexDestroy(&(pShard->mutex)); }
+static void tdbPCacheLock(SPCacheShard *pShard) { tdbMutexLock(&(pShard->mutex)); }
+static int  tdbPCacheTryLock(SPCacheShard *pShard) { return tdbMutexTryLock(&(pShard->mutex)); }
+static void tdbPCacheUnlock(SPCacheShard *pShard) { tdbMutexUnlock(&(pShard->mutex)); }
+
+// make room in aOwn for one more page, so that taking a page over cannot fail
+static int tdbPCacheReserveOwn(SPCacheShard *pShard) {
+  if (pShard->nOwn < pShard->szOwn) return 0;
+
+  int     szOwn = pShard->szOwn ? pShard->szOwn * 2 : TDB_PCACHE_SHARD_PAGES;
+  SPage **aOwn = (SPage **)tdbOsRealloc(pShard->aOwn, sizeof(SPage *) * szOwn);
+  if (aOwn == NULL) {
+    return -1;
+  }
+
+  pShard->aOwn = aOwn;
+  pShard->szOwn = szOwn;
+  return 0;
+}
+
+static void tdbPCacheOwnPage(SPCacheShard *pShard, SPage *pPage) {
+  ASSERT(pShard->nOwn < pShard->szOwn);
+
+  pPage->slot = pShard->nOwn;
+  pShard->aOwn[pShard->nOwn++] = pPage;
+}
+
+static void tdbPCacheDisownPage(SPCacheShard *pShard, SPage *pPage) {
+  SPage *pLast = pShard->aOwn[--pShard->nOwn];
+
+  pShard->aOwn[pPage->slot] = pLast;
+  pLast->slot = pPage->slot;
+}
+
+static void tdbPCachePushFree(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
+  pPage->pFreeNext = pShard->pFree;
+  pShard->pFree = pPage;
+  pShard->nFree++;
+  atomic_add_fetch_32(&pCache->nFree, 1);
+}
+
+static SPage *tdbPCachePopFree(SPCache *pCache, SPCacheShard *pShard) {
+  SPage *pPage = pShard->pFree;
+
+  if (pPage) {
+    pShard->pFree = pPage->pFreeNext;
+    pShard->nFree--;
+    atomic_sub_fetch_32(&pCache->nFree, 1);
+  }
+
+  return pPage;
+}
 
 int tdbPCacheOpen(int pageSize, int cacheSize, SPCache **ppCache) {
   SPCache *pCache;
@@ -93,6 +172,12 @@ int tdbPCacheClose(SPCache *pCache) {
 //   add to free list
 // }
 
+static void tdbPCacheDestroyPage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
+  tdbPCacheDisownPage(pShard, pPage);
+  pCache->aPage[pPage->id] = NULL;
+  tdbPageDestroy(pPage, tdbDefaultFree, NULL);
+}
+
 static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
   if (pCache->nPages == nPage) {
     return 0;
@@ -110,43 +195,70 @@ static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
       }
 
       // pPage->pgid = 0;
-      aPage[iPage]->isAnchor = 0;
       aPage[iPage]->isLocal = 1;
+      aPage[iPage]->isRecyclable = 0;
       aPage[iPage]->nRef = 0;
       aPage[iPage]->pHashNext = NULL;
-      aPage[iPage]->pLruNext = NULL;
-      aPage[iPage]->pLruPrev = NULL;
       aPage[iPage]->pDirtyNext = NULL;
 
       // add to local list
       aPage[iPage]->id = iPage;
     }
 
-    // add page to free list
-    for (int32_t iPage = pCache->nPages; iPage < nPage; iPage++) {
-      aPage[iPage]->pFreeNext = pCache->pFree;
-      pCache->pFree = aPage[iPage];
-      pCache->nFree++;
-    }
-
     for (int32_t iPage = 0; iPage < pCache->nPages; iPage++) {
       aPage[iPage] = pCache->aPage[iPage];
     }
 
     tdbOsFree(pCache->aPage);
     pCache->aPage = aPage;
+
+    // add page to free list of a shard, the pages not taken over are dropped
+    for (int32_t iPage = pCache->nPages; iPage < nPage; iPage++) {
+      SPCacheShard *pShard = &pCache->aShard[iPage % pCache->nShard];
+
+      if (tdbPCacheReserveOwn(pShard) < 0) {
+        for (int32_t jPage = iPage; jPage < nPage; jPage++) {
+          tdbPageDestroy(aPage[jPage], tdbDefaultFree, NULL);
+          aPage[jPage] = NULL;
+        }
+        pCache->nPages = iPage;
+        return -1;
+      }
+
+      tdbPCacheOwnPage(pShard, aPage[iPage]);
+      tdbPCachePushFree(pCache, pShard, aPage[iPage]);
+    }
   } else {
-    for (SPage **ppPage = &pCache->pFree; *ppPage;) {
-      int32_t iPage = (*ppPage)->id;
-
-      if (iPage >= nPage) {
-        SPage *pPage = *ppPage;
-        *ppPage = pPage->pFreeNext;
-        pCache->aPage[pPage->id] = NULL;
-        tdbPageDestroy(pPage, tdbDefaultFree, NULL);
-        pCache->nFree--;
-      } else {
-        ppPage = &(*ppPage)->pFreeNext;
+    for (int32_t iShard = 0; iShard < pCache->nShard; iShard++) {
+      SPCacheShard *pShard = &pCache->aShard[iShard];
+
+      for (SPage **ppPage = &pShard->pFree; *ppPage;) {
+        int32_t iPage = (*ppPage)->id;
+
+        if (iPage >= nPage) {
+          SPage *pPage = *ppPage;
+          *ppPage = pPage->pFreeNext;
+          tdbPCacheDestroyPage(pCache, pShard, pPage);
+          pShard->nFree--;
+          atomic_sub_fetch_32(&pCache->nFree, 1);
+        } else {
+          ppPage = &(*ppPage)->pFreeNext;
+        }
+      }
+
+      pShard->clock = 0;
+    }
+
+    // the unpinned pages out of the cache are not reached by the clock any more, pinned ones are destroyed when unpinned
+    for (int32_t iPage = nPage; iPage < pCache->nPages; iPage++) {
+      SPage *pPage = pCache->aPage[iPage];
+
+      if (pPage && pPage->isRecyclable) {
+        SPCacheShard *pShard = tdbPCacheGetShard(pCache, &pPage->pgid);
+
+        tdbPCachePinPage(pShard, pPage);
+        tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
+        tdbPCacheDestroyPage(pCache, pShard, pPage);
       }
     }
   }
@@ -158,27 +270,32 @@ static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
 int tdbPCacheAlter(SPCache *pCache, int32_t nPage) {
   int ret = 0;
 
-  tdbPCacheLock(pCache);
+  for (int32_t iShard = 0; iShard < pCache->nShard; iShard++) {
+    tdbPCacheLock(&pCache->aShard[iShard]);
+  }
 
   ret = tdbPCacheAlterImpl(pCache, nPage);
 
-  tdbPCacheUnlock(pCache);
+  for (int32_t iShard = pCache->nShard - 1; iShard >= 0; iShard--) {
+    tdbPCacheUnlock(&pCache->aShard[iShard]);
+  }
 
   return ret;
 }
 
 SPage *tdbPCacheFetch(SPCache *pCache, const SPgid *pPgid, TXN *pTxn) {
-  SPage *pPage;
-  i32    nRef = 0;
+  SPage        *pPage;
+  i32           nRef = 0;
+  SPCacheShard *pShard = tdbPCacheGetShard(pCache, pPgid);
 
-  tdbPCacheLock(pCache);
+  tdbPCacheLock(pShard);
 
-  pPage = tdbPCacheFetchImpl(pCache, pPgid, pTxn);
+  pPage = tdbPCacheFetchImpl(pCache, pShard, pPgid, pTxn);
   if (pPage) {
     nRef = tdbRefPage(pPage);
   }
 
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlock(pShard);
 
   // printf("thread %" PRId64 " fetch page %d pgno %d pPage %p nRef %d\n", taosGetSelfPthreadId(), pPage->id,
   //        TDB_PAGE_PGNO(pPage), pPage, nRef);
@@ -193,55 +310,60 @@ SPage *tdbPCacheFetch(SPCache *pCache, const SPgid *pPgid, TXN *pTxn) {
 }
 
 void tdbPCacheMarkFree(SPCache *pCache, SPage *pPage) {
-  tdbPCacheLock(pCache);
-  tdbPCacheRemovePageFromHash(pCache, pPage);
+  SPCacheShard *pShard = tdbPCacheGetShard(pCache, &pPage->pgid);
+
+  tdbPCacheLock(pShard);
+  tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
   pPage->isFree = 1;
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlock(pShard);
 }
 
-static void tdbPCacheFreePage(SPCache *pCache, SPage *pPage) {
+static void tdbPCacheFreePage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
   if (pPage->id < pCache->nPages) {
-    pPage->pFreeNext = pCache->pFree;
-    pCache->pFree = pPage;
     pPage->isFree = 0;
-    ++pCache->nFree;
+    tdbPCachePushFree(pCache, pShard, pPage);
     tdbTrace("pcache/free page %p/%d, pgno:%d, ", pPage, pPage->id, TDB_PAGE_PGNO(pPage));
   } else {
     tdbTrace("pcache/free2 page: %p/%d, pgno:%d, ", pPage, pPage->id, TDB_PAGE_PGNO(pPage));
 
-    tdbPCacheRemovePageFromHash(pCache, pPage);
-    tdbPageDestroy(pPage, tdbDefaultFree, NULL);
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
+    tdbPCacheDestroyPage(pCache, pShard, pPage);
   }
 }
 
 void tdbPCacheInvalidatePage(SPCache *pCache, SPager *pPager, SPgno pgno) {
-  SPgid        pgid;
-  const SPgid *pPgid = &pgid;
-  SPage       *pPage = NULL;
+  SPgid         pgid;
+  const SPgid  *pPgid = &pgid;
+  SPage        *pPage = NULL;
+  SPCacheShard *pShard;
 
   memcpy(&pgid, pPager->fid, TDB_FILE_ID_LEN);
   pgid.pgno = pgno;
+  pShard = tdbPCacheGetShard(pCache, pPgid);
 
-  pPage = pCache->pgHash[tdbPCachePageHash(pPgid) % pCache->nHash];
+  tdbPCacheLock(pShard);
+  pPage = pShard->pgHash[tdbPCacheHashSlot(pCache, pShard, pPgid)];
   while (pPage) {
     if (pPage->pgid.pgno == pPgid->pgno && memcmp(pPage->pgid.fileid, pPgid->fileid, TDB_FILE_ID_LEN) == 0) break;
     pPage = pPage->pHashNext;
   }
 
   if (pPage) {
-    tdbPCacheRemovePageFromHash(pCache, pPage);
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
   }
+  tdbPCacheUnlock(pShard);
 }
 
 void tdbPCacheRelease(SPCache *pCache, SPage *pPage, TXN *pTxn) {
-  i32 nRef;
+  i32           nRef;
+  SPCacheShard *pShard = tdbPCacheGetShard(pCache, &pPage->pgid);
 
   ASSERT(pTxn);
 
   // nRef = tdbUnrefPage(pPage);
   // ASSERT(nRef >= 0);
 
-  tdbPCacheLock(pCache);
+  tdbPCacheLock(pShard);
   nRef = tdbUnrefPage(pPage);
   tdbTrace("pcache/release page %p/%d/%d/%d", pPage, TDB_PAGE_PGNO(pPage), pPage->id, nRef);
   if (nRef == 0) {
@@ -251,26 +373,78 @@ void tdbPCacheRelease(SPCache *pCache, SPage *pPage, TXN *pTxn) {
     // if (nRef == 0) {
     if (pPage->isLocal) {
       if (!pPage->isFree) {
-        tdbPCacheUnpinPage(pCache, pPage);
+        tdbPCacheUnpinPage(pCache, pShard, pPage);
       } else {
-        tdbPCacheFreePage(pCache, pPage);
+        tdbPCacheFreePage(pCache, pShard, pPage);
       }
     } else {
       if (TDB_TXN_IS_WRITE(pTxn)) {
         // remove from hash
-        tdbPCacheRemovePageFromHash(pCache, pPage);
+        tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
       }
 
       tdbPageDestroy(pPage, pTxn->xFree, pTxn->xArg);
     }
     // }
   }
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlock(pShard);
 }
 
 int tdbPCacheGetPageSize(SPCache *pCache) { return pCache->szPage; }
 
-static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn) {
+// run the CLOCK hand over the pages of the shard, each recyclable page is passed once more if it was hit
+static SPage *tdbPCacheRecyclePage(SPCache *pCache, SPCacheShard *pShard) {
+  if (pShard->nRecyclable == 0) return NULL;
+
+  for (int i = 0; i < pShard->nOwn * 2; i++) {
+    if (pShard->clock >= pShard->nOwn) pShard->clock = 0;
+
+    SPage *pPage = pShard->aOwn[pShard->clock++];
+
+    if (!pPage->isRecyclable) continue;
+    if (pPage->clockRef) {
+      pPage->clockRef = 0;
+      continue;
+    }
+
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
+    tdbPCachePinPage(pShard, pPage);
+    return pPage;
+  }
+
+  return NULL;
+}
+
+// take a free page, or a recycled one, over from another shard
+static SPage *tdbPCacheBorrowPage(SPCache *pCache, SPCacheShard *pShard, bool recycle) {
+  if (tdbPCacheReserveOwn(pShard) < 0) return NULL;
+
+  for (int i = 1; i < pCache->nShard; i++) {
+    SPCacheShard *pDonor = &pCache->aShard[(pShard->idx + i) % pCache->nShard];
+    SPage        *pPage;
+
+    // never wait for a donor while holding the shard, two shards borrowing from each other would deadlock
+    if (tdbPCacheTryLock(pDonor) != 0) continue;
+
+    pPage = recycle ? tdbPCacheRecyclePage(pCache, pDonor) : tdbPCachePopFree(pCache, pDonor);
+    if (pPage) {
+      tdbPCacheDisownPage(pDonor, pPage);
+    }
+
+    tdbPCacheUnlock(pDonor);
+
+    if (pPage) {
+      tdbPCacheOwnPage(pShard, pPage);
+      pShard->nBorrow++;
+      tdbTrace("pcache/borrow page %p/%d from shard %d to %d", pPage, pPage->id, pDonor->idx, pShard->idx);
+      return pPage;
+    }
+  }
+
+  return NULL;
+}
+
+static SPage *tdbPCacheFetchImpl(SPCache *pCache, SPCacheShard *pShard, const SPgid *pPgid, TXN *pTxn) {
   int    ret = 0;
   SPage *pPage = NULL;
   SPage *pPageH = NULL;
@@ -278,17 +452,21 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   ASSERT(pTxn);
 
   // 1. Search the hash table
-  pPage = pCache->pgHash[tdbPCachePageHash(pPgid) % pCache->nHash];
+  pPage = pShard->pgHash[tdbPCacheHashSlot(pCache, pShard, pPgid)];
   while (pPage) {
     if (pPage->pgid.pgno == pPgid->pgno && memcmp(pPage->pgid.fileid, pPgid->fileid, TDB_FILE_ID_LEN) == 0) break;
     pPage = pPage->pHashNext;
   }
 
   if (pPage) {
+    pShard->nHit++;
+    pPage->clockRef = 1;
     if (pPage->isLocal || TDB_TXN_IS_WRITE(pTxn)) {
-      tdbPCachePinPage(pCache, pPage);
+      tdbPCachePinPage(pShard, pPage);
       return pPage;
     }
+  } else {
+    pShard->nMiss++;
   }
 
   // 1. pPage == NULL
@@ -296,19 +474,18 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   pPageH = pPage;
   pPage = NULL;
 
-  // 2. Try to allocate a new page from the free list
-  if (pCache->pFree) {
-    pPage = pCache->pFree;
-    pCache->pFree = pPage->pFreeNext;
-    pCache->nFree--;
-    pPage->pLruNext = NULL;
+  // 2. Try to allocate a new page from the free list, of the shard or of the others
+  pPage = tdbPCachePopFree(pCache, pShard);
+  if (!pPage && atomic_load_32(&pCache->nFree) > 0) {
+    pPage = tdbPCacheBorrowPage(pCache, pShard, false);
   }
 
-  // 3. Try to Recycle a page
-  if (!pPage && !pCache->lru.pLruPrev->isAnchor) {
-    pPage = pCache->lru.pLruPrev;
-    tdbPCacheRemovePageFromHash(pCache, pPage);
-    tdbPCachePinPage(pCache, pPage);
+  // 3. Try to Recycle a page, of the shard or of the others
+  if (!pPage) {
+    pPage = tdbPCacheRecyclePage(pCache, pShard);
+  }
+  if (!pPage) {
+    pPage = tdbPCacheBorrowPage(pCache, pShard, true);
   }
 
   // 4. Try a create new page
@@ -321,8 +498,8 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
     }
 
     // init the page fields
-    pPage->isAnchor = 0;
     pPage->isLocal = 0;
+    pPage->isRecyclable = 0;
     pPage->nRef = 0;
     pPage->id = -1;
   }
@@ -331,6 +508,7 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   // or by recycling or allocated streesly,
   // need to initialize it
   if (pPage) {
+    pPage->clockRef = 0;
     if (pPageH) {
       // copy the page content
       memcpy(&(pPage->pgid), pPgid, sizeof(*pPgid));
@@ -343,7 +521,6 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
         }
       }
 
-      pPage->pLruNext = NULL;
       pPage->pPager = pPageH->pPager;
 
       memcpy(pPage->pData, pPageH->pData, pPage->pageSize);
@@ -356,11 +533,10 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
       pPage->minLocal = pPageH->minLocal;
     } else {
       memcpy(&(pPage->pgid), pPgid, sizeof(*pPgid));
-      pPage->pLruNext = NULL;
       pPage->pPager = NULL;
 
       if (pPage->isLocal || TDB_TXN_IS_WRITE(pTxn)) {
-        tdbPCacheAddPageToHash(pCache, pPage);
+        tdbPCacheAddPageToHash(pCache, pShard, pPage);
       }
     }
   }
@@ -368,74 +544,69 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   return pPage;
 }
 
-static void tdbPCachePinPage(SPCache *pCache, SPage *pPage) {
-  if (pPage->pLruNext != NULL) {
+static void tdbPCachePinPage(SPCacheShard *pShard, SPage *pPage) {
+  if (pPage->isRecyclable) {
     ASSERT(tdbGetPageRef(pPage) == 0);
 
-    pPage->pLruPrev->pLruNext = pPage->pLruNext;
-    pPage->pLruNext->pLruPrev = pPage->pLruPrev;
-    pPage->pLruNext = NULL;
-
-    pCache->nRecyclable--;
+    pPage->isRecyclable = 0;
+    pShard->nRecyclable--;
 
     tdbTrace("pcache/pin page %p/%d, pgno:%d, ", pPage, pPage->id, TDB_PAGE_PGNO(pPage));
   }
 }
 
-static void tdbPCacheUnpinPage(SPCache *pCache, SPage *pPage) {
+static void tdbPCacheUnpinPage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
   i32 nRef;
 
   ASSERT(pPage->isLocal);
   ASSERT(!pPage->isDirty);
   ASSERT(tdbGetPageRef(pPage) == 0);
 
-  ASSERT(pPage->pLruNext == NULL);
+  ASSERT(!pPage->isRecyclable);
 
   tdbTrace("pCache:%p unpin page %p/%d, nPages:%d, pgno:%d, ", pCache, pPage, pPage->id, pCache->nPages,
            TDB_PAGE_PGNO(pPage));
   if (pPage->id < pCache->nPages) {
-    pPage->pLruPrev = &(pCache->lru);
-    pPage->pLruNext = pCache->lru.pLruNext;
-    pCache->lru.pLruNext->pLruPrev = pPage;
-    pCache->lru.pLruNext = pPage;
-
-    pCache->nRecyclable++;
+    pPage->isRecyclable = 1;
+    pShard->nRecyclable++;
 
     // printf("unpin page %d pgno %d pPage %p\n", pPage->id, TDB_PAGE_PGNO(pPage), pPage);
     tdbTrace("pcache/unpin page %p/%d/%d", pPage, TDB_PAGE_PGNO(pPage), pPage->id);
   } else {
     tdbTrace("pcache destroy page: %p/%d/%d", pPage, TDB_PAGE_PGNO(pPage), pPage->id);
 
-    tdbPCacheRemovePageFromHash(pCache, pPage);
-    tdbPageDestroy(pPage, tdbDefaultFree, NULL);
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
+    tdbPCacheDestroyPage(pCache, pShard, pPage);
   }
 }
 
-static void tdbPCacheRemovePageFromHash(SPCache *pCache, SPage *pPage) {
-  uint32_t h = tdbPCachePageHash(&(pPage->pgid)) % pCache->nHash;
+static void tdbPCacheRemovePageFromHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
+  uint32_t h = tdbPCacheHashSlot(pCache, pShard, &(pPage->pgid));
 
-  SPage **ppPage = &(pCache->pgHash[h]);
+  SPage **ppPage = &(pShard->pgHash[h]);
   for (; (*ppPage) && *ppPage != pPage; ppPage = &((*ppPage)->pHashNext))
     ;
 
   if (*ppPage) {
     *ppPage = pPage->pHashNext;
-    pCache->nPage--;
+    pShard->nPage--;
     // printf("rmv page %d to hash, pgno %d, pPage %p\n", pPage->id, TDB_PAGE_PGNO(pPage), pPage);
   }
 
-  tdbTrace("pcache/remove page %p/%d from hash %" PRIu32 " pgno:%d, ", pPage, pPage->id, h, TDB_PAGE_PGNO(pPage));
+  tdbTrace("pcache/remove page %p/%d from hash %d/%" PRIu32 " pgno:%d, ", pPage, pPage->id, pShard->idx, h,
+           TDB_PAGE_PGNO(pPage));
 }
 
-static void tdbPCacheAddPageToHash(SPCache *pCache, SPage *pPage) {
-  uint32_t h = tdbPCachePageHash(&(pPage->pgid)) % pCache->nHash;
+static void tdbPCacheAddPageToHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
+  uint32_t h = tdbPCacheHashSlot(pCache, pShard, &(pPage->pgid));
 
-  pPage->pHashNext = pCache->pgHash[h];
-  pCache->pgHash[h] = pPage;
+  pPage->pHashNext = pShard->pgHash[h];
+  pShard->pgHash[h] = pPage;
 
-  pCache->nPage++;
+  pShard->nPage++;
 
-  tdbTrace("pcache/add page %p/%d to hash %" PRIu32 " pgno:%d, ", pPage, pPage->id, h, TDB_PAGE_PGNO(pPage));
+  tdbTrace("pcache/add page %p/%d to hash %d/%" PRIu32 " pgno:%d, ", pPage, pPage->id, pShard->idx, h,
+           TDB_PAGE_PGNO(pPage));
 }
 
 static int tdbPCacheOpenImpl(SPCache *pCache) {
@@ -444,71 +615,77 @@ static int tdbPCacheOpenImpl(SPCache *pCache) {
   int    tsize;
   int    ret;
 
-  tdbPCacheInitLock(pCache);
+  // Open the shards, small caches keep a single one
+  pCache->nShard = pCache->nPages / TDB_PCACHE_SHARD_PAGES;
+  if (pCache->nShard < 1) pCache->nShard = 1;
+  if (pCache->nShard > TDB_PCACHE_MAX_SHARDS) pCache->nShard = TDB_PCACHE_MAX_SHARDS;
+
+  pCache->aShard = (SPCacheShard *)tdbOsCalloc(pCache->nShard, sizeof(SPCacheShard));
+  if (pCache->aShard == NULL) {
+    return -1;
+  }
+
+  for (int iShard = 0; iShard < pCache->nShard; iShard++) {
+    SPCacheShard *pShard = &pCache->aShard[iShard];
+
+    tdbPCacheInitLock(pShard);
+    pShard->idx = iShard;
 
-  // Open the free list
-  pCache->nFree = 0;
-  pCache->pFree = NULL;
+    // Open the hash table
+    pShard->nPage = 0;
+    pShard->nHash = pCache->nPages / pCache->nShard < 8 ? 8 : pCache->nPages / pCache->nShard;
+    pShard->pgHash = (SPage **)tdbOsCalloc(pShard->nHash, sizeof(SPage *));
+    if (pShard->pgHash == NULL) {
+      // TODO
+      return -1;
+    }
+  }
+
+  // Open the free lists
   for (int i = 0; i < pCache->nPages; i++) {
-    if (tdbPageCreate(pCache->szPage, &pPage, tdbDefaultMalloc, NULL) < 0) {
+    SPCacheShard *pShard = &pCache->aShard[i % pCache->nShard];
+
+    if (tdbPCacheReserveOwn(pShard) < 0 || tdbPageCreate(pCache->szPage, &pPage, tdbDefaultMalloc, NULL) < 0) {
       // TODO: handle error
       return -1;
     }
 
     // pPage->pgid = 0;
-    pPage->isAnchor = 0;
     pPage->isLocal = 1;
+    pPage->isRecyclable = 0;
     pPage->nRef = 0;
     pPage->pHashNext = NULL;
-    pPage->pLruNext = NULL;
-    pPage->pLruPrev = NULL;
     pPage->pDirtyNext = NULL;
 
     // add page to free list
-    pPage->pFreeNext = pCache->pFree;
-    pCache->pFree = pPage;
-    pCache->nFree++;
+    tdbPCacheOwnPage(pShard, pPage);
+    tdbPCachePushFree(pCache, pShard, pPage);
 
     // add to local list
     pPage->id = i;
     pCache->aPage[i] = pPage;
   }
 
-  // Open the hash table
-  pCache->nPage = 0;
-  pCache->nHash = pCache->nPages < 8 ? 8 : pCache->nPages;
-  pCache->pgHash = (SPage **)tdbOsCalloc(pCache->nHash, sizeof(SPage *));
-  if (pCache->pgHash == NULL) {
-    // TODO
-    return -1;
-  }
-
-  // Open LRU list
-  pCache->nRecyclable = 0;
-  pCache->lru.isAnchor = 1;
-  pCache->lru.pLruNext = &(pCache->lru);
-  pCache->lru.pLruPrev = &(pCache->lru);
-
   return 0;
 }
 
 static int tdbPCacheCloseImpl(SPCache *pCache) {
-  // free free page
-  for (SPage *pPage = pCache->pFree; pPage;) {
-    SPage *pPageT = pPage->pFreeNext;
-    tdbPageDestroy(pPage, tdbDefaultFree, NULL);
-    pPage = pPageT;
-  }
+  for (int iShard = 0; iShard < pCache->nShard; iShard++) {
+    SPCacheShard *pShard = &pCache->aShard[iShard];
+
+    tdbDebug("pcache/close shard %d/%d, pages:%d/%d, hit:%" PRId64 ", miss:%" PRId64 ", borrow:%" PRId64, iShard,
+             pCache->nShard, pShard->nPage, pShard->nOwn, pShard->nHit, pShard->nMiss, pShard->nBorrow);
 
-  for (int32_t iBucket = 0; iBucket < pCache->nHash; iBucket++) {
-    for (SPage *pPage = pCache->pgHash[iBucket]; pPage;) {
-      SPage *pPageT = pPage->pHashNext;
-      tdbPageDestroy(pPage, tdbDefaultFree, NULL);
-      pPage = pPageT;
+    // free the pages of the shard, whether free, cached or still pinned
+    for (int32_t iOwn = 0; iOwn < pShard->nOwn; iOwn++) {
+      tdbPageDestroy(pShard->aOwn[iOwn], tdbDefaultFree, NULL);
     }
+
+    tdbOsFree(pShard->aOwn);
+    tdbOsFree(pShard->pgHash);
+    tdbPCacheDestroyLock(pShard);
   }
 
-  tdbOsFree(pCache->pgHash);
-  tdbPCacheDestroyLock(pCache);
+  tdbOsFree(pCache->aShard);
   return 0;
 }
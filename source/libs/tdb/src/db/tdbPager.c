@@ -13,6 +13,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "tchecksum.h"
 #include "tdbInt.h"
 
 #pragma pack(push, 1)
@@ -23,10 +24,28 @@ typedef struct {
   u32   nFreePages;
   u8    reserved[102];
 } SFileHdr;
+
+// header of a frame of the redo log, followed by the page unless it is the commit or post-commit record of a txn
+typedef struct {
+  SPgno   pgno;    // 0 for the commit record, TDB_WAL_POST_PGNO for the post-commit record
+  SPgno   dbSize;  // pages of the db file after the txn, in the commit record only
+  i64     txnId;
+  TSCKSUM cksum;  // of the header before it and the page
+} SWalFrameHdr;
 #pragma pack(pop)
 
 TDB_STATIC_ASSERT(sizeof(SFileHdr) == 128, "Size of file header is not correct");
 
+typedef struct {
+  SPgno pgno;
+  i64   offset;
+} SWalFrameLoc;
+
+#define TDB_PAGER_WAL(pPager)      ((pPager)->walCkptSize > 0)
+#define TDB_WAL_FRAME_SIZE(pPager) ((i64)sizeof(SWalFrameHdr) + (pPager)->pageSize)
+#define TDB_WAL_POST_PGNO          ((SPgno)-1)
+#define TDB_PAGER_MAX_IOV          64  // pages written by one pwritev
+
 struct hashset_st {
   size_t  nbits;
   size_t  mask;
@@ -143,6 +162,16 @@ static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage
                             u8 loadPage);
 static int tdbPagerWritePageToJournal(SPager *pPager, SPage *pPage);
 static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage);
+static int tdbPagerPWriteDirtyPages(SPager *pPager, bool skipLocal, SPgno *pMaxPgno);
+static i64 tdbPagerReadPage(SPager *pPager, SPgno pgno, u8 *pData);
+static int tdbPagerWalRecover(SPager *pPager, int8_t rollback);
+static int tdbPagerWalWriteFrames(SPager *pPager, TXN *pTxn, SPage **aPage, int nPage);
+static int tdbPagerWalWriteDirtyPages(SPager *pPager, TXN *pTxn, bool skipLocal, SPgno *pMaxPgno);
+static int tdbPagerWalCommit(SPager *pPager, TXN *pTxn);
+static int tdbPagerWalPostCommit(SPager *pPager);
+static int tdbPagerWalCheckpoint(SPager *pPager, SPgno dbSize);
+static int tdbPagerWalAbort(SPager *pPager);
+static int tdbPagerWalClose(SPager *pPager, bool removeFile);
 
 static FORCE_INLINE int32_t pageCmpFn(const SRBTreeNode *lhs, const SRBTreeNode *rhs) {
   SPage *pPageL = (SPage *)(((uint8_t *)lhs) - offsetof(SPage, node));
@@ -160,7 +189,7 @@ static FORCE_INLINE int32_t pageCmpFn(const SRBTreeNode *lhs, const SRBTreeNode
   }
 }
 
-int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
+int tdbPagerOpen(SPCache *pCache, const char *fileName, int8_t rollback, SPager **ppPager) {
   uint8_t *pPtr;
   SPager  *pPager;
   int      fsize;
@@ -172,7 +201,8 @@ int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
   fsize = strlen(fileName);
   zsize = sizeof(*pPager)  /* SPager */
           + fsize + 1      /* dbFileName */
-          + fsize + 8 + 1; /* jFileName */
+          + fsize + 8 + 1  /* jFileName */
+          + fsize + 4 + 1; /* wFileName */
   pPtr = (uint8_t *)tdbOsCalloc(1, zsize);
   if (pPtr == NULL) {
     return -1;
@@ -190,6 +220,12 @@ int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
   memcpy(pPager->jFileName, fileName, fsize);
   memcpy(pPager->jFileName + fsize, "-journal", 8);
   pPager->jFileName[fsize + 8] = '\0';
+  pPtr += fsize + 8 + 1;
+  // pPager->wFileName
+  pPager->wFileName = (char *)pPtr;
+  memcpy(pPager->wFileName, fileName, fsize);
+  memcpy(pPager->wFileName + fsize, "-wal", 4);
+  pPager->wFileName[fsize + 4] = '\0';
   // pPager->pCache
   pPager->pCache = pCache;
 
@@ -206,6 +242,14 @@ int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
 
   // pPager->jfd = -1;
   pPager->pageSize = tdbPCacheGetPageSize(pCache);
+  tdbMutexInit(&pPager->walMutex, NULL);
+
+  // apply the committed frames of a redo log left by a crash
+  ret = tdbPagerWalRecover(pPager, rollback);
+  if (ret < 0) {
+    return -1;
+  }
+
   // pPager->dbOrigSize
   ret = tdbGetFileSize(pPager->fd, pPager->pageSize, &(pPager->dbOrigSize));
   pPager->dbFileSize = pPager->dbOrigSize;
@@ -224,7 +268,14 @@ int tdbPagerClose(SPager *pPager) {
       tdbOsClose(pPager->jfd);
     }
     */
+    if (TDB_PAGER_WAL(pPager)) {
+      // keep the log for the recovery if the checkpoint fails, or if the last txn may still be rolled back
+      bool ckpted = !pPager->walPostPending && (tdbPagerWalCheckpoint(pPager, pPager->dbFileSize) == 0);
+      tdbPagerWalClose(pPager, ckpted);
+    }
     tdbOsClose(pPager->fd);
+    tdbMutexDestroy(&pPager->walMutex);
+    tdbOsFree(pPager->aFreePgno);
     tdbOsFree(pPager);
   }
   return 0;
@@ -262,8 +313,8 @@ int tdbPagerWrite(SPager *pPager, SPage *pPage) {
   tdbTrace("put page: %p %d to dirty tree: %p", pPage, TDB_PAGE_PGNO(pPage), &pPager->rbt);
   tRBTreePut(&pPager->rbt, (SRBTreeNode *)pPage);
 
-  // Write page to journal if neccessary
-  if (TDB_PAGE_PGNO(pPage) <= pPager->dbOrigSize &&
+  // Write page to journal if neccessary, the redo log keeps the committed pages untouched
+  if (!TDB_PAGER_WAL(pPager) && TDB_PAGE_PGNO(pPage) <= pPager->dbOrigSize &&
       (pPager->pActiveTxn->jPageSet == NULL ||
        !hashset_contains(pPager->pActiveTxn->jPageSet, (void *)((long)TDB_PAGE_PGNO(pPage))))) {
     ret = tdbPagerWritePageToJournal(pPager, pPage);
@@ -287,13 +338,15 @@ int tdbPagerBegin(SPager *pPager, TXN *pTxn) {
   }
   */
   // Open the journal
-  char jTxnFileName[TDB_FILENAME_LEN];
-  sprintf(jTxnFileName, "%s.%" PRId64, pPager->jFileName, pTxn->txnId);
-  pTxn->jfd = tdbOsOpen(jTxnFileName, TDB_O_CREAT | TDB_O_RDWR, 0755);
-  if (TDB_FD_INVALID(pTxn->jfd)) {
-    tdbError("failed to open file due to %s. jFileName:%s", strerror(errno), pPager->jFileName);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
+  if (!TDB_PAGER_WAL(pPager)) {
+    char jTxnFileName[TDB_FILENAME_LEN];
+    sprintf(jTxnFileName, "%s.%" PRId64, pPager->jFileName, pTxn->txnId);
+    pTxn->jfd = tdbOsOpen(jTxnFileName, TDB_O_CREAT | TDB_O_RDWR, 0755);
+    if (TDB_FD_INVALID(pTxn->jfd)) {
+      tdbError("failed to open file due to %s. jFileName:%s", strerror(errno), pPager->jFileName);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
   }
 
   pTxn->jPageSet = hashset_create();
@@ -311,28 +364,38 @@ int tdbPagerBegin(SPager *pPager, TXN *pTxn) {
 
 int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
   SPage *pPage;
+  SPgno  maxPgno = 0;
   int    ret;
 
-  // sync the journal file
-  ret = tdbOsFSync(pTxn->jfd);
-  if (ret < 0) {
-    tdbError("failed to fsync: %s. jFileName:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
-  }
-
-  // loop to write the dirty pages to file
-  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
-  SRBTreeNode *pNode = NULL;
-  while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
-    pPage = (SPage *)pNode;
+  if (TDB_PAGER_WAL(pPager)) {
+    ret = tdbPagerWalCommit(pPager, pTxn);
+    if (ret < 0) {
+      return -1;
+    }
+  } else {
+    // sync the journal file
+    ret = tdbOsFSync(pTxn->jfd);
+    if (ret < 0) {
+      tdbError("failed to fsync: %s. jFileName:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
 
-    ASSERT(pPage->nOverflow == 0);
-    ret = tdbPagerPWritePageToDB(pPager, pPage);
+    // write the dirty pages to file
+    ret = tdbPagerPWriteDirtyPages(pPager, false, &maxPgno);
     if (ret < 0) {
-      tdbError("failed to write page to db since %s", tstrerror(terrno));
       return -1;
     }
+
+    // truncate the tail released by tdbPagerVacuum
+    if (pPager->dbFileSize < pPager->dbOrigSize) {
+      if (tdbOsFTruncate(pPager->fd, (i64)pPager->pageSize * pPager->dbFileSize) < 0) {
+        tdbError("failed to truncate file due to %s. file:%s, pages:%d", strerror(errno), pPager->dbFileName,
+                 pPager->dbFileSize);
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        return -1;
+      }
+    }
   }
 
   tdbDebug("pager/commit: %p, %d/%d, txnId:%" PRId64, pPager, pPager->dbOrigSize, pPager->dbFileSize, pTxn->txnId);
@@ -340,7 +403,8 @@ int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
   pPager->dbOrigSize = pPager->dbFileSize;
 
   // release the page
-  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeNode *pNode = NULL;
   while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
     pPage = (SPage *)pNode;
 
@@ -356,6 +420,11 @@ int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
   tdbTrace("pager/commit reset dirty tree: %p", &pPager->rbt);
   tRBTreeCreate(&pPager->rbt, pageCmpFn);
 
+  // the log is synced, and copied into the db file at the post-commit once it is large enough
+  if (TDB_PAGER_WAL(pPager)) {
+    return 0;
+  }
+
   // sync the db file
   if (tdbOsFSync(pPager->fd) < 0) {
     tdbError("failed to fsync fd due to %s. file:%s", strerror(errno), pPager->dbFileName);
@@ -368,6 +437,22 @@ int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
 
 int tdbPagerPostCommit(SPager *pPager, TXN *pTxn) {
   char jTxnFileName[TDB_FILENAME_LEN];
+
+  if (TDB_PAGER_WAL(pPager)) {
+    if (tdbPagerWalPostCommit(pPager) < 0) {
+      return -1;
+    }
+
+    tdbDebug("pager/post-commit:%p, %d/%d, wal:%" PRId64, pPager, pPager->dbOrigSize, pPager->dbFileSize,
+             pPager->walSize);
+
+    // the txn can not be rolled back any more, so its frames may go to the db file
+    if (pPager->walSize >= pPager->walCkptSize && pPager->walOffset == pPager->walSize) {
+      return tdbPagerWalCheckpoint(pPager, pPager->dbFileSize);
+    }
+    return 0;
+  }
+
   sprintf(jTxnFileName, "%s.%" PRId64, pPager->jFileName, pTxn->txnId);
 
   // remove the journal file
@@ -395,28 +480,24 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   SPgno  maxPgno = pPager->dbOrigSize;
   int    ret;
 
-  // sync the journal file
-  ret = tdbOsFSync(pTxn->jfd);
-  if (ret < 0) {
-    tdbError("failed to fsync jfd: %s. jfile:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
-  }
-
-  // loop to write the dirty pages to file
-  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
-  SRBTreeNode *pNode = NULL;
-  while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
-    pPage = (SPage *)pNode;
-    if (pPage->isLocal) continue;
-
-    SPgno pgno = TDB_PAGE_PGNO(pPage);
-    if (pgno > maxPgno) {
-      maxPgno = pgno;
+  if (TDB_PAGER_WAL(pPager)) {
+    // the pages are written as frames of the txn, and committed by tdbPagerCommit
+    ret = tdbPagerWalWriteDirtyPages(pPager, pTxn, true, &maxPgno);
+    if (ret < 0) {
+      return -1;
     }
-    ret = tdbPagerPWritePageToDB(pPager, pPage);
+  } else {
+    // sync the journal file
+    ret = tdbOsFSync(pTxn->jfd);
+    if (ret < 0) {
+      tdbError("failed to fsync jfd: %s. jfile:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+
+    // write the dirty pages to file
+    ret = tdbPagerPWriteDirtyPages(pPager, true, &maxPgno);
     if (ret < 0) {
-      tdbError("failed to write page to db since %s", tstrerror(terrno));
       return -1;
     }
   }
@@ -426,7 +507,8 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   //  pPager->dbOrigSize = pPager->dbFileSize;
 
   // release the page
-  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeNode *pNode = NULL;
   while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
     pPage = (SPage *)pNode;
     if (pPage->isLocal) continue;
@@ -450,12 +532,10 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   return 0;
 }
 
-// recovery dirty pages
-int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
-  SPage *pPage;
-  int    pgIdx;
-  SPgno  journalSize = 0;
-  int    ret;
+// restore the pages of the db file from the journal of the txn
+static int tdbPagerAbortJournal(SPager *pPager, TXN *pTxn) {
+  SPgno journalSize = 0;
+  int   ret;
 
   // sync the journal file
   ret = tdbOsFSync(pTxn->jfd);
@@ -532,6 +612,23 @@ int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
 
   tdbOsFree(pageBuf);
 
+  return 0;
+}
+
+// recovery dirty pages
+int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
+  SPage *pPage;
+  int    ret;
+
+  if (TDB_PAGER_WAL(pPager)) {
+    ret = tdbPagerWalAbort(pPager);
+  } else {
+    ret = tdbPagerAbortJournal(pPager, pTxn);
+  }
+  if (ret < 0) {
+    return -1;
+  }
+
   // 3, release the dirty pages
   SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
   SRBTreeNode *pNode = NULL;
@@ -552,6 +649,10 @@ int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
   tdbTrace("pager/abort: reset dirty tree: %p", &pPager->rbt);
   tRBTreeCreate(&pPager->rbt, pageCmpFn);
 
+  if (TDB_PAGER_WAL(pPager)) {
+    return 0;
+  }
+
   // 4, remove the journal file
   if (tdbOsClose(pTxn->jfd) < 0) {
     tdbError("failed to close jfd: %s. file:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
@@ -593,7 +694,11 @@ int tdbPagerFlushPage(SPager *pPager, TXN *pTxn) {
     if (pgno > maxPgno) {
       maxPgno = pgno;
     }
-    ret = tdbPagerPWritePageToDB(pPager, pPage);
+    if (TDB_PAGER_WAL(pPager)) {
+      ret = tdbPagerWalWriteFrames(pPager, pTxn, &pPage, 1);
+    } else {
+      ret = tdbPagerPWritePageToDB(pPager, pPage);
+    }
     if (ret < 0) {
       tdbError("failed to write page to db since %s", tstrerror(terrno));
       return -1;
@@ -693,11 +798,186 @@ void tdbPagerReturnPage(SPager *pPager, SPage *pPage, TXN *pTxn) {
   //        TDB_PAGE_PGNO(pPage), pPage);
 }
 
+// ---------------------------- Free pages
+#define TDB_FREE_CHUNK_SIZE(pPager) ((pPager)->pageSize / 8 / (int)sizeof(SPgno))
+
+static int tdbPagerPushFreePgno(SPager *pPager, SPgno pgno) {
+  if (pPager->nFreePgno >= pPager->capFreePgno) {
+    int    cap = pPager->capFreePgno ? pPager->capFreePgno * 2 : 64;
+    SPgno *aFreePgno = tdbOsRealloc(pPager->aFreePgno, sizeof(SPgno) * cap);
+    if (aFreePgno == NULL) {
+      return -1;
+    }
+    pPager->aFreePgno = aFreePgno;
+    pPager->capFreePgno = cap;
+  }
+
+  // binary search the insert position, in descending order
+  int lidx = 0, ridx = pPager->nFreePgno;
+  while (lidx < ridx) {
+    int midx = (lidx + ridx) >> 1;
+    if (pPager->aFreePgno[midx] > pgno) {
+      lidx = midx + 1;
+    } else {
+      ridx = midx;
+    }
+  }
+  ASSERT(lidx == pPager->nFreePgno || pPager->aFreePgno[lidx] != pgno);
+
+  memmove(pPager->aFreePgno + lidx + 1, pPager->aFreePgno + lidx, sizeof(SPgno) * (pPager->nFreePgno - lidx));
+  pPager->aFreePgno[lidx] = pgno;
+  pPager->nFreePgno++;
+  pPager->freeVer++;
+  return 0;
+}
+
 static int tdbPagerAllocFreePage(SPager *pPager, SPgno *ppgno) {
-  // TODO: Allocate a page from the free list
+  if (pPager->nFreePgno == 0 || pPager->noFreeAlloc) {
+    return 0;
+  }
+
+  *ppgno = pPager->aFreePgno[--pPager->nFreePgno];
+  pPager->freeVer++;
+  tdbTrace("pager/alloc free page: %p, pgno:%d, nFree:%d", pPager, *ppgno, pPager->nFreePgno);
   return 0;
 }
 
+// Put a page no longer linked in the B-tree to the free pages. The page is dropped from the dirty tree and the cache,
+// so a later allocation of the pgno starts with an empty page. Its content before the transaction is in the journal.
+void tdbPagerFreePage(SPager *pPager, SPage *pPage, TXN *pTxn) {
+  SPgno pgno = TDB_PAGE_PGNO(pPage);
+
+  tdbPCacheMarkFree(pPager->pCache, pPage);
+  if (pPage->isDirty) {
+    pPage->isDirty = 0;
+    tRBTreeDrop(&pPager->rbt, (SRBTreeNode *)pPage);
+    tdbPCacheRelease(pPager->pCache, pPage, pTxn);
+  }
+  tdbPCacheRelease(pPager->pCache, pPage, pTxn);
+
+  if (tdbPagerPushFreePgno(pPager, pgno) < 0) {
+    tdbWarn("pager/free page: %p, pgno:%d is leaked since out of memory", pPager, pgno);
+    return;
+  }
+  tdbTrace("pager/free page: %p, pgno:%d, nFree:%d", pPager, pgno, pPager->nFreePgno);
+}
+
+// Online vacuum: the free pages at the tail of the file are given back, the file is truncated at commit.
+void tdbPagerVacuum(SPager *pPager) {
+  int nTail = 0;
+  while (nTail < pPager->nFreePgno && pPager->aFreePgno[nTail] == pPager->dbFileSize - nTail) {
+    nTail++;
+  }
+  if (nTail == 0) return;
+
+  pPager->dbFileSize -= nTail;
+  pPager->nFreePgno -= nTail;
+  memmove(pPager->aFreePgno, pPager->aFreePgno + nTail, sizeof(SPgno) * pPager->nFreePgno);
+  pPager->freeVer++;
+
+  tdbDebug("pager/vacuum: %p, %d tail pages released, %d/%d, nFree:%d", pPager, nTail, pPager->dbOrigSize,
+           pPager->dbFileSize, pPager->nFreePgno);
+}
+
+int tdbPagerLoadFreeList(SPager *pPager, TTB *pFreeDb) {
+  TBC  *pTbc = NULL;
+  void *pKey = NULL;
+  void *pVal = NULL;
+  int   kLen, vLen;
+  int   ret;
+
+  pPager->nFreePgno = 0;
+  pPager->nFreeChunk = 0;
+
+  ret = tdbTbcOpen(pFreeDb, &pTbc, NULL);
+  if (ret < 0) {
+    return -1;
+  }
+
+  tdbTbcMoveToFirst(pTbc);
+  while (tdbTbcNext(pTbc, &pKey, &kLen, &pVal, &vLen) == 0) {
+    pPager->nFreeChunk++;
+    for (int i = 0; i < vLen / (int)sizeof(SPgno); i++) {
+      SPgno pgno = ((SPgno *)pVal)[i];
+      // pages beyond the file are truncated ones, restored to the free db by a journal
+      if (pgno > pPager->dbFileSize) continue;
+
+      ret = tdbPagerPushFreePgno(pPager, pgno);
+      if (ret < 0) {
+        break;
+      }
+    }
+    if (ret < 0) break;
+  }
+
+  tdbFree(pKey);
+  tdbFree(pVal);
+  tdbTbcClose(pTbc);
+
+  // the whole list is saved again if any page is dropped above
+  pPager->freeSavedVer = pPager->freeVer;
+  if (pPager->nFreeChunk != (pPager->nFreePgno + TDB_FREE_CHUNK_SIZE(pPager) - 1) / TDB_FREE_CHUNK_SIZE(pPager)) {
+    pPager->freeVer++;
+  }
+
+  tdbDebug("pager/load free list: %p, nFree:%d, nChunk:%d", pPager, pPager->nFreePgno, pPager->nFreeChunk);
+  return ret;
+}
+
+// Write the free pages into the free db in chunks. Saving may split or merge pages of the free db itself, so it loops
+// until no page is freed meanwhile, with the allocation from the free pages disabled.
+int tdbPagerSaveFreeList(SPager *pPager, TTB *pFreeDb, TXN *pTxn) {
+  int    nPerChunk = TDB_FREE_CHUNK_SIZE(pPager);
+  SPgno *aPgno = NULL;
+  int    ret = 0;
+
+  if (pPager->freeVer == pPager->freeSavedVer) {
+    return 0;
+  }
+
+  aPgno = tdbOsMalloc(sizeof(SPgno) * nPerChunk);
+  if (aPgno == NULL) {
+    return -1;
+  }
+
+  pPager->noFreeAlloc = 1;
+  for (int nLoops = 0; pPager->freeVer != pPager->freeSavedVer && nLoops < 8; nLoops++) {
+    int64_t freeVer = pPager->freeVer;
+    int     nChunk = (pPager->nFreePgno + nPerChunk - 1) / nPerChunk;
+
+    for (int iChunk = 0; iChunk < nChunk; iChunk++) {
+      int n = TMIN(nPerChunk, pPager->nFreePgno - iChunk * nPerChunk);
+      memcpy(aPgno, pPager->aFreePgno + iChunk * nPerChunk, sizeof(SPgno) * n);
+
+      ret = tdbTbUpsert(pFreeDb, &iChunk, sizeof(iChunk), aPgno, sizeof(SPgno) * n, pTxn);
+      if (ret < 0) {
+        goto _exit;
+      }
+    }
+
+    for (int iChunk = nChunk; iChunk < pPager->nFreeChunk; iChunk++) {
+      ret = tdbTbDelete(pFreeDb, &iChunk, sizeof(iChunk), pTxn);
+      if (ret < 0) {
+        goto _exit;
+      }
+    }
+
+    pPager->nFreeChunk = nChunk;
+    pPager->freeSavedVer = freeVer;
+  }
+
+  if (pPager->freeVer != pPager->freeSavedVer) {
+    // the pages freed by the last round are leaked on crash, they are saved by the next commit
+    tdbWarn("pager/save free list: %p, free pages still changing, nFree:%d", pPager, pPager->nFreePgno);
+  }
+
+_exit:
+  pPager->noFreeAlloc = 0;
+  tdbOsFree(aPgno);
+  return ret;
+}
+
+
 static int tdbPagerAllocNewPage(SPager *pPager, SPgno *ppgno) {
   *ppgno = ++pPager->dbFileSize;
   return 0;
@@ -749,7 +1029,7 @@ static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage
     if (loadPage && pgno <= pPager->dbOrigSize) {
       init = 1;
 
-      nRead = tdbOsPRead(pPager->fd, pPage->pData, pPage->pageSize, ((i64)pPage->pageSize) * (pgno - 1));
+      nRead = tdbPagerReadPage(pPager, pgno, pPage->pData);
       tdbTrace("tdb/pager:%p, pgno:%d, nRead:%" PRId64, pPager, pgno, nRead);
       if (nRead < pPage->pageSize) {
         ASSERT(0);
@@ -791,23 +1071,12 @@ static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage
 
 // ---------------------------- Journal manipulation
 static int tdbPagerWritePageToJournal(SPager *pPager, SPage *pPage) {
-  int   ret;
-  SPgno pgno;
-
-  pgno = TDB_PAGE_PGNO(pPage);
+  SPgno       pgno = TDB_PAGE_PGNO(pPage);
+  TdFileIoVec iov[2] = {{.buf = &pgno, .len = sizeof(pgno)}, {.buf = pPage->pData, .len = pPage->pageSize}};
 
-  ret = tdbOsWrite(pPager->pActiveTxn->jfd, &pgno, sizeof(pgno));
-  if (ret < 0) {
-    tdbError("failed to write pgno due to %s. file:%s, pgno:%u, txnId:%" PRId64, strerror(errno), pPager->jFileName,
-             pgno, pPager->pActiveTxn->txnId);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
-  }
-
-  ret = tdbOsWrite(pPager->pActiveTxn->jfd, pPage->pData, pPage->pageSize);
-  if (ret < 0) {
-    tdbError("failed to write page data due to %s. file:%s, pageSize:%d, txnId:%" PRId64, strerror(errno),
-             pPager->jFileName, pPage->pageSize, pPager->pActiveTxn->txnId);
+  if (tdbOsWritev(pPager->pActiveTxn->jfd, iov, 2) < 0) {
+    tdbError("failed to write page due to %s. file:%s, pgno:%u, pageSize:%d, txnId:%" PRId64, strerror(errno),
+             pPager->jFileName, pgno, pPage->pageSize, pPager->pActiveTxn->txnId);
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
@@ -854,6 +1123,534 @@ static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage) {
   return 0;
 }
 
+static int tdbPagerPWritePagesToDB(SPager *pPager, SPgno pgno, const TdFileIoVec *iov, int nIov) {
+  i64 offset = (i64)pPager->pageSize * (pgno - 1);
+
+  if (tdbOsPWritev(pPager->fd, iov, nIov, offset) < 0) {
+    tdbError("failed to pwrite pages due to %s. file:%s, pgno:%u, pages:%d", strerror(errno), pPager->dbFileName, pgno,
+             nIov);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  return 0;
+}
+
+// write the dirty pages in pgno order, each run of consecutive pages with one pwritev
+static int tdbPagerPWriteDirtyPages(SPager *pPager, bool skipLocal, SPgno *pMaxPgno) {
+  TdFileIoVec  iov[TDB_PAGER_MAX_IOV];
+  int          nIov = 0;
+  SPgno        pgno = 0;
+  SPgno        startPgno = 0;
+  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeNode *pNode = NULL;
+
+  for (;;) {
+    SPage *pPage = NULL;
+    if ((pNode = tRBTreeIterNext(&iter)) != NULL) {
+      pPage = (SPage *)pNode;
+      if (skipLocal && pPage->isLocal) continue;
+      pgno = TDB_PAGE_PGNO(pPage);
+    }
+
+    if (nIov > 0 && (pPage == NULL || nIov == TDB_PAGER_MAX_IOV || pgno != startPgno + nIov)) {
+      if (tdbPagerPWritePagesToDB(pPager, startPgno, iov, nIov) < 0) {
+        return -1;
+      }
+      nIov = 0;
+    }
+
+    if (pPage == NULL) break;
+
+    if (nIov == 0) startPgno = pgno;
+    iov[nIov].buf = pPage->pData;
+    iov[nIov].len = pPage->pageSize;
+    nIov++;
+
+    if (pgno > *pMaxPgno) {
+      *pMaxPgno = pgno;
+    }
+  }
+
+  return 0;
+}
+
+static i64 tdbPagerReadPage(SPager *pPager, SPgno pgno, u8 *pData) {
+  if (TDB_PAGER_WAL(pPager)) {
+    i64 nRead = 0;
+    i64 *pOffset = NULL;
+
+    tdbMutexLock(&pPager->walMutex);
+    pOffset = taosHashGet(pPager->pWalTxnIdx, &pgno, sizeof(pgno));
+    if (pOffset == NULL) {
+      pOffset = taosHashGet(pPager->pWalIdx, &pgno, sizeof(pgno));
+    }
+    if (pOffset != NULL) {
+      nRead = tdbOsPRead(pPager->wfd, pData, pPager->pageSize, *pOffset + sizeof(SWalFrameHdr));
+    }
+    tdbMutexUnlock(&pPager->walMutex);
+
+    if (pOffset != NULL) {
+      return nRead;
+    }
+  }
+
+  return tdbOsPRead(pPager->fd, pData, pPager->pageSize, ((i64)pPager->pageSize) * (pgno - 1));
+}
+
+// ---------------------------- Redo log
+/*
+ * With a redo log, the db file only changes at checkpoints. A commit appends the dirty pages as frames to the log,
+ * then a commit record, and syncs the log once. Pages are read from their last frame in the log if any. When the log
+ * grows over walCkptSize, the last frame of each page is copied into the db file and the log is emptied.
+ */
+static int tdbPagerWalOpen(SPager *pPager, bool create) {
+  int32_t flags = create ? (TDB_O_CREAT | TDB_O_RDWR | TDB_O_TRUNC) : TDB_O_RDWR;
+
+  pPager->wfd = tdbOsOpen(pPager->wFileName, flags, 0755);
+  if (TDB_FD_INVALID(pPager->wfd)) {
+    tdbError("failed to open file due to %s. wFileName:%s", strerror(errno), pPager->wFileName);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  pPager->pWalIdx = taosHashInit(1024, taosIntHash_32, true, HASH_NO_LOCK);
+  pPager->pWalTxnIdx = taosHashInit(1024, taosIntHash_32, true, HASH_NO_LOCK);
+  if (pPager->pWalIdx == NULL || pPager->pWalTxnIdx == NULL) {
+    tdbPagerWalClose(pPager, false);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pPager->walSize = 0;
+  pPager->walOffset = 0;
+  pPager->walPostPending = 0;
+  return 0;
+}
+
+static int tdbPagerWalClose(SPager *pPager, bool removeFile) {
+  if (!TDB_FD_INVALID(pPager->wfd)) {
+    tdbOsClose(pPager->wfd);
+  }
+  taosHashCleanup(pPager->pWalIdx);
+  taosHashCleanup(pPager->pWalTxnIdx);
+  pPager->pWalIdx = NULL;
+  pPager->pWalTxnIdx = NULL;
+  pPager->walSize = 0;
+  pPager->walOffset = 0;
+
+  if (removeFile && tdbOsRemove(pPager->wFileName) < 0 && errno != ENOENT) {
+    tdbError("failed to remove file due to %s. file:%s", strerror(errno), pPager->wFileName);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  return 0;
+}
+
+// make the frames of the active txn the last committed ones of their pages
+static void tdbPagerWalMergeTxnIdx(SPager *pPager) {
+  void *p = NULL;
+
+  tdbMutexLock(&pPager->walMutex);
+  while ((p = taosHashIterate(pPager->pWalTxnIdx, p)) != NULL) {
+    size_t keyLen = 0;
+    void  *pKey = taosHashGetKey(p, &keyLen);
+    taosHashPut(pPager->pWalIdx, pKey, keyLen, p, sizeof(i64));
+  }
+  taosHashClear(pPager->pWalTxnIdx);
+  pPager->walSize = pPager->walOffset;
+  tdbMutexUnlock(&pPager->walMutex);
+}
+
+static TSCKSUM tdbPagerWalFrameCksum(const SWalFrameHdr *pHdr, const u8 *pData, int pageSize) {
+  TSCKSUM cksum = taosCalcChecksum(0, (const uint8_t *)pHdr, offsetof(SWalFrameHdr, cksum));
+  if (pData) {
+    cksum = taosCalcChecksum(cksum, pData, pageSize);
+  }
+  return cksum;
+}
+
+#define TDB_WAL_MAX_FRAMES (TDB_PAGER_MAX_IOV / 2)
+
+// append the pages as frames of the active txn
+static int tdbPagerWalWriteFrames(SPager *pPager, TXN *pTxn, SPage **aPage, int nPage) {
+  SWalFrameHdr aHdr[TDB_WAL_MAX_FRAMES];
+  TdFileIoVec  iov[TDB_WAL_MAX_FRAMES * 2];
+
+  ASSERT(nPage <= TDB_WAL_MAX_FRAMES);
+  for (int i = 0; i < nPage; i++) {
+    aHdr[i].pgno = TDB_PAGE_PGNO(aPage[i]);
+    aHdr[i].dbSize = 0;
+    aHdr[i].txnId = pTxn->txnId;
+    aHdr[i].cksum = tdbPagerWalFrameCksum(&aHdr[i], aPage[i]->pData, pPager->pageSize);
+
+    iov[i * 2].buf = &aHdr[i];
+    iov[i * 2].len = sizeof(SWalFrameHdr);
+    iov[i * 2 + 1].buf = aPage[i]->pData;
+    iov[i * 2 + 1].len = pPager->pageSize;
+  }
+
+  if (tdbOsPWritev(pPager->wfd, iov, nPage * 2, pPager->walOffset) < 0) {
+    tdbError("failed to write frames due to %s. file:%s, frames:%d, txnId:%" PRId64, strerror(errno),
+             pPager->wFileName, nPage, pTxn->txnId);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  tdbMutexLock(&pPager->walMutex);
+  for (int i = 0; i < nPage; i++) {
+    taosHashPut(pPager->pWalTxnIdx, &aHdr[i].pgno, sizeof(SPgno), &pPager->walOffset, sizeof(i64));
+    pPager->walOffset += TDB_WAL_FRAME_SIZE(pPager);
+  }
+  tdbMutexUnlock(&pPager->walMutex);
+
+  return 0;
+}
+
+static int tdbPagerWalWriteDirtyPages(SPager *pPager, TXN *pTxn, bool skipLocal, SPgno *pMaxPgno) {
+  SPage       *aPage[TDB_WAL_MAX_FRAMES];
+  int          nPage = 0;
+  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeNode *pNode = NULL;
+
+  while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
+    SPage *pPage = (SPage *)pNode;
+    if (skipLocal && pPage->isLocal) continue;
+
+    SPgno pgno = TDB_PAGE_PGNO(pPage);
+    if (pgno > *pMaxPgno) {
+      *pMaxPgno = pgno;
+    }
+
+    aPage[nPage++] = pPage;
+    if (nPage == TDB_WAL_MAX_FRAMES) {
+      if (tdbPagerWalWriteFrames(pPager, pTxn, aPage, nPage) < 0) {
+        return -1;
+      }
+      nPage = 0;
+    }
+  }
+
+  if (nPage > 0 && tdbPagerWalWriteFrames(pPager, pTxn, aPage, nPage) < 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+static int tdbPagerWalCommit(SPager *pPager, TXN *pTxn) {
+  SPgno        maxPgno = 0;
+  SWalFrameHdr hdr = {0};
+
+  if (tdbPagerWalWriteDirtyPages(pPager, pTxn, false, &maxPgno) < 0) {
+    return -1;
+  }
+
+  // nothing changed by the txn
+  if (pPager->walOffset == pPager->walSize) {
+    return 0;
+  }
+
+  hdr.pgno = 0;
+  hdr.dbSize = pPager->dbFileSize;
+  hdr.txnId = pTxn->txnId;
+  hdr.cksum = tdbPagerWalFrameCksum(&hdr, NULL, 0);
+  if (tdbOsPWrite(pPager->wfd, &hdr, sizeof(hdr), pPager->walOffset) < 0) {
+    tdbError("failed to write commit record due to %s. file:%s, txnId:%" PRId64, strerror(errno), pPager->wFileName,
+             pTxn->txnId);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  pPager->walOffset += sizeof(hdr);
+
+  if (tdbOsFSync(pPager->wfd) < 0) {
+    tdbError("failed to fsync due to %s. file:%s, txnId:%" PRId64, strerror(errno), pPager->wFileName, pTxn->txnId);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  tdbPagerWalMergeTxnIdx(pPager);
+  pPager->walCommitTxnId = pTxn->txnId;
+  pPager->walPostPending = 1;
+
+  tdbDebug("pager/wal-commit: %p, dbSize:%d, wal:%" PRId64 ", txnId:%" PRId64, pPager, pPager->dbFileSize,
+           pPager->walSize, pTxn->txnId);
+  return 0;
+}
+
+/*
+ * The post-commit record tells the recovery that the last committed txn is final. Without it, a recovery asked to
+ * roll back discards that txn, as the rollback journal of a txn is kept until its post-commit. The record is not
+ * synced, like the removal of a journal.
+ */
+static int tdbPagerWalPostCommit(SPager *pPager) {
+  SWalFrameHdr hdr = {0};
+
+  // nothing was committed since the last post-commit
+  if (!pPager->walPostPending) {
+    return 0;
+  }
+
+  hdr.pgno = TDB_WAL_POST_PGNO;
+  hdr.txnId = pPager->walCommitTxnId;
+  hdr.cksum = tdbPagerWalFrameCksum(&hdr, NULL, 0);
+  if (tdbOsPWrite(pPager->wfd, &hdr, sizeof(hdr), pPager->walOffset) < 0) {
+    tdbError("failed to write post-commit record due to %s. file:%s, txnId:%" PRId64, strerror(errno),
+             pPager->wFileName, hdr.txnId);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  // the record goes among the frames of an active txn if it spilled pages, an abort writes it again
+  tdbMutexLock(&pPager->walMutex);
+  if (pPager->walOffset == pPager->walSize) {
+    pPager->walSize += sizeof(hdr);
+  }
+  pPager->walOffset += sizeof(hdr);
+  tdbMutexUnlock(&pPager->walMutex);
+
+  pPager->walPostPending = 0;
+  return 0;
+}
+
+static int tdbWalFrameLocCmpr(const void *p1, const void *p2) {
+  SPgno pgno1 = ((const SWalFrameLoc *)p1)->pgno;
+  SPgno pgno2 = ((const SWalFrameLoc *)p2)->pgno;
+  return (pgno1 < pgno2) ? -1 : ((pgno1 > pgno2) ? 1 : 0);
+}
+
+// copy the last committed frame of each page into the db file, then empty the log
+static int tdbPagerWalCheckpoint(SPager *pPager, SPgno dbSize) {
+  int           code = 0;
+  int           nLoc = 0;
+  SWalFrameLoc *aLoc = NULL;
+  u8           *pBuf = NULL;
+  void         *p = NULL;
+
+  ASSERT(pPager->walOffset == pPager->walSize);
+
+  nLoc = taosHashGetSize(pPager->pWalIdx);
+  aLoc = tdbOsMalloc(sizeof(SWalFrameLoc) * (nLoc + 1));
+  pBuf = tdbOsMalloc((i64)pPager->pageSize * TDB_PAGER_MAX_IOV);
+  if (aLoc == NULL || pBuf == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _exit;
+  }
+
+  nLoc = 0;
+  while ((p = taosHashIterate(pPager->pWalIdx, p)) != NULL) {
+    SPgno pgno = *(SPgno *)taosHashGetKey(p, NULL);
+    // pages truncated from the tail of the db file
+    if (dbSize > 0 && pgno > dbSize) continue;
+
+    aLoc[nLoc].pgno = pgno;
+    aLoc[nLoc].offset = *(i64 *)p;
+    nLoc++;
+  }
+  taosSort(aLoc, nLoc, sizeof(SWalFrameLoc), tdbWalFrameLocCmpr);
+
+  // runs of consecutive pages are gathered into pBuf and written at once
+  for (int i = 0, nRun = 0; i <= nLoc; i++) {
+    if (nRun > 0 && (i == nLoc || nRun == TDB_PAGER_MAX_IOV || aLoc[i].pgno != aLoc[i - nRun].pgno + nRun)) {
+      i64 offset = (i64)pPager->pageSize * (aLoc[i - nRun].pgno - 1);
+      if (tdbOsPWrite(pPager->fd, pBuf, (i64)pPager->pageSize * nRun, offset) < 0) {
+        code = TAOS_SYSTEM_ERROR(errno);
+        goto _exit;
+      }
+      nRun = 0;
+    }
+
+    if (i == nLoc) break;
+
+    i64 nRead = tdbOsPRead(pPager->wfd, pBuf + (i64)pPager->pageSize * nRun, pPager->pageSize,
+                           aLoc[i].offset + sizeof(SWalFrameHdr));
+    if (nRead < pPager->pageSize) {
+      code = (nRead < 0) ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_FILE_CORRUPTED;
+      goto _exit;
+    }
+    nRun++;
+  }
+
+  if (dbSize > 0 && tdbOsFTruncate(pPager->fd, (i64)pPager->pageSize * dbSize) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _exit;
+  }
+
+  if (tdbOsFSync(pPager->fd) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _exit;
+  }
+
+  // the db file has all the committed pages now
+  tdbMutexLock(&pPager->walMutex);
+  taosHashClear(pPager->pWalIdx);
+  pPager->walSize = 0;
+  pPager->walOffset = 0;
+  tdbMutexUnlock(&pPager->walMutex);
+
+  if (tdbOsFTruncate(pPager->wfd, 0) < 0 || tdbOsFSync(pPager->wfd) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _exit;
+  }
+
+  tdbDebug("pager/checkpoint: %p, pages:%d, dbSize:%d", pPager, nLoc, dbSize);
+
+_exit:
+  if (code) {
+    tdbError("failed to checkpoint since %s. file:%s, wal:%" PRId64, tstrerror(code), pPager->dbFileName,
+             pPager->walSize);
+    terrno = code;
+  }
+  tdbOsFree(aLoc);
+  tdbOsFree(pBuf);
+  return code ? -1 : 0;
+}
+
+// drop the frames of the active txn, the pages spilled to them are reloaded from the committed ones
+static int tdbPagerWalAbort(SPager *pPager) {
+  void *p = NULL;
+  bool  dropped = (pPager->walOffset > pPager->walSize);
+
+  while ((p = taosHashIterate(pPager->pWalTxnIdx, p)) != NULL) {
+    SPgno pgno = *(SPgno *)taosHashGetKey(p, NULL);
+    tdbPCacheInvalidatePage(pPager->pCache, pPager, pgno);
+  }
+
+  tdbMutexLock(&pPager->walMutex);
+  taosHashClear(pPager->pWalTxnIdx);
+  pPager->walOffset = pPager->walSize;
+  tdbMutexUnlock(&pPager->walMutex);
+
+  if (tdbOsFTruncate(pPager->wfd, pPager->walSize) < 0) {
+    tdbError("failed to truncate file due to %s. file:%s, size:%" PRId64, strerror(errno), pPager->wFileName,
+             pPager->walSize);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  // the post-commit record of the last committed txn may be among the dropped frames
+  if (dropped && !pPager->walPostPending && pPager->walSize > 0) {
+    pPager->walPostPending = 1;
+    if (tdbPagerWalPostCommit(pPager) < 0) {
+      return -1;
+    }
+  }
+
+  tdbDebug("pager/wal-abort: %p, %d/%d, wal:%" PRId64, pPager, pPager->dbOrigSize, pPager->dbFileSize,
+           pPager->walSize);
+  return 0;
+}
+
+// index the committed frames of the log up to limit, and find the start of the last committed txn if it is not
+// post-committed
+static void tdbPagerWalScan(SPager *pPager, u8 *pageBuf, i64 limit, SPgno *pDbSize, i64 *pPendOffset) {
+  SWalFrameHdr hdr;
+  i64          offset = 0;
+  i64          txnOffset = 0;  // start of the frames of the txn being read
+  i64          pendTxnId = 0;
+
+  *pPendOffset = -1;
+  while (offset + (i64)sizeof(hdr) <= limit) {
+    if (tdbOsPRead(pPager->wfd, &hdr, sizeof(hdr), offset) < (i64)sizeof(hdr)) break;
+
+    if (hdr.pgno == 0 || hdr.pgno == TDB_WAL_POST_PGNO) {
+      if (hdr.cksum != tdbPagerWalFrameCksum(&hdr, NULL, 0)) break;
+      offset += sizeof(hdr);
+
+      if (hdr.pgno == TDB_WAL_POST_PGNO) {
+        if (*pPendOffset >= 0 && hdr.txnId == pendTxnId) *pPendOffset = -1;
+        continue;
+      }
+
+      pPager->walOffset = offset;
+      tdbPagerWalMergeTxnIdx(pPager);
+      *pDbSize = hdr.dbSize;
+      *pPendOffset = txnOffset;
+      pendTxnId = hdr.txnId;
+      txnOffset = offset;
+      continue;
+    }
+
+    if (offset + TDB_WAL_FRAME_SIZE(pPager) > limit) break;
+    if (tdbOsPRead(pPager->wfd, pageBuf, pPager->pageSize, offset + sizeof(hdr)) < pPager->pageSize) break;
+    if (hdr.cksum != tdbPagerWalFrameCksum(&hdr, pageBuf, pPager->pageSize)) break;
+
+    taosHashPut(pPager->pWalTxnIdx, &hdr.pgno, sizeof(SPgno), &offset, sizeof(i64));
+    offset += TDB_WAL_FRAME_SIZE(pPager);
+  }
+
+  taosHashClear(pPager->pWalTxnIdx);
+  pPager->walOffset = pPager->walSize;
+}
+
+// copy the committed txns of a redo log left by a crash into the db file, the frames after the last valid commit
+// record are discarded, and so is the last committed txn if it is not post-committed and rollback is set
+static int tdbPagerWalRecover(SPager *pPager, int8_t rollback) {
+  SPgno dbSize = 0;
+  i64   size = 0;
+  i64   pendOffset = -1;
+  u8   *pageBuf = NULL;
+
+  if (!taosCheckExistFile(pPager->wFileName)) {
+    return 0;
+  }
+
+  if (tdbPagerWalOpen(pPager, false) < 0) {
+    return -1;
+  }
+
+  pageBuf = tdbOsMalloc(pPager->pageSize);
+  if (pageBuf == NULL || tdbOsFileSize(pPager->wfd, &size) < 0) {
+    tdbOsFree(pageBuf);
+    tdbPagerWalClose(pPager, false);
+    return -1;
+  }
+
+  tdbPagerWalScan(pPager, pageBuf, size, &dbSize, &pendOffset);
+  if (rollback && pendOffset >= 0) {
+    tdbInfo("pager/wal-recover: %p, file:%s, roll back the txn at %" PRId64, pPager, pPager->wFileName, pendOffset);
+
+    taosHashClear(pPager->pWalIdx);
+    pPager->walSize = 0;
+    pPager->walOffset = 0;
+    dbSize = 0;
+    tdbPagerWalScan(pPager, pageBuf, pendOffset, &dbSize, &pendOffset);
+  }
+  tdbOsFree(pageBuf);
+
+  tdbInfo("pager/wal-recover: %p, file:%s, committed:%" PRId64 ", discarded:%" PRId64 ", dbSize:%d", pPager,
+          pPager->wFileName, pPager->walSize, size - pPager->walSize, dbSize);
+
+  if (tdbPagerWalCheckpoint(pPager, dbSize) < 0) {
+    tdbPagerWalClose(pPager, false);
+    return -1;
+  }
+
+  return tdbPagerWalClose(pPager, true);
+}
+
+// switch between the redo log and the rollback journal, between txns
+int tdbPagerSetWal(SPager *pPager, i64 ckptSize) {
+  if (ckptSize > 0) {
+    if (!TDB_PAGER_WAL(pPager) && tdbPagerWalOpen(pPager, true) < 0) {
+      return -1;
+    }
+    pPager->walCkptSize = ckptSize;
+    return 0;
+  }
+
+  if (TDB_PAGER_WAL(pPager)) {
+    if (tdbPagerWalCheckpoint(pPager, pPager->dbFileSize) < 0) {
+      return -1;
+    }
+    pPager->walCkptSize = 0;
+    return tdbPagerWalClose(pPager, true);
+  }
+
+  return 0;
+}
+
 static int tdbPagerRestore(SPager *pPager, const char *jFileName) {
   int   ret = 0;
   SPgno journalSize = 0;
@@ -107,6 +107,7 @@ typedef struct SPage   SPage;
 void    tdbEnvAddPager(TDB *pEnv, SPager *pPager);
 void    tdbEnvRemovePager(TDB *pEnv, SPager *pPager);
 SPager *tdbEnvGetPager(TDB *pEnv, const char *fname);
+SPager *tdbEnvGetMainPager(TDB *pEnv);
 
 // tdbBtree.c ====================================
 typedef struct SBTree SBTree;
@@ -184,7 +185,7 @@ int tdbBtcUpsert(SBTC *pBtc, const void *pKey, int kLen, const void *pData, int
 
 // tdbPager.c ====================================
 
-int  tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager);
+int  tdbPagerOpen(SPCache *pCache, const char *fileName, int8_t rollback, SPager **ppPager);
 int  tdbPagerClose(SPager *pPager);
 int  tdbPagerOpenDB(SPager *pPager, SPgno *ppgno, bool toCreate, SBTree *pBt);
 int  tdbPagerWrite(SPager *pPager, SPage *pPage);
@@ -197,23 +198,28 @@ int  tdbPagerFetchPage(SPager *pPager, SPgno *ppgno, SPage **ppPage, int (*initP
                        TXN *pTxn);
 void tdbPagerReturnPage(SPager *pPager, SPage *pPage, TXN *pTxn);
 int  tdbPagerAllocPage(SPager *pPager, SPgno *ppgno);
+void tdbPagerFreePage(SPager *pPager, SPage *pPage, TXN *pTxn);
+void tdbPagerVacuum(SPager *pPager);
+int  tdbPagerLoadFreeList(SPager *pPager, TTB *pFreeDb);
+int  tdbPagerSaveFreeList(SPager *pPager, TTB *pFreeDb, TXN *pTxn);
 int  tdbPagerRestoreJournals(SPager *pPager);
 int  tdbPagerRollback(SPager *pPager);
+int  tdbPagerSetWal(SPager *pPager, i64 ckptSize);
 
 // tdbPCache.c ====================================
-#define TDB_PCACHE_PAGE    \
-  u8           isAnchor;   \
-  u8           isLocal;    \
-  u8           isDirty;    \
-  u8           isFree;     \
-  volatile i32 nRef;       \
-  i32          id;         \
-  SPage       *pFreeNext;  \
-  SPage       *pHashNext;  \
-  SPage       *pLruNext;   \
-  SPage       *pLruPrev;   \
-  SPage       *pDirtyNext; \
-  SPager      *pPager;     \
+#define TDB_PCACHE_PAGE      \
+  u8           isLocal;      \
+  u8           isDirty;      \
+  u8           isFree;       \
+  u8           isRecyclable; \
+  u8           clockRef;     \
+  volatile i32 nRef;         \
+  i32          id;           \
+  i32          slot;         \
+  SPage       *pFreeNext;    \
+  SPage       *pHashNext;    \
+  SPage       *pDirtyNext;   \
+  SPager      *pPager;       \
   SPgid        pgid;
 
 // For page ref
@@ -371,6 +377,7 @@ static inline SCell *tdbPageGetCell(SPage *pPage, int idx) {
 
 #ifdef USE_MAINDB
 #define TDB_MAINDB_NAME "main.tdb"
+#define TDB_FREEDB_NAME "_free.db"  // free pages of the main db file, chunk no. -> pgno array
 #endif
 
 struct STDB {
@@ -384,6 +391,7 @@ struct STDB {
   SPager **pgrHash;
 #ifdef USE_MAINDB
   TTB *pMainDb;
+  TTB *pFreeDb;
 #endif
   int64_t txnId;
 };
@@ -403,6 +411,25 @@ struct SPager {
   TXN    *pActiveTxn;
   SPager *pNext;      // used by TDB
   SPager *pHashNext;  // used by TDB
+  // free pages, sorted by pgno in descending order so the lowest one is reused first
+  SPgno  *aFreePgno;
+  int     nFreePgno;
+  int     capFreePgno;
+  int     nFreeChunk;    // chunks of the free pages in the free db
+  int64_t freeVer;       // bumped on each change of the free pages
+  int64_t freeSavedVer;  // freeVer of the free pages in the free db
+  u8      noFreeAlloc;
+  // redo log, commits append the dirty pages to it instead of the rollback journal when walCkptSize > 0
+  char       *wFileName;
+  tdb_fd_t    wfd;
+  i64         walCkptSize;  // size of the log to checkpoint it into the db file
+  i64         walSize;      // end of the committed frames
+  i64         walOffset;    // end of the frames, including the ones of the active txn
+  SHashObj   *pWalIdx;      // pgno -> offset of the last committed frame of the page
+  SHashObj   *pWalTxnIdx;   // pgno -> offset of the last frame of the page written by the active txn
+  i64         walCommitTxnId;  // txn of the last commit record
+  u8          walPostPending;  // the last committed txn is not post-committed yet, and may still be rolled back
+  tdb_mutex_t walMutex;
 #ifdef USE_MAINDB
   TDB *pEnv;
 #endif
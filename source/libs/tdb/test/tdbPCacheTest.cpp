@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#define ALLOW_FORBID_FUNC
+#include "tdbInt.h"
+
+namespace {
+
+const int kPageSize = 4096;
+
+// pages with an all zero file id go to shard pgno % nShard
+SPgid pgid(SPgno pgno) {
+  SPgid id = {0};
+  id.pgno = pgno;
+  return id;
+}
+
+SPage *fetch(SPCache *pCache, SPgno pgno, TXN *pTxn) {
+  SPgid id = pgid(pgno);
+  return tdbPCacheFetch(pCache, &id, pTxn);
+}
+
+// the page still holds what was written to it when it was fetched for pgno
+bool isCached(SPage *pPage, SPgno pgno) { return *(SPgno *)pPage->pData == pgno; }
+
+class TdbPCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&txn, 0, sizeof(txn));
+    txn.flags = TDB_TXN_WRITE;
+  }
+
+  void TearDown() override { tdbPCacheClose(pCache); }
+
+  void open(int nPages) { ASSERT_EQ(tdbPCacheOpen(kPageSize, nPages, &pCache), 0); }
+
+  SPage *fetchPage(SPgno pgno) {
+    SPage *pPage = fetch(pCache, pgno, &txn);
+    if (pPage) {
+      EXPECT_EQ(pPage->pgid.pgno, pgno);
+    }
+    return pPage;
+  }
+
+  // pin the pages of pgnos, then the next fetch finds no page as the transaction allocates none
+  std::vector<SPage *> pinAll(const std::vector<SPgno> &pgnos) {
+    std::vector<SPage *> aPage;
+    std::set<SPage *>    pages;
+    for (SPgno pgno : pgnos) {
+      SPage *pPage = fetchPage(pgno);
+      EXPECT_NE(pPage, nullptr) << "pgno " << pgno;
+      if (pPage == NULL) break;
+      pages.insert(pPage);
+      aPage.push_back(pPage);
+    }
+    EXPECT_EQ(pages.size(), pgnos.size());
+    return aPage;
+  }
+
+  void releaseAll(std::vector<SPage *> &aPage) {
+    for (SPage *pPage : aPage) {
+      tdbPCacheRelease(pCache, pPage, &txn);
+    }
+    aPage.clear();
+  }
+
+  SPCache *pCache = NULL;
+  TXN      txn;
+};
+
+}  // namespace
+
+TEST_F(TdbPCacheTest, concurrentFetchRelease) {
+  const int nThreads = 8;
+  const int nPages = 1024;
+  open(nPages);
+
+  // each thread works on pgnos of its own, so a page it holds is never handed to another one
+  std::vector<std::thread> threads;
+  for (int iThread = 0; iThread < nThreads; iThread++) {
+    threads.emplace_back([this, iThread]() {
+      TXN txn = {0};
+      txn.flags = TDB_TXN_WRITE;
+
+      std::mt19937         rng(iThread);
+      std::vector<SPage *> held;
+      for (int i = 0; i < 20000; i++) {
+        SPgno  pgno = iThread * 100000 + rng() % 2000;
+        SPage *pPage = fetch(pCache, pgno, &txn);
+        ASSERT_NE(pPage, nullptr);
+        ASSERT_EQ(pPage->pgid.pgno, pgno);
+        *(SPgno *)pPage->pData = pgno;
+        held.push_back(pPage);
+
+        if (held.size() > 4 || i == 19999) {
+          for (SPage *pHeld : held) {
+            ASSERT_TRUE(isCached(pHeld, pHeld->pgid.pgno));
+            tdbPCacheRelease(pCache, pHeld, &txn);
+          }
+          held.clear();
+        }
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  // no page is left pinned, in any of the shards
+  std::vector<SPgno> pgnos;
+  for (int i = 0; i < nPages; i++) {
+    pgnos.push_back(1000000 + i);
+  }
+  std::vector<SPage *> aPage = pinAll(pgnos);
+  ASSERT_EQ(aPage.size(), nPages);
+  ASSERT_EQ(fetchPage(2000000), nullptr);
+  releaseAll(aPage);
+}
+
+TEST_F(TdbPCacheTest, clockEvictionOrder) {
+  const int nPages = 8;
+  open(nPages);
+
+  for (SPgno pgno = 1; pgno <= nPages; pgno++) {
+    SPage *pPage = fetchPage(pgno);
+    ASSERT_NE(pPage, nullptr);
+    *(SPgno *)pPage->pData = pgno;
+    tdbPCacheRelease(pCache, pPage, &txn);
+  }
+
+  // a hit gives 1 to 4 a second chance, so the misses after take the pages of 5 to 8
+  for (SPgno pgno = 1; pgno <= 4; pgno++) {
+    SPage *pPage = fetchPage(pgno);
+    ASSERT_NE(pPage, nullptr);
+    ASSERT_TRUE(isCached(pPage, pgno));
+    tdbPCacheRelease(pCache, pPage, &txn);
+  }
+  for (SPgno pgno = 9; pgno <= 12; pgno++) {
+    SPage *pPage = fetchPage(pgno);
+    ASSERT_NE(pPage, nullptr);
+    ASSERT_FALSE(isCached(pPage, pgno));
+    *(SPgno *)pPage->pData = pgno;
+    tdbPCacheRelease(pCache, pPage, &txn);
+  }
+
+  for (SPgno pgno = 1; pgno <= 12; pgno++) {
+    SPage *pPage = fetchPage(pgno);
+    ASSERT_NE(pPage, nullptr);
+    ASSERT_EQ(isCached(pPage, pgno), pgno <= 4) << "pgno " << pgno;
+    *(SPgno *)pPage->pData = pgno;
+    tdbPCacheRelease(pCache, pPage, &txn);
+  }
+}
+
+TEST_F(TdbPCacheTest, shardExhaustion) {
+  const int nPages = 256;
+  open(nPages);
+
+  // all the pages go to one shard, which borrows the free pages of the others
+  std::vector<SPgno> pgnos;
+  for (int i = 0; i < nPages; i++) {
+    pgnos.push_back(i * 16);
+  }
+  std::vector<SPage *> aPage = pinAll(pgnos);
+  ASSERT_EQ(aPage.size(), nPages);
+  for (SPage *pPage : aPage) {
+    *(SPgno *)pPage->pData = pPage->pgid.pgno;
+  }
+  ASSERT_EQ(fetchPage(nPages * 16), nullptr);
+  releaseAll(aPage);
+
+  // then another shard takes them back once they are recyclable
+  pgnos.clear();
+  for (int i = 0; i < nPages; i++) {
+    pgnos.push_back(i * 16 + 1);
+  }
+  aPage = pinAll(pgnos);
+  ASSERT_EQ(aPage.size(), nPages);
+  ASSERT_EQ(fetchPage(0), nullptr);
+  releaseAll(aPage);
+
+  SPage *pPage = fetchPage(16);
+  ASSERT_NE(pPage, nullptr);
+  ASSERT_FALSE(isCached(pPage, 16));
+  tdbPCacheRelease(pCache, pPage, &txn);
+}
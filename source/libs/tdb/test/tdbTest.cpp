@@ -710,3 +710,232 @@ TEST(tdb_test, DISABLED_multi_thread1) {
   GTEST_ASSERT_EQ(ret, 0);
 #endif
 }
+
+static void tdbTestInsertRange(TDB *pEnv, TTB *pDb, int from, int to) {
+  SPoolMem *pPool = openPool();
+  TXN      *txn = NULL;
+  char      key[64];
+  char      data[128];
+
+  GTEST_ASSERT_EQ(tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED), 0);
+  for (int iData = from; iData < to; iData++) {
+    sprintf(key, "key%d", iData);
+    sprintf(data, "data%d-%064d", iData, iData);
+    GTEST_ASSERT_EQ(tdbTbInsert(pDb, key, strlen(key), data, strlen(data), txn), 0);
+  }
+  GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+  GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+  closePool(pPool);
+}
+
+static void tdbTestDeleteRange(TDB *pEnv, TTB *pDb, int from, int to) {
+  SPoolMem *pPool = openPool();
+  TXN      *txn = NULL;
+  char      key[64];
+
+  GTEST_ASSERT_EQ(tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED), 0);
+  for (int iData = from; iData < to; iData++) {
+    sprintf(key, "key%d", iData);
+    GTEST_ASSERT_EQ(tdbTbDelete(pDb, key, strlen(key), txn), 0);
+  }
+  GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+  GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+  closePool(pPool);
+}
+
+TEST(tdb_test, free_page_reuse) {
+  TDB    *pEnv;
+  TTB    *pDb;
+  int64_t size0 = 0, size1 = 0, size2 = 0;
+  int     nKV = 20000;
+
+  taosRemoveDir("tdb");
+
+  GTEST_ASSERT_EQ(tdbOpen("tdb", 1024, 256, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+
+  tdbTestInsertRange(pEnv, pDb, 0, nKV);
+  taosStatFile("tdb/main.tdb", &size0, NULL);
+
+  // the merged pages are freed, and the free tail of the file is truncated
+  tdbTestDeleteRange(pEnv, pDb, 0, nKV);
+  taosStatFile("tdb/main.tdb", &size1, NULL);
+  GTEST_ASSERT_LE(size1, size0);
+
+  // the free pages are reused instead of extending the file
+  tdbTestInsertRange(pEnv, pDb, nKV, nKV * 2);
+  taosStatFile("tdb/main.tdb", &size2, NULL);
+  std::cout << "file size, full:" << size0 << " deleted:" << size1 << " refilled:" << size2 << std::endl;
+  GTEST_ASSERT_LE(size2, size0 + size0 / 10);
+
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+
+  // the free pages survive a reopen
+  GTEST_ASSERT_EQ(tdbOpen("tdb", 1024, 256, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+
+  tdbTestDeleteRange(pEnv, pDb, nKV, nKV + nKV / 2);
+  tdbTestInsertRange(pEnv, pDb, 0, nKV / 2);
+
+  char  key[64];
+  void *pData = NULL;
+  int   nData;
+  for (int iData = 0; iData < nKV * 2; iData++) {
+    sprintf(key, "key%d", iData);
+    int ret = tdbTbGet(pDb, key, strlen(key), &pData, &nData);
+    GTEST_ASSERT_EQ(ret, (iData < nKV / 2 || iData >= nKV + nKV / 2) ? 0 : -1);
+  }
+  tdbFree(pData);
+
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+}
+
+static void tdbTestCheckRange(TTB *pDb, int from, int to, int ret) {
+  char  key[64];
+  void *pData = NULL;
+  int   nData;
+
+  for (int iData = from; iData < to; iData++) {
+    sprintf(key, "key%d", iData);
+    GTEST_ASSERT_EQ(tdbTbGet(pDb, key, strlen(key), &pData, &nData), ret);
+  }
+  tdbFree(pData);
+}
+
+// with no allocator, the txn spills its dirty pages out of a full cache
+static void tdbTestSpillRange(TDB *pEnv, TTB *pDb, int from, int to, bool commit) {
+  TXN *txn = NULL;
+  char key[64];
+
+  GTEST_ASSERT_EQ(tdbBegin(pEnv, &txn, NULL, NULL, NULL, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED), 0);
+  for (int iData = from; iData < to; iData++) {
+    sprintf(key, "key%d", iData);
+    GTEST_ASSERT_EQ(tdbTbInsert(pDb, key, strlen(key), key, strlen(key), txn), 0);
+  }
+  if (commit) {
+    GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+    GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+  } else {
+    GTEST_ASSERT_EQ(tdbAbort(pEnv, txn), 0);
+  }
+}
+
+TEST(tdb_test, wal_commit) {
+  TDB    *pEnv;
+  TTB    *pDb;
+  int64_t size = 0;
+  int     nKV = 20000;
+
+  taosRemoveDir("tdb");
+  taosRemoveDir("tdb_crash");
+
+  // a small cache spills dirty pages into the log before the commit
+  GTEST_ASSERT_EQ(tdbOpen("tdb", 1024, 64, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbSetWal(pEnv, 1024 * 1024 * 1024), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+
+  tdbTestSpillRange(pEnv, pDb, 0, nKV / 2, true);
+  tdbTestInsertRange(pEnv, pDb, nKV / 2, nKV);
+  taosStatFile("tdb/main.tdb-wal", &size, NULL);
+  GTEST_ASSERT_GT(size, 0);
+
+  // the pages of an aborted txn are dropped with its frames
+  tdbTestSpillRange(pEnv, pDb, nKV, nKV * 2, false);
+  tdbTestCheckRange(pDb, 0, nKV, 0);
+  tdbTestCheckRange(pDb, nKV, nKV * 2, -1);
+
+  // a crash leaves the db file and the log, the committed frames are recovered at open
+  taosMkDir("tdb_crash");
+  GTEST_ASSERT_GT(taosCopyFile("tdb/main.tdb", "tdb_crash/main.tdb"), -1);
+  GTEST_ASSERT_GT(taosCopyFile("tdb/main.tdb-wal", "tdb_crash/main.tdb-wal"), -1);
+
+  tdbTestDeleteRange(pEnv, pDb, 0, nKV / 2);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+  GTEST_ASSERT_EQ(taosCheckExistFile("tdb/main.tdb-wal"), false);
+
+  GTEST_ASSERT_EQ(tdbOpen("tdb", 1024, 256, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+  tdbTestCheckRange(pDb, 0, nKV / 2, -1);
+  tdbTestCheckRange(pDb, nKV / 2, nKV, 0);
+
+  // checkpoint the log every 64 pages
+  GTEST_ASSERT_EQ(tdbSetWal(pEnv, 64 * 1024), 0);
+  for (int i = 0; i < 10; i++) {
+    tdbTestInsertRange(pEnv, pDb, nKV + i * 1000, nKV + (i + 1) * 1000);
+  }
+  taosStatFile("tdb/main.tdb-wal", &size, NULL);
+  GTEST_ASSERT_LT(size, 64 * 1024 + 64 * 1024);
+  tdbTestCheckRange(pDb, nKV / 2, nKV + 10000, 0);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+
+  GTEST_ASSERT_EQ(tdbOpen("tdb_crash", 1024, 256, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(taosCheckExistFile("tdb_crash/main.tdb-wal"), false);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+  tdbTestCheckRange(pDb, 0, nKV, 0);
+  tdbTestCheckRange(pDb, nKV, nKV * 2, -1);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+}
+
+TEST(tdb_test, wal_rollback) {
+  TDB      *pEnv;
+  TTB      *pDb;
+  TXN      *txn = NULL;
+  SPoolMem *pPool = openPool();
+  char      key[64];
+  int       nKV = 10000;
+
+  taosRemoveDir("tdb");
+  taosRemoveDir("tdb_rollback");
+  taosRemoveDir("tdb_keep");
+
+  GTEST_ASSERT_EQ(tdbOpen("tdb", 1024, 256, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbSetWal(pEnv, 1024 * 1024 * 1024), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+  tdbTestInsertRange(pEnv, pDb, 0, nKV);
+
+  // a crash between the commit and the post-commit of a txn
+  GTEST_ASSERT_EQ(tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED), 0);
+  for (int iData = nKV; iData < nKV * 2; iData++) {
+    sprintf(key, "key%d", iData);
+    GTEST_ASSERT_EQ(tdbTbInsert(pDb, key, strlen(key), key, strlen(key), txn), 0);
+  }
+  GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+
+  taosMkDir("tdb_rollback");
+  taosMkDir("tdb_keep");
+  GTEST_ASSERT_GT(taosCopyFile("tdb/main.tdb", "tdb_rollback/main.tdb"), -1);
+  GTEST_ASSERT_GT(taosCopyFile("tdb/main.tdb-wal", "tdb_rollback/main.tdb-wal"), -1);
+  GTEST_ASSERT_GT(taosCopyFile("tdb/main.tdb", "tdb_keep/main.tdb"), -1);
+  GTEST_ASSERT_GT(taosCopyFile("tdb/main.tdb-wal", "tdb_keep/main.tdb-wal"), -1);
+
+  GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+  closePool(pPool);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+
+  // the txn is rolled back only if it is not post-committed
+  GTEST_ASSERT_EQ(tdbOpen("tdb", 1024, 256, &pEnv, 1), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 1), 0);
+  tdbTestCheckRange(pDb, 0, nKV * 2, 0);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+
+  GTEST_ASSERT_EQ(tdbOpen("tdb_rollback", 1024, 256, &pEnv, 1), 0);
+  GTEST_ASSERT_EQ(taosCheckExistFile("tdb_rollback/main.tdb-wal"), false);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 1), 0);
+  tdbTestCheckRange(pDb, 0, nKV, 0);
+  tdbTestCheckRange(pDb, nKV, nKV * 2, -1);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+
+  GTEST_ASSERT_EQ(tdbOpen("tdb_keep", 1024, 256, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pDb, 0), 0);
+  tdbTestCheckRange(pDb, 0, nKV * 2, 0);
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+}
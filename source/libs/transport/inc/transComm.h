@@ -99,6 +99,7 @@ typedef void* queue[2];
 #define TRANS_CONN_TIMEOUT 3000  // connect timeout (ms)
 #define TRANS_READ_TIMEOUT 3000  // read timeout  (ms)
 #define TRANS_PACKET_LIMIT 1024 * 1024 * 512
+#define TRANS_BATCH_SEND_LIMIT 32  // max msgs drained into one vectored write
 
 #define TRANS_MAGIC_NUM 0x5f375a86
 
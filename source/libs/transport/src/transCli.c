@@ -799,15 +799,8 @@ static void cliSendCb(uv_write_t* req, int status) {
   uv_read_start((uv_stream_t*)pConn->stream, cliAllocRecvBufferCb, cliRecvCb);
 }
 
-void cliSend(SCliConn* pConn) {
-  bool empty = transQueueEmpty(&pConn->cliMsgs);
-  ASSERTS(empty == false, "trans-cli get invalid msg");
-  if (empty == true) {
-    return;
-  }
-
-  SCliMsg* pCliMsg = NULL;
-  CONN_GET_NEXT_SENDMSG(pConn);
+// fill the head of one msg and compress it, the returned buf points to the data to write
+static uv_buf_t cliPrepareSendMsg(SCliConn* pConn, SCliMsg* pCliMsg) {
   pCliMsg->sent = 1;
 
   STransConnCtx* pCtx = pCliMsg->ctx;
@@ -843,7 +836,7 @@ void cliSend(SCliConn* pConn) {
 
   STraceId* trace = &pMsg->info.traceId;
 
-  if (pTransInst->startTimer != NULL && pTransInst->startTimer(0, pMsg->msgType)) {
+  if (pConn->timer == NULL && pTransInst->startTimer != NULL && pTransInst->startTimer(0, pMsg->msgType)) {
     uv_timer_t* timer = taosArrayGetSize(pThrd->timerList) > 0 ? *(uv_timer_t**)taosArrayPop(pThrd->timerList) : NULL;
     if (timer == NULL) {
       timer = taosMemoryCalloc(1, sizeof(uv_timer_t));
@@ -869,13 +862,44 @@ void cliSend(SCliConn* pConn) {
   tGDebug("%s conn %p %s is sent to %s, local info %s, len:%d", CONN_GET_INST_LABEL(pConn), pConn,
           TMSG_INFO(pHead->msgType), pConn->dst, pConn->src, msgLen);
 
-  uv_buf_t    wb = uv_buf_init((char*)pHead, msgLen);
+  return uv_buf_init((char*)pHead, msgLen);
+}
+
+void cliSend(SCliConn* pConn) {
+  bool empty = transQueueEmpty(&pConn->cliMsgs);
+  ASSERTS(empty == false, "trans-cli get invalid msg");
+  if (empty == true) {
+    return;
+  }
+
+  SCliMsg* pCliMsg = NULL;
+  CONN_GET_NEXT_SENDMSG(pConn);
+
+  uv_buf_t wb[TRANS_BATCH_SEND_LIMIT];
+  int      nbufs = 0;
+  wb[nbufs++] = cliPrepareSendMsg(pConn, pCliMsg);
+
+  /*
+   * resps on a persistent conn are matched by ahandle, so the msgs queued behind the first one are drained into the
+   * same vectored write. msgs without resp are left to cliHandleNoResp, which only handles the head of the queue
+   */
+  if (pConn->status != ConnNormal && !REQUEST_NO_RESP(&pCliMsg->msg) && !REQUEST_RELEASE_HANDLE(pCliMsg)) {
+    int32_t sz = transQueueSize(&pConn->cliMsgs);
+    for (int32_t i = 0; i < sz && nbufs < TRANS_BATCH_SEND_LIMIT; i++) {
+      SCliMsg* pNext = transQueueGet(&pConn->cliMsgs, i);
+      if (pNext->sent == 1) continue;
+      if (REQUEST_NO_RESP(&pNext->msg) || REQUEST_RELEASE_HANDLE(pNext)) break;
+      wb[nbufs++] = cliPrepareSendMsg(pConn, pNext);
+    }
+  }
+
   uv_write_t* req = transReqQueuePush(&pConn->wreqQueue);
 
-  int status = uv_write(req, (uv_stream_t*)pConn->stream, &wb, 1, cliSendCb);
+  int status = uv_write(req, (uv_stream_t*)pConn->stream, wb, nbufs, cliSendCb);
   if (status != 0) {
-    tGError("%s conn %p failed to send msg:%s, errmsg:%s", CONN_GET_INST_LABEL(pConn), pConn, TMSG_INFO(pMsg->msgType),
-            uv_err_name(status));
+    STraceId* trace = &pCliMsg->msg.info.traceId;
+    tGError("%s conn %p failed to send msg:%s, nbufs:%d, errmsg:%s", CONN_GET_INST_LABEL(pConn), pConn,
+            TMSG_INFO(pCliMsg->msg.msgType), nbufs, uv_err_name(status));
     cliHandleExcept(pConn);
   }
   return;
@@ -23,23 +23,57 @@ static TdThreadOnce transModuleInit = PTHREAD_ONCE_INIT;
 static int32_t refMgt;
 static int32_t instMgt;
 
+// per-thread scratch buffer of the msg compression, buffers larger than the limit are not kept
+#define COMPRESS_BUF_CACHE_LIMIT (4 * 1024 * 1024)
+
+static threadlocal char*   compBuf = NULL;
+static threadlocal int32_t compBufCap = 0;
+
+static char* transGetCompressBuf(int32_t size) {
+  if (size > COMPRESS_BUF_CACHE_LIMIT) {
+    return taosMemoryMalloc(size);
+  }
+  if (compBufCap < size) {
+    int32_t cap = compBufCap == 0 ? BUFFER_CAP : compBufCap;
+    while (cap < size) cap *= 2;
+    char* buf = taosMemoryRealloc(compBuf, cap);
+    if (buf == NULL) {
+      return NULL;
+    }
+    compBuf = buf;
+    compBufCap = cap;
+  }
+  return compBuf;
+}
+static void transReleaseCompressBuf(char* buf) {
+  if (buf != compBuf) {
+    taosMemoryFree(buf);
+  }
+}
+
 int32_t transCompressMsg(char* msg, int32_t len) {
   int32_t        ret = 0;
   int            compHdr = sizeof(STransCompMsg);
   STransMsgHead* pHead = transHeadFromCont(msg);
 
-  char* buf = taosMemoryMalloc(len + compHdr + 8);  // 8 extra bytes
+  if (len <= compHdr) {
+    pHead->comp = 0;
+    return len;
+  }
+
+  char* buf = transGetCompressBuf(len);
   if (buf == NULL) {
     tError("failed to allocate memory for rpc msg compression, contLen:%d", len);
     ret = len;
     return ret;
   }
 
-  int32_t clen = LZ4_compress_default(msg, buf, len, len + compHdr);
   /*
-   * only the compressed size is less than the value of contLen - overhead, the compression is applied
+   * only the compressed size is less than the value of contLen - overhead, the compression is applied, so the
+   * output is bounded to that size and lz4 gives up early on incompressible msgs
    * The first four bytes is set to 0, the second four bytes are utilized to keep the original length of message
    */
+  int32_t clen = LZ4_compress_default(msg, buf, len, len - compHdr - 1);
   if (clen > 0 && clen < len - compHdr) {
     STransCompMsg* pComp = (STransCompMsg*)msg;
     pComp->reserved = 0;
@@ -53,7 +87,7 @@ int32_t transCompressMsg(char* msg, int32_t len) {
     ret = len;
     pHead->comp = 0;
   }
-  taosMemoryFree(buf);
+  transReleaseCompressBuf(buf);
   return ret;
 }
 int32_t transDecompressMsg(char** msg, int32_t len) {
@@ -39,6 +39,7 @@ typedef struct SSvrConn {
   void*       ahandle;     //
   void*       hostThrd;
   STransQueue srvMsgs;
+  int32_t     nSending;  // count of msgs at the head of srvMsgs in the write on fly
 
   SSvrRegArg regArg;
   bool       broken;  // conn broken;
@@ -348,11 +349,14 @@ void uvOnSendCb(uv_write_t* req, int status) {
   if (status == 0) {
     tTrace("conn %p data already was written on stream", conn);
     if (!transQueueEmpty(&conn->srvMsgs)) {
-      SSvrMsg*  msg = transQueuePop(&conn->srvMsgs);
-      STraceId* trace = &msg->msg.info.traceId;
-      tGDebug("conn %p write data out", conn);
+      SSvrMsg* msg = NULL;
+      tDebug("conn %p write %d msgs out", conn, conn->nSending);
+      for (int32_t i = 0; i < conn->nSending; i++) {
+        msg = transQueuePop(&conn->srvMsgs);
+        destroySmsg(msg);
+      }
+      conn->nSending = 0;
 
-      destroySmsg(msg);
       // send cached data
       if (!transQueueEmpty(&conn->srvMsgs)) {
         msg = (SSvrMsg*)transQueueGet(&conn->srvMsgs, 0);
@@ -413,10 +417,8 @@ static int uvPrepareSendData(SSvrMsg* smsg, uv_buf_t* wb) {
   pHead->hasEpSet = pMsg->info.hasEpSet;
   pHead->magicNum = htonl(TRANS_MAGIC_NUM);
 
-  // handle invalid drop_task resp, TD-20098
+  // handle invalid drop_task resp, TD-20098, the caller drops it from srvMsgs
   if (pConn->inType == TDMT_SCH_DROP_TASK && pMsg->code == TSDB_CODE_VND_INVALID_VGROUP_ID) {
-    transQueuePop(&pConn->srvMsgs);
-    destroySmsg(smsg);
     return -1;
   }
 
@@ -457,20 +459,43 @@ static int uvPrepareSendData(SSvrMsg* smsg, uv_buf_t* wb) {
   return 0;
 }
 
+/*
+ * smsg is the head of srvMsgs, the resps queued behind it are drained into the same vectored write until a
+ * register or release msg, which changes the conn status
+ */
 static FORCE_INLINE void uvStartSendRespImpl(SSvrMsg* smsg) {
   SSvrConn* pConn = smsg->pConn;
   if (pConn->broken) {
     return;
   }
 
-  uv_buf_t wb;
-  if (uvPrepareSendData(smsg, &wb) < 0) {
+  uv_buf_t wb[TRANS_BATCH_SEND_LIMIT];
+  int      nbufs = 0;
+  int32_t  i = 0;
+  while (nbufs < TRANS_BATCH_SEND_LIMIT && i < transQueueSize(&pConn->srvMsgs)) {
+    SSvrMsg* pMsg = transQueueGet(&pConn->srvMsgs, i);
+    if (pMsg->type == Register || (nbufs > 0 && pMsg->type != Normal)) {
+      break;
+    }
+    if (uvPrepareSendData(pMsg, &wb[nbufs]) < 0) {
+      transQueueRm(&pConn->srvMsgs, i);
+      destroySmsg(pMsg);
+      continue;
+    }
+    nbufs++;
+    i++;
+    if (pMsg->type == Release) {
+      break;
+    }
+  }
+  if (nbufs == 0) {
     return;
   }
 
+  pConn->nSending = nbufs;
   transRefSrvHandle(pConn);
   uv_write_t* req = transReqQueuePush(&pConn->wreqQueue);
-  uv_write(req, (uv_stream_t*)pConn->pTcp, &wb, 1, uvOnSendCb);
+  uv_write(req, (uv_stream_t*)pConn->pTcp, wb, nbufs, uvOnSendCb);
 }
 static void uvStartSendResp(SSvrMsg* smsg) {
   // impl
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3 * or later ("AGPL"), as published by the Free
+ * Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef LINUX
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+
+#define ALLOW_FORBID_FUNC
+#include "tmisce.h"
+#include "trpc.h"
+
+using namespace std;
+
+namespace {
+
+const char   *label = "APP";
+const char   *user = "user";
+const uint16_t kPort = 7100;
+
+// socket writev calls of the process, libuv writes a single buf by write() and several by writev()
+std::atomic<int32_t> maxIovCnt(0);
+std::atomic<int32_t> nShortWrite(0);
+std::atomic<int32_t> writeCap(0);  // max bytes of one socket writev, 0 for no limit
+
+// the content of resp seq, seq at the head and a pattern of it after
+void fillResp(char *pCont, int32_t contLen, int32_t seq) {
+  *(int32_t *)pCont = seq;
+  for (int32_t i = sizeof(int32_t); i < contLen; i++) {
+    pCont[i] = (char)(seq * 31 + i);
+  }
+}
+
+bool checkResp(const char *pCont, int32_t contLen, int32_t seq) {
+  if (contLen < (int32_t)sizeof(int32_t) || *(int32_t *)pCont != seq) return false;
+  for (int32_t i = sizeof(int32_t); i < contLen; i++) {
+    if (pCont[i] != (char)(seq * 31 + i)) return false;
+  }
+  return true;
+}
+
+/*
+ * the server holds the reqs until nBatch of them arrived and then sends all their resps from the same callback, so
+ * the resps are queued on the conn behind the first one
+ */
+struct SBatchSrv {
+  std::mutex           mutex;
+  int32_t              nBatch = 0;
+  int32_t              respLen = 0;
+  std::vector<SRpcMsg> reqs;
+};
+SBatchSrv batchSrv;
+
+void processReq(void *parent, SRpcMsg *pMsg, SEpSet *pEpSet) {
+  std::vector<SRpcMsg> reqs;
+  {
+    std::lock_guard<std::mutex> lock(batchSrv.mutex);
+    batchSrv.reqs.push_back(*pMsg);
+    if ((int32_t)batchSrv.reqs.size() < batchSrv.nBatch) return;
+    reqs.swap(batchSrv.reqs);
+  }
+
+  for (SRpcMsg &req : reqs) {
+    int32_t seq = *(int32_t *)req.pCont;
+    rpcFreeCont(req.pCont);
+
+    SRpcMsg rpcMsg = {0};
+    rpcMsg.contLen = batchSrv.respLen;
+    rpcMsg.pCont = rpcMallocCont(rpcMsg.contLen);
+    fillResp((char *)rpcMsg.pCont, rpcMsg.contLen, seq);
+    rpcMsg.info = req.info;
+    rpcMsg.code = 0;
+    rpcSendResponse(&rpcMsg);
+  }
+}
+
+struct SBatchCli {
+  tsem_t                  sem;
+  std::mutex              mutex;
+  std::map<int32_t, bool> resps;  // seq -> content checked
+  void                   *handle = NULL;
+};
+
+void processResp(void *parent, SRpcMsg *pMsg, SEpSet *pEpSet) {
+  SBatchCli *pCli = (SBatchCli *)parent;
+  int32_t    seq = (int32_t)(intptr_t)pMsg->info.ahandle;
+  {
+    std::lock_guard<std::mutex> lock(pCli->mutex);
+    pCli->resps[seq] = pMsg->code == 0 && checkResp((char *)pMsg->pCont, pMsg->contLen, seq);
+    pCli->handle = pMsg->info.handle;
+  }
+  rpcFreeCont(pMsg->pCont);
+  tsem_post(&pCli->sem);
+}
+
+class TransBatchEnv : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memcpy(tsTempDir, TD_TMP_DIR_PATH, strlen(TD_TMP_DIR_PATH));
+    batchSrv.nBatch = 1;
+    batchSrv.respLen = 100;
+
+    SRpcInit srvInit = {0};
+    memcpy(srvInit.localFqdn, "localhost", strlen("localhost"));
+    srvInit.localPort = kPort;
+    srvInit.label = (char *)label;
+    srvInit.numOfThreads = 1;
+    srvInit.cfp = processReq;
+    srvInit.user = (char *)user;
+    srvInit.connType = TAOS_CONN_SERVER;
+    transSrv = rpcOpen(&srvInit);
+    ASSERT_NE(transSrv, nullptr);
+    taosMsleep(1000);
+
+    tsem_init(&cli.sem, 0, 0);
+    SRpcInit cliInit = {0};
+    cliInit.label = (char *)label;
+    cliInit.numOfThreads = 1;
+    cliInit.cfp = processResp;
+    cliInit.user = (char *)user;
+    cliInit.parent = &cli;
+    cliInit.connType = TAOS_CONN_CLIENT;
+    transCli = rpcOpen(&cliInit);
+    ASSERT_NE(transCli, nullptr);
+
+    maxIovCnt = 0;
+    nShortWrite = 0;
+    writeCap = 0;
+  }
+
+  void TearDown() override {
+    writeCap = 0;
+    if (cli.handle) rpcReleaseHandle(cli.handle, TAOS_CONN_CLIENT);
+    rpcClose(transCli);
+    rpcClose(transSrv);
+    tsem_destroy(&cli.sem);
+  }
+
+  void send(int32_t seq, void *handle) {
+    SEpSet epSet = {0};
+    addEpIntoEpSet(&epSet, "127.0.0.1", kPort);
+
+    SRpcMsg req = {0};
+    req.msgType = 1;
+    req.contLen = sizeof(int32_t);
+    req.pCont = rpcMallocCont(req.contLen);
+    *(int32_t *)req.pCont = seq;
+    req.info.ahandle = (void *)(intptr_t)seq;
+    req.info.handle = handle;
+    req.info.persistHandle = 1;
+    rpcSendRequest(transCli, &epSet, &req, NULL);
+  }
+
+  // nResp resps of respLen bytes to reqs sent together on one persistent conn
+  void sendBatch(int32_t nResp, int32_t respLen) {
+    send(0, NULL);
+    ASSERT_EQ(tsem_timewait(&cli.sem, 10000), 0);
+    ASSERT_TRUE(cli.resps[0]);
+    ASSERT_NE(cli.handle, nullptr);
+
+    batchSrv.nBatch = nResp;
+    batchSrv.respLen = respLen;
+    for (int32_t seq = 1; seq <= nResp; seq++) {
+      send(seq, cli.handle);
+    }
+    for (int32_t i = 0; i < nResp; i++) {
+      ASSERT_EQ(tsem_timewait(&cli.sem, 10000), 0);
+    }
+
+    std::lock_guard<std::mutex> lock(cli.mutex);
+    ASSERT_EQ(cli.resps.size(), nResp + 1);
+    for (auto &resp : cli.resps) {
+      EXPECT_TRUE(resp.second) << "resp " << resp.first;
+    }
+  }
+
+  void     *transSrv = NULL;
+  void     *transCli = NULL;
+  SBatchCli cli;
+};
+
+}  // namespace
+
+#ifdef LINUX
+// sees all the socket writev of the process, and cuts them at writeCap bytes to make them partial
+extern "C" ssize_t writev(int fd, const struct iovec *iov, int iovcnt) {
+  static ssize_t (*realWritev)(int, const struct iovec *, int) =
+      (ssize_t(*)(int, const struct iovec *, int))dlsym(RTLD_NEXT, "writev");
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+    return realWritev(fd, iov, iovcnt);
+  }
+
+  for (int32_t cnt = maxIovCnt; iovcnt > cnt && !maxIovCnt.compare_exchange_weak(cnt, iovcnt);) {
+  }
+
+  int32_t cap = writeCap;
+  if (cap == 0) {
+    return realWritev(fd, iov, iovcnt);
+  }
+
+  std::vector<struct iovec> capped;
+  size_t                    total = 0;
+  for (int i = 0; i < iovcnt && total < (size_t)cap; i++) {
+    struct iovec vec = iov[i];
+    vec.iov_len = TMIN(vec.iov_len, (size_t)cap - total);
+    total += vec.iov_len;
+    capped.push_back(vec);
+  }
+
+  ssize_t nwritten = realWritev(fd, capped.data(), (int)capped.size());
+  if (nwritten >= 0 && (capped.size() < (size_t)iovcnt || capped.back().iov_len < iov[capped.size() - 1].iov_len)) {
+    nShortWrite++;
+  }
+  return nwritten;
+}
+
+TEST_F(TransBatchEnv, srvBatchSend) {
+  // the resps queued behind the first one, if not all of them, go out in one vectored write
+  sendBatch(10, 100);
+  ASSERT_GE(maxIovCnt.load(), 9);
+}
+
+TEST_F(TransBatchEnv, srvBatchPartialWrite) {
+  // each write of the batch stops in the middle of a resp, and the rest is written from there
+  writeCap = 4000;
+  sendBatch(10, 32 * 1024);
+  ASSERT_GE(maxIovCnt.load(), 9);
+  ASSERT_GT(nShortWrite.load(), 0);
+}
+#endif
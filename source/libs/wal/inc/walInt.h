@@ -148,6 +148,7 @@ int walLoadMeta(SWal* pWal);
 int walSaveMeta(SWal* pWal);
 int walRemoveMeta(SWal* pWal);
 int walRollFileInfo(SWal* pWal);
+void walUpdateSyncedOffset(SWal* pWal);
 
 int walCheckAndRepairMeta(SWal* pWal);
 
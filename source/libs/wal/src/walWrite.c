@@ -19,6 +19,8 @@
 #include "tglobal.h"
 #include "walInt.h"
 
+static int32_t walFsyncImpl(SWal *pWal, bool forceFsync);
+
 int32_t walRestoreFromSnapshot(SWal *pWal, int64_t ver) {
   taosThreadMutexLock(&pWal->mutex);
 
@@ -398,6 +400,15 @@ END:
 
 int32_t walRollImpl(SWal *pWal) {
   int32_t code = 0;
+
+  // entries not covered by a group fsync yet are in the files to be closed
+  if (pWal->cfg.level == TAOS_WAL_FSYNC && pWal->cfg.fsyncPeriod == 0) {
+    code = walFsyncImpl(pWal, true);
+    if (code != 0) {
+      goto END;
+    }
+  }
+
   if (pWal->pIdxFile != NULL) {
     code = taosCloseFile(&pWal->pIdxFile);
     if (code != 0) {
@@ -507,15 +518,9 @@ static FORCE_INLINE int32_t walWriteImpl(SWal *pWal, int64_t index, tmsg_t msgTy
     goto END;
   }
 
-  if (taosWriteFile(pWal->pLogFile, &pWal->writeHead, sizeof(SWalCkHead)) != sizeof(SWalCkHead)) {
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    wError("vgId:%d, file:%" PRId64 ".log, failed to write since %s", pWal->cfg.vgId, walGetLastFileFirstVer(pWal),
-           strerror(errno));
-    code = -1;
-    goto END;
-  }
-
-  if (taosWriteFile(pWal->pLogFile, (char *)body, bodyLen) != bodyLen) {
+  // head and body in one syscall
+  TdFileIoVec iov[2] = {{.buf = &pWal->writeHead, .len = sizeof(SWalCkHead)}, {.buf = body, .len = bodyLen}};
+  if (taosWritevFile(pWal->pLogFile, iov, 2) != (int64_t)sizeof(SWalCkHead) + bodyLen) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     wError("vgId:%d, file:%" PRId64 ".log, failed to write since %s", pWal->cfg.vgId, walGetLastFileFirstVer(pWal),
            strerror(errno));
@@ -634,17 +639,45 @@ int32_t walWrite(SWal *pWal, int64_t index, tmsg_t msgType, const void *body, in
   return walWriteWithSyncInfo(pWal, index, msgType, syncMeta, body, bodyLen);
 }
 
-void walFsync(SWal *pWal, bool forceFsync) {
-  if (forceFsync || (pWal->cfg.level == TAOS_WAL_FSYNC && pWal->cfg.fsyncPeriod == 0)) {
-    wTrace("vgId:%d, fileId:%" PRId64 ".idx, do fsync", pWal->cfg.vgId, walGetCurFileFirstVer(pWal));
-    if (taosFsyncFile(pWal->pIdxFile) < 0) {
-      wError("vgId:%d, file:%" PRId64 ".idx, fsync failed since %s", pWal->cfg.vgId, walGetCurFileFirstVer(pWal),
-             strerror(errno));
-    }
-    wTrace("vgId:%d, fileId:%" PRId64 ".log, do fsync", pWal->cfg.vgId, walGetCurFileFirstVer(pWal));
-    if (taosFsyncFile(pWal->pLogFile) < 0) {
-      wError("vgId:%d, file:%" PRId64 ".log, fsync failed since %s", pWal->cfg.vgId, walGetCurFileFirstVer(pWal),
-             strerror(errno));
-    }
+static int32_t walFsyncImpl(SWal *pWal, bool forceFsync) {
+  if (!forceFsync && (pWal->cfg.level != TAOS_WAL_FSYNC || pWal->cfg.fsyncPeriod != 0)) {
+    return 0;
+  }
+
+  if (pWal->pIdxFile == NULL || pWal->pLogFile == NULL) {
+    return 0;
   }
+
+  // all entries written since the last fsync are covered by this one
+  SWalFileInfo *pFileInfo = walGetCurFileInfo(pWal);
+  if (pFileInfo == NULL || pFileInfo->syncedOffset == pFileInfo->fileSize) {
+    return 0;
+  }
+
+  wTrace("vgId:%d, fileId:%" PRId64 ".idx, do fsync", pWal->cfg.vgId, walGetCurFileFirstVer(pWal));
+  if (taosFdatasyncFile(pWal->pIdxFile) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%" PRId64 ".idx, fsync failed since %s", pWal->cfg.vgId, walGetCurFileFirstVer(pWal),
+           strerror(errno));
+    return -1;
+  }
+  wTrace("vgId:%d, fileId:%" PRId64 ".log, do fsync", pWal->cfg.vgId, walGetCurFileFirstVer(pWal));
+  if (taosFdatasyncFile(pWal->pLogFile) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%" PRId64 ".log, fsync failed since %s", pWal->cfg.vgId, walGetCurFileFirstVer(pWal),
+           strerror(errno));
+    return -1;
+  }
+
+  walUpdateSyncedOffset(pWal);
+  return 0;
+}
+
+// Group commit: entries of a group are appended by walAppendLog without fsync, and the caller syncs the whole group
+// by one walFsync before acknowledging any of them.
+int32_t walFsync(SWal *pWal, bool forceFsync) {
+  taosThreadMutexLock(&pWal->mutex);
+  int32_t code = walFsyncImpl(pWal, forceFsync);
+  taosThreadMutexUnlock(&pWal->mutex);
+  return code;
 }
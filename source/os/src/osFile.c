@@ -32,6 +32,7 @@
 #include <sys/sendfile.h>
 #endif
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define LINUX_FILE_NO_TEXT_OPTION 0
 #define O_TEXT                    LINUX_FILE_NO_TEXT_OPTION
@@ -515,6 +516,146 @@ int64_t taosPWriteFile(TdFilePtr pFile, const void *buf, int64_t count, int64_t
   return ret;
 }
 
+#define TD_FILE_MAX_IOV 64
+
+// write all buffers at the current file position with as few syscalls as possible
+int64_t taosWritevFile(TdFilePtr pFile, const TdFileIoVec *iov, int32_t iovcnt) {
+  if (pFile == NULL) {
+    return 0;
+  }
+#if FILE_WITH_LOCK
+  taosThreadRwlockWrlock(&(pFile->rwlock));
+#endif
+  assert(pFile->fd >= 0);  // Please check if you have closed the file.
+
+  int64_t total = 0;
+#ifdef WINDOWS
+  for (int32_t i = 0; i < iovcnt; i++) {
+    const char *tbuf = (const char *)iov[i].buf;
+    int64_t     nleft = iov[i].len;
+    while (nleft > 0) {
+      int64_t nwritten = _write(pFile->fd, tbuf, (uint32_t)nleft);
+      if (nwritten < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        total = -1;
+        goto _exit;
+      }
+      nleft -= nwritten;
+      tbuf += nwritten;
+      total += nwritten;
+    }
+  }
+_exit:
+#else
+  struct iovec vec[TD_FILE_MAX_IOV];
+  int32_t      i = 0;
+  int64_t      offset = 0;  // written bytes of iov[i]
+  while (i < iovcnt) {
+    int32_t n = 0;
+    for (int32_t j = i; j < iovcnt && n < TD_FILE_MAX_IOV; j++, n++) {
+      int64_t skip = (j == i) ? offset : 0;
+      vec[n].iov_base = (char *)iov[j].buf + skip;
+      vec[n].iov_len = iov[j].len - skip;
+    }
+
+    int64_t nwritten = writev(pFile->fd, vec, n);
+    if (nwritten < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      total = -1;
+      break;
+    }
+    total += nwritten;
+
+    // skip the buffers written, a short write resumes from the middle of iov[i]
+    while (i < iovcnt && nwritten >= iov[i].len - offset) {
+      nwritten -= iov[i].len - offset;
+      offset = 0;
+      i++;
+    }
+    offset += nwritten;
+  }
+#endif
+
+#if FILE_WITH_LOCK
+  taosThreadRwlockUnlock(&(pFile->rwlock));
+#endif
+  return total;
+}
+
+// write all buffers at the offset with as few syscalls as possible, the file position is not changed
+int64_t taosPWritevFile(TdFilePtr pFile, const TdFileIoVec *iov, int32_t iovcnt, int64_t offset) {
+  if (pFile == NULL) {
+    return 0;
+  }
+#if FILE_WITH_LOCK
+  taosThreadRwlockWrlock(&(pFile->rwlock));
+#endif
+  assert(pFile->fd >= 0);  // Please check if you have closed the file.
+
+  int64_t total = 0;
+#ifdef WINDOWS
+  size_t pos = _lseeki64(pFile->fd, 0, SEEK_CUR);
+  _lseeki64(pFile->fd, offset, SEEK_SET);
+  for (int32_t i = 0; i < iovcnt; i++) {
+    const char *tbuf = (const char *)iov[i].buf;
+    int64_t     nleft = iov[i].len;
+    while (nleft > 0) {
+      int64_t nwritten = _write(pFile->fd, tbuf, (uint32_t)nleft);
+      if (nwritten < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        total = -1;
+        goto _exit;
+      }
+      nleft -= nwritten;
+      tbuf += nwritten;
+      total += nwritten;
+    }
+  }
+_exit:
+  _lseeki64(pFile->fd, pos, SEEK_SET);
+#else
+  struct iovec vec[TD_FILE_MAX_IOV];
+  int32_t      i = 0;
+  int64_t      skipped = 0;  // written bytes of iov[i]
+  while (i < iovcnt) {
+    int32_t n = 0;
+    for (int32_t j = i; j < iovcnt && n < TD_FILE_MAX_IOV; j++, n++) {
+      int64_t skip = (j == i) ? skipped : 0;
+      vec[n].iov_base = (char *)iov[j].buf + skip;
+      vec[n].iov_len = iov[j].len - skip;
+    }
+
+    int64_t nwritten = pwritev(pFile->fd, vec, n, offset + total);
+    if (nwritten < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      total = -1;
+      break;
+    }
+    total += nwritten;
+
+    while (i < iovcnt && nwritten >= iov[i].len - skipped) {
+      nwritten -= iov[i].len - skipped;
+      skipped = 0;
+      i++;
+    }
+    skipped += nwritten;
+  }
+#endif
+
+#if FILE_WITH_LOCK
+  taosThreadRwlockUnlock(&(pFile->rwlock));
+#endif
+  return total;
+}
+
 int64_t taosLSeekFile(TdFilePtr pFile, int64_t offset, int32_t whence) {
 #if FILE_WITH_LOCK
   taosThreadRwlockRdlock(&(pFile->rwlock));
@@ -657,6 +798,26 @@ int32_t taosFsyncFile(TdFilePtr pFile) {
   return 0;
 }
 
+// flush the data and the metadata needed to read it back, e.g. the file size, but not the timestamps
+int32_t taosFdatasyncFile(TdFilePtr pFile) {
+  if (pFile == NULL) {
+    return 0;
+  }
+
+  if (pFile->fp != NULL) return fflush(pFile->fp);
+  if (pFile->fd >= 0) {
+#ifdef WINDOWS
+    HANDLE h = (HANDLE)_get_osfhandle(pFile->fd);
+    return !FlushFileBuffers(h);
+#elif defined(_TD_DARWIN_64)
+    return fsync(pFile->fd);
+#else
+    return fdatasync(pFile->fd);
+#endif
+  }
+  return 0;
+}
+
 int64_t taosFSendFile(TdFilePtr pFileOut, TdFilePtr pFileIn, int64_t *offset, int64_t size) {
   if (pFileOut == NULL || pFileIn == NULL) {
     return 0;
@@ -51,6 +51,7 @@
 #include "tcompression.h"
 #include "lz4.h"
 #include "tRealloc.h"
+#include "tencode.h"
 #include "tlog.h"
 
 #ifdef TD_TSZ
@@ -61,6 +62,8 @@ static const int32_t TEST_NUMBER = 1;
 #define is_bigendian()     ((*(char *)&TEST_NUMBER) == 0)
 #define SIMPLE8B_MAX_INT64 ((uint64_t)1152921504606846974LL)
 
+#define TS_DECOMPRESS_BATCH_SIZE 512  // timestamps decoded per batch, must be even
+
 #define safeInt64Add(a, b)  (((a >= 0) && (b <= INT64_MAX - a)) || ((a < 0) && (b >= INT64_MIN - a)))
 #define ZIGZAG_ENCODE(T, v) (((u##T)((v) >> (sizeof(T) * 8 - 1))) ^ (((u##T)(v)) << 1))  // zigzag encode
 #define ZIGZAG_DECODE(T, v) (((v) >> 1) ^ -((T)((v)&1)))                                 // zigzag decode
@@ -227,6 +230,141 @@ int32_t tsCompressINTImp(const char *const input, const int32_t nelements, char
   return opos;
 }
 
+static const uint64_t LE_BYTES_MASK[] = {0x0ul,
+                                         0xfful,
+                                         0xfffful,
+                                         0xfffffful,
+                                         0xfffffffful,
+                                         0xfffffffffful,
+                                         0xfffffffffffful,
+                                         0xfffffffffffffful,
+                                         0xfffffffffffffffful};
+
+// Load nbytes (0~8) little endian bytes at input + pos. A whole word is loaded and masked when it still lies inside
+// the ninput bytes of input, which saves the branchy variable length copy on the hot path.
+static FORCE_INLINE uint64_t tsLoadLEBytes(const char *const input, int32_t pos, int32_t ninput, int32_t nbytes) {
+  uint64_t v = 0;
+  if (pos + LONG_BYTES <= ninput) {
+    memcpy(&v, input + pos, LONG_BYTES);
+    return v & LE_BYTES_MASK[nbytes];
+  }
+
+  memcpy(&v, input + pos, nbytes);
+  return v;
+}
+
+#if __AVX2__
+// Unpack the zigzag-decoded diffs of one simple8b word four lanes at a time, return the number of diffs unpacked.
+static int32_t tsSimple8BUnpackAVX2(uint64_t w, int32_t bit, int32_t elems, int64_t *diffs) {
+  int32_t rounds = elems / 4;
+  __m256i word = _mm256_set1_epi64x((int64_t)w);
+  __m256i mask = _mm256_set1_epi64x((int64_t)INT64MASK(bit));
+  __m256i one = _mm256_set1_epi64x(1);
+  __m256i zero = _mm256_setzero_si256();
+  __m256i shift = _mm256_setr_epi64x(4, 4 + bit, 4 + 2 * bit, 4 + 3 * bit);
+  __m256i step = _mm256_set1_epi64x(4 * bit);
+
+  for (int32_t i = 0; i < rounds; ++i) {
+    __m256i zz = _mm256_and_si256(_mm256_srlv_epi64(word, shift), mask);
+    __m256i v = _mm256_xor_si256(_mm256_srli_epi64(zz, 1), _mm256_sub_epi64(zero, _mm256_and_si256(zz, one)));
+    _mm256_storeu_si256((__m256i *)(diffs + i * 4), v);
+    shift = _mm256_add_epi64(shift, step);
+  }
+
+  return rounds * 4;
+}
+
+// In-place inclusive prefix sum seeded with *prev, four lanes at a time. Return the number of values summed.
+static int32_t tsPrefixSumI64AVX2(int64_t *data, int32_t num, int64_t *prev) {
+  int32_t rounds = num / 4;
+  __m256i zero = _mm256_setzero_si256();
+  __m256i carry = _mm256_set1_epi64x(*prev);
+
+  for (int32_t i = 0; i < rounds; ++i) {
+    __m256i v = _mm256_loadu_si256((__m256i *)(data + i * 4));
+    // [a, b, c, d] -> [a, a+b, b+c, c+d] -> [a, a+b, a+b+c, a+b+c+d]
+    v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, 0x90), zero, 0x03));
+    v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, 0x40), zero, 0x0F));
+    v = _mm256_add_epi64(v, carry);
+    _mm256_storeu_si256((__m256i *)(data + i * 4), v);
+    carry = _mm256_permute4x64_epi64(v, 0xFF);
+  }
+
+  if (rounds > 0) *prev = data[rounds * 4 - 1];
+  return rounds * 4;
+}
+#endif
+
+static FORCE_INLINE void tsPrefixSumI64(int64_t *data, int32_t num, int64_t *prev) {
+  int32_t i = 0;
+#if __AVX2__
+  if (tsAVX2Enable && tsSIMDBuiltins) {
+    i = tsPrefixSumI64AVX2(data, num, prev);
+  }
+#endif
+
+  int64_t sum = *prev;
+  for (; i < num; ++i) {
+    sum += data[i];
+    data[i] = sum;
+  }
+  *prev = sum;
+}
+
+#define SIMPLE8B_UNPACK_CASE(_selector, _bit)            \
+  case _selector:                                        \
+    for (; i < elems; ++i) {                             \
+      uint64_t zz = (w >> (4 + (_bit)*i)) & INT64MASK(_bit); \
+      diffs[i] = ZIGZAG_DECODE(int64_t, zz);             \
+    }                                                    \
+    break;
+
+// Unpack the first elems diffs of a simple8b word whose selector is 2~15, with the bit width a constant per case.
+static void tsSimple8BUnpack(uint64_t w, int32_t selector, int32_t elems, int64_t *diffs) {
+  int32_t i = 0;
+#if __AVX2__
+  if (tsAVX2Enable && tsSIMDBuiltins) {
+    static const int32_t bits[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+    i = tsSimple8BUnpackAVX2(w, bits[selector], elems, diffs);
+  }
+#endif
+
+  switch (selector) {
+    SIMPLE8B_UNPACK_CASE(2, 1)
+    SIMPLE8B_UNPACK_CASE(3, 2)
+    SIMPLE8B_UNPACK_CASE(4, 3)
+    SIMPLE8B_UNPACK_CASE(5, 4)
+    SIMPLE8B_UNPACK_CASE(6, 5)
+    SIMPLE8B_UNPACK_CASE(7, 6)
+    SIMPLE8B_UNPACK_CASE(8, 7)
+    SIMPLE8B_UNPACK_CASE(9, 8)
+    SIMPLE8B_UNPACK_CASE(10, 10)
+    SIMPLE8B_UNPACK_CASE(11, 12)
+    SIMPLE8B_UNPACK_CASE(12, 15)
+    SIMPLE8B_UNPACK_CASE(13, 20)
+    SIMPLE8B_UNPACK_CASE(14, 30)
+    SIMPLE8B_UNPACK_CASE(15, 60)
+    default:
+      break;
+  }
+}
+
+#define SIMPLE8B_PUT_VALUES(T, _output, _pos, _values, _num) \
+  do {                                                       \
+    T *_p = (T *)(_output) + (_pos);                         \
+    for (int32_t _i = 0; _i < (_num); ++_i) {                \
+      _p[_i] = (T)(_values)[_i];                             \
+    }                                                        \
+  } while (0)
+
+#define SIMPLE8B_FILL_VALUE(T, _output, _pos, _value, _num) \
+  do {                                                      \
+    T *_p = (T *)(_output) + (_pos);                        \
+    for (int32_t _i = 0; _i < (_num); ++_i) {               \
+      _p[_i] = (T)(_value);                                 \
+    }                                                       \
+  } while (0)
+
 int32_t tsDecompressINTImp(const char *const input, const int32_t nelements, char *const output, const char type) {
   int32_t word_length = 0;
   switch (type) {
@@ -255,61 +393,286 @@ int32_t tsDecompressINTImp(const char *const input, const int32_t nelements, cha
 
   // Selector value:              0    1   2   3   4   5   6   7   8  9  10  11
   // 12  13  14  15
-  char    bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
   int32_t selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
 
   const char *ip = input + 1;
   int32_t     count = 0;
-  int32_t     _pos = 0;
   int64_t     prev_value = 0;
+  int64_t     diffs[60];
 
-  while (1) {
-    if (count == nelements) break;
-
+  // Each word is unpacked into a diff buffer by a loop specialized on its selector, the diffs are then prefix
+  // summed and stored with a single type dispatch per word instead of per element.
+  while (count < nelements) {
     uint64_t w = 0;
     memcpy(&w, ip, LONG_BYTES);
+    ip += LONG_BYTES;
 
-    char    selector = (char)(w & INT64MASK(4));       // selector = 4
-    char    bit = bit_per_integer[(int32_t)selector];  // bit = 3
-    int32_t elems = selector_to_elems[(int32_t)selector];
-
-    for (int32_t i = 0; i < elems; i++) {
-      uint64_t zigzag_value;
+    int32_t selector = (int32_t)(w & INT64MASK(4));
+    int32_t elems = TMIN(selector_to_elems[selector], nelements - count);
 
-      if (selector == 0 || selector == 1) {
-        zigzag_value = 0;
-      } else {
-        zigzag_value = ((w >> (4 + bit * i)) & INT64MASK(bit));
+    if (selector == 0 || selector == 1) {
+      // a run of zero diffs, the previous value repeats
+      switch (type) {
+        case TSDB_DATA_TYPE_BIGINT:
+          SIMPLE8B_FILL_VALUE(int64_t, output, count, prev_value, elems);
+          break;
+        case TSDB_DATA_TYPE_INT:
+          SIMPLE8B_FILL_VALUE(int32_t, output, count, prev_value, elems);
+          break;
+        case TSDB_DATA_TYPE_SMALLINT:
+          SIMPLE8B_FILL_VALUE(int16_t, output, count, prev_value, elems);
+          break;
+        default:
+          SIMPLE8B_FILL_VALUE(int8_t, output, count, prev_value, elems);
+          break;
       }
-      int64_t diff = ZIGZAG_DECODE(int64_t, zigzag_value);
-      int64_t curr_value = diff + prev_value;
-      prev_value = curr_value;
+    } else {
+      tsSimple8BUnpack(w, selector, elems, diffs);
+      tsPrefixSumI64(diffs, elems, &prev_value);
 
       switch (type) {
         case TSDB_DATA_TYPE_BIGINT:
-          *((int64_t *)output + _pos) = (int64_t)curr_value;
-          _pos++;
+          memcpy((int64_t *)output + count, diffs, elems * LONG_BYTES);
           break;
         case TSDB_DATA_TYPE_INT:
-          *((int32_t *)output + _pos) = (int32_t)curr_value;
-          _pos++;
+          SIMPLE8B_PUT_VALUES(int32_t, output, count, diffs, elems);
           break;
         case TSDB_DATA_TYPE_SMALLINT:
-          *((int16_t *)output + _pos) = (int16_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_TINYINT:
-          *((int8_t *)output + _pos) = (int8_t)curr_value;
-          _pos++;
+          SIMPLE8B_PUT_VALUES(int16_t, output, count, diffs, elems);
           break;
         default:
-          perror("Wrong integer types.\n");
-          return -1;
+          SIMPLE8B_PUT_VALUES(int8_t, output, count, diffs, elems);
+          break;
       }
-      count++;
-      if (count == nelements) break;
     }
-    ip += LONG_BYTES;
+
+    count += elems;
+  }
+
+  return nelements * word_length;
+}
+
+/* ----------------------------------------------FOR and RLE Compression
+ * ---------------------------------------------- */
+// FOR: [indicator][int64 reference][uint8 bit width][bit packed value - reference, LSB first]
+// RLE: [indicator]{[value][u32v run length]}...
+// Both fall back to the raw values with indicator 1 when the encoding is not smaller.
+#define FOR_MAX_BIT_WIDTH 56  // keeps a value plus its bit shift inside one 64-bit load
+#define FOR_HEADER_SIZE   (1 + LONG_BYTES + 1)
+
+static int32_t tsIntTypeBytes(const char type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BIGINT:
+      return LONG_BYTES;
+    case TSDB_DATA_TYPE_INT:
+      return INT_BYTES;
+    case TSDB_DATA_TYPE_SMALLINT:
+      return SHORT_BYTES;
+    case TSDB_DATA_TYPE_TINYINT:
+      return CHAR_BYTES;
+    default:
+      return 0;
+  }
+}
+
+static FORCE_INLINE int64_t tsGetIntValue(const char *const input, int32_t word_length, int32_t i) {
+  switch (word_length) {
+    case LONG_BYTES:
+      return ((int64_t *)input)[i];
+    case INT_BYTES:
+      return ((int32_t *)input)[i];
+    case SHORT_BYTES:
+      return ((int16_t *)input)[i];
+    default:
+      return ((int8_t *)input)[i];
+  }
+}
+
+int32_t tsCompressFORImp(const char *const input, const int32_t nelements, char *const output, const char type) {
+  int32_t word_length = tsIntTypeBytes(type);
+  if (word_length == 0) {
+    uError("Invalid compress integer type:%d", type);
+    return -1;
+  }
+
+  int32_t byte_limit = nelements * word_length + 1;
+  int64_t min = INT64_MAX;
+  int64_t max = INT64_MIN;
+  for (int32_t i = 0; i < nelements; i++) {
+    int64_t v = tsGetIntValue(input, word_length, i);
+    if (v < min) min = v;
+    if (v > max) max = v;
+  }
+
+  uint64_t range = (nelements > 0) ? ((uint64_t)max - (uint64_t)min) : 0;
+  int32_t  width = range ? (LONG_BYTES * BITS_PER_BYTE - BUILDIN_CLZL(range)) : 0;
+  int32_t  packed_size = (int32_t)(((int64_t)nelements * width + BITS_PER_BYTE - 1) / BITS_PER_BYTE);
+
+  if (width > FOR_MAX_BIT_WIDTH || FOR_HEADER_SIZE + packed_size >= byte_limit) {
+    output[0] = 1;
+    memcpy(output + 1, input, byte_limit - 1);
+    return byte_limit;
+  }
+
+  output[0] = 0;
+  memcpy(output + 1, &min, LONG_BYTES);
+  output[1 + LONG_BYTES] = (char)width;
+
+  char *packed = output + FOR_HEADER_SIZE;
+  memset(packed, 0, packed_size);
+  if (width > 0) {
+    int64_t bit_pos = 0;
+    for (int32_t i = 0; i < nelements; i++) {
+      uint64_t delta = (uint64_t)tsGetIntValue(input, word_length, i) - (uint64_t)min;
+      int32_t  pos = (int32_t)(bit_pos / BITS_PER_BYTE);
+      int32_t  nbytes = TMIN(LONG_BYTES, packed_size - pos);
+      uint64_t w = 0;
+
+      memcpy(&w, packed + pos, nbytes);
+      w |= delta << (bit_pos % BITS_PER_BYTE);
+      memcpy(packed + pos, &w, nbytes);
+      bit_pos += width;
+    }
+  }
+
+  return FOR_HEADER_SIZE + packed_size;
+}
+
+#define FOR_UNPACK_VALUES(T)                                                                              \
+  do {                                                                                                    \
+    T *ostream = (T *)output;                                                                             \
+    for (int32_t i = 0; i < nelements; i++) {                                                             \
+      int64_t  bit_pos = (int64_t)i * width;                                                              \
+      int32_t  pos = (int32_t)(bit_pos / BITS_PER_BYTE);                                                  \
+      uint64_t w = tsLoadLEBytes(packed, pos, packed_size, TMIN(LONG_BYTES, packed_size - pos));          \
+      ostream[i] = (T)(min + (int64_t)((w >> (bit_pos % BITS_PER_BYTE)) & mask));                         \
+    }                                                                                                     \
+  } while (0)
+
+int32_t tsDecompressFORImp(const char *const input, const int32_t nelements, char *const output, const char type) {
+  int32_t word_length = tsIntTypeBytes(type);
+  if (word_length == 0) {
+    uError("Invalid decompress integer type:%d", type);
+    return -1;
+  }
+
+  if (input[0] == 1) {
+    memcpy(output, input + 1, nelements * word_length);
+    return nelements * word_length;
+  }
+
+  int64_t min = 0;
+  memcpy(&min, input + 1, LONG_BYTES);
+  int32_t width = (uint8_t)input[1 + LONG_BYTES];
+  if (width > FOR_MAX_BIT_WIDTH) {
+    uError("Invalid FOR bit width:%d", width);
+    return -1;
+  }
+
+  const char *packed = input + FOR_HEADER_SIZE;
+  int32_t     packed_size = (int32_t)(((int64_t)nelements * width + BITS_PER_BYTE - 1) / BITS_PER_BYTE);
+  uint64_t    mask = INT64MASK(width);
+
+  switch (word_length) {
+    case LONG_BYTES:
+      FOR_UNPACK_VALUES(int64_t);
+      break;
+    case INT_BYTES:
+      FOR_UNPACK_VALUES(int32_t);
+      break;
+    case SHORT_BYTES:
+      FOR_UNPACK_VALUES(int16_t);
+      break;
+    default:
+      FOR_UNPACK_VALUES(int8_t);
+      break;
+  }
+
+  return nelements * word_length;
+}
+
+int32_t tsCompressRLEImp(const char *const input, const int32_t nelements, char *const output, const char type) {
+  int32_t word_length = tsIntTypeBytes(type);
+  if (word_length == 0) {
+    uError("Invalid compress integer type:%d", type);
+    return -1;
+  }
+
+  int32_t byte_limit = nelements * word_length + 1;
+  int32_t opos = 1;
+
+  for (int32_t i = 0; i < nelements;) {
+    int32_t j = i + 1;
+    while (j < nelements && memcmp(input + j * word_length, input + i * word_length, word_length) == 0) j++;
+
+    uint32_t run = j - i;
+    if (opos + word_length + tPutU32v(NULL, run) >= byte_limit) {
+      output[0] = 1;
+      memcpy(output + 1, input, byte_limit - 1);
+      return byte_limit;
+    }
+
+    memcpy(output + opos, input + i * word_length, word_length);
+    opos += word_length;
+    opos += tPutU32v((uint8_t *)output + opos, run);
+    i = j;
+  }
+
+  output[0] = 0;
+  return opos;
+}
+
+#define RLE_FILL_VALUES(T)                               \
+  do {                                                   \
+    T v;                                                 \
+    memcpy(&v, input + ipos, sizeof(T));                 \
+    T *ostream = (T *)output + count;                    \
+    for (uint32_t i = 0; i < run; i++) ostream[i] = v;   \
+  } while (0)
+
+int32_t tsDecompressRLEImp(const char *const input, int32_t ninput, const int32_t nelements, char *const output,
+                           const char type) {
+  int32_t word_length = tsIntTypeBytes(type);
+  if (word_length == 0) {
+    uError("Invalid decompress integer type:%d", type);
+    return -1;
+  }
+
+  if (input[0] == 1) {
+    memcpy(output, input + 1, nelements * word_length);
+    return nelements * word_length;
+  }
+
+  int32_t ipos = 1;
+  int32_t count = 0;
+  while (count < nelements) {
+    uint32_t run = 0;
+    if (ipos + word_length >= ninput) break;
+    int32_t n = tGetU32v((uint8_t *)input + ipos + word_length, &run);
+    if (run == 0 || run > (uint32_t)(nelements - count)) break;
+
+    switch (word_length) {
+      case LONG_BYTES:
+        RLE_FILL_VALUES(int64_t);
+        break;
+      case INT_BYTES:
+        RLE_FILL_VALUES(int32_t);
+        break;
+      case SHORT_BYTES:
+        RLE_FILL_VALUES(int16_t);
+        break;
+      default:
+        RLE_FILL_VALUES(int8_t);
+        break;
+    }
+
+    ipos += word_length + n;
+    count += run;
+  }
+
+  if (count != nelements) {
+    uError("Invalid RLE data, decoded:%d expected:%d", count, nelements);
+    return -1;
   }
 
   return nelements * word_length;
@@ -564,7 +927,7 @@ _exit_over:
   return nelements * LONG_BYTES + 1;
 }
 
-int32_t tsDecompressTimestampImp(const char *const input, const int32_t nelements, char *const output) {
+int32_t tsDecompressTimestampImp(const char *const input, int32_t ninput, const int32_t nelements, char *const output) {
   ASSERTS(nelements >= 0, "nelements is negative");
   if (nelements == 0) return 0;
 
@@ -576,58 +939,46 @@ int32_t tsDecompressTimestampImp(const char *const input, const int32_t nelement
 
     int32_t ipos = 1, opos = 0;
     int8_t  nbytes = 0;
+    uint8_t flags = 0;
     int64_t prev_value = 0;
     int64_t prev_delta = 0;
-    int64_t delta_of_delta = 0;
-
-    while (1) {
-      uint8_t flags = input[ipos++];
-      // Decode dd1
-      uint64_t dd1 = 0;
-      nbytes = flags & INT8MASK(4);
-      if (nbytes == 0) {
-        delta_of_delta = 0;
-      } else {
-        if (is_bigendian()) {
-          memcpy(((char *)(&dd1)) + LONG_BYTES - nbytes, input + ipos, nbytes);
-        } else {
-          memcpy(&dd1, input + ipos, nbytes);
-        }
-        delta_of_delta = ZIGZAG_DECODE(int64_t, dd1);
-      }
-      ipos += nbytes;
-      if (opos == 0) {
-        prev_value = delta_of_delta;
-        prev_delta = 0;
-        ostream[opos++] = delta_of_delta;
-      } else {
-        prev_delta = delta_of_delta + prev_delta;
-        prev_value = prev_value + prev_delta;
-        ostream[opos++] = prev_value;
-      }
-      if (opos == nelements) return nelements * LONG_BYTES;
+    bool    bigEndian = is_bigendian();
 
-      // Decode dd2
-      uint64_t dd2 = 0;
-      nbytes = (flags >> 4) & INT8MASK(4);
-      if (nbytes == 0) {
-        delta_of_delta = 0;
-      } else {
-        if (is_bigendian()) {
-          memcpy(((char *)(&dd2)) + LONG_BYTES - nbytes, input + ipos, nbytes);
-        } else {
-          memcpy(&dd2, input + ipos, nbytes);
+    // The delta-of-deltas of a batch are unpacked into the output first, then turned into deltas and values by two
+    // prefix sums. The batch size is even so that a flags byte never straddles two batches.
+    while (opos < nelements) {
+      int64_t *batch = ostream + opos;
+      int32_t  num = TMIN(nelements - opos, TS_DECOMPRESS_BATCH_SIZE);
+
+      for (int32_t i = 0; i < num; ++i) {
+        if (i % 2 == 0) {
+          flags = input[ipos++];
+        }
+        nbytes = flags & INT8MASK(4);
+        flags >>= 4;
+
+        uint64_t dd = 0;
+        if (!bigEndian) {
+          dd = tsLoadLEBytes(input, ipos, ninput, TMIN(nbytes, LONG_BYTES));
+        } else if (nbytes) {
+          memcpy(((char *)(&dd)) + LONG_BYTES - nbytes, input + ipos, nbytes);
         }
+        ipos += nbytes;
         // zigzag_decoding
-        delta_of_delta = ZIGZAG_DECODE(int64_t, dd2);
+        batch[i] = ZIGZAG_DECODE(int64_t, dd);
       }
-      ipos += nbytes;
-      prev_delta = delta_of_delta + prev_delta;
-      prev_value = prev_value + prev_delta;
-      ostream[opos++] = prev_value;
-      if (opos == nelements) return nelements * LONG_BYTES;
+
+      if (opos == 0) {
+        // the first value is stored as is
+        prev_value = batch[0];
+        batch[0] = 0;
+      }
+      tsPrefixSumI64(batch, num, &prev_delta);
+      tsPrefixSumI64(batch, num, &prev_value);
+      opos += num;
     }
 
+    return nelements * LONG_BYTES;
   } else {
     ASSERT(0);
     return -1;
@@ -743,7 +1094,15 @@ uint64_t decodeDoubleValue(const char *const input, int32_t *const ipos, uint8_t
   return diff;
 }
 
-int32_t tsDecompressDoubleImp(const char *const input, const int32_t nelements, char *const output) {
+static FORCE_INLINE uint64_t decodeDoubleValueLE(const char *const input, int32_t *const ipos, int32_t ninput,
+                                                 uint8_t flag) {
+  int32_t  nbytes = (flag & INT8MASK(3)) + 1;
+  uint64_t diff = tsLoadLEBytes(input, *ipos, ninput, nbytes);
+  *ipos += nbytes;
+  return diff << ((LONG_BYTES * BITS_PER_BYTE - nbytes * BITS_PER_BYTE) * (flag >> 3));
+}
+
+int32_t tsDecompressDoubleImp(const char *const input, int32_t ninput, const int32_t nelements, char *const output) {
   // output stream
   double *ostream = (double *)output;
 
@@ -757,6 +1116,21 @@ int32_t tsDecompressDoubleImp(const char *const input, const int32_t nelements,
   int32_t  opos = 0;
   uint64_t prev_value = 0;
 
+  if (!is_bigendian()) {
+    // the diff bytes are stored least significant first, so they load straight into a word on little endian
+    uint64_t *obits = (uint64_t *)output;
+    for (int32_t i = 0; i < nelements; i++) {
+      if (i % 2 == 0) {
+        flags = input[ipos++];
+      }
+      prev_value ^= decodeDoubleValueLE(input, &ipos, ninput, flags & INT8MASK(4));
+      flags >>= 4;
+      obits[i] = prev_value;
+    }
+
+    return nelements * DOUBLE_BYTES;
+  }
+
   for (int32_t i = 0; i < nelements; i++) {
     if (i % 2 == 0) {
       flags = input[ipos++];
@@ -890,7 +1264,15 @@ uint32_t decodeFloatValue(const char *const input, int32_t *const ipos, uint8_t
   return diff;
 }
 
-int32_t tsDecompressFloatImp(const char *const input, const int32_t nelements, char *const output) {
+static FORCE_INLINE uint32_t decodeFloatValueLE(const char *const input, int32_t *const ipos, int32_t ninput,
+                                                uint8_t flag) {
+  int32_t  nbytes = (flag & INT8MASK(3)) + 1;
+  uint32_t diff = (uint32_t)tsLoadLEBytes(input, *ipos, ninput, TMIN(nbytes, FLOAT_BYTES));
+  *ipos += nbytes;
+  return diff << ((FLOAT_BYTES * BITS_PER_BYTE - nbytes * BITS_PER_BYTE) * (flag >> 3));
+}
+
+int32_t tsDecompressFloatImp(const char *const input, int32_t ninput, const int32_t nelements, char *const output) {
   float *ostream = (float *)output;
 
   if (input[0] == 1) {
@@ -903,6 +1285,20 @@ int32_t tsDecompressFloatImp(const char *const input, const int32_t nelements, c
   int32_t  opos = 0;
   uint32_t prev_value = 0;
 
+  if (!is_bigendian()) {
+    uint32_t *obits = (uint32_t *)output;
+    for (int32_t i = 0; i < nelements; i++) {
+      if (i % 2 == 0) {
+        flags = input[ipos++];
+      }
+      prev_value ^= decodeFloatValueLE(input, &ipos, ninput, flags & INT8MASK(4));
+      flags >>= 4;
+      obits[i] = prev_value;
+    }
+
+    return nelements * FLOAT_BYTES;
+  }
+
   for (int32_t i = 0; i < nelements; i++) {
     if (i % 2 == 0) {
       flags = input[ipos++];
@@ -2154,10 +2550,11 @@ int32_t tsCompressTimestamp(void *pIn, int32_t nIn, int32_t nEle, void *pOut, in
 int32_t tsDecompressTimestamp(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int32_t nOut, uint8_t cmprAlg,
                               void *pBuf, int32_t nBuf) {
   if (cmprAlg == ONE_STAGE_COMP) {
-    return tsDecompressTimestampImp(pIn, nEle, pOut);
+    return tsDecompressTimestampImp(pIn, nIn, nEle, pOut);
   } else if (cmprAlg == TWO_STAGE_COMP) {
-    if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
-    return tsDecompressTimestampImp(pBuf, nEle, pOut);
+    int32_t len = tsDecompressStringImp(pIn, nIn, pBuf, nBuf);
+    if (len < 0) return -1;
+    return tsDecompressTimestampImp(pBuf, len, nEle, pOut);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2198,10 +2595,11 @@ int32_t tsDecompressFloat(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int3
 #endif
     // decompress lossless
     if (cmprAlg == ONE_STAGE_COMP) {
-      return tsDecompressFloatImp(pIn, nEle, pOut);
+      return tsDecompressFloatImp(pIn, nIn, nEle, pOut);
     } else if (cmprAlg == TWO_STAGE_COMP) {
-      if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
-      return tsDecompressFloatImp(pBuf, nEle, pOut);
+      int32_t len = tsDecompressStringImp(pIn, nIn, pBuf, nBuf);
+      if (len < 0) return -1;
+      return tsDecompressFloatImp(pBuf, len, nEle, pOut);
     } else {
       ASSERTS(0, "compress algo invalid");
       return -1;
@@ -2245,10 +2643,11 @@ int32_t tsDecompressDouble(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int
 #endif
     // decompress lossless
     if (cmprAlg == ONE_STAGE_COMP) {
-      return tsDecompressDoubleImp(pIn, nEle, pOut);
+      return tsDecompressDoubleImp(pIn, nIn, nEle, pOut);
     } else if (cmprAlg == TWO_STAGE_COMP) {
-      if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
-      return tsDecompressDoubleImp(pBuf, nEle, pOut);
+      int32_t len = tsDecompressStringImp(pIn, nIn, pBuf, nBuf);
+      if (len < 0) return -1;
+      return tsDecompressDoubleImp(pBuf, len, nEle, pOut);
     } else {
       ASSERTS(0, "compress algo invalid");
       return -1;
@@ -2307,6 +2706,10 @@ int32_t tsCompressTinyint(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int3
   } else if (cmprAlg == TWO_STAGE_COMP) {
     int32_t len = tsCompressINTImp(pIn, nEle, pBuf, TSDB_DATA_TYPE_TINYINT);
     return tsCompressStringImp(pBuf, len, pOut, nOut);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsCompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_TINYINT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsCompressRLEImp(pIn, nEle, pOut, TSDB_DATA_TYPE_TINYINT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2320,6 +2723,10 @@ int32_t tsDecompressTinyint(void *pIn, int32_t nIn, int32_t nEle, void *pOut, in
   } else if (cmprAlg == TWO_STAGE_COMP) {
     if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
     return tsDecompressINTImp(pBuf, nEle, pOut, TSDB_DATA_TYPE_TINYINT);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsDecompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_TINYINT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsDecompressRLEImp(pIn, nIn, nEle, pOut, TSDB_DATA_TYPE_TINYINT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2334,6 +2741,10 @@ int32_t tsCompressSmallint(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int
   } else if (cmprAlg == TWO_STAGE_COMP) {
     int32_t len = tsCompressINTImp(pIn, nEle, pBuf, TSDB_DATA_TYPE_SMALLINT);
     return tsCompressStringImp(pBuf, len, pOut, nOut);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsCompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_SMALLINT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsCompressRLEImp(pIn, nEle, pOut, TSDB_DATA_TYPE_SMALLINT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2347,6 +2758,10 @@ int32_t tsDecompressSmallint(void *pIn, int32_t nIn, int32_t nEle, void *pOut, i
   } else if (cmprAlg == TWO_STAGE_COMP) {
     if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
     return tsDecompressINTImp(pBuf, nEle, pOut, TSDB_DATA_TYPE_SMALLINT);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsDecompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_SMALLINT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsDecompressRLEImp(pIn, nIn, nEle, pOut, TSDB_DATA_TYPE_SMALLINT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2361,6 +2776,10 @@ int32_t tsCompressInt(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int32_t
   } else if (cmprAlg == TWO_STAGE_COMP) {
     int32_t len = tsCompressINTImp(pIn, nEle, pBuf, TSDB_DATA_TYPE_INT);
     return tsCompressStringImp(pBuf, len, pOut, nOut);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsCompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_INT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsCompressRLEImp(pIn, nEle, pOut, TSDB_DATA_TYPE_INT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2374,6 +2793,10 @@ int32_t tsDecompressInt(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int32_
   } else if (cmprAlg == TWO_STAGE_COMP) {
     if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
     return tsDecompressINTImp(pBuf, nEle, pOut, TSDB_DATA_TYPE_INT);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsDecompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_INT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsDecompressRLEImp(pIn, nIn, nEle, pOut, TSDB_DATA_TYPE_INT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2388,6 +2811,10 @@ int32_t tsCompressBigint(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int32
   } else if (cmprAlg == TWO_STAGE_COMP) {
     int32_t len = tsCompressINTImp(pIn, nEle, pBuf, TSDB_DATA_TYPE_BIGINT);
     return tsCompressStringImp(pBuf, len, pOut, nOut);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsCompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_BIGINT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsCompressRLEImp(pIn, nEle, pOut, TSDB_DATA_TYPE_BIGINT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
@@ -2401,6 +2828,10 @@ int32_t tsDecompressBigint(void *pIn, int32_t nIn, int32_t nEle, void *pOut, int
   } else if (cmprAlg == TWO_STAGE_COMP) {
     if (tsDecompressStringImp(pIn, nIn, pBuf, nBuf) < 0) return -1;
     return tsDecompressINTImp(pBuf, nEle, pOut, TSDB_DATA_TYPE_BIGINT);
+  } else if (cmprAlg == FOR_BITPACK_COMP) {
+    return tsDecompressFORImp(pIn, nEle, pOut, TSDB_DATA_TYPE_BIGINT);
+  } else if (cmprAlg == RLE_COMP) {
+    return tsDecompressRLEImp(pIn, nIn, nEle, pOut, TSDB_DATA_TYPE_BIGINT);
   } else {
     ASSERTS(0, "compress algo invalid");
     return -1;
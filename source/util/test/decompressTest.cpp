@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "tcompression.h"
+
+namespace {
+
+typedef int32_t (*CompFn)(void *, int32_t, int32_t, void *, int32_t, uint8_t, void *, int32_t);
+
+const int32_t kRows = 4096;
+const int32_t kBenchRounds = 2000;
+
+struct Codec {
+  const char *name;
+  int32_t     bytes;
+  CompFn      comp;
+  CompFn      decomp;
+  bool        isInteger;
+};
+
+const Codec kCodecs[] = {
+    {"tinyint", 1, tsCompressTinyint, tsDecompressTinyint, true},
+    {"smallint", 2, tsCompressSmallint, tsDecompressSmallint, true},
+    {"int", 4, tsCompressInt, tsDecompressInt, true},
+    {"bigint", 8, tsCompressBigint, tsDecompressBigint, true},
+    {"timestamp", 8, tsCompressTimestamp, tsDecompressTimestamp, false},
+    {"float", 4, tsCompressFloat, tsDecompressFloat, false},
+    {"double", 8, tsCompressDouble, tsDecompressDouble, false},
+};
+
+// Fill nEle values of the codec type, covering runs, small steps and random bit widths.
+void genData(const Codec &codec, int32_t nEle, int32_t pattern, std::mt19937_64 &rng, std::vector<char> &data) {
+  data.assign(nEle * codec.bytes, 0);
+  int64_t base = 1650803518000;
+  for (int32_t i = 0; i < nEle; ++i) {
+    int64_t v = 0;
+    switch (pattern) {
+      case 0:
+        v = 7;
+        break;
+      case 1:
+        v = base + i * 1000 + (int64_t)(rng() % 8);
+        break;
+      case 2:
+        v = (int64_t)(rng() % 200) - 100;
+        break;
+      default:
+        v = (int64_t)(rng() >> (rng() % 40 + 8));
+        break;
+    }
+
+    if (strcmp(codec.name, "float") == 0) {
+      float f = (pattern == 0) ? 1.5f : (float)(v % 100000) / 8;
+      memcpy(data.data() + i * codec.bytes, &f, sizeof(f));
+    } else if (strcmp(codec.name, "double") == 0) {
+      double d = (pattern == 0) ? 1.5 : (double)(v % 100000) / 8;
+      memcpy(data.data() + i * codec.bytes, &d, sizeof(d));
+    } else {
+      // little endian truncation to the column width
+      memcpy(data.data() + i * codec.bytes, &v, codec.bytes);
+    }
+  }
+}
+
+void roundTrip(const Codec &codec, const std::vector<char> &data, int32_t nEle, uint8_t cmprAlg) {
+  int32_t           size = nEle * codec.bytes;
+  std::vector<char> cmpr(size + 64);
+  std::vector<char> buf(size + 64);
+  std::vector<char> out(size + 64);
+
+  int32_t len = codec.comp((void *)data.data(), size, nEle, cmpr.data(), (int32_t)cmpr.size(), cmprAlg, buf.data(),
+                           (int32_t)buf.size());
+  ASSERT_GT(len, 0) << codec.name;
+  int32_t outLen = codec.decomp(cmpr.data(), len, nEle, out.data(), (int32_t)out.size(), cmprAlg, buf.data(),
+                                (int32_t)buf.size());
+  ASSERT_EQ(outLen, size) << codec.name;
+  ASSERT_EQ(memcmp(data.data(), out.data(), size), 0) << codec.name << " nEle:" << nEle << " alg:" << (int)cmprAlg;
+}
+
+}  // namespace
+
+TEST(decompressTest, roundTrip) {
+  std::mt19937_64   rng(20230601);
+  std::vector<char> data;
+  char              simdBuiltins = tsSIMDBuiltins;
+
+  taosGetCpuInstructions(&tsSSE42Enable, &tsAVXEnable, &tsAVX2Enable, &tsFMAEnable);
+  for (char simd = 0; simd <= 1; ++simd) {
+    tsSIMDBuiltins = simd;
+    for (const Codec &codec : kCodecs) {
+      for (int32_t pattern = 0; pattern < 4; ++pattern) {
+        for (int32_t nEle = 1; nEle <= kRows; nEle += (nEle < 300 ? 1 : 509)) {
+          genData(codec, nEle, pattern, rng, data);
+          roundTrip(codec, data, nEle, ONE_STAGE_COMP);
+          roundTrip(codec, data, nEle, TWO_STAGE_COMP);
+          if (codec.isInteger) {
+            roundTrip(codec, data, nEle, FOR_BITPACK_COMP);
+            roundTrip(codec, data, nEle, RLE_COMP);
+          }
+        }
+      }
+    }
+  }
+  tsSIMDBuiltins = simdBuiltins;
+}
+
+// Micro-benchmark of the one stage decoders, reported in nanoseconds per decoded value.
+TEST(decompressTest, bench) {
+  std::mt19937_64   rng(20230601);
+  std::vector<char> data;
+
+  taosGetCpuInstructions(&tsSSE42Enable, &tsAVXEnable, &tsAVX2Enable, &tsFMAEnable);
+  for (const Codec &codec : kCodecs) {
+    genData(codec, kRows, 1, rng, data);
+
+    int32_t           size = kRows * codec.bytes;
+    std::vector<char> cmpr(size + 64);
+    std::vector<char> out(size + 64);
+    int32_t len = codec.comp(data.data(), size, kRows, cmpr.data(), (int32_t)cmpr.size(), ONE_STAGE_COMP, NULL, 0);
+    ASSERT_GT(len, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < kBenchRounds; ++i) {
+      codec.decomp(cmpr.data(), len, kRows, out.data(), (int32_t)out.size(), ONE_STAGE_COMP, NULL, 0);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("%-10s ratio:%5.2f decode:%6.2f ns/value\n", codec.name, (double)size / len,
+           ns / ((double)kBenchRounds * kRows));
+  }
+}
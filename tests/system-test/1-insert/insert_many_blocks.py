@@ -0,0 +1,64 @@
+# -*- coding: utf-8 -*-
+
+import taos
+
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    # a submit request of 32 blocks or more is inserted by the vnode insert threads
+    updatecfgDict = {'numOfVnodeInsertThreads': 4}
+
+    def init(self, conn, logSql, replicaVar=1):
+        self.replicaVar = int(replicaVar)
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+        self.dbname = "db"
+        self.stbname = "stb"
+        self.tbnum = 64
+        self.rownum = 10
+        self.ts = 1537146000000
+
+    def insert_sql(self, ts):
+        sql = "insert into"
+        for i in range(self.tbnum):
+            sql += f" {self.dbname}.ct{i} values"
+            for j in range(self.rownum):
+                sql += f" ({ts + j}, {i}, {j})"
+        return sql
+
+    def run(self):
+        tdSql.execute(f"create database {self.dbname} vgroups 1")
+        tdSql.execute(f"create table {self.dbname}.{self.stbname} (ts timestamp, c1 int, c2 int) tags (t1 int)")
+        for i in range(self.tbnum):
+            tdSql.execute(f"create table {self.dbname}.ct{i} using {self.dbname}.{self.stbname} tags ({i})")
+
+        # one block per table
+        tdSql.execute(self.insert_sql(self.ts))
+        tdSql.checkAffectedRows(self.tbnum * self.rownum)
+        tdSql.query(f"select count(*), sum(c1), sum(c2) from {self.dbname}.{self.stbname}")
+        tdSql.checkData(0, 0, self.tbnum * self.rownum)
+        tdSql.checkData(0, 1, self.rownum * self.tbnum * (self.tbnum - 1) // 2)
+        tdSql.checkData(0, 2, self.tbnum * self.rownum * (self.rownum - 1) // 2)
+
+        # the insert threads of the vnode fail the block of a table dropped behind the back of the client
+        conn = taos.connect(config=tdDnodes.getSimCfgPath())
+        conn.execute(f"drop table {self.dbname}.ct5")
+        conn.close()
+
+        tdSql.error(self.insert_sql(self.ts + self.rownum))
+        tdSql.query(f"select count(*) from {self.dbname}.ct4")
+        tdSql.checkData(0, 0, self.rownum * 2)
+        tdSql.query(f"select count(*) from {self.dbname}.{self.stbname}")
+        tdSql.checkData(0, 0, (self.tbnum - 1) * self.rownum * 2)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())